@@ -0,0 +1,3260 @@
+﻿/*+===================================================================
+  File:      MAIN.CPP
+
+  Summary:   Frame benchmark. Runs frames with synthetic simulation and
+             render loads through the frame pipeline, one stage after
+             the other and then overlapped, and reports the frame
+             throughput of both. Then stresses the job system, measures
+             how its parallel loops scale with the number of threads,
+             checks that steady frames of profiled tasks with frame
+             arena scratch never call operator new, times the frustum
+             culler and the clustered light culler with and without SSE,
+             checks the occlusion culler around a wall and times its
+             rasterizer, checks the AVX2 mip kernels against the scalar
+             ones, the splits and texel snapping of the shadow cascades,
+             the frame timer on a scripted clock and the rectangle
+             packer, times the shader permutation lookup of a draw and
+             checks the constant ring on scripted fences and the texture
+             streaming queue on a fake loader, maps DDS files and a TPAK
+             archive of them, checks their layout and that corrupt
+             headers are rejected, times mapped against read loads, and
+             checks the GPU profiler on scripted late timestamps. Last,
+             builds a voxel scene of a configurable size with models,
+             animated models and lights, flies the camera along a
+             scripted path through it on a headless renderer, or runs
+             the frames of an input log the game recorded, and reports
+             the load time with and without the texture cache, the frame
+             time percentiles and the average and worst time of every
+             subsystem, then how the path frames scale with the
+             submission threads. Needs no window nor GPU. The scene
+             needs the Direct3D renderer and runs on Windows only, the
+             rest builds and runs on any host.
+
+  © 2022 Kyung Hee University
+===================================================================+*/
+
+#include "Common.h"
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <chrono>
+#include <cstdarg>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <fstream>
+#include <functional>
+#include <memory>
+#include <new>
+#include <numeric>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "Game/FramePipeline.h"
+#include "Game/FrameTimer.h"
+#include "Game/InputRecording.h"
+#include "Job/JobSystem.h"
+#include "Memory/FrameArena.h"
+#include "Profiler/CpuProfiler.h"
+#include "Profiler/GpuProfiler.h"
+#include "Renderer/ClusteredLightCuller.h"
+#include "Renderer/FrustumCuller.h"
+#include "Renderer/OcclusionCuller.h"
+#include "Renderer/RenderContext.h"
+#include "Renderer/RenderThreadPool.h"
+#include "Renderer/RingAllocator.h"
+#include "Renderer/ShadowCascades.h"
+#include "Shader/ShaderPermutation.h"
+#include "Texture/DDSFile.h"
+#include "Texture/FileMapping.h"
+#include "Texture/MipGenerator.h"
+#include "Texture/RectanglePacker.h"
+#include "Texture/TextureArchive.h"
+#include "Texture/TextureStreamingQueue.h"
+
+#ifdef _WIN32
+#include "Light/PointLight.h"
+#include "Model/Model.h"
+#include "Renderer/Renderer.h"
+#include "Scene/Scene.h"
+#include "Shader/ShaderConstants.h"
+#include "Shader/ShadowVertexShader.h"
+#include "Texture/TextureCache.h"
+#endif // _WIN32
+
+/*S+S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S
+  Struct:   SceneSettings
+
+  Summary:  Size of the benchmark scene, in voxel columns and height,
+            models, animated models and point lights, and the frames
+            the camera takes to fly its path
+S---S---S---S---S---S---S---S---S---S---S---S---S---S---S---S---S-S*/
+struct SceneSettings
+{
+    UINT uMapSize;
+    UINT uMapHeight;
+    UINT uNumModels;
+    UINT uNumAnimatedModels;
+    UINT uNumLights;
+    UINT uNumFrames;
+};
+
+// Simulation step of the scene frames, the one the game runs at
+static constexpr FLOAT SCENE_TIMESTEP = 1.0f / 60.0f;
+
+// Frames run before the measured ones, while the caches and rings warm up
+static constexpr UINT NUM_WARMUP_FRAMES = 30u;
+
+// Random boxes the frustum culler is timed on
+static constexpr UINT NUM_CULLING_BOXES = 1u << 20u;
+
+// Random point lights the clustered light culler is timed on
+static constexpr UINT NUM_CULLED_LIGHTS = 1000u;
+
+// Random boxes the occlusion culler rasterizes in its timing
+static constexpr UINT NUM_OCCLUDERS = 4096u;
+
+// Side of the image the mip kernels are timed on
+static constexpr UINT MIP_TIMING_SIZE = 2048u;
+
+// Random draws whose shader permutation lookups are timed
+static constexpr UINT NUM_PERMUTATION_LOOKUPS = 1u << 22u;
+
+// Side of the DDS file whose mapped and read loads are timed
+static constexpr UINT DDS_TIMING_SIZE = 2048u;
+
+// DXGI_FORMAT values of the DDS files the texture file checks write
+static constexpr UINT FORMAT_R8G8B8A8_UNORM = 28u;
+static constexpr UINT FORMAT_BC1_UNORM = 71u;
+
+static constexpr PCSTR USAGE = "Usage: Benchmark [-frames N] [-simulation MS] [-render MS] [-jobs N] [-stress N] [-scene N] [-map N] [-height N]"
+    " [-models N] [-animated N] [-lights N] [-content DIR] [-replay FILE] [-frametimes FILE]\n";
+
+#ifdef _WIN32
+// Camera path recorded over the map, a closed loop. X and Z are
+// fractions of the half extent of the map, Y the height above its
+// highest voxels
+static constexpr XMFLOAT3 CAMERA_PATH[] =
+{
+    XMFLOAT3(-0.6f, 12.0f, -0.6f),
+    XMFLOAT3( 0.0f, 20.0f, -0.8f),
+    XMFLOAT3( 0.6f, 14.0f, -0.6f),
+    XMFLOAT3( 0.8f, 30.0f,  0.0f),
+    XMFLOAT3( 0.5f, 10.0f,  0.5f),
+    XMFLOAT3( 0.0f, 16.0f,  0.2f),
+    XMFLOAT3(-0.5f, 24.0f,  0.6f),
+    XMFLOAT3(-0.8f, 12.0f,  0.0f),
+};
+#endif // _WIN32
+
+// Calls to operator new of the whole process, so that a run can tell
+// whether its steady frames reach the heap
+static std::atomic<UINT64> s_uNumHeapAllocations = 0u;
+
+// GCC pairs malloc and free with operator new and delete once the
+// replacements below are inlined into their callers, they stay out of
+// line
+#if defined(__GNUC__) && !defined(__clang__)
+#define BENCHMARK_NOINLINE __attribute__((noinline))
+#else
+#define BENCHMARK_NOINLINE
+#endif
+
+/*F+F+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+  Function: operator new
+
+  Summary:  Replaces the global allocation function to count its calls.
+            The array and nothrow forms call this one
+
+  Args:     size_t uSize
+              Bytes to allocate
+
+  Returns:  void*
+              Memory allocated
+-----------------------------------------------------------------F-F*/
+BENCHMARK_NOINLINE void* operator new(size_t uSize)
+{
+    s_uNumHeapAllocations.fetch_add(1u, std::memory_order_relaxed);
+    void* pMemory = malloc(uSize > 0u ? uSize : 1u);
+    if (!pMemory)
+    {
+        throw std::bad_alloc();
+    }
+
+    return pMemory;
+}
+
+BENCHMARK_NOINLINE void operator delete(void* pMemory) noexcept
+{
+    free(pMemory);
+}
+
+BENCHMARK_NOINLINE void operator delete(void* pMemory, size_t) noexcept
+{
+    free(pMemory);
+}
+
+/*S+S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S
+  Struct:   BenchmarkResult
+
+  Summary:  Throughput and frame times of a run, in milliseconds
+S---S---S---S---S---S---S---S---S---S---S---S---S---S---S---S---S-S*/
+struct BenchmarkResult
+{
+    double framesPerSecond;
+    double averageFrameTime;
+    double worstFrameTime;
+};
+
+/*C+C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C
+  Class:    ManualClock
+
+  Summary:  Clock of the frame timer checks, advanced by hand. A sleep
+            advances it by the time slept, a yield by a fixed tick, so
+            the limiter can wait on it
+
+  Methods:  Advance
+              Moves the time forward
+            GetTime
+              Returns the time
+            Sleep
+              Moves the time forward by the sleep or a tick
+            ManualClock
+              Constructor.
+            ~ManualClock
+              Destructor.
+C---C---C---C---C---C---C---C---C---C---C---C---C---C---C---C---C-C*/
+class ManualClock final : public library::Clock
+{
+public:
+    static constexpr double YIELD_TICK = 1.0 / 1024.0;
+
+public:
+    ManualClock()
+        : m_time(0.0)
+    {
+    }
+
+    ManualClock(const ManualClock& other) = delete;
+    ManualClock(ManualClock&& other) = delete;
+    ManualClock& operator=(const ManualClock& other) = delete;
+    ManualClock& operator=(ManualClock&& other) = delete;
+    ~ManualClock() = default;
+
+    void Advance(_In_ double seconds)
+    {
+        m_time += seconds;
+    }
+
+    double GetTime() override
+    {
+        return m_time;
+    }
+
+    void Sleep(_In_ double seconds) override
+    {
+        m_time += (seconds > 0.0) ? seconds : YIELD_TICK;
+    }
+
+private:
+    double m_time;
+};
+
+/*C+C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C
+  Class:    ScriptedTimestampContext
+
+  Summary:  Render context whose timestamp queries the GPU profiler
+            checks script. Timestamps read a clock the check advances,
+            a set becomes readable a scripted number of frames after it
+            ended and its read can report a disjoint clock. Misuses of
+            the sets are counted: beginning one in flight, writing to
+            one not begun, and reading one not ended or out of order.
+            Every other command is discarded
+
+  Methods:  SetFrame
+              Sets the frame the scripted GPU has reached
+            SetNextSet
+              Scripts the latency and clock of the next set begun
+            AdvanceClock
+              Moves the clock the timestamps read
+            GetNumMisuses
+              Returns the misuses of the sets so far
+            GetNumFailedPolls
+              Returns the reads of sets not ready since the last frame
+            GetReadFrames
+              Returns the frames read back, in order, and whether
+              their clock was disjoint
+            ScriptedTimestampContext
+              Constructor.
+            ~ScriptedTimestampContext
+              Destructor.
+C---C---C---C---C---C---C---C---C---C---C---C---C---C---C---C---C-C*/
+class ScriptedTimestampContext final : public library::RenderContext
+{
+public:
+    static constexpr UINT64 FREQUENCY = 1000000u;
+
+    struct ReadFrame
+    {
+        UINT uFrame;
+        BOOL bDisjoint;
+    };
+
+public:
+    ScriptedTimestampContext() = default;
+    ScriptedTimestampContext(const ScriptedTimestampContext& other) = delete;
+    ScriptedTimestampContext(ScriptedTimestampContext&& other) = delete;
+    ScriptedTimestampContext& operator=(const ScriptedTimestampContext& other) = delete;
+    ScriptedTimestampContext& operator=(ScriptedTimestampContext&& other) = delete;
+    ~ScriptedTimestampContext() override = default;
+
+    void SetFrame(_In_ UINT uFrame)
+    {
+        m_uFrame = uFrame;
+        m_uNumFailedPolls = 0u;
+    }
+
+    void SetNextSet(_In_ UINT uLatency, _In_ BOOL bDisjoint)
+    {
+        m_uNextLatency = uLatency;
+        m_bNextDisjoint = bDisjoint;
+    }
+
+    void AdvanceClock(_In_ UINT64 uTicks)
+    {
+        m_uClock += uTicks;
+    }
+
+    UINT GetNumMisuses() const
+    {
+        return m_uNumMisuses;
+    }
+
+    UINT GetNumFailedPolls() const
+    {
+        return m_uNumFailedPolls;
+    }
+
+    const std::vector<ReadFrame>& GetReadFrames() const
+    {
+        return m_aReadFrames;
+    }
+
+protected:
+    // Commands are discarded, only the timestamp queries are scripted
+    void clearRenderTarget(_In_ library::RenderHandle, _In_ const FLOAT[4]) override {}
+    void clearDepthStencil(_In_ library::RenderHandle, _In_ FLOAT) override {}
+    void setRenderTargets(_In_ UINT, _In_ const library::RenderHandle*, _In_opt_ library::RenderHandle) override {}
+    void setViewport(_In_ FLOAT, _In_ FLOAT) override {}
+    void setPrimitiveTopology(_In_ library::ePrimitiveTopology) override {}
+    void setVertexBuffers(_In_ UINT, _In_ UINT, _In_ const library::RenderHandle*, _In_ const UINT*, _In_ const UINT*) override {}
+    void setIndexBuffer(_In_ library::RenderHandle, _In_ library::eIndexFormat, _In_ UINT) override {}
+    void setInputLayout(_In_ library::RenderHandle) override {}
+    void setVertexShader(_In_ library::RenderHandle) override {}
+    void setPixelShader(_In_ library::RenderHandle) override {}
+    void setVertexConstantBuffers(_In_ UINT, _In_ UINT, _In_ const library::RenderHandle*) override {}
+    void setPixelConstantBuffers(_In_ UINT, _In_ UINT, _In_ const library::RenderHandle*) override {}
+    void setVertexConstantBufferRanges(_In_ UINT, _In_ UINT, _In_ const library::ConstantBufferRange*) override {}
+    void setPixelConstantBufferRanges(_In_ UINT, _In_ UINT, _In_ const library::ConstantBufferRange*) override {}
+    void setPixelShaderResources(_In_ UINT, _In_ UINT, _In_ const library::RenderHandle*) override {}
+    void setPixelSamplers(_In_ UINT, _In_ UINT, _In_ const library::RenderHandle*) override {}
+    void updateConstantBuffer(_In_ library::RenderHandle, _In_ const void*, _In_ UINT) override {}
+    void* mapBuffer(_In_ library::RenderHandle, _In_ library::eMapMode, _In_ UINT) override { return nullptr; }
+    void unmapBuffer(_In_ library::RenderHandle) override {}
+    void copySubresource(_In_ library::RenderHandle, _In_ UINT, _In_ library::RenderHandle, _In_ UINT) override {}
+    void drawIndexed(_In_ UINT, _In_ UINT, _In_ INT) override {}
+    void drawIndexedInstanced(_In_ UINT, _In_ UINT, _In_ UINT, _In_ INT, _In_ UINT) override {}
+    HRESULT finishCommandList() override { return E_NOTIMPL; }
+    HRESULT executeCommandList(_In_ library::RenderContext&) override { return E_NOTIMPL; }
+    void signalFence(_In_ UINT64) override {}
+    UINT64 getCompletedFenceValue() override { return 0u; }
+
+    HRESULT createTimestampQueries(_In_ UINT uNumQuerySets, _In_ UINT uNumTimestamps) override
+    {
+        m_aSets.assign(uNumQuerySets, QuerySet{ .auTimestamps = std::vector<UINT64>(uNumTimestamps, 0u) });
+        return S_OK;
+    }
+
+    void beginTimestampQueries(_In_ UINT uQuerySet) override
+    {
+        QuerySet& querySet = m_aSets[uQuerySet];
+        m_uNumMisuses += (querySet.eState != eSetState::FREE) ? 1u : 0u;
+        querySet.eState = eSetState::FILLING;
+        querySet.uFrame = m_uFrame;
+        querySet.uReadyFrame = m_uFrame + m_uNextLatency;
+        querySet.bDisjoint = m_bNextDisjoint;
+    }
+
+    void writeTimestamp(_In_ UINT uQuerySet, _In_ UINT uTimestamp) override
+    {
+        QuerySet& querySet = m_aSets[uQuerySet];
+        if (querySet.eState != eSetState::FILLING || uTimestamp >= querySet.auTimestamps.size())
+        {
+            ++m_uNumMisuses;
+            return;
+        }
+        querySet.auTimestamps[uTimestamp] = m_uClock;
+    }
+
+    void endTimestampQueries(_In_ UINT uQuerySet) override
+    {
+        QuerySet& querySet = m_aSets[uQuerySet];
+        m_uNumMisuses += (querySet.eState != eSetState::FILLING) ? 1u : 0u;
+        querySet.eState = eSetState::ENDED;
+        m_auEndedSets.push_back(uQuerySet);
+    }
+
+    BOOL getTimestampQueryData(_In_ UINT uQuerySet, _In_ UINT uNumTimestamps, _Out_writes_(uNumTimestamps) UINT64* auTimestamps,
+        _Out_ UINT64* puFrequency) override
+    {
+        *puFrequency = 0u;
+        QuerySet& querySet = m_aSets[uQuerySet];
+        if (querySet.eState != eSetState::ENDED || m_auEndedSets.empty() || m_auEndedSets.front() != uQuerySet
+            || uNumTimestamps > querySet.auTimestamps.size())
+        {
+            ++m_uNumMisuses;
+            return FALSE;
+        }
+        if (m_uFrame < querySet.uReadyFrame)
+        {
+            ++m_uNumFailedPolls;
+            return FALSE;
+        }
+
+        std::copy_n(querySet.auTimestamps.begin(), uNumTimestamps, auTimestamps);
+        *puFrequency = querySet.bDisjoint ? 0u : FREQUENCY;
+        querySet.eState = eSetState::FREE;
+        m_auEndedSets.pop_front();
+        m_aReadFrames.push_back({ .uFrame = querySet.uFrame, .bDisjoint = querySet.bDisjoint });
+
+        return TRUE;
+    }
+
+private:
+    enum class eSetState : UINT
+    {
+        FREE = 0,
+        FILLING,
+        ENDED,
+    };
+
+    struct QuerySet
+    {
+        std::vector<UINT64> auTimestamps;
+        eSetState eState = eSetState::FREE;
+        UINT uFrame = 0u;
+        UINT uReadyFrame = 0u;
+        BOOL bDisjoint = FALSE;
+    };
+
+    std::vector<QuerySet> m_aSets;
+    std::deque<UINT> m_auEndedSets;
+    std::vector<ReadFrame> m_aReadFrames;
+    UINT64 m_uClock = 0u;
+    UINT m_uFrame = 0u;
+    UINT m_uNextLatency = 0u;
+    BOOL m_bNextDisjoint = FALSE;
+    UINT m_uNumMisuses = 0u;
+    UINT m_uNumFailedPolls = 0u;
+};
+
+/*F+F+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+  Function: ReportCheck
+
+  Summary:  Prints the line of a check, what it covered and whether it
+            passed, and hands the result back for the check to return
+
+  Args:     BOOL bPassed
+              Result of the check
+            PCSTR pszFormat
+              printf format of what the check covered, then its values
+
+  Returns:  BOOL
+              bPassed
+-----------------------------------------------------------------F-F*/
+static BOOL ReportCheck(_In_ BOOL bPassed, _In_z_ PCSTR pszFormat, ...)
+{
+    va_list args;
+    va_start(args, pszFormat);
+    std::printf("\n");
+    std::vprintf(pszFormat, args);
+    std::printf(": %s\n", bPassed ? "passed" : "FAILED");
+    va_end(args);
+
+    return bPassed;
+}
+
+/*F+F+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+  Function: TimeBestOf
+
+  Summary:  Runs a piece of work a few times and returns the time of
+            the fastest run, the one least disturbed by the rest of the
+            machine
+
+  Args:     UINT uNumRuns
+              Times the work runs, at least one
+            const Function& run
+              The work
+
+  Returns:  double
+              Milliseconds of the fastest run
+-----------------------------------------------------------------F-F*/
+template <typename Function>
+static double TimeBestOf(_In_ UINT uNumRuns, _In_ const Function& run)
+{
+    double bestTime = 0.0;
+    for (UINT uRun = 0u; uRun < uNumRuns; ++uRun)
+    {
+        const auto start = std::chrono::steady_clock::now();
+        run();
+        const double time = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        bestTime = (uRun == 0u) ? time : std::min(bestTime, time);
+    }
+
+    return bestTime;
+}
+
+/*F+F+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+  Function: RunLoad
+
+  Summary:  Synthetic stage load. Blends transforms, the kind of
+            arithmetic animation and culling spend their time on. The
+            amount of work is fixed rather than the time, so a stage
+            that is preempted takes longer as real work does
+
+  Args:     UINT64 uNumPasses
+              Passes over the values
+            std::vector<FLOAT>& aState
+              Values the load transforms, kept so the work is not
+              optimized away
+
+  Modifies: [aState].
+-----------------------------------------------------------------F-F*/
+static void RunLoad(_In_ UINT64 uNumPasses, _Inout_ std::vector<FLOAT>& aState)
+{
+    for (UINT64 uPass = 0u; uPass < uNumPasses; ++uPass)
+    {
+        for (size_t i = 0u; i + 16u <= aState.size(); i += 16u)
+        {
+            FLOAT* m = &aState[i];
+            for (UINT j = 0u; j < 16u; ++j)
+            {
+                m[j] = m[j] * 0.999f + std::sin(m[(j + 5u) & 15u]) * 0.001f;
+            }
+        }
+    }
+}
+
+/*F+F+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+  Function: CalibrateLoad
+
+  Summary:  Measures how many passes of the synthetic load run in a
+            millisecond on one thread of this machine
+
+  Returns:  double
+              Passes per millisecond
+-----------------------------------------------------------------F-F*/
+static double CalibrateLoad()
+{
+    std::vector<FLOAT> aState(4096u, 0.5f);
+    UINT64 uNumPasses = 1u;
+    for (;;)
+    {
+        const auto start = std::chrono::steady_clock::now();
+        RunLoad(uNumPasses, aState);
+        const double milliseconds = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        if (milliseconds >= 50.0)
+        {
+            return static_cast<double>(uNumPasses) / milliseconds;
+        }
+        uNumPasses *= 2u;
+    }
+}
+
+/*F+F+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+  Function: RunFrames
+
+  Summary:  Runs frames through a frame pipeline, each simulating and
+            rendering with the synthetic loads
+
+  Args:     BOOL bPipelined
+              TRUE to overlap the stages
+            UINT uNumFrames
+              Number of frames to run
+            UINT64 uSimulationPasses
+              Load of the simulation stage
+            UINT64 uRenderPasses
+              Load of the render stage
+
+  Returns:  BenchmarkResult
+              Throughput and frame times of the run
+-----------------------------------------------------------------F-F*/
+static BenchmarkResult RunFrames(_In_ BOOL bPipelined, _In_ UINT uNumFrames, _In_ UINT64 uSimulationPasses, _In_ UINT64 uRenderPasses)
+{
+    library::FramePipeline pipeline;
+    pipeline.Initialize(bPipelined);
+
+    // Each stage has its own data, as the two frame snapshots of the renderer
+    std::vector<FLOAT> aSimulationState(4096u, 0.5f);
+    std::vector<FLOAT> aRenderState(4096u, 0.5f);
+    const std::function<void()> simulate = [&]() { RunLoad(uSimulationPasses, aSimulationState); };
+    const std::function<void()> render = [&]() { RunLoad(uRenderPasses, aRenderState); };
+
+    double worstFrameTime = 0.0;
+    const auto start = std::chrono::steady_clock::now();
+    for (UINT i = 0u; i < uNumFrames; ++i)
+    {
+        pipeline.RunFrame(simulate, render);
+        worstFrameTime = std::max(worstFrameTime, static_cast<double>(pipeline.GetStatistics().frameTime));
+    }
+    const double totalTime = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+    return
+    {
+        .framesPerSecond = 1000.0 * uNumFrames / totalTime,
+        .averageFrameTime = totalTime / uNumFrames,
+        .worstFrameTime = worstFrameTime
+    };
+}
+
+/*F+F+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+  Function: RunJobStress
+
+  Summary:  Checks the job system under load: many tiny jobs, jobs
+            spawning and waiting for jobs, dependency chains, jobs for
+            the main thread and jobs run from a thread outside the
+            system. Every check counts the work it expects to be done
+
+  Args:     UINT uNumThreads
+              Threads of the job system
+            UINT uNumRounds
+              Times every check is repeated
+
+  Returns:  BOOL
+              TRUE if every check passed
+-----------------------------------------------------------------F-F*/
+static BOOL RunJobStress(_In_ UINT uNumThreads, _In_ UINT uNumRounds)
+{
+    library::JobSystem jobSystem;
+    if (FAILED(jobSystem.Initialize(uNumThreads)))
+    {
+        return FALSE;
+    }
+
+    BOOL bPassed = TRUE;
+    for (UINT uRound = 0u; uRound < uNumRounds; ++uRound)
+    {
+        // More tiny jobs than a queue holds, the rest overflow to the shared queue
+        std::atomic<UINT> uNumTinyJobs = 0u;
+        library::JobCounter tinyCounter;
+        for (UINT i = 0u; i < 2u * library::WorkStealingQueue::CAPACITY; ++i)
+        {
+            jobSystem.Run([&uNumTinyJobs]() { uNumTinyJobs.fetch_add(1u, std::memory_order_relaxed); }, &tinyCounter);
+        }
+        jobSystem.Wait(tinyCounter);
+        bPassed &= uNumTinyJobs.load() == 2u * library::WorkStealingQueue::CAPACITY;
+
+        // Parallel loops inside parallel loops, every element once
+        std::vector<std::atomic<UINT>> aVisits(64u * 64u);
+        jobSystem.ParallelFor(64u, 1u, [&jobSystem, &aVisits](UINT uFirstRow, UINT uLastRow)
+            {
+                for (UINT uRow = uFirstRow; uRow < uLastRow; ++uRow)
+                {
+                    jobSystem.ParallelFor(64u, 4u, [&aVisits, uRow](UINT uFirst, UINT uLast)
+                        {
+                            for (UINT i = uFirst; i < uLast; ++i)
+                            {
+                                aVisits[uRow * 64u + i].fetch_add(1u, std::memory_order_relaxed);
+                            }
+                        });
+                }
+            });
+        bPassed &= std::all_of(aVisits.begin(), aVisits.end(), [](const std::atomic<UINT>& uVisits) { return uVisits.load() == 1u; });
+
+        // A chain of dependencies runs in order
+        static constexpr UINT CHAIN_LENGTH = 64u;
+        std::vector<std::unique_ptr<library::JobCounter>> apLinks;
+        std::vector<UINT> aOrder;
+        library::JobCounter chainCounter;
+        for (UINT i = 0u; i < CHAIN_LENGTH; ++i)
+        {
+            apLinks.push_back(std::make_unique<library::JobCounter>());
+            const std::function<void()> link = [&aOrder, i]() { aOrder.push_back(i); };
+            if (i == 0u)
+            {
+                jobSystem.Run(link, apLinks[i].get());
+            }
+            else
+            {
+                jobSystem.RunAfter(*apLinks[i - 1u], link, apLinks[i].get());
+            }
+        }
+        jobSystem.RunAfter(*apLinks.back(), []() {}, &chainCounter);
+        jobSystem.Wait(chainCounter);
+        for (const std::unique_ptr<library::JobCounter>& pLink : apLinks)
+        {
+            jobSystem.Wait(*pLink);
+        }
+        bPassed &= aOrder.size() == CHAIN_LENGTH;
+        for (UINT i = 0u; i < aOrder.size(); ++i)
+        {
+            bPassed &= aOrder[i] == i;
+        }
+
+        // Jobs for the main thread, queued by workers, run on the main thread
+        std::atomic<UINT> uNumOnMainThread = 0u;
+        library::JobCounter mainThreadCounter;
+        jobSystem.ParallelFor(256u, 1u, [&jobSystem, &uNumOnMainThread, &mainThreadCounter](UINT uFirst, UINT uLast)
+            {
+                for (UINT i = uFirst; i < uLast; ++i)
+                {
+                    jobSystem.RunOnMainThread([&jobSystem, &uNumOnMainThread]()
+                        {
+                            if (jobSystem.IsMainThread())
+                            {
+                                uNumOnMainThread.fetch_add(1u, std::memory_order_relaxed);
+                            }
+                        }, &mainThreadCounter);
+                }
+            });
+        jobSystem.Wait(mainThreadCounter);
+        bPassed &= uNumOnMainThread.load() == 256u;
+
+        // A thread outside the system runs and waits for its own jobs
+        std::atomic<UINT> uNumExternalJobs = 0u;
+        std::thread external([&jobSystem, &uNumExternalJobs]()
+            {
+                jobSystem.ParallelFor(1024u, 8u, [&uNumExternalJobs](UINT uFirst, UINT uLast)
+                    {
+                        uNumExternalJobs.fetch_add(uLast - uFirst, std::memory_order_relaxed);
+                    });
+            });
+        external.join();
+        bPassed &= uNumExternalJobs.load() == 1024u;
+    }
+
+    return bPassed;
+}
+
+/*F+F+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+  Function: RunJobScaling
+
+  Summary:  Times a parallel loop of the synthetic load on a job system
+            of the given number of threads
+
+  Args:     UINT uNumThreads
+              Threads of the job system
+            UINT uNumJobs
+              Jobs of the loop
+            UINT64 uPassesPerJob
+              Load of each job
+
+  Returns:  double
+              Milliseconds of the loop, the best of a few runs
+-----------------------------------------------------------------F-F*/
+static double RunJobScaling(_In_ UINT uNumThreads, _In_ UINT uNumJobs, _In_ UINT64 uPassesPerJob)
+{
+    library::JobSystem jobSystem;
+    jobSystem.Initialize(uNumThreads);
+
+    std::vector<std::vector<FLOAT>> aStates(uNumJobs, std::vector<FLOAT>(256u, 0.5f));
+    return TimeBestOf(5u, [&jobSystem, &aStates, uNumJobs, uPassesPerJob]()
+        {
+            jobSystem.ParallelFor(uNumJobs, 1u, [&aStates, uPassesPerJob](UINT uFirst, UINT uLast)
+                {
+                    for (UINT i = uFirst; i < uLast; ++i)
+                    {
+                        RunLoad(uPassesPerJob, aStates[i]);
+                    }
+                });
+        });
+}
+
+/*F+F+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+  Function: MakeViewProjection
+
+  Summary:  Builds the view projection the culling checks look through,
+            a camera at the origin looking down z with 60 degrees of
+            vertical field of view at 16:9, row major as the renderer
+
+  Args:     FLOAT nearZ
+              Distance of the near plane
+            FLOAT farZ
+              Distance of the far plane
+            FLOAT* aViewProjection
+              Receives the 16 floats of the matrix
+
+  Modifies: [aViewProjection].
+-----------------------------------------------------------------F-F*/
+static void MakeViewProjection(_In_ FLOAT nearZ, _In_ FLOAT farZ, _Out_writes_(16) FLOAT* aViewProjection)
+{
+    const FLOAT yScale = 1.0f / std::tan(0.5f * 60.0f * 3.14159265f / 180.0f);
+    const FLOAT xScale = yScale * 9.0f / 16.0f;
+    const FLOAT aMatrix[16] =
+    {
+        xScale, 0.0f, 0.0f, 0.0f,
+        0.0f, yScale, 0.0f, 0.0f,
+        0.0f, 0.0f, farZ / (farZ - nearZ), 1.0f,
+        0.0f, 0.0f, -nearZ * farZ / (farZ - nearZ), 0.0f,
+    };
+    std::memcpy(aViewProjection, aMatrix, sizeof(aMatrix));
+}
+
+/*F+F+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+  Function: RunCullingBenchmark
+
+  Summary:  Times the frustum culler on random boxes around a camera,
+            one box at a time and four at a time with SSE, the path
+            Cull takes when available, and checks both flag the same
+            boxes visible
+
+  Args:     UINT uNumBoxes
+              Number of boxes
+
+  Returns:  BOOL
+              TRUE if both paths gave the same flags
+-----------------------------------------------------------------F-F*/
+static BOOL RunCullingBenchmark(_In_ UINT uNumBoxes)
+{
+    const FLOAT farZ = 1000.0f;
+    FLOAT aViewProjection[16];
+    MakeViewProjection(0.1f, farZ, aViewProjection);
+    library::FrustumCuller culler;
+    culler.SetViewProjection(aViewProjection);
+
+    std::mt19937 random(1u);
+    std::uniform_real_distribution<FLOAT> position(-farZ, farZ);
+    std::uniform_real_distribution<FLOAT> extent(0.5f, 8.0f);
+    library::BoundingBoxArray boxes;
+    boxes.Reserve(uNumBoxes);
+    for (UINT i = 0u; i < uNumBoxes; ++i)
+    {
+        library::AxisAlignedBox box;
+        for (UINT uAxis = 0u; uAxis < 3u; ++uAxis)
+        {
+            box.Center[uAxis] = position(random);
+            box.Extents[uAxis] = extent(random);
+        }
+        boxes.Add(box);
+    }
+
+    std::vector<BYTE> aScalarVisible(uNumBoxes, 0u);
+    std::vector<BYTE> aSimdVisible(uNumBoxes, 0u);
+    UINT uNumScalarVisible = 0u;
+    UINT uNumSimdVisible = 0u;
+    const double scalarTime = TimeBestOf(5u, [&]()
+        {
+            uNumScalarVisible = culler.CullScalar(boxes, 0u, uNumBoxes, aScalarVisible.data());
+        });
+    const double simdTime = TimeBestOf(5u, [&]()
+        {
+            uNumSimdVisible = culler.Cull(boxes, aSimdVisible.data());
+        });
+
+    const BOOL bPassed = ReportCheck(uNumScalarVisible == uNumSimdVisible && std::memcmp(aScalarVisible.data(), aSimdVisible.data(), uNumBoxes) == 0,
+        "Frustum culling, %u boxes, %u visible", uNumBoxes, uNumSimdVisible);
+    std::printf("%-10s %12s %12s %12s\n", "Path", "Time ms", "Mboxes/s", "Speedup");
+    std::printf("%-10s %12.3f %12.1f %11.2fx\n", "Scalar", scalarTime, uNumBoxes / (1000.0 * scalarTime), 1.0);
+    std::printf("%-10s %12.3f %12.1f %11.2fx\n", "SSE", simdTime, uNumBoxes / (1000.0 * simdTime), scalarTime / simdTime);
+
+    return bPassed;
+}
+
+/*F+F+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+  Function: RunLightCullingBenchmark
+
+  Summary:  Times the clustered light culler on random lights in and
+            around the view frustum, one cluster at a time and four at
+            a time with SSE, the path Cull takes when available. Both
+            must give the same lists, in light order, checked by brute
+            force against every cluster. A list may only hold lights
+            whose sphere touches the bounding box of the cluster, and
+            must hold every light whose sphere covers a point of a grid
+            spanning the cluster itself, unless the list is full.
+            Spheres within a hair of either may go both ways
+
+  Args:     UINT uNumLights
+              Number of lights
+
+  Returns:  BOOL
+              TRUE if both paths gave the lists of the reference
+-----------------------------------------------------------------F-F*/
+static BOOL RunLightCullingBenchmark(_In_ UINT uNumLights)
+{
+    static constexpr FLOAT NEAR_Z = 0.1f;
+    static constexpr FLOAT FAR_Z = 200.0f;
+    static constexpr double TOUCH_TOLERANCE = 1.0e-3;
+    static constexpr UINT MAX_LIGHTS = library::ClusteredLightCuller::MAX_LIGHTS_PER_CLUSTER;
+    static constexpr UINT NUM_GRID_POINTS = 5u;
+
+    const FLOAT tanHalfFovY = std::tan(0.5f * 60.0f * 3.14159265f / 180.0f);
+    const FLOAT tanHalfFovX = tanHalfFovY * 16.0f / 9.0f;
+    library::ClusteredLightCuller culler;
+    if (FAILED(culler.SetProjection(tanHalfFovX, tanHalfFovY, NEAR_Z, FAR_Z)))
+    {
+        return ReportCheck(FALSE, "Light culling, projection");
+    }
+
+    std::mt19937 random(1u);
+    std::uniform_real_distribution<FLOAT> depth(-10.0f, FAR_Z + 10.0f);
+    std::uniform_real_distribution<FLOAT> side(-1.2f, 1.2f);
+    std::uniform_real_distribution<FLOAT> radius(0.5f, 12.0f);
+    std::vector<library::LightSphere> aLights(uNumLights);
+    for (library::LightSphere& light : aLights)
+    {
+        const FLOAT z = depth(random);
+        light.Radius = radius(random);
+        light.Center[0] = side(random) * (std::abs(z) * tanHalfFovX + light.Radius);
+        light.Center[1] = side(random) * (std::abs(z) * tanHalfFovY + light.Radius);
+        light.Center[2] = z;
+    }
+
+    const double scalarTime = TimeBestOf(5u, [&]()
+        {
+            culler.CullScalar(aLights.data(), uNumLights);
+        });
+    const std::vector<UINT> auScalarRanges(culler.GetClusterRanges(), culler.GetClusterRanges() + 2u * library::ClusteredLightCuller::NUM_CLUSTERS);
+    const std::vector<UINT> auScalarIndices(culler.GetLightIndices(), culler.GetLightIndices() + culler.GetNumLightIndices());
+    const UINT uNumScalarDropped = culler.GetNumDroppedLights();
+    const double simdTime = TimeBestOf(5u, [&]()
+        {
+            culler.Cull(aLights.data(), uNumLights);
+        });
+
+    BOOL bPassed = uNumScalarDropped == culler.GetNumDroppedLights() && auScalarIndices.size() == culler.GetNumLightIndices()
+        && std::equal(auScalarRanges.begin(), auScalarRanges.end(), culler.GetClusterRanges())
+        && std::equal(auScalarIndices.begin(), auScalarIndices.end(), culler.GetLightIndices());
+
+    // Lights that may touch the box of each cluster, and the ones that
+    // surely touch the cluster
+    UINT uNumIndices = 0u;
+    UINT uMaxNumDropped = 0u;
+    std::vector<UINT> auTouching;
+    std::vector<BYTE> aSure(uNumLights, 0u);
+    std::vector<FLOAT> aGrid(3u * NUM_GRID_POINTS * NUM_GRID_POINTS * NUM_GRID_POINTS);
+    for (UINT uCluster = 0u; uCluster < library::ClusteredLightCuller::NUM_CLUSTERS; ++uCluster)
+    {
+        const library::AxisAlignedBox box = culler.GetClusterBox(uCluster);
+        const UINT x = uCluster % library::ClusteredLightCuller::NUM_CLUSTERS_X;
+        const UINT y = uCluster / library::ClusteredLightCuller::NUM_CLUSTERS_X % library::ClusteredLightCuller::NUM_CLUSTERS_Y;
+        FLOAT* pGridPoint = aGrid.data();
+        for (UINT i = 0u; i < NUM_GRID_POINTS * NUM_GRID_POINTS * NUM_GRID_POINTS; ++i, pGridPoint += 3)
+        {
+            const FLOAT u = static_cast<FLOAT>(i % NUM_GRID_POINTS) / (NUM_GRID_POINTS - 1u);
+            const FLOAT v = static_cast<FLOAT>(i / NUM_GRID_POINTS % NUM_GRID_POINTS) / (NUM_GRID_POINTS - 1u);
+            const FLOAT w = static_cast<FLOAT>(i / (NUM_GRID_POINTS * NUM_GRID_POINTS)) / (NUM_GRID_POINTS - 1u);
+            pGridPoint[2] = box.Center[2] + (2.0f * w - 1.0f) * box.Extents[2];
+            pGridPoint[0] = (-1.0f + 2.0f * (x + u) / library::ClusteredLightCuller::NUM_CLUSTERS_X) * pGridPoint[2] * tanHalfFovX;
+            pGridPoint[1] = (1.0f - 2.0f * (y + v) / library::ClusteredLightCuller::NUM_CLUSTERS_Y) * pGridPoint[2] * tanHalfFovY;
+        }
+
+        auTouching.clear();
+        UINT uNumSure = 0u;
+        for (UINT uLight = 0u; uLight < uNumLights; ++uLight)
+        {
+            const library::LightSphere& light = aLights[uLight];
+            double distanceSquared = 0.0;
+            for (UINT uAxis = 0u; uAxis < 3u; ++uAxis)
+            {
+                const double d = std::max(std::abs(static_cast<double>(light.Center[uAxis]) - box.Center[uAxis]) - box.Extents[uAxis], 0.0);
+                distanceSquared += d * d;
+            }
+            if (std::sqrt(distanceSquared) > light.Radius + TOUCH_TOLERANCE)
+            {
+                continue;
+            }
+
+            aSure[uLight] = FALSE;
+            for (UINT i = 0u; i < aGrid.size() && !aSure[uLight]; i += 3u)
+            {
+                const double dx = static_cast<double>(aGrid[i]) - light.Center[0];
+                const double dy = static_cast<double>(aGrid[i + 1u]) - light.Center[1];
+                const double dz = static_cast<double>(aGrid[i + 2u]) - light.Center[2];
+                aSure[uLight] = std::sqrt(dx * dx + dy * dy + dz * dz) < light.Radius - TOUCH_TOLERANCE;
+            }
+            uNumSure += aSure[uLight];
+            auTouching.push_back(uLight);
+        }
+
+        const UINT uOffset = culler.GetClusterRanges()[2u * uCluster];
+        const UINT uCount = culler.GetClusterRanges()[2u * uCluster + 1u];
+        const UINT* pLights = culler.GetLightIndices() + uOffset;
+        bPassed &= uOffset == uNumIndices && uCount <= MAX_LIGHTS && std::is_sorted(pLights, pLights + uCount, std::less_equal<UINT>());
+        bPassed &= std::includes(auTouching.begin(), auTouching.end(), pLights, pLights + uCount);
+        if (uCount < MAX_LIGHTS)
+        {
+            bPassed &= std::all_of(auTouching.begin(), auTouching.end(), [&](UINT uLight)
+                {
+                    return !aSure[uLight] || std::binary_search(pLights, pLights + uCount, uLight);
+                });
+        }
+        else
+        {
+            uMaxNumDropped += static_cast<UINT>(auTouching.size()) - MAX_LIGHTS;
+        }
+        bPassed &= uCount == MAX_LIGHTS || uNumSure <= uCount;
+        uNumIndices += uCount;
+    }
+    bPassed &= uNumIndices == culler.GetNumLightIndices() && culler.GetNumDroppedLights() <= uMaxNumDropped;
+
+    ReportCheck(bPassed, "Light culling, %u lights in %u clusters, %u indices, %u dropped", uNumLights, library::ClusteredLightCuller::NUM_CLUSTERS,
+        culler.GetNumLightIndices(), culler.GetNumDroppedLights());
+    std::printf("%-10s %12s %12s %12s\n", "Path", "Time ms", "Mlights/s", "Speedup");
+    std::printf("%-10s %12.3f %12.2f %11.2fx\n", "Scalar", scalarTime, uNumLights / (1000.0 * scalarTime), 1.0);
+    std::printf("%-10s %12.3f %12.2f %11.2fx\n", "SSE", simdTime, uNumLights / (1000.0 * simdTime), scalarTime / simdTime);
+
+    return bPassed;
+}
+
+/*F+F+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+  Function: RunOcclusionChecks
+
+  Summary:  Checks the occlusion culler on a wall drawn with
+            RasterizeBox at the size of the renderer's depth buffer:
+            boxes in front of the wall, the wall itself, boxes sticking
+            out past its silhouette and boxes crossing the near plane
+            stay visible, boxes wholly behind it are culled, the same
+            through Cull as through IsVisible. Then times the drawing of
+            random occluder boxes and the build of the hierarchy
+
+  Args:     UINT uNumOccluders
+              Number of occluder boxes timed
+
+  Returns:  BOOL
+              TRUE if every box got the visibility expected
+-----------------------------------------------------------------F-F*/
+static BOOL RunOcclusionChecks(_In_ UINT uNumOccluders)
+{
+    static constexpr UINT WIDTH = 256u;
+    static constexpr UINT HEIGHT = 128u;
+
+    FLOAT aViewProjection[16];
+    MakeViewProjection(0.1f, 1000.0f, aViewProjection);
+    library::OcclusionCuller culler;
+    if (FAILED(culler.Initialize(WIDTH, HEIGHT)))
+    {
+        return ReportCheck(FALSE, "Occlusion culling");
+    }
+
+    // A wall 20 units wide and high, 19 to 21 units ahead of the camera
+    const library::AxisAlignedBox wall = { .Center = { 0.0f, 0.0f, 20.0f }, .Extents = { 10.0f, 10.0f, 1.0f } };
+    culler.BeginFrame();
+    BOOL bPassed = culler.RasterizeBox(wall, aViewProjection) > 0u;
+    culler.BuildHierarchy();
+
+    static constexpr struct
+    {
+        library::AxisAlignedBox Box;
+        BOOL bVisible;
+    } CASES[] =
+    {
+        { { .Center = { 0.0f, 0.0f, 10.0f }, .Extents = { 1.0f, 1.0f, 1.0f } }, TRUE },      // In front
+        { { .Center = { 3.0f, -2.0f, 15.0f }, .Extents = { 4.0f, 4.0f, 2.0f } }, TRUE },     // In front, larger
+        { { .Center = { 0.0f, 0.0f, 20.0f }, .Extents = { 10.0f, 10.0f, 1.0f } }, TRUE },    // The wall
+        { { .Center = { 0.0f, 0.0f, 40.0f }, .Extents = { 2.0f, 2.0f, 2.0f } }, FALSE },     // Behind
+        { { .Center = { -6.0f, 5.0f, 60.0f }, .Extents = { 8.0f, 8.0f, 8.0f } }, FALSE },    // Behind, larger
+        { { .Center = { 0.0f, 0.0f, 22.5f }, .Extents = { 1.0f, 1.0f, 0.5f } }, FALSE },     // Just behind
+        { { .Center = { 25.0f, 0.0f, 40.0f }, .Extents = { 8.0f, 2.0f, 2.0f } }, TRUE },     // Partly hidden, out on the right
+        { { .Center = { 0.0f, -20.0f, 40.0f }, .Extents = { 2.0f, 4.0f, 2.0f } }, TRUE },    // Partly hidden, out below
+        { { .Center = { 0.0f, 0.0f, 0.0f }, .Extents = { 1.0f, 1.0f, 1.0f } }, TRUE },       // Crossing the near plane
+    };
+
+    library::BoundingBoxArray boxes;
+    for (const auto& testCase : CASES)
+    {
+        bPassed &= culler.IsVisible(testCase.Box, aViewProjection) == testCase.bVisible;
+        boxes.Add(testCase.Box);
+    }
+
+    std::vector<BYTE> aVisible(ARRAYSIZE(CASES), 1u);
+    UINT uNumExpectedVisible = 0u;
+    const UINT uNumVisible = culler.Cull(boxes, aViewProjection, aVisible.data());
+    for (UINT i = 0u; i < ARRAYSIZE(CASES); ++i)
+    {
+        bPassed &= (aVisible[i] != 0u) == CASES[i].bVisible;
+        uNumExpectedVisible += CASES[i].bVisible ? 1u : 0u;
+    }
+    bPassed &= uNumVisible == uNumExpectedVisible;
+
+    // Occluders spread over the view as voxels of a landscape would be
+    std::mt19937 random(1u);
+    std::uniform_real_distribution<FLOAT> lateral(-1.0f, 1.0f);
+    std::uniform_real_distribution<FLOAT> distance(5.0f, 200.0f);
+    std::vector<library::AxisAlignedBox> aOccluders(uNumOccluders);
+    for (library::AxisAlignedBox& occluder : aOccluders)
+    {
+        const FLOAT z = distance(random);
+        occluder = { .Center = { lateral(random) * z, lateral(random) * 0.5f * z, z }, .Extents = { 1.0f, 1.0f, 1.0f } };
+    }
+
+    UINT uNumTriangles = 0u;
+    const double time = TimeBestOf(5u, [&]()
+        {
+            culler.BeginFrame();
+            for (const library::AxisAlignedBox& occluder : aOccluders)
+            {
+                culler.RasterizeBox(occluder, aViewProjection);
+            }
+            culler.BuildHierarchy();
+            uNumTriangles = culler.GetNumRasterizedTriangles();
+        });
+
+    ReportCheck(bPassed, "Occlusion culling, %u boxes around a wall at %ux%u", static_cast<UINT>(ARRAYSIZE(CASES)), WIDTH, HEIGHT);
+    std::printf("%u occluder boxes, %u triangles in %.3f ms, %.1f Mtriangles/s\n", uNumOccluders, uNumTriangles, time,
+        uNumTriangles / (1000.0 * time));
+
+    return bPassed;
+}
+
+/*F+F+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+  Function: MakeRandomImage
+
+  Summary:  Returns an image of random 8-bit RGBA texels, its full
+            resolution mip only
+
+  Args:     UINT uWidth
+              Width of the image
+            UINT uHeight
+              Height of the image
+            UINT uSeed
+              Seed of the texels
+
+  Returns:  library::DecodedImage
+              Image to generate the mips of
+-----------------------------------------------------------------F-F*/
+static library::DecodedImage MakeRandomImage(_In_ UINT uWidth, _In_ UINT uHeight, _In_ UINT uSeed)
+{
+    std::mt19937 random(uSeed);
+    library::DecodedMip base =
+    {
+        .uWidth = uWidth,
+        .uHeight = uHeight,
+        .uRowPitch = uWidth * 4u,
+        .aData = std::vector<BYTE>(static_cast<size_t>(uWidth) * uHeight * 4u)
+    };
+    for (BYTE& uValue : base.aData)
+    {
+        uValue = static_cast<BYTE>(random() >> 24u);
+    }
+
+    library::DecodedImage image;
+    image.aMips.push_back(std::move(base));
+
+    return image;
+}
+
+/*F+F+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+  Function: RunMipBenchmark
+
+  Summary:  Checks that the AVX2 mip kernels give the bits of the
+            scalar ones, on random RGBA8 images, plain, sRGB and normal
+            maps, of odd and even sizes, comparing every mip of the
+            chain. Then times both kernels on a large sRGB image.
+            Passes without checking on CPUs without AVX2
+
+  Args:     UINT uNumThreads
+              Threads of the mip generators
+
+  Returns:  BOOL
+              TRUE if both kernels gave the same mips
+-----------------------------------------------------------------F-F*/
+static BOOL RunMipBenchmark(_In_ UINT uNumThreads)
+{
+    library::MipGenerator scalarGenerator(uNumThreads);
+    library::MipGenerator avx2Generator(uNumThreads);
+    scalarGenerator.SetKernel(library::eMipKernel::SCALAR);
+    if (FAILED(avx2Generator.SetKernel(library::eMipKernel::AVX2)))
+    {
+        std::printf("\nMip generation skipped, the CPU runs no AVX2\n");
+        return TRUE;
+    }
+
+    static constexpr UINT SIZES[][2] = { { 1023u, 517u }, { 255u, 255u }, { 77u, 1u }, { 1u, 33u }, { 3u, 5u }, { 256u, 128u } };
+    static constexpr struct
+    {
+        library::eMipFormat Format;
+        BOOL bNormalMap;
+    } VARIANTS[] =
+    {
+        { library::eMipFormat::RGBA8_UNORM, FALSE },
+        { library::eMipFormat::RGBA8_UNORM_SRGB, FALSE },
+        { library::eMipFormat::RGBA8_UNORM, TRUE },
+    };
+
+    BOOL bPassed = TRUE;
+    UINT uNumMips = 0u;
+    UINT uSeed = 1u;
+    for (const auto& variant : VARIANTS)
+    {
+        for (const UINT* auSize : SIZES)
+        {
+            library::DecodedImage scalarImage = MakeRandomImage(auSize[0], auSize[1], uSeed++);
+            library::DecodedImage avx2Image = scalarImage;
+            if (FAILED(scalarGenerator.Generate(scalarImage, variant.Format, variant.bNormalMap))
+                || FAILED(avx2Generator.Generate(avx2Image, variant.Format, variant.bNormalMap))
+                || scalarImage.aMips.size() != avx2Image.aMips.size())
+            {
+                bPassed = FALSE;
+                continue;
+            }
+
+            for (size_t i = 0u; i < scalarImage.aMips.size(); ++i)
+            {
+                const library::DecodedMip& scalarMip = scalarImage.aMips[i];
+                const library::DecodedMip& avx2Mip = avx2Image.aMips[i];
+                bPassed &= scalarMip.uWidth == avx2Mip.uWidth && scalarMip.uHeight == avx2Mip.uHeight && scalarMip.aData.size() == avx2Mip.aData.size()
+                    && std::memcmp(scalarMip.aData.data(), avx2Mip.aData.data(), scalarMip.aData.size()) == 0;
+            }
+            uNumMips += static_cast<UINT>(scalarImage.aMips.size());
+        }
+    }
+    ReportCheck(bPassed, "Mip generation, AVX2 against scalar on %u mips", uNumMips);
+
+    // Generating keeps the full resolution mip and replaces the others, every run starts from the same image
+    library::DecodedImage image = MakeRandomImage(MIP_TIMING_SIZE, MIP_TIMING_SIZE, uSeed);
+    std::printf("%-10s %12s %12s %12s\n", "Kernels", "Time ms", "MP/s", "Speedup");
+    double scalarTime = 0.0;
+    for (const library::MipGenerator* pGenerator : { &scalarGenerator, &avx2Generator })
+    {
+        const double bestTime = TimeBestOf(3u, [pGenerator, &image]()
+            {
+                pGenerator->Generate(image, library::eMipFormat::RGBA8_UNORM_SRGB, FALSE);
+            });
+        scalarTime = (pGenerator == &scalarGenerator) ? bestTime : scalarTime;
+        std::printf("%-10s %12.2f %12.1f %11.2fx\n", pGenerator == &scalarGenerator ? "Scalar" : "AVX2", bestTime,
+            static_cast<double>(MIP_TIMING_SIZE) * MIP_TIMING_SIZE / (1000.0 * bestTime), scalarTime / bestTime);
+    }
+
+    return bPassed;
+}
+
+/*F+F+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+  Function: GetCascadeOrigin
+
+  Summary:  Returns the light space center a cascade was snapped to,
+            read back from its orthographic projection
+
+  Args:     const library::ShadowCascades& cascades
+              Cascades fitted around a camera
+            UINT uCascade
+              Index of the cascade
+            FLOAT* aOrigin
+              Receives x and y of the center
+
+  Modifies: [aOrigin].
+-----------------------------------------------------------------F-F*/
+static void GetCascadeOrigin(_In_ const library::ShadowCascades& cascades, _In_ UINT uCascade, _Out_writes_(2) FLOAT* aOrigin)
+{
+    const FLOAT* aProjection = cascades.GetProjection(uCascade);
+    aOrigin[0] = -aProjection[12] / aProjection[0];
+    aOrigin[1] = -aProjection[13] / aProjection[5];
+}
+
+/*F+F+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+  Function: RunCascadeChecks
+
+  Summary:  Checks the shadow cascades. The splits of every number of
+            cascades and a few blends increase from the near plane to
+            the shadow distance and follow the blend of the logarithmic
+            and uniform splits. Then the camera is moved across the
+            light a sixteenth of a texel at a time over four texels of
+            every cascade: the snapped origin of the cascade must stay
+            put between whole texels and only ever jump by one
+
+  Returns:  BOOL
+              TRUE if every check passed
+-----------------------------------------------------------------F-F*/
+static BOOL RunCascadeChecks()
+{
+    static constexpr FLOAT SPLIT_LAMBDAS[] = { 0.0f, 0.5f, 0.75f, 1.0f };
+    static constexpr UINT RESOLUTION = 2048u;
+    static constexpr UINT STEPS_PER_TEXEL = 16u;
+    static constexpr UINT NUM_TEXELS = 4u;
+
+    const FLOAT nearZ = 0.1f;
+    const FLOAT shadowDistance = 200.0f;
+    BOOL bPassed = TRUE;
+    UINT uNumLayouts = 0u;
+    for (FLOAT splitLambda : SPLIT_LAMBDAS)
+    {
+        for (UINT uNumSplits = 1u; uNumSplits <= library::ShadowCascades::MAX_CASCADES; ++uNumSplits)
+        {
+            FLOAT aSplits[library::ShadowCascades::MAX_CASCADES];
+            library::ShadowCascades::ComputeSplits(nearZ, shadowDistance, splitLambda, uNumSplits, aSplits);
+
+            FLOAT previousSplit = nearZ;
+            for (UINT i = 0u; i < uNumSplits; ++i)
+            {
+                const double fraction = static_cast<double>(i + 1u) / uNumSplits;
+                const double expected = splitLambda * nearZ * std::pow(static_cast<double>(shadowDistance) / nearZ, fraction)
+                    + (1.0 - splitLambda) * (nearZ + (static_cast<double>(shadowDistance) - nearZ) * fraction);
+                bPassed &= aSplits[i] > previousSplit && std::fabs(aSplits[i] - expected) <= 1e-5 * expected;
+                previousSplit = aSplits[i];
+            }
+            bPassed &= aSplits[uNumSplits - 1u] == shadowDistance;
+            ++uNumLayouts;
+        }
+    }
+
+    library::ShadowCascades cascades;
+    if (FAILED(cascades.SetProjection(1.0f, 0.5625f, nearZ, shadowDistance, 0.75f, library::ShadowCascades::MAX_CASCADES, RESOLUTION, 50.0f)))
+    {
+        return FALSE;
+    }
+
+    const FLOAT aLightDirection[3] = { 0.3f, -1.0f, 0.2f };
+    const FLOAT aPosition[3] = { 12.3f, 4.5f, -7.8f };
+    FLOAT aCameraWorld[16] =
+    {
+        1.0f, 0.0f, 0.0f, 0.0f,
+        0.0f, 1.0f, 0.0f, 0.0f,
+        0.0f, 0.0f, 1.0f, 0.0f,
+        aPosition[0], aPosition[1], aPosition[2], 1.0f,
+    };
+    cascades.Update(aCameraWorld, aLightDirection);
+
+    // The x axis of the light in the world, the first column of its view
+    const FLOAT* aView = cascades.GetView();
+    const FLOAT aLightX[3] = { aView[0], aView[4], aView[8] };
+    for (UINT uCascade = 0u; uCascade < cascades.GetNumCascades(); ++uCascade)
+    {
+        const FLOAT texelSize = 2.0f * cascades.GetRadius(uCascade) / RESOLUTION;
+        UINT uNumJumps = 0u;
+        FLOAT aPreviousOrigin[2];
+        for (UINT uStep = 0u; uStep <= NUM_TEXELS * STEPS_PER_TEXEL; ++uStep)
+        {
+            const FLOAT offset = texelSize * static_cast<FLOAT>(uStep) / STEPS_PER_TEXEL;
+            for (UINT uAxis = 0u; uAxis < 3u; ++uAxis)
+            {
+                aCameraWorld[12u + uAxis] = aPosition[uAxis] + aLightX[uAxis] * offset;
+            }
+            cascades.Update(aCameraWorld, aLightDirection);
+
+            FLOAT aOrigin[2];
+            GetCascadeOrigin(cascades, uCascade, aOrigin);
+            if (uStep > 0u && (aOrigin[0] != aPreviousOrigin[0] || aOrigin[1] != aPreviousOrigin[1]))
+            {
+                const FLOAT jump = std::fabs(aOrigin[0] - aPreviousOrigin[0]) + std::fabs(aOrigin[1] - aPreviousOrigin[1]);
+                bPassed &= std::fabs(jump - texelSize) <= 0.01f * texelSize;
+                ++uNumJumps;
+            }
+            aPreviousOrigin[0] = aOrigin[0];
+            aPreviousOrigin[1] = aOrigin[1];
+        }
+        bPassed &= uNumJumps >= NUM_TEXELS - 1u && uNumJumps <= NUM_TEXELS + 1u;
+    }
+
+    return ReportCheck(bPassed, "Shadow cascades, splits of %u layouts and snapping of %u cascades", uNumLayouts, cascades.GetNumCascades());
+}
+
+/*F+F+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+  Function: RunFrameTimerChecks
+
+  Summary:  Checks the frame timer on a clock advanced by scripted
+            frame times, multiples of a sixteenth of a power of two
+            step so the expected steps and alphas are exact: the steps
+            of every frame and the alpha left over a long run, a stall
+            clamped to the most steps a frame may run with the rest
+            dropped and not caught up later, and the limiter waiting
+            until the end of the frame period with every strategy
+
+  Returns:  BOOL
+              TRUE if every check passed
+-----------------------------------------------------------------F-F*/
+static BOOL RunFrameTimerChecks()
+{
+    static constexpr FLOAT TIMESTEP = 1.0f / 64.0f;
+    static constexpr UINT SUBSTEPS = 16u;
+    static constexpr UINT MAX_STEPS_PER_FRAME = 4u;
+    static constexpr UINT NUM_FRAMES = 10000u;
+
+    std::unique_ptr<ManualClock> pClock = std::make_unique<ManualClock>();
+    ManualClock& clock = *pClock;
+    library::FrameTimer frameTimer(std::move(pClock));
+    frameTimer.SetTimestep(TIMESTEP);
+    frameTimer.SetMaxStepsPerFrame(MAX_STEPS_PER_FRAME);
+    frameTimer.Reset();
+
+    // Frames of zero to a little over two steps, never enough to be clamped
+    BOOL bPassed = TRUE;
+    std::mt19937 random(1u);
+    UINT64 uNumSubsteps = 0u;
+    UINT64 uNumSteps = 0u;
+    for (UINT uFrame = 0u; uFrame < NUM_FRAMES; ++uFrame)
+    {
+        const UINT uFrameSubsteps = random() % (2u * SUBSTEPS + 8u);
+        clock.Advance(static_cast<double>(TIMESTEP) * uFrameSubsteps / SUBSTEPS);
+        uNumSubsteps += uFrameSubsteps;
+
+        const UINT64 uExpectedSteps = uNumSubsteps / SUBSTEPS - uNumSteps;
+        const UINT uSteps = frameTimer.Advance();
+        bPassed &= uSteps == uExpectedSteps;
+        bPassed &= frameTimer.GetAlpha() == static_cast<FLOAT>(uNumSubsteps % SUBSTEPS) / SUBSTEPS;
+        uNumSteps += uSteps;
+    }
+    library::FrameTimerStatistics statistics = frameTimer.GetStatistics();
+    bPassed &= statistics.uNumFrames == NUM_FRAMES && statistics.uNumSteps == uNumSteps && statistics.uNumDroppedSteps == 0u;
+
+    // A stall of a hundred and a half steps runs the most steps and drops the rest, the half stays
+    frameTimer.Reset();
+    clock.Advance(static_cast<double>(TIMESTEP) * 100.5);
+    bPassed &= frameTimer.Advance() == MAX_STEPS_PER_FRAME;
+    bPassed &= frameTimer.GetAlpha() == 0.5f;
+    clock.Advance(static_cast<double>(TIMESTEP));
+    bPassed &= frameTimer.Advance() == 1u;
+    bPassed &= frameTimer.GetAlpha() == 0.5f;
+    statistics = frameTimer.GetStatistics();
+    bPassed &= statistics.uNumSteps == MAX_STEPS_PER_FRAME + 1u && statistics.uNumDroppedSteps == 100u - MAX_STEPS_PER_FRAME;
+
+    // The limiter waits out the rest of the period after the frame started, a yield late at most
+    frameTimer.SetFrameLimit(64.0f);
+    for (UINT uStrategy = 0u; uStrategy < static_cast<UINT>(library::eSleepStrategy::COUNT); ++uStrategy)
+    {
+        frameTimer.SetSleepStrategy(static_cast<library::eSleepStrategy>(uStrategy));
+        frameTimer.Advance();
+        const double frameEnd = clock.GetTime() + 1.0 / 64.0;
+        clock.Advance(1.0 / 256.0);
+        frameTimer.WaitForNextFrame();
+        bPassed &= clock.GetTime() >= frameEnd && clock.GetTime() < frameEnd + ManualClock::YIELD_TICK;
+    }
+
+    return ReportCheck(bPassed, "Frame timer, %u scripted frames, a stall and %u sleep strategies", NUM_FRAMES,
+        static_cast<UINT>(library::eSleepStrategy::COUNT));
+}
+
+/*F+F+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+  Function: RunPackingChecks
+
+  Summary:  Checks the rectangle packer on random images padded the way
+            the texture atlas pads them, with a border around each and
+            rounded up to the alignment. The footprints must lie inside
+            their layer at aligned positions without overlapping, so
+            the images inside keep two borders apart. A set with an
+            empty or oversize rectangle must fail without placing
+            anything, and a rectangle of the layer size must fill one
+
+  Returns:  BOOL
+              TRUE if every check passed
+-----------------------------------------------------------------F-F*/
+static BOOL RunPackingChecks()
+{
+    static constexpr UINT LAYER_SIZE = 1024u;
+    static constexpr UINT BORDER = 8u;
+    static constexpr UINT ALIGNMENT = 16u;
+    static constexpr UINT NUM_RECTANGLES = 400u;
+    static constexpr UINT NUM_SETS = 3u;
+
+    BOOL bPassed = TRUE;
+    UINT uNumLayers = 0u;
+    FLOAT occupancy = 0.0f;
+    std::mt19937 random(1u);
+    std::uniform_int_distribution<UINT> size(1u, 300u);
+    for (UINT uSet = 0u; uSet < NUM_SETS; ++uSet)
+    {
+        std::vector<library::PackedRectangle> aImages(NUM_RECTANGLES);
+        std::vector<library::PackedRectangle> aFootprints(NUM_RECTANGLES);
+        for (UINT i = 0u; i < NUM_RECTANGLES; ++i)
+        {
+            aImages[i] = { .uWidth = size(random), .uHeight = size(random), .uX = 0u, .uY = 0u, .uLayer = 0u };
+            aFootprints[i] =
+            {
+                .uWidth = (aImages[i].uWidth + 2u * BORDER + ALIGNMENT - 1u) & ~(ALIGNMENT - 1u),
+                .uHeight = (aImages[i].uHeight + 2u * BORDER + ALIGNMENT - 1u) & ~(ALIGNMENT - 1u),
+                .uX = 0u,
+                .uY = 0u,
+                .uLayer = 0u
+            };
+        }
+
+        library::RectanglePacker packer(LAYER_SIZE, LAYER_SIZE);
+        if (FAILED(packer.Pack(aFootprints)))
+        {
+            bPassed = FALSE;
+            continue;
+        }
+        uNumLayers += packer.GetNumLayers();
+        occupancy += packer.GetOccupancy() / NUM_SETS;
+
+        for (UINT i = 0u; i < NUM_RECTANGLES; ++i)
+        {
+            const library::PackedRectangle& footprint = aFootprints[i];
+            bPassed &= footprint.uLayer < packer.GetNumLayers() && footprint.uX % ALIGNMENT == 0u && footprint.uY % ALIGNMENT == 0u
+                && footprint.uX + footprint.uWidth <= LAYER_SIZE && footprint.uY + footprint.uHeight <= LAYER_SIZE;
+            aImages[i].uX = footprint.uX + BORDER;
+            aImages[i].uY = footprint.uY + BORDER;
+            aImages[i].uLayer = footprint.uLayer;
+        }
+
+        for (UINT i = 0u; i < NUM_RECTANGLES; ++i)
+        {
+            for (UINT j = i + 1u; j < NUM_RECTANGLES; ++j)
+            {
+                const library::PackedRectangle& a = aFootprints[i];
+                const library::PackedRectangle& b = aFootprints[j];
+                bPassed &= a.uLayer != b.uLayer || a.uX + a.uWidth <= b.uX || b.uX + b.uWidth <= a.uX || a.uY + a.uHeight <= b.uY
+                    || b.uY + b.uHeight <= a.uY;
+
+                const library::PackedRectangle& imageA = aImages[i];
+                const library::PackedRectangle& imageB = aImages[j];
+                bPassed &= imageA.uLayer != imageB.uLayer || imageA.uX + imageA.uWidth + 2u * BORDER <= imageB.uX
+                    || imageB.uX + imageB.uWidth + 2u * BORDER <= imageA.uX || imageA.uY + imageA.uHeight + 2u * BORDER <= imageB.uY
+                    || imageB.uY + imageB.uHeight + 2u * BORDER <= imageA.uY;
+            }
+        }
+    }
+
+    library::RectanglePacker packer(LAYER_SIZE, LAYER_SIZE);
+    for (const library::PackedRectangle& invalid : { library::PackedRectangle{ .uWidth = LAYER_SIZE + 1u, .uHeight = 16u, .uX = 0u, .uY = 0u, .uLayer = 0u },
+        library::PackedRectangle{ .uWidth = 16u, .uHeight = LAYER_SIZE + 1u, .uX = 0u, .uY = 0u, .uLayer = 0u },
+        library::PackedRectangle{ .uWidth = 0u, .uHeight = 16u, .uX = 0u, .uY = 0u, .uLayer = 0u } })
+    {
+        std::vector<library::PackedRectangle> aRectangles(8u, library::PackedRectangle{ .uWidth = 64u, .uHeight = 64u, .uX = 0u, .uY = 0u, .uLayer = 0u });
+        aRectangles.push_back(invalid);
+        bPassed &= packer.Pack(aRectangles) == E_INVALIDARG && packer.GetNumLayers() == 0u;
+        bPassed &= std::all_of(aRectangles.begin(), aRectangles.end() - 1, [](const library::PackedRectangle& rectangle)
+            {
+                return rectangle.uX == 0u && rectangle.uY == 0u && rectangle.uLayer == 0u;
+            });
+    }
+
+    std::vector<library::PackedRectangle> aWhole(2u, library::PackedRectangle{ .uWidth = LAYER_SIZE, .uHeight = LAYER_SIZE, .uX = 0u, .uY = 0u, .uLayer = 0u });
+    bPassed &= SUCCEEDED(packer.Pack(aWhole)) && packer.GetNumLayers() == 2u && packer.GetOccupancy() == 1.0f && aWhole[1].uLayer == 1u;
+
+    return ReportCheck(bPassed, "Rectangle packing, %u sets of %u padded rectangles in %u layers, %.0f%% occupancy", NUM_SETS, NUM_RECTANGLES,
+        uNumLayers, 100.0f * occupancy);
+}
+
+/*F+F+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+  Function: RunPermutationBenchmark
+
+  Summary:  Times the lookup of the shader permutation a draw uses,
+            over the whole key space of shader and object feature
+            sets. Every feature set a shader can declare gets a table
+            of slots, filled where a permutation is compiled like the
+            shader arrays. Checks each key lands on a compiled
+            permutation with exactly the features the object and the
+            shader share, and the tables hold one permutation per
+            subset of features
+
+  Args:     UINT uNumLookups
+              Number of draws looked up
+
+  Returns:  BOOL
+              TRUE if every key found its permutation
+-----------------------------------------------------------------F-F*/
+static BOOL RunPermutationBenchmark(_In_ UINT uNumLookups)
+{
+    static constexpr UINT NUM_FEATURE_SETS = library::MAX_NUM_SHADER_PERMUTATIONS;
+    static constexpr UINT NUM_KEYS = NUM_FEATURE_SETS * NUM_FEATURE_SETS;
+    static constexpr UINT NO_PERMUTATION = 0xFFFFFFFFu;
+
+    BOOL bPassed = TRUE;
+    std::vector<UINT> auSlots(NUM_KEYS, NO_PERMUTATION);
+    UINT uNumPermutations = 0u;
+    UINT uExpectedNumPermutations = 0u;
+    for (UINT uShaderFeatures = 0u; uShaderFeatures < NUM_FEATURE_SETS; ++uShaderFeatures)
+    {
+        for (UINT uPermutation = 0u; uPermutation < NUM_FEATURE_SETS; ++uPermutation)
+        {
+            if (library::IsShaderPermutation(uShaderFeatures, uPermutation))
+            {
+                auSlots[uShaderFeatures * NUM_FEATURE_SETS + uPermutation] = uNumPermutations++;
+            }
+        }
+        uExpectedNumPermutations += 1u << std::popcount(uShaderFeatures);
+    }
+    bPassed &= uNumPermutations == uExpectedNumPermutations;
+
+    std::vector<UINT> auKeySlots(NUM_KEYS, NO_PERMUTATION);
+    for (UINT uKey = 0u; uKey < NUM_KEYS; ++uKey)
+    {
+        const UINT uShaderFeatures = uKey / NUM_FEATURE_SETS;
+        const UINT uFeatures = uKey % NUM_FEATURE_SETS;
+        const UINT uPermutation = library::GetShaderPermutation(uShaderFeatures, uFeatures);
+        const UINT uSlot = auSlots[uShaderFeatures * NUM_FEATURE_SETS + uPermutation];
+        bPassed &= uSlot != NO_PERMUTATION && (uPermutation & ~uFeatures) == 0u && (uShaderFeatures & uFeatures & ~uPermutation) == 0u;
+        auKeySlots[uKey] = uSlot;
+    }
+
+    std::mt19937 random(1u);
+    std::uniform_int_distribution<UINT> key(0u, NUM_KEYS - 1u);
+    std::vector<UINT> auKeys(uNumLookups);
+    UINT64 uExpectedSum = 0u;
+    for (UINT& uKey : auKeys)
+    {
+        uKey = key(random);
+        uExpectedSum += auKeySlots[uKey];
+    }
+
+    const double bestTime = TimeBestOf(5u, [&]()
+        {
+            UINT64 uSum = 0u;
+            for (const UINT uKey : auKeys)
+            {
+                const UINT uShaderFeatures = uKey / NUM_FEATURE_SETS;
+                uSum += auSlots[uShaderFeatures * NUM_FEATURE_SETS + library::GetShaderPermutation(uShaderFeatures, uKey % NUM_FEATURE_SETS)];
+            }
+            bPassed &= uSum == uExpectedSum;
+        });
+
+    ReportCheck(bPassed, "Shader permutations, %u keys, %u permutations", NUM_KEYS, uNumPermutations);
+    std::printf("%u lookups in %.3f ms, %.2f ns per lookup\n", uNumLookups, bestTime, 1.0e6 * bestTime / uNumLookups);
+
+    return bPassed;
+}
+
+/*F+F+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+  Function: RunRingChecks
+
+  Summary:  Checks the ring the renderer hands out constant ranges
+            from, frame after frame of random ranges with the GPU
+            scripted a few fences behind. Every range must be aligned
+            for constant buffer offsets, inside the ring and clear of
+            the ranges of the frames not yet retired, and the ring must
+            wrap back to the front. A range that does not fit while the
+            oldest fence is pending must ask for a discard, the same
+            range must wrap once that fence completed, and a reset must
+            empty the ring and discard again
+
+  Returns:  BOOL
+              TRUE if every check passed
+-----------------------------------------------------------------F-F*/
+static BOOL RunRingChecks()
+{
+    static constexpr UINT CAPACITY = 1u << 16u;
+    static constexpr UINT ALIGNMENT = library::RenderContext::CONSTANT_BUFFER_ALIGNMENT;
+    static constexpr UINT NUM_FRAMES = 4096u;
+    static constexpr UINT FRAME_LATENCY = 2u;
+    static constexpr UINT SMALL_CAPACITY = 4096u;
+
+    struct LiveRange
+    {
+        UINT uOffset;
+        UINT uSize;
+        UINT64 uFenceValue;
+    };
+
+    BOOL bPassed = TRUE;
+    library::RingAllocator ring;
+    ring.Initialize(CAPACITY);
+    std::vector<LiveRange> aLiveRanges;
+    UINT uNumRanges = 0u;
+    UINT uNumWraps = 0u;
+    UINT uNumDiscards = 0u;
+    std::mt19937 random(1u);
+    std::uniform_int_distribution<UINT> size(1u, 3000u);
+    std::uniform_int_distribution<UINT> numFrameRanges(1u, 12u);
+    for (UINT uFrame = 0u; uFrame < NUM_FRAMES; ++uFrame)
+    {
+        const UINT64 uFenceValue = uFrame + 1u;
+        for (UINT i = numFrameRanges(random); i > 0u; --i)
+        {
+            const UINT uSize = size(random);
+            const UINT uHead = ring.GetHead();
+            UINT uOffset = 0u;
+            BOOL bDiscard = FALSE;
+            bPassed &= ring.Allocate(uSize, ALIGNMENT, &uOffset, &bDiscard);
+            bPassed &= uOffset % ALIGNMENT == 0u && uOffset + uSize <= CAPACITY;
+            if (bDiscard)
+            {
+                aLiveRanges.clear();
+                ++uNumDiscards;
+            }
+            else if (uOffset < uHead)
+            {
+                ++uNumWraps;
+            }
+
+            bPassed &= std::none_of(aLiveRanges.begin(), aLiveRanges.end(), [uOffset, uSize](const LiveRange& range)
+                {
+                    return uOffset < range.uOffset + range.uSize && range.uOffset < uOffset + uSize;
+                });
+            aLiveRanges.push_back({ .uOffset = uOffset, .uSize = uSize, .uFenceValue = uFenceValue });
+            ++uNumRanges;
+        }
+
+        ring.EndFrame(uFenceValue);
+        if (uFenceValue > FRAME_LATENCY)
+        {
+            const UINT64 uCompletedFenceValue = uFenceValue - FRAME_LATENCY;
+            ring.RetireFrames(uCompletedFenceValue);
+            std::erase_if(aLiveRanges, [uCompletedFenceValue](const LiveRange& range)
+                {
+                    return range.uFenceValue <= uCompletedFenceValue;
+                });
+        }
+        bPassed &= ring.GetNumUsed() <= CAPACITY && ring.GetNumFramesInFlight() <= FRAME_LATENCY;
+    }
+    bPassed &= uNumWraps > 0u;
+
+    // The front of a small ring is held by a pending fence, then
+    // released
+    library::RingAllocator smallRing;
+    smallRing.Initialize(SMALL_CAPACITY);
+    UINT uOffset = 0u;
+    BOOL bDiscard = FALSE;
+    bPassed &= smallRing.Allocate(3000u, ALIGNMENT, &uOffset, &bDiscard) && uOffset == 0u && bDiscard;
+    smallRing.EndFrame(1u);
+    bPassed &= smallRing.Allocate(3000u, ALIGNMENT, &uOffset, &bDiscard) && uOffset == 0u && bDiscard
+        && smallRing.GetNumFramesInFlight() == 0u;
+    smallRing.EndFrame(2u);
+    bPassed &= smallRing.Allocate(512u, ALIGNMENT, &uOffset, &bDiscard) && uOffset == 3072u && !bDiscard;
+    smallRing.EndFrame(3u);
+    smallRing.RetireFrames(2u);
+    bPassed &= smallRing.Allocate(3000u, ALIGNMENT, &uOffset, &bDiscard) && uOffset == 0u && !bDiscard
+        && smallRing.GetNumFramesInFlight() == 1u;
+    bPassed &= !smallRing.Allocate(SMALL_CAPACITY + 1u, ALIGNMENT, &uOffset, &bDiscard);
+
+    smallRing.Reset();
+    bPassed &= smallRing.GetNumUsed() == 0u && smallRing.GetNumFramesInFlight() == 0u;
+    bPassed &= smallRing.Allocate(16u, ALIGNMENT, &uOffset, &bDiscard) && uOffset == 0u && bDiscard;
+
+    return ReportCheck(bPassed, "Constant ring, %u ranges in %u frames %u fences behind, %u wraps and %u discards", uNumRanges,
+        NUM_FRAMES, FRAME_LATENCY, uNumWraps, uNumDiscards);
+}
+
+/*F+F+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+  Function: RunStreamingChecks
+
+  Summary:  Checks the texture streaming queue on a fake loader that
+            makes mip chains of 16 to 512 texels on worker threads, one
+            of them failing and one canceled. Every texture must show
+            its placeholder until it decoded, then start on the tail of
+            its mip chain. The uploads of a frame must fit in the
+            budget unless a single mip larger than it goes alone, every
+            stream must gain its mips one at a time from coarse to fine,
+            the coarsest stream first, and every texture that decoded
+            must end up resident with its image freed
+
+  Returns:  BOOL
+              TRUE if every check passed
+-----------------------------------------------------------------F-F*/
+static BOOL RunStreamingChecks()
+{
+    static constexpr UINT NUM_TEXTURES = 24u;
+    static constexpr UINT NUM_THREADS = 2u;
+    static constexpr UINT64 UPLOAD_BUDGET = 256u * 1024u;
+    static constexpr UINT64 MIP_TAIL_SIZE = 4096u;
+    static constexpr UINT MAX_FRAMES = 10000u;
+    static constexpr UINT FAILED_TEXTURE = 5u;
+    static constexpr UINT CANCELED_TEXTURE = 7u;
+    static constexpr UINT NOT_DECODED = ~0u;
+
+    BOOL bPassed = TRUE;
+    library::TextureStreamingQueue queue;
+    bPassed &= SUCCEEDED(queue.Initialize(NUM_THREADS, UPLOAD_BUDGET, MIP_TAIL_SIZE));
+
+    std::vector<UINT> auStreams(NUM_TEXTURES);
+    for (UINT uTexture = 0u; uTexture < NUM_TEXTURES; ++uTexture)
+    {
+        auStreams[uTexture] = queue.Enqueue([uTexture](library::DecodedImage& image)
+            {
+                if (uTexture == FAILED_TEXTURE)
+                {
+                    return E_FAIL;
+                }
+
+                // RGBA mips down to one texel, half as high as wide for every other texture
+                UINT uWidth = 16u << (uTexture % 6u);
+                UINT uHeight = uWidth >> (uTexture % 2u);
+                for (;;)
+                {
+                    image.aMips.push_back(
+                        {
+                            .uWidth = uWidth,
+                            .uHeight = uHeight,
+                            .uRowPitch = uWidth * 4u,
+                            .aData = std::vector<BYTE>(static_cast<size_t>(uWidth) * uHeight * 4u, static_cast<BYTE>(image.aMips.size()))
+                        });
+                    if (uWidth == 1u && uHeight == 1u)
+                    {
+                        return S_OK;
+                    }
+                    uWidth = std::max(uWidth / 2u, 1u);
+                    uHeight = std::max(uHeight / 2u, 1u);
+                }
+            });
+    }
+    queue.Cancel(auStreams[CANCELED_TEXTURE]);
+    bPassed &= queue.GetStatus(auStreams[CANCELED_TEXTURE]) == E_ABORT;
+
+    // Finest resident mip of every stream as the uploads so far leave it
+    const UINT uNumStreams = *std::max_element(auStreams.begin(), auStreams.end()) + 1u;
+    std::vector<UINT> auResidentMips(uNumStreams, NOT_DECODED);
+    std::vector<BOOL> abDecoded(uNumStreams, FALSE);
+    std::vector<UINT> auDecoded;
+    std::vector<library::MipUpload> aUploads;
+    UINT uNumFinished = 0u;
+    UINT uNumFailed = 0u;
+    UINT uNumOversizeUploads = 0u;
+    UINT64 uExpectedBytes = 0u;
+    UINT64 uBytesUploaded = 0u;
+    UINT uFrame = 0u;
+    for (; uFrame < MAX_FRAMES && uNumFinished < NUM_TEXTURES - 1u; ++uFrame)
+    {
+        for (UINT uStream : auStreams)
+        {
+            bPassed &= uStream == auStreams[CANCELED_TEXTURE] || abDecoded[uStream] || queue.GetStatus(uStream) == E_PENDING;
+        }
+
+        queue.BeginFrame(auDecoded);
+        UINT64 uTailBytes = 0u;
+        for (UINT uStream : auDecoded)
+        {
+            bPassed &= uStream != auStreams[CANCELED_TEXTURE] && !abDecoded[uStream];
+            abDecoded[uStream] = TRUE;
+            if (uStream == auStreams[FAILED_TEXTURE])
+            {
+                bPassed &= queue.GetStatus(uStream) == E_FAIL;
+                ++uNumFailed;
+                ++uNumFinished;
+                continue;
+            }
+
+            const std::vector<library::DecodedMip>& aMips = queue.GetImage(uStream).aMips;
+            UINT uTail = static_cast<UINT>(aMips.size()) - 1u;
+            while (uTail > 0u && aMips[uTail - 1u].aData.size() <= MIP_TAIL_SIZE)
+            {
+                --uTail;
+            }
+            bPassed &= queue.GetStatus(uStream) == S_OK && queue.GetResidentMip(uStream) == uTail;
+            auResidentMips[uStream] = uTail;
+            for (UINT uMip = 0u; uMip < aMips.size(); ++uMip)
+            {
+                uExpectedBytes += aMips[uMip].aData.size();
+                uTailBytes += (uMip >= uTail) ? aMips[uMip].aData.size() : 0u;
+            }
+            uNumFinished += (uTail == 0u) ? 1u : 0u;
+        }
+
+        queue.Schedule(aUploads);
+        UINT64 uFrameBytes = 0u;
+        for (const library::MipUpload& upload : aUploads)
+        {
+            const UINT uResidentMip = auResidentMips[upload.uStream];
+            bPassed &= uResidentMip != NOT_DECODED && upload.uMip + 1u == uResidentMip;
+            bPassed &= std::none_of(auResidentMips.begin(), auResidentMips.end(), [uResidentMip](UINT uOtherMip)
+                {
+                    return uOtherMip != NOT_DECODED && uOtherMip > uResidentMip;
+                });
+            bPassed &= queue.GetImage(upload.uStream).aMips[upload.uMip].aData[0] == static_cast<BYTE>(upload.uMip);
+
+            uFrameBytes += queue.GetImage(upload.uStream).aMips[upload.uMip].aData.size();
+            auResidentMips[upload.uStream] = upload.uMip;
+            uNumFinished += (upload.uMip == 0u) ? 1u : 0u;
+        }
+        bPassed &= uFrameBytes <= UPLOAD_BUDGET || aUploads.size() == 1u;
+        uNumOversizeUploads += (uFrameBytes > UPLOAD_BUDGET) ? 1u : 0u;
+        uBytesUploaded += uTailBytes + uFrameBytes;
+
+        const library::StreamingStatistics statistics = queue.GetStatistics();
+        bPassed &= statistics.uBytesUploaded == uFrameBytes && statistics.uNumUploads == aUploads.size()
+            && statistics.uTailBytesUploaded == uTailBytes;
+
+        queue.EndFrame();
+        for (UINT uStream : auStreams)
+        {
+            if (uStream != auStreams[FAILED_TEXTURE] && auResidentMips[uStream] == 0u)
+            {
+                bPassed &= queue.IsResident(uStream) && queue.GetResidentMip(uStream) == 0u && queue.GetImage(uStream).aMips.empty();
+            }
+        }
+
+        // Nothing to do until the workers decode more
+        if (auDecoded.empty() && aUploads.empty())
+        {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+    }
+
+    const library::StreamingStatistics statistics = queue.GetStatistics();
+    bPassed &= uNumFinished == NUM_TEXTURES - 1u && uNumFailed == 1u && uNumOversizeUploads > 0u && uBytesUploaded == uExpectedBytes;
+    bPassed &= statistics.uNumResident == NUM_TEXTURES - 2u && statistics.uNumFailed == 1u && statistics.uNumDecoding == 0u
+        && statistics.uNumStreaming == 0u;
+    queue.Shutdown();
+
+    return ReportCheck(bPassed, "Texture streaming, %u textures in %u frames under a %llu KB budget, %u mips over it uploaded alone",
+        NUM_TEXTURES, uFrame, static_cast<unsigned long long>(UPLOAD_BUDGET / 1024u), uNumOversizeUploads);
+}
+
+/*F+F+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+  Function: GetTexturePitch
+
+  Summary:  Works out the row pitch and rows of a mip of the formats
+            the texture file checks write, apart from DDSFile
+
+  Args:     UINT uFormat
+              FORMAT_R8G8B8A8_UNORM or FORMAT_BC1_UNORM
+            UINT uWidth
+              Width of the mip
+            UINT uHeight
+              Height of the mip
+            UINT* puRowPitch
+              Bytes of a row, of 4x4 blocks for BC1
+            UINT* puNumRows
+              Rows of the mip
+
+  Modifies: [puRowPitch, puNumRows].
+-----------------------------------------------------------------F-F*/
+static void GetTexturePitch(_In_ UINT uFormat, _In_ UINT uWidth, _In_ UINT uHeight, _Out_ UINT* puRowPitch, _Out_ UINT* puNumRows)
+{
+    if (uFormat == FORMAT_BC1_UNORM)
+    {
+        *puRowPitch = std::max((uWidth + 3u) / 4u, 1u) * 8u;
+        *puNumRows = std::max((uHeight + 3u) / 4u, 1u);
+        return;
+    }
+
+    *puRowPitch = uWidth * 4u;
+    *puNumRows = uHeight;
+}
+
+/*F+F+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+  Function: MakeDDSFile
+
+  Summary:  Returns the bytes of a DDS file of a 2D texture, its headers
+            followed by its subresources tightly packed, every byte of
+            a subresource its index plus one
+
+  Args:     const library::DDSDescription& description
+              Texture of the file
+
+  Returns:  std::vector<BYTE>
+              Bytes of the file
+-----------------------------------------------------------------F-F*/
+static std::vector<BYTE> MakeDDSFile(_In_ const library::DDSDescription& description)
+{
+    std::vector<BYTE> aFile;
+    library::DDSFile::WriteHeader(description, aFile);
+    for (UINT uSubresource = 0u; uSubresource < description.uArraySize * description.uMipLevels; ++uSubresource)
+    {
+        const UINT uMip = uSubresource % description.uMipLevels;
+        UINT uRowPitch = 0u;
+        UINT uNumRows = 0u;
+        GetTexturePitch(description.uFormat, std::max(description.uWidth >> uMip, 1u), std::max(description.uHeight >> uMip, 1u), &uRowPitch,
+            &uNumRows);
+        aFile.insert(aFile.end(), static_cast<size_t>(uRowPitch) * uNumRows, static_cast<BYTE>(uSubresource + 1u));
+    }
+
+    return aFile;
+}
+
+/*F+F+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+  Function: CheckDDSLayout
+
+  Summary:  Tells whether a parsed DDS file of MakeDDSFile describes its
+            texture and lays out every subresource where it was
+            written, with the pitches of GetTexturePitch
+
+  Args:     const library::DDSFile& file
+              Parsed file
+            const library::DDSDescription& description
+              Texture the file was made of
+            const BYTE* pData
+              First byte of the file parsed
+
+  Returns:  BOOL
+              TRUE if the layout matches
+-----------------------------------------------------------------F-F*/
+static BOOL CheckDDSLayout(_In_ const library::DDSFile& file, _In_ const library::DDSDescription& description, _In_ const BYTE* pData)
+{
+    const library::DDSDescription& parsed = file.GetDescription();
+    BOOL bPassed = parsed.uFormat == description.uFormat && parsed.uWidth == description.uWidth && parsed.uHeight == description.uHeight
+        && parsed.uMipLevels == description.uMipLevels && parsed.uArraySize == description.uArraySize
+        && file.GetNumSubresources() == description.uArraySize * description.uMipLevels;
+
+    UINT64 uOffset = sizeof(UINT) + library::DDSFile::HEADER_SIZE + library::DDSFile::DX10_HEADER_SIZE;
+    for (UINT uSubresource = 0u; bPassed && uSubresource < file.GetNumSubresources(); ++uSubresource)
+    {
+        const library::DDSSubresource& subresource = file.GetSubresource(uSubresource);
+        const UINT uMip = uSubresource % description.uMipLevels;
+        const UINT uWidth = std::max(description.uWidth >> uMip, 1u);
+        const UINT uHeight = std::max(description.uHeight >> uMip, 1u);
+        UINT uRowPitch = 0u;
+        UINT uNumRows = 0u;
+        GetTexturePitch(description.uFormat, uWidth, uHeight, &uRowPitch, &uNumRows);
+
+        const UINT uSlicePitch = uRowPitch * uNumRows;
+        bPassed &= subresource.pData == pData + uOffset && subresource.uRowPitch == uRowPitch && subresource.uSlicePitch == uSlicePitch
+            && subresource.uWidth == uWidth && subresource.uHeight == uHeight && subresource.uDepth == 1u;
+        bPassed &= subresource.pData[0] == static_cast<BYTE>(uSubresource + 1u)
+            && subresource.pData[uSlicePitch - 1u] == static_cast<BYTE>(uSubresource + 1u);
+        uOffset += uSlicePitch;
+    }
+
+    // The data size counts the DX10 header in
+    return bPassed && file.GetDataSize() == uOffset - (sizeof(UINT) + library::DDSFile::HEADER_SIZE);
+}
+
+/*F+F+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+  Function: WriteFileBytes
+
+  Summary:  Writes bytes to a file, replacing it
+
+  Args:     const std::filesystem::path& filePath
+              Path to the file
+            const std::vector<BYTE>& aBytes
+              Bytes to write
+
+  Returns:  BOOL
+              TRUE if every byte was written
+-----------------------------------------------------------------F-F*/
+static BOOL WriteFileBytes(_In_ const std::filesystem::path& filePath, _In_ const std::vector<BYTE>& aBytes)
+{
+    std::ofstream file(filePath, std::ios::binary | std::ios::trunc);
+    file.write(reinterpret_cast<const CHAR*>(aBytes.data()), static_cast<std::streamsize>(aBytes.size()));
+
+    return file.good();
+}
+
+/*F+F+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+  Function: RunTextureFileChecks
+
+  Summary:  Writes a block compressed DDS array and an RGBA DDS with odd
+            sizes to temporary files, maps them and checks that every
+            subresource points where it was written with the expected
+            pitches, the same once packed into a TPAK archive. DDS
+            headers cut short, files that end before their texels and
+            headers whose sizes, mips or array exceed the file or the
+            limits must be rejected, as must truncated archives and
+            entries that reach past their end. Then times parsing a
+            large mapped DDS against reading it into a buffer first,
+            both summing every texel
+
+  Args:     UINT uTimingSize
+              Side of the RGBA DDS of the timing
+
+  Returns:  BOOL
+              TRUE if every check passed
+-----------------------------------------------------------------F-F*/
+static BOOL RunTextureFileChecks(_In_ UINT uTimingSize)
+{
+    static constexpr UINT NUM_TIMING_RUNS = 5u;
+    // Offsets in the file of the header fields made too large
+    static constexpr size_t HEADER_SIZE_OFFSET = 4u;
+    static constexpr size_t WIDTH_OFFSET = 16u;
+    static constexpr size_t MIP_COUNT_OFFSET = 28u;
+    static constexpr size_t ARRAY_SIZE_OFFSET = 140u;
+
+    const library::DDSDescription aDescriptions[] =
+    {
+        {
+            .uFormat = FORMAT_BC1_UNORM, .uDimension = 2u, .uWidth = 64u, .uHeight = 32u, .uDepth = 1u, .uMipLevels = 7u,
+            .uArraySize = 2u, .bCubeMap = FALSE
+        },
+        {
+            .uFormat = FORMAT_R8G8B8A8_UNORM, .uDimension = 2u, .uWidth = 40u, .uHeight = 24u, .uDepth = 1u, .uMipLevels = 6u,
+            .uArraySize = 1u, .bCubeMap = FALSE
+        }
+    };
+    const std::filesystem::path directory = std::filesystem::temp_directory_path() / L"BenchmarkTextureFiles";
+    std::error_code error;
+    std::filesystem::create_directories(directory, error);
+
+    BOOL bPassed = !error;
+    std::vector<std::filesystem::path> aFilePaths;
+    std::vector<std::vector<BYTE>> aaFiles;
+    std::unique_ptr<library::FileMapping> mapping = library::FileMapping::Create();
+    library::DDSFile file;
+    size_t uNumRejected = 0u;
+    for (const library::DDSDescription& description : aDescriptions)
+    {
+        aFilePaths.push_back(directory / (L"Texture" + std::to_wstring(aFilePaths.size()) + L".dds"));
+        aaFiles.push_back(MakeDDSFile(description));
+        const std::vector<BYTE>& aFile = aaFiles.back();
+        bPassed &= WriteFileBytes(aFilePaths.back(), aFile);
+
+        bPassed &= SUCCEEDED(mapping->Open(aFilePaths.back())) && mapping->GetSize() == aFile.size();
+        bPassed &= SUCCEEDED(file.Parse(mapping->GetData(), mapping->GetSize())) && CheckDDSLayout(file, description, mapping->GetData());
+        mapping->Close();
+
+        // Cut short anywhere in the headers or the texels
+        for (UINT64 uSize : { UINT64{ 0u }, UINT64{ 4u }, UINT64{ 127u }, UINT64{ 147u }, static_cast<UINT64>(aFile.size() - 1u) })
+        {
+            bPassed &= FAILED(file.Parse(aFile.data(), uSize)) && file.GetNumSubresources() == 0u;
+            ++uNumRejected;
+        }
+        bPassed &= SUCCEEDED(file.Parse(aFile.data(), aFile.size()));
+
+        // Fields beyond the file or the limits
+        const std::pair<size_t, UINT> aOversizedFields[] =
+        {
+            { HEADER_SIZE_OFFSET, 0x7FFFFFFFu },
+            { WIDTH_OFFSET, 1u << 30u },
+            { MIP_COUNT_OFFSET, library::DDSFile::MAX_MIP_LEVELS + 1u },
+            { ARRAY_SIZE_OFFSET, library::DDSFile::MAX_ARRAY_SIZE + 1u },
+            { ARRAY_SIZE_OFFSET, description.uArraySize + 1u }
+        };
+        for (const auto& [uFieldOffset, uValue] : aOversizedFields)
+        {
+            std::vector<BYTE> aBadFile = aFile;
+            std::memcpy(aBadFile.data() + uFieldOffset, &uValue, sizeof(uValue));
+            bPassed &= FAILED(file.Parse(aBadFile.data(), aBadFile.size())) && file.GetNumSubresources() == 0u;
+            ++uNumRejected;
+        }
+    }
+
+    // The same files packed, each aligned in the archive
+    const std::filesystem::path archivePath = directory / L"Textures.tpak";
+    library::TextureArchive archive;
+    bPassed &= SUCCEEDED(library::TextureArchive::Write(archivePath, aFilePaths)) && SUCCEEDED(archive.Open(archivePath))
+        && archive.GetNumEntries() == static_cast<UINT>(aFilePaths.size());
+    for (size_t i = 0u; i < aFilePaths.size(); ++i)
+    {
+        library::FileRange range = {};
+        bPassed &= archive.Find(aFilePaths[i], &range) && range.uSize == aaFiles[i].size()
+            && reinterpret_cast<uintptr_t>(range.pData) % library::TextureArchive::FILE_ALIGNMENT == 0u;
+        bPassed &= range.pData && SUCCEEDED(file.Parse(range.pData, range.uSize)) && CheckDDSLayout(file, aDescriptions[i], range.pData);
+    }
+    archive.Close();
+
+    // Archives cut short or whose header and entries reach past their end
+    std::vector<BYTE> aArchive(static_cast<size_t>(std::filesystem::file_size(archivePath, error)));
+    {
+        std::ifstream archiveFile(archivePath, std::ios::binary);
+        bPassed &= !error && archiveFile.read(reinterpret_cast<CHAR*>(aArchive.data()), static_cast<std::streamsize>(aArchive.size())).good();
+    }
+    // The magic, the entry count, then the offset, size and name length of the first entry, little-endian
+    struct BadField
+    {
+        size_t uOffset;
+        size_t uSize;
+        UINT64 uValue;
+    };
+    const BadField aBadArchiveFields[] =
+    {
+        { .uOffset = 0u, .uSize = sizeof(UINT), .uValue = 0u },
+        { .uOffset = 8u, .uSize = sizeof(UINT), .uValue = 0xFFFFFFFFu },
+        { .uOffset = library::TextureArchive::HEADER_SIZE, .uSize = sizeof(UINT64), .uValue = aArchive.size() + 1u },
+        { .uOffset = library::TextureArchive::HEADER_SIZE + 8u, .uSize = sizeof(UINT64), .uValue = aArchive.size() },
+        { .uOffset = library::TextureArchive::HEADER_SIZE + 20u, .uSize = sizeof(UINT), .uValue = 0xFFFFFFFFu }
+    };
+    const std::filesystem::path badArchivePath = directory / L"Bad.tpak";
+    for (const BadField& field : aBadArchiveFields)
+    {
+        std::vector<BYTE> aBadArchive = aArchive;
+        std::memcpy(aBadArchive.data() + field.uOffset, &field.uValue, field.uSize);
+        bPassed &= WriteFileBytes(badArchivePath, aBadArchive) && FAILED(archive.Open(badArchivePath)) && archive.GetNumEntries() == 0u;
+        ++uNumRejected;
+    }
+    for (size_t uSize : { size_t{ library::TextureArchive::HEADER_SIZE - 1u }, aArchive.size() - 1u })
+    {
+        bPassed &= WriteFileBytes(badArchivePath, std::vector<BYTE>(aArchive.begin(), aArchive.begin() + uSize))
+            && FAILED(archive.Open(badArchivePath));
+        ++uNumRejected;
+    }
+
+    // A large texture, mapped and parsed in place or read whole into a buffer and parsed there
+    const library::DDSDescription timingDescription =
+    {
+        .uFormat = FORMAT_R8G8B8A8_UNORM, .uDimension = 2u, .uWidth = uTimingSize, .uHeight = uTimingSize, .uDepth = 1u,
+        .uMipLevels = static_cast<UINT>(std::bit_width(uTimingSize)), .uArraySize = 1u, .bCubeMap = FALSE
+    };
+    const std::filesystem::path timingPath = directory / L"Timing.dds";
+    const std::vector<BYTE> aTimingFile = MakeDDSFile(timingDescription);
+    const size_t uTimingFileSize = aTimingFile.size();
+    bPassed &= WriteFileBytes(timingPath, aTimingFile);
+    const auto sumTexels = [](const library::DDSFile& parsedFile)
+        {
+            UINT64 uSum = 0u;
+            for (UINT uSubresource = 0u; uSubresource < parsedFile.GetNumSubresources(); ++uSubresource)
+            {
+                const library::DDSSubresource& subresource = parsedFile.GetSubresource(uSubresource);
+                uSum = std::accumulate(subresource.pData, subresource.pData + subresource.uSlicePitch, uSum);
+            }
+            return uSum;
+        };
+
+    UINT64 uMappedSum = 0u;
+    const double mappedTime = TimeBestOf(NUM_TIMING_RUNS, [&]()
+        {
+            library::DDSFile mappedFile;
+            bPassed &= SUCCEEDED(mapping->Open(timingPath)) && SUCCEEDED(mappedFile.Parse(mapping->GetData(), mapping->GetSize()));
+            uMappedSum = sumTexels(mappedFile);
+            mapping->Close();
+        });
+    UINT64 uReadSum = 0u;
+    const double readTime = TimeBestOf(NUM_TIMING_RUNS, [&]()
+        {
+            std::ifstream timingFile(timingPath, std::ios::binary | std::ios::ate);
+            std::vector<BYTE> aBytes(static_cast<size_t>(timingFile.tellg()));
+            timingFile.seekg(0);
+            library::DDSFile readFile;
+            bPassed &= timingFile.read(reinterpret_cast<CHAR*>(aBytes.data()), static_cast<std::streamsize>(aBytes.size())).good()
+                && SUCCEEDED(readFile.Parse(aBytes.data(), aBytes.size()));
+            uReadSum = sumTexels(readFile);
+        });
+    bPassed &= uMappedSum == uReadSum && uMappedSum != 0u;
+
+    std::filesystem::remove_all(directory, error);
+
+    const double megabytes = static_cast<double>(uTimingFileSize) / (1024.0 * 1024.0);
+    std::printf("\n%-10s %12s %12s %12s\n", "Load", "Time ms", "MB/s", "Speedup");
+    std::printf("%-10s %12.3f %12.1f %11.2fx\n", "Read", readTime, 1000.0 * megabytes / readTime, 1.0);
+    std::printf("%-10s %12.3f %12.1f %11.2fx\n", "Mapped", mappedTime, 1000.0 * megabytes / mappedTime, readTime / mappedTime);
+
+    return ReportCheck(bPassed, "Texture files, %zu DDS files mapped and packed, %zu truncated and oversized files rejected", aFilePaths.size(),
+        uNumRejected);
+}
+
+/*F+F+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+  Function: RunGpuProfilerChecks
+
+  Summary:  Checks the GPU profiler on a scripted context whose sets
+            come back two frames late, and much later while the GPU
+            stalls so that the ring fills, some of them on a disjoint
+            clock. Every frame times a shadow pass, a main pass with a
+            nested light pass and two post passes. The profiler must
+            never use a set in flight nor poll a set that is not ready
+            more than once per read back, must drop the frames whose
+            clock was disjoint and the ones it found no free set for,
+            and the CPU profiler must hold the passes of the last frame
+            read back, the post passes summed
+
+  Returns:  BOOL
+              TRUE if every check passed
+-----------------------------------------------------------------F-F*/
+static BOOL RunGpuProfilerChecks()
+{
+    static constexpr UINT NUM_FRAMES = 64u;
+    static constexpr UINT LATENCY = 2u;
+    static constexpr UINT STALL_LATENCY = 3u * library::GpuProfiler::NUM_QUERY_SETS;
+    static constexpr UINT STALL_FRAME = 24u;
+    static constexpr UINT DISJOINT_PERIOD = 7u;
+
+    // Ticks of the passes of a frame, the shadows growing every frame
+    struct PassTimes
+    {
+        UINT64 uShadowTicks;
+        UINT64 uLightTicks;
+        UINT64 uMainTicks;
+        UINT64 uPostTicks;
+    };
+    const auto getPassTimes = [](UINT uFrame)
+        {
+            return PassTimes{ .uShadowTicks = 100u + 10u * uFrame, .uLightTicks = 50u, .uMainTicks = 300u, .uPostTicks = 20u };
+        };
+
+    ScriptedTimestampContext context;
+    library::GpuProfiler profiler;
+    library::CpuProfiler& cpuProfiler = library::CpuProfiler::GetGlobal();
+    cpuProfiler.SetGpuFrameStatistics({});
+    BOOL bPassed = SUCCEEDED(profiler.Initialize(&context));
+    profiler.SetEnabled(TRUE);
+
+    UINT uNumUntimedFrames = 0u;
+    UINT uNumDisjointFrames = 0u;
+    UINT uLastTimedFrame = NUM_FRAMES;
+    for (UINT uFrame = 0u; uFrame < NUM_FRAMES + STALL_LATENCY; ++uFrame)
+    {
+        // The last frames are not timed, only read back
+        context.SetFrame(uFrame);
+        context.SetNextSet(uFrame == STALL_FRAME ? STALL_LATENCY : LATENCY, uFrame % DISJOINT_PERIOD == DISJOINT_PERIOD - 1u);
+        profiler.SetEnabled(uFrame < NUM_FRAMES);
+        const UINT64 uLostFrames = profiler.GetNumLostFrames();
+        const size_t uNumReadBefore = context.GetReadFrames().size();
+
+        profiler.BeginFrame();
+        const PassTimes passTimes = getPassTimes(uFrame);
+        {
+            library::GpuProfileScope shadowScope(profiler, "Shadows");
+            context.AdvanceClock(passTimes.uShadowTicks);
+        }
+        {
+            library::GpuProfileScope mainScope(profiler, "Main");
+            {
+                library::GpuProfileScope lightScope(profiler, "Lights");
+                context.AdvanceClock(passTimes.uLightTicks);
+            }
+            context.AdvanceClock(passTimes.uMainTicks - passTimes.uLightTicks);
+        }
+        for (UINT i = 0u; i < 2u; ++i)
+        {
+            library::GpuProfileScope postScope(profiler, "Post");
+            context.AdvanceClock(passTimes.uPostTicks);
+        }
+        profiler.EndFrame();
+
+        // A frame begun with every set in flight is lost at once, the disjoint ones when they are read
+        const UINT64 uNewLostFrames = profiler.GetNumLostFrames() - uLostFrames;
+        UINT uNewDisjointFrames = 0u;
+        const std::vector<ScriptedTimestampContext::ReadFrame>& aReadFrames = context.GetReadFrames();
+        for (size_t i = uNumReadBefore; i < aReadFrames.size(); ++i)
+        {
+            uNewDisjointFrames += aReadFrames[i].bDisjoint ? 1u : 0u;
+            uLastTimedFrame = aReadFrames[i].bDisjoint ? uLastTimedFrame : aReadFrames[i].uFrame;
+        }
+        bPassed &= uNewLostFrames >= uNewDisjointFrames && uNewLostFrames - uNewDisjointFrames <= 1u;
+        uNumUntimedFrames += static_cast<UINT>(uNewLostFrames - uNewDisjointFrames);
+        uNumDisjointFrames += uNewDisjointFrames;
+        bPassed &= context.GetNumFailedPolls() <= 2u;
+
+        if (uLastTimedFrame == NUM_FRAMES)
+        {
+            continue;
+        }
+
+        // The passes of the last frame read back, in the order they began, the frame around them
+        const PassTimes lastTimes = getPassTimes(uLastTimedFrame);
+        const std::pair<PCSTR, UINT64> aExpectedTicks[] =
+        {
+            { "GPU frame", lastTimes.uShadowTicks + lastTimes.uMainTicks + 2u * lastTimes.uPostTicks },
+            { "Shadows", lastTimes.uShadowTicks },
+            { "Main", lastTimes.uMainTicks },
+            { "Lights", lastTimes.uLightTicks },
+            { "Post", 2u * lastTimes.uPostTicks }
+        };
+        std::vector<library::ProfileStatistic> aGpuStatistics;
+        for (const library::ProfileStatistic& statistic : cpuProfiler.GetFrameStatistics())
+        {
+            if (statistic.eTimeline == library::eProfileTimeline::GPU)
+            {
+                aGpuStatistics.push_back(statistic);
+            }
+        }
+        bPassed &= aGpuStatistics.size() == std::size(aExpectedTicks);
+        for (size_t i = 0u; bPassed && i < aGpuStatistics.size(); ++i)
+        {
+            const double expectedTime = 1000.0 * static_cast<double>(aExpectedTicks[i].second) / ScriptedTimestampContext::FREQUENCY;
+            bPassed &= std::strcmp(aGpuStatistics[i].pszName, aExpectedTicks[i].first) == 0
+                && std::fabs(aGpuStatistics[i].totalTime - expectedTime) < 1.0e-4;
+        }
+        bPassed &= aGpuStatistics.size() < 5u || aGpuStatistics[4].uNumCalls == 2u;
+    }
+
+    // Every timed frame was read back once, and nothing is left in flight
+    bPassed &= context.GetNumMisuses() == 0u && context.GetReadFrames().size() + uNumUntimedFrames == NUM_FRAMES;
+    bPassed &= uNumUntimedFrames > 0u && uNumDisjointFrames > 0u && profiler.GetNumLostFrames() == uNumUntimedFrames + uNumDisjointFrames;
+    cpuProfiler.SetGpuFrameStatistics({});
+
+    return ReportCheck(bPassed, "GPU profiler, %u frames read %u frames late, %u untimed while the GPU stalled, %u disjoint dropped", NUM_FRAMES,
+        LATENCY, uNumUntimedFrames, uNumDisjointFrames);
+}
+
+/*F+F+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+  Function: RunFrameAllocations
+
+  Summary:  Runs frames of the per-frame work that is meant to stay off
+            the heap: tasks of a render thread pool sorting scratch in
+            their frame arenas under profiled scopes, then the end of
+            the frame of the profiler and of the frame memory. The
+            trace keeps as many frames as are warmed up, so it is
+            recycling its frames when the measure starts
+
+  Args:     UINT uNumThreads
+              Threads of the pool
+            UINT uNumFrames
+              Frames measured after the warm up ones
+
+  Returns:  UINT64
+              Calls to operator new during the measured frames
+-----------------------------------------------------------------F-F*/
+static UINT64 RunFrameAllocations(_In_ UINT uNumThreads, _In_ UINT uNumFrames)
+{
+    library::RenderThreadPool threadPool;
+    threadPool.Initialize(uNumThreads);
+
+    library::CpuProfiler& profiler = library::CpuProfiler::GetGlobal();
+    library::FrameMemory& frameMemory = library::FrameMemory::GetGlobal();
+    profiler.SetMaxCapturedFrames(NUM_WARMUP_FRAMES);
+    profiler.SetEnabled(TRUE);
+
+    const UINT uNumTasks = 4u * uNumThreads;
+    std::vector<UINT> auResults(uNumTasks, 0u);
+    UINT64 uFirstAllocation = s_uNumHeapAllocations.load();
+    for (UINT uFrame = 0u; uFrame < NUM_WARMUP_FRAMES + uNumFrames; ++uFrame)
+    {
+        if (uFrame == NUM_WARMUP_FRAMES)
+        {
+            uFirstAllocation = s_uNumHeapAllocations.load();
+        }
+
+        {
+            library::ProfileScope frameScope("Frame");
+
+            // Frames of a few sizes, all of them seen while warming up
+            const auto task = [uFrame, &auResults](UINT uTask)
+                {
+                    library::ProfileScope taskScope("Task");
+                    library::FrameVector<UINT> auValues;
+                    UINT uValue = uFrame * 7919u + uTask;
+                    for (UINT i = 0u; i < 256u * (1u + uFrame % 8u); ++i)
+                    {
+                        uValue = uValue * 1664525u + 1013904223u;
+                        auValues.push_back(uValue);
+                    }
+                    std::sort(auValues.begin(), auValues.end());
+                    auResults[uTask] = auValues[auValues.size() / 2u];
+                };
+            threadPool.Dispatch(uNumTasks, [&task](UINT uTask)
+                {
+                    task(uTask);
+                });
+        }
+
+        profiler.EndFrame();
+        frameMemory.EndFrame();
+    }
+    const UINT64 uNumAllocations = s_uNumHeapAllocations.load() - uFirstAllocation;
+
+    profiler.SetEnabled(FALSE);
+    profiler.SetMaxCapturedFrames(library::CpuProfiler::DEFAULT_MAX_CAPTURED_FRAMES);
+
+    return uNumAllocations;
+}
+
+#ifdef _WIN32
+/*F+F+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+  Function: WriteHeightMap
+
+  Summary:  Writes the height map of the benchmark scene, fractal noise
+            as the game generates, with ocean, sand, grassland and snow
+            by height
+
+  Args:     const std::filesystem::path& filePath
+              Path of the height map
+            UINT uMapSize
+              Width and depth of the map in voxels
+            UINT uMapHeight
+              Height of the map in voxels
+
+  Returns:  BOOL
+              TRUE if the file was written
+-----------------------------------------------------------------F-F*/
+static BOOL WriteHeightMap(_In_ const std::filesystem::path& filePath, _In_ UINT uMapSize, _In_ UINT uMapHeight)
+{
+    std::ofstream sceneFile(filePath);
+    if (!sceneFile)
+    {
+        return FALSE;
+    }
+
+    // In the order of the block types they color
+    static constexpr XMFLOAT3 COLORS[] =
+    {
+        XMFLOAT3(0.0f, 0.666f, 0.0f),   // GRASSLAND
+        XMFLOAT3(1.0f, 1.0f,   1.0f),   // SNOW
+        XMFLOAT3(0.0f, 0.0f,   0.666f), // OCEAN
+        XMFLOAT3(1.0f, 0.666f, 0.0f),   // SAND
+    };
+
+    sceneFile << uMapSize << ' ' << uMapHeight << ' ' << uMapSize << ' ' << ARRAYSIZE(COLORS) << '\n';
+    for (const XMFLOAT3& color : COLORS)
+    {
+        sceneFile << color.x << ' ' << color.y << ' ' << color.z << '\n';
+    }
+
+    for (UINT z = 0u; z < uMapSize; ++z)
+    {
+        for (UINT x = 0u; x < uMapSize; ++x)
+        {
+            FLOAT height = 0.0f;
+            FLOAT frequencySum = 0.0f;
+            for (UINT i = 0u; i < 4u; ++i)
+            {
+                const FLOAT frequency = std::pow(2.0f, static_cast<FLOAT>(i));
+                frequencySum += 1.0f / frequency;
+                height += library::Scene::GetPerlin2d(frequency * static_cast<FLOAT>(x), frequency * static_cast<FLOAT>(z), 0.1f, 4u) / frequency;
+            }
+            height = std::clamp(std::pow(std::max(height / frequencySum, 0.0f) * 1.2f, 1.25f), 0.0f, 1.0f);
+
+            library::eBlockType blockType = library::eBlockType::GRASSLAND;
+            if (height < 0.1f)
+            {
+                blockType = library::eBlockType::OCEAN;
+            }
+            else if (height < 0.12f)
+            {
+                blockType = library::eBlockType::SAND;
+            }
+            else if (height > 0.8f)
+            {
+                blockType = library::eBlockType::SNOW;
+            }
+
+            sceneFile << static_cast<CHAR>(blockType) << height << ' ';
+        }
+        sceneFile << '\n';
+    }
+
+    return sceneFile.good();
+}
+
+/*F+F+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+  Function: BuildScene
+
+  Summary:  Builds the benchmark scene on a height map: the voxels, the
+            models and animated models on a grid over the map and the
+            point lights on a spiral above it. The first light is the
+            high one the cascaded shadows are cast from, straight down
+            along the shadow direction the scene sets
+
+  Args:     const SceneSettings& settings
+              Size of the scene
+            const std::filesystem::path& heightMapPath
+              Path of the height map
+            std::shared_ptr<library::Scene>& outScene
+              The scene built
+
+  Modifies: [outScene].
+
+  Returns:  HRESULT
+              Status code
+-----------------------------------------------------------------F-F*/
+static HRESULT BuildScene(_In_ const SceneSettings& settings, _In_ const std::filesystem::path& heightMapPath, _Out_ std::shared_ptr<library::Scene>& outScene)
+{
+    HRESULT hr = S_OK;
+
+    outScene = std::make_shared<library::Scene>(heightMapPath);
+
+    // Never compiled on a headless renderer, but every object needs its shaders
+    constexpr UINT uNormalMapFeature = library::GetShaderFeatureMask(library::eShaderFeature::NORMAL_MAP);
+    constexpr UINT uLitFeatures = uNormalMapFeature | library::GetShaderFeatureMask(library::eShaderFeature::SHADOW_RECEIVER);
+    hr = outScene->AddVertexShader(L"PhongShader", std::make_shared<library::VertexShader>(L"Shaders/PhongShaders.fxh", "VSPhong", "vs_5_0", uNormalMapFeature));
+    if (FAILED(hr))
+    {
+        return hr;
+    }
+    hr = outScene->AddPixelShader(L"PhongShader", std::make_shared<library::PixelShader>(L"Shaders/PhongShaders.fxh", "PSPhong", "ps_5_0", uLitFeatures));
+    if (FAILED(hr))
+    {
+        return hr;
+    }
+    hr = outScene->AddVertexShader(L"VoxelShader", std::make_shared<library::VertexShader>(L"Shaders/VoxelShaders.fxh", "VSVoxel", "vs_5_0", uNormalMapFeature));
+    if (FAILED(hr))
+    {
+        return hr;
+    }
+    hr = outScene->AddPixelShader(L"VoxelShader", std::make_shared<library::PixelShader>(L"Shaders/VoxelShaders.fxh", "PSVoxel", "ps_5_0", uLitFeatures));
+    if (FAILED(hr))
+    {
+        return hr;
+    }
+    hr = outScene->SetVertexShaderOfVoxel(L"VoxelShader");
+    if (FAILED(hr))
+    {
+        return hr;
+    }
+    hr = outScene->SetPixelShaderOfVoxel(L"VoxelShader");
+    if (FAILED(hr))
+    {
+        return hr;
+    }
+
+    // Voxels are 2 units wide, centered on the origin, their highest tops near three quarters of the map height
+    const FLOAT halfExtent = static_cast<FLOAT>(settings.uMapSize);
+    const FLOAT groundHeight = 0.75f * static_cast<FLOAT>(settings.uMapHeight);
+
+    const UINT uNumAllModels = settings.uNumModels + settings.uNumAnimatedModels;
+    const UINT uGridSize = static_cast<UINT>(std::ceil(std::sqrt(static_cast<double>(uNumAllModels))));
+    for (UINT i = 0u; i < uNumAllModels; ++i)
+    {
+        const BOOL bAnimated = i >= settings.uNumModels;
+        const std::wstring szName = (bAnimated ? L"Animated" : L"Model") + std::to_wstring(i);
+        std::shared_ptr<library::Model> pModel = std::make_shared<library::Model>(
+            bAnimated ? L"Content/BobLampClean/boblampclean.md5mesh" : L"Content/Nanosuit/nanosuit.obj");
+
+        const FLOAT u = (static_cast<FLOAT>(i % uGridSize) + 0.5f) / static_cast<FLOAT>(uGridSize);
+        const FLOAT v = (static_cast<FLOAT>(i / uGridSize) + 0.5f) / static_cast<FLOAT>(uGridSize);
+        pModel->Translate(XMVectorSet((1.6f * u - 0.8f) * halfExtent, groundHeight, (1.6f * v - 0.8f) * halfExtent, 0.0f));
+
+        hr = outScene->AddModel(szName.c_str(), pModel);
+        if (FAILED(hr))
+        {
+            return hr;
+        }
+        hr = outScene->SetVertexShaderOfModel(szName.c_str(), L"PhongShader");
+        if (FAILED(hr))
+        {
+            return hr;
+        }
+        hr = outScene->SetPixelShaderOfModel(szName.c_str(), L"PhongShader");
+        if (FAILED(hr))
+        {
+            return hr;
+        }
+    }
+
+    static const XMVECTORF32 LIGHT_COLORS[] = { Colors::White, Colors::Orange, Colors::SkyBlue, Colors::LimeGreen, Colors::Magenta };
+    for (UINT i = 0u; i < settings.uNumLights; ++i)
+    {
+        XMFLOAT4 position(0.0f, 300.0f, 0.0f, 1.0f);
+        FLOAT attenuationDistance = 100.0f;
+        if (i > 0u)
+        {
+            // Golden angle spiral, evenly spread over the map whatever the count
+            const FLOAT radius = 0.9f * halfExtent * std::sqrt((static_cast<FLOAT>(i) - 0.5f) / static_cast<FLOAT>(settings.uNumLights));
+            const FLOAT angle = 2.39996f * static_cast<FLOAT>(i);
+            position = XMFLOAT4(radius * std::cos(angle), groundHeight + 4.0f, radius * std::sin(angle), 1.0f);
+            attenuationDistance = 20.0f;
+        }
+
+        XMFLOAT4 color;
+        XMStoreFloat4(&color, LIGHT_COLORS[i % ARRAYSIZE(LIGHT_COLORS)]);
+        hr = outScene->AddPointLight(i, std::make_shared<library::PointLight>(position, color, attenuationDistance));
+        if (FAILED(hr))
+        {
+            return hr;
+        }
+    }
+
+    // The first light casts the cascades straight down, as a sun at noon over the map
+    return outScene->SetShadowDirection(XMFLOAT3(0.0f, -1.0f, 0.0f));
+}
+
+/*F+F+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+  Function: GetCameraPathPoint
+
+  Summary:  Returns the point of the camera path at a time, a closed
+            Catmull-Rom spline through the recorded points scaled to
+            the map
+
+  Args:     FLOAT time
+              Time along the path, 0 to 1 for a lap
+            const SceneSettings& settings
+              Size of the scene
+
+  Returns:  XMVECTOR
+              Point of the path in world space
+-----------------------------------------------------------------F-F*/
+static XMVECTOR GetCameraPathPoint(_In_ FLOAT time, _In_ const SceneSettings& settings)
+{
+    constexpr UINT uNumPoints = ARRAYSIZE(CAMERA_PATH);
+    const FLOAT position = (time - std::floor(time)) * static_cast<FLOAT>(uNumPoints);
+    const UINT uSegment = std::min(static_cast<UINT>(position), uNumPoints - 1u);
+
+    const XMVECTOR scale = XMVectorSet(static_cast<FLOAT>(settings.uMapSize), 1.0f, static_cast<FLOAT>(settings.uMapSize), 0.0f);
+    const XMVECTOR offset = XMVectorSet(0.0f, 0.75f * static_cast<FLOAT>(settings.uMapHeight), 0.0f, 0.0f);
+    XMVECTOR aControlPoints[4];
+    for (UINT i = 0u; i < 4u; ++i)
+    {
+        aControlPoints[i] = XMLoadFloat3(&CAMERA_PATH[(uSegment + uNumPoints - 1u + i) % uNumPoints]) * scale + offset;
+    }
+
+    return XMVectorCatmullRom(aControlPoints[0], aControlPoints[1], aControlPoints[2], aControlPoints[3], position - static_cast<FLOAT>(uSegment));
+}
+
+/*F+F+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+  Function: GetPercentile
+
+  Summary:  Returns a percentile of sorted values, the nearest rank
+
+  Args:     const std::vector<double>& aSortedValues
+              Values in ascending order, at least one
+            double percentile
+              Percentile, 0 to 100
+
+  Returns:  double
+              The value of the percentile
+-----------------------------------------------------------------F-F*/
+static double GetPercentile(_In_ const std::vector<double>& aSortedValues, _In_ double percentile)
+{
+    const size_t uRank = static_cast<size_t>(std::ceil(percentile / 100.0 * static_cast<double>(aSortedValues.size())));
+    return aSortedValues[std::clamp<size_t>(uRank, 1u, aSortedValues.size()) - 1u];
+}
+
+/*F+F+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+  Function: RunSubmissionScaling
+
+  Summary:  Flies the camera path again on a loaded renderer for every
+            number of submission threads from 1 to the hardware threads
+            and prints the frame and submission times of each, then
+            restores the number the renderer had
+
+  Args:     library::Renderer& renderer
+              Renderer with the scene loaded
+            const SceneSettings& settings
+              Size of the scene
+-----------------------------------------------------------------F-F*/
+static void RunSubmissionScaling(_In_ library::Renderer& renderer, _In_ const SceneSettings& settings)
+{
+    const UINT uNumSubmissionThreads = renderer.GetNumSubmissionThreads();
+    const UINT uNumHardwareThreads = std::max(std::thread::hardware_concurrency(), 1u);
+    const UINT uNumRunFrames = NUM_WARMUP_FRAMES + settings.uNumFrames;
+
+    std::printf("\nSubmission scaling, %u path frames\n", settings.uNumFrames);
+    std::printf("%-10s %12s %12s %12s\n", "Threads", "Frame ms", "Submit ms", "Speedup");
+    double baseFrameTime = 0.0;
+    for (UINT uNumThreads = 1u; uNumThreads <= uNumHardwareThreads; ++uNumThreads)
+    {
+        if (FAILED(renderer.SetNumSubmissionThreads(uNumThreads)))
+        {
+            std::fprintf(stderr, "Could not start %u submission threads\n", uNumThreads);
+            break;
+        }
+
+        double frameTime = 0.0;
+        double submissionTime = 0.0;
+        for (UINT uFrame = 0u; uFrame < uNumRunFrames; ++uFrame)
+        {
+            const FLOAT time = static_cast<FLOAT>(uFrame) / static_cast<FLOAT>(uNumRunFrames);
+            const XMVECTOR eye = GetCameraPathPoint(time, settings);
+            const XMVECTOR at = GetCameraPathPoint(time + 0.01f, settings) - XMVectorSet(0.0f, 8.0f, 0.0f, 0.0f);
+
+            const auto frameStart = std::chrono::steady_clock::now();
+            renderer.SaveState();
+            renderer.SetCameraLookAt(eye, at);
+            renderer.Update(SCENE_TIMESTEP);
+            renderer.Render();
+            const auto frameEnd = std::chrono::steady_clock::now();
+            PROFILE_END_FRAME();
+            library::FrameMemory::GetGlobal().EndFrame();
+
+            if (uFrame >= NUM_WARMUP_FRAMES)
+            {
+                frameTime += std::chrono::duration<double, std::milli>(frameEnd - frameStart).count();
+                submissionTime += renderer.GetSubmissionTime();
+            }
+        }
+
+        frameTime /= settings.uNumFrames;
+        submissionTime /= settings.uNumFrames;
+        baseFrameTime = (uNumThreads == 1u) ? frameTime : baseFrameTime;
+        std::printf("%-10u %12.2f %12.3f %11.2fx\n", uNumThreads, frameTime, submissionTime, baseFrameTime / frameTime);
+    }
+
+    renderer.SetNumSubmissionThreads(uNumSubmissionThreads);
+}
+
+/*F+F+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+  Function: LoadScene
+
+  Summary:  Builds the benchmark scene and loads it into a new headless
+            renderer with every submission thread and the shadow maps
+
+  Args:     const SceneSettings& settings
+              Size of the scene
+            const std::filesystem::path& heightMapPath
+              Path of the height map, already written
+            std::unique_ptr<library::Renderer>& outRenderer
+              The renderer with the scene loaded
+
+  Modifies: [outRenderer].
+
+  Returns:  HRESULT
+              Status code
+-----------------------------------------------------------------F-F*/
+static HRESULT LoadScene(_In_ const SceneSettings& settings, _In_ const std::filesystem::path& heightMapPath,
+    _Out_ std::unique_ptr<library::Renderer>& outRenderer)
+{
+    std::shared_ptr<library::Scene> pScene;
+    HRESULT hr = BuildScene(settings, heightMapPath, pScene);
+    outRenderer = std::make_unique<library::Renderer>();
+    if (SUCCEEDED(hr))
+    {
+        hr = outRenderer->AddScene(L"Benchmark", pScene);
+    }
+    if (SUCCEEDED(hr))
+    {
+        hr = outRenderer->SetMainScene(L"Benchmark");
+    }
+    if (SUCCEEDED(hr))
+    {
+        hr = outRenderer->SetNumSubmissionThreads(std::max(std::thread::hardware_concurrency(), 1u));
+    }
+    if (SUCCEEDED(hr))
+    {
+        outRenderer->SetShadowMapShader(std::make_shared<library::ShadowVertexShader>(L"Shaders/ShadowShaders.fxh", "VSShadow", "vs_5_0",
+            library::GetShaderFeatureMask(library::eShaderFeature::INSTANCING)));
+        hr = outRenderer->InitializeHeadless(1280u, 720u);
+    }
+
+    return hr;
+}
+
+/*F+F+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+  Function: RunScene
+
+  Summary:  Builds the benchmark scene, loads it into a headless
+            renderer, and once more without the texture cache to time
+            what it saves, then flies the camera once along its path, a
+            simulation step and a frame at a time after a few warm up
+            frames. With an input log, runs the frames of the log
+            instead, every one measured, as the game would have. Prints
+            both load times, the texture cache counters of the load,
+            the frame time percentiles, the average and worst time of
+            every subsystem, the frame snapshot among
+            them, and the draw and shadow cache counters per frame.
+            Profiled builds print the time of every profiled scope too.
+            The times of every frame, the snapshot's included, can be
+            written to compare two runs frame by frame. A path run is
+            then flown again for every number of submission threads
+
+  Args:     const SceneSettings& settings
+              Size of the scene
+            const std::filesystem::path& heightMapPath
+              Path to write the height map to
+            library::InputReplayer* pReplayer
+              Input log to run the frames of, or null to fly the path
+            const std::filesystem::path& frameTimesPath
+              Path to write the times of every frame to as comma
+              separated values, or empty
+
+  Returns:  BOOL
+              TRUE if the scene loaded and ran
+-----------------------------------------------------------------F-F*/
+static BOOL RunScene(_In_ const SceneSettings& settings, _In_ const std::filesystem::path& heightMapPath, _In_opt_ library::InputReplayer* pReplayer,
+    _In_ const std::filesystem::path& frameTimesPath)
+{
+    if (!WriteHeightMap(heightMapPath, settings.uMapSize, settings.uMapHeight))
+    {
+        std::fprintf(stderr, "Could not write the height map %s\n", heightMapPath.string().c_str());
+        return FALSE;
+    }
+
+    // The cache counters cover the load of the scene alone
+    library::TextureCache& textureCache = library::TextureCache::GetGlobal();
+    textureCache.ResetStatistics();
+    std::unique_ptr<library::Renderer> pRenderer;
+    HRESULT hr = LoadScene(settings, heightMapPath, pRenderer);
+    if (FAILED(hr))
+    {
+        std::fprintf(stderr, "Could not load the scene: 0x%08X\n", static_cast<UINT>(hr));
+        return FALSE;
+    }
+    const library::TextureCacheStatistics textureStatistics = textureCache.GetStatistics();
+
+    // Loaded again with every acquisition a new texture. The first load warmed the file and shader caches, which only
+    // narrows the difference
+    double uncachedLoadTime = 0.0;
+    {
+        std::unique_ptr<library::Renderer> pUncachedRenderer;
+        textureCache.SetEnabled(FALSE);
+        hr = LoadScene(settings, heightMapPath, pUncachedRenderer);
+        textureCache.SetEnabled(TRUE);
+        if (FAILED(hr))
+        {
+            std::fprintf(stderr, "Could not load the scene without the texture cache: 0x%08X\n", static_cast<UINT>(hr));
+            return FALSE;
+        }
+        uncachedLoadTime = pUncachedRenderer->GetSceneLoadTime();
+    }
+
+#if PROFILING_ENABLED
+    library::CpuProfiler::GetGlobal().SetEnabled(TRUE);
+    std::vector<library::ProfileStatistic> aScopeTotals;
+#endif
+
+    std::ofstream frameTimesFile;
+    if (!frameTimesPath.empty())
+    {
+        frameTimesFile.open(frameTimesPath);
+        frameTimesFile << "Frame,Frame ms,Update ms,Render ms,Snapshot ms,Draw calls\n";
+    }
+
+    const UINT uNumWarmupFrames = pReplayer ? 0u : NUM_WARMUP_FRAMES;
+    const UINT uNumRunFrames = pReplayer ? pReplayer->GetNumFrames() : NUM_WARMUP_FRAMES + settings.uNumFrames;
+    std::vector<double> aFrameTimes;
+    aFrameTimes.reserve(uNumRunFrames);
+    // Summed and worst over the measured frames. Submission includes the
+    // culling of the frame, the times are not exclusive
+    struct SubsystemTime
+    {
+        PCSTR pszName;
+        double totalTime;
+        double worstTime;
+    } aSubsystemTimes[] =
+    {
+        { .pszName = "Update", .totalTime = 0.0, .worstTime = 0.0 },
+        { .pszName = "Render", .totalTime = 0.0, .worstTime = 0.0 },
+        { .pszName = "Snapshot", .totalTime = 0.0, .worstTime = 0.0 },
+        { .pszName = "Light culling", .totalTime = 0.0, .worstTime = 0.0 },
+        { .pszName = "Occlusion", .totalTime = 0.0, .worstTime = 0.0 },
+        { .pszName = "Submission", .totalTime = 0.0, .worstTime = 0.0 }
+    };
+    UINT64 uNumDrawCalls = 0u;
+    UINT64 uNumInstances = 0u;
+    UINT64 uNumStateChanges = 0u;
+    UINT64 uNumVisibleObjects = 0u;
+    UINT64 uNumCulledObjects = 0u;
+    UINT64 uNumShadowStaticDraws = 0u;
+    UINT64 uNumShadowDynamicDraws = 0u;
+    UINT64 uNumCascadeDrawsSaved = 0u;
+    UINT64 uNumCubeDrawsSaved = 0u;
+    UINT64 uNumShadowCopies = 0u;
+    library::FrameMemory& frameMemory = library::FrameMemory::GetGlobal();
+    frameMemory.ResetStatistics();
+    UINT64 uFirstAllocation = s_uNumHeapAllocations.load();
+    for (UINT uFrame = 0u; uFrame < uNumRunFrames; ++uFrame)
+    {
+        std::chrono::steady_clock::time_point frameStart;
+        std::chrono::steady_clock::time_point renderStart;
+        if (pReplayer)
+        {
+            // The steps of the frame as the game simulates them, the mouse movement going to the first
+            library::InputFrame frame;
+            pReplayer->ReadFrame(frame);
+
+            const FLOAT timestep = pReplayer->GetTimestep();
+            frameStart = std::chrono::steady_clock::now();
+            for (UINT i = 0u; i < frame.uNumSteps; ++i)
+            {
+                pRenderer->SaveState();
+                pRenderer->HandleInput(frame.directions, (i == 0u) ? frame.mouseRelativeMovement : MouseRelativeMovement{ .X = 0, .Y = 0 }, timestep);
+                pRenderer->Update(timestep);
+            }
+            renderStart = std::chrono::steady_clock::now();
+            pRenderer->Render(frame.alpha);
+        }
+        else
+        {
+            // The camera looks a little ahead along the path and down at the map
+            const FLOAT time = static_cast<FLOAT>(uFrame) / static_cast<FLOAT>(uNumRunFrames);
+            const XMVECTOR eye = GetCameraPathPoint(time, settings);
+            const XMVECTOR at = GetCameraPathPoint(time + 0.01f, settings) - XMVectorSet(0.0f, 8.0f, 0.0f, 0.0f);
+
+            frameStart = std::chrono::steady_clock::now();
+            pRenderer->SaveState();
+            pRenderer->SetCameraLookAt(eye, at);
+            pRenderer->Update(SCENE_TIMESTEP);
+            renderStart = std::chrono::steady_clock::now();
+            pRenderer->Render();
+        }
+        const auto frameEnd = std::chrono::steady_clock::now();
+        PROFILE_END_FRAME();
+        frameMemory.EndFrame();
+
+        if (uFrame < uNumWarmupFrames)
+        {
+            // The arenas grow to the largest frame while warming up, the run counts the blocks they take after
+            if (uFrame + 1u == uNumWarmupFrames)
+            {
+                frameMemory.ResetStatistics();
+                uFirstAllocation = s_uNumHeapAllocations.load();
+            }
+            continue;
+        }
+
+        const double frameTime = std::chrono::duration<double, std::milli>(frameEnd - frameStart).count();
+        const double frameUpdateTime = std::chrono::duration<double, std::milli>(renderStart - frameStart).count();
+        const double frameRenderTime = std::chrono::duration<double, std::milli>(frameEnd - renderStart).count();
+        if (frameTimesFile.is_open())
+        {
+            frameTimesFile << uFrame - uNumWarmupFrames << ',' << frameTime << ',' << frameUpdateTime << ',' << frameRenderTime << ','
+                << pRenderer->GetSnapshotTime() << ',' << pRenderer->GetRenderStatistics().uNumDrawCalls << '\n';
+        }
+
+        aFrameTimes.push_back(frameTime);
+        const double aFrameSubsystemTimes[] = { frameUpdateTime, frameRenderTime, pRenderer->GetSnapshotTime(), pRenderer->GetLightCullingTime(),
+            pRenderer->GetOcclusionTime(), pRenderer->GetSubmissionTime() };
+        for (size_t i = 0u; i < std::size(aSubsystemTimes); ++i)
+        {
+            aSubsystemTimes[i].totalTime += aFrameSubsystemTimes[i];
+            aSubsystemTimes[i].worstTime = std::max(aSubsystemTimes[i].worstTime, aFrameSubsystemTimes[i]);
+        }
+
+        const library::RenderStatistics& renderStatistics = pRenderer->GetRenderStatistics();
+        uNumDrawCalls += renderStatistics.uNumDrawCalls;
+        uNumInstances += renderStatistics.uNumInstances;
+        uNumStateChanges += renderStatistics.uNumStateChanges;
+        const library::CullingStatistics& cullingStatistics = pRenderer->GetCullingStatistics(library::eRenderPass::MAIN);
+        uNumVisibleObjects += cullingStatistics.uNumVisibleObjects;
+        uNumCulledObjects += cullingStatistics.uNumCulledObjects;
+        const library::ShadowStatistics& shadowStatistics = pRenderer->GetShadowStatistics();
+        uNumShadowStaticDraws += shadowStatistics.uNumStaticDraws;
+        uNumShadowDynamicDraws += shadowStatistics.uNumDynamicDraws;
+        uNumCascadeDrawsSaved += shadowStatistics.uNumCascadeDrawsSaved;
+        uNumCubeDrawsSaved += shadowStatistics.uNumCubeDrawsSaved;
+        uNumShadowCopies += shadowStatistics.uNumCopies;
+
+#if PROFILING_ENABLED
+        // Summed over the frames per name, in the order the names first showed up
+        for (const library::ProfileStatistic& statistic : library::CpuProfiler::GetGlobal().GetFrameStatistics())
+        {
+            auto it = std::find_if(aScopeTotals.begin(), aScopeTotals.end(), [&statistic](const library::ProfileStatistic& total)
+                {
+                    return std::strcmp(total.pszName, statistic.pszName) == 0 && total.eTimeline == statistic.eTimeline;
+                });
+            if (it == aScopeTotals.end())
+            {
+                aScopeTotals.push_back(statistic);
+                continue;
+            }
+            it->uNumCalls += statistic.uNumCalls;
+            it->totalTime += statistic.totalTime;
+            it->maxTime = std::max(it->maxTime, statistic.maxTime);
+        }
+#endif
+    }
+
+#if PROFILING_ENABLED
+    library::CpuProfiler::GetGlobal().SetEnabled(FALSE);
+#endif
+
+    if (aFrameTimes.empty())
+    {
+        std::fprintf(stderr, "No scene frames were run\n");
+        return FALSE;
+    }
+
+    const double numFrames = static_cast<double>(aFrameTimes.size());
+    double totalTime = 0.0;
+    for (double frameTime : aFrameTimes)
+    {
+        totalTime += frameTime;
+    }
+    std::sort(aFrameTimes.begin(), aFrameTimes.end());
+
+    std::printf("\nScene, %ux%ux%u voxels, %u models, %u animated models, %u lights, %zu %s frames\n", settings.uMapSize, settings.uMapHeight,
+        settings.uMapSize, settings.uNumModels, settings.uNumAnimatedModels, settings.uNumLights, aFrameTimes.size(), pReplayer ? "replayed" : "path");
+    std::printf("Loaded in %.1f ms, %.1f ms without the texture cache\n", pRenderer->GetSceneLoadTime(), uncachedLoadTime);
+    // Headless, no texture reaches a device, so none is resident and the times differ by the texture objects alone
+    std::printf("Texture cache: %u hits, %u misses, %u textures, %llu bytes resident\n", textureStatistics.uNumHits,
+        textureStatistics.uNumMisses, textureStatistics.uNumTextures, static_cast<unsigned long long>(textureStatistics.uMemorySize));
+    std::printf("%-10s %12s %12s %12s %12s %12s %12s\n", "Frames/s", "Average ms", "50% ms", "90% ms", "99% ms", "99.9% ms", "Worst ms");
+    std::printf("%-10.1f %12.2f %12.2f %12.2f %12.2f %12.2f %12.2f\n", 1000.0 * numFrames / totalTime, totalTime / numFrames,
+        GetPercentile(aFrameTimes, 50.0), GetPercentile(aFrameTimes, 90.0), GetPercentile(aFrameTimes, 99.0), GetPercentile(aFrameTimes, 99.9),
+        aFrameTimes.back());
+
+    std::printf("%-14s %12s %12s\n", "Subsystem", "Average ms", "Worst ms");
+    for (const SubsystemTime& subsystemTime : aSubsystemTimes)
+    {
+        std::printf("%-14s %12.3f %12.3f\n", subsystemTime.pszName, subsystemTime.totalTime / numFrames, subsystemTime.worstTime);
+    }
+    std::printf("Per frame: %.0f draw calls, %.0f instances, %.0f state changes, %.0f objects visible, %.0f culled\n",
+        uNumDrawCalls / numFrames, uNumInstances / numFrames, uNumStateChanges / numFrames, uNumVisibleObjects / numFrames,
+        uNumCulledObjects / numFrames);
+    // Cascades follow the camera, their static layers rarely survive a moving one
+    std::printf("Shadows per frame: %.0f static draws, %.0f dynamic draws, %.0f draws saved on cascades, %.0f on cube faces, %.1f copies\n",
+        uNumShadowStaticDraws / numFrames, uNumShadowDynamicDraws / numFrames, uNumCascadeDrawsSaved / numFrames, uNumCubeDrawsSaved / numFrames,
+        uNumShadowCopies / numFrames);
+
+    const library::FrameMemoryStatistics frameMemoryStatistics = frameMemory.GetStatistics();
+    std::printf("Frame memory: %u arenas, %.1f KB reserved, %.1f KB high water, %llu heap blocks\n", frameMemoryStatistics.uNumArenas,
+        frameMemoryStatistics.uCapacity / 1024.0, frameMemoryStatistics.uHighWaterMark / 1024.0,
+        static_cast<unsigned long long>(frameMemoryStatistics.uNumBlockAllocations));
+    std::printf("Heap allocations: %.1f per frame\n", (s_uNumHeapAllocations.load() - uFirstAllocation) / numFrames);
+
+#if PROFILING_ENABLED
+    std::printf("%-32s %12s %12s %12s\n", "Scope", "Average ms", "Worst ms", "Calls/frame");
+    for (const library::ProfileStatistic& total : aScopeTotals)
+    {
+        std::printf("%*s%-*s %12.3f %12.3f %12.1f\n", 2 * total.uDepth, "", 32 - 2 * total.uDepth, total.pszName, total.totalTime / numFrames,
+            total.maxTime, total.uNumCalls / numFrames);
+    }
+#endif
+
+    if (!pReplayer)
+    {
+        RunSubmissionScaling(*pRenderer, settings);
+    }
+
+    return TRUE;
+}
+#endif // _WIN32
+
+/*F+F+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+  Function: main
+
+  Summary:  Entry point of the benchmark. Runs the frames serially and
+            pipelined and prints the throughput of both, then the job
+            system checks and scaling, then the scene
+
+  Args:     INT argc
+              Number of arguments
+            char* argv[]
+              Options: -frames N, -simulation MS and -render MS, the
+              milliseconds of the synthetic loads of the stages, -jobs
+              N, the jobs of the scaling loop, -stress N, the rounds of
+              the job system checks, -scene N, the frames of the scene,
+              0 to skip it, -map N and -height N, the size of its map
+              in voxels, -models N, -animated N and -lights N, what it
+              holds, -content DIR, the directory of the game the
+              models load from, -replay FILE, an input log recorded by
+              the game whose frames the scene runs instead of the
+              camera path, and -frametimes FILE, where the times of
+              every scene frame are written
+
+  Returns:  INT
+              0 on success, 1 on a bad option or a failed check
+-----------------------------------------------------------------F-F*/
+INT main(_In_ INT argc, _In_reads_(argc) char* argv[])
+{
+    UINT uNumFrames = 300u;
+    double simulationLoad = 4.0;
+    double renderLoad = 6.0;
+    UINT uNumJobs = 256u;
+    UINT uNumStressRounds = 20u;
+    SceneSettings sceneSettings =
+    {
+        .uMapSize = 128u,
+        .uMapHeight = 32u,
+        .uNumModels = 8u,
+        .uNumAnimatedModels = 8u,
+        .uNumLights = 256u,
+        .uNumFrames = 600u
+    };
+    std::filesystem::path contentDirectory = L"../Game";
+    std::filesystem::path replayPath;
+    std::filesystem::path frameTimesPath;
+    for (INT i = 1; i + 1 < argc; i += 2)
+    {
+        if (std::strcmp(argv[i], "-frames") == 0)
+        {
+            uNumFrames = static_cast<UINT>(std::max(std::atoi(argv[i + 1]), 1));
+        }
+        else if (std::strcmp(argv[i], "-simulation") == 0)
+        {
+            simulationLoad = std::max(std::atof(argv[i + 1]), 0.0);
+        }
+        else if (std::strcmp(argv[i], "-render") == 0)
+        {
+            renderLoad = std::max(std::atof(argv[i + 1]), 0.0);
+        }
+        else if (std::strcmp(argv[i], "-jobs") == 0)
+        {
+            uNumJobs = static_cast<UINT>(std::max(std::atoi(argv[i + 1]), 1));
+        }
+        else if (std::strcmp(argv[i], "-stress") == 0)
+        {
+            uNumStressRounds = static_cast<UINT>(std::max(std::atoi(argv[i + 1]), 0));
+        }
+        else if (std::strcmp(argv[i], "-scene") == 0)
+        {
+            sceneSettings.uNumFrames = static_cast<UINT>(std::max(std::atoi(argv[i + 1]), 0));
+        }
+        else if (std::strcmp(argv[i], "-map") == 0)
+        {
+            sceneSettings.uMapSize = static_cast<UINT>(std::max(std::atoi(argv[i + 1]), 1));
+        }
+        else if (std::strcmp(argv[i], "-height") == 0)
+        {
+            sceneSettings.uMapHeight = static_cast<UINT>(std::max(std::atoi(argv[i + 1]), 1));
+        }
+        else if (std::strcmp(argv[i], "-models") == 0)
+        {
+            sceneSettings.uNumModels = static_cast<UINT>(std::max(std::atoi(argv[i + 1]), 0));
+        }
+        else if (std::strcmp(argv[i], "-animated") == 0)
+        {
+            sceneSettings.uNumAnimatedModels = static_cast<UINT>(std::max(std::atoi(argv[i + 1]), 0));
+        }
+        else if (std::strcmp(argv[i], "-lights") == 0)
+        {
+            sceneSettings.uNumLights = static_cast<UINT>(std::max(std::atoi(argv[i + 1]), 0));
+        }
+        else if (std::strcmp(argv[i], "-content") == 0)
+        {
+            contentDirectory = argv[i + 1];
+        }
+        else if (std::strcmp(argv[i], "-replay") == 0)
+        {
+            replayPath = std::filesystem::absolute(argv[i + 1]);
+        }
+        else if (std::strcmp(argv[i], "-frametimes") == 0)
+        {
+            frameTimesPath = std::filesystem::absolute(argv[i + 1]);
+        }
+        else
+        {
+            std::fprintf(stderr, "%s", USAGE);
+            return 1;
+        }
+    }
+    if (argc % 2 == 0)
+    {
+        std::fprintf(stderr, "%s", USAGE);
+        return 1;
+    }
+
+    const double passesPerMillisecond = CalibrateLoad();
+    const UINT64 uSimulationPasses = static_cast<UINT64>(std::llround(simulationLoad * passesPerMillisecond));
+    const UINT64 uRenderPasses = static_cast<UINT64>(std::llround(renderLoad * passesPerMillisecond));
+
+    std::printf("%u frames, %.2f ms simulation, %.2f ms render, %u hardware threads\n", uNumFrames, simulationLoad, renderLoad,
+        std::thread::hardware_concurrency());
+    std::printf("%-10s %12s %12s %12s\n", "Pipeline", "Frames/s", "Average ms", "Worst ms");
+
+    const BenchmarkResult serial = RunFrames(FALSE, uNumFrames, uSimulationPasses, uRenderPasses);
+    std::printf("%-10s %12.1f %12.2f %12.2f\n", "Serial", serial.framesPerSecond, serial.averageFrameTime, serial.worstFrameTime);
+
+    const BenchmarkResult pipelined = RunFrames(TRUE, uNumFrames, uSimulationPasses, uRenderPasses);
+    std::printf("%-10s %12.1f %12.2f %12.2f\n", "Pipelined", pipelined.framesPerSecond, pipelined.averageFrameTime, pipelined.worstFrameTime);
+
+    std::printf("Pipelining runs %.2fx the frames\n", pipelined.framesPerSecond / serial.framesPerSecond);
+
+    // Twice the hardware threads too, to see the cost of oversubscription
+    const UINT uNumHardwareThreads = std::max(std::thread::hardware_concurrency(), 1u);
+    std::vector<UINT> aNumThreads;
+    for (UINT uNumThreads = 1u; uNumThreads < uNumHardwareThreads; uNumThreads *= 2u)
+    {
+        aNumThreads.push_back(uNumThreads);
+    }
+    aNumThreads.push_back(uNumHardwareThreads);
+    aNumThreads.push_back(2u * uNumHardwareThreads);
+
+    BOOL bPassed = TRUE;
+    for (UINT uNumThreads : aNumThreads)
+    {
+        bPassed &= RunJobStress(uNumThreads, uNumStressRounds);
+    }
+    ReportCheck(bPassed, "Job system stress, %u rounds on 1 to %u threads", uNumStressRounds, aNumThreads.back());
+
+    // A tenth of a millisecond of load per job, whose state is a sixteenth of the calibrated one
+    const UINT64 uPassesPerJob = std::max<UINT64>(static_cast<UINT64>(std::llround(0.1 * passesPerMillisecond * 16.0)), 1u);
+    std::printf("\nJob system scaling, %u jobs\n", uNumJobs);
+    std::printf("%-10s %12s %12s %12s\n", "Threads", "Time ms", "Speedup", "Efficiency");
+    double baseTime = 0.0;
+    for (UINT uNumThreads : aNumThreads)
+    {
+        const double time = RunJobScaling(uNumThreads, uNumJobs, uPassesPerJob);
+        baseTime = (uNumThreads == 1u) ? time : baseTime;
+        std::printf("%-10u %12.2f %11.2fx %11.0f%%\n", uNumThreads, time, baseTime / time, 100.0 * baseTime / (time * std::min(uNumThreads, uNumHardwareThreads)));
+    }
+
+    const UINT64 uNumFrameAllocations = RunFrameAllocations(uNumHardwareThreads, uNumFrames);
+    bPassed &= ReportCheck(uNumFrameAllocations == 0u, "Heap allocations in %u steady frames on %u threads, %llu of them", uNumFrames,
+        uNumHardwareThreads, static_cast<unsigned long long>(uNumFrameAllocations));
+
+    bPassed &= RunCullingBenchmark(NUM_CULLING_BOXES);
+    bPassed &= RunLightCullingBenchmark(NUM_CULLED_LIGHTS);
+    bPassed &= RunOcclusionChecks(NUM_OCCLUDERS);
+    bPassed &= RunMipBenchmark(uNumHardwareThreads);
+    bPassed &= RunCascadeChecks();
+    bPassed &= RunFrameTimerChecks();
+    bPassed &= RunPackingChecks();
+    bPassed &= RunPermutationBenchmark(NUM_PERMUTATION_LOOKUPS);
+    bPassed &= RunRingChecks();
+    bPassed &= RunStreamingChecks();
+    bPassed &= RunTextureFileChecks(DDS_TIMING_SIZE);
+    bPassed &= RunGpuProfilerChecks();
+
+    library::InputReplayer replayer;
+    if (!replayPath.empty() && FAILED(replayer.Load(replayPath)))
+    {
+        std::fprintf(stderr, "Could not read the input log %s\n", replayPath.string().c_str());
+        return 1;
+    }
+
+    if (sceneSettings.uNumFrames > 0u || replayer.IsReplaying())
+    {
+#ifdef _WIN32
+        // The models load from the game directory as the game does, the height map is written elsewhere
+        const std::filesystem::path heightMapPath = std::filesystem::absolute(std::filesystem::temp_directory_path() / L"BenchmarkHeightMap.txt");
+        std::error_code error;
+        std::filesystem::current_path(contentDirectory, error);
+        if (error)
+        {
+            std::fprintf(stderr, "Could not open the content directory %s\n", contentDirectory.string().c_str());
+            return 1;
+        }
+
+        // The scene builds its voxels and loads on the job system
+        if (FAILED(library::JobSystem::GetGlobal().Initialize(uNumHardwareThreads)))
+        {
+            return 1;
+        }
+        sceneSettings.uNumLights = std::min(sceneSettings.uNumLights, library::MAX_NUM_LIGHTS);
+        bPassed &= RunScene(sceneSettings, heightMapPath, replayer.IsReplaying() ? &replayer : nullptr, frameTimesPath);
+#else
+        std::printf("\nScene skipped, the renderer needs Direct3D 11\n");
+#endif // _WIN32
+    }
+
+    return bPassed ? 0 : 1;
+}
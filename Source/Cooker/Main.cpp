@@ -0,0 +1,252 @@
+﻿/*+===================================================================
+  File:      MAIN.CPP
+
+  Summary:   Texture cooker. Converts the PNG, JPG and BMP images of a
+             content directory to block compressed DDS files with their
+             full mip chain, written next to the images where the
+             texture loaders look for them, and reports the memory and
+             load time the cooked files save.
+
+  © 2022 Kyung Hee University
+===================================================================+*/
+
+#include "Common.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cwctype>
+#include <fstream>
+#include <thread>
+
+#include "Texture/DDSFile.h"
+#include "Texture/FileMapping.h"
+#include "Texture/TextureCooker.h"
+#include "Texture/TextureStreamer.h"
+
+/*F+F+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+  Function: IsSourceImage
+
+  Summary:  Tells whether a file is an image the cooker converts
+
+  Args:     const std::filesystem::path& filePath
+              Path to the file
+
+  Returns:  BOOL
+              TRUE for PNG, JPG and BMP files
+-----------------------------------------------------------------F-F*/
+static BOOL IsSourceImage(_In_ const std::filesystem::path& filePath)
+{
+    std::wstring szExtension = filePath.extension().wstring();
+    std::transform(szExtension.begin(), szExtension.end(), szExtension.begin(), [](WCHAR c)
+        {
+            return static_cast<WCHAR>(std::towlower(c));
+        });
+
+    return szExtension == L".png" || szExtension == L".jpg" || szExtension == L".jpeg" || szExtension == L".bmp";
+}
+
+/*F+F+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+  Function: MeasureMappedLoad
+
+  Summary:  Times what the texture loader does on the CPU with a cooked
+            file, mapping and parsing it, then reading every page of
+            its subresources as the driver does when it copies them
+
+  Args:     const std::filesystem::path& cookedPath
+              Path to the cooked file
+            UINT64* puDataSize
+              Bytes of the subresources, the memory of the texture
+
+  Modifies: [puDataSize].
+
+  Returns:  double
+              Milliseconds, negative if the file does not load
+-----------------------------------------------------------------F-F*/
+static double MeasureMappedLoad(_In_ const std::filesystem::path& cookedPath, _Out_ UINT64* puDataSize)
+{
+    *puDataSize = 0u;
+
+    const auto start = std::chrono::steady_clock::now();
+
+    std::unique_ptr<library::FileMapping> mapping = library::FileMapping::Create();
+    library::DDSFile dds;
+    if (FAILED(mapping->Open(cookedPath)) || FAILED(dds.Parse(mapping->GetData(), mapping->GetSize())))
+    {
+        return -1.0;
+    }
+
+    volatile UINT uChecksum = 0u;
+    for (UINT i = 0u; i < dds.GetNumSubresources(); ++i)
+    {
+        const library::DDSSubresource& subresource = dds.GetSubresource(i);
+        for (UINT uOffset = 0u; uOffset < subresource.uSlicePitch; uOffset += 4096u)
+        {
+            uChecksum = uChecksum + subresource.pData[uOffset];
+        }
+        *puDataSize += subresource.uSlicePitch;
+    }
+
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+/*F+F+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+  Function: wmain
+
+  Summary:  Entry point of the cooker. Cooks every image of a
+            directory and its subdirectories whose cooked file is
+            missing or older than the image, then prints, per image and
+            in total, the bytes on disk and in video memory and the CPU
+            time of loading the image against the cooked file
+
+  Args:     INT argc
+              Number of arguments
+            WCHAR* argv[]
+              Content directory, then the options: -bc7 encodes the
+              colors in BC7, -force cooks every image again
+
+  Returns:  INT
+              0 if every image cooked, 1 otherwise
+-----------------------------------------------------------------F-F*/
+INT wmain(_In_ INT argc, _In_reads_(argc) WCHAR* argv[])
+{
+    if (argc < 2)
+    {
+        fwprintf(stderr, L"Usage: Cooker <content directory> [-bc7] [-force]\n");
+        return 1;
+    }
+
+    BOOL bHighQuality = FALSE;
+    BOOL bForce = FALSE;
+    for (INT i = 2; i < argc; ++i)
+    {
+        const std::wstring szOption = argv[i];
+        if (szOption == L"-bc7")
+        {
+            bHighQuality = TRUE;
+        }
+        else if (szOption == L"-force")
+        {
+            bForce = TRUE;
+        }
+        else
+        {
+            fwprintf(stderr, L"Unknown option %ls\n", szOption.c_str());
+            return 1;
+        }
+    }
+
+    static constexpr const PCWSTR FORMAT_NAMES[] = { L"BC1", L"BC3", L"BC5", L"BC7" };
+    const UINT uNumThreads = std::max(std::thread::hardware_concurrency(), 1u);
+
+    UINT uNumImages = 0u;
+    UINT uNumCooked = 0u;
+    UINT uNumFailed = 0u;
+    UINT64 uTotalSourceSize = 0u;
+    UINT64 uTotalCookedSize = 0u;
+    UINT64 uTotalDecodedMemory = 0u;
+    UINT64 uTotalCookedMemory = 0u;
+    double fTotalDecodeTime = 0.0;
+    double fTotalMappedTime = 0.0;
+
+    wprintf(L"%-48ls %-6ls %10ls %10ls %10ls %10ls %10ls %10ls\n", L"Image", L"Format", L"Source KB", L"Cooked KB",
+        L"RGBA8 KB", L"BC KB", L"Decode ms", L"Mapped ms");
+
+    std::error_code directoryError;
+    std::error_code error;
+    for (const std::filesystem::directory_entry& entry : std::filesystem::recursive_directory_iterator(argv[1], directoryError))
+    {
+        const std::filesystem::path& sourcePath = entry.path();
+        if (!entry.is_regular_file(error) || !IsSourceImage(sourcePath))
+        {
+            continue;
+        }
+        ++uNumImages;
+
+        // The loaders decode with the same call, it is what an image costs to load
+        library::DecodedImage image;
+        const auto decodeStart = std::chrono::steady_clock::now();
+        HRESULT hr = library::TextureStreamer::Decode(sourcePath, uNumThreads, image);
+        const double fDecodeTime = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - decodeStart).count();
+        if (FAILED(hr))
+        {
+            fwprintf(stderr, L"Can't decode \"%ls\" (0x%08X)\n", sourcePath.c_str(), static_cast<UINT>(hr));
+            ++uNumFailed;
+            continue;
+        }
+
+        const library::eCookedFormat format = library::TextureCooker::ChooseFormat(sourcePath, image.aMips[0], bHighQuality);
+        const std::filesystem::path cookedPath = library::TextureCooker::GetCookedPath(sourcePath);
+        const BOOL bUpToDate = std::filesystem::exists(cookedPath, error)
+            && std::filesystem::last_write_time(cookedPath, error) >= std::filesystem::last_write_time(sourcePath, error);
+        if (bForce || !bUpToDate)
+        {
+            std::vector<BYTE> aFile;
+            hr = library::TextureCooker::Cook(image, format, aFile);
+            if (SUCCEEDED(hr))
+            {
+                std::ofstream cookedFile(cookedPath, std::ios::binary | std::ios::trunc);
+                cookedFile.write(reinterpret_cast<const char*>(aFile.data()), static_cast<std::streamsize>(aFile.size()));
+                hr = cookedFile ? S_OK : E_FAIL;
+            }
+            if (FAILED(hr))
+            {
+                fwprintf(stderr, L"Can't cook \"%ls\"\n", sourcePath.c_str());
+                ++uNumFailed;
+                continue;
+            }
+            ++uNumCooked;
+        }
+
+        UINT64 uCookedMemory = 0u;
+        const double fMappedTime = MeasureMappedLoad(cookedPath, &uCookedMemory);
+        if (fMappedTime < 0.0)
+        {
+            fwprintf(stderr, L"Can't load \"%ls\"\n", cookedPath.c_str());
+            ++uNumFailed;
+            continue;
+        }
+
+        UINT64 uDecodedMemory = 0u;
+        for (const library::DecodedMip& mip : image.aMips)
+        {
+            uDecodedMemory += mip.aData.size();
+        }
+        const UINT64 uSourceSize = std::filesystem::file_size(sourcePath, error);
+        const UINT64 uCookedSize = std::filesystem::file_size(cookedPath, error);
+
+        std::wstring szName = std::filesystem::relative(sourcePath, argv[1], error).wstring();
+        if (szName.empty())
+        {
+            szName = sourcePath.filename().wstring();
+        }
+        wprintf(L"%-48ls %-6ls %10llu %10llu %10llu %10llu %10.2f %10.2f\n", szName.c_str(), FORMAT_NAMES[static_cast<size_t>(format)],
+            uSourceSize / 1024u, uCookedSize / 1024u, uDecodedMemory / 1024u, uCookedMemory / 1024u, fDecodeTime, fMappedTime);
+
+        uTotalSourceSize += uSourceSize;
+        uTotalCookedSize += uCookedSize;
+        uTotalDecodedMemory += uDecodedMemory;
+        uTotalCookedMemory += uCookedMemory;
+        fTotalDecodeTime += fDecodeTime;
+        fTotalMappedTime += fMappedTime;
+    }
+
+    if (directoryError)
+    {
+        fwprintf(stderr, L"Can't read \"%ls\"\n", argv[1]);
+        return 1;
+    }
+
+    wprintf(L"\n%u images, %u cooked, %u failed\n", uNumImages, uNumCooked, uNumFailed);
+    if (uTotalSourceSize > 0u && uTotalDecodedMemory > 0u && fTotalMappedTime > 0.0)
+    {
+        wprintf(L"On disk:         %10.2f MB source, %10.2f MB cooked (%.1f%%)\n", static_cast<double>(uTotalSourceSize) / 1048576.0,
+            static_cast<double>(uTotalCookedSize) / 1048576.0, 100.0 * static_cast<double>(uTotalCookedSize) / static_cast<double>(uTotalSourceSize));
+        wprintf(L"In video memory: %10.2f MB RGBA8, %10.2f MB block compressed (%.1f%%)\n", static_cast<double>(uTotalDecodedMemory) / 1048576.0,
+            static_cast<double>(uTotalCookedMemory) / 1048576.0, 100.0 * static_cast<double>(uTotalCookedMemory) / static_cast<double>(uTotalDecodedMemory));
+        wprintf(L"Load time:       %10.2f ms decoded, %10.2f ms mapped (%.1fx faster)\n", fTotalDecodeTime, fTotalMappedTime,
+            fTotalDecodeTime / fTotalMappedTime);
+    }
+
+    return uNumFailed == 0u ? 0 : 1;
+}
@@ -5,11 +5,13 @@
   Summary:  Constructor
   Args:     const std::filesystem::path& textureFilePath
               Path to the texture to use
+  Modifies: [m_bounds].
 M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
 
 BaseCube::BaseCube(_In_ const XMFLOAT4& outputColor)
     : Renderable(outputColor)
 {
+    m_bounds = library::FrustumCuller::ComputeBox(&VERTICES[0].Position.x, NUM_VERTICES, static_cast<UINT>(sizeof(library::SimpleVertex)));
 }
 
 /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
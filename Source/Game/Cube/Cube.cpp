@@ -27,6 +27,7 @@ HRESULT Cube::Initialize(_In_ ID3D11Device* pDevice, _In_ ID3D11DeviceContext* p
 {
     BasicMeshEntry basicMeshEntry;
     basicMeshEntry.uNumIndices = NUM_INDICES;
+    basicMeshEntry.Bounds = m_bounds;
 
     m_aMeshes.push_back(basicMeshEntry);
 
@@ -14,16 +14,22 @@
 #include <cstdio>
 #include <fstream>
 #include <memory>
+#include <sstream>
+#include <thread>
 
 #include "Cube/Cube.h"
 #include "Cube/RotatingCube.h"
 #include "Game/Game.h"
+#include "Job/JobSystem.h"
 #include "Light/RotatingPointLight.h"
 #include "Model/Model.h"
+#include "Profiler/CpuProfiler.h"
 #include "Renderer/Skybox.h"
 #include "Scene/Scene.h"
 #include "Scene/Voxel.h"
+#include "Shader/ShaderCache.h"
 #include "Shader/SkyMapVertexShader.h"
+#include "Texture/TextureCache.h"
 
 /*F+F+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
   Function: wWinMain
@@ -38,7 +44,8 @@
               Has no meaning.
             LPWSTR lpCmdLine
               Contains the command-line arguments as a Unicode
-              string
+              string: -record FILE writes the input of the run to
+              a log, -replay FILE runs the frames of a log and quits
             INT nCmdShow
               Flag that says whether the main application window
               will be minimized, maximized, or shown normally
@@ -49,7 +56,35 @@
 INT WINAPI wWinMain(_In_ HINSTANCE hInstance, _In_opt_ HINSTANCE hPrevInstance, _In_ LPWSTR lpCmdLine, _In_ INT nCmdShow)
 {
     UNREFERENCED_PARAMETER(hPrevInstance);
-    UNREFERENCED_PARAMETER(lpCmdLine);
+
+    std::filesystem::path recordPath;
+    std::filesystem::path replayPath;
+    std::wistringstream commandLine(lpCmdLine);
+    std::wstring szOption;
+    std::wstring szPath;
+    while (commandLine >> szOption >> szPath)
+    {
+        if (szOption == L"-record")
+        {
+            recordPath = szPath;
+        }
+        else if (szOption == L"-replay")
+        {
+            replayPath = szPath;
+        }
+    }
+
+#if PROFILING_ENABLED
+    // Profiled builds record from the load on, the trace is written on exit
+    library::CpuProfiler::GetGlobal().SetEnabled(TRUE);
+    PROFILE_THREAD_NAME("Main");
+#endif
+
+    // Jobs run on every hardware thread, this one included, from the scene build on
+    if (FAILED(library::JobSystem::GetGlobal().Initialize(std::max(std::thread::hardware_concurrency(), 1u))))
+    {
+        return 0;
+    }
 
     std::unique_ptr<library::Game> game = std::make_unique<library::Game>(L"Game Graphics Programming Assignment 3: Cube Mapping");
 
@@ -211,14 +246,18 @@ INT WINAPI wWinMain(_In_ HINSTANCE hInstance, _In_opt_ HINSTANCE hPrevInstance,
 
     std::shared_ptr<library::Scene> mainScene = std::make_shared<library::Scene>(L"HeightMap.txt");
 
+    // Lit shaders compile a permutation per combination of these, each object draws with the one of its material
+    constexpr UINT uNormalMapFeature = library::GetShaderFeatureMask(library::eShaderFeature::NORMAL_MAP);
+    constexpr UINT uLitFeatures = uNormalMapFeature | library::GetShaderFeatureMask(library::eShaderFeature::SHADOW_RECEIVER);
+
     // Phong
-    std::shared_ptr<library::VertexShader> phongVertexShader = std::make_shared<library::VertexShader>(L"Shaders/PhongShaders.fxh", "VSPhong", "vs_5_0");
+    std::shared_ptr<library::VertexShader> phongVertexShader = std::make_shared<library::VertexShader>(L"Shaders/PhongShaders.fxh", "VSPhong", "vs_5_0", uNormalMapFeature);
     if (FAILED(mainScene->AddVertexShader(L"PhongShader", phongVertexShader)))
     {
         return 0;
     }
     // Voxel
-    std::shared_ptr<library::VertexShader> voxelVertexShader = std::make_shared<library::VertexShader>(L"Shaders/VoxelShaders.fxh", "VSVoxel", "vs_5_0");
+    std::shared_ptr<library::VertexShader> voxelVertexShader = std::make_shared<library::VertexShader>(L"Shaders/VoxelShaders.fxh", "VSVoxel", "vs_5_0", uNormalMapFeature);
     if (FAILED(mainScene->AddVertexShader(L"VoxelShader", voxelVertexShader)))
     {
         return 0;
@@ -243,13 +282,13 @@ INT WINAPI wWinMain(_In_ HINSTANCE hInstance, _In_opt_ HINSTANCE hPrevInstance,
     }
 
     // Phong
-    std::shared_ptr<library::PixelShader> phongPixelShader = std::make_shared<library::PixelShader>(L"Shaders/PhongShaders.fxh", "PSPhong", "ps_5_0");
+    std::shared_ptr<library::PixelShader> phongPixelShader = std::make_shared<library::PixelShader>(L"Shaders/PhongShaders.fxh", "PSPhong", "ps_5_0", uLitFeatures);
     if (FAILED(mainScene->AddPixelShader(L"PhongShader", phongPixelShader)))
     {
         return 0;
     }
     // Voxel
-    std::shared_ptr<library::PixelShader> voxelPixelShader = std::make_shared<library::PixelShader>(L"Shaders/VoxelShaders.fxh", "PSVoxel", "ps_5_0");
+    std::shared_ptr<library::PixelShader> voxelPixelShader = std::make_shared<library::PixelShader>(L"Shaders/VoxelShaders.fxh", "PSVoxel", "ps_5_0", uLitFeatures);
     if (FAILED(mainScene->AddPixelShader(L"VoxelShader", voxelPixelShader)))
     {
         return 0;
@@ -313,7 +352,7 @@ INT WINAPI wWinMain(_In_ HINSTANCE hInstance, _In_opt_ HINSTANCE hPrevInstance,
     }
 
     std::shared_ptr<library::Material> floorMaterial = std::make_shared<library::Material>(L"FloorMat");
-    floorMaterial->pDiffuse = std::make_shared<library::Texture>("Content/plane.jpg");
+    floorMaterial->pDiffuse = library::TextureCache::GetGlobal().Acquire("Content/plane.jpg");
 
     if (FAILED(mainScene->AddMaterial(floorMaterial)))
     {
@@ -384,12 +423,70 @@ INT WINAPI wWinMain(_In_ HINSTANCE hInstance, _In_opt_ HINSTANCE hPrevInstance,
         return 0;
     }
 
-    
+    // Record the draw calls on every hardware thread
+    if (FAILED(game->GetRenderer()->SetNumSubmissionThreads(std::max(std::thread::hardware_concurrency(), 1u))))
+    {
+        return 0;
+    }
+
+    // Cascaded shadows from the first light, cube shadows from the next ones, voxels cast theirs per instance
+    game->GetRenderer()->SetShadowMapShader(std::make_shared<library::ShadowVertexShader>(L"Shaders/ShadowShaders.fxh", "VSShadow", "vs_5_0",
+        library::GetShaderFeatureMask(library::eShaderFeature::INSTANCING)));
+
+    // Simulate at 60 Hz, render up to 144 frames a second in between the steps
+    game->GetFrameTimer().SetTimestep(1.0f / 60.0f);
+    game->GetFrameTimer().SetFrameLimit(144.0f);
+    game->GetFrameTimer().SetSleepStrategy(library::eSleepStrategy::SLEEP_THEN_SPIN);
 
     if (FAILED(game->Initialize(hInstance, nCmdShow)))
     {
         return 0;
     }
 
-    return game->Run();
+#if PROFILING_ENABLED
+    game->GetRenderer()->SetGpuProfiling(TRUE);
+#endif
+
+    // Report how long the scene took to load and how much its textures take
+    const library::TextureCacheStatistics textureStatistics = library::TextureCache::GetGlobal().GetStatistics();
+    WCHAR szLoadReport[256];
+    const library::StreamingStatistics streamingStatistics = library::TextureStreamer::GetGlobal().GetStatistics();
+    swprintf_s(szLoadReport, L"Scene loaded in %.1f ms: %u textures, %.1f MiB, %u cache hits, %u misses, %u textures streaming\n",
+        game->GetRenderer()->GetSceneLoadTime(), textureStatistics.uNumLoadedTextures,
+        static_cast<double>(textureStatistics.uMemorySize) / (1024.0 * 1024.0), textureStatistics.uNumHits, textureStatistics.uNumMisses,
+        streamingStatistics.uNumDecoding + streamingStatistics.uNumStreaming);
+    OutputDebugString(szLoadReport);
+
+    // A warm shader cache reads every shader instead of compiling it
+    const library::ShaderCacheStatistics shaderStatistics = library::ShaderCache::GetGlobal().GetStatistics();
+    swprintf_s(szLoadReport, L"Shaders: %u read from the cache in %.1f ms, %u compiled in %.1f ms, %u failed\n",
+        shaderStatistics.uNumHits, shaderStatistics.readTime, shaderStatistics.uNumMisses, shaderStatistics.compileTime, shaderStatistics.uNumFailures);
+    OutputDebugString(szLoadReport);
+
+    // Replays run at the timestep they were recorded at, recordings at the one set above
+    if (!replayPath.empty() && FAILED(game->ReplayInput(replayPath)))
+    {
+        return 0;
+    }
+    if (!recordPath.empty())
+    {
+        game->StartInputRecording();
+    }
+
+    const INT iExitCode = game->Run();
+
+    if (!recordPath.empty() && FAILED(game->SaveInputRecording(recordPath)))
+    {
+        OutputDebugString(L"Could not write the input log\n");
+    }
+
+#if PROFILING_ENABLED
+    // Open in chrome://tracing or ui.perfetto.dev
+    if (FAILED(library::CpuProfiler::GetGlobal().WriteChromeTrace(L"Profile.json")))
+    {
+        OutputDebugString(L"Could not write the profile\n");
+    }
+#endif
+
+    return iExitCode;
 }
\ No newline at end of file
@@ -8,7 +8,8 @@ namespace library
       Modifies: [m_yaw, m_pitch, m_moveLeftRight, m_moveBackForward,
                  m_moveUpDown, m_travelSpeed, m_rotationSpeed,
                  m_padding, m_cameraForward, m_cameraRight, m_cameraUp,
-                 m_eye, m_at, m_up, m_rotation, m_view].
+                 m_eye, m_at, m_up, m_rotation, m_view, m_previousEye,
+                 m_previousDirection].
     M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
 
     Camera::Camera(_In_ const XMVECTOR& position)
@@ -16,7 +17,8 @@ namespace library
         m_moveUpDown(), m_travelSpeed(), m_rotationSpeed(),
         m_padding(), m_cameraForward(XMVECTOR()), m_cameraRight(XMVECTOR()),
         m_cameraUp(XMVECTOR()), m_eye(position), m_at(XMVectorSet(0.0f, 1.0f, 0.0f, 0.0f)), m_up(XMVectorSet(0.0f, 1.0f, 0.0f, 0.0f)),
-        m_rotation(XMMATRIX()), m_view(XMMATRIX()), m_cbChangeOnCameraMovement(nullptr)
+        m_rotation(XMMATRIX()), m_view(XMMATRIX()), m_cbChangeOnCameraMovement(nullptr),
+        m_previousEye(position), m_previousDirection(DEFAULT_FORWARD)
     {
     }
 
@@ -135,6 +137,37 @@ namespace library
         Update(deltaTime);
     }
 
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   Camera::LookAt
+      Summary:  Places the camera at an eye looking at a point, the way
+                a scripted path drives it. The yaw and pitch are derived
+                from the direction so that the input turns the camera
+                on from there
+      Args:     const XMVECTOR& eye
+                  Position of the camera
+                const XMVECTOR& at
+                  Point the camera looks at
+      Modifies: [m_eye, m_yaw, m_pitch, and what Update modifies].
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+
+    void Camera::LookAt(_In_ const XMVECTOR& eye, _In_ const XMVECTOR& at)
+    {
+        const XMVECTOR direction = at - eye;
+        if (XMVector3LessOrEqual(XMVector3LengthSq(direction), XMVectorReplicate(1e-6f)))
+        {
+            return;
+        }
+
+        XMFLOAT3 forward;
+        XMStoreFloat3(&forward, XMVector3Normalize(direction));
+
+        m_eye = eye;
+        m_yaw = std::atan2(forward.x, forward.z);
+        m_pitch = std::clamp(-std::asin(forward.y), -XM_PIDIV2 + 0.01f, XM_PIDIV2 - 0.01f);
+
+        Update(0.0f);
+    }
+
     /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
       Method:   Camera::Initialize
       Summary:  Initialize the view matrix constant buffers
@@ -145,6 +178,11 @@ namespace library
 
     HRESULT Camera::Initialize(_In_ ID3D11Device* device)
     {
+        if (!device)
+        {
+            return S_OK;
+        }
+
         //create constant buffer
         D3D11_BUFFER_DESC constantBd = {
             .ByteWidth = sizeof(CBChangeOnCameraMovement),
@@ -203,4 +241,59 @@ namespace library
         // determine the view matrix
         m_view = XMMatrixLookAtLH(m_eye, m_at, m_up);
     }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   Camera::SaveState
+      Summary:  Keeps the eye and the look direction before a simulation
+                step, the state rendered frames blend from
+      Modifies: [m_previousEye, m_previousDirection].
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+
+    void Camera::SaveState()
+    {
+        m_previousEye = m_eye;
+        m_previousDirection = XMVector3Normalize(m_at - m_eye);
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   Camera::GetInterpolatedEye
+      Summary:  Returns the eye between the saved and the current state
+      Args:     FLOAT alpha
+                  Blend factor, 0 for the saved state, 1 for the current
+      Returns:  XMVECTOR
+                  The eye vector
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+
+    XMVECTOR Camera::GetInterpolatedEye(_In_ FLOAT alpha) const
+    {
+        return XMVectorLerp(m_previousEye, m_eye, alpha);
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   Camera::GetInterpolatedView
+      Summary:  Returns the view between the saved and the current
+                state. The look directions are blended then normalized,
+                which is close enough to a slerp for the turn of a step
+      Args:     FLOAT alpha
+                  Blend factor, 0 for the saved state, 1 for the current
+      Returns:  XMMATRIX
+                  The view transform matrix
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+
+    XMMATRIX Camera::GetInterpolatedView(_In_ FLOAT alpha) const
+    {
+        if (alpha >= 1.0f)
+        {
+            return m_view;
+        }
+
+        const XMVECTOR direction = XMVector3Normalize(m_at - m_eye);
+        const XMVECTOR blendedDirection = XMVectorLerp(m_previousDirection, direction, alpha);
+        if (XMVector3LessOrEqual(XMVector3LengthSq(blendedDirection), XMVectorReplicate(1e-6f)))
+        {
+            return m_view;
+        }
+
+        return XMMatrixLookToLH(GetInterpolatedEye(alpha), XMVector3Normalize(blendedDirection), m_up);
+    }
 }
\ No newline at end of file
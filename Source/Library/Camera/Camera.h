@@ -30,10 +30,18 @@ namespace library
                   Get the constant buffer containing the view transform
                 HandleInput
                   Handles the keyboard / mouse input
+                LookAt
+                  Places the camera at an eye looking at a point
                 Initialize
                   Initialize the view matrix constant buffers
                 Update
                   Update the camera according to the input
+                SaveState
+                  Keeps the eye and direction before a simulation step
+                GetInterpolatedEye
+                  Returns the eye between the saved and current state
+                GetInterpolatedView
+                  Returns the view between the saved and current state
                 Camera
                   Constructor.
                 ~Camera
@@ -57,8 +65,13 @@ namespace library
         ComPtr<ID3D11Buffer>& GetConstantBuffer();
 
         virtual void HandleInput(_In_ const DirectionsInput& directions, _In_ const MouseRelativeMovement& mouseRelativeMovement, _In_ FLOAT deltaTime);
+        void LookAt(_In_ const XMVECTOR& eye, _In_ const XMVECTOR& at);
         virtual HRESULT Initialize(_In_ ID3D11Device* device);
         virtual void Update(_In_ FLOAT deltaTime);
+
+        void SaveState();
+        XMVECTOR GetInterpolatedEye(_In_ FLOAT alpha) const;
+        XMMATRIX GetInterpolatedView(_In_ FLOAT alpha) const;
     protected:
         static constexpr const XMVECTORF32 DEFAULT_FORWARD = { 0.0f, 0.0f, 1.0f, 0.0f };
         static constexpr const XMVECTORF32 DEFAULT_RIGHT = { 1.0f, 0.0f, 0.0f, 0.0f };
@@ -88,5 +101,8 @@ namespace library
 
         XMMATRIX m_rotation;
         XMMATRIX m_view;
+
+        XMVECTOR m_previousEye;
+        XMVECTOR m_previousDirection;
     };
 }
\ No newline at end of file
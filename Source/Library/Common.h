@@ -11,6 +11,8 @@
 ===================================================================+*/
 #pragma once
 
+#ifdef _WIN32
+
 #ifndef  UNICODE
 #define UNICODE
 #endif // ! UNICODE
@@ -19,6 +21,10 @@
 #define WIN32_LEAN_AND_MEAN
 #endif // ! WIN32_LEAN_AND_MEAN
 
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif // ! NOMINMAX
+
 #include <windows.h>
 #include <wincodec.h>
 #include <wrl.h>
@@ -35,6 +41,12 @@
 #include <stdlib.h>
 #include <crtdbg.h>
 
+#else
+
+#include "Platform.h"
+
+#endif // _WIN32
+
 #include <cassert>
 #include <filesystem>
 #include <memory>
@@ -47,8 +59,10 @@
 
 constexpr LPCWSTR PSZ_COURSE_TITLE = L"Game Graphics Programming";
 
+#ifdef _WIN32
 using namespace Microsoft::WRL;
 using namespace DirectX;
+#endif // _WIN32
 
 #define ASSIMP_LOAD_FLAGS (aiProcess_Triangulate | aiProcess_GenSmoothNormals | aiProcess_FlipUVs | aiProcess_JoinIdenticalVertices | aiProcess_ConvertToLeftHanded | aiProcess_CalcTangentSpace)
 
@@ -0,0 +1,198 @@
+#include "Game/FramePipeline.h"
+
+#include <chrono>
+
+#include "Profiler/CpuProfiler.h"
+
+namespace library
+{
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   FramePipeline::FramePipeline
+      Summary:  Constructor. The stages run one after the other until
+                the pipeline is initialized
+      Modifies: [m_worker, m_mutex, m_startCondition,
+                  m_completeCondition, m_pSimulate, m_bPipelined,
+                  m_bShutdown, m_uNumFrames, m_simulationTime,
+                  m_renderTime, m_frameTime].
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    FramePipeline::FramePipeline()
+        : m_worker()
+        , m_mutex()
+        , m_startCondition()
+        , m_completeCondition()
+        , m_pSimulate(nullptr)
+        , m_bPipelined(FALSE)
+        , m_bShutdown(FALSE)
+        , m_uNumFrames(0u)
+        , m_simulationTime(0.0f)
+        , m_renderTime(0.0f)
+        , m_frameTime(0.0f)
+    {
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   FramePipeline::~FramePipeline
+      Summary:  Destructor. Stops and joins the simulation thread
+      Modifies: [m_worker, m_bShutdown].
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    FramePipeline::~FramePipeline()
+    {
+        shutdown();
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   FramePipeline::Initialize
+      Summary:  Starts the simulation thread, or stops it to run the
+                stages one after the other. Must not be called during a
+                frame
+      Args:     BOOL bPipelined
+                  TRUE to overlap the stages
+      Modifies: [m_worker, m_bPipelined, m_bShutdown].
+      Returns:  HRESULT
+                  Status code
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    HRESULT FramePipeline::Initialize(_In_ BOOL bPipelined)
+    {
+        shutdown();
+
+        m_bPipelined = bPipelined;
+        if (m_bPipelined)
+        {
+            m_bShutdown = FALSE;
+            m_worker = std::thread(&FramePipeline::workerMain, this);
+        }
+
+        return S_OK;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   FramePipeline::RunFrame
+      Summary:  Hands the simulation stage to the simulation thread,
+                runs the render stage on the calling thread and waits
+                for both. Without pipelining, simulates then renders
+      Args:     const std::function<void()>& simulate
+                  Simulation stage of the next frame
+                const std::function<void()>& render
+                  Render stage of the current frame
+      Modifies: [m_pSimulate, m_uNumFrames, m_simulationTime,
+                  m_renderTime, m_frameTime].
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    void FramePipeline::RunFrame(_In_ const std::function<void()>& simulate, _In_ const std::function<void()>& render)
+    {
+        const std::chrono::steady_clock::time_point frameStart = std::chrono::steady_clock::now();
+
+        if (!m_bPipelined)
+        {
+            simulate();
+            const std::chrono::steady_clock::time_point renderStart = std::chrono::steady_clock::now();
+            render();
+            const std::chrono::steady_clock::time_point frameEnd = std::chrono::steady_clock::now();
+
+            m_simulationTime = std::chrono::duration<FLOAT, std::milli>(renderStart - frameStart).count();
+            m_renderTime = std::chrono::duration<FLOAT, std::milli>(frameEnd - renderStart).count();
+            m_frameTime = std::chrono::duration<FLOAT, std::milli>(frameEnd - frameStart).count();
+            ++m_uNumFrames;
+            return;
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_pSimulate = &simulate;
+        }
+        m_startCondition.notify_one();
+
+        render();
+        m_renderTime = std::chrono::duration<FLOAT, std::milli>(std::chrono::steady_clock::now() - frameStart).count();
+
+        // The simulation thread times its own stage
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_completeCondition.wait(lock, [this] { return m_pSimulate == nullptr; });
+        m_frameTime = std::chrono::duration<FLOAT, std::milli>(std::chrono::steady_clock::now() - frameStart).count();
+        ++m_uNumFrames;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   FramePipeline::IsPipelined
+      Summary:  Tells whether the stages overlap
+      Returns:  BOOL
+                  TRUE if the simulation runs on its own thread
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    BOOL FramePipeline::IsPipelined() const
+    {
+        return m_bPipelined;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   FramePipeline::GetStatistics
+      Summary:  Returns the times of the last frame
+      Returns:  FramePipelineStatistics
+                  Number of frames and the times of the stages
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    FramePipelineStatistics FramePipeline::GetStatistics() const
+    {
+        return
+        {
+            .uNumFrames = m_uNumFrames,
+            .simulationTime = m_simulationTime,
+            .renderTime = m_renderTime,
+            .frameTime = m_frameTime
+        };
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   FramePipeline::shutdown
+      Summary:  Wakes the simulation thread up to exit and joins it
+      Modifies: [m_worker, m_bShutdown].
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    void FramePipeline::shutdown()
+    {
+        if (!m_worker.joinable())
+        {
+            return;
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_bShutdown = TRUE;
+        }
+        m_startCondition.notify_one();
+
+        m_worker.join();
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   FramePipeline::workerMain
+      Summary:  Loop of the simulation thread, runs each simulation
+                stage it is handed until shut down
+      Modifies: [m_pSimulate, m_simulationTime].
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    void FramePipeline::workerMain()
+    {
+        PROFILE_THREAD_NAME("Simulation");
+
+        for (;;)
+        {
+            const std::function<void()>* pSimulate = nullptr;
+            {
+                std::unique_lock<std::mutex> lock(m_mutex);
+                m_startCondition.wait(lock, [this] { return m_bShutdown || m_pSimulate != nullptr; });
+                if (m_bShutdown)
+                {
+                    return;
+                }
+                pSimulate = m_pSimulate;
+            }
+
+            const std::chrono::steady_clock::time_point simulationStart = std::chrono::steady_clock::now();
+            (*pSimulate)();
+            const FLOAT simulationTime = std::chrono::duration<FLOAT, std::milli>(std::chrono::steady_clock::now() - simulationStart).count();
+
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                m_simulationTime = simulationTime;
+                m_pSimulate = nullptr;
+            }
+            m_completeCondition.notify_one();
+        }
+    }
+}
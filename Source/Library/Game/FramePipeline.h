@@ -0,0 +1,96 @@
+﻿/*+===================================================================
+  File:      FRAMEPIPELINE.H
+
+  Summary:   FramePipeline header file contains declarations of the
+             FramePipeline class that overlaps the simulation of a frame
+             with the rendering of the previous one on two threads.
+
+  Classes: FramePipeline
+
+  © 2022 Kyung Hee University
+===================================================================+*/
+#pragma once
+
+#include "Common.h"
+
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+namespace library
+{
+    /*S+S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S
+      Struct:   FramePipelineStatistics
+
+      Summary:  Times of the last frame of the pipeline, in
+                milliseconds. The frame time is the time both stages
+                took together, the longer of the two when pipelined,
+                their sum otherwise
+    S---S---S---S---S---S---S---S---S---S---S---S---S---S---S---S---S-S*/
+    struct FramePipelineStatistics
+    {
+        UINT64 uNumFrames;
+        FLOAT simulationTime;
+        FLOAT renderTime;
+        FLOAT frameTime;
+    };
+
+    /*C+C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C
+      Class:    FramePipeline
+
+      Summary:  Two stage frame pipeline. The simulation stage of frame
+                N + 1 runs on a worker thread while the calling thread
+                renders frame N, and a frame returns once both are done.
+                The stages must not share state: the simulation writes
+                the back frame snapshot of the renderer and the render
+                reads the front one, swapped between frames. The
+                render stage stays on the calling thread, the one that
+                owns the device context. Without pipelining the stages
+                run one after the other on the calling thread
+
+      Methods:  Initialize
+                  Starts the simulation thread when pipelined
+                RunFrame
+                  Runs the simulation and render stages of a frame
+                IsPipelined
+                  Tells whether the stages overlap
+                GetStatistics
+                  Returns the times of the last frame
+                FramePipeline
+                  Constructor.
+                ~FramePipeline
+                  Destructor.
+    C---C---C---C---C---C---C---C---C---C---C---C---C---C---C---C---C-C*/
+    class FramePipeline final
+    {
+    public:
+        FramePipeline();
+        FramePipeline(const FramePipeline& other) = delete;
+        FramePipeline(FramePipeline&& other) = delete;
+        FramePipeline& operator=(const FramePipeline& other) = delete;
+        FramePipeline& operator=(FramePipeline&& other) = delete;
+        ~FramePipeline();
+
+        HRESULT Initialize(_In_ BOOL bPipelined);
+        void RunFrame(_In_ const std::function<void()>& simulate, _In_ const std::function<void()>& render);
+        BOOL IsPipelined() const;
+        FramePipelineStatistics GetStatistics() const;
+
+    private:
+        void shutdown();
+        void workerMain();
+
+        std::thread m_worker;
+        std::mutex m_mutex;
+        std::condition_variable m_startCondition;
+        std::condition_variable m_completeCondition;
+        const std::function<void()>* m_pSimulate;
+        BOOL m_bPipelined;
+        BOOL m_bShutdown;
+        UINT64 m_uNumFrames;
+        FLOAT m_simulationTime;
+        FLOAT m_renderTime;
+        FLOAT m_frameTime;
+    };
+}
@@ -0,0 +1,395 @@
+#include "Game/FrameTimer.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <thread>
+
+namespace library
+{
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   SteadyClock::SteadyClock
+      Summary:  Constructor. Time starts from zero
+      Modifies: [m_start, m_hTimer].
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    SteadyClock::SteadyClock()
+        : m_start(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count())
+#ifdef _WIN32
+        , m_hTimer(CreateWaitableTimerExW(nullptr, nullptr, CREATE_WAITABLE_TIMER_HIGH_RESOLUTION, TIMER_ALL_ACCESS))
+#endif // _WIN32
+    {
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   SteadyClock::~SteadyClock
+      Summary:  Destructor
+      Modifies: [m_hTimer].
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    SteadyClock::~SteadyClock()
+    {
+#ifdef _WIN32
+        if (m_hTimer)
+        {
+            CloseHandle(m_hTimer);
+        }
+#endif // _WIN32
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   SteadyClock::GetTime
+      Summary:  Returns the time since the clock was made
+      Returns:  double
+                  Time in seconds
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    double SteadyClock::GetTime()
+    {
+        const INT64 now = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+
+        return static_cast<double>(now - m_start) * 1e-9;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   SteadyClock::Sleep
+      Summary:  Waits for a duration, or yields the thread for zero
+      Args:     double seconds
+                  Duration of the wait
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    void SteadyClock::Sleep(_In_ double seconds)
+    {
+        if (seconds <= 0.0)
+        {
+            std::this_thread::yield();
+            return;
+        }
+
+#ifdef _WIN32
+        // Due times are relative when negative, in 100 ns units
+        if (m_hTimer)
+        {
+            LARGE_INTEGER dueTime = { .QuadPart = -static_cast<LONGLONG>(seconds * 1e7) };
+            if (SetWaitableTimerEx(m_hTimer, &dueTime, 0, nullptr, nullptr, nullptr, 0))
+            {
+                WaitForSingleObject(m_hTimer, INFINITE);
+                return;
+            }
+        }
+#endif // _WIN32
+
+        std::this_thread::sleep_for(std::chrono::duration<double>(seconds));
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   FrameTimer::FrameTimer
+      Summary:  Constructor. Measures time with the steady clock of the
+                system, steps at 60 Hz and does not limit frames
+      Modifies: [m_clock, m_timestep, m_uMaxStepsPerFrame, m_frameLimit,
+                  m_sleepStrategy, m_spinThreshold, and the counters].
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    FrameTimer::FrameTimer()
+        : FrameTimer(std::make_unique<SteadyClock>())
+    {
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   FrameTimer::FrameTimer
+      Summary:  Constructor. Measures time with the given clock, steps at
+                60 Hz and does not limit frames
+      Args:     std::unique_ptr<Clock>&& clock
+                  Source of time
+      Modifies: [m_clock, m_timestep, m_uMaxStepsPerFrame, m_frameLimit,
+                  m_sleepStrategy, m_spinThreshold, and the counters].
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    FrameTimer::FrameTimer(_In_ std::unique_ptr<Clock>&& clock)
+        : m_clock(std::move(clock))
+        , m_timestep(DEFAULT_TIMESTEP)
+        , m_uMaxStepsPerFrame(DEFAULT_MAX_STEPS_PER_FRAME)
+        , m_frameLimit(0.0f)
+        , m_sleepStrategy(eSleepStrategy::SLEEP_THEN_SPIN)
+        , m_spinThreshold(DEFAULT_SPIN_THRESHOLD)
+        , m_previousTime(0.0)
+        , m_frameStartTime(0.0)
+        , m_accumulator(0.0)
+        , m_uNumFrames(0u)
+        , m_uNumSteps(0u)
+        , m_uNumDroppedSteps(0u)
+        , m_frameTime(0.0f)
+        , m_waitTime(0.0)
+    {
+        Reset();
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   FrameTimer::SetTimestep
+      Summary:  Sets the duration of a simulation step
+      Args:     FLOAT timestep
+                  Duration in seconds, ignored if not positive
+      Modifies: [m_timestep].
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    void FrameTimer::SetTimestep(_In_ FLOAT timestep)
+    {
+        if (timestep > 0.0f)
+        {
+            m_timestep = timestep;
+        }
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   FrameTimer::GetTimestep
+      Summary:  Returns the duration of a simulation step
+      Returns:  FLOAT
+                  Duration in seconds
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    FLOAT FrameTimer::GetTimestep() const
+    {
+        return m_timestep;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   FrameTimer::SetMaxStepsPerFrame
+      Summary:  Sets the steps a frame may run at most
+      Args:     UINT uMaxStepsPerFrame
+                  Number of steps, at least one
+      Modifies: [m_uMaxStepsPerFrame].
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    void FrameTimer::SetMaxStepsPerFrame(_In_ UINT uMaxStepsPerFrame)
+    {
+        m_uMaxStepsPerFrame = std::max(uMaxStepsPerFrame, 1u);
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   FrameTimer::GetMaxStepsPerFrame
+      Summary:  Returns the steps a frame may run at most
+      Returns:  UINT
+                  Number of steps
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    UINT FrameTimer::GetMaxStepsPerFrame() const
+    {
+        return m_uMaxStepsPerFrame;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   FrameTimer::SetFrameLimit
+      Summary:  Sets the frames per second the limiter keeps to
+      Args:     FLOAT framesPerSecond
+                  Frame rate, zero or less does not limit frames
+      Modifies: [m_frameLimit].
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    void FrameTimer::SetFrameLimit(_In_ FLOAT framesPerSecond)
+    {
+        m_frameLimit = std::max(framesPerSecond, 0.0f);
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   FrameTimer::GetFrameLimit
+      Summary:  Returns the frames per second the limiter keeps to
+      Returns:  FLOAT
+                  Frame rate, zero if frames are not limited
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    FLOAT FrameTimer::GetFrameLimit() const
+    {
+        return m_frameLimit;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   FrameTimer::SetSleepStrategy
+      Summary:  Sets how the limiter waits
+      Args:     eSleepStrategy sleepStrategy
+                  Strategy of the wait
+      Modifies: [m_sleepStrategy].
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    void FrameTimer::SetSleepStrategy(_In_ eSleepStrategy sleepStrategy)
+    {
+        m_sleepStrategy = sleepStrategy;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   FrameTimer::GetSleepStrategy
+      Summary:  Returns how the limiter waits
+      Returns:  eSleepStrategy
+                  Strategy of the wait
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    eSleepStrategy FrameTimer::GetSleepStrategy() const
+    {
+        return m_sleepStrategy;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   FrameTimer::SetSpinThreshold
+      Summary:  Sets the time before a frame the limiter spins for with
+                SLEEP_THEN_SPIN. It covers how late a sleep may wake up
+      Args:     FLOAT spinThreshold
+                  Duration in seconds
+      Modifies: [m_spinThreshold].
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    void FrameTimer::SetSpinThreshold(_In_ FLOAT spinThreshold)
+    {
+        m_spinThreshold = std::max(spinThreshold, 0.0f);
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   FrameTimer::GetSpinThreshold
+      Summary:  Returns the time before a frame the limiter spins for
+      Returns:  FLOAT
+                  Duration in seconds
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    FLOAT FrameTimer::GetSpinThreshold() const
+    {
+        return m_spinThreshold;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   FrameTimer::Reset
+      Summary:  Starts measuring time from now, with nothing left to
+                simulate, and zeroes the counters. Called before the
+                loop so loading does not count as a frame
+      Modifies: [m_previousTime, m_frameStartTime, m_accumulator, and the
+                  counters].
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    void FrameTimer::Reset()
+    {
+        m_previousTime = m_clock->GetTime();
+        m_frameStartTime = m_previousTime;
+        m_accumulator = 0.0;
+        m_uNumFrames = 0u;
+        m_uNumSteps = 0u;
+        m_uNumDroppedSteps = 0u;
+        m_frameTime = 0.0f;
+        m_waitTime = 0.0;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   FrameTimer::Advance
+      Summary:  Adds the time since the last frame to the accumulator
+                and takes the whole steps out of it. Steps beyond the
+                most a frame may run are dropped. The accumulator is
+                kept in double precision, it would lose the fraction of
+                a step to rounding over a long session otherwise
+      Modifies: [m_previousTime, m_frameStartTime, m_accumulator, and the
+                  counters].
+      Returns:  UINT
+                  Number of steps to simulate this frame
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    UINT FrameTimer::Advance()
+    {
+        const double now = m_clock->GetTime();
+        const double frameTime = std::max(now - m_previousTime, 0.0);
+        m_previousTime = now;
+        m_frameStartTime = now;
+        m_frameTime = static_cast<FLOAT>(frameTime * 1000.0);
+        m_accumulator += frameTime;
+
+        const double timestep = static_cast<double>(m_timestep);
+        const double numSteps = std::floor(m_accumulator / timestep);
+        UINT uNumSteps = m_uMaxStepsPerFrame;
+        if (numSteps > static_cast<double>(m_uMaxStepsPerFrame))
+        {
+            m_uNumDroppedSteps += static_cast<UINT64>(numSteps) - m_uMaxStepsPerFrame;
+            m_accumulator = std::fmod(m_accumulator, timestep);
+        }
+        else
+        {
+            uNumSteps = static_cast<UINT>(numSteps);
+            m_accumulator -= numSteps * timestep;
+        }
+
+        ++m_uNumFrames;
+        m_uNumSteps += uNumSteps;
+
+        return uNumSteps;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   FrameTimer::GetAlpha
+      Summary:  Returns the fraction of a step the accumulator holds
+                after the steps of the frame, how far the rendered frame
+                is from the previous state to the current one
+      Returns:  FLOAT
+                  Blend factor in [0, 1)
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    FLOAT FrameTimer::GetAlpha() const
+    {
+        return std::clamp(static_cast<FLOAT>(m_accumulator / static_cast<double>(m_timestep)), 0.0f, 1.0f);
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   FrameTimer::WaitForNextFrame
+      Summary:  Waits until a frame period after the start of the frame
+                with the sleep strategy. Returns at once without a frame
+                limit or when the frame already took longer
+      Modifies: [m_waitTime].
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    void FrameTimer::WaitForNextFrame()
+    {
+        if (m_frameLimit <= 0.0f)
+        {
+            return;
+        }
+
+        const double waitStart = m_clock->GetTime();
+        const double frameEnd = m_frameStartTime + 1.0 / static_cast<double>(m_frameLimit);
+        if (waitStart >= frameEnd)
+        {
+            return;
+        }
+
+        switch (m_sleepStrategy)
+        {
+        case eSleepStrategy::SLEEP:
+            m_clock->Sleep(frameEnd - waitStart);
+            break;
+
+        case eSleepStrategy::SLEEP_THEN_SPIN:
+        {
+            const double spinStart = frameEnd - static_cast<double>(m_spinThreshold);
+            if (waitStart < spinStart)
+            {
+                m_clock->Sleep(spinStart - waitStart);
+            }
+            while (m_clock->GetTime() < frameEnd)
+            {
+                m_clock->Sleep(0.0);
+            }
+            break;
+        }
+
+        case eSleepStrategy::SPIN:
+        default:
+            while (m_clock->GetTime() < frameEnd)
+            {
+                m_clock->Sleep(0.0);
+            }
+            break;
+        }
+
+        m_waitTime += (m_clock->GetTime() - waitStart) * 1000.0;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   FrameTimer::GetClock
+      Summary:  Returns the clock of the timer
+      Returns:  Clock&
+                  Source of time
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    Clock& FrameTimer::GetClock()
+    {
+        return *m_clock;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   FrameTimer::GetStatistics
+      Summary:  Returns the counters since the timer was reset
+      Returns:  FrameTimerStatistics
+                  Frames, steps and times
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    FrameTimerStatistics FrameTimer::GetStatistics() const
+    {
+        return
+        {
+            .uNumFrames = m_uNumFrames,
+            .uNumSteps = m_uNumSteps,
+            .uNumDroppedSteps = m_uNumDroppedSteps,
+            .frameTime = m_frameTime,
+            .waitTime = static_cast<FLOAT>(m_waitTime)
+        };
+    }
+}
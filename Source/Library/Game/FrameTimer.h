@@ -0,0 +1,221 @@
+﻿/*+===================================================================
+  File:      FRAMETIMER.H
+
+  Summary:   FrameTimer header file contains declarations of the Clock
+             interface, the SteadyClock class and the FrameTimer class
+             that paces the game loop, stepping the simulation at a
+             fixed rate and limiting the rate of the rendered frames.
+
+  Classes: Clock, SteadyClock, FrameTimer
+
+  © 2022 Kyung Hee University
+===================================================================+*/
+#pragma once
+
+#include "Common.h"
+
+namespace library
+{
+    /*E+E+++E+++E+++E+++E+++E+++E+++E+++E+++E+++E+++E+++E+++E+++E+++E+++E
+      Enum:     eSleepStrategy
+
+      Summary:  How the frame limiter waits for the next frame. SPIN
+                yields until the time has come, precise but keeps a core
+                busy. SLEEP gives the core back but wakes up as late as
+                the scheduler decides. SLEEP_THEN_SPIN sleeps until the
+                spin threshold before the frame, then spins
+    E---E---E---E---E---E---E---E---E---E---E---E---E---E---E---E---E-E*/
+    enum class eSleepStrategy : UINT
+    {
+        SPIN = 0u,
+        SLEEP,
+        SLEEP_THEN_SPIN,
+        COUNT,
+    };
+
+    /*C+C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C
+      Class:    Clock
+
+      Summary:  Source of time of the frame timer. Tests replace it
+                with a clock they advance by hand
+
+      Methods:  GetTime
+                  Returns the time in seconds since an arbitrary origin
+                Sleep
+                  Waits, sleeping for zero seconds yields the thread
+                Clock
+                  Constructor.
+                ~Clock
+                  Destructor.
+    C---C---C---C---C---C---C---C---C---C---C---C---C---C---C---C---C-C*/
+    class Clock
+    {
+    public:
+        Clock() = default;
+        Clock(const Clock& other) = delete;
+        Clock(Clock&& other) = delete;
+        Clock& operator=(const Clock& other) = delete;
+        Clock& operator=(Clock&& other) = delete;
+        virtual ~Clock() = default;
+
+        virtual double GetTime() = 0;
+        virtual void Sleep(_In_ double seconds) = 0;
+    };
+
+    /*C+C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C
+      Class:    SteadyClock
+
+      Summary:  Monotonic clock of the system. On Windows it sleeps on a
+                high resolution waitable timer when the system has one,
+                so a sleep is not rounded up to the 15.6 ms tick
+
+      Methods:  GetTime
+                  Returns the time in seconds since the clock was made
+                Sleep
+                  Waits, sleeping for zero seconds yields the thread
+                SteadyClock
+                  Constructor.
+                ~SteadyClock
+                  Destructor.
+    C---C---C---C---C---C---C---C---C---C---C---C---C---C---C---C---C-C*/
+    class SteadyClock final : public Clock
+    {
+    public:
+        SteadyClock();
+        SteadyClock(const SteadyClock& other) = delete;
+        SteadyClock(SteadyClock&& other) = delete;
+        SteadyClock& operator=(const SteadyClock& other) = delete;
+        SteadyClock& operator=(SteadyClock&& other) = delete;
+        ~SteadyClock();
+
+        double GetTime() override;
+        void Sleep(_In_ double seconds) override;
+
+    private:
+        INT64 m_start;
+#ifdef _WIN32
+        HANDLE m_hTimer;
+#endif // _WIN32
+    };
+
+    /*S+S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S
+      Struct:   FrameTimerStatistics
+
+      Summary:  Counters of the frame timer since it was reset. Dropped
+                steps are those the simulation fell behind by more than
+                the steps a frame may run, they are never caught up.
+                Times are in milliseconds, the frame time of the last
+                frame, the wait time summed over every frame
+    S---S---S---S---S---S---S---S---S---S---S---S---S---S---S---S---S-S*/
+    struct FrameTimerStatistics
+    {
+        UINT64 uNumFrames;
+        UINT64 uNumSteps;
+        UINT64 uNumDroppedSteps;
+        FLOAT frameTime;
+        FLOAT waitTime;
+    };
+
+    /*C+C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C
+      Class:    FrameTimer
+
+      Summary:  Fixed timestep pacing of the game loop. The time a frame
+                took is added to an accumulator that the simulation
+                drains in steps of the timestep, so it advances by the
+                same amount whatever the frame rate. What is left, a
+                fraction of a step, is the alpha the renderer blends the
+                previous and current states with. Frames that come too
+                late run at most a bounded number of steps and drop the
+                rest, so a stall does not turn into a spiral of ever
+                longer frames. The frame limiter then waits until the
+                next frame is due, with the sleep strategy set
+
+      Methods:  SetTimestep
+                  Sets the duration of a simulation step
+                GetTimestep
+                  Returns the duration of a simulation step
+                SetMaxStepsPerFrame
+                  Sets the steps a frame may run at most
+                GetMaxStepsPerFrame
+                  Returns the steps a frame may run at most
+                SetFrameLimit
+                  Sets the frames per second the limiter keeps to
+                GetFrameLimit
+                  Returns the frames per second the limiter keeps to
+                SetSleepStrategy
+                  Sets how the limiter waits
+                GetSleepStrategy
+                  Returns how the limiter waits
+                SetSpinThreshold
+                  Sets the time before a frame the limiter spins for
+                GetSpinThreshold
+                  Returns the time before a frame the limiter spins for
+                Reset
+                  Starts measuring time from now
+                Advance
+                  Measures the frame and returns the steps to run
+                GetAlpha
+                  Returns the fraction of a step left to simulate
+                WaitForNextFrame
+                  Waits until the next frame is due
+                GetClock
+                  Returns the clock
+                GetStatistics
+                  Returns the counters since the timer was reset
+                FrameTimer
+                  Constructor.
+                ~FrameTimer
+                  Destructor.
+    C---C---C---C---C---C---C---C---C---C---C---C---C---C---C---C---C-C*/
+    class FrameTimer final
+    {
+    public:
+        static constexpr FLOAT DEFAULT_TIMESTEP = 1.0f / 60.0f;
+        static constexpr UINT DEFAULT_MAX_STEPS_PER_FRAME = 8u;
+        static constexpr FLOAT DEFAULT_SPIN_THRESHOLD = 0.002f;
+
+    public:
+        FrameTimer();
+        explicit FrameTimer(_In_ std::unique_ptr<Clock>&& clock);
+        FrameTimer(const FrameTimer& other) = delete;
+        FrameTimer(FrameTimer&& other) = delete;
+        FrameTimer& operator=(const FrameTimer& other) = delete;
+        FrameTimer& operator=(FrameTimer&& other) = delete;
+        ~FrameTimer() = default;
+
+        void SetTimestep(_In_ FLOAT timestep);
+        FLOAT GetTimestep() const;
+        void SetMaxStepsPerFrame(_In_ UINT uMaxStepsPerFrame);
+        UINT GetMaxStepsPerFrame() const;
+        void SetFrameLimit(_In_ FLOAT framesPerSecond);
+        FLOAT GetFrameLimit() const;
+        void SetSleepStrategy(_In_ eSleepStrategy sleepStrategy);
+        eSleepStrategy GetSleepStrategy() const;
+        void SetSpinThreshold(_In_ FLOAT spinThreshold);
+        FLOAT GetSpinThreshold() const;
+
+        void Reset();
+        UINT Advance();
+        FLOAT GetAlpha() const;
+        void WaitForNextFrame();
+
+        Clock& GetClock();
+        FrameTimerStatistics GetStatistics() const;
+
+    private:
+        std::unique_ptr<Clock> m_clock;
+        FLOAT m_timestep;
+        UINT m_uMaxStepsPerFrame;
+        FLOAT m_frameLimit;
+        eSleepStrategy m_sleepStrategy;
+        FLOAT m_spinThreshold;
+        double m_previousTime;
+        double m_frameStartTime;
+        double m_accumulator;
+        UINT64 m_uNumFrames;
+        UINT64 m_uNumSteps;
+        UINT64 m_uNumDroppedSteps;
+        FLOAT m_frameTime;
+        double m_waitTime;
+    };
+}
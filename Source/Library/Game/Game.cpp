@@ -1,5 +1,8 @@
 ﻿#include "Game/Game.h"
 
+#include "Memory/FrameArena.h"
+#include "Profiler/CpuProfiler.h"
+
 namespace library
 {
 
@@ -8,13 +11,19 @@ namespace library
       Summary:  Constructor
       Args:     PCWSTR pszGameName
                   Name of the game
-      Modifies: [m_pszGameName, m_mainWindow, m_renderer].
+      Modifies: [m_pszGameName, m_mainWindow, m_renderer,
+                 m_frameTimer, m_framePipeline, m_inputRecorder,
+                 m_inputReplayer].
     M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
 
     Game::Game(_In_ PCWSTR pszGameName)
         : m_pszGameName(pszGameName),
         m_mainWindow(std::make_unique<MainWindow>()),
-        m_renderer(std::make_unique<Renderer>())
+        m_renderer(std::make_unique<Renderer>()),
+        m_frameTimer(),
+        m_framePipeline(),
+        m_inputRecorder(),
+        m_inputReplayer()
     {
     }
 
@@ -26,7 +35,7 @@ namespace library
                 INT nCmdShow
                   Is a flag that says whether the main application window
                   will be minimized, maximized, or shown normally
-      Modifies: [m_mainWindow, m_renderer].
+      Modifies: [m_mainWindow, m_renderer, m_framePipeline].
       Returns:  HRESULT
                 Status code
     M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
@@ -47,26 +56,42 @@ namespace library
         if (FAILED(hr))
             return hr;
 
+        // A single core gains nothing from a second thread
+        hr = m_framePipeline.Initialize(std::thread::hardware_concurrency() > 1u);
+        if (FAILED(hr))
+            return hr;
+
         return S_OK;
 
     }
 
     /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
       Method:   Game::Run
-      Summary:  Runs the game loop
+      Summary:  Runs the game loop. Every frame handles the pending
+                messages and reads the input, then the frame pipeline
+                simulates the next frame, stepping at the fixed
+                timestep of the frame timer as many times as the
+                elapsed time calls for, while it renders the frame
+                captured by the previous simulation. Frames are shown
+                one frame after they are simulated. The mouse movement
+                is kept for the next step on frames that run none.
+                While an input log replays, its frames replace the steps
+                and the input of the timer and the window, and the game
+                quits after the last one. Recorded frames are those
+                simulated, replayed or not
+      Modifies: [m_frameTimer, m_framePipeline, m_inputRecorder,
+                  m_inputReplayer].
       Returns:  INT
                   Status code to return to the operating system
     M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
 
     INT Game::Run()
     {
-        LARGE_INTEGER startingTime, endingTime;
-        LARGE_INTEGER frequency;
-
-        float elapsedTime;
-
-        QueryPerformanceFrequency(&frequency);
-        QueryPerformanceCounter(&startingTime);
+        // Loading is not simulated time, the first frame is captured as loaded
+        m_renderer->SaveState();
+        m_renderer->CaptureFrame(1.0f);
+        m_renderer->SwapFrames();
+        m_frameTimer.Reset();
 
         // Main message loop
         MSG msg = { 0 };
@@ -74,40 +99,55 @@ namespace library
         // Main message loop
         while (WM_QUIT != msg.message)
         {
-
-
             if (PeekMessage(&msg, nullptr, 0, 0, PM_REMOVE))
             {
                 TranslateMessage(&msg);
                 DispatchMessage(&msg);
+                continue;
             }
-            else
-            {
-                // update the elapsed time
-                QueryPerformanceCounter(&endingTime);
-                elapsedTime = (FLOAT)(endingTime.QuadPart - startingTime.QuadPart);
-                elapsedTime /= (FLOAT)frequency.QuadPart;
 
-                // handling input
-                m_renderer->HandleInput(
-                    m_mainWindow->GetDirections(),
-                    m_mainWindow->GetMouseRelativeMovement(),
-                    elapsedTime
-                );
-                m_mainWindow->ResetMouseMovement();
-
-
-                // update the renderer
-                m_renderer->Update(elapsedTime);
-
-                QueryPerformanceCounter(&startingTime);
-
-                // render game
-                m_renderer->Render(); // Do some rendering
+            {
+                PROFILE_SCOPE("Frame");
+
+                // The window writes the input on this thread, the simulation reads a copy
+                InputFrame frame =
+                {
+                    .uNumSteps = m_frameTimer.Advance(),
+                    .alpha = m_frameTimer.GetAlpha(),
+                    .directions = m_mainWindow->GetDirections(),
+                    .mouseRelativeMovement = m_mainWindow->GetMouseRelativeMovement()
+                };
+                if (frame.uNumSteps != 0u)
+                {
+                    m_mainWindow->ResetMouseMovement();
+                }
+
+                if (m_inputReplayer.IsReplaying())
+                {
+                    m_inputReplayer.ReadFrame(frame);
+                    if (!m_inputReplayer.IsReplaying())
+                    {
+                        PostQuitMessage(0);
+                    }
+                }
+                m_inputRecorder.RecordFrame(frame);
+
+                m_framePipeline.RunFrame(
+                    [&]()
+                    {
+                        simulate(frame.uNumSteps, frame.directions, frame.mouseRelativeMovement, frame.alpha);
+                    },
+                    [this]()
+                    {
+                        m_renderer->RenderFrame();
+                    });
+                m_renderer->SwapFrames();
             }
-        }
-
+            PROFILE_END_FRAME();
+            FrameMemory::GetGlobal().EndFrame();
 
+            m_frameTimer.WaitForNextFrame();
+        }
 
         return static_cast<INT>(msg.wParam);
     }
@@ -148,4 +188,121 @@ namespace library
     {
         return m_renderer;
     }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   Game::GetFrameTimer
+      Summary:  Returns the timer pacing the game loop, to set the
+                timestep, the frame limit and the sleep strategy
+      Returns:  FrameTimer&
+                  The frame timer
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+
+    FrameTimer& Game::GetFrameTimer()
+    {
+        return m_frameTimer;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   Game::GetFramePipeline
+      Summary:  Returns the pipeline overlapping the simulation of a
+                frame with the rendering of the previous one
+      Returns:  FramePipeline&
+                  The frame pipeline
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+
+    FramePipeline& Game::GetFramePipeline()
+    {
+        return m_framePipeline;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   Game::StartInputRecording
+      Summary:  Starts recording the steps and the input of every frame
+                at the timestep of the frame timer, which must be set
+                before
+      Modifies: [m_inputRecorder].
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+
+    void Game::StartInputRecording()
+    {
+        m_inputRecorder.Start(m_frameTimer.GetTimestep());
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   Game::SaveInputRecording
+      Summary:  Stops recording and writes the frames recorded to an
+                input log
+      Args:     const std::filesystem::path& filePath
+                  Path of the log
+      Modifies: [m_inputRecorder].
+      Returns:  HRESULT
+                  Status code
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+
+    HRESULT Game::SaveInputRecording(_In_ const std::filesystem::path& filePath)
+    {
+        m_inputRecorder.Stop();
+
+        return m_inputRecorder.Save(filePath);
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   Game::ReplayInput
+      Summary:  Loads an input log whose frames the game runs, at its
+                timestep, instead of those of the timer and the window
+      Args:     const std::filesystem::path& filePath
+                  Path of the log
+      Modifies: [m_inputReplayer, m_frameTimer].
+      Returns:  HRESULT
+                  Status code
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+
+    HRESULT Game::ReplayInput(_In_ const std::filesystem::path& filePath)
+    {
+        HRESULT hr = m_inputReplayer.Load(filePath);
+        if (FAILED(hr))
+        {
+            return hr;
+        }
+
+        m_frameTimer.SetTimestep(m_inputReplayer.GetTimestep());
+
+        return S_OK;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   Game::simulate
+      Summary:  Simulation stage of a frame. Runs the steps of the
+                frame, the mouse movement going to the first one, and
+                captures the frame the next render stage draws
+      Args:     UINT uNumSteps
+                  Number of fixed timesteps to simulate
+                const DirectionsInput& directions
+                  Keyboard directional input of the frame
+                const MouseRelativeMovement& mouseRelativeMovement
+                  Mouse movement since the last step
+                FLOAT alpha
+                  Fraction of a step left after the steps
+      Modifies: [m_renderer].
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+
+    void Game::simulate(_In_ UINT uNumSteps, _In_ const DirectionsInput& directions, _In_ const MouseRelativeMovement& mouseRelativeMovement,
+        _In_ FLOAT alpha)
+    {
+        PROFILE_SCOPE("Simulate");
+
+        const FLOAT timestep = m_frameTimer.GetTimestep();
+        for (UINT i = 0u; i < uNumSteps; ++i)
+        {
+            m_renderer->SaveState();
+
+            // handling input
+            m_renderer->HandleInput(directions, (i == 0u) ? mouseRelativeMovement : MouseRelativeMovement{ .X = 0, .Y = 0 }, timestep);
+
+            // update the renderer
+            m_renderer->Update(timestep);
+        }
+
+        m_renderer->CaptureFrame(alpha);
+    }
 }
\ No newline at end of file
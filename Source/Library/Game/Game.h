@@ -10,6 +10,9 @@
 
 #include "Common.h"
 
+#include "Game/FramePipeline.h"
+#include "Game/FrameTimer.h"
+#include "Game/InputRecording.h"
 #include "Renderer/Renderer.h"
 #include "Window/MainWindow.h"
 
@@ -31,6 +34,17 @@ namespace library
                 GetRenderer
                   Returns the reference to the unique pointer to the
                   renderer
+                GetFrameTimer
+                  Returns the timer pacing the game loop
+                GetFramePipeline
+                  Returns the pipeline overlapping simulation and
+                  rendering
+                StartInputRecording
+                  Starts recording the input of every frame
+                SaveInputRecording
+                  Stops recording and writes the input log
+                ReplayInput
+                  Runs the frames of an input log instead of the input
                 Game
                   Constructor.
                 ~Game
@@ -52,9 +66,22 @@ namespace library
         PCWSTR GetGameName() const;
         std::unique_ptr<MainWindow>& GetWindow();
         std::unique_ptr<Renderer>& GetRenderer();
+        FrameTimer& GetFrameTimer();
+        FramePipeline& GetFramePipeline();
+
+        void StartInputRecording();
+        HRESULT SaveInputRecording(_In_ const std::filesystem::path& filePath);
+        HRESULT ReplayInput(_In_ const std::filesystem::path& filePath);
     private:
+        void simulate(_In_ UINT uNumSteps, _In_ const DirectionsInput& directions, _In_ const MouseRelativeMovement& mouseRelativeMovement,
+            _In_ FLOAT alpha);
+
         PCWSTR m_pszGameName;
         std::unique_ptr<MainWindow> m_mainWindow;
         std::unique_ptr<Renderer> m_renderer;
+        FrameTimer m_frameTimer;
+        FramePipeline m_framePipeline;
+        InputRecorder m_inputRecorder;
+        InputReplayer m_inputReplayer;
     };
 }
\ No newline at end of file
@@ -0,0 +1,356 @@
+#include "Game/InputRecording.h"
+
+#include <cstring>
+#include <fstream>
+
+namespace library
+{
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   InputRecorder::InputRecorder
+      Summary:  Constructor. Nothing is recorded until started
+      Modifies: [m_bRecording, m_timestep, m_uNumFrames, m_aData].
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    InputRecorder::InputRecorder()
+        : m_bRecording(FALSE)
+        , m_timestep(0.0f)
+        , m_uNumFrames(0u)
+        , m_aData()
+    {
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   InputRecorder::Start
+      Summary:  Starts recording a run, the frames of a previous one are
+                dropped
+      Args:     FLOAT timestep
+                  Duration of the simulation steps of the run
+      Modifies: [m_bRecording, m_timestep, m_uNumFrames, m_aData].
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    void InputRecorder::Start(_In_ FLOAT timestep)
+    {
+        m_bRecording = TRUE;
+        m_timestep = timestep;
+        m_uNumFrames = 0u;
+        m_aData.clear();
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   InputRecorder::Stop
+      Summary:  Stops recording, the frames recorded are kept to be
+                saved
+      Modifies: [m_bRecording].
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    void InputRecorder::Stop()
+    {
+        m_bRecording = FALSE;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   InputRecorder::IsRecording
+      Summary:  Tells whether frames are recorded
+      Returns:  BOOL
+                  TRUE between Start and Stop
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    BOOL InputRecorder::IsRecording() const
+    {
+        return m_bRecording;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   InputRecorder::RecordFrame
+      Summary:  Appends a frame when recording. The mouse movement is
+                zigzag encoded, so small movements either way take a
+                byte
+      Args:     const InputFrame& frame
+                  Frame to append
+      Modifies: [m_uNumFrames, m_aData].
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    void InputRecorder::RecordFrame(_In_ const InputFrame& frame)
+    {
+        if (!m_bRecording)
+        {
+            return;
+        }
+
+        const BYTE directions = static_cast<BYTE>(
+            (frame.directions.bFront ? 0x01u : 0u) | (frame.directions.bLeft ? 0x02u : 0u) | (frame.directions.bBack ? 0x04u : 0u)
+            | (frame.directions.bRight ? 0x08u : 0u) | (frame.directions.bUp ? 0x10u : 0u) | (frame.directions.bDown ? 0x20u : 0u));
+        m_aData.push_back(directions);
+
+        writeVarint(frame.uNumSteps);
+        const INT64 aMovement[2] = { frame.mouseRelativeMovement.X, frame.mouseRelativeMovement.Y };
+        for (INT64 movement : aMovement)
+        {
+            writeVarint((static_cast<UINT64>(movement) << 1u) ^ static_cast<UINT64>(movement >> 63));
+        }
+
+        BYTE aAlpha[sizeof(FLOAT)];
+        memcpy(aAlpha, &frame.alpha, sizeof(aAlpha));
+        m_aData.insert(m_aData.end(), aAlpha, aAlpha + sizeof(aAlpha));
+
+        ++m_uNumFrames;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   InputRecorder::GetNumFrames
+      Summary:  Returns the frames recorded
+      Returns:  UINT
+                  Number of frames
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    UINT InputRecorder::GetNumFrames() const
+    {
+        return m_uNumFrames;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   InputRecorder::Save
+      Summary:  Writes the frames recorded to a log
+      Args:     const std::filesystem::path& filePath
+                  Path of the log
+      Returns:  HRESULT
+                  Status code
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    HRESULT InputRecorder::Save(_In_ const std::filesystem::path& filePath) const
+    {
+        const FileHeader header =
+        {
+            .uMagic = FILE_MAGIC,
+            .uVersion = FILE_VERSION,
+            .timestep = m_timestep,
+            .uNumFrames = m_uNumFrames,
+            .uSize = static_cast<UINT64>(m_aData.size())
+        };
+
+        std::ofstream file(filePath, std::ios::binary | std::ios::trunc);
+        file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        file.write(reinterpret_cast<const char*>(m_aData.data()), static_cast<std::streamsize>(m_aData.size()));
+        if (!file)
+        {
+            return E_FAIL;
+        }
+
+        return S_OK;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   InputRecorder::writeVarint
+      Summary:  Appends an integer seven bits a byte, low bits first,
+                the high bit of a byte set when more follow
+      Args:     UINT64 uValue
+                  Integer to append
+      Modifies: [m_aData].
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    void InputRecorder::writeVarint(_In_ UINT64 uValue)
+    {
+        while (uValue >= 0x80u)
+        {
+            m_aData.push_back(static_cast<BYTE>(uValue | 0x80u));
+            uValue >>= 7u;
+        }
+        m_aData.push_back(static_cast<BYTE>(uValue));
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   InputReplayer::InputReplayer
+      Summary:  Constructor. Nothing is replayed until a log is loaded
+      Modifies: [m_bReplaying, m_timestep, m_uNumFrames, m_uFrameIndex,
+                  m_uOffset, m_aData].
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    InputReplayer::InputReplayer()
+        : m_bReplaying(FALSE)
+        , m_timestep(0.0f)
+        , m_uNumFrames(0u)
+        , m_uFrameIndex(0u)
+        , m_uOffset(0u)
+        , m_aData()
+    {
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   InputReplayer::Load
+      Summary:  Reads a log and starts replaying it from its first frame
+      Args:     const std::filesystem::path& filePath
+                  Path of the log
+      Modifies: [m_bReplaying, m_timestep, m_uNumFrames, m_uFrameIndex,
+                  m_uOffset, m_aData].
+      Returns:  HRESULT
+                  Status code, failed if the file is missing or is not
+                  a log of this version
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    HRESULT InputReplayer::Load(_In_ const std::filesystem::path& filePath)
+    {
+        Stop();
+
+        std::ifstream file(filePath, std::ios::binary | std::ios::ate);
+        const std::streamoff size = file ? static_cast<std::streamoff>(file.tellg()) : -1;
+        if (size < static_cast<std::streamoff>(sizeof(InputRecorder::FileHeader)))
+        {
+            return E_FAIL;
+        }
+        file.seekg(0);
+
+        InputRecorder::FileHeader header;
+        if (!file.read(reinterpret_cast<char*>(&header), sizeof(header)))
+        {
+            return E_FAIL;
+        }
+        if (header.uMagic != InputRecorder::FILE_MAGIC || header.uVersion != InputRecorder::FILE_VERSION || !(header.timestep > 0.0f)
+            || header.uSize != static_cast<UINT64>(size) - sizeof(header))
+        {
+            return E_FAIL;
+        }
+
+        m_aData.resize(static_cast<size_t>(header.uSize));
+        if (!file.read(reinterpret_cast<char*>(m_aData.data()), static_cast<std::streamsize>(m_aData.size())))
+        {
+            m_aData.clear();
+            return E_FAIL;
+        }
+
+        m_timestep = header.timestep;
+        m_uNumFrames = header.uNumFrames;
+        m_bReplaying = TRUE;
+
+        return S_OK;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   InputReplayer::Stop
+      Summary:  Stops replaying and drops the log
+      Modifies: [m_bReplaying, m_uNumFrames, m_uFrameIndex, m_uOffset,
+                  m_aData].
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    void InputReplayer::Stop()
+    {
+        m_bReplaying = FALSE;
+        m_uNumFrames = 0u;
+        m_uFrameIndex = 0u;
+        m_uOffset = 0u;
+        m_aData.clear();
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   InputReplayer::IsReplaying
+      Summary:  Tells whether frames are left to replay
+      Returns:  BOOL
+                  TRUE from a load until the last frame was read
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    BOOL InputReplayer::IsReplaying() const
+    {
+        return m_bReplaying && m_uFrameIndex < m_uNumFrames;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   InputReplayer::ReadFrame
+      Summary:  Returns the next frame of the log. A log cut short ends
+                the replay where its frames do
+      Args:     InputFrame& outFrame
+                  Receives the frame
+      Modifies: [m_bReplaying, m_uFrameIndex, m_uOffset].
+      Returns:  BOOL
+                  TRUE if a frame was read, FALSE once the replay ended
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    BOOL InputReplayer::ReadFrame(_Out_ InputFrame& outFrame)
+    {
+        outFrame = InputFrame{};
+        if (!IsReplaying() || m_uOffset >= m_aData.size())
+        {
+            m_bReplaying = FALSE;
+            return FALSE;
+        }
+
+        const BYTE directions = m_aData[m_uOffset++];
+        outFrame.directions =
+        {
+            .bFront = (directions & 0x01u) ? TRUE : FALSE,
+            .bLeft = (directions & 0x02u) ? TRUE : FALSE,
+            .bBack = (directions & 0x04u) ? TRUE : FALSE,
+            .bRight = (directions & 0x08u) ? TRUE : FALSE,
+            .bUp = (directions & 0x10u) ? TRUE : FALSE,
+            .bDown = (directions & 0x20u) ? TRUE : FALSE,
+        };
+
+        UINT64 uNumSteps = 0u;
+        UINT64 auMovement[2] = { 0u, 0u };
+        if (!readVarint(uNumSteps) || !readVarint(auMovement[0]) || !readVarint(auMovement[1]) || m_aData.size() - m_uOffset < sizeof(FLOAT))
+        {
+            m_bReplaying = FALSE;
+            return FALSE;
+        }
+        outFrame.uNumSteps = static_cast<UINT>(uNumSteps);
+        outFrame.mouseRelativeMovement =
+        {
+            .X = static_cast<LONG>(static_cast<INT64>(auMovement[0] >> 1u) ^ -static_cast<INT64>(auMovement[0] & 1u)),
+            .Y = static_cast<LONG>(static_cast<INT64>(auMovement[1] >> 1u) ^ -static_cast<INT64>(auMovement[1] & 1u)),
+        };
+        memcpy(&outFrame.alpha, &m_aData[m_uOffset], sizeof(FLOAT));
+        m_uOffset += sizeof(FLOAT);
+
+        ++m_uFrameIndex;
+        return TRUE;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   InputReplayer::GetTimestep
+      Summary:  Returns the timestep the log was recorded at
+      Returns:  FLOAT
+                  Duration of a simulation step in seconds
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    FLOAT InputReplayer::GetTimestep() const
+    {
+        return m_timestep;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   InputReplayer::GetNumFrames
+      Summary:  Returns the frames of the log
+      Returns:  UINT
+                  Number of frames
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    UINT InputReplayer::GetNumFrames() const
+    {
+        return m_uNumFrames;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   InputReplayer::GetFrameIndex
+      Summary:  Returns the index of the next frame to read
+      Returns:  UINT
+                  Index of the frame
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    UINT InputReplayer::GetFrameIndex() const
+    {
+        return m_uFrameIndex;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   InputReplayer::readVarint
+      Summary:  Reads an integer written by InputRecorder::writeVarint
+      Args:     UINT64& uOutValue
+                  Receives the integer
+      Modifies: [m_uOffset].
+      Returns:  BOOL
+                  FALSE if the log ends within the integer or it is too
+                  long
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    BOOL InputReplayer::readVarint(_Out_ UINT64& uOutValue)
+    {
+        uOutValue = 0u;
+        for (UINT uShift = 0u; uShift < 64u; uShift += 7u)
+        {
+            if (m_uOffset >= m_aData.size())
+            {
+                return FALSE;
+            }
+
+            const BYTE byte = m_aData[m_uOffset++];
+            uOutValue |= static_cast<UINT64>(byte & 0x7Fu) << uShift;
+            if ((byte & 0x80u) == 0u)
+            {
+                return TRUE;
+            }
+        }
+
+        return FALSE;
+    }
+}
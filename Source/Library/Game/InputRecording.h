@@ -0,0 +1,165 @@
+﻿/*+===================================================================
+  File:      INPUTRECORDING.H
+
+  Summary:   InputRecording header file contains declarations of the
+             InputFrame type and of the InputRecorder and InputReplayer
+             classes that write the input of every frame to a compact
+             binary log and read it back, so that a run can be played
+             again step for step.
+
+  Classes: InputRecorder, InputReplayer
+
+  © 2022 Kyung Hee University
+===================================================================+*/
+#pragma once
+
+#include "Common.h"
+
+namespace library
+{
+    /*S+S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S
+      Struct:   InputFrame
+
+      Summary:  Everything a frame of the game loop simulates from: the
+                fixed steps it ran, the fraction of a step left for the
+                renderer to blend with, and the input it read
+    S---S---S---S---S---S---S---S---S---S---S---S---S---S---S---S---S-S*/
+    struct InputFrame
+    {
+        UINT uNumSteps;
+        FLOAT alpha;
+        DirectionsInput directions;
+        MouseRelativeMovement mouseRelativeMovement;
+    };
+
+    /*C+C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C
+      Class:    InputRecorder
+
+      Summary:  Records the input frames of a run into memory and saves
+                them as a log. The directions of a frame take a byte of
+                bits, the steps and the mouse movement variable length
+                integers, the alpha its four bytes, so a frame usually
+                takes eight bytes
+
+      Methods:  Start
+                  Starts recording a run at a timestep
+                Stop
+                  Stops recording, the frames recorded are kept
+                IsRecording
+                  Tells whether frames are recorded
+                RecordFrame
+                  Appends a frame
+                GetNumFrames
+                  Returns the frames recorded
+                Save
+                  Writes the frames recorded to a log
+                InputRecorder
+                  Constructor.
+                ~InputRecorder
+                  Destructor.
+    C---C---C---C---C---C---C---C---C---C---C---C---C---C---C---C---C-C*/
+    class InputRecorder final
+    {
+        friend class InputReplayer;
+
+    public:
+        static constexpr UINT FILE_VERSION = 1u;
+
+    public:
+        InputRecorder();
+        InputRecorder(const InputRecorder& other) = delete;
+        InputRecorder(InputRecorder&& other) = delete;
+        InputRecorder& operator=(const InputRecorder& other) = delete;
+        InputRecorder& operator=(InputRecorder&& other) = delete;
+        ~InputRecorder() = default;
+
+        void Start(_In_ FLOAT timestep);
+        void Stop();
+        BOOL IsRecording() const;
+        void RecordFrame(_In_ const InputFrame& frame);
+        UINT GetNumFrames() const;
+        HRESULT Save(_In_ const std::filesystem::path& filePath) const;
+
+    private:
+        static constexpr UINT FILE_MAGIC = 0x474F4C49u;
+
+        /*S+S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S
+          Struct:   FileHeader
+
+          Summary:  Start of a log, followed by the encoded frames. The
+                    timestep is the one the frames were simulated at
+        S---S---S---S---S---S---S---S---S---S---S---S---S---S---S---S---S-S*/
+        struct FileHeader
+        {
+            UINT uMagic;
+            UINT uVersion;
+            FLOAT timestep;
+            UINT uNumFrames;
+            UINT64 uSize;
+        };
+
+        void writeVarint(_In_ UINT64 uValue);
+
+        BOOL m_bRecording;
+        FLOAT m_timestep;
+        UINT m_uNumFrames;
+        std::vector<BYTE> m_aData;
+    };
+
+    /*C+C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C
+      Class:    InputReplayer
+
+      Summary:  Reads the frames of a log back in order. The game runs
+                the steps, the alpha and the input of each frame instead
+                of those of its own clock and window, at the timestep
+                of the log, so the simulation and the frames it renders
+                are those of the recorded run
+
+      Methods:  Load
+                  Reads a log and starts replaying it
+                Stop
+                  Stops replaying
+                IsReplaying
+                  Tells whether frames are left to replay
+                ReadFrame
+                  Returns the next frame
+                GetTimestep
+                  Returns the timestep of the log
+                GetNumFrames
+                  Returns the frames of the log
+                GetFrameIndex
+                  Returns the index of the next frame
+                InputReplayer
+                  Constructor.
+                ~InputReplayer
+                  Destructor.
+    C---C---C---C---C---C---C---C---C---C---C---C---C---C---C---C---C-C*/
+    class InputReplayer final
+    {
+    public:
+        InputReplayer();
+        InputReplayer(const InputReplayer& other) = delete;
+        InputReplayer(InputReplayer&& other) = delete;
+        InputReplayer& operator=(const InputReplayer& other) = delete;
+        InputReplayer& operator=(InputReplayer&& other) = delete;
+        ~InputReplayer() = default;
+
+        HRESULT Load(_In_ const std::filesystem::path& filePath);
+        void Stop();
+        BOOL IsReplaying() const;
+        BOOL ReadFrame(_Out_ InputFrame& outFrame);
+        FLOAT GetTimestep() const;
+        UINT GetNumFrames() const;
+        UINT GetFrameIndex() const;
+
+    private:
+        BOOL readVarint(_Out_ UINT64& uOutValue);
+
+        BOOL m_bReplaying;
+        FLOAT m_timestep;
+        UINT m_uNumFrames;
+        UINT m_uFrameIndex;
+        size_t m_uOffset;
+        std::vector<BYTE> m_aData;
+    };
+}
@@ -0,0 +1,698 @@
+#include "Job/JobSystem.h"
+
+#include <algorithm>
+
+#include "Profiler/CpuProfiler.h"
+
+namespace library
+{
+    // Job system the calling thread belongs to, and its index in it
+    static thread_local JobSystem* s_pJobSystem = nullptr;
+    static thread_local UINT s_uThreadIndex = 0u;
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   JobCounter::JobCounter
+      Summary:  Constructor
+      Modifies: [m_uCount, m_mutex, m_apContinuations].
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    JobCounter::JobCounter()
+        : m_uCount(0u)
+        , m_mutex()
+        , m_apContinuations()
+    {
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   JobCounter::IsDone
+      Summary:  Tells whether every job run with the counter finished
+      Returns:  BOOL
+                  TRUE if the counter is zero
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    BOOL JobCounter::IsDone() const
+    {
+        return m_uCount.load(std::memory_order_acquire) == 0u;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   JobSystem::GetGlobal
+      Summary:  Returns the job system shared by the whole library
+      Returns:  JobSystem&
+                  The global job system
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    JobSystem& JobSystem::GetGlobal()
+    {
+        static JobSystem s_jobSystem;
+        return s_jobSystem;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   JobSystem::JobSystem
+      Summary:  Constructor
+      Modifies: [m_apQueues, m_aWorkers, m_mainThreadId, m_sharedMutex,
+                  m_apSharedJobs, m_uNumSharedJobs, m_mainThreadMutex,
+                  m_apMainThreadJobs, m_uNumMainThreadJobs,
+                  m_sleepMutex, m_wakeCondition, m_uEpoch,
+                  m_uNumSleeping, m_bShutdown, m_uNumJobs,
+                  m_uNumStolenJobs, m_uNumExecutedMainThreadJobs].
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    JobSystem::JobSystem()
+        : m_apQueues()
+        , m_aWorkers()
+        , m_mainThreadId()
+        , m_sharedMutex()
+        , m_apSharedJobs()
+        , m_uNumSharedJobs(0u)
+        , m_mainThreadMutex()
+        , m_apMainThreadJobs()
+        , m_uNumMainThreadJobs(0u)
+        , m_sleepMutex()
+        , m_wakeCondition()
+        , m_uEpoch(0u)
+        , m_uNumSleeping(0u)
+        , m_bShutdown(FALSE)
+        , m_uNumJobs(0u)
+        , m_uNumStolenJobs(0u)
+        , m_uNumExecutedMainThreadJobs(0u)
+    {
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   JobSystem::~JobSystem
+      Summary:  Destructor. Stops and joins the worker threads
+      Modifies: [m_apQueues, m_aWorkers, m_bShutdown].
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    JobSystem::~JobSystem()
+    {
+        shutdown();
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   JobSystem::Initialize
+      Summary:  Makes the calling thread the main thread and starts
+                uNumThreads - 1 worker threads. Restarts the system when
+                it is already running, which must not happen while jobs
+                are pending
+      Args:     UINT uNumThreads
+                  Number of threads that run jobs, the main thread
+                  included
+      Modifies: [m_apQueues, m_aWorkers, m_mainThreadId, m_bShutdown].
+      Returns:  HRESULT
+                  Status code
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    HRESULT JobSystem::Initialize(_In_ UINT uNumThreads)
+    {
+        if (uNumThreads == 0u)
+        {
+            return E_INVALIDARG;
+        }
+
+        shutdown();
+
+        m_bShutdown.store(FALSE);
+        m_mainThreadId = std::this_thread::get_id();
+        s_pJobSystem = this;
+        s_uThreadIndex = 0u;
+
+        m_apQueues.reserve(uNumThreads);
+        for (UINT i = 0u; i < uNumThreads; ++i)
+        {
+            m_apQueues.push_back(std::make_unique<WorkStealingQueue>());
+        }
+
+        m_aWorkers.reserve(uNumThreads - 1u);
+        for (UINT i = 1u; i < uNumThreads; ++i)
+        {
+            m_aWorkers.emplace_back(&JobSystem::workerMain, this, i);
+        }
+
+        return S_OK;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   JobSystem::Run
+      Summary:  Runs a job on whichever thread gets to it first
+      Args:     std::function<void()> function
+                  Function of the job
+                JobCounter* pCounter
+                  Counter of the job, or nullptr
+      Modifies: [pCounter, m_apQueues, m_apSharedJobs].
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    void JobSystem::Run(_In_ std::function<void()> function, _In_opt_ JobCounter* pCounter)
+    {
+        schedule(createJob(std::move(function), pCounter));
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   JobSystem::RunAfter
+      Summary:  Runs a job once every job of another counter finished.
+                The job counts in its own counter from now on, so
+                waiting for it waits for the dependency too
+      Args:     JobCounter& dependency
+                  Counter the job waits for
+                std::function<void()> function
+                  Function of the job
+                JobCounter* pCounter
+                  Counter of the job, or nullptr
+      Modifies: [dependency, pCounter].
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    void JobSystem::RunAfter(_In_ JobCounter& dependency, _In_ std::function<void()> function, _In_opt_ JobCounter* pCounter)
+    {
+        Job* pJob = createJob(std::move(function), pCounter);
+
+        {
+            std::lock_guard<std::mutex> lock(dependency.m_mutex);
+            if (dependency.m_uCount.load(std::memory_order_acquire) != 0u)
+            {
+                dependency.m_apContinuations.push_back(pJob);
+                return;
+            }
+        }
+
+        schedule(pJob);
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   JobSystem::RunOnMainThread
+      Summary:  Runs a job on the main thread, at once when called
+                from it, otherwise the next time it waits or pumps its
+                jobs
+      Args:     std::function<void()> function
+                  Function of the job
+                JobCounter* pCounter
+                  Counter of the job, or nullptr
+      Modifies: [pCounter, m_apMainThreadJobs, m_uNumMainThreadJobs].
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    void JobSystem::RunOnMainThread(_In_ std::function<void()> function, _In_opt_ JobCounter* pCounter)
+    {
+        Job* pJob = createJob(std::move(function), pCounter);
+        if (m_apQueues.empty() || IsMainThread())
+        {
+            m_uNumExecutedMainThreadJobs.fetch_add(1u, std::memory_order_relaxed);
+            execute(pJob);
+            return;
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(m_mainThreadMutex);
+            m_apMainThreadJobs.push_back(pJob);
+            m_uNumMainThreadJobs.fetch_add(1u, std::memory_order_release);
+        }
+        wake(TRUE);
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   JobSystem::Wait
+      Summary:  Runs jobs until every job of the counter finished,
+                the pending jobs of the main thread first when called
+                from it. Sleeps only when no job is left to run
+      Args:     JobCounter& counter
+                  Counter to wait for
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    void JobSystem::Wait(_In_ JobCounter& counter)
+    {
+        const BOOL bMainThread = IsMainThread();
+
+        UINT uNumIdleSpins = 0u;
+        while (!counter.IsDone())
+        {
+            const UINT64 uEpoch = m_uEpoch.load();
+            Job* pJob = findJob(bMainThread);
+            if (pJob)
+            {
+                execute(pJob);
+                uNumIdleSpins = 0u;
+            }
+            else if (uNumIdleSpins < NUM_SPINS_BEFORE_SLEEP)
+            {
+                std::this_thread::yield();
+                ++uNumIdleSpins;
+            }
+            else
+            {
+                sleep(uEpoch, &counter);
+            }
+        }
+
+        // The last job may still hold the lock it zeroed the counter
+        // under, it is done with the counter once the lock is free
+        std::lock_guard<std::mutex> lock(counter.m_mutex);
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   JobSystem::ParallelFor
+      Summary:  Calls a function on consecutive ranges that cover
+                [0, uCount), one job per range, and returns once every
+                range is done. The calling thread takes the first range
+      Args:     UINT uCount
+                  Number of elements
+                UINT uGrainSize
+                  Elements per range, 0 makes about four ranges per
+                  thread
+                const std::function<void(UINT, UINT)>& function
+                  Function called with the first and one past the last
+                  element of each range
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    void JobSystem::ParallelFor(_In_ UINT uCount, _In_ UINT uGrainSize, _In_ const std::function<void(UINT, UINT)>& function)
+    {
+        if (uCount == 0u)
+        {
+            return;
+        }
+
+        if (uGrainSize == 0u)
+        {
+            uGrainSize = std::max(uCount / (GetNumThreads() * 4u), 1u);
+        }
+
+        if (m_aWorkers.empty() || uCount <= uGrainSize)
+        {
+            function(0u, uCount);
+            return;
+        }
+
+        JobCounter counter;
+        for (UINT uBegin = uGrainSize; uBegin < uCount; uBegin += uGrainSize)
+        {
+            const UINT uEnd = std::min(uBegin + uGrainSize, uCount);
+            Run([&function, uBegin, uEnd]()
+                {
+                    function(uBegin, uEnd);
+                }, &counter);
+        }
+
+        function(0u, uGrainSize);
+        Wait(counter);
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   JobSystem::ExecuteMainThreadJobs
+      Summary:  Runs the jobs queued for the main thread. Does nothing
+                on any other thread
+      Modifies: [m_apMainThreadJobs, m_uNumMainThreadJobs].
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    void JobSystem::ExecuteMainThreadJobs()
+    {
+        if (!IsMainThread())
+        {
+            return;
+        }
+
+        for (Job* pJob = popMainThreadJob(); pJob; pJob = popMainThreadJob())
+        {
+            execute(pJob);
+        }
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   JobSystem::IsMainThread
+      Summary:  Tells whether the calling thread initialized the system
+      Returns:  BOOL
+                  TRUE on the main thread
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    BOOL JobSystem::IsMainThread() const
+    {
+        return !m_apQueues.empty() && std::this_thread::get_id() == m_mainThreadId;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   JobSystem::GetNumThreads
+      Summary:  Returns the number of threads that run jobs
+      Returns:  UINT
+                  Worker threads plus the main thread
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    UINT JobSystem::GetNumThreads() const
+    {
+        return static_cast<UINT>(m_aWorkers.size()) + 1u;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   JobSystem::ResetStatistics
+      Summary:  Zeroes the counters
+      Modifies: [m_uNumJobs, m_uNumStolenJobs,
+                  m_uNumExecutedMainThreadJobs].
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    void JobSystem::ResetStatistics()
+    {
+        m_uNumJobs.store(0u, std::memory_order_relaxed);
+        m_uNumStolenJobs.store(0u, std::memory_order_relaxed);
+        m_uNumExecutedMainThreadJobs.store(0u, std::memory_order_relaxed);
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   JobSystem::GetStatistics
+      Summary:  Returns the counters
+      Returns:  JobSystemStatistics
+                  Jobs run, stolen and run for the main thread
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    JobSystemStatistics JobSystem::GetStatistics() const
+    {
+        return JobSystemStatistics
+        {
+            .uNumJobs = m_uNumJobs.load(std::memory_order_relaxed),
+            .uNumStolenJobs = m_uNumStolenJobs.load(std::memory_order_relaxed),
+            .uNumMainThreadJobs = m_uNumExecutedMainThreadJobs.load(std::memory_order_relaxed),
+        };
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   JobSystem::createJob
+      Summary:  Allocates a job and counts it in its counter
+      Args:     std::function<void()>&& function
+                  Function of the job
+                JobCounter* pCounter
+                  Counter of the job, or nullptr
+      Modifies: [pCounter].
+      Returns:  Job*
+                  The job, deleted once it ran
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    Job* JobSystem::createJob(_In_ std::function<void()>&& function, _In_opt_ JobCounter* pCounter)
+    {
+        if (pCounter)
+        {
+            pCounter->m_uCount.fetch_add(1u, std::memory_order_relaxed);
+        }
+
+        return new Job
+        {
+            .Function = std::move(function),
+            .pCounter = pCounter,
+        };
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   JobSystem::schedule
+      Summary:  Makes a job available to the threads: in the queue of
+                the calling thread when it belongs to the system and
+                the queue has room, in the shared queue otherwise.
+                Runs it at once before Initialize
+      Args:     Job* pJob
+                  Job to schedule
+      Modifies: [m_apQueues, m_apSharedJobs, m_uNumSharedJobs].
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    void JobSystem::schedule(_In_ Job* pJob)
+    {
+        if (m_apQueues.empty())
+        {
+            execute(pJob);
+            return;
+        }
+
+        if (s_pJobSystem != this || !m_apQueues[s_uThreadIndex]->Push(pJob))
+        {
+            std::lock_guard<std::mutex> lock(m_sharedMutex);
+            m_apSharedJobs.push_back(pJob);
+            m_uNumSharedJobs.fetch_add(1u, std::memory_order_release);
+        }
+        wake(FALSE);
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   JobSystem::execute
+      Summary:  Runs a job, releases its counter and deletes it
+      Args:     Job* pJob
+                  Job to run
+      Modifies: [m_uNumJobs].
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    void JobSystem::execute(_In_ Job* pJob)
+    {
+        pJob->Function();
+        finish(pJob->pCounter);
+        delete pJob;
+
+        m_uNumJobs.fetch_add(1u, std::memory_order_relaxed);
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   JobSystem::finish
+      Summary:  Counts a finished job out of its counter. The last job
+                schedules the jobs that waited for the counter and wakes
+                the threads that wait for it. The count drops under the
+                lock of the counter, so a waiter can tell when the
+                counter is no longer used
+      Args:     JobCounter* pCounter
+                  Counter of the job, or nullptr
+      Modifies: [pCounter].
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    void JobSystem::finish(_In_opt_ JobCounter* pCounter)
+    {
+        if (!pCounter)
+        {
+            return;
+        }
+
+        std::vector<Job*> apContinuations;
+        {
+            std::lock_guard<std::mutex> lock(pCounter->m_mutex);
+            if (pCounter->m_uCount.fetch_sub(1u, std::memory_order_acq_rel) != 1u)
+            {
+                return;
+            }
+            apContinuations.swap(pCounter->m_apContinuations);
+        }
+
+        for (Job* pJob : apContinuations)
+        {
+            schedule(pJob);
+        }
+        wake(TRUE);
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   JobSystem::findJob
+      Summary:  Takes the next job the calling thread should run: a
+                job of the main thread when it is the main thread, then
+                the newest job of its own queue, then the oldest shared
+                job, then the oldest job of another queue, starting
+                from the one after its own
+      Args:     BOOL bMainThread
+                  Whether the caller is the main thread
+      Modifies: [m_apQueues, m_apSharedJobs, m_uNumSharedJobs,
+                  m_uNumStolenJobs].
+      Returns:  Job*
+                  The job, nullptr if none was found
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    Job* JobSystem::findJob(_In_ BOOL bMainThread)
+    {
+        if (bMainThread)
+        {
+            Job* pJob = popMainThreadJob();
+            if (pJob)
+            {
+                return pJob;
+            }
+        }
+
+        const BOOL bOwnsQueue = s_pJobSystem == this;
+        if (bOwnsQueue)
+        {
+            Job* pJob = m_apQueues[s_uThreadIndex]->Pop();
+            if (pJob)
+            {
+                return pJob;
+            }
+        }
+
+        if (m_uNumSharedJobs.load(std::memory_order_acquire) > 0u)
+        {
+            std::lock_guard<std::mutex> lock(m_sharedMutex);
+            if (!m_apSharedJobs.empty())
+            {
+                Job* pJob = m_apSharedJobs.front();
+                m_apSharedJobs.pop_front();
+                m_uNumSharedJobs.fetch_sub(1u, std::memory_order_relaxed);
+                return pJob;
+            }
+        }
+
+        const UINT uNumQueues = static_cast<UINT>(m_apQueues.size());
+        const UINT uFirst = bOwnsQueue ? s_uThreadIndex + 1u : 0u;
+        for (UINT i = 0u; i < uNumQueues; ++i)
+        {
+            const UINT uVictim = (uFirst + i) % uNumQueues;
+            if (bOwnsQueue && uVictim == s_uThreadIndex)
+            {
+                continue;
+            }
+
+            Job* pJob = m_apQueues[uVictim]->Steal();
+            if (pJob)
+            {
+                m_uNumStolenJobs.fetch_add(1u, std::memory_order_relaxed);
+                return pJob;
+            }
+        }
+
+        return nullptr;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   JobSystem::popMainThreadJob
+      Summary:  Takes the oldest job queued for the main thread
+      Modifies: [m_apMainThreadJobs, m_uNumMainThreadJobs,
+                  m_uNumExecutedMainThreadJobs].
+      Returns:  Job*
+                  The job, nullptr if none is queued
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    Job* JobSystem::popMainThreadJob()
+    {
+        if (m_uNumMainThreadJobs.load(std::memory_order_acquire) == 0u)
+        {
+            return nullptr;
+        }
+
+        std::lock_guard<std::mutex> lock(m_mainThreadMutex);
+        if (m_apMainThreadJobs.empty())
+        {
+            return nullptr;
+        }
+
+        Job* pJob = m_apMainThreadJobs.front();
+        m_apMainThreadJobs.pop_front();
+        m_uNumMainThreadJobs.fetch_sub(1u, std::memory_order_relaxed);
+        m_uNumExecutedMainThreadJobs.fetch_add(1u, std::memory_order_relaxed);
+
+        return pJob;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   JobSystem::wake
+      Summary:  Tells the sleeping threads something changed. A new job
+                wakes one of them, anything a particular thread may be
+                waiting for, a counter reaching zero or a job of the
+                main thread, wakes them all
+      Args:     BOOL bAll
+                  Whether to wake every sleeping thread
+      Modifies: [m_uEpoch].
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    void JobSystem::wake(_In_ BOOL bAll)
+    {
+        m_uEpoch.fetch_add(1u);
+        if (m_uNumSleeping.load() == 0u)
+        {
+            return;
+        }
+
+        // Taking the lock makes sure a thread that saw the old epoch
+        // is already waiting and gets the notification
+        {
+            std::lock_guard<std::mutex> lock(m_sleepMutex);
+        }
+        if (bAll)
+        {
+            m_wakeCondition.notify_all();
+        }
+        else
+        {
+            m_wakeCondition.notify_one();
+        }
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   JobSystem::sleep
+      Summary:  Sleeps until the epoch moves past the one seen before
+                the last search for a job, the counter reaches zero or
+                the system shuts down
+      Args:     UINT64 uEpoch
+                  Epoch read before the last search
+                const JobCounter* pCounter
+                  Counter the thread waits for, or nullptr
+      Modifies: [m_uNumSleeping].
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    void JobSystem::sleep(_In_ UINT64 uEpoch, _In_opt_ const JobCounter* pCounter)
+    {
+        std::unique_lock<std::mutex> lock(m_sleepMutex);
+        m_uNumSleeping.fetch_add(1u);
+        m_wakeCondition.wait(lock, [this, uEpoch, pCounter]
+            {
+                return m_uEpoch.load() != uEpoch || m_bShutdown.load() || (pCounter && pCounter->IsDone());
+            });
+        m_uNumSleeping.fetch_sub(1u);
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   JobSystem::shutdown
+      Summary:  Wakes the worker threads up to exit, joins them and
+                frees the jobs nobody ran
+      Modifies: [m_apQueues, m_aWorkers, m_apSharedJobs,
+                  m_apMainThreadJobs, m_bShutdown].
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    void JobSystem::shutdown()
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_sleepMutex);
+            m_bShutdown.store(TRUE);
+        }
+        m_wakeCondition.notify_all();
+
+        for (std::thread& worker : m_aWorkers)
+        {
+            worker.join();
+        }
+        m_aWorkers.clear();
+
+        for (std::unique_ptr<WorkStealingQueue>& pQueue : m_apQueues)
+        {
+            for (Job* pJob = pQueue->Steal(); pJob; pJob = pQueue->Steal())
+            {
+                delete pJob;
+            }
+        }
+        m_apQueues.clear();
+
+        for (Job* pJob : m_apSharedJobs)
+        {
+            delete pJob;
+        }
+        m_apSharedJobs.clear();
+        m_uNumSharedJobs.store(0u);
+
+        for (Job* pJob : m_apMainThreadJobs)
+        {
+            delete pJob;
+        }
+        m_apMainThreadJobs.clear();
+        m_uNumMainThreadJobs.store(0u);
+
+        if (s_pJobSystem == this)
+        {
+            s_pJobSystem = nullptr;
+        }
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   JobSystem::workerMain
+      Summary:  Entry point of a worker thread. Runs jobs, spinning a
+                little and then sleeping when none are left, until the
+                system shuts down
+      Args:     UINT uIndex
+                  Index of the thread and of its queue
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    void JobSystem::workerMain(_In_ UINT uIndex)
+    {
+        s_pJobSystem = this;
+        s_uThreadIndex = uIndex;
+        PROFILE_THREAD_NAME("Job worker");
+
+        UINT uNumIdleSpins = 0u;
+        while (!m_bShutdown.load())
+        {
+            const UINT64 uEpoch = m_uEpoch.load();
+            Job* pJob = findJob(FALSE);
+            if (pJob)
+            {
+                execute(pJob);
+                uNumIdleSpins = 0u;
+            }
+            else if (uNumIdleSpins < NUM_SPINS_BEFORE_SLEEP)
+            {
+                std::this_thread::yield();
+                ++uNumIdleSpins;
+            }
+            else
+            {
+                sleep(uEpoch, nullptr);
+                uNumIdleSpins = 0u;
+            }
+        }
+    }
+}
@@ -0,0 +1,200 @@
+﻿/*+===================================================================
+  File:      JOBSYSTEM.H
+
+  Summary:   JobSystem header file contains declarations of the Job and
+             JobSystemStatistics types and of the JobCounter and
+             JobSystem classes, the work stealing scheduler the library
+             runs its parallel work on.
+
+  Classes: JobCounter, JobSystem
+
+  © 2022 Kyung Hee University
+===================================================================+*/
+#pragma once
+
+#include "Common.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+#include "Job/WorkStealingQueue.h"
+
+namespace library
+{
+    class JobCounter;
+
+    /*S+S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S
+      Struct:   Job
+
+      Summary:  Function the job system runs, and the counter it
+                decrements once the function has returned
+    S---S---S---S---S---S---S---S---S---S---S---S---S---S---S---S---S-S*/
+    struct Job
+    {
+        std::function<void()> Function;
+        JobCounter* pCounter;
+    };
+
+    /*S+S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S
+      Struct:   JobSystemStatistics
+
+      Summary:  Counters of the job system since its statistics were
+                reset: the jobs it ran, those taken from the queue of
+                another thread, and those run for the main thread
+    S---S---S---S---S---S---S---S---S---S---S---S---S---S---S---S---S-S*/
+    struct JobSystemStatistics
+    {
+        UINT64 uNumJobs;
+        UINT64 uNumStolenJobs;
+        UINT64 uNumMainThreadJobs;
+    };
+
+    /*C+C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C
+      Class:    JobCounter
+
+      Summary:  Number of jobs still to finish of a group. Every job
+                run with the counter adds one, every finished job takes
+                one away. Jobs run after a counter start once it
+                reaches zero. A counter must outlive its jobs, waiting
+                for it before it goes out of scope is enough
+
+      Methods:  IsDone
+                  Tells whether every job of the counter finished
+                JobCounter
+                  Constructor.
+                ~JobCounter
+                  Destructor.
+    C---C---C---C---C---C---C---C---C---C---C---C---C---C---C---C---C-C*/
+    class JobCounter final
+    {
+        friend class JobSystem;
+
+    public:
+        JobCounter();
+        JobCounter(const JobCounter& other) = delete;
+        JobCounter(JobCounter&& other) = delete;
+        JobCounter& operator=(const JobCounter& other) = delete;
+        JobCounter& operator=(JobCounter&& other) = delete;
+        ~JobCounter() = default;
+
+        BOOL IsDone() const;
+
+    private:
+        std::atomic<UINT> m_uCount;
+        std::mutex m_mutex;
+        std::vector<Job*> m_apContinuations;
+    };
+
+    /*C+C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C
+      Class:    JobSystem
+
+      Summary:  Work stealing job scheduler. Every thread of the system
+                owns a WorkStealingQueue: it pushes the jobs it runs to
+                its own queue and works through them newest first,
+                while idle threads steal the oldest jobs of the others.
+                The thread that initializes the system is the main
+                thread and takes part as thread 0 whenever it waits.
+                Threads outside the system may run and wait for jobs
+                too, theirs go through a shared queue. Waiting never
+                blocks a thread that could work: it runs jobs until its
+                counter reaches zero and only then sleeps. Jobs run
+                for the main thread execute there only, when it waits
+                or pumps them, for the calls that need the immediate
+                context. Before Initialize every job runs on the
+                calling thread at once
+
+      Methods:  GetGlobal
+                  Returns the job system shared by the whole library
+                Initialize
+                  Starts the worker threads
+                Run
+                  Runs a job on any thread
+                RunAfter
+                  Runs a job once a counter reaches zero
+                RunOnMainThread
+                  Runs a job on the main thread
+                Wait
+                  Runs jobs until a counter reaches zero
+                ParallelFor
+                  Splits a range into jobs and waits for them
+                ExecuteMainThreadJobs
+                  Runs the pending jobs of the main thread
+                IsMainThread
+                  Tells whether the calling thread is the main thread
+                GetNumThreads
+                  Returns the number of threads that run jobs
+                ResetStatistics
+                  Zeroes the counters
+                GetStatistics
+                  Returns the counters
+                JobSystem
+                  Constructor.
+                ~JobSystem
+                  Destructor.
+    C---C---C---C---C---C---C---C---C---C---C---C---C---C---C---C---C-C*/
+    class JobSystem final
+    {
+    public:
+        static JobSystem& GetGlobal();
+
+    public:
+        JobSystem();
+        JobSystem(const JobSystem& other) = delete;
+        JobSystem(JobSystem&& other) = delete;
+        JobSystem& operator=(const JobSystem& other) = delete;
+        JobSystem& operator=(JobSystem&& other) = delete;
+        ~JobSystem();
+
+        HRESULT Initialize(_In_ UINT uNumThreads);
+
+        void Run(_In_ std::function<void()> function, _In_opt_ JobCounter* pCounter);
+        void RunAfter(_In_ JobCounter& dependency, _In_ std::function<void()> function, _In_opt_ JobCounter* pCounter);
+        void RunOnMainThread(_In_ std::function<void()> function, _In_opt_ JobCounter* pCounter);
+        void Wait(_In_ JobCounter& counter);
+        void ParallelFor(_In_ UINT uCount, _In_ UINT uGrainSize, _In_ const std::function<void(UINT, UINT)>& function);
+        void ExecuteMainThreadJobs();
+
+        BOOL IsMainThread() const;
+        UINT GetNumThreads() const;
+
+        void ResetStatistics();
+        JobSystemStatistics GetStatistics() const;
+
+    private:
+        static constexpr UINT NUM_SPINS_BEFORE_SLEEP = 64u;
+
+        Job* createJob(_In_ std::function<void()>&& function, _In_opt_ JobCounter* pCounter);
+        void schedule(_In_ Job* pJob);
+        void execute(_In_ Job* pJob);
+        void finish(_In_opt_ JobCounter* pCounter);
+        Job* findJob(_In_ BOOL bMainThread);
+        Job* popMainThreadJob();
+        void wake(_In_ BOOL bAll);
+        void sleep(_In_ UINT64 uEpoch, _In_opt_ const JobCounter* pCounter);
+        void shutdown();
+        void workerMain(_In_ UINT uIndex);
+
+        std::vector<std::unique_ptr<WorkStealingQueue>> m_apQueues;
+        std::vector<std::thread> m_aWorkers;
+        std::thread::id m_mainThreadId;
+        std::mutex m_sharedMutex;
+        std::deque<Job*> m_apSharedJobs;
+        std::atomic<UINT> m_uNumSharedJobs;
+        std::mutex m_mainThreadMutex;
+        std::deque<Job*> m_apMainThreadJobs;
+        std::atomic<UINT> m_uNumMainThreadJobs;
+        std::mutex m_sleepMutex;
+        std::condition_variable m_wakeCondition;
+        std::atomic<UINT64> m_uEpoch;
+        std::atomic<UINT> m_uNumSleeping;
+        std::atomic<BOOL> m_bShutdown;
+        std::atomic<UINT64> m_uNumJobs;
+        std::atomic<UINT64> m_uNumStolenJobs;
+        std::atomic<UINT64> m_uNumExecutedMainThreadJobs;
+    };
+}
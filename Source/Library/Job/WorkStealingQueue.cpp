@@ -0,0 +1,103 @@
+#include "Job/WorkStealingQueue.h"
+
+namespace library
+{
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   WorkStealingQueue::WorkStealingQueue
+      Summary:  Constructor
+      Modifies: [m_apJobs, m_top, m_bottom].
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    WorkStealingQueue::WorkStealingQueue()
+        : m_apJobs(std::make_unique<std::atomic<Job*>[]>(CAPACITY))
+        , m_top(0)
+        , m_bottom(0)
+    {
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   WorkStealingQueue::Push
+      Summary:  Adds a job at the bottom of the queue. Owner only
+      Args:     Job* pJob
+                  Job to add
+      Modifies: [m_apJobs, m_bottom].
+      Returns:  BOOL
+                  FALSE if the queue is full
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    BOOL WorkStealingQueue::Push(_In_ Job* pJob)
+    {
+        const INT64 bottom = m_bottom.load(std::memory_order_relaxed);
+        const INT64 top = m_top.load(std::memory_order_acquire);
+        if (bottom - top >= static_cast<INT64>(CAPACITY))
+        {
+            return FALSE;
+        }
+
+        m_apJobs[bottom & MASK].store(pJob, std::memory_order_relaxed);
+        m_bottom.store(bottom + 1, std::memory_order_release);
+
+        return TRUE;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   WorkStealingQueue::Pop
+      Summary:  Removes the job pushed last. Owner only. The last job
+                left is raced for with the thieves
+      Modifies: [m_top, m_bottom].
+      Returns:  Job*
+                  The job, nullptr if the queue is empty or a thief
+                  took the last one
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    Job* WorkStealingQueue::Pop()
+    {
+        const INT64 bottom = m_bottom.load(std::memory_order_relaxed) - 1;
+        m_bottom.store(bottom, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        INT64 top = m_top.load(std::memory_order_relaxed);
+
+        if (top > bottom)
+        {
+            m_bottom.store(bottom + 1, std::memory_order_relaxed);
+            return nullptr;
+        }
+
+        Job* pJob = m_apJobs[bottom & MASK].load(std::memory_order_relaxed);
+        if (top == bottom)
+        {
+            if (!m_top.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+            {
+                pJob = nullptr;
+            }
+            m_bottom.store(bottom + 1, std::memory_order_relaxed);
+        }
+
+        return pJob;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   WorkStealingQueue::Steal
+      Summary:  Removes the job pushed first. Any thread
+      Modifies: [m_top].
+      Returns:  Job*
+                  The job, nullptr if the queue is empty or another
+                  thread won the race for it
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    Job* WorkStealingQueue::Steal()
+    {
+        INT64 top = m_top.load(std::memory_order_acquire);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        const INT64 bottom = m_bottom.load(std::memory_order_acquire);
+
+        if (top >= bottom)
+        {
+            return nullptr;
+        }
+
+        Job* pJob = m_apJobs[top & MASK].load(std::memory_order_relaxed);
+        if (!m_top.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+        {
+            return nullptr;
+        }
+
+        return pJob;
+    }
+}
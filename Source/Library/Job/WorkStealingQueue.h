@@ -0,0 +1,69 @@
+﻿/*+===================================================================
+  File:      WORKSTEALINGQUEUE.H
+
+  Summary:   WorkStealingQueue header file contains declarations of the
+             WorkStealingQueue class, the lock free deque of jobs each
+             thread of the job system owns.
+
+  Classes: WorkStealingQueue
+
+  © 2022 Kyung Hee University
+===================================================================+*/
+#pragma once
+
+#include "Common.h"
+
+#include <atomic>
+#include <memory>
+
+namespace library
+{
+    struct Job;
+
+    /*C+C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C
+      Class:    WorkStealingQueue
+
+      Summary:  Chase-Lev deque of a fixed power of two capacity. The
+                owning thread pushes and pops jobs at the bottom, last
+                in first out so the data it just touched stays in its
+                caches, while any other thread steals the oldest job
+                from the top. Push and Pop must only be called by the
+                owner, Steal by any thread
+
+      Methods:  Push
+                  Adds a job at the bottom
+                Pop
+                  Removes the newest job
+                Steal
+                  Removes the oldest job
+                WorkStealingQueue
+                  Constructor.
+                ~WorkStealingQueue
+                  Destructor.
+    C---C---C---C---C---C---C---C---C---C---C---C---C---C---C---C---C-C*/
+    class WorkStealingQueue final
+    {
+    public:
+        static constexpr UINT CAPACITY = 4096u;
+
+    public:
+        WorkStealingQueue();
+        WorkStealingQueue(const WorkStealingQueue& other) = delete;
+        WorkStealingQueue(WorkStealingQueue&& other) = delete;
+        WorkStealingQueue& operator=(const WorkStealingQueue& other) = delete;
+        WorkStealingQueue& operator=(WorkStealingQueue&& other) = delete;
+        ~WorkStealingQueue() = default;
+
+        BOOL Push(_In_ Job* pJob);
+        Job* Pop();
+        Job* Steal();
+
+    private:
+        static_assert((CAPACITY & (CAPACITY - 1u)) == 0u, "The capacity of a work stealing queue must be a power of two");
+        static constexpr INT64 MASK = static_cast<INT64>(CAPACITY) - 1;
+
+        std::unique_ptr<std::atomic<Job*>[]> m_apJobs;
+        alignas(64) std::atomic<INT64> m_top;
+        alignas(64) std::atomic<INT64> m_bottom;
+    };
+}
@@ -13,15 +13,21 @@ namespace library
                   Position of the color
                 FLOAT attenuationDistance
                   Attenuation distance
-      Modifies: [m_position, m_color, m_attenuationDistance].
+      Modifies: [m_position, m_color, m_attenuationDistance, m_eye,
+                  m_at, m_up, m_view, m_projection].
     M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
 
     PointLight::PointLight(_In_ const XMFLOAT4& position, _In_ const XMFLOAT4& color, _In_ FLOAT attenuationDistance)
         : m_position(position)
         , m_color(color)
         , m_attenuationDistance(attenuationDistance)
-        
+        , m_eye()
+        , m_at(XMVectorSet(0.0f, 0.0f, 0.0f, 1.0f))
+        , m_up(DEFAULT_UP)
+        , m_view()
+        , m_projection(XMMatrixIdentity())
     {
+        updateView();
     }
 
     /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
@@ -60,16 +66,124 @@ namespace library
         return m_attenuationDistance;
     }
 
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   PointLight::GetRange
+      Summary:  Returns the distance beyond which the light is ignored.
+                The attenuation has fallen to 1 / RANGE_SCALE^2 there,
+                the shaders fade the light out towards it
+      Returns:  FLOAT
+                  Range of the light
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+
+    FLOAT PointLight::GetRange() const
+    {
+        return m_attenuationDistance * RANGE_SCALE;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   PointLight::GetViewMatrix
+      Summary:  Returns the view matrix looking from the light to the
+                origin
+      Returns:  const XMMATRIX&
+                  View matrix of the light
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+
+    const XMMATRIX& PointLight::GetViewMatrix() const
+    {
+        return m_view;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   PointLight::GetProjectionMatrix
+      Summary:  Returns the projection matrix of the light
+      Returns:  const XMMATRIX&
+                  Projection matrix of the light
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+
+    const XMMATRIX& PointLight::GetProjectionMatrix() const
+    {
+        return m_projection;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   PointLight::GetCubeFaceViewProjection
+      Summary:  Returns the view projection matrix of a face of the
+                shadow cube around the light. Faces come in the order
+                of the faces of a cube texture, +x, -x, +y, -y, +z, -z,
+                each a square 90 degree frustum that ends at the range
+                of the light
+      Args:     UINT uFace
+                  Index of the face
+      Returns:  XMMATRIX
+                  View projection matrix of the face
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+
+    XMMATRIX PointLight::GetCubeFaceViewProjection(_In_ UINT uFace) const
+    {
+        static const XMVECTORF32 s_aDirections[NUM_CUBE_FACES] =
+        {
+            { 1.0f, 0.0f, 0.0f, 0.0f }, { -1.0f, 0.0f, 0.0f, 0.0f },
+            { 0.0f, 1.0f, 0.0f, 0.0f }, { 0.0f, -1.0f, 0.0f, 0.0f },
+            { 0.0f, 0.0f, 1.0f, 0.0f }, { 0.0f, 0.0f, -1.0f, 0.0f },
+        };
+        static const XMVECTORF32 s_aUps[NUM_CUBE_FACES] =
+        {
+            { 0.0f, 1.0f, 0.0f, 0.0f }, { 0.0f, 1.0f, 0.0f, 0.0f },
+            { 0.0f, 0.0f, -1.0f, 0.0f }, { 0.0f, 0.0f, 1.0f, 0.0f },
+            { 0.0f, 1.0f, 0.0f, 0.0f }, { 0.0f, 1.0f, 0.0f, 0.0f },
+        };
+        assert(uFace < NUM_CUBE_FACES);
+
+        return XMMatrixLookToLH(XMLoadFloat4(&m_position), s_aDirections[uFace], s_aUps[uFace])
+            * XMMatrixPerspectiveFovLH(XM_PIDIV2, 1.0f, SHADOW_NEAR_Z, GetRange());
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   PointLight::Initialize
+      Summary:  Initializes the projection matrix of the light
+      Args:     UINT uWidth
+                  Width of the shadow map
+                UINT uHeight
+                  Height of the shadow map
+      Modifies: [m_projection].
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+
+    void PointLight::Initialize(_In_ UINT uWidth, _In_ UINT uHeight)
+    {
+        m_projection = XMMatrixPerspectiveFovLH(XM_PIDIV2, static_cast<FLOAT>(uWidth) / static_cast<FLOAT>(uHeight), 0.01f, 1000.0f);
+    }
+
     /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
       Method:   PointLight::Update
       Summary:  Updates the light every frame
       Args:     FLOAT deltaTime
                   Elapsed time
+      Modifies: [m_eye, m_up, m_view].
     M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
 
     void PointLight::Update(_In_ FLOAT deltaTime)
     {
         UNREFERENCED_PARAMETER(deltaTime);
+
+        updateView();
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   PointLight::updateView
+      Summary:  Recomputes the view matrix from the current position.
+                The up vector falls back to the forward axis when the
+                light looks straight up or down
+      Modifies: [m_eye, m_up, m_view].
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+
+    void PointLight::updateView()
+    {
+        m_eye = XMLoadFloat4(&m_position);
+
+        const XMVECTOR direction = XMVector3Normalize(XMVectorSubtract(m_at, m_eye));
+        m_up = (XMVectorGetX(XMVector3LengthSq(XMVector3Cross(direction, DEFAULT_UP))) < 1e-6f) ? DEFAULT_FORWARD : DEFAULT_UP;
+
+        m_view = XMMatrixLookAtLH(m_eye, m_at, m_up);
     }
 
 
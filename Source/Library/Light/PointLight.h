@@ -16,6 +16,20 @@ namespace library
                   Returns the position of the light
                 GetColor
                   Returns the color of the light
+                GetAttenuationDistance
+                  Returns the attenuation distance
+                GetRange
+                  Returns the distance beyond which the light is
+                  ignored
+                GetViewMatrix
+                  Returns the view matrix looking from the light
+                GetProjectionMatrix
+                  Returns the projection matrix of the light
+                GetCubeFaceViewProjection
+                  Returns the view projection matrix of a face of the
+                  shadow cube of the light
+                Initialize
+                  Initializes the projection matrix
                 Update
                   Updates the light
                 PointLight
@@ -25,6 +39,11 @@ namespace library
     C---C---C---C---C---C---C---C---C---C---C---C---C---C---C---C---C-C*/
     class PointLight
     {
+    public:
+        static constexpr FLOAT RANGE_SCALE = 8.0f;
+        static constexpr UINT NUM_CUBE_FACES = 6u;
+        static constexpr FLOAT SHADOW_NEAR_Z = 0.1f;
+
     public:
         PointLight() = delete;
         PointLight(_In_ const XMFLOAT4& position, _In_ const XMFLOAT4& color, _In_ FLOAT attenuationDistance);
@@ -37,14 +56,30 @@ namespace library
         const XMFLOAT4& GetPosition() const;
         const XMFLOAT4& GetColor() const;
         FLOAT GetAttenuationDistance() const;
+        FLOAT GetRange() const;
+        const XMMATRIX& GetViewMatrix() const;
+        const XMMATRIX& GetProjectionMatrix() const;
+        XMMATRIX GetCubeFaceViewProjection(_In_ UINT uFace) const;
+
+        void Initialize(_In_ UINT uWidth, _In_ UINT uHeight);
 
         virtual void Update(_In_ FLOAT deltaTime);
 
     protected:
+        void updateView();
+
+        static constexpr const XMVECTORF32 DEFAULT_FORWARD = { 0.0f, 0.0f, 1.0f, 0.0f };
+        static constexpr const XMVECTORF32 DEFAULT_UP = { 0.0f, 1.0f, 0.0f, 0.0f };
+
         XMFLOAT4 m_position;
         XMFLOAT4 m_color;
 
         FLOAT m_attenuationDistance;
 
+        XMVECTOR m_eye;
+        XMVECTOR m_at;
+        XMVECTOR m_up;
+        XMMATRIX m_view;
+        XMMATRIX m_projection;
     };
 }
\ No newline at end of file
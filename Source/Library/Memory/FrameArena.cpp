@@ -0,0 +1,328 @@
+#include "Memory/FrameArena.h"
+
+#include <algorithm>
+#include <bit>
+
+namespace library
+{
+    // Frame memory the calling thread has an arena in, and the arena
+    static thread_local FrameMemory* s_pFrameMemory = nullptr;
+    static thread_local FrameArena* s_pFrameArena = nullptr;
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   FrameArena::FrameArena
+      Summary:  Constructor. The first block is taken from the heap on
+                the first allocation
+      Modifies: [m_apBlocks, m_pBlock, m_uBlockSize, m_uHead, m_uFrame,
+                  m_uNumUsed, m_uCapacity, m_uHighWaterMark,
+                  m_uNumBlockAllocations].
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    FrameArena::FrameArena()
+        : m_apBlocks()
+        , m_pBlock(nullptr)
+        , m_uBlockSize(0u)
+        , m_uHead(0u)
+        , m_uFrame(0u)
+        , m_uNumUsed(0u)
+        , m_uCapacity(0u)
+        , m_uHighWaterMark(0u)
+        , m_uNumBlockAllocations(0u)
+    {
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   FrameArena::Allocate
+      Summary:  Reserves memory after the last allocation, in a new
+                block when the current one is full
+      Args:     size_t uSize
+                  Size in bytes
+                size_t uAlignment
+                  Alignment in bytes, a power of two
+      Modifies: [m_apBlocks, m_pBlock, m_uBlockSize, m_uHead,
+                  m_uNumUsed, m_uCapacity, m_uHighWaterMark,
+                  m_uNumBlockAllocations].
+      Returns:  void*
+                  The memory, valid until the arena is reset
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    void* FrameArena::Allocate(_In_ size_t uSize, _In_ size_t uAlignment)
+    {
+        assert(std::has_single_bit(uAlignment));
+
+        uSize = std::max<size_t>(uSize, 1u);
+
+        uintptr_t uAddress = (reinterpret_cast<uintptr_t>(m_pBlock) + m_uHead + uAlignment - 1u) & ~static_cast<uintptr_t>(uAlignment - 1u);
+        size_t uOffset = static_cast<size_t>(uAddress - reinterpret_cast<uintptr_t>(m_pBlock));
+        if (!m_pBlock || uOffset + uSize > m_uBlockSize)
+        {
+            addBlock(uSize + uAlignment);
+            uAddress = (reinterpret_cast<uintptr_t>(m_pBlock) + uAlignment - 1u) & ~static_cast<uintptr_t>(uAlignment - 1u);
+            uOffset = static_cast<size_t>(uAddress - reinterpret_cast<uintptr_t>(m_pBlock));
+        }
+
+        // The padding counts, the next frame has to fit it too
+        const size_t uNumUsed = m_uNumUsed.load(std::memory_order_relaxed) + uOffset + uSize - m_uHead;
+        m_uNumUsed.store(uNumUsed, std::memory_order_relaxed);
+        if (uNumUsed > m_uHighWaterMark.load(std::memory_order_relaxed))
+        {
+            m_uHighWaterMark.store(uNumUsed, std::memory_order_relaxed);
+        }
+
+        m_uHead = uOffset + uSize;
+
+        return m_pBlock + uOffset;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   FrameArena::Free
+      Summary:  Gives the memory back when it is the last allocation, so
+                that a container growing in place or a scratch buffer
+                dropped at once can be reused. Anything else is kept
+                until the reset
+      Args:     void* pMemory
+                  Memory allocated from the arena, or nullptr
+                size_t uSize
+                  Size it was allocated with
+      Modifies: [m_uHead, m_uNumUsed].
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    void FrameArena::Free(_In_opt_ void* pMemory, _In_ size_t uSize)
+    {
+        uSize = std::max<size_t>(uSize, 1u);
+
+        BYTE* pBytes = static_cast<BYTE*>(pMemory);
+        if (!pBytes || pBytes + uSize != m_pBlock + m_uHead)
+        {
+            return;
+        }
+
+        m_uHead -= uSize;
+        m_uNumUsed.store(m_uNumUsed.load(std::memory_order_relaxed) - uSize, std::memory_order_relaxed);
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   FrameArena::Reset
+      Summary:  Releases every allocation. When the frame spilled into
+                more than one block, they are replaced by a single one
+                as large as all of them, the next frames fit in it
+      Modifies: [m_apBlocks, m_pBlock, m_uBlockSize, m_uHead,
+                  m_uNumUsed, m_uCapacity, m_uNumBlockAllocations].
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    void FrameArena::Reset()
+    {
+        if (m_apBlocks.size() > 1u)
+        {
+            const size_t uCapacity = m_uCapacity.load(std::memory_order_relaxed);
+            m_apBlocks.clear();
+            m_pBlock = nullptr;
+            m_uBlockSize = 0u;
+            m_uCapacity.store(0u, std::memory_order_relaxed);
+            addBlock(uCapacity);
+        }
+
+        m_uHead = 0u;
+        m_uNumUsed.store(0u, std::memory_order_relaxed);
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   FrameArena::GetNumUsed
+      Summary:  Returns the memory allocated since the last reset
+      Returns:  size_t
+                  Size in bytes, padding included
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    size_t FrameArena::GetNumUsed() const
+    {
+        return m_uNumUsed.load(std::memory_order_relaxed);
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   FrameArena::GetCapacity
+      Summary:  Returns the memory the blocks of the arena reserve
+      Returns:  size_t
+                  Size in bytes
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    size_t FrameArena::GetCapacity() const
+    {
+        return m_uCapacity.load(std::memory_order_relaxed);
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   FrameArena::GetHighWaterMark
+      Summary:  Returns the most memory allocated between two resets
+                since the statistics were reset
+      Returns:  size_t
+                  Size in bytes, padding included
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    size_t FrameArena::GetHighWaterMark() const
+    {
+        return m_uHighWaterMark.load(std::memory_order_relaxed);
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   FrameArena::GetNumBlockAllocations
+      Summary:  Returns the blocks taken from the heap since the
+                statistics were reset, none once the arena is warm
+      Returns:  UINT64
+                  Number of blocks
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    UINT64 FrameArena::GetNumBlockAllocations() const
+    {
+        return m_uNumBlockAllocations.load(std::memory_order_relaxed);
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   FrameArena::ResetStatistics
+      Summary:  Zeroes the block count and lowers the high water mark
+                to the memory used now
+      Modifies: [m_uHighWaterMark, m_uNumBlockAllocations].
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    void FrameArena::ResetStatistics()
+    {
+        m_uHighWaterMark.store(m_uNumUsed.load(std::memory_order_relaxed), std::memory_order_relaxed);
+        m_uNumBlockAllocations.store(0u, std::memory_order_relaxed);
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   FrameArena::addBlock
+      Summary:  Takes a block from the heap and allocates from its front
+                from now on. Blocks at least double, so a frame spills
+                into a few of them only
+      Args:     size_t uMinSize
+                  Size the block must have at least
+      Modifies: [m_apBlocks, m_pBlock, m_uBlockSize, m_uHead,
+                  m_uCapacity, m_uNumBlockAllocations].
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    void FrameArena::addBlock(_In_ size_t uMinSize)
+    {
+        const size_t uBlockSize = std::max({ uMinSize, m_uBlockSize * 2u, DEFAULT_BLOCK_SIZE });
+
+        m_apBlocks.push_back(std::make_unique_for_overwrite<BYTE[]>(uBlockSize));
+        m_pBlock = m_apBlocks.back().get();
+        m_uBlockSize = uBlockSize;
+        m_uHead = 0u;
+        m_uCapacity.fetch_add(uBlockSize, std::memory_order_relaxed);
+        m_uNumBlockAllocations.fetch_add(1u, std::memory_order_relaxed);
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   FrameMemory::GetGlobal
+      Summary:  Returns the frame memory shared by the whole library,
+                whose frames end with those of the game
+      Returns:  FrameMemory&
+                  The global frame memory
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    FrameMemory& FrameMemory::GetGlobal()
+    {
+        static FrameMemory s_frameMemory;
+        return s_frameMemory;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   FrameMemory::FrameMemory
+      Summary:  Constructor. Arenas are created as threads ask for them
+      Modifies: [m_uFrame, m_mutex, m_apArenas].
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    FrameMemory::FrameMemory()
+        : m_uFrame(0u)
+        , m_mutex()
+        , m_apArenas()
+    {
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   FrameMemory::GetThreadArena
+      Summary:  Returns the arena of the calling thread, created the
+                first time the thread asks for it, and reset the first
+                time it does in a frame
+      Modifies: [m_apArenas].
+      Returns:  FrameArena&
+                  Arena of the thread, owned by the frame memory
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    FrameArena& FrameMemory::GetThreadArena()
+    {
+        const UINT64 uFrame = m_uFrame.load(std::memory_order_acquire);
+        if (s_pFrameMemory == this)
+        {
+            if (s_pFrameArena->m_uFrame != uFrame)
+            {
+                s_pFrameArena->Reset();
+                s_pFrameArena->m_uFrame = uFrame;
+            }
+
+            return *s_pFrameArena;
+        }
+
+        std::lock_guard<std::mutex> lock(m_mutex);
+        std::unique_ptr<FrameArena> pArena = std::make_unique<FrameArena>();
+        pArena->m_uFrame = uFrame;
+        s_pFrameMemory = this;
+        s_pFrameArena = pArena.get();
+        m_apArenas.push_back(std::move(pArena));
+
+        return *s_pFrameArena;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   FrameMemory::EndFrame
+      Summary:  Ends the frame. Called once the work of the frame is
+                done, the memory of every arena may then be reused
+      Modifies: [m_uFrame].
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    void FrameMemory::EndFrame()
+    {
+        m_uFrame.fetch_add(1u, std::memory_order_release);
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   FrameMemory::GetFrameIndex
+      Summary:  Returns the index of the current frame
+      Returns:  UINT64
+                  Frames ended so far
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    UINT64 FrameMemory::GetFrameIndex() const
+    {
+        return m_uFrame.load(std::memory_order_relaxed);
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   FrameMemory::ResetStatistics
+      Summary:  Zeroes the counters of every arena, to measure a run
+                after it warmed up
+      Modifies: [m_apArenas].
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    void FrameMemory::ResetStatistics()
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        for (const std::unique_ptr<FrameArena>& pArena : m_apArenas)
+        {
+            pArena->ResetStatistics();
+        }
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   FrameMemory::GetStatistics
+      Summary:  Returns the counters of every arena summed. The high
+                water marks of the threads may come from different
+                frames, their sum bounds what a frame ever needed
+      Returns:  FrameMemoryStatistics
+                  The counters
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    FrameMemoryStatistics FrameMemory::GetStatistics() const
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+
+        FrameMemoryStatistics statistics =
+        {
+            .uNumArenas = static_cast<UINT>(m_apArenas.size()),
+            .uCapacity = 0u,
+            .uHighWaterMark = 0u,
+            .uNumBlockAllocations = 0u,
+        };
+        for (const std::unique_ptr<FrameArena>& pArena : m_apArenas)
+        {
+            statistics.uCapacity += pArena->GetCapacity();
+            statistics.uHighWaterMark += pArena->GetHighWaterMark();
+            statistics.uNumBlockAllocations += pArena->GetNumBlockAllocations();
+        }
+
+        return statistics;
+    }
+}
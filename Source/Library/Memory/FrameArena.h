@@ -0,0 +1,238 @@
+﻿/*+===================================================================
+  File:      FRAMEARENA.H
+
+  Summary:   FrameArena header file contains declarations of the
+             FrameMemoryStatistics type, of the FrameArena and
+             FrameMemory classes that hand out memory that lives until
+             the end of the frame, and of the FrameAllocator adapter
+             that lets standard containers use it.
+
+  Classes: FrameArena, FrameMemory, FrameAllocator
+
+  © 2022 Kyung Hee University
+===================================================================+*/
+#pragma once
+
+#include "Common.h"
+
+#include <atomic>
+#include <mutex>
+
+namespace library
+{
+    /*S+S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S
+      Struct:   FrameMemoryStatistics
+
+      Summary:  Counters of the frame arenas of every thread since their
+                statistics were reset: the memory they reserve, the
+                most a frame used at once summed over the threads, and
+                the blocks they had to take from the heap
+    S---S---S---S---S---S---S---S---S---S---S---S---S---S---S---S---S-S*/
+    struct FrameMemoryStatistics
+    {
+        UINT uNumArenas;
+        UINT64 uCapacity;
+        UINT64 uHighWaterMark;
+        UINT64 uNumBlockAllocations;
+    };
+
+    /*C+C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C
+      Class:    FrameArena
+
+      Summary:  Linear allocator of a thread. Allocations are bumped
+                from the front of a block and are all released at once
+                when the arena is reset, freeing one does nothing
+                unless it is the last. A frame that does not fit in the
+                block continues in new ones, and the reset that follows
+                replaces them all by a single block large enough for
+                the whole frame, so once the arena has seen its largest
+                frame it no longer calls the heap. Only the thread that
+                owns it allocates from it, the counters may be read
+                from any thread
+
+      Methods:  Allocate
+                  Reserves memory until the next reset
+                Free
+                  Gives back the last allocation
+                Reset
+                  Releases every allocation
+                GetNumUsed
+                  Returns the memory allocated since the last reset
+                GetCapacity
+                  Returns the memory the blocks reserve
+                GetHighWaterMark
+                  Returns the most memory allocated between two resets
+                GetNumBlockAllocations
+                  Returns the blocks taken from the heap
+                ResetStatistics
+                  Zeroes the high water mark and the block count
+                FrameArena
+                  Constructor.
+                ~FrameArena
+                  Destructor.
+    C---C---C---C---C---C---C---C---C---C---C---C---C---C---C---C---C-C*/
+    class FrameArena final
+    {
+        friend class FrameMemory;
+
+    public:
+        static constexpr size_t DEFAULT_BLOCK_SIZE = 1u << 16u;
+
+    public:
+        FrameArena();
+        FrameArena(const FrameArena& other) = delete;
+        FrameArena(FrameArena&& other) = delete;
+        FrameArena& operator=(const FrameArena& other) = delete;
+        FrameArena& operator=(FrameArena&& other) = delete;
+        ~FrameArena() = default;
+
+        void* Allocate(_In_ size_t uSize, _In_ size_t uAlignment);
+        void Free(_In_opt_ void* pMemory, _In_ size_t uSize);
+        void Reset();
+
+        size_t GetNumUsed() const;
+        size_t GetCapacity() const;
+        size_t GetHighWaterMark() const;
+        UINT64 GetNumBlockAllocations() const;
+        void ResetStatistics();
+
+    private:
+        void addBlock(_In_ size_t uMinSize);
+
+        std::vector<std::unique_ptr<BYTE[]>> m_apBlocks;
+        BYTE* m_pBlock;
+        size_t m_uBlockSize;
+        size_t m_uHead;
+        UINT64 m_uFrame;
+        std::atomic<size_t> m_uNumUsed;
+        std::atomic<size_t> m_uCapacity;
+        std::atomic<size_t> m_uHighWaterMark;
+        std::atomic<UINT64> m_uNumBlockAllocations;
+    };
+
+    /*C+C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C
+      Class:    FrameMemory
+
+      Summary:  Owns a frame arena per thread and counts the frames.
+                Memory of an arena is valid until the end of the frame
+                it was allocated in: the first time a thread asks for
+                its arena in a new frame, the arena is reset. The reset
+                happens on the thread that owns the arena, so the end
+                of a frame never touches an arena another thread may be
+                using. Work that outlives a frame must not keep memory
+                of an arena
+
+      Methods:  GetGlobal
+                  Returns the frame memory shared by the whole library
+                GetThreadArena
+                  Returns the arena of the calling thread
+                EndFrame
+                  Ends the frame, the arenas reset on their next use
+                GetFrameIndex
+                  Returns the index of the current frame
+                ResetStatistics
+                  Zeroes the counters of every arena
+                GetStatistics
+                  Returns the counters of every arena summed
+                FrameMemory
+                  Constructor.
+                ~FrameMemory
+                  Destructor.
+    C---C---C---C---C---C---C---C---C---C---C---C---C---C---C---C---C-C*/
+    class FrameMemory final
+    {
+    public:
+        static FrameMemory& GetGlobal();
+
+    public:
+        FrameMemory();
+        FrameMemory(const FrameMemory& other) = delete;
+        FrameMemory(FrameMemory&& other) = delete;
+        FrameMemory& operator=(const FrameMemory& other) = delete;
+        FrameMemory& operator=(FrameMemory&& other) = delete;
+        ~FrameMemory() = default;
+
+        FrameArena& GetThreadArena();
+        void EndFrame();
+        UINT64 GetFrameIndex() const;
+
+        void ResetStatistics();
+        FrameMemoryStatistics GetStatistics() const;
+
+    private:
+        std::atomic<UINT64> m_uFrame;
+        mutable std::mutex m_mutex;
+        std::vector<std::unique_ptr<FrameArena>> m_apArenas;
+    };
+
+    /*C+C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C
+      Class:    FrameAllocator
+
+      Summary:  Standard allocator on a frame arena, for containers
+                built and dropped within a frame. A container grows on
+                the thread whose arena it was created with, and must
+                not be used once the frame ended
+
+      Methods:  allocate
+                  Allocates elements from the arena
+                deallocate
+                  Gives elements back to the arena
+                GetArena
+                  Returns the arena
+                FrameAllocator
+                  Constructor. Uses the arena of the calling thread
+    C---C---C---C---C---C---C---C---C---C---C---C---C---C---C---C---C-C*/
+    template <typename T>
+    class FrameAllocator
+    {
+    public:
+        using value_type = T;
+
+    public:
+        FrameAllocator()
+            : m_pArena(&FrameMemory::GetGlobal().GetThreadArena())
+        {
+        }
+
+        explicit FrameAllocator(_In_ FrameArena& arena)
+            : m_pArena(&arena)
+        {
+        }
+
+        template <typename U>
+        FrameAllocator(_In_ const FrameAllocator<U>& other)
+            : m_pArena(other.GetArena())
+        {
+        }
+
+        T* allocate(_In_ size_t uCount)
+        {
+            return static_cast<T*>(m_pArena->Allocate(uCount * sizeof(T), alignof(T)));
+        }
+
+        void deallocate(_In_opt_ T* pElements, _In_ size_t uCount)
+        {
+            m_pArena->Free(pElements, uCount * sizeof(T));
+        }
+
+        FrameArena* GetArena() const
+        {
+            return m_pArena;
+        }
+
+        template <typename U>
+        bool operator==(_In_ const FrameAllocator<U>& other) const
+        {
+            return m_pArena == other.GetArena();
+        }
+
+    private:
+        FrameArena* m_pArena;
+    };
+
+    template <typename T>
+    using FrameVector = std::vector<T, FrameAllocator<T>>;
+
+    template <typename Key, typename T, typename Hash = std::hash<Key>>
+    using FrameUnorderedMap = std::unordered_map<Key, T, Hash, std::equal_to<Key>, FrameAllocator<std::pair<const Key, T>>>;
+}
@@ -1,5 +1,8 @@
 #include "Model/Model.h"
 
+#include "Profiler/CpuProfiler.h"
+#include "Texture/TextureCache.h"
+
 #include "assimp/Importer.hpp"	// C++ importer interface
 #include "assimp/scene.h"		    // output data structure
 #include "assimp/postprocess.h"	// post processing flags
@@ -54,8 +57,6 @@ namespace library
         return XMLoadFloat4(&float4);
     }
 
-    std::unique_ptr<Assimp::Importer> Model::sm_pImporter = std::make_unique<Assimp::Importer>();
-
     /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
       Method:   Model::Model
       Summary:  Constructor
@@ -65,7 +66,8 @@ namespace library
                  m_skinningConstantBuffer, m_aVertices, m_aAnimationData,
                  m_aIndices, m_aBoneData, m_aBoneInfo, m_aTransforms,
                  m_aBoneInfo, m_aTransforms, m_boneNameToIndexMap,
-                 m_pScene, m_timeSinceLoaded, m_globalInverseTransform].
+                 m_pImporter, m_pScene, m_timeSinceLoaded,
+                 m_globalInverseTransform].
     M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
 
     Model::Model(_In_ const std::filesystem::path& filePath)
@@ -79,13 +81,21 @@ namespace library
         m_aBoneData(std::vector<VertexBoneData>()),
         m_aBoneInfo(std::vector<BoneInfo>()),
         m_aTransforms(std::vector<XMMATRIX>()),
-        m_boneNameToIndexMap(std::unordered_map<std::string, UINT>()),
+        m_boneNameToIndexMap(std::unordered_map<std::string, UINT, BoneNameHash, std::equal_to<>>()),
+        m_pImporter(std::make_unique<Assimp::Importer>()),
         m_pScene(),
         m_timeSinceLoaded(),
         m_globalInverseTransform(XMMATRIX())
     {
     }
 
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   Model::~Model
+      Summary:  Destructor. Defined here, where the importer is complete
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+
+    Model::~Model() = default;
+
     /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
       Method:   Model::Initialize
       Summary:  Load and initialize the 3d model and create buffers
@@ -101,13 +111,16 @@ namespace library
 
     HRESULT Model::Initialize(_In_ ID3D11Device* pDevice, _In_ ID3D11DeviceContext* pImmediateContext)
     {
+        PROFILE_SCOPE("Import model");
 
         HRESULT hr = S_OK;
 
         // Create the buffers for the vertices attributes
 
-        // Read the 3d model file using the importer and get an aiScene
-        m_pScene = sm_pImporter->ReadFile(
+        // Read the 3d model file using the importer and get an aiScene.
+        // The importer owns the scene, which the animation reads every
+        // update, so each model keeps its own
+        m_pScene = m_pImporter->ReadFile(
             m_filePath.string().c_str(),
             aiProcess_Triangulate | aiProcess_GenSmoothNormals |
             aiProcess_CalcTangentSpace | aiProcess_ConvertToLeftHanded
@@ -129,7 +142,7 @@ namespace library
             OutputDebugString(L"Error parsing ");
             OutputDebugString(m_filePath.c_str());
             OutputDebugString(L": ");
-            OutputDebugStringA(sm_pImporter->GetErrorString());
+            OutputDebugStringA(m_pImporter->GetErrorString());
             OutputDebugString(L"\n");
         }
 
@@ -138,6 +151,11 @@ namespace library
             return hr;
         }
 
+        // A headless renderer has no device, the CPU side data is all it needs
+        if (!pDevice)
+        {
+            return S_OK;
+        }
 
         // Create the vertex buffer, m_animationBuffer with initial data  m_aAnimationData
         D3D11_BUFFER_DESC anim_bd =
@@ -240,6 +258,8 @@ namespace library
 
     void Model::Update(_In_ FLOAT deltaTime)
     {
+        PROFILE_SCOPE("Animation");
+
         //UNREFERENCED_PARAMETER(deltaTime);
 
         // Update  m_timeSinceLoaded by adding delta time
@@ -334,13 +354,44 @@ namespace library
     /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
         Method:   Model::GetBoneNameToIndexMap
         Summary:  Returns the bone name to index map
-        Returns:  std::unordered_map<std::string, UINT>&
+        Returns:  std::unordered_map<std::string, UINT, BoneNameHash, std::equal_to<>>&
      M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
-    const std::unordered_map<std::string, UINT>& Model::GetBoneNameToIndexMap() const
+    const std::unordered_map<std::string, UINT, BoneNameHash, std::equal_to<>>& Model::GetBoneNameToIndexMap() const
     {
         return m_boneNameToIndexMap;
     }
 
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   Model::HasAnimations
+      Summary:  Returns whether the model is animated, in which case its
+                meshes move away from the bind pose they were bounded in
+      Returns:  BOOL
+                  TRUE if the loaded scene has animations
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    BOOL Model::HasAnimations() const
+    {
+        return m_pScene && m_pScene->HasAnimations();
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   Model::GetShaderFeatures
+      Summary:  Returns the shader features of the model. A model with
+                bones is drawn with the skinning permutations, the
+                others without blending any bone
+      Returns:  UINT
+                  Mask of eShaderFeature
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    UINT Model::GetShaderFeatures() const
+    {
+        UINT uFeatures = Renderable::GetShaderFeatures();
+        if (!m_aBoneInfo.empty())
+        {
+            uFeatures |= GetShaderFeatureMask(eShaderFeature::SKINNING);
+        }
+
+        return uFeatures;
+    }
+
     /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
       Method:   Model::countVerticesAndIndices
       Summary:  Fill the BasicMeshEntry information
@@ -695,6 +746,8 @@ namespace library
                   Index of mesh
                 const aiMesh* pMesh
                   Point to an assimp mesh object
+      Modifies: [m_aVertices, m_aNormalData, m_aIndices, m_aMeshes,
+                  m_bounds].
     M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
 
     void Model::initSingleMesh(_In_ UINT uMeshIndex, _In_ const aiMesh* pMesh)
@@ -745,6 +798,10 @@ namespace library
             m_aIndices.push_back(aIndices[2]);
         }
 
+        // Bind pose bounding box of the mesh, merged into the one of the model
+        m_aMeshes[uMeshIndex].Bounds = FrustumCuller::ComputeBox(reinterpret_cast<const FLOAT*>(pMesh->mVertices), pMesh->mNumVertices, static_cast<UINT>(sizeof(aiVector3D)));
+        m_bounds = (uMeshIndex == 0u) ? m_aMeshes[uMeshIndex].Bounds : FrustumCuller::MergeBoxes(m_bounds, m_aMeshes[uMeshIndex].Bounds);
+
         // After populating the vertex attribute, call initMeshBones
         initMeshBones(uMeshIndex, pMesh);
     }
@@ -893,7 +950,7 @@ namespace library
 
                 std::filesystem::path fullPath = parentDirectory / szPath;
 
-                m_aMaterials[uIndex]->pDiffuse = std::make_shared<Texture>(fullPath);
+                m_aMaterials[uIndex]->pDiffuse = TextureCache::GetGlobal().Acquire(fullPath);
 
                 hr = m_aMaterials[uIndex]->pDiffuse->Initialize(pDevice, pImmediateContext);
                 if (FAILED(hr))
@@ -954,7 +1011,7 @@ namespace library
 
                 std::filesystem::path fullPath = parentDirectory / szPath;
 
-                m_aMaterials[uIndex]->pSpecularExponent = std::make_shared<Texture>(fullPath);
+                m_aMaterials[uIndex]->pSpecularExponent = TextureCache::GetGlobal().Acquire(fullPath);
 
                 hr = m_aMaterials[uIndex]->pSpecularExponent->Initialize(pDevice, pImmediateContext);
                 if (FAILED(hr))
@@ -1009,7 +1066,7 @@ namespace library
 
                 std::filesystem::path fullPath = parentDirectory / szPath;
 
-                m_aMaterials[uIndex]->pNormal = std::make_shared<Texture>(fullPath);
+                m_aMaterials[uIndex]->pNormal = TextureCache::GetGlobal().Acquire(fullPath);
                 m_bHasNormalMap = true;
 
                 if (FAILED(hr))
@@ -1116,12 +1173,12 @@ namespace library
         // Declare a XMMATRIX local variable gloablTransformation, represented by nodeTransformation * parentTransform
         XMMATRIX globalTransformation = nodeTransformation * parentTransform;
 
-        // If m_boneNameToIndexMap has the key that matches the name of the given node
-        if (m_boneNameToIndexMap.contains(pNode->mName.C_Str()))
+        // If m_boneNameToIndexMap has the key that matches the name of the given node,
+        // looked up by view, a name longer than the small string buffer would allocate
+        auto boneNameIndex = m_boneNameToIndexMap.find(std::string_view(pNode->mName.data, pNode->mName.length));
+        if (boneNameIndex != m_boneNameToIndexMap.end())
         {
             // Get the bone index and retrieve the boneInfo in m_aBoneInfo
-            auto boneNameIndex = m_boneNameToIndexMap.find(pNode->mName.C_Str());
-
             UINT boneIndex = boneNameIndex->second;
 
             // Set the FinalTransformation of boneInfo properly
@@ -12,6 +12,9 @@
 #pragma once
 
 #include "Common.h"
+
+#include <string_view>
+
 #include "Renderer/DataTypes.h"
 #include "Renderer/Renderable.h"
 #include "Shader/PixelShader.h"
@@ -33,6 +36,23 @@ namespace Assimp
 
 namespace library
 {
+    /*S+S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S
+      Struct:   BoneNameHash
+
+      Summary:  Hash of bone names that takes a string view as well, so
+                that the bones of a node are looked up every frame
+                without copying its name into a string
+    S---S---S---S---S---S---S---S---S---S---S---S---S---S---S---S---S-S*/
+    struct BoneNameHash
+    {
+        using is_transparent = void;
+
+        size_t operator()(_In_ std::string_view szName) const
+        {
+            return std::hash<std::string_view>()(szName);
+        }
+    };
+
     /*C+C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C
       Class:    Model
 
@@ -57,6 +77,11 @@ namespace library
                 GetNumIndices
                   Pure virtual function that returns the number of
                   indices
+                HasAnimations
+                  Returns whether the model is skinned and animated
+                GetShaderFeatures
+                  Returns the shader features, skinning for a model
+                  with bones
                 Model
                   Constructor.
                 ~Model
@@ -71,7 +96,7 @@ namespace library
         Model(Model&& other) = delete;
         Model& operator=(const Model& other) = delete;
         Model& operator=(Model&& other) = delete;
-        virtual ~Model() = default;
+        virtual ~Model();
 
         virtual HRESULT Initialize(_In_ ID3D11Device* pDevice, _In_ ID3D11DeviceContext* pImmediateContext);
         virtual void Update(_In_ FLOAT deltaTime) override;
@@ -83,7 +108,10 @@ namespace library
         virtual UINT GetNumIndices() const override;
 
         std::vector<XMMATRIX>& GetBoneTransforms();
-        const std::unordered_map<std::string, UINT>& GetBoneNameToIndexMap() const;
+        const std::unordered_map<std::string, UINT, BoneNameHash, std::equal_to<>>& GetBoneNameToIndexMap() const;
+        BOOL HasAnimations() const;
+
+        virtual UINT GetShaderFeatures() const override;
 
     protected:
         struct VertexBoneData
@@ -187,9 +215,6 @@ namespace library
         void readNodeHierarchy(_In_ FLOAT animationTimeTicks, _In_ const aiNode* pNode, _In_ const XMMATRIX& parentTransform);
         void reserveSpace(_In_ UINT uNumVertices, _In_ UINT uNumIndices);
 
-    protected:
-        static std::unique_ptr<Assimp::Importer> sm_pImporter;
-
     protected:
         std::filesystem::path m_filePath;
 
@@ -202,8 +227,9 @@ namespace library
         std::vector<VertexBoneData> m_aBoneData;
         std::vector<BoneInfo> m_aBoneInfo;
         std::vector<XMMATRIX> m_aTransforms;
-        std::unordered_map<std::string, UINT> m_boneNameToIndexMap;
+        std::unordered_map<std::string, UINT, BoneNameHash, std::equal_to<>> m_boneNameToIndexMap;
 
+        std::unique_ptr<Assimp::Importer> m_pImporter;
         const aiScene* m_pScene;
 
         float m_timeSinceLoaded;
@@ -0,0 +1,93 @@
+﻿/*+===================================================================
+  File:      PLATFORM.H
+
+  Summary:   Platform header file that provides the subset of the
+             Windows types, status codes and annotations the portable
+             parts of the Library project use, so those parts can be
+             compiled and exercised on non-Windows hosts.
+
+  Functions:
+
+  © 2022 Kyung Hee University
+===================================================================+*/
+#pragma once
+
+#ifndef _WIN32
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <cwchar>
+
+typedef int32_t BOOL;
+typedef uint8_t BYTE;
+typedef char CHAR;
+typedef wchar_t WCHAR;
+typedef uint16_t WORD;
+typedef uint16_t UINT16;
+typedef uint32_t DWORD;
+typedef int32_t INT;
+typedef uint32_t UINT;
+typedef int32_t LONG;
+typedef uint32_t ULONG;
+typedef int64_t INT64;
+typedef uint64_t UINT64;
+typedef int64_t LONGLONG;
+typedef float FLOAT;
+typedef int32_t HRESULT;
+typedef const CHAR* PCSTR;
+typedef const WCHAR* PCWSTR;
+typedef const WCHAR* LPCWSTR;
+
+#ifndef TRUE
+#define TRUE (1)
+#endif
+#ifndef FALSE
+#define FALSE (0)
+#endif
+
+#define S_OK            (static_cast<HRESULT>(0x00000000L))
+#define S_FALSE         (static_cast<HRESULT>(0x00000001L))
+#define E_NOTIMPL       (static_cast<HRESULT>(0x80004001L))
+#define E_ABORT         (static_cast<HRESULT>(0x80004004L))
+#define E_FAIL          (static_cast<HRESULT>(0x80004005L))
+#define E_PENDING       (static_cast<HRESULT>(0x8000000AL))
+#define E_UNEXPECTED    (static_cast<HRESULT>(0x8000FFFFL))
+#define E_OUTOFMEMORY   (static_cast<HRESULT>(0x8007000EL))
+#define E_INVALIDARG    (static_cast<HRESULT>(0x80070057L))
+
+#define SUCCEEDED(hr)   (static_cast<HRESULT>(hr) >= 0)
+#define FAILED(hr)      (static_cast<HRESULT>(hr) < 0)
+
+#define ARRAYSIZE(a)    (sizeof(a) / sizeof((a)[0]))
+#define UNREFERENCED_PARAMETER(p) (static_cast<void>(p))
+
+#define _In_
+#define _In_opt_
+#define _In_z_
+#define _In_reads_(size)
+#define _In_reads_bytes_(size)
+#define _Out_
+#define _Out_opt_
+#define _Out_writes_(size)
+#define _Out_writes_bytes_(size)
+#define _Inout_
+#define _Inout_opt_
+#define _Inout_updates_(size)
+#define _Outptr_
+#define _Outptr_opt_
+#define _Use_decl_annotations_
+
+inline void OutputDebugStringA(_In_ PCSTR pszOutputString)
+{
+    std::fputs(pszOutputString, stderr);
+}
+
+inline void OutputDebugStringW(_In_ PCWSTR pszOutputString)
+{
+    std::fputws(pszOutputString, stderr);
+}
+
+#define OutputDebugString OutputDebugStringW
+
+#endif // ! _WIN32
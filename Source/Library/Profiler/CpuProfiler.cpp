@@ -0,0 +1,470 @@
+#include "Profiler/CpuProfiler.h"
+
+#include "Memory/FrameArena.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <string_view>
+#include <unordered_map>
+
+#if defined(_M_X64) || defined(_M_IX86)
+#include <intrin.h>
+#define PROFILER_HAS_TSC 1
+#elif defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define PROFILER_HAS_TSC 1
+#else
+#define PROFILER_HAS_TSC 0
+#endif
+
+namespace library
+{
+    // Profiler the calling thread has a ring in, and the ring
+    static thread_local CpuProfiler* s_pProfiler = nullptr;
+    static thread_local ProfileThread* s_pProfileThread = nullptr;
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   ProfileScope::ProfileScope
+      Summary:  Constructor. Starts timing when the global profiler is
+                enabled
+      Args:     PCSTR pszName
+                  Name of the scope, a string literal
+      Modifies: [m_pThread, m_pszName, m_uStart].
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    ProfileScope::ProfileScope(_In_z_ PCSTR pszName)
+        : m_pThread(nullptr)
+        , m_pszName(pszName)
+        , m_uStart(0u)
+    {
+        CpuProfiler& profiler = CpuProfiler::GetGlobal();
+        if (profiler.IsEnabled())
+        {
+            m_pThread = profiler.getThread();
+            ++m_pThread->uDepth;
+            m_uStart = CpuProfiler::ReadTimestamp();
+        }
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   ProfileScope::~ProfileScope
+      Summary:  Destructor. Writes the event of the scope to the ring of
+                its thread, over the oldest one when the ring is full
+      Modifies: [m_pThread].
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    ProfileScope::~ProfileScope()
+    {
+        if (!m_pThread)
+        {
+            return;
+        }
+
+        const UINT64 uEnd = CpuProfiler::ReadTimestamp();
+        const UINT uDepth = --m_pThread->uDepth;
+        const UINT64 uIndex = m_pThread->uNumWritten.load(std::memory_order_relaxed);
+        m_pThread->aEvents[uIndex & (CpuProfiler::EVENTS_PER_THREAD - 1u)] = ProfileEvent
+        {
+            .pszName = m_pszName,
+            .uStart = m_uStart,
+            .uEnd = uEnd,
+            .uDepth = uDepth,
+        };
+        m_pThread->uNumWritten.store(uIndex + 1u, std::memory_order_release);
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   CpuProfiler::GetGlobal
+      Summary:  Returns the profiler shared by the whole library, the
+                one the scopes record to
+      Returns:  CpuProfiler&
+                  The global profiler
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    CpuProfiler& CpuProfiler::GetGlobal()
+    {
+        static CpuProfiler s_profiler;
+        return s_profiler;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   CpuProfiler::ReadTimestamp
+      Summary:  Reads the time stamp counter, a few cycles on x86. Other
+                processors read the steady clock in nanoseconds
+      Returns:  UINT64
+                  Ticks since an arbitrary point
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    UINT64 CpuProfiler::ReadTimestamp()
+    {
+#if PROFILER_HAS_TSC
+        return __rdtsc();
+#else
+        return static_cast<UINT64>(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count());
+#endif
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   CpuProfiler::CpuProfiler
+      Summary:  Constructor. Takes a first measure of the rate of the
+                time stamp counter, refined every frame
+      Modifies: [m_bEnabled, m_mutex, m_apThreads, m_aCapturedFrames,
+                  m_uOldestCapturedFrame, m_aFrameStatistics,
+                  m_aGpuFrameStatistics, m_uMaxCapturedFrames,
+                  m_uNumDroppedEvents, m_uBaseTimestamp, m_baseTime,
+                  m_ticksPerMillisecond].
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    CpuProfiler::CpuProfiler()
+        : m_bEnabled(FALSE)
+        , m_mutex()
+        , m_apThreads()
+        , m_aCapturedFrames()
+        , m_uOldestCapturedFrame(0u)
+        , m_aFrameStatistics()
+        , m_aGpuFrameStatistics()
+        , m_uMaxCapturedFrames(DEFAULT_MAX_CAPTURED_FRAMES)
+        , m_uNumDroppedEvents(0u)
+        , m_uBaseTimestamp(ReadTimestamp())
+        , m_baseTime(std::chrono::steady_clock::now())
+        , m_ticksPerMillisecond(1000000.0)
+    {
+        while (std::chrono::steady_clock::now() - m_baseTime < std::chrono::milliseconds(1))
+        {
+        }
+        calibrate();
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   CpuProfiler::SetEnabled
+      Summary:  Starts or stops recording scopes. Scopes already open
+                when it changes still record consistently
+      Args:     BOOL bEnable
+                  TRUE to record
+      Modifies: [m_bEnabled].
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    void CpuProfiler::SetEnabled(_In_ BOOL bEnable)
+    {
+        m_bEnabled.store(bEnable, std::memory_order_relaxed);
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   CpuProfiler::IsEnabled
+      Summary:  Tells whether scopes are recorded
+      Returns:  BOOL
+                  TRUE when recording
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    BOOL CpuProfiler::IsEnabled() const
+    {
+        return m_bEnabled.load(std::memory_order_relaxed);
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   CpuProfiler::SetThreadName
+      Summary:  Names the calling thread in the trace
+      Args:     PCSTR pszName
+                  Name of the thread
+      Modifies: [m_apThreads].
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    void CpuProfiler::SetThreadName(_In_z_ PCSTR pszName)
+    {
+        ProfileThread* pThread = getThread();
+
+        std::lock_guard<std::mutex> lock(m_mutex);
+        pThread->szName = pszName;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   CpuProfiler::SetMaxCapturedFrames
+      Summary:  Sets how many of the last frames the trace keeps, 0
+                keeps none
+      Args:     UINT uMaxFrames
+                  Number of frames
+      Modifies: [m_uMaxCapturedFrames, m_aCapturedFrames,
+                  m_uOldestCapturedFrame].
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    void CpuProfiler::SetMaxCapturedFrames(_In_ UINT uMaxFrames)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_uMaxCapturedFrames = uMaxFrames;
+
+        // Oldest frame first, then the oldest ones past the new count go
+        std::rotate(m_aCapturedFrames.begin(), m_aCapturedFrames.begin() + m_uOldestCapturedFrame, m_aCapturedFrames.end());
+        m_uOldestCapturedFrame = 0u;
+        if (m_aCapturedFrames.size() > m_uMaxCapturedFrames)
+        {
+            m_aCapturedFrames.erase(m_aCapturedFrames.begin(),
+                m_aCapturedFrames.begin() + static_cast<std::ptrdiff_t>(m_aCapturedFrames.size() - m_uMaxCapturedFrames));
+        }
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   CpuProfiler::EndFrame
+      Summary:  Drains the rings of every thread. The events of the
+                frame are ordered by start, summed per name into the
+                statistics of the frame, in the order the names first
+                ran, and kept for the trace. Events a thread wrote over
+                before they were drained are counted as dropped. The
+                events are gathered in the frame arena, and the trace
+                is a ring of frames whose storage is reused, so once
+                the frames stop growing no call reaches the heap
+      Modifies: [m_apThreads, m_aCapturedFrames, m_uOldestCapturedFrame,
+                  m_aFrameStatistics, m_uNumDroppedEvents,
+                  m_ticksPerMillisecond].
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    void CpuProfiler::EndFrame()
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        calibrate();
+
+        FrameVector<CapturedEvent> aEvents;
+        for (const std::unique_ptr<ProfileThread>& pThread : m_apThreads)
+        {
+            const UINT64 uNumWritten = pThread->uNumWritten.load(std::memory_order_acquire);
+            const UINT64 uFirst = std::max(pThread->uNumRead, uNumWritten > EVENTS_PER_THREAD ? uNumWritten - EVENTS_PER_THREAD : 0u);
+            m_uNumDroppedEvents += uFirst - pThread->uNumRead;
+
+            const size_t uFirstCopied = aEvents.size();
+            for (UINT64 i = uFirst; i < uNumWritten; ++i)
+            {
+                aEvents.push_back(CapturedEvent
+                    {
+                        .Event = pThread->aEvents[i & (EVENTS_PER_THREAD - 1u)],
+                        .uThread = pThread->uIndex,
+                    });
+            }
+
+            // The thread kept writing while the ring was copied, the
+            // slots it reached again hold newer events
+            const UINT64 uNumWrittenAfter = pThread->uNumWritten.load(std::memory_order_acquire);
+            if (uNumWrittenAfter > uFirst + EVENTS_PER_THREAD)
+            {
+                const UINT64 uNumOverwritten = std::min(uNumWrittenAfter - EVENTS_PER_THREAD - uFirst, uNumWritten - uFirst);
+                aEvents.erase(aEvents.begin() + static_cast<std::ptrdiff_t>(uFirstCopied),
+                    aEvents.begin() + static_cast<std::ptrdiff_t>(uFirstCopied + uNumOverwritten));
+                m_uNumDroppedEvents += uNumOverwritten;
+            }
+
+            pThread->uNumRead = uNumWritten;
+        }
+
+        std::sort(aEvents.begin(), aEvents.end(), [](const CapturedEvent& a, const CapturedEvent& b)
+            {
+                return a.Event.uStart < b.Event.uStart;
+            });
+
+        m_aFrameStatistics.clear();
+        FrameUnorderedMap<std::string_view, size_t> statisticIndices;
+        for (const CapturedEvent& captured : aEvents)
+        {
+            const FLOAT time = static_cast<FLOAT>(static_cast<double>(captured.Event.uEnd - captured.Event.uStart) / m_ticksPerMillisecond);
+            auto it = statisticIndices.find(captured.Event.pszName);
+            if (it == statisticIndices.end())
+            {
+                statisticIndices.emplace(captured.Event.pszName, m_aFrameStatistics.size());
+                m_aFrameStatistics.push_back(ProfileStatistic
+                    {
+                        .pszName = captured.Event.pszName,
+                        .eTimeline = eProfileTimeline::CPU,
+                        .uDepth = captured.Event.uDepth,
+                        .uNumCalls = 1u,
+                        .totalTime = time,
+                        .maxTime = time,
+                    });
+            }
+            else
+            {
+                ProfileStatistic& statistic = m_aFrameStatistics[it->second];
+                statistic.uDepth = std::min(statistic.uDepth, captured.Event.uDepth);
+                ++statistic.uNumCalls;
+                statistic.totalTime += time;
+                statistic.maxTime = std::max(statistic.maxTime, time);
+            }
+        }
+
+        if (m_uMaxCapturedFrames > 0u)
+        {
+            if (m_aCapturedFrames.size() < m_uMaxCapturedFrames)
+            {
+                m_aCapturedFrames.emplace_back(aEvents.begin(), aEvents.end());
+            }
+            else
+            {
+                m_aCapturedFrames[m_uOldestCapturedFrame].assign(aEvents.begin(), aEvents.end());
+                m_uOldestCapturedFrame = (m_uOldestCapturedFrame + 1u) % static_cast<UINT>(m_aCapturedFrames.size());
+            }
+        }
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   CpuProfiler::SetGpuFrameStatistics
+      Summary:  Keeps the GPU scopes of the last frame read back, a few
+                frames behind the CPU ones
+      Args:     const std::vector<ProfileStatistic>& aStatistics
+                  One statistic per name
+      Modifies: [m_aGpuFrameStatistics].
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    void CpuProfiler::SetGpuFrameStatistics(_In_ const std::vector<ProfileStatistic>& aStatistics)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_aGpuFrameStatistics = aStatistics;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   CpuProfiler::GetFrameStatistics
+      Summary:  Returns the scopes of the last frame summed per name,
+                those of the CPU followed by those of the GPU
+      Returns:  std::vector<ProfileStatistic>
+                  One statistic per name and timeline, in the order
+                  they first ran
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    std::vector<ProfileStatistic> CpuProfiler::GetFrameStatistics() const
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+
+        std::vector<ProfileStatistic> aStatistics;
+        aStatistics.reserve(m_aFrameStatistics.size() + m_aGpuFrameStatistics.size());
+        aStatistics.insert(aStatistics.end(), m_aFrameStatistics.begin(), m_aFrameStatistics.end());
+        aStatistics.insert(aStatistics.end(), m_aGpuFrameStatistics.begin(), m_aGpuFrameStatistics.end());
+
+        return aStatistics;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   CpuProfiler::GetNumDroppedEvents
+      Summary:  Returns the events lost because a thread wrote more of
+                them in a frame than its ring holds
+      Returns:  UINT64
+                  Number of events
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    UINT64 CpuProfiler::GetNumDroppedEvents() const
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_uNumDroppedEvents;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   CpuProfiler::WriteChromeTrace
+      Summary:  Writes the kept frames in the Trace Event format, one
+                complete event per scope in microseconds, with the names
+                of the threads
+      Args:     const std::filesystem::path& filePath
+                  Path of the JSON file
+      Returns:  HRESULT
+                  Status code
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    HRESULT CpuProfiler::WriteChromeTrace(_In_ const std::filesystem::path& filePath) const
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+
+        std::ofstream file(filePath, std::ios::trunc);
+        if (!file)
+        {
+            return E_FAIL;
+        }
+
+        file << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+
+        BOOL bFirst = TRUE;
+        for (const std::unique_ptr<ProfileThread>& pThread : m_apThreads)
+        {
+            const std::string szName = pThread->szName.empty() ? "Thread " + std::to_string(pThread->uIndex) : pThread->szName;
+            file << (bFirst ? "" : ",\n") << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << pThread->uIndex
+                << ",\"args\":{\"name\":\"" << escapeJson(szName.c_str()) << "\"}}";
+            bFirst = FALSE;
+        }
+
+        CHAR szTimes[64];
+        for (size_t uFrame = 0u; uFrame < m_aCapturedFrames.size(); ++uFrame)
+        {
+            const std::vector<CapturedEvent>& aEvents = m_aCapturedFrames[(m_uOldestCapturedFrame + uFrame) % m_aCapturedFrames.size()];
+            for (const CapturedEvent& captured : aEvents)
+            {
+                const double start = 1000.0 * static_cast<double>(static_cast<INT64>(captured.Event.uStart - m_uBaseTimestamp)) / m_ticksPerMillisecond;
+                const double duration = 1000.0 * static_cast<double>(captured.Event.uEnd - captured.Event.uStart) / m_ticksPerMillisecond;
+                std::snprintf(szTimes, sizeof(szTimes), "\"ts\":%.3f,\"dur\":%.3f", start, duration);
+
+                file << (bFirst ? "" : ",\n") << "{\"name\":\"" << escapeJson(captured.Event.pszName) << "\",\"cat\":\"cpu\",\"ph\":\"X\","
+                    << szTimes << ",\"pid\":1,\"tid\":" << captured.uThread << "}";
+                bFirst = FALSE;
+            }
+        }
+
+        file << "\n]}\n";
+
+        return file ? S_OK : E_FAIL;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   CpuProfiler::escapeJson
+      Summary:  Escapes a text to be written in a JSON string
+      Args:     PCSTR pszText
+                  Text to escape
+      Returns:  std::string
+                  The escaped text
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    std::string CpuProfiler::escapeJson(_In_z_ PCSTR pszText)
+    {
+        std::string szEscaped;
+        for (PCSTR pszChar = pszText; *pszChar != '\0'; ++pszChar)
+        {
+            if (*pszChar == '"' || *pszChar == '\\')
+            {
+                szEscaped += '\\';
+                szEscaped += *pszChar;
+            }
+            else if (static_cast<BYTE>(*pszChar) < 0x20u)
+            {
+                szEscaped += ' ';
+            }
+            else
+            {
+                szEscaped += *pszChar;
+            }
+        }
+
+        return szEscaped;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   CpuProfiler::getThread
+      Summary:  Returns the ring of the calling thread, created the
+                first time the thread records
+      Modifies: [m_apThreads].
+      Returns:  ProfileThread*
+                  Ring of the thread, owned by the profiler
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    ProfileThread* CpuProfiler::getThread()
+    {
+        if (s_pProfiler == this)
+        {
+            return s_pProfileThread;
+        }
+
+        std::lock_guard<std::mutex> lock(m_mutex);
+        std::unique_ptr<ProfileThread> pThread = std::make_unique<ProfileThread>();
+        pThread->aEvents = std::make_unique<ProfileEvent[]>(EVENTS_PER_THREAD);
+        pThread->uNumWritten.store(0u, std::memory_order_relaxed);
+        pThread->uNumRead = 0u;
+        pThread->uDepth = 0u;
+        pThread->uIndex = static_cast<UINT>(m_apThreads.size());
+        s_pProfiler = this;
+        s_pProfileThread = pThread.get();
+        m_apThreads.push_back(std::move(pThread));
+
+        return s_pProfileThread;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   CpuProfiler::calibrate
+      Summary:  Measures the rate of the time stamp counter against the
+                steady clock since the profiler was created, the longer
+                it runs the more precise
+      Modifies: [m_ticksPerMillisecond].
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    void CpuProfiler::calibrate()
+    {
+        const UINT64 uTimestamp = ReadTimestamp();
+        const double milliseconds = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - m_baseTime).count();
+        if (milliseconds > 0.0 && uTimestamp > m_uBaseTimestamp)
+        {
+            m_ticksPerMillisecond = static_cast<double>(uTimestamp - m_uBaseTimestamp) / milliseconds;
+        }
+    }
+}
@@ -0,0 +1,236 @@
+﻿/*+===================================================================
+  File:      CPUPROFILER.H
+
+  Summary:   CpuProfiler header file contains the profiling macros and
+             declarations of the eProfileTimeline, ProfileEvent and
+             ProfileStatistic types and of the ProfileScope and CpuProfiler classes that
+             time nested scopes of code on every thread.
+
+  Classes: ProfileScope, CpuProfiler
+
+  © 2022 Kyung Hee University
+===================================================================+*/
+#pragma once
+
+#include "Common.h"
+
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <string>
+
+// Markers are compiled in debug builds, or when the build defines
+// PROFILING_ENABLED to 1. Release builds compile them out entirely
+#ifndef PROFILING_ENABLED
+#ifdef NDEBUG
+#define PROFILING_ENABLED 0
+#else
+#define PROFILING_ENABLED 1
+#endif
+#endif
+
+#if PROFILING_ENABLED
+#define PROFILE_CONCATENATE_IMPL(a, b) a##b
+#define PROFILE_CONCATENATE(a, b) PROFILE_CONCATENATE_IMPL(a, b)
+#define PROFILE_SCOPE(pszName) library::ProfileScope PROFILE_CONCATENATE(profileScope, __LINE__)(pszName)
+#define PROFILE_END_FRAME() library::CpuProfiler::GetGlobal().EndFrame()
+#define PROFILE_THREAD_NAME(pszName) library::CpuProfiler::GetGlobal().SetThreadName(pszName)
+#else
+#define PROFILE_SCOPE(pszName) ((void)0)
+#define PROFILE_END_FRAME() ((void)0)
+#define PROFILE_THREAD_NAME(pszName) ((void)0)
+#endif
+
+namespace library
+{
+    /*E+E+++E+++E+++E+++E+++E+++E+++E+++E+++E+++E+++E+++E+++E+++E+++E+++E
+      Enum:     eProfileTimeline
+
+      Summary:  Enumeration of the clocks a scope is timed with
+    E---E---E---E---E---E---E---E---E---E---E---E---E---E---E---E---E-E*/
+    enum class eProfileTimeline : UINT
+    {
+        CPU = 0,
+        GPU,
+        COUNT,
+    };
+
+    /*S+S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S
+      Struct:   ProfileEvent
+
+      Summary:  Scope a thread ran, in timestamp ticks. The depth is the
+                number of scopes of the thread it is nested in
+    S---S---S---S---S---S---S---S---S---S---S---S---S---S---S---S---S-S*/
+    struct ProfileEvent
+    {
+        PCSTR pszName;
+        UINT64 uStart;
+        UINT64 uEnd;
+        UINT uDepth;
+    };
+
+    /*S+S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S
+      Struct:   ProfileStatistic
+
+      Summary:  Scopes of a name over the last frame, on every thread
+                or on the GPU: how many ran, their summed and longest
+                time in milliseconds, and the shallowest depth they ran
+                at
+    S---S---S---S---S---S---S---S---S---S---S---S---S---S---S---S---S-S*/
+    struct ProfileStatistic
+    {
+        PCSTR pszName;
+        eProfileTimeline eTimeline;
+        UINT uDepth;
+        UINT uNumCalls;
+        FLOAT totalTime;
+        FLOAT maxTime;
+    };
+
+    /*S+S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S
+      Struct:   ProfileThread
+
+      Summary:  Ring of the events of a thread. Only the thread writes
+                it and publishes them through the written count, the
+                profiler reads them back at the end of a frame
+    S---S---S---S---S---S---S---S---S---S---S---S---S---S---S---S---S-S*/
+    struct ProfileThread
+    {
+        std::unique_ptr<ProfileEvent[]> aEvents;
+        std::atomic<UINT64> uNumWritten;
+        UINT64 uNumRead;
+        UINT uDepth;
+        UINT uIndex;
+        std::string szName;
+    };
+
+    /*C+C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C
+      Class:    ProfileScope
+
+      Summary:  Times the scope it lives in when the profiler is
+                enabled, declared through PROFILE_SCOPE. The name must
+                be a string literal, only its pointer is kept
+
+      Methods:  ProfileScope
+                  Constructor. Starts timing
+                ~ProfileScope
+                  Destructor. Records the scope
+    C---C---C---C---C---C---C---C---C---C---C---C---C---C---C---C---C-C*/
+    class ProfileScope final
+    {
+    public:
+        explicit ProfileScope(_In_z_ PCSTR pszName);
+        ProfileScope(const ProfileScope& other) = delete;
+        ProfileScope(ProfileScope&& other) = delete;
+        ProfileScope& operator=(const ProfileScope& other) = delete;
+        ProfileScope& operator=(ProfileScope&& other) = delete;
+        ~ProfileScope();
+
+    private:
+        ProfileThread* m_pThread;
+        PCSTR m_pszName;
+        UINT64 m_uStart;
+    };
+
+    /*C+C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C
+      Class:    CpuProfiler
+
+      Summary:  Hierarchical CPU profiler. Scopes are timed with the
+                time stamp counter and written, without a lock, to a
+                ring of the thread that ran them. At the end of every
+                frame the rings are drained: the events are summed per
+                name into the statistics of the frame and the events of
+                the last frames are kept to be written as a Chrome trace
+                that chrome://tracing and Perfetto open. The GPU
+                timings of the last frame read back are merged into the
+                statistics after those of the CPU. Disabled, a scope
+                costs a load and a branch
+
+      Methods:  GetGlobal
+                  Returns the profiler shared by the whole library
+                ReadTimestamp
+                  Reads the time stamp counter
+                SetEnabled
+                  Starts or stops recording scopes
+                IsEnabled
+                  Tells whether scopes are recorded
+                SetThreadName
+                  Names the calling thread in the trace
+                SetMaxCapturedFrames
+                  Sets how many frames the trace keeps
+                EndFrame
+                  Collects the events of the frame
+                SetGpuFrameStatistics
+                  Sets the GPU scopes of the last frame read back
+                GetFrameStatistics
+                  Returns the scopes of the last frame summed per name
+                GetNumDroppedEvents
+                  Returns the events lost to full rings
+                WriteChromeTrace
+                  Writes the kept frames as a Chrome trace
+                CpuProfiler
+                  Constructor.
+                ~CpuProfiler
+                  Destructor.
+    C---C---C---C---C---C---C---C---C---C---C---C---C---C---C---C---C-C*/
+    class CpuProfiler final
+    {
+        friend class ProfileScope;
+
+    public:
+        static constexpr UINT EVENTS_PER_THREAD = 1u << 14u;
+        static constexpr UINT DEFAULT_MAX_CAPTURED_FRAMES = 300u;
+
+        static CpuProfiler& GetGlobal();
+        static UINT64 ReadTimestamp();
+
+    public:
+        CpuProfiler();
+        CpuProfiler(const CpuProfiler& other) = delete;
+        CpuProfiler(CpuProfiler&& other) = delete;
+        CpuProfiler& operator=(const CpuProfiler& other) = delete;
+        CpuProfiler& operator=(CpuProfiler&& other) = delete;
+        ~CpuProfiler() = default;
+
+        void SetEnabled(_In_ BOOL bEnable);
+        BOOL IsEnabled() const;
+        void SetThreadName(_In_z_ PCSTR pszName);
+        void SetMaxCapturedFrames(_In_ UINT uMaxFrames);
+
+        void EndFrame();
+        void SetGpuFrameStatistics(_In_ const std::vector<ProfileStatistic>& aStatistics);
+        std::vector<ProfileStatistic> GetFrameStatistics() const;
+        UINT64 GetNumDroppedEvents() const;
+        HRESULT WriteChromeTrace(_In_ const std::filesystem::path& filePath) const;
+
+    private:
+        /*S+S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S
+          Struct:   CapturedEvent
+
+          Summary:  Event kept for the trace, with the thread it ran on
+        S---S---S---S---S---S---S---S---S---S---S---S---S---S---S---S---S-S*/
+        struct CapturedEvent
+        {
+            ProfileEvent Event;
+            UINT uThread;
+        };
+
+        static std::string escapeJson(_In_z_ PCSTR pszText);
+
+        ProfileThread* getThread();
+        void calibrate();
+
+        std::atomic<BOOL> m_bEnabled;
+        mutable std::mutex m_mutex;
+        std::vector<std::unique_ptr<ProfileThread>> m_apThreads;
+        std::vector<std::vector<CapturedEvent>> m_aCapturedFrames;
+        UINT m_uOldestCapturedFrame;
+        std::vector<ProfileStatistic> m_aFrameStatistics;
+        std::vector<ProfileStatistic> m_aGpuFrameStatistics;
+        UINT m_uMaxCapturedFrames;
+        UINT64 m_uNumDroppedEvents;
+        UINT64 m_uBaseTimestamp;
+        std::chrono::steady_clock::time_point m_baseTime;
+        double m_ticksPerMillisecond;
+    };
+}
@@ -0,0 +1,340 @@
+#include "Profiler/GpuProfiler.h"
+
+#include <algorithm>
+#include <string_view>
+
+namespace library
+{
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   GpuProfiler::GpuProfiler
+      Summary:  Constructor
+      Modifies: [m_pContext, m_bEnabled, m_bTiming, m_uDepth,
+                  m_uQuerySet, m_aQuerySets, m_uOldestQuerySet,
+                  m_uNumPendingQuerySets, m_auTimestamps,
+                  m_aFrameStatistics, m_uNumLostFrames].
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    GpuProfiler::GpuProfiler()
+        : m_pContext(nullptr)
+        , m_bEnabled(FALSE)
+        , m_bTiming(FALSE)
+        , m_uDepth(0u)
+        , m_uQuerySet(0u)
+        , m_aQuerySets()
+        , m_uOldestQuerySet(0u)
+        , m_uNumPendingQuerySets(0u)
+        , m_auTimestamps()
+        , m_aFrameStatistics()
+        , m_uNumLostFrames(0u)
+    {
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   GpuProfiler::Initialize
+      Summary:  Creates the ring of query sets on the immediate render
+                context. The profiler stays unusable if it fails
+      Args:     RenderContext* pContext
+                  Immediate render context the frames are recorded into
+      Modifies: [m_pContext, m_aQuerySets, m_uOldestQuerySet,
+                  m_uNumPendingQuerySets].
+      Returns:  HRESULT
+                  Status code
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    HRESULT GpuProfiler::Initialize(_In_ RenderContext* pContext)
+    {
+        m_pContext = nullptr;
+        m_uOldestQuerySet = 0u;
+        m_uNumPendingQuerySets = 0u;
+
+        HRESULT hr = pContext->CreateTimestampQueries(NUM_QUERY_SETS, MAX_TIMESTAMPS);
+        if (FAILED(hr))
+        {
+            return hr;
+        }
+
+        for (QuerySet& querySet : m_aQuerySets)
+        {
+            querySet.aScopes.reserve(MAX_TIMESTAMPS / 2u);
+            querySet.uNumTimestamps = 0u;
+        }
+        m_pContext = pContext;
+
+        return S_OK;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   GpuProfiler::SetEnabled
+      Summary:  Starts or stops timing frames from the next one on. The
+                frames in flight are still read back
+      Args:     BOOL bEnable
+                  TRUE to time frames
+      Modifies: [m_bEnabled].
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    void GpuProfiler::SetEnabled(_In_ BOOL bEnable)
+    {
+        m_bEnabled = bEnable;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   GpuProfiler::IsEnabled
+      Summary:  Tells whether frames are timed
+      Returns:  BOOL
+                  TRUE if enabled and initialized
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    BOOL GpuProfiler::IsEnabled() const
+    {
+        return m_bEnabled && m_pContext;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   GpuProfiler::BeginFrame
+      Summary:  Reads back the sets the GPU is done with, then starts
+                filling the next free one with a scope around the whole
+                frame. With every set in flight the frame is lost
+      Modifies: [m_bTiming, m_uDepth, m_uQuerySet, m_aQuerySets,
+                  m_uNumLostFrames].
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    void GpuProfiler::BeginFrame()
+    {
+        m_bTiming = FALSE;
+        if (!m_pContext)
+        {
+            return;
+        }
+
+        readBack();
+        if (!m_bEnabled)
+        {
+            return;
+        }
+
+        if (m_uNumPendingQuerySets == NUM_QUERY_SETS)
+        {
+            ++m_uNumLostFrames;
+            return;
+        }
+
+        m_uQuerySet = (m_uOldestQuerySet + m_uNumPendingQuerySets) % NUM_QUERY_SETS;
+        QuerySet& querySet = m_aQuerySets[m_uQuerySet];
+        querySet.aScopes.clear();
+        querySet.uNumTimestamps = 0u;
+
+        m_pContext->BeginTimestampQueries(m_uQuerySet);
+        m_bTiming = TRUE;
+        m_uDepth = 0u;
+        BeginScope("GPU frame");
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   GpuProfiler::BeginScope
+      Summary:  Writes the timestamp a scope begins at
+      Args:     PCSTR pszName
+                  Name of the scope, a string literal
+      Modifies: [m_aQuerySets, m_uDepth].
+      Returns:  UINT
+                  Index of the scope to end, INVALID_SCOPE if the frame
+                  is not timed or its timestamps ran out
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    UINT GpuProfiler::BeginScope(_In_z_ PCSTR pszName)
+    {
+        if (!m_bTiming)
+        {
+            return INVALID_SCOPE;
+        }
+
+        // The timestamp the scope ends at is taken now, so that every
+        // scope begun can end
+        QuerySet& querySet = m_aQuerySets[m_uQuerySet];
+        if (querySet.uNumTimestamps + 2u > MAX_TIMESTAMPS)
+        {
+            return INVALID_SCOPE;
+        }
+
+        m_pContext->WriteTimestamp(m_uQuerySet, querySet.uNumTimestamps);
+        querySet.aScopes.push_back(GpuScope
+            {
+                .pszName = pszName,
+                .uBegin = querySet.uNumTimestamps,
+                .uEnd = INVALID_SCOPE,
+                .uDepth = m_uDepth++,
+            });
+        querySet.uNumTimestamps += 2u;
+
+        return static_cast<UINT>(querySet.aScopes.size()) - 1u;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   GpuProfiler::EndScope
+      Summary:  Writes the timestamp a scope ends at
+      Args:     UINT uScope
+                  Index BeginScope returned
+      Modifies: [m_aQuerySets, m_uDepth].
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    void GpuProfiler::EndScope(_In_ UINT uScope)
+    {
+        if (!m_bTiming || uScope == INVALID_SCOPE)
+        {
+            return;
+        }
+
+        GpuScope& scope = m_aQuerySets[m_uQuerySet].aScopes[uScope];
+        scope.uEnd = scope.uBegin + 1u;
+        m_pContext->WriteTimestamp(m_uQuerySet, scope.uEnd);
+        --m_uDepth;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   GpuProfiler::EndFrame
+      Summary:  Ends the scope of the frame and its set, which joins
+                the sets in flight, and reads back the done ones
+      Modifies: [m_bTiming, m_uNumPendingQuerySets].
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    void GpuProfiler::EndFrame()
+    {
+        if (!m_bTiming)
+        {
+            return;
+        }
+
+        EndScope(0u);
+        m_pContext->EndTimestampQueries(m_uQuerySet);
+        ++m_uNumPendingQuerySets;
+        m_bTiming = FALSE;
+
+        readBack();
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   GpuProfiler::GetFrameStatistics
+      Summary:  Returns the scopes of the last frame read back, summed
+                per name
+      Returns:  const std::vector<ProfileStatistic>&
+                  One statistic per name, in the order they began
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    const std::vector<ProfileStatistic>& GpuProfiler::GetFrameStatistics() const
+    {
+        return m_aFrameStatistics;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   GpuProfiler::GetNumLostFrames
+      Summary:  Returns the frames that were not timed because every
+                set was in flight, or whose timestamps were unreliable
+      Returns:  UINT64
+                  Number of frames
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    UINT64 GpuProfiler::GetNumLostFrames() const
+    {
+        return m_uNumLostFrames;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   GpuProfiler::readBack
+      Summary:  Reads back the sets in flight, oldest first, until one
+                is not done yet. The newest frame read back becomes the
+                statistics, frames the GPU clock changed in are lost
+      Modifies: [m_uOldestQuerySet, m_uNumPendingQuerySets,
+                  m_auTimestamps, m_aFrameStatistics, m_uNumLostFrames].
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    void GpuProfiler::readBack()
+    {
+        while (m_uNumPendingQuerySets > 0u)
+        {
+            const QuerySet& querySet = m_aQuerySets[m_uOldestQuerySet];
+            UINT64 uFrequency = 0u;
+            if (!m_pContext->GetTimestampQueryData(m_uOldestQuerySet, querySet.uNumTimestamps, m_auTimestamps, &uFrequency))
+            {
+                break;
+            }
+
+            if (uFrequency == 0u)
+            {
+                ++m_uNumLostFrames;
+            }
+            else
+            {
+                sumScopes(querySet, uFrequency);
+                CpuProfiler::GetGlobal().SetGpuFrameStatistics(m_aFrameStatistics);
+            }
+
+            m_uOldestQuerySet = (m_uOldestQuerySet + 1u) % NUM_QUERY_SETS;
+            --m_uNumPendingQuerySets;
+        }
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   GpuProfiler::sumScopes
+      Summary:  Sums the scopes of a set read back per name. A frame
+                has few scopes, the names are searched linearly
+      Args:     const QuerySet& querySet
+                  Set whose timestamps were read into m_auTimestamps
+                UINT64 uFrequency
+                  GPU ticks per second
+      Modifies: [m_aFrameStatistics].
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    void GpuProfiler::sumScopes(_In_ const QuerySet& querySet, _In_ UINT64 uFrequency)
+    {
+        const double millisecondsPerTick = 1000.0 / static_cast<double>(uFrequency);
+
+        m_aFrameStatistics.clear();
+        for (const GpuScope& scope : querySet.aScopes)
+        {
+            // A scope left open has no end
+            if (scope.uEnd == INVALID_SCOPE)
+            {
+                continue;
+            }
+
+            const UINT64 uBegin = m_auTimestamps[scope.uBegin];
+            const UINT64 uEnd = std::max(m_auTimestamps[scope.uEnd], uBegin);
+            const FLOAT time = static_cast<FLOAT>(static_cast<double>(uEnd - uBegin) * millisecondsPerTick);
+
+            auto it = std::find_if(m_aFrameStatistics.begin(), m_aFrameStatistics.end(), [&scope](const ProfileStatistic& statistic)
+                {
+                    return std::string_view(statistic.pszName) == scope.pszName;
+                });
+            if (it == m_aFrameStatistics.end())
+            {
+                m_aFrameStatistics.push_back(ProfileStatistic
+                    {
+                        .pszName = scope.pszName,
+                        .eTimeline = eProfileTimeline::GPU,
+                        .uDepth = scope.uDepth,
+                        .uNumCalls = 1u,
+                        .totalTime = time,
+                        .maxTime = time,
+                    });
+            }
+            else
+            {
+                it->uDepth = std::min(it->uDepth, scope.uDepth);
+                ++it->uNumCalls;
+                it->totalTime += time;
+                it->maxTime = std::max(it->maxTime, time);
+            }
+        }
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   GpuProfileScope::GpuProfileScope
+      Summary:  Constructor. Begins the scope
+      Args:     GpuProfiler& profiler
+                  Profiler of the frame
+                PCSTR pszName
+                  Name of the scope, a string literal
+      Modifies: [m_profiler, m_uScope].
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    GpuProfileScope::GpuProfileScope(_In_ GpuProfiler& profiler, _In_z_ PCSTR pszName)
+        : m_profiler(profiler)
+        , m_uScope(profiler.BeginScope(pszName))
+    {
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   GpuProfileScope::~GpuProfileScope
+      Summary:  Destructor. Ends the scope
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    GpuProfileScope::~GpuProfileScope()
+    {
+        m_profiler.EndScope(m_uScope);
+    }
+}
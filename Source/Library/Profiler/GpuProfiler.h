@@ -0,0 +1,153 @@
+﻿/*+===================================================================
+  File:      GPUPROFILER.H
+
+  Summary:   GpuProfiler header file contains declarations of the
+             GpuProfiler and GpuProfileScope classes that time the
+             passes of a frame on the GPU with timestamp queries.
+
+  Classes: GpuProfiler, GpuProfileScope
+
+  © 2022 Kyung Hee University
+===================================================================+*/
+#pragma once
+
+#include "Common.h"
+
+#include "Profiler/CpuProfiler.h"
+#include "Renderer/RenderContext.h"
+
+namespace library
+{
+    /*C+C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C
+      Class:    GpuProfiler
+
+      Summary:  Times nested scopes of the commands of a frame on the
+                GPU. Every frame fills one of a ring of timestamp query
+                sets, a timestamp where each scope begins and one where
+                it ends, and the sets are read back in order once the
+                GPU is done with them, a few frames later. A read never
+                waits: when every set is still in flight the frame is
+                not timed. Read back frames are summed per name into
+                the GPU statistics of the CPU profiler. The render
+                context owns the queries, the null render context times
+                the recording instead
+
+      Methods:  Initialize
+                  Creates the query sets on a render context
+                SetEnabled
+                  Starts or stops timing frames
+                IsEnabled
+                  Tells whether frames are timed
+                BeginFrame
+                  Starts timing a frame
+                BeginScope
+                  Starts timing a scope of the frame
+                EndScope
+                  Stops timing a scope of the frame
+                EndFrame
+                  Stops timing the frame and reads back the done ones
+                GetFrameStatistics
+                  Returns the scopes of the last frame read back
+                GetNumLostFrames
+                  Returns the frames that could not be timed
+                GpuProfiler
+                  Constructor.
+                ~GpuProfiler
+                  Destructor.
+    C---C---C---C---C---C---C---C---C---C---C---C---C---C---C---C---C-C*/
+    class GpuProfiler final
+    {
+    public:
+        static constexpr UINT NUM_QUERY_SETS = 4u;
+        static constexpr UINT MAX_TIMESTAMPS = 64u;
+        static constexpr UINT INVALID_SCOPE = 0xFFFFFFFFu;
+
+    public:
+        GpuProfiler();
+        GpuProfiler(const GpuProfiler& other) = delete;
+        GpuProfiler(GpuProfiler&& other) = delete;
+        GpuProfiler& operator=(const GpuProfiler& other) = delete;
+        GpuProfiler& operator=(GpuProfiler&& other) = delete;
+        ~GpuProfiler() = default;
+
+        HRESULT Initialize(_In_ RenderContext* pContext);
+        void SetEnabled(_In_ BOOL bEnable);
+        BOOL IsEnabled() const;
+
+        void BeginFrame();
+        UINT BeginScope(_In_z_ PCSTR pszName);
+        void EndScope(_In_ UINT uScope);
+        void EndFrame();
+
+        const std::vector<ProfileStatistic>& GetFrameStatistics() const;
+        UINT64 GetNumLostFrames() const;
+
+    private:
+        /*S+S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S
+          Struct:   GpuScope
+
+          Summary:  Scope of a frame and the timestamps it begins and
+                    ends at in its query set
+        S---S---S---S---S---S---S---S---S---S---S---S---S---S---S---S---S-S*/
+        struct GpuScope
+        {
+            PCSTR pszName;
+            UINT uBegin;
+            UINT uEnd;
+            UINT uDepth;
+        };
+
+        /*S+S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S
+          Struct:   QuerySet
+
+          Summary:  Scopes written into a set of timestamp queries and
+                    the number of timestamps they took
+        S---S---S---S---S---S---S---S---S---S---S---S---S---S---S---S---S-S*/
+        struct QuerySet
+        {
+            std::vector<GpuScope> aScopes;
+            UINT uNumTimestamps;
+        };
+
+        void readBack();
+        void sumScopes(_In_ const QuerySet& querySet, _In_ UINT64 uFrequency);
+
+        RenderContext* m_pContext;
+        BOOL m_bEnabled;
+        BOOL m_bTiming;
+        UINT m_uDepth;
+        UINT m_uQuerySet;
+        QuerySet m_aQuerySets[NUM_QUERY_SETS];
+        UINT m_uOldestQuerySet;
+        UINT m_uNumPendingQuerySets;
+        UINT64 m_auTimestamps[MAX_TIMESTAMPS];
+        std::vector<ProfileStatistic> m_aFrameStatistics;
+        UINT64 m_uNumLostFrames;
+    };
+
+    /*C+C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C
+      Class:    GpuProfileScope
+
+      Summary:  Times the commands recorded in the scope it lives in on
+                the GPU. The name must be a string literal
+
+      Methods:  GpuProfileScope
+                  Constructor. Begins the scope
+                ~GpuProfileScope
+                  Destructor. Ends the scope
+    C---C---C---C---C---C---C---C---C---C---C---C---C---C---C---C---C-C*/
+    class GpuProfileScope final
+    {
+    public:
+        GpuProfileScope(_In_ GpuProfiler& profiler, _In_z_ PCSTR pszName);
+        GpuProfileScope(const GpuProfileScope& other) = delete;
+        GpuProfileScope(GpuProfileScope&& other) = delete;
+        GpuProfileScope& operator=(const GpuProfileScope& other) = delete;
+        GpuProfileScope& operator=(GpuProfileScope&& other) = delete;
+        ~GpuProfileScope();
+
+    private:
+        GpuProfiler& m_profiler;
+        UINT m_uScope;
+    };
+}
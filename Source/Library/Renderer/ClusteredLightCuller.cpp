@@ -0,0 +1,534 @@
+#include "Renderer/ClusteredLightCuller.h"
+
+#include <algorithm>
+#include <cmath>
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__SSE__)
+#define CLUSTEREDLIGHTCULLER_SSE
+#include <xmmintrin.h>
+#endif
+
+namespace library
+{
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   ClusteredLightCuller::ClusteredLightCuller
+      Summary:  Constructor. Every cluster is empty until lights are
+                assigned
+      Modifies: [m_tanHalfFovX, m_tanHalfFovY, m_nearZ, m_farZ,
+                  m_sliceScale, m_sliceBias, m_aMin, m_aMax, m_aLights,
+                  m_aLightBounds, m_aClusterCounts, m_aClusterLights,
+                  m_aSliceDroppedLights, m_aClusterRanges,
+                  m_aLightIndices, m_uNumDroppedLights].
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    ClusteredLightCuller::ClusteredLightCuller()
+        : m_tanHalfFovX(1.0f)
+        , m_tanHalfFovY(1.0f)
+        , m_nearZ(1.0f)
+        , m_farZ(2.0f)
+        , m_sliceScale(0.0f)
+        , m_sliceBias(0.0f)
+        , m_aMin()
+        , m_aMax()
+        , m_aLights()
+        , m_aLightBounds()
+        , m_aClusterCounts(NUM_CLUSTERS, 0u)
+        , m_aClusterLights()
+        , m_aSliceDroppedLights(NUM_CLUSTERS_Z, 0u)
+        , m_aClusterRanges(NUM_CLUSTERS * 2u, 0u)
+        , m_aLightIndices()
+        , m_uNumDroppedLights(0u)
+    {
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   ClusteredLightCuller::SetProjection
+      Summary:  Builds the view space bounding boxes of the clusters of
+                a perspective projection looking down +z. Slices grow
+                exponentially from the near to the far plane
+      Args:     FLOAT tanHalfFovX
+                  Tangent of half the horizontal field of view
+                FLOAT tanHalfFovY
+                  Tangent of half the vertical field of view
+                FLOAT nearZ
+                  Distance to the near plane
+                FLOAT farZ
+                  Distance to the far plane
+      Modifies: [m_tanHalfFovX, m_tanHalfFovY, m_nearZ, m_farZ,
+                  m_sliceScale, m_sliceBias, m_aMin, m_aMax,
+                  m_aClusterLights].
+      Returns:  HRESULT
+                  Status code
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    HRESULT ClusteredLightCuller::SetProjection(_In_ FLOAT tanHalfFovX, _In_ FLOAT tanHalfFovY, _In_ FLOAT nearZ, _In_ FLOAT farZ)
+    {
+        if (!(tanHalfFovX > 0.0f) || !(tanHalfFovY > 0.0f) || !(nearZ > 0.0f) || !(farZ > nearZ))
+        {
+            return E_INVALIDARG;
+        }
+
+        m_tanHalfFovX = tanHalfFovX;
+        m_tanHalfFovY = tanHalfFovY;
+        m_nearZ = nearZ;
+        m_farZ = farZ;
+
+        // slice = log(z) * scale + bias, 0 at the near plane and
+        // NUM_CLUSTERS_Z at the far plane
+        const FLOAT logDepthRange = std::log(farZ / nearZ);
+        m_sliceScale = static_cast<FLOAT>(NUM_CLUSTERS_Z) / logDepthRange;
+        m_sliceBias = -static_cast<FLOAT>(NUM_CLUSTERS_Z) * std::log(nearZ) / logDepthRange;
+
+        for (UINT uAxis = 0u; uAxis < 3u; ++uAxis)
+        {
+            m_aMin[uAxis].resize(NUM_CLUSTERS);
+            m_aMax[uAxis].resize(NUM_CLUSTERS);
+        }
+
+        for (UINT z = 0u; z < NUM_CLUSTERS_Z; ++z)
+        {
+            const FLOAT sliceNear = nearZ * std::pow(farZ / nearZ, static_cast<FLOAT>(z) / NUM_CLUSTERS_Z);
+            const FLOAT sliceFar = nearZ * std::pow(farZ / nearZ, static_cast<FLOAT>(z + 1u) / NUM_CLUSTERS_Z);
+
+            for (UINT y = 0u; y < NUM_CLUSTERS_Y; ++y)
+            {
+                // Rows count from the top of the screen
+                const FLOAT ndcTop = 1.0f - 2.0f * static_cast<FLOAT>(y) / NUM_CLUSTERS_Y;
+                const FLOAT ndcBottom = 1.0f - 2.0f * static_cast<FLOAT>(y + 1u) / NUM_CLUSTERS_Y;
+
+                for (UINT x = 0u; x < NUM_CLUSTERS_X; ++x)
+                {
+                    const FLOAT ndcLeft = -1.0f + 2.0f * static_cast<FLOAT>(x) / NUM_CLUSTERS_X;
+                    const FLOAT ndcRight = -1.0f + 2.0f * static_cast<FLOAT>(x + 1u) / NUM_CLUSTERS_X;
+                    const UINT uCluster = (z * NUM_CLUSTERS_Y + y) * NUM_CLUSTERS_X + x;
+
+                    // The side planes go through the eye, the extremes lie on
+                    // the near or the far face
+                    m_aMin[0][uCluster] = std::min(ndcLeft * sliceNear, ndcLeft * sliceFar) * tanHalfFovX;
+                    m_aMax[0][uCluster] = std::max(ndcRight * sliceNear, ndcRight * sliceFar) * tanHalfFovX;
+                    m_aMin[1][uCluster] = std::min(ndcBottom * sliceNear, ndcBottom * sliceFar) * tanHalfFovY;
+                    m_aMax[1][uCluster] = std::max(ndcTop * sliceNear, ndcTop * sliceFar) * tanHalfFovY;
+                    m_aMin[2][uCluster] = sliceNear;
+                    m_aMax[2][uCluster] = sliceFar;
+                }
+            }
+        }
+
+        m_aClusterLights.resize(MAX_LIGHT_INDICES);
+
+        return S_OK;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   ClusteredLightCuller::BeginFrame
+      Summary:  Takes the lights of a frame, empties every cluster and
+                finds the range of clusters each light may touch
+      Args:     const LightSphere* aLights
+                  Lights in view space
+                UINT uNumLights
+                  Number of lights
+      Modifies: [m_aLights, m_aLightBounds, m_aClusterCounts,
+                  m_aSliceDroppedLights].
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    void ClusteredLightCuller::BeginFrame(_In_reads_(uNumLights) const LightSphere* aLights, _In_ UINT uNumLights)
+    {
+        assert(m_aClusterLights.size() == MAX_LIGHT_INDICES);
+
+        m_aLights.assign(aLights, aLights + uNumLights);
+        m_aLightBounds.resize(uNumLights);
+        for (UINT i = 0u; i < uNumLights; ++i)
+        {
+            m_aLightBounds[i] = computeBounds(aLights[i]);
+        }
+
+        std::fill(m_aClusterCounts.begin(), m_aClusterCounts.end(), 0u);
+        std::fill(m_aSliceDroppedLights.begin(), m_aSliceDroppedLights.end(), 0u);
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   ClusteredLightCuller::AssignSlice
+      Summary:  Tests the lights that reach a depth slice against the
+                boxes of its clusters and appends the ones that touch
+                to their lists, in light order. Only writes the
+                clusters of the slice, so distinct slices can be
+                assigned concurrently
+      Args:     UINT uSlice
+                  Index of the depth slice
+      Modifies: [m_aClusterCounts, m_aClusterLights,
+                  m_aSliceDroppedLights].
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    void ClusteredLightCuller::AssignSlice(_In_ UINT uSlice)
+    {
+        assert(uSlice < NUM_CLUSTERS_Z);
+
+#ifdef CLUSTEREDLIGHTCULLER_SSE
+        const UINT uNumLights = static_cast<UINT>(m_aLights.size());
+        for (UINT uLight = 0u; uLight < uNumLights; ++uLight)
+        {
+            const LightBounds& bounds = m_aLightBounds[uLight];
+            if (uSlice < bounds.uFirstSlice || uSlice > bounds.uLastSlice)
+            {
+                continue;
+            }
+
+            const LightSphere& light = m_aLights[uLight];
+            const UINT uFirstGroup = bounds.uFirstX / SIMD_WIDTH * SIMD_WIDTH;
+            const __m128 centerX = _mm_set1_ps(light.Center[0]);
+            const __m128 centerY = _mm_set1_ps(light.Center[1]);
+            const __m128 centerZ = _mm_set1_ps(light.Center[2]);
+            const __m128 radiusSquared = _mm_set1_ps(light.Radius * light.Radius);
+            const __m128 zero = _mm_setzero_ps();
+
+            for (UINT y = bounds.uFirstY; y <= bounds.uLastY; ++y)
+            {
+                const UINT uRow = (uSlice * NUM_CLUSTERS_Y + y) * NUM_CLUSTERS_X;
+                for (UINT x = uFirstGroup; x <= bounds.uLastX; x += SIMD_WIDTH)
+                {
+                    // Distance from the center to the box along each axis, 0 inside
+                    const UINT uGroup = uRow + x;
+                    const __m128 dx = _mm_max_ps(_mm_max_ps(_mm_sub_ps(_mm_loadu_ps(&m_aMin[0][uGroup]), centerX), _mm_sub_ps(centerX, _mm_loadu_ps(&m_aMax[0][uGroup]))), zero);
+                    const __m128 dy = _mm_max_ps(_mm_max_ps(_mm_sub_ps(_mm_loadu_ps(&m_aMin[1][uGroup]), centerY), _mm_sub_ps(centerY, _mm_loadu_ps(&m_aMax[1][uGroup]))), zero);
+                    const __m128 dz = _mm_max_ps(_mm_max_ps(_mm_sub_ps(_mm_loadu_ps(&m_aMin[2][uGroup]), centerZ), _mm_sub_ps(centerZ, _mm_loadu_ps(&m_aMax[2][uGroup]))), zero);
+                    const __m128 distanceSquared = _mm_add_ps(_mm_add_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dy, dy)), _mm_mul_ps(dz, dz));
+
+                    const INT iTouched = _mm_movemask_ps(_mm_cmple_ps(distanceSquared, radiusSquared));
+                    for (UINT uLane = 0u; uLane < SIMD_WIDTH; ++uLane)
+                    {
+                        const UINT uX = x + uLane;
+                        if ((iTouched & (1 << uLane)) && uX >= bounds.uFirstX && uX <= bounds.uLastX)
+                        {
+                            addLight(uSlice, uRow + uX, uLight);
+                        }
+                    }
+                }
+            }
+        }
+#else
+        AssignSliceScalar(uSlice);
+#endif
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   ClusteredLightCuller::AssignSliceScalar
+      Summary:  Lists the lights of the clusters of a depth slice like
+                AssignSlice, one cluster at a time without SIMD
+      Args:     UINT uSlice
+                  Index of the depth slice
+      Modifies: [m_aClusterCounts, m_aClusterLights,
+                  m_aSliceDroppedLights].
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    void ClusteredLightCuller::AssignSliceScalar(_In_ UINT uSlice)
+    {
+        assert(uSlice < NUM_CLUSTERS_Z);
+
+        const UINT uNumLights = static_cast<UINT>(m_aLights.size());
+        for (UINT uLight = 0u; uLight < uNumLights; ++uLight)
+        {
+            const LightBounds& bounds = m_aLightBounds[uLight];
+            if (uSlice < bounds.uFirstSlice || uSlice > bounds.uLastSlice)
+            {
+                continue;
+            }
+
+            const LightSphere& light = m_aLights[uLight];
+            for (UINT y = bounds.uFirstY; y <= bounds.uLastY; ++y)
+            {
+                const UINT uRow = (uSlice * NUM_CLUSTERS_Y + y) * NUM_CLUSTERS_X;
+                for (UINT x = bounds.uFirstX; x <= bounds.uLastX; ++x)
+                {
+                    const UINT uCluster = uRow + x;
+                    FLOAT distanceSquared = 0.0f;
+                    for (UINT uAxis = 0u; uAxis < 3u; ++uAxis)
+                    {
+                        const FLOAT d = std::max(std::max(m_aMin[uAxis][uCluster] - light.Center[uAxis], light.Center[uAxis] - m_aMax[uAxis][uCluster]), 0.0f);
+                        distanceSquared += d * d;
+                    }
+
+                    if (distanceSquared <= light.Radius * light.Radius)
+                    {
+                        addLight(uSlice, uCluster, uLight);
+                    }
+                }
+            }
+        }
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   ClusteredLightCuller::EndFrame
+      Summary:  Packs the lists of the clusters back to back into the
+                light index list and records where each one starts
+      Modifies: [m_aClusterRanges, m_aLightIndices, m_uNumDroppedLights].
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    void ClusteredLightCuller::EndFrame()
+    {
+        UINT uNumIndices = 0u;
+        for (UINT uCluster = 0u; uCluster < NUM_CLUSTERS; ++uCluster)
+        {
+            m_aClusterRanges[uCluster * 2u] = uNumIndices;
+            m_aClusterRanges[uCluster * 2u + 1u] = m_aClusterCounts[uCluster];
+            uNumIndices += m_aClusterCounts[uCluster];
+        }
+
+        m_aLightIndices.resize(uNumIndices);
+        for (UINT uCluster = 0u; uCluster < NUM_CLUSTERS; ++uCluster)
+        {
+            const UINT* pFirst = m_aClusterLights.data() + uCluster * MAX_LIGHTS_PER_CLUSTER;
+            std::copy(pFirst, pFirst + m_aClusterCounts[uCluster], m_aLightIndices.begin() + m_aClusterRanges[uCluster * 2u]);
+        }
+
+        m_uNumDroppedLights = 0u;
+        for (UINT uDropped : m_aSliceDroppedLights)
+        {
+            m_uNumDroppedLights += uDropped;
+        }
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   ClusteredLightCuller::Cull
+      Summary:  Assigns the lights of a frame to the clusters on the
+                calling thread
+      Args:     const LightSphere* aLights
+                  Lights in view space
+                UINT uNumLights
+                  Number of lights
+      Modifies: [m_aLights, m_aLightBounds, m_aClusterCounts,
+                  m_aClusterLights, m_aSliceDroppedLights,
+                  m_aClusterRanges, m_aLightIndices, m_uNumDroppedLights].
+      Returns:  UINT
+                  Length of the light index list
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    UINT ClusteredLightCuller::Cull(_In_reads_(uNumLights) const LightSphere* aLights, _In_ UINT uNumLights)
+    {
+        BeginFrame(aLights, uNumLights);
+        for (UINT uSlice = 0u; uSlice < NUM_CLUSTERS_Z; ++uSlice)
+        {
+            AssignSlice(uSlice);
+        }
+        EndFrame();
+
+        return GetNumLightIndices();
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   ClusteredLightCuller::CullScalar
+      Summary:  Assigns the lights of a frame to the clusters on the
+                calling thread like Cull, without SIMD
+      Args:     const LightSphere* aLights
+                  Lights in view space
+                UINT uNumLights
+                  Number of lights
+      Modifies: [m_aLights, m_aLightBounds, m_aClusterCounts,
+                  m_aClusterLights, m_aSliceDroppedLights,
+                  m_aClusterRanges, m_aLightIndices, m_uNumDroppedLights].
+      Returns:  UINT
+                  Length of the light index list
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    UINT ClusteredLightCuller::CullScalar(_In_reads_(uNumLights) const LightSphere* aLights, _In_ UINT uNumLights)
+    {
+        BeginFrame(aLights, uNumLights);
+        for (UINT uSlice = 0u; uSlice < NUM_CLUSTERS_Z; ++uSlice)
+        {
+            AssignSliceScalar(uSlice);
+        }
+        EndFrame();
+
+        return GetNumLightIndices();
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   ClusteredLightCuller::GetClusterBox
+      Summary:  Returns the view space bounding box of a cluster
+      Args:     UINT uCluster
+                  Index of the cluster
+      Returns:  AxisAlignedBox
+                  Bounding box
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    AxisAlignedBox ClusteredLightCuller::GetClusterBox(_In_ UINT uCluster) const
+    {
+        assert(uCluster < NUM_CLUSTERS && m_aMin[0].size() == NUM_CLUSTERS);
+
+        AxisAlignedBox box;
+        for (UINT uAxis = 0u; uAxis < 3u; ++uAxis)
+        {
+            box.Center[uAxis] = 0.5f * (m_aMin[uAxis][uCluster] + m_aMax[uAxis][uCluster]);
+            box.Extents[uAxis] = 0.5f * (m_aMax[uAxis][uCluster] - m_aMin[uAxis][uCluster]);
+        }
+
+        return box;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   ClusteredLightCuller::GetClusterRanges
+      Summary:  Returns where the list of every cluster starts in the
+                light index list and how long it is
+      Returns:  const UINT*
+                  NUM_CLUSTERS pairs of offset and count
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    const UINT* ClusteredLightCuller::GetClusterRanges() const
+    {
+        return m_aClusterRanges.data();
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   ClusteredLightCuller::GetLightIndices
+      Summary:  Returns the light index list
+      Returns:  const UINT*
+                  Indices into the lights given to BeginFrame
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    const UINT* ClusteredLightCuller::GetLightIndices() const
+    {
+        return m_aLightIndices.data();
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   ClusteredLightCuller::GetNumLightIndices
+      Summary:  Returns the length of the light index list
+      Returns:  UINT
+                  Number of indices
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    UINT ClusteredLightCuller::GetNumLightIndices() const
+    {
+        return static_cast<UINT>(m_aLightIndices.size());
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   ClusteredLightCuller::GetNumDroppedLights
+      Summary:  Returns how many times a light touched a cluster that
+                already listed MAX_LIGHTS_PER_CLUSTER lights
+      Returns:  UINT
+                  Number of dropped cluster entries
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    UINT ClusteredLightCuller::GetNumDroppedLights() const
+    {
+        return m_uNumDroppedLights;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   ClusteredLightCuller::GetSliceScale
+      Summary:  Returns the scale of the slice of a view depth,
+                slice = log(depth) * scale + bias
+      Returns:  FLOAT
+                  Slice scale
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    FLOAT ClusteredLightCuller::GetSliceScale() const
+    {
+        return m_sliceScale;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   ClusteredLightCuller::GetSliceBias
+      Summary:  Returns the bias of the slice of a view depth
+      Returns:  FLOAT
+                  Slice bias
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    FLOAT ClusteredLightCuller::GetSliceBias() const
+    {
+        return m_sliceBias;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   ClusteredLightCuller::getSlice
+      Summary:  Returns the slice a view depth falls into
+      Args:     FLOAT depth
+                  View depth, clamped to the near and far planes
+      Returns:  UINT
+                  Index of the slice
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    UINT ClusteredLightCuller::getSlice(_In_ FLOAT depth) const
+    {
+        const FLOAT slice = std::floor(std::log(std::clamp(depth, m_nearZ, m_farZ)) * m_sliceScale + m_sliceBias);
+
+        return static_cast<UINT>(std::clamp(slice, 0.0f, static_cast<FLOAT>(NUM_CLUSTERS_Z - 1u)));
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   ClusteredLightCuller::getTile
+      Summary:  Returns the tile a normalized device coordinate falls
+                into, counting from -1
+      Args:     FLOAT ndc
+                  Coordinate, clamped to [-1, 1]
+                UINT uNumTiles
+                  Number of tiles along the axis
+      Returns:  UINT
+                  Index of the tile
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    UINT ClusteredLightCuller::getTile(_In_ FLOAT ndc, _In_ UINT uNumTiles) const
+    {
+        const FLOAT tile = std::floor((std::clamp(ndc, -1.0f, 1.0f) + 1.0f) * 0.5f * static_cast<FLOAT>(uNumTiles));
+
+        return std::min(static_cast<UINT>(tile), uNumTiles - 1u);
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   ClusteredLightCuller::computeBounds
+      Summary:  Returns the clusters a light may touch. The view space
+                box of the sphere, cut by the near and far planes, is
+                projected conservatively: x / z is monotonic in z, so
+                the extremes lie at the nearest or the farthest depth
+      Args:     const LightSphere& light
+                  Light in view space
+      Returns:  LightBounds
+                  Ranges of clusters, empty when the light lies outside
+                  of the frustum
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    ClusteredLightCuller::LightBounds ClusteredLightCuller::computeBounds(_In_ const LightSphere& light) const
+    {
+        const LightBounds empty = { .uFirstX = 1u, .uLastX = 0u, .uFirstY = 1u, .uLastY = 0u, .uFirstSlice = 1u, .uLastSlice = 0u };
+
+        const FLOAT nearest = std::max(light.Center[2] - light.Radius, m_nearZ);
+        const FLOAT farthest = std::min(light.Center[2] + light.Radius, m_farZ);
+        if (nearest > farthest)
+        {
+            return empty;
+        }
+
+        const FLOAT left = light.Center[0] - light.Radius;
+        const FLOAT right = light.Center[0] + light.Radius;
+        const FLOAT bottom = light.Center[1] - light.Radius;
+        const FLOAT top = light.Center[1] + light.Radius;
+
+        const FLOAT ndcLeft = std::min(left / nearest, left / farthest) / m_tanHalfFovX;
+        const FLOAT ndcRight = std::max(right / nearest, right / farthest) / m_tanHalfFovX;
+        const FLOAT ndcBottom = std::min(bottom / nearest, bottom / farthest) / m_tanHalfFovY;
+        const FLOAT ndcTop = std::max(top / nearest, top / farthest) / m_tanHalfFovY;
+        if (ndcRight < -1.0f || ndcLeft > 1.0f || ndcTop < -1.0f || ndcBottom > 1.0f)
+        {
+            return empty;
+        }
+
+        // Rows count from the top, so the top of the light is the first row
+        return
+        {
+            .uFirstX = getTile(ndcLeft, NUM_CLUSTERS_X),
+            .uLastX = getTile(ndcRight, NUM_CLUSTERS_X),
+            .uFirstY = NUM_CLUSTERS_Y - 1u - getTile(ndcTop, NUM_CLUSTERS_Y),
+            .uLastY = NUM_CLUSTERS_Y - 1u - getTile(ndcBottom, NUM_CLUSTERS_Y),
+            .uFirstSlice = getSlice(nearest),
+            .uLastSlice = getSlice(farthest)
+        };
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   ClusteredLightCuller::addLight
+      Summary:  Appends a light to the list of a cluster, or counts it
+                as dropped when the list is full
+      Args:     UINT uSlice
+                  Slice of the cluster
+                UINT uCluster
+                  Index of the cluster
+                UINT uLight
+                  Index of the light
+      Modifies: [m_aClusterCounts, m_aClusterLights,
+                  m_aSliceDroppedLights].
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    void ClusteredLightCuller::addLight(_In_ UINT uSlice, _In_ UINT uCluster, _In_ UINT uLight)
+    {
+        UINT& uCount = m_aClusterCounts[uCluster];
+        if (uCount == MAX_LIGHTS_PER_CLUSTER)
+        {
+            ++m_aSliceDroppedLights[uSlice];
+            return;
+        }
+
+        m_aClusterLights[uCluster * MAX_LIGHTS_PER_CLUSTER + uCount] = uLight;
+        ++uCount;
+    }
+}
@@ -0,0 +1,156 @@
+﻿/*+===================================================================
+  File:      CLUSTEREDLIGHTCULLER.H
+
+  Summary:   ClusteredLightCuller header file contains declarations of
+             the LightSphere type and the ClusteredLightCuller class
+             that assigns point lights to the clusters of a view
+             frustum.
+
+  Classes: ClusteredLightCuller
+
+  © 2022 Kyung Hee University
+===================================================================+*/
+#pragma once
+
+#include "Common.h"
+
+#include "Renderer/FrustumCuller.h"
+
+namespace library
+{
+    /*S+S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S
+      Struct:   LightSphere
+
+      Summary:  Sphere of influence of a point light in view space
+    S---S---S---S---S---S---S---S---S---S---S---S---S---S---S---S---S-S*/
+    struct LightSphere
+    {
+        FLOAT Center[3];
+        FLOAT Radius;
+    };
+
+    /*C+C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C
+      Class:    ClusteredLightCuller
+
+      Summary:  Splits the view frustum into screen tiles and
+                exponential depth slices, and lists for every cluster
+                the lights whose sphere touches its bounding box. The
+                spheres are tested against four clusters of a row at a
+                time with SSE when available. Slices are independent,
+                so they can be assigned on several threads between
+                BeginFrame and EndFrame. The result is a range of the
+                light index list per cluster, x fastest, then y from
+                the top of the screen, then z
+
+      Methods:  SetProjection
+                  Builds the bounding boxes of the clusters
+                BeginFrame
+                  Takes the lights of a frame
+                AssignSlice
+                  Lists the lights of the clusters of a depth slice
+                AssignSliceScalar
+                  Lists the lights of a depth slice without SIMD
+                EndFrame
+                  Packs the lists into the light index list
+                Cull
+                  Assigns every slice on the calling thread
+                CullScalar
+                  Assigns every slice on the calling thread without
+                  SIMD
+                GetClusterBox
+                  Returns the bounding box of a cluster
+                GetClusterRanges
+                  Returns the offset and count of every cluster
+                GetLightIndices
+                  Returns the light index list
+                GetNumLightIndices
+                  Returns the length of the light index list
+                GetNumDroppedLights
+                  Returns the lights left out of full clusters
+                GetSliceScale
+                  Returns the scale from log depth to slice
+                GetSliceBias
+                  Returns the bias from log depth to slice
+                ClusteredLightCuller
+                  Constructor.
+                ~ClusteredLightCuller
+                  Destructor.
+    C---C---C---C---C---C---C---C---C---C---C---C---C---C---C---C---C-C*/
+    class ClusteredLightCuller final
+    {
+    public:
+        static constexpr UINT SIMD_WIDTH = 4u;
+        static constexpr UINT NUM_CLUSTERS_X = 16u;
+        static constexpr UINT NUM_CLUSTERS_Y = 9u;
+        static constexpr UINT NUM_CLUSTERS_Z = 24u;
+        static constexpr UINT NUM_CLUSTERS = NUM_CLUSTERS_X * NUM_CLUSTERS_Y * NUM_CLUSTERS_Z;
+        static constexpr UINT MAX_LIGHTS_PER_CLUSTER = 64u;
+        static constexpr UINT MAX_LIGHT_INDICES = NUM_CLUSTERS * MAX_LIGHTS_PER_CLUSTER;
+
+        static_assert(NUM_CLUSTERS_X % SIMD_WIDTH == 0u, "Rows of clusters are tested a SIMD group at a time");
+
+    public:
+        ClusteredLightCuller();
+        ClusteredLightCuller(const ClusteredLightCuller& other) = default;
+        ClusteredLightCuller(ClusteredLightCuller&& other) = default;
+        ClusteredLightCuller& operator=(const ClusteredLightCuller& other) = default;
+        ClusteredLightCuller& operator=(ClusteredLightCuller&& other) = default;
+        ~ClusteredLightCuller() = default;
+
+        HRESULT SetProjection(_In_ FLOAT tanHalfFovX, _In_ FLOAT tanHalfFovY, _In_ FLOAT nearZ, _In_ FLOAT farZ);
+
+        void BeginFrame(_In_reads_(uNumLights) const LightSphere* aLights, _In_ UINT uNumLights);
+        void AssignSlice(_In_ UINT uSlice);
+        void AssignSliceScalar(_In_ UINT uSlice);
+        void EndFrame();
+        UINT Cull(_In_reads_(uNumLights) const LightSphere* aLights, _In_ UINT uNumLights);
+        UINT CullScalar(_In_reads_(uNumLights) const LightSphere* aLights, _In_ UINT uNumLights);
+
+        AxisAlignedBox GetClusterBox(_In_ UINT uCluster) const;
+        const UINT* GetClusterRanges() const;
+        const UINT* GetLightIndices() const;
+        UINT GetNumLightIndices() const;
+        UINT GetNumDroppedLights() const;
+        FLOAT GetSliceScale() const;
+        FLOAT GetSliceBias() const;
+
+    private:
+        /*S+S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S
+          Struct:   LightBounds
+
+          Summary:  Clusters a light may touch, inclusive ranges along
+                    every axis, empty when uFirstSlice > uLastSlice
+        S---S---S---S---S---S---S---S---S---S---S---S---S---S---S---S---S-S*/
+        struct LightBounds
+        {
+            UINT uFirstX;
+            UINT uLastX;
+            UINT uFirstY;
+            UINT uLastY;
+            UINT uFirstSlice;
+            UINT uLastSlice;
+        };
+
+        UINT getSlice(_In_ FLOAT depth) const;
+        UINT getTile(_In_ FLOAT ndc, _In_ UINT uNumTiles) const;
+        LightBounds computeBounds(_In_ const LightSphere& light) const;
+        void addLight(_In_ UINT uSlice, _In_ UINT uCluster, _In_ UINT uLight);
+
+        FLOAT m_tanHalfFovX;
+        FLOAT m_tanHalfFovY;
+        FLOAT m_nearZ;
+        FLOAT m_farZ;
+        FLOAT m_sliceScale;
+        FLOAT m_sliceBias;
+        std::vector<FLOAT> m_aMin[3];
+        std::vector<FLOAT> m_aMax[3];
+        std::vector<LightSphere> m_aLights;
+        std::vector<LightBounds> m_aLightBounds;
+        std::vector<UINT> m_aClusterCounts;
+        std::vector<UINT> m_aClusterLights;
+        std::vector<UINT> m_aSliceDroppedLights;
+        std::vector<UINT> m_aClusterRanges;
+        std::vector<UINT> m_aLightIndices;
+        UINT m_uNumDroppedLights;
+    };
+}
@@ -0,0 +1,673 @@
+#include "Renderer/D3D11RenderContext.h"
+
+#include <cstring>
+
+namespace library
+{
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   D3D11RenderContext::D3D11RenderContext
+      Summary:  Constructor
+      Args:     ID3D11DeviceContext* pDeviceContext
+                  The immediate or deferred context to record into
+      Modifies: [m_deviceContext, m_deviceContext1, m_commandList,
+                  m_aPendingFences, m_aFreeQueries,
+                  m_uCompletedFenceValue, m_aTimestampQuerySets,
+                  m_pConstantBufferCopies, m_aaSlotConstantBuffers].
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    D3D11RenderContext::D3D11RenderContext(_In_ ID3D11DeviceContext* pDeviceContext)
+        : RenderContext()
+        , m_deviceContext(pDeviceContext)
+        , m_deviceContext1()
+        , m_commandList()
+        , m_aPendingFences()
+        , m_aFreeQueries()
+        , m_uCompletedFenceValue(0u)
+        , m_aTimestampQuerySets()
+        , m_pConstantBufferCopies(nullptr)
+        , m_aaSlotConstantBuffers()
+    {
+        // Null on the Direct3D 11.0 runtime, ranges are copied then
+        m_deviceContext.As(&m_deviceContext1);
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   D3D11RenderContext::GetDeviceContext
+      Summary:  Returns the wrapped device context
+      Returns:  ComPtr<ID3D11DeviceContext>&
+                  The device context
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    ComPtr<ID3D11DeviceContext>& D3D11RenderContext::GetDeviceContext()
+    {
+        return m_deviceContext;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   D3D11RenderContext::CopyConstantBufferRanges
+      Summary:  Binds constant buffer ranges without offsets, for
+                devices that lack them. Maps of the buffers in the
+                copies write the copies, and each bound range is copied
+                into a buffer of its slot with a discard map
+      Args:     ConstantBufferCopies* pCopies
+                  CPU copies of the buffers ranges are bound from,
+                  shared by the contexts of the device
+      Modifies: [m_pConstantBufferCopies].
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    void D3D11RenderContext::CopyConstantBufferRanges(_In_ ConstantBufferCopies* pCopies)
+    {
+        m_pConstantBufferCopies = pCopies;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   D3D11RenderContext::clearRenderTarget
+      Summary:  Clears a render target view
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    void D3D11RenderContext::clearRenderTarget(_In_ RenderHandle renderTargetView, _In_ const FLOAT aColor[4])
+    {
+        m_deviceContext->ClearRenderTargetView(fromHandle<ID3D11RenderTargetView>(renderTargetView), aColor);
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   D3D11RenderContext::clearDepthStencil
+      Summary:  Clears the depth of a depth stencil view
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    void D3D11RenderContext::clearDepthStencil(_In_ RenderHandle depthStencilView, _In_ FLOAT depth)
+    {
+        m_deviceContext->ClearDepthStencilView(fromHandle<ID3D11DepthStencilView>(depthStencilView), D3D11_CLEAR_DEPTH, depth, 0);
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   D3D11RenderContext::setRenderTargets
+      Summary:  Binds render targets and a depth stencil view
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    void D3D11RenderContext::setRenderTargets(_In_ UINT uNumViews, _In_reads_(uNumViews) const RenderHandle* aRenderTargetViews, _In_opt_ RenderHandle depthStencilView)
+    {
+        ID3D11RenderTargetView* apViews[MAX_RENDER_TARGETS] = {};
+        for (UINT i = 0u; i < uNumViews; ++i)
+        {
+            apViews[i] = fromHandle<ID3D11RenderTargetView>(aRenderTargetViews[i]);
+        }
+
+        m_deviceContext->OMSetRenderTargets(uNumViews, apViews, fromHandle<ID3D11DepthStencilView>(depthStencilView));
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   D3D11RenderContext::setViewport
+      Summary:  Sets the rasterizer viewport
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    void D3D11RenderContext::setViewport(_In_ FLOAT width, _In_ FLOAT height)
+    {
+        D3D11_VIEWPORT vp =
+        {
+            .TopLeftX = 0.0f,
+            .TopLeftY = 0.0f,
+            .Width = width,
+            .Height = height,
+            .MinDepth = 0.0f,
+            .MaxDepth = 1.0f,
+        };
+        m_deviceContext->RSSetViewports(1, &vp);
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   D3D11RenderContext::setPrimitiveTopology
+      Summary:  Sets the input assembler primitive topology
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    void D3D11RenderContext::setPrimitiveTopology(_In_ ePrimitiveTopology topology)
+    {
+        switch (topology)
+        {
+        case ePrimitiveTopology::TRIANGLE_LIST:
+        default:
+            m_deviceContext->IASetPrimitiveTopology(D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
+            break;
+        }
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   D3D11RenderContext::setVertexBuffers
+      Summary:  Binds vertex buffers to the input assembler
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    void D3D11RenderContext::setVertexBuffers(_In_ UINT uStartSlot, _In_ UINT uNumBuffers, _In_reads_(uNumBuffers) const RenderHandle* aBuffers, _In_reads_(uNumBuffers) const UINT* aStrides, _In_reads_(uNumBuffers) const UINT* aOffsets)
+    {
+        ID3D11Buffer* apBuffers[MAX_VERTEX_BUFFERS] = {};
+        for (UINT i = 0u; i < uNumBuffers; ++i)
+        {
+            apBuffers[i] = fromHandle<ID3D11Buffer>(aBuffers[i]);
+        }
+
+        m_deviceContext->IASetVertexBuffers(uStartSlot, uNumBuffers, apBuffers, aStrides, aOffsets);
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   D3D11RenderContext::setIndexBuffer
+      Summary:  Binds an index buffer to the input assembler
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    void D3D11RenderContext::setIndexBuffer(_In_ RenderHandle indexBuffer, _In_ eIndexFormat format, _In_ UINT uOffset)
+    {
+        m_deviceContext->IASetIndexBuffer(
+            fromHandle<ID3D11Buffer>(indexBuffer),
+            format == eIndexFormat::R32_UINT ? DXGI_FORMAT_R32_UINT : DXGI_FORMAT_R16_UINT,
+            uOffset
+        );
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   D3D11RenderContext::setInputLayout
+      Summary:  Binds an input layout to the input assembler
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    void D3D11RenderContext::setInputLayout(_In_ RenderHandle inputLayout)
+    {
+        m_deviceContext->IASetInputLayout(fromHandle<ID3D11InputLayout>(inputLayout));
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   D3D11RenderContext::setVertexShader
+      Summary:  Binds a vertex shader
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    void D3D11RenderContext::setVertexShader(_In_ RenderHandle vertexShader)
+    {
+        m_deviceContext->VSSetShader(fromHandle<ID3D11VertexShader>(vertexShader), nullptr, 0u);
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   D3D11RenderContext::setPixelShader
+      Summary:  Binds a pixel shader
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    void D3D11RenderContext::setPixelShader(_In_ RenderHandle pixelShader)
+    {
+        m_deviceContext->PSSetShader(fromHandle<ID3D11PixelShader>(pixelShader), nullptr, 0u);
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   D3D11RenderContext::setVertexConstantBuffers
+      Summary:  Binds constant buffers to the vertex shader stage
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    void D3D11RenderContext::setVertexConstantBuffers(_In_ UINT uStartSlot, _In_ UINT uNumBuffers, _In_reads_(uNumBuffers) const RenderHandle* aBuffers)
+    {
+        ID3D11Buffer* apBuffers[MAX_CONSTANT_BUFFERS] = {};
+        for (UINT i = 0u; i < uNumBuffers; ++i)
+        {
+            apBuffers[i] = fromHandle<ID3D11Buffer>(aBuffers[i]);
+        }
+
+        m_deviceContext->VSSetConstantBuffers(uStartSlot, uNumBuffers, apBuffers);
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   D3D11RenderContext::setPixelConstantBuffers
+      Summary:  Binds constant buffers to the pixel shader stage
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    void D3D11RenderContext::setPixelConstantBuffers(_In_ UINT uStartSlot, _In_ UINT uNumBuffers, _In_reads_(uNumBuffers) const RenderHandle* aBuffers)
+    {
+        ID3D11Buffer* apBuffers[MAX_CONSTANT_BUFFERS] = {};
+        for (UINT i = 0u; i < uNumBuffers; ++i)
+        {
+            apBuffers[i] = fromHandle<ID3D11Buffer>(aBuffers[i]);
+        }
+
+        m_deviceContext->PSSetConstantBuffers(uStartSlot, uNumBuffers, apBuffers);
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   D3D11RenderContext::setPixelShaderResources
+      Summary:  Binds shader resource views to the pixel shader stage
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    void D3D11RenderContext::setPixelShaderResources(_In_ UINT uStartSlot, _In_ UINT uNumViews, _In_reads_(uNumViews) const RenderHandle* aViews)
+    {
+        ID3D11ShaderResourceView* apViews[MAX_SHADER_RESOURCES] = {};
+        for (UINT i = 0u; i < uNumViews; ++i)
+        {
+            apViews[i] = fromHandle<ID3D11ShaderResourceView>(aViews[i]);
+        }
+
+        m_deviceContext->PSSetShaderResources(uStartSlot, uNumViews, apViews);
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   D3D11RenderContext::setPixelSamplers
+      Summary:  Binds sampler states to the pixel shader stage
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    void D3D11RenderContext::setPixelSamplers(_In_ UINT uStartSlot, _In_ UINT uNumSamplers, _In_reads_(uNumSamplers) const RenderHandle* aSamplers)
+    {
+        ID3D11SamplerState* apSamplers[MAX_SAMPLERS] = {};
+        for (UINT i = 0u; i < uNumSamplers; ++i)
+        {
+            apSamplers[i] = fromHandle<ID3D11SamplerState>(aSamplers[i]);
+        }
+
+        m_deviceContext->PSSetSamplers(uStartSlot, uNumSamplers, apSamplers);
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   D3D11RenderContext::setVertexConstantBufferRanges
+      Summary:  Binds constant buffer ranges to the vertex shader
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    void D3D11RenderContext::setVertexConstantBufferRanges(_In_ UINT uStartSlot, _In_ UINT uNumBuffers, _In_reads_(uNumBuffers) const ConstantBufferRange* aRanges)
+    {
+        setConstantBufferRanges(FALSE, uStartSlot, uNumBuffers, aRanges);
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   D3D11RenderContext::setPixelConstantBufferRanges
+      Summary:  Binds constant buffer ranges to the pixel shader
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    void D3D11RenderContext::setPixelConstantBufferRanges(_In_ UINT uStartSlot, _In_ UINT uNumBuffers, _In_reads_(uNumBuffers) const ConstantBufferRange* aRanges)
+    {
+        setConstantBufferRanges(TRUE, uStartSlot, uNumBuffers, aRanges);
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   D3D11RenderContext::updateConstantBuffer
+      Summary:  Uploads the whole contents of a constant buffer
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    void D3D11RenderContext::updateConstantBuffer(_In_ RenderHandle buffer, _In_reads_bytes_(uDataSize) const void* pData, _In_ UINT)
+    {
+        m_deviceContext->UpdateSubresource(fromHandle<ID3D11Buffer>(buffer), 0u, nullptr, pData, 0u, 0u);
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   D3D11RenderContext::mapBuffer
+      Summary:  Maps a dynamic buffer with WRITE_DISCARD or
+                WRITE_NO_OVERWRITE
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    void* D3D11RenderContext::mapBuffer(_In_ RenderHandle buffer, _In_ eMapMode mode, _In_ UINT)
+    {
+        if (m_pConstantBufferCopies)
+        {
+            // The GPU never reads the buffer itself, only the copied ranges
+            const auto copy = m_pConstantBufferCopies->aCopies.find(buffer);
+            if (copy != m_pConstantBufferCopies->aCopies.end())
+            {
+                return copy->second.data();
+            }
+        }
+
+        D3D11_MAPPED_SUBRESOURCE mappedSubresource = {};
+        const D3D11_MAP mapType = (mode == eMapMode::WRITE_DISCARD) ? D3D11_MAP_WRITE_DISCARD : D3D11_MAP_WRITE_NO_OVERWRITE;
+        if (FAILED(m_deviceContext->Map(fromHandle<ID3D11Buffer>(buffer), 0u, mapType, 0u, &mappedSubresource)))
+        {
+            return nullptr;
+        }
+
+        return mappedSubresource.pData;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   D3D11RenderContext::unmapBuffer
+      Summary:  Unmaps a dynamic buffer
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    void D3D11RenderContext::unmapBuffer(_In_ RenderHandle buffer)
+    {
+        if (m_pConstantBufferCopies && m_pConstantBufferCopies->aCopies.contains(buffer))
+        {
+            return;
+        }
+
+        m_deviceContext->Unmap(fromHandle<ID3D11Buffer>(buffer), 0u);
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   D3D11RenderContext::copySubresource
+      Summary:  Copies a subresource of a texture into another
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    void D3D11RenderContext::copySubresource(_In_ RenderHandle destination, _In_ UINT uDestinationSubresource, _In_ RenderHandle source, _In_ UINT uSourceSubresource)
+    {
+        m_deviceContext->CopySubresourceRegion(fromHandle<ID3D11Resource>(destination), uDestinationSubresource, 0u, 0u, 0u,
+            fromHandle<ID3D11Resource>(source), uSourceSubresource, nullptr);
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   D3D11RenderContext::drawIndexed
+      Summary:  Draws indexed, non-instanced primitives
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    void D3D11RenderContext::drawIndexed(_In_ UINT uIndexCount, _In_ UINT uStartIndexLocation, _In_ INT iBaseVertexLocation)
+    {
+        m_deviceContext->DrawIndexed(uIndexCount, uStartIndexLocation, iBaseVertexLocation);
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   D3D11RenderContext::drawIndexedInstanced
+      Summary:  Draws indexed, instanced primitives
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    void D3D11RenderContext::drawIndexedInstanced(_In_ UINT uIndexCountPerInstance, _In_ UINT uInstanceCount, _In_ UINT uStartIndexLocation, _In_ INT iBaseVertexLocation, _In_ UINT uStartInstanceLocation)
+    {
+        m_deviceContext->DrawIndexedInstanced(uIndexCountPerInstance, uInstanceCount, uStartIndexLocation, iBaseVertexLocation, uStartInstanceLocation);
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   D3D11RenderContext::finishCommandList
+      Summary:  Closes the deferred context into a command list. The
+                context state is not restored, the next list starts
+                from the default state
+      Modifies: [m_commandList].
+      Returns:  HRESULT
+                  Status code
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    HRESULT D3D11RenderContext::finishCommandList()
+    {
+        m_commandList.Reset();
+
+        return m_deviceContext->FinishCommandList(FALSE, m_commandList.GetAddressOf());
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   D3D11RenderContext::executeCommandList
+      Summary:  Plays back and releases the command list of a deferred
+                context
+      Args:     RenderContext& deferredContext
+                  Deferred context, must be a D3D11RenderContext
+      Returns:  HRESULT
+                  Status code
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    HRESULT D3D11RenderContext::executeCommandList(_In_ RenderContext& deferredContext)
+    {
+        D3D11RenderContext& d3dContext = static_cast<D3D11RenderContext&>(deferredContext);
+        if (!d3dContext.m_commandList)
+        {
+            return E_FAIL;
+        }
+
+        m_deviceContext->ExecuteCommandList(d3dContext.m_commandList.Get(), FALSE);
+        d3dContext.m_commandList.Reset();
+
+        return S_OK;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   D3D11RenderContext::signalFence
+      Summary:  Ends an event query after the commands issued so far.
+                Queries are recycled once they complete
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    void D3D11RenderContext::signalFence(_In_ UINT64 uFenceValue)
+    {
+        ComPtr<ID3D11Query> query;
+        if (!m_aFreeQueries.empty())
+        {
+            query = std::move(m_aFreeQueries.back());
+            m_aFreeQueries.pop_back();
+        }
+        else
+        {
+            ComPtr<ID3D11Device> device;
+            m_deviceContext->GetDevice(device.GetAddressOf());
+
+            const D3D11_QUERY_DESC queryDesc =
+            {
+                .Query = D3D11_QUERY_EVENT,
+                .MiscFlags = 0u
+            };
+            // Without a query the fence never completes, which is safe
+            if (FAILED(device->CreateQuery(&queryDesc, query.GetAddressOf())))
+            {
+                return;
+            }
+        }
+
+        m_deviceContext->End(query.Get());
+        m_aPendingFences.push_back({ .uValue = uFenceValue, .query = std::move(query) });
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   D3D11RenderContext::getCompletedFenceValue
+      Summary:  Polls the pending event queries in order without
+                flushing the command buffer
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    UINT64 D3D11RenderContext::getCompletedFenceValue()
+    {
+        while (!m_aPendingFences.empty())
+        {
+            PendingFence& fence = m_aPendingFences.front();
+            if (m_deviceContext->GetData(fence.query.Get(), nullptr, 0u, D3D11_ASYNC_GETDATA_DONOTFLUSH) != S_OK)
+            {
+                break;
+            }
+
+            m_uCompletedFenceValue = fence.uValue;
+            m_aFreeQueries.push_back(std::move(fence.query));
+            m_aPendingFences.pop_front();
+        }
+
+        return m_uCompletedFenceValue;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   D3D11RenderContext::createTimestampQueries
+      Summary:  Creates a disjoint query and the timestamp queries of
+                every set
+      Args:     UINT uNumQuerySets
+                  Number of sets
+                UINT uNumTimestamps
+                  Number of timestamps of every set
+      Modifies: [m_aTimestampQuerySets].
+      Returns:  HRESULT
+                  Status code
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    HRESULT D3D11RenderContext::createTimestampQueries(_In_ UINT uNumQuerySets, _In_ UINT uNumTimestamps)
+    {
+        HRESULT hr = S_OK;
+
+        ComPtr<ID3D11Device> device;
+        m_deviceContext->GetDevice(device.GetAddressOf());
+
+        const D3D11_QUERY_DESC disjointDesc =
+        {
+            .Query = D3D11_QUERY_TIMESTAMP_DISJOINT,
+            .MiscFlags = 0u
+        };
+        const D3D11_QUERY_DESC timestampDesc =
+        {
+            .Query = D3D11_QUERY_TIMESTAMP,
+            .MiscFlags = 0u
+        };
+
+        m_aTimestampQuerySets.clear();
+        m_aTimestampQuerySets.resize(uNumQuerySets);
+        for (TimestampQuerySet& querySet : m_aTimestampQuerySets)
+        {
+            hr = device->CreateQuery(&disjointDesc, querySet.disjoint.GetAddressOf());
+            if (FAILED(hr))
+            {
+                m_aTimestampQuerySets.clear();
+                return hr;
+            }
+
+            querySet.aTimestamps.resize(uNumTimestamps);
+            for (ComPtr<ID3D11Query>& timestamp : querySet.aTimestamps)
+            {
+                hr = device->CreateQuery(&timestampDesc, timestamp.GetAddressOf());
+                if (FAILED(hr))
+                {
+                    m_aTimestampQuerySets.clear();
+                    return hr;
+                }
+            }
+        }
+
+        return S_OK;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   D3D11RenderContext::beginTimestampQueries
+      Summary:  Begins the disjoint query of a set
+      Args:     UINT uQuerySet
+                  Index of the set
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    void D3D11RenderContext::beginTimestampQueries(_In_ UINT uQuerySet)
+    {
+        m_deviceContext->Begin(m_aTimestampQuerySets[uQuerySet].disjoint.Get());
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   D3D11RenderContext::writeTimestamp
+      Summary:  Ends a timestamp query, timestamp queries only end
+      Args:     UINT uQuerySet
+                  Index of the set being filled
+                UINT uTimestamp
+                  Index of the timestamp in the set
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    void D3D11RenderContext::writeTimestamp(_In_ UINT uQuerySet, _In_ UINT uTimestamp)
+    {
+        m_deviceContext->End(m_aTimestampQuerySets[uQuerySet].aTimestamps[uTimestamp].Get());
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   D3D11RenderContext::endTimestampQueries
+      Summary:  Ends the disjoint query of a set
+      Args:     UINT uQuerySet
+                  Index of the set
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    void D3D11RenderContext::endTimestampQueries(_In_ UINT uQuerySet)
+    {
+        m_deviceContext->End(m_aTimestampQuerySets[uQuerySet].disjoint.Get());
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   D3D11RenderContext::getTimestampQueryData
+      Summary:  Polls the disjoint query of a set, then its timestamps,
+                without flushing the command buffer
+      Args:     UINT uQuerySet
+                  Index of the set
+                UINT uNumTimestamps
+                  Number of timestamps written into the set
+                UINT64* auTimestamps
+                  Receives the timestamps in GPU ticks
+                UINT64* puFrequency
+                  Receives the GPU ticks per second, 0 if the GPU
+                  clock changed while the set was filled
+      Returns:  BOOL
+                  FALSE if any query of the set is not done
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    BOOL D3D11RenderContext::getTimestampQueryData(_In_ UINT uQuerySet, _In_ UINT uNumTimestamps, _Out_writes_(uNumTimestamps) UINT64* auTimestamps, _Out_ UINT64* puFrequency)
+    {
+        const TimestampQuerySet& querySet = m_aTimestampQuerySets[uQuerySet];
+
+        D3D11_QUERY_DATA_TIMESTAMP_DISJOINT disjoint = {};
+        if (m_deviceContext->GetData(querySet.disjoint.Get(), &disjoint, sizeof(disjoint), D3D11_ASYNC_GETDATA_DONOTFLUSH) != S_OK)
+        {
+            return FALSE;
+        }
+
+        for (UINT i = 0u; i < uNumTimestamps; ++i)
+        {
+            if (m_deviceContext->GetData(querySet.aTimestamps[i].Get(), &auTimestamps[i], sizeof(UINT64), D3D11_ASYNC_GETDATA_DONOTFLUSH) != S_OK)
+            {
+                return FALSE;
+            }
+        }
+
+        *puFrequency = disjoint.Disjoint ? 0u : disjoint.Frequency;
+
+        return TRUE;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   D3D11RenderContext::setConstantBufferRanges
+      Summary:  Binds constant buffer ranges to a shader stage with the
+                Direct3D 11.1 offset binding
+      Args:     BOOL bPixelStage
+                  TRUE for the pixel shader, FALSE for the vertex
+                  shader
+                UINT uStartSlot
+                  First constant buffer slot
+                UINT uNumBuffers
+                  Number of ranges
+                const ConstantBufferRange* aRanges
+                  Ranges to bind, all of them must have a size
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    void D3D11RenderContext::setConstantBufferRanges(_In_ BOOL bPixelStage, _In_ UINT uStartSlot, _In_ UINT uNumBuffers, _In_reads_(uNumBuffers) const ConstantBufferRange* aRanges)
+    {
+        if (m_pConstantBufferCopies)
+        {
+            copyConstantBufferRanges(bPixelStage, uStartSlot, uNumBuffers, aRanges);
+            return;
+        }
+
+        assert(m_deviceContext1);
+
+        ID3D11Buffer* apBuffers[MAX_CONSTANT_BUFFERS];
+        UINT auFirstConstants[MAX_CONSTANT_BUFFERS];
+        UINT auNumConstants[MAX_CONSTANT_BUFFERS];
+        for (UINT i = 0u; i < uNumBuffers; ++i)
+        {
+            assert(aRanges[i].uNumConstants != 0u);
+            apBuffers[i] = fromHandle<ID3D11Buffer>(aRanges[i].buffer);
+            auFirstConstants[i] = aRanges[i].uFirstConstant;
+            auNumConstants[i] = aRanges[i].uNumConstants;
+        }
+
+        if (bPixelStage)
+        {
+            m_deviceContext1->PSSetConstantBuffers1(uStartSlot, uNumBuffers, apBuffers, auFirstConstants, auNumConstants);
+        }
+        else
+        {
+            m_deviceContext1->VSSetConstantBuffers1(uStartSlot, uNumBuffers, apBuffers, auFirstConstants, auNumConstants);
+        }
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   D3D11RenderContext::copyConstantBufferRanges
+      Summary:  Binds constant buffer ranges to a shader stage without
+                offsets. Each range is copied from the CPU copy of its
+                buffer into the buffer of its slot, mapped with a
+                discard so the driver renames it for every draw
+      Args:     BOOL bPixelStage
+                  TRUE for the pixel shader, FALSE for the vertex
+                  shader
+                UINT uStartSlot
+                  First constant buffer slot
+                UINT uNumBuffers
+                  Number of ranges
+                const ConstantBufferRange* aRanges
+                  Ranges to bind, of buffers with a CPU copy
+      Modifies: [m_aaSlotConstantBuffers].
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    void D3D11RenderContext::copyConstantBufferRanges(_In_ BOOL bPixelStage, _In_ UINT uStartSlot, _In_ UINT uNumBuffers, _In_reads_(uNumBuffers) const ConstantBufferRange* aRanges)
+    {
+        ID3D11Buffer* apBuffers[MAX_CONSTANT_BUFFERS] = {};
+        for (UINT i = 0u; i < uNumBuffers; ++i)
+        {
+            const auto copy = m_pConstantBufferCopies->aCopies.find(aRanges[i].buffer);
+            assert(copy != m_pConstantBufferCopies->aCopies.end());
+            assert((aRanges[i].uFirstConstant + aRanges[i].uNumConstants) * CONSTANT_SIZE <= copy->second.size());
+
+            // Slot buffers hold the largest range a shader can bind
+            ComPtr<ID3D11Buffer>& slotBuffer = m_aaSlotConstantBuffers[bPixelStage ? 1u : 0u][uStartSlot + i];
+            if (!slotBuffer)
+            {
+                ComPtr<ID3D11Device> device;
+                m_deviceContext->GetDevice(device.GetAddressOf());
+                const D3D11_BUFFER_DESC bd =
+                {
+                    .ByteWidth = D3D11_REQ_CONSTANT_BUFFER_ELEMENT_COUNT * CONSTANT_SIZE,
+                    .Usage = D3D11_USAGE_DYNAMIC,
+                    .BindFlags = D3D11_BIND_CONSTANT_BUFFER,
+                    .CPUAccessFlags = D3D11_CPU_ACCESS_WRITE
+                };
+                if (FAILED(device->CreateBuffer(&bd, nullptr, slotBuffer.GetAddressOf())))
+                {
+                    continue;
+                }
+            }
+
+            D3D11_MAPPED_SUBRESOURCE mappedSubresource = {};
+            if (FAILED(m_deviceContext->Map(slotBuffer.Get(), 0u, D3D11_MAP_WRITE_DISCARD, 0u, &mappedSubresource)))
+            {
+                continue;
+            }
+            std::memcpy(mappedSubresource.pData, copy->second.data() + aRanges[i].uFirstConstant * CONSTANT_SIZE,
+                aRanges[i].uNumConstants * CONSTANT_SIZE);
+            m_deviceContext->Unmap(slotBuffer.Get(), 0u);
+            apBuffers[i] = slotBuffer.Get();
+        }
+
+        if (bPixelStage)
+        {
+            m_deviceContext->PSSetConstantBuffers(uStartSlot, uNumBuffers, apBuffers);
+        }
+        else
+        {
+            m_deviceContext->VSSetConstantBuffers(uStartSlot, uNumBuffers, apBuffers);
+        }
+    }
+}
@@ -0,0 +1,162 @@
+﻿/*+===================================================================
+  File:      D3D11RENDERCONTEXT.H
+
+  Summary:   D3D11RenderContext header file contains declarations of
+             the D3D11RenderContext class, the render context that
+             forwards recorded commands to a Direct3D 11 device
+             context, and of the ConstantBufferCopies struct.
+
+  Classes: D3D11RenderContext
+
+  © 2022 Kyung Hee University
+===================================================================+*/
+#pragma once
+
+#include "Common.h"
+
+#include <deque>
+
+#include "Renderer/RenderContext.h"
+
+namespace library
+{
+    /*S+S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S
+      Struct:   ConstantBufferCopies
+
+      Summary:  CPU copies of the dynamic constant buffers bound as
+                ranges on a device that cannot bind constant buffer
+                offsets. Mapping such a buffer writes its copy, binding
+                a range uploads the range from the copy. Buffers are
+                added between passes only, the contexts recording a
+                pass just read the copies
+    S---S---S---S---S---S---S---S---S---S---S---S---S---S---S---S---S-S*/
+    struct ConstantBufferCopies
+    {
+        std::unordered_map<RenderHandle, std::vector<BYTE>> aCopies;
+    };
+
+    /*C+C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C
+      Class:    D3D11RenderContext
+
+      Summary:  Direct3D 11 back end of RenderContext. Handles are raw
+                Direct3D interface pointers owned by the renderables.
+                Wrapping a deferred context records a command list
+                that the immediate context plays back. Constant buffer
+                ranges are bound with the Direct3D 11.1 offsets, or
+                copied into a buffer of their slot with a discard map
+                at every bind where offsets are missing. Fences are
+                event queries, timestamps are timestamp queries
+                bracketed by a disjoint query per set
+
+      Methods:  GetDeviceContext
+                  Returns the wrapped device context
+                CopyConstantBufferRanges
+                  Binds ranges by copying them from CPU copies
+                D3D11RenderContext
+                  Constructor.
+                ~D3D11RenderContext
+                  Destructor.
+    C---C---C---C---C---C---C---C---C---C---C---C---C---C---C---C---C-C*/
+    class D3D11RenderContext final : public RenderContext
+    {
+    public:
+        D3D11RenderContext() = delete;
+        D3D11RenderContext(_In_ ID3D11DeviceContext* pDeviceContext);
+        D3D11RenderContext(const D3D11RenderContext& other) = delete;
+        D3D11RenderContext(D3D11RenderContext&& other) = delete;
+        D3D11RenderContext& operator=(const D3D11RenderContext& other) = delete;
+        D3D11RenderContext& operator=(D3D11RenderContext&& other) = delete;
+        ~D3D11RenderContext() override = default;
+
+        ComPtr<ID3D11DeviceContext>& GetDeviceContext();
+        void CopyConstantBufferRanges(_In_ ConstantBufferCopies* pCopies);
+
+    protected:
+        void clearRenderTarget(_In_ RenderHandle renderTargetView, _In_ const FLOAT aColor[4]) override;
+        void clearDepthStencil(_In_ RenderHandle depthStencilView, _In_ FLOAT depth) override;
+        void setRenderTargets(_In_ UINT uNumViews, _In_reads_(uNumViews) const RenderHandle* aRenderTargetViews, _In_opt_ RenderHandle depthStencilView) override;
+        void setViewport(_In_ FLOAT width, _In_ FLOAT height) override;
+        void setPrimitiveTopology(_In_ ePrimitiveTopology topology) override;
+        void setVertexBuffers(_In_ UINT uStartSlot, _In_ UINT uNumBuffers, _In_reads_(uNumBuffers) const RenderHandle* aBuffers, _In_reads_(uNumBuffers) const UINT* aStrides, _In_reads_(uNumBuffers) const UINT* aOffsets) override;
+        void setIndexBuffer(_In_ RenderHandle indexBuffer, _In_ eIndexFormat format, _In_ UINT uOffset) override;
+        void setInputLayout(_In_ RenderHandle inputLayout) override;
+        void setVertexShader(_In_ RenderHandle vertexShader) override;
+        void setPixelShader(_In_ RenderHandle pixelShader) override;
+        void setVertexConstantBuffers(_In_ UINT uStartSlot, _In_ UINT uNumBuffers, _In_reads_(uNumBuffers) const RenderHandle* aBuffers) override;
+        void setPixelConstantBuffers(_In_ UINT uStartSlot, _In_ UINT uNumBuffers, _In_reads_(uNumBuffers) const RenderHandle* aBuffers) override;
+        void setVertexConstantBufferRanges(_In_ UINT uStartSlot, _In_ UINT uNumBuffers, _In_reads_(uNumBuffers) const ConstantBufferRange* aRanges) override;
+        void setPixelConstantBufferRanges(_In_ UINT uStartSlot, _In_ UINT uNumBuffers, _In_reads_(uNumBuffers) const ConstantBufferRange* aRanges) override;
+        void setPixelShaderResources(_In_ UINT uStartSlot, _In_ UINT uNumViews, _In_reads_(uNumViews) const RenderHandle* aViews) override;
+        void setPixelSamplers(_In_ UINT uStartSlot, _In_ UINT uNumSamplers, _In_reads_(uNumSamplers) const RenderHandle* aSamplers) override;
+        void updateConstantBuffer(_In_ RenderHandle buffer, _In_reads_bytes_(uDataSize) const void* pData, _In_ UINT uDataSize) override;
+        void* mapBuffer(_In_ RenderHandle buffer, _In_ eMapMode mode, _In_ UINT uByteWidth) override;
+        void unmapBuffer(_In_ RenderHandle buffer) override;
+        void copySubresource(_In_ RenderHandle destination, _In_ UINT uDestinationSubresource, _In_ RenderHandle source, _In_ UINT uSourceSubresource) override;
+        void drawIndexed(_In_ UINT uIndexCount, _In_ UINT uStartIndexLocation, _In_ INT iBaseVertexLocation) override;
+        void drawIndexedInstanced(_In_ UINT uIndexCountPerInstance, _In_ UINT uInstanceCount, _In_ UINT uStartIndexLocation, _In_ INT iBaseVertexLocation, _In_ UINT uStartInstanceLocation) override;
+        HRESULT finishCommandList() override;
+        HRESULT executeCommandList(_In_ RenderContext& deferredContext) override;
+        void signalFence(_In_ UINT64 uFenceValue) override;
+        UINT64 getCompletedFenceValue() override;
+        HRESULT createTimestampQueries(_In_ UINT uNumQuerySets, _In_ UINT uNumTimestamps) override;
+        void beginTimestampQueries(_In_ UINT uQuerySet) override;
+        void writeTimestamp(_In_ UINT uQuerySet, _In_ UINT uTimestamp) override;
+        void endTimestampQueries(_In_ UINT uQuerySet) override;
+        BOOL getTimestampQueryData(_In_ UINT uQuerySet, _In_ UINT uNumTimestamps, _Out_writes_(uNumTimestamps) UINT64* auTimestamps, _Out_ UINT64* puFrequency) override;
+
+    private:
+        /*S+S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S
+          Struct:   PendingFence
+
+          Summary:  Fence value and the event query issued for it
+        S---S---S---S---S---S---S---S---S---S---S---S---S---S---S---S---S-S*/
+        struct PendingFence
+        {
+            UINT64 uValue;
+            ComPtr<ID3D11Query> query;
+        };
+
+        /*S+S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S
+          Struct:   TimestampQuerySet
+
+          Summary:  Timestamp queries of a set and the disjoint query
+                    that tells their frequency
+        S---S---S---S---S---S---S---S---S---S---S---S---S---S---S---S---S-S*/
+        struct TimestampQuerySet
+        {
+            ComPtr<ID3D11Query> disjoint;
+            std::vector<ComPtr<ID3D11Query>> aTimestamps;
+        };
+
+        template <class T>
+        static T* fromHandle(_In_ RenderHandle handle);
+
+        void setConstantBufferRanges(_In_ BOOL bPixelStage, _In_ UINT uStartSlot, _In_ UINT uNumBuffers, _In_reads_(uNumBuffers) const ConstantBufferRange* aRanges);
+        void copyConstantBufferRanges(_In_ BOOL bPixelStage, _In_ UINT uStartSlot, _In_ UINT uNumBuffers, _In_reads_(uNumBuffers) const ConstantBufferRange* aRanges);
+
+        ComPtr<ID3D11DeviceContext> m_deviceContext;
+        ComPtr<ID3D11DeviceContext1> m_deviceContext1;
+        ComPtr<ID3D11CommandList> m_commandList;
+        std::deque<PendingFence> m_aPendingFences;
+        std::vector<ComPtr<ID3D11Query>> m_aFreeQueries;
+        UINT64 m_uCompletedFenceValue;
+        std::vector<TimestampQuerySet> m_aTimestampQuerySets;
+        ConstantBufferCopies* m_pConstantBufferCopies;
+        ComPtr<ID3D11Buffer> m_aaSlotConstantBuffers[2][MAX_CONSTANT_BUFFERS];
+    };
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   D3D11RenderContext::fromHandle
+      Summary:  Converts a render handle back into the Direct3D
+                interface pointer it was made from
+      Args:     RenderHandle handle
+                  The handle
+      Returns:  T*
+                  The interface pointer
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    template <class T>
+    T* D3D11RenderContext::fromHandle(_In_ RenderHandle handle)
+    {
+        return static_cast<T*>(const_cast<void*>(handle));
+    }
+}
@@ -2,10 +2,10 @@
 
 #include "Common.h"
 
+#include "Shader/ShaderConstants.h"
+
 namespace library
 {
-#define NUM_LIGHTS (2)
-#define MAX_NUM_BONES (256)
 #define MAX_NUM_BONES_PER_VERTEX (16)
 
 	struct SimpleVertex
@@ -15,9 +15,11 @@ namespace library
 		XMFLOAT3 Normal;
 	};
 
+	// Material indexes the voxel materials, one per voxel of the scene
 	struct InstanceData
 	{
 		XMMATRIX Transformation;
+		UINT Material;
 	};
 
 	struct AnimationData
@@ -32,12 +34,21 @@ namespace library
 		XMFLOAT3 Bitangent;
 	};
 
+	// Texture holds where the color is sampled from, VOXEL_TEXTURE_NONE,
+	// _ATLAS or _BOUND, then the atlas layer. ScaleOffset maps the
+	// texture coordinates of a voxel to its region of the layer
+	struct VoxelMaterialData
+	{
+		XMFLOAT4 Color;
+		XMFLOAT4 ScaleOffset;
+		XMUINT4 Texture;
+	};
+
+	// AttenuationDistance holds the distance, the range, and their squares
 	struct PointLightData
 	{
 		XMFLOAT4 Position;
 		XMFLOAT4 Color;
-		XMMATRIX View;
-		XMMATRIX Projection;
 		XMFLOAT4 AttenuationDistance;
 	};
 
@@ -56,7 +67,6 @@ namespace library
 	{
 		XMMATRIX World;
 		XMFLOAT4 OutputColor;
-		BOOL HasNormalMap;
 	};
 
 	struct CBSkinning
@@ -64,16 +74,32 @@ namespace library
 		XMMATRIX BoneTransforms[MAX_NUM_BONES];
 	};
 
+	// ClusterScale maps a pixel to its tile and a log view depth to its
+	// slice, ClusterCounts holds the clusters along x, y, z and the lights
 	struct CBLights
 	{
-		PointLightData PointLights[NUM_LIGHTS];
+		XMMATRIX LightView;
+		XMMATRIX LightProjection;
+		XMFLOAT4 ClusterScale;
+		XMUINT4 ClusterCounts;
 	};
 
 	struct CBShadowMatrix
 	{
 		XMMATRIX World;
-		XMMATRIX View;
-		XMMATRIX Projection;
-		BOOL IsVoxel;
+		XMMATRIX ViewProjection;
+	};
+
+	// ShadowLights holds the light casting the cascades and the lights
+	// casting cube shadows, NO_SHADOW_LIGHT for none. ShadowParameters
+	// holds the depth biases of the cascades and the cubes, and the size
+	// of a shadow map texel
+	struct CBShadows
+	{
+		XMMATRIX CascadeViewProjections[NUM_SHADOW_CASCADES];
+		XMMATRIX CubeViewProjections[MAX_NUM_CUBE_SHADOWS * 6];
+		XMFLOAT4 CascadeSplits;
+		XMUINT4 ShadowLights;
+		XMFLOAT4 ShadowParameters;
 	};
 }
\ No newline at end of file
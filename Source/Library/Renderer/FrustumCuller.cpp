@@ -0,0 +1,473 @@
+#include "Renderer/FrustumCuller.h"
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__SSE__)
+#define FRUSTUMCULLER_SSE
+#include <xmmintrin.h>
+#endif
+
+namespace library
+{
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   BoundingBoxArray::BoundingBoxArray
+      Summary:  Constructor
+      Modifies: [m_aCenters, m_aExtents, m_uNumBoxes].
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    BoundingBoxArray::BoundingBoxArray()
+        : m_aCenters()
+        , m_aExtents()
+        , m_uNumBoxes(0u)
+    {
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   BoundingBoxArray::Clear
+      Summary:  Removes all boxes, keeping the storage
+      Modifies: [m_aCenters, m_aExtents, m_uNumBoxes].
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    void BoundingBoxArray::Clear()
+    {
+        for (UINT uAxis = 0u; uAxis < 3u; ++uAxis)
+        {
+            m_aCenters[uAxis].clear();
+            m_aExtents[uAxis].clear();
+        }
+        m_uNumBoxes = 0u;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   BoundingBoxArray::Reserve
+      Summary:  Reserves storage for a number of boxes
+      Args:     UINT uNumBoxes
+                  Number of boxes
+      Modifies: [m_aCenters, m_aExtents].
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    void BoundingBoxArray::Reserve(_In_ UINT uNumBoxes)
+    {
+        const size_t uPadded = (uNumBoxes + SIMD_WIDTH - 1u) / SIMD_WIDTH * SIMD_WIDTH;
+        for (UINT uAxis = 0u; uAxis < 3u; ++uAxis)
+        {
+            m_aCenters[uAxis].reserve(uPadded);
+            m_aExtents[uAxis].reserve(uPadded);
+        }
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   BoundingBoxArray::Add
+      Summary:  Appends a box. A new SIMD group is zero filled so that
+                the padding is always a valid, degenerate box
+      Args:     const AxisAlignedBox& box
+                  Box to append
+      Modifies: [m_aCenters, m_aExtents, m_uNumBoxes].
+      Returns:  UINT
+                  Index of the box
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    UINT BoundingBoxArray::Add(_In_ const AxisAlignedBox& box)
+    {
+        if (m_uNumBoxes % SIMD_WIDTH == 0u)
+        {
+            for (UINT uAxis = 0u; uAxis < 3u; ++uAxis)
+            {
+                m_aCenters[uAxis].resize(m_uNumBoxes + SIMD_WIDTH, 0.0f);
+                m_aExtents[uAxis].resize(m_uNumBoxes + SIMD_WIDTH, 0.0f);
+            }
+        }
+
+        for (UINT uAxis = 0u; uAxis < 3u; ++uAxis)
+        {
+            m_aCenters[uAxis][m_uNumBoxes] = box.Center[uAxis];
+            m_aExtents[uAxis][m_uNumBoxes] = box.Extents[uAxis];
+        }
+
+        return m_uNumBoxes++;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   BoundingBoxArray::GetNumBoxes
+      Summary:  Returns the number of boxes
+      Returns:  UINT
+                  Number of boxes, padding excluded
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    UINT BoundingBoxArray::GetNumBoxes() const
+    {
+        return m_uNumBoxes;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   BoundingBoxArray::GetBox
+      Summary:  Returns a box in array of structures form
+      Args:     UINT uIndex
+                  Index of the box
+      Returns:  AxisAlignedBox
+                  The box
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    AxisAlignedBox BoundingBoxArray::GetBox(_In_ UINT uIndex) const
+    {
+        assert(uIndex < m_uNumBoxes);
+
+        AxisAlignedBox box = {};
+        for (UINT uAxis = 0u; uAxis < 3u; ++uAxis)
+        {
+            box.Center[uAxis] = m_aCenters[uAxis][uIndex];
+            box.Extents[uAxis] = m_aExtents[uAxis][uIndex];
+        }
+
+        return box;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   BoundingBoxArray::GetCenters
+      Summary:  Returns the centers along an axis
+      Args:     UINT uAxis
+                  0, 1 or 2 for x, y or z
+      Returns:  const FLOAT*
+                  Padded array of centers
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    const FLOAT* BoundingBoxArray::GetCenters(_In_ UINT uAxis) const
+    {
+        return m_aCenters[uAxis].data();
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   BoundingBoxArray::GetExtents
+      Summary:  Returns the half extents along an axis
+      Args:     UINT uAxis
+                  0, 1 or 2 for x, y or z
+      Returns:  const FLOAT*
+                  Padded array of half extents
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    const FLOAT* BoundingBoxArray::GetExtents(_In_ UINT uAxis) const
+    {
+        return m_aExtents[uAxis].data();
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   FrustumCuller::FrustumCuller
+      Summary:  Constructor. Every box is visible until a view
+                projection is set
+      Modifies: [m_aPlanes].
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    FrustumCuller::FrustumCuller()
+        : m_aPlanes()
+    {
+        for (UINT i = 0u; i < NUM_PLANES; ++i)
+        {
+            m_aPlanes[i][3] = FLT_MAX;
+        }
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   FrustumCuller::SetViewProjection
+      Summary:  Extracts and normalizes the frustum planes of a row
+                major view projection matrix that transforms row
+                vectors, with a [0, 1] clip space depth range. The
+                plane normals point into the frustum
+      Args:     const FLOAT* aViewProjection
+                  16 floats of the view projection matrix
+      Modifies: [m_aPlanes].
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    void FrustumCuller::SetViewProjection(_In_reads_(16) const FLOAT* aViewProjection)
+    {
+        auto column = [aViewProjection](UINT uColumn, UINT uRow)
+        {
+            return aViewProjection[uRow * 4u + uColumn];
+        };
+
+        for (UINT uRow = 0u; uRow < 4u; ++uRow)
+        {
+            m_aPlanes[0][uRow] = column(3u, uRow) + column(0u, uRow);  // left
+            m_aPlanes[1][uRow] = column(3u, uRow) - column(0u, uRow);  // right
+            m_aPlanes[2][uRow] = column(3u, uRow) + column(1u, uRow);  // bottom
+            m_aPlanes[3][uRow] = column(3u, uRow) - column(1u, uRow);  // top
+            m_aPlanes[4][uRow] = column(2u, uRow);                     // near
+            m_aPlanes[5][uRow] = column(3u, uRow) - column(2u, uRow);  // far
+        }
+
+        for (UINT i = 0u; i < NUM_PLANES; ++i)
+        {
+            const FLOAT length = std::sqrt(m_aPlanes[i][0] * m_aPlanes[i][0] + m_aPlanes[i][1] * m_aPlanes[i][1] + m_aPlanes[i][2] * m_aPlanes[i][2]);
+            if (length > 0.0f)
+            {
+                for (UINT j = 0u; j < 4u; ++j)
+                {
+                    m_aPlanes[i][j] /= length;
+                }
+            }
+        }
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   FrustumCuller::Cull
+      Summary:  Tests a batch of boxes against the frustum. A box is
+                culled when it lies entirely behind one of the planes,
+                i.e. when the signed distance of its center plus its
+                projected radius is negative
+      Args:     const BoundingBoxArray& boxes
+                  Boxes to test
+                BYTE* aVisible
+                  Receives 1 for each visible box, 0 otherwise
+      Returns:  UINT
+                  Number of visible boxes
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    UINT FrustumCuller::Cull(_In_ const BoundingBoxArray& boxes, _Out_writes_(boxes.GetNumBoxes()) BYTE* aVisible) const
+    {
+        return Cull(boxes, 0u, boxes.GetNumBoxes(), aVisible);
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   FrustumCuller::Cull
+      Summary:  Tests a range of boxes against the frustum, so that a
+                large batch can be split across threads
+      Args:     const BoundingBoxArray& boxes
+                  Boxes to test
+                UINT uFirstBox
+                  Index of the first box of the range, a multiple of
+                  the SIMD width
+                UINT uNumBoxes
+                  Number of boxes of the range
+                BYTE* aVisible
+                  Receives 1 for each visible box of the range, 0
+                  otherwise, starting at the first box of the range
+      Returns:  UINT
+                  Number of visible boxes of the range
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    UINT FrustumCuller::Cull(_In_ const BoundingBoxArray& boxes, _In_ UINT uFirstBox, _In_ UINT uNumBoxes, _Out_writes_(uNumBoxes) BYTE* aVisible) const
+    {
+        assert(uFirstBox % BoundingBoxArray::SIMD_WIDTH == 0u);
+        assert(uFirstBox + uNumBoxes <= boxes.GetNumBoxes());
+
+#ifdef FRUSTUMCULLER_SSE
+        const FLOAT* aCenterX = boxes.GetCenters(0u) + uFirstBox;
+        const FLOAT* aCenterY = boxes.GetCenters(1u) + uFirstBox;
+        const FLOAT* aCenterZ = boxes.GetCenters(2u) + uFirstBox;
+        const FLOAT* aExtentX = boxes.GetExtents(0u) + uFirstBox;
+        const FLOAT* aExtentY = boxes.GetExtents(1u) + uFirstBox;
+        const FLOAT* aExtentZ = boxes.GetExtents(2u) + uFirstBox;
+
+        UINT uNumVisible = 0u;
+        __m128 aPlaneX[NUM_PLANES];
+        __m128 aPlaneY[NUM_PLANES];
+        __m128 aPlaneZ[NUM_PLANES];
+        __m128 aPlaneW[NUM_PLANES];
+        __m128 aAbsPlaneX[NUM_PLANES];
+        __m128 aAbsPlaneY[NUM_PLANES];
+        __m128 aAbsPlaneZ[NUM_PLANES];
+        for (UINT i = 0u; i < NUM_PLANES; ++i)
+        {
+            aPlaneX[i] = _mm_set1_ps(m_aPlanes[i][0]);
+            aPlaneY[i] = _mm_set1_ps(m_aPlanes[i][1]);
+            aPlaneZ[i] = _mm_set1_ps(m_aPlanes[i][2]);
+            aPlaneW[i] = _mm_set1_ps(m_aPlanes[i][3]);
+            aAbsPlaneX[i] = _mm_set1_ps(std::fabs(m_aPlanes[i][0]));
+            aAbsPlaneY[i] = _mm_set1_ps(std::fabs(m_aPlanes[i][1]));
+            aAbsPlaneZ[i] = _mm_set1_ps(std::fabs(m_aPlanes[i][2]));
+        }
+
+        const __m128 zero = _mm_setzero_ps();
+        for (UINT uBase = 0u; uBase < uNumBoxes; uBase += BoundingBoxArray::SIMD_WIDTH)
+        {
+            const __m128 centerX = _mm_loadu_ps(aCenterX + uBase);
+            const __m128 centerY = _mm_loadu_ps(aCenterY + uBase);
+            const __m128 centerZ = _mm_loadu_ps(aCenterZ + uBase);
+            const __m128 extentX = _mm_loadu_ps(aExtentX + uBase);
+            const __m128 extentY = _mm_loadu_ps(aExtentY + uBase);
+            const __m128 extentZ = _mm_loadu_ps(aExtentZ + uBase);
+
+            __m128 outside = _mm_setzero_ps();
+            for (UINT i = 0u; i < NUM_PLANES; ++i)
+            {
+                __m128 distance = _mm_add_ps(_mm_mul_ps(centerX, aPlaneX[i]), aPlaneW[i]);
+                distance = _mm_add_ps(distance, _mm_mul_ps(centerY, aPlaneY[i]));
+                distance = _mm_add_ps(distance, _mm_mul_ps(centerZ, aPlaneZ[i]));
+
+                __m128 radius = _mm_mul_ps(extentX, aAbsPlaneX[i]);
+                radius = _mm_add_ps(radius, _mm_mul_ps(extentY, aAbsPlaneY[i]));
+                radius = _mm_add_ps(radius, _mm_mul_ps(extentZ, aAbsPlaneZ[i]));
+
+                outside = _mm_or_ps(outside, _mm_cmplt_ps(_mm_add_ps(distance, radius), zero));
+            }
+
+            const INT mask = _mm_movemask_ps(outside);
+            const UINT uCount = std::min(BoundingBoxArray::SIMD_WIDTH, uNumBoxes - uBase);
+            for (UINT j = 0u; j < uCount; ++j)
+            {
+                const BYTE visible = (mask & (1 << j)) ? 0u : 1u;
+                aVisible[uBase + j] = visible;
+                uNumVisible += visible;
+            }
+        }
+
+        return uNumVisible;
+#else
+        return CullScalar(boxes, uFirstBox, uNumBoxes, aVisible);
+#endif
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   FrustumCuller::CullScalar
+      Summary:  Tests a range of boxes against the frustum one at a
+                time. Cull falls back to it without SSE, and gives the
+                same flags with it
+      Args:     const BoundingBoxArray& boxes
+                  Boxes to test
+                UINT uFirstBox
+                  Index of the first box of the range
+                UINT uNumBoxes
+                  Number of boxes of the range
+                BYTE* aVisible
+                  Receives 1 for each visible box of the range, 0
+                  otherwise, starting at the first box of the range
+      Returns:  UINT
+                  Number of visible boxes of the range
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    UINT FrustumCuller::CullScalar(_In_ const BoundingBoxArray& boxes, _In_ UINT uFirstBox, _In_ UINT uNumBoxes, _Out_writes_(uNumBoxes) BYTE* aVisible) const
+    {
+        assert(uFirstBox + uNumBoxes <= boxes.GetNumBoxes());
+
+        const FLOAT* aCenterX = boxes.GetCenters(0u) + uFirstBox;
+        const FLOAT* aCenterY = boxes.GetCenters(1u) + uFirstBox;
+        const FLOAT* aCenterZ = boxes.GetCenters(2u) + uFirstBox;
+        const FLOAT* aExtentX = boxes.GetExtents(0u) + uFirstBox;
+        const FLOAT* aExtentY = boxes.GetExtents(1u) + uFirstBox;
+        const FLOAT* aExtentZ = boxes.GetExtents(2u) + uFirstBox;
+
+        UINT uNumVisible = 0u;
+        for (UINT uIndex = 0u; uIndex < uNumBoxes; ++uIndex)
+        {
+            const AxisAlignedBox box =
+            {
+                .Center = { aCenterX[uIndex], aCenterY[uIndex], aCenterZ[uIndex] },
+                .Extents = { aExtentX[uIndex], aExtentY[uIndex], aExtentZ[uIndex] },
+            };
+            const BYTE visible = IsVisible(box) ? 1u : 0u;
+            aVisible[uIndex] = visible;
+            uNumVisible += visible;
+        }
+
+        return uNumVisible;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   FrustumCuller::IsVisible
+      Summary:  Tests a single box against the frustum. The terms are
+                summed in the order of the SSE path of Cull, so that
+                both round alike on boxes touching a plane
+      Args:     const AxisAlignedBox& box
+                  Box to test
+      Returns:  BOOL
+                  TRUE when the box is not entirely outside
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    BOOL FrustumCuller::IsVisible(_In_ const AxisAlignedBox& box) const
+    {
+        for (UINT i = 0u; i < NUM_PLANES; ++i)
+        {
+            const FLOAT distance = box.Center[0] * m_aPlanes[i][0] + m_aPlanes[i][3] + box.Center[1] * m_aPlanes[i][1] + box.Center[2] * m_aPlanes[i][2];
+            const FLOAT radius = std::fabs(m_aPlanes[i][0]) * box.Extents[0] + std::fabs(m_aPlanes[i][1]) * box.Extents[1] + std::fabs(m_aPlanes[i][2]) * box.Extents[2];
+            if (distance + radius < 0.0f)
+            {
+                return FALSE;
+            }
+        }
+
+        return TRUE;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   FrustumCuller::ComputeBox
+      Summary:  Returns the box that bounds a set of points
+      Args:     const FLOAT* pPositions
+                  x of the first point, followed by y and z
+                UINT uNumPoints
+                  Number of points
+                UINT uStride
+                  Distance in bytes between two points
+      Returns:  AxisAlignedBox
+                  Bounding box, empty at the origin without points
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    AxisAlignedBox FrustumCuller::ComputeBox(_In_reads_bytes_(uNumPoints * uStride) const FLOAT* pPositions, _In_ UINT uNumPoints, _In_ UINT uStride)
+    {
+        AxisAlignedBox box = {};
+        if (uNumPoints == 0u)
+        {
+            return box;
+        }
+
+        FLOAT aMin[3] = { FLT_MAX, FLT_MAX, FLT_MAX };
+        FLOAT aMax[3] = { -FLT_MAX, -FLT_MAX, -FLT_MAX };
+
+        const BYTE* pPosition = reinterpret_cast<const BYTE*>(pPositions);
+        for (UINT i = 0u; i < uNumPoints; ++i, pPosition += uStride)
+        {
+            const FLOAT* aPoint = reinterpret_cast<const FLOAT*>(pPosition);
+            for (UINT uAxis = 0u; uAxis < 3u; ++uAxis)
+            {
+                aMin[uAxis] = std::min(aMin[uAxis], aPoint[uAxis]);
+                aMax[uAxis] = std::max(aMax[uAxis], aPoint[uAxis]);
+            }
+        }
+
+        for (UINT uAxis = 0u; uAxis < 3u; ++uAxis)
+        {
+            box.Center[uAxis] = (aMin[uAxis] + aMax[uAxis]) * 0.5f;
+            box.Extents[uAxis] = (aMax[uAxis] - aMin[uAxis]) * 0.5f;
+        }
+
+        return box;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   FrustumCuller::MergeBoxes
+      Summary:  Returns the box that bounds two boxes
+      Args:     const AxisAlignedBox& a
+                  First box
+                const AxisAlignedBox& b
+                  Second box
+      Returns:  AxisAlignedBox
+                  Union of the boxes
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    AxisAlignedBox FrustumCuller::MergeBoxes(_In_ const AxisAlignedBox& a, _In_ const AxisAlignedBox& b)
+    {
+        AxisAlignedBox box = {};
+        for (UINT uAxis = 0u; uAxis < 3u; ++uAxis)
+        {
+            const FLOAT lower = std::min(a.Center[uAxis] - a.Extents[uAxis], b.Center[uAxis] - b.Extents[uAxis]);
+            const FLOAT upper = std::max(a.Center[uAxis] + a.Extents[uAxis], b.Center[uAxis] + b.Extents[uAxis]);
+            box.Center[uAxis] = (lower + upper) * 0.5f;
+            box.Extents[uAxis] = (upper - lower) * 0.5f;
+        }
+
+        return box;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   FrustumCuller::TransformBox
+      Summary:  Returns the axis-aligned box that bounds a box
+                transformed by a row major matrix that transforms row
+                vectors. The center is transformed as a point, the
+                extents by the absolute value of the linear part
+      Args:     const AxisAlignedBox& box
+                  Box to transform
+                const FLOAT* aMatrix
+                  16 floats of the transformation
+      Returns:  AxisAlignedBox
+                  Transformed box
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    AxisAlignedBox FrustumCuller::TransformBox(_In_ const AxisAlignedBox& box, _In_reads_(16) const FLOAT* aMatrix)
+    {
+        AxisAlignedBox transformed = {};
+        for (UINT uColumn = 0u; uColumn < 3u; ++uColumn)
+        {
+            transformed.Center[uColumn] = aMatrix[12u + uColumn];
+            for (UINT uRow = 0u; uRow < 3u; ++uRow)
+            {
+                transformed.Center[uColumn] += box.Center[uRow] * aMatrix[uRow * 4u + uColumn];
+                transformed.Extents[uColumn] += box.Extents[uRow] * std::fabs(aMatrix[uRow * 4u + uColumn]);
+            }
+        }
+
+        return transformed;
+    }
+}
@@ -0,0 +1,164 @@
+﻿/*+===================================================================
+  File:      FRUSTUMCULLER.H
+
+  Summary:   FrustumCuller header file contains declarations of the
+             bounding volume types and the FrustumCuller class that
+             tests batches of axis-aligned boxes against the planes of
+             a view frustum.
+
+  Classes: BoundingBoxArray, FrustumCuller
+
+  © 2022 Kyung Hee University
+===================================================================+*/
+#pragma once
+
+#include "Common.h"
+
+namespace library
+{
+    /*S+S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S
+      Struct:   AxisAlignedBox
+
+      Summary:  Axis-aligned bounding box stored as center and half
+                extents
+    S---S---S---S---S---S---S---S---S---S---S---S---S---S---S---S---S-S*/
+    struct AxisAlignedBox
+    {
+        FLOAT Center[3];
+        FLOAT Extents[3];
+    };
+
+    /*S+S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S
+      Struct:   CullingStatistics
+
+      Summary:  Counters of a culled render pass. Culled counts what
+                lies outside of the frustum, occluded what lies inside
+                but behind the occluders. Tested instances are those of
+                the voxels inside the frustum, uploaded ones those
+                written into the instance ring
+    S---S---S---S---S---S---S---S---S---S---S---S---S---S---S---S---S-S*/
+    struct CullingStatistics
+    {
+        UINT uNumVisibleObjects;
+        UINT uNumCulledObjects;
+        UINT uNumOccludedObjects;
+        UINT uNumVisibleMeshes;
+        UINT uNumCulledMeshes;
+        UINT uNumOccludedMeshes;
+        UINT uNumVisibleInstances;
+        UINT uNumCulledInstances;
+        UINT uNumOccludedInstances;
+        UINT uNumTestedInstances;
+        UINT uNumUploadedInstances;
+        UINT uNumOccluderTriangles;
+    };
+
+    /*C+C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C
+      Class:    BoundingBoxArray
+
+      Summary:  Axis-aligned boxes stored as structure of arrays, one
+                array per component, padded to a multiple of the SIMD
+                width so that the culler never reads past the end
+
+      Methods:  Clear
+                  Removes all boxes
+                Reserve
+                  Reserves storage for a number of boxes
+                Add
+                  Appends a box and returns its index
+                GetNumBoxes
+                  Returns the number of boxes
+                GetBox
+                  Returns a box in array of structures form
+                GetCenters
+                  Returns the centers along an axis
+                GetExtents
+                  Returns the half extents along an axis
+                BoundingBoxArray
+                  Constructor.
+                ~BoundingBoxArray
+                  Destructor.
+    C---C---C---C---C---C---C---C---C---C---C---C---C---C---C---C---C-C*/
+    class BoundingBoxArray final
+    {
+    public:
+        static constexpr UINT SIMD_WIDTH = 4u;
+
+    public:
+        BoundingBoxArray();
+        BoundingBoxArray(const BoundingBoxArray& other) = default;
+        BoundingBoxArray(BoundingBoxArray&& other) = default;
+        BoundingBoxArray& operator=(const BoundingBoxArray& other) = default;
+        BoundingBoxArray& operator=(BoundingBoxArray&& other) = default;
+        ~BoundingBoxArray() = default;
+
+        void Clear();
+        void Reserve(_In_ UINT uNumBoxes);
+        UINT Add(_In_ const AxisAlignedBox& box);
+
+        UINT GetNumBoxes() const;
+        AxisAlignedBox GetBox(_In_ UINT uIndex) const;
+        const FLOAT* GetCenters(_In_ UINT uAxis) const;
+        const FLOAT* GetExtents(_In_ UINT uAxis) const;
+
+    private:
+        std::vector<FLOAT> m_aCenters[3];
+        std::vector<FLOAT> m_aExtents[3];
+        UINT m_uNumBoxes;
+    };
+
+    /*C+C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C
+      Class:    FrustumCuller
+
+      Summary:  Extracts the six planes of a view frustum from a view
+                projection matrix and culls boxes against them, four
+                boxes at a time with SSE when available
+
+      Methods:  SetViewProjection
+                  Extracts the frustum planes
+                Cull
+                  Tests a batch or a range of boxes, writes one
+                  visibility flag per box and returns the number of
+                  visible boxes
+                CullScalar
+                  Tests a range of boxes one at a time, without SIMD
+                IsVisible
+                  Tests a single box
+                ComputeBox
+                  Returns the box that bounds a set of points
+                MergeBoxes
+                  Returns the box that bounds two boxes
+                TransformBox
+                  Returns the box that bounds a transformed box
+                FrustumCuller
+                  Constructor.
+                ~FrustumCuller
+                  Destructor.
+    C---C---C---C---C---C---C---C---C---C---C---C---C---C---C---C---C-C*/
+    class FrustumCuller final
+    {
+    public:
+        static constexpr UINT NUM_PLANES = 6u;
+
+    public:
+        FrustumCuller();
+        FrustumCuller(const FrustumCuller& other) = default;
+        FrustumCuller(FrustumCuller&& other) = default;
+        FrustumCuller& operator=(const FrustumCuller& other) = default;
+        FrustumCuller& operator=(FrustumCuller&& other) = default;
+        ~FrustumCuller() = default;
+
+        void SetViewProjection(_In_reads_(16) const FLOAT* aViewProjection);
+        UINT Cull(_In_ const BoundingBoxArray& boxes, _Out_writes_(boxes.GetNumBoxes()) BYTE* aVisible) const;
+        UINT Cull(_In_ const BoundingBoxArray& boxes, _In_ UINT uFirstBox, _In_ UINT uNumBoxes, _Out_writes_(uNumBoxes) BYTE* aVisible) const;
+        UINT CullScalar(_In_ const BoundingBoxArray& boxes, _In_ UINT uFirstBox, _In_ UINT uNumBoxes, _Out_writes_(uNumBoxes) BYTE* aVisible) const;
+        BOOL IsVisible(_In_ const AxisAlignedBox& box) const;
+
+        static AxisAlignedBox ComputeBox(_In_reads_bytes_(uNumPoints * uStride) const FLOAT* pPositions, _In_ UINT uNumPoints, _In_ UINT uStride);
+        static AxisAlignedBox MergeBoxes(_In_ const AxisAlignedBox& a, _In_ const AxisAlignedBox& b);
+        static AxisAlignedBox TransformBox(_In_ const AxisAlignedBox& box, _In_reads_(16) const FLOAT* aMatrix);
+
+    private:
+        FLOAT m_aPlanes[NUM_PLANES][4];
+    };
+}
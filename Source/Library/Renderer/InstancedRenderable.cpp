@@ -13,7 +13,8 @@ namespace library
         :Renderable(outputColor),
         m_instanceBuffer(nullptr),
         m_aInstanceData(std::vector<InstanceData>()),
-        m_padding()
+        m_uRevision(0u),
+        m_uMaterialIndex(0u)
     {
     }
 
@@ -24,28 +25,36 @@ namespace library
                   An instance data
                 const XMFLOAT4& outputColor
                   Default color of the renderable
-      Modifies: [m_instanceBuffer, m_aInstanceData].
+      Modifies: [m_instanceBuffer, m_aInstanceData, m_uRevision,
+                  m_uMaterialIndex].
     M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
 
     InstancedRenderable::InstancedRenderable(_In_ std::vector<InstanceData>&& aInstanceData, _In_ const XMFLOAT4& outputColor)
         :Renderable(outputColor),
         m_instanceBuffer(nullptr),
         m_aInstanceData(aInstanceData),
-        m_padding()
+        m_uRevision(0u),
+        m_uMaterialIndex(0u)
     {
     }
 
     /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
       Method:   InstancedRenderable::SetInstanceData
-      Summary:  Sets the instance data
+      Summary:  Sets the instance data, a new revision of the instances
+                drawn with the material of the renderable
       Args:     std::vector<InstanceData>&& aInstanceData
                   Instance data
-      Modifies: [m_aInstanceData].
+      Modifies: [m_aInstanceData, m_uRevision].
     M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
 
     void InstancedRenderable::SetInstanceData(_In_ std::vector<InstanceData>&& aInstanceData)
     {
         m_aInstanceData = aInstanceData;
+        for (InstanceData& instanceData : m_aInstanceData)
+        {
+            instanceData.Material = m_uMaterialIndex;
+        }
+        ++m_uRevision;
     }
 
     /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
@@ -72,6 +81,76 @@ namespace library
         return m_aInstanceData.size();
     }
 
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   InstancedRenderable::GetInstanceData
+      Summary:  Returns the instance data the instance buffer was
+                created from
+      Returns:  const InstanceData*
+                  Array of GetNumInstances() instance data
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+
+    const InstanceData* InstancedRenderable::GetInstanceData() const
+    {
+        return m_aInstanceData.data();
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   InstancedRenderable::GetRevision
+      Summary:  Returns how many times the instance data was set, what
+                was drawn from older instances is stale
+      Returns:  UINT64
+                  Revision of the instance data
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+
+    UINT64 InstancedRenderable::GetRevision() const
+    {
+        return m_uRevision;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   InstancedRenderable::SetMaterialIndex
+      Summary:  Sets the material every instance is drawn with, written
+                into the instance data. The instance buffer is created
+                from it, so this is called before Initialize
+      Args:     UINT uMaterialIndex
+                  Index of the material
+      Modifies: [m_aInstanceData, m_uMaterialIndex].
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+
+    void InstancedRenderable::SetMaterialIndex(_In_ UINT uMaterialIndex)
+    {
+        m_uMaterialIndex = uMaterialIndex;
+        for (InstanceData& instanceData : m_aInstanceData)
+        {
+            instanceData.Material = uMaterialIndex;
+        }
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   InstancedRenderable::GetMaterialIndex
+      Summary:  Returns the material the instances are drawn with
+      Returns:  UINT
+                  Index of the material
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+
+    UINT InstancedRenderable::GetMaterialIndex() const
+    {
+        return m_uMaterialIndex;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   InstancedRenderable::GetShaderFeatures
+      Summary:  Returns the shader features of the renderable, which is
+                always drawn with per instance data
+      Returns:  UINT
+                  Mask of eShaderFeature
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+
+    UINT InstancedRenderable::GetShaderFeatures() const
+    {
+        return Renderable::GetShaderFeatures() | GetShaderFeatureMask(eShaderFeature::INSTANCING);
+    }
+
     /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
       Method:   InstancedRenderable::initializeInstance
       Summary:  Creates an instance buffer
@@ -86,6 +165,11 @@ namespace library
     {
         HRESULT hr = S_OK;
 
+        if (!pDevice)
+        {
+            return S_OK;
+        }
+
         D3D11_BUFFER_DESC bd =
         {
          .ByteWidth = sizeof(InstanceData) * (UINT)m_aInstanceData.size(),
@@ -24,6 +24,16 @@ namespace library
                   Returns a instance buffer
                 GetNumInstances
                   Returns the number of instance data
+                GetInstanceData
+                  Returns the instance data
+                GetRevision
+                  Returns how many times the instance data was set
+                SetMaterialIndex
+                  Sets the material every instance is drawn with
+                GetMaterialIndex
+                  Returns the material of the instances
+                GetShaderFeatures
+                  Returns the shader features, instancing included
                 initializeInstance
                   Initialize the instance buffer
                 InstancedRenderable
@@ -49,6 +59,12 @@ namespace library
 
         virtual ComPtr<ID3D11Buffer>& GetInstanceBuffer();
         virtual UINT GetNumInstances() const;
+        const InstanceData* GetInstanceData() const;
+        UINT64 GetRevision() const;
+        void SetMaterialIndex(_In_ UINT uMaterialIndex);
+        UINT GetMaterialIndex() const;
+
+        UINT GetShaderFeatures() const override;
 
         UINT GetNumVertices() const override = 0;
         UINT GetNumIndices() const override = 0;
@@ -64,6 +80,7 @@ namespace library
         std::vector<InstanceData> m_aInstanceData;
 
     private:
-        BYTE m_padding[8];
+        UINT64 m_uRevision;
+        UINT m_uMaterialIndex;
     };
 }
\ No newline at end of file
@@ -0,0 +1,321 @@
+#include "Renderer/NullRenderContext.h"
+
+#include <algorithm>
+#include <chrono>
+
+namespace library
+{
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   NullRenderContext::NullRenderContext
+      Summary:  Constructor
+      Modifies: [m_aMappedData, m_uCompletedFenceValue, m_auTimestamps,
+                  m_uNumTimestampsPerSet].
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    NullRenderContext::NullRenderContext()
+        : RenderContext()
+        , m_aMappedData()
+        , m_uCompletedFenceValue(0u)
+        , m_auTimestamps()
+        , m_uNumTimestampsPerSet(0u)
+    {
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   NullRenderContext::clearRenderTarget
+      Summary:  Discards the clear
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    void NullRenderContext::clearRenderTarget(_In_ RenderHandle, _In_ const FLOAT[4])
+    {
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   NullRenderContext::clearDepthStencil
+      Summary:  Discards the clear
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    void NullRenderContext::clearDepthStencil(_In_ RenderHandle, _In_ FLOAT)
+    {
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   NullRenderContext::setRenderTargets
+      Summary:  Discards the bind
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    void NullRenderContext::setRenderTargets(_In_ UINT, _In_reads_(uNumViews) const RenderHandle*, _In_opt_ RenderHandle)
+    {
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   NullRenderContext::setViewport
+      Summary:  Discards the viewport
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    void NullRenderContext::setViewport(_In_ FLOAT, _In_ FLOAT)
+    {
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   NullRenderContext::setPrimitiveTopology
+      Summary:  Discards the topology
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    void NullRenderContext::setPrimitiveTopology(_In_ ePrimitiveTopology)
+    {
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   NullRenderContext::setVertexBuffers
+      Summary:  Discards the bind
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    void NullRenderContext::setVertexBuffers(_In_ UINT, _In_ UINT, _In_reads_(uNumBuffers) const RenderHandle*, _In_reads_(uNumBuffers) const UINT*, _In_reads_(uNumBuffers) const UINT*)
+    {
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   NullRenderContext::setIndexBuffer
+      Summary:  Discards the bind
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    void NullRenderContext::setIndexBuffer(_In_ RenderHandle, _In_ eIndexFormat, _In_ UINT)
+    {
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   NullRenderContext::setInputLayout
+      Summary:  Discards the bind
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    void NullRenderContext::setInputLayout(_In_ RenderHandle)
+    {
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   NullRenderContext::setVertexShader
+      Summary:  Discards the bind
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    void NullRenderContext::setVertexShader(_In_ RenderHandle)
+    {
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   NullRenderContext::setPixelShader
+      Summary:  Discards the bind
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    void NullRenderContext::setPixelShader(_In_ RenderHandle)
+    {
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   NullRenderContext::setVertexConstantBuffers
+      Summary:  Discards the bind
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    void NullRenderContext::setVertexConstantBuffers(_In_ UINT, _In_ UINT, _In_reads_(uNumBuffers) const RenderHandle*)
+    {
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   NullRenderContext::setPixelConstantBuffers
+      Summary:  Discards the bind
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    void NullRenderContext::setPixelConstantBuffers(_In_ UINT, _In_ UINT, _In_reads_(uNumBuffers) const RenderHandle*)
+    {
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   NullRenderContext::setPixelShaderResources
+      Summary:  Discards the bind
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    void NullRenderContext::setPixelShaderResources(_In_ UINT, _In_ UINT, _In_reads_(uNumViews) const RenderHandle*)
+    {
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   NullRenderContext::setPixelSamplers
+      Summary:  Discards the bind
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    void NullRenderContext::setPixelSamplers(_In_ UINT, _In_ UINT, _In_reads_(uNumSamplers) const RenderHandle*)
+    {
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   NullRenderContext::setVertexConstantBufferRanges
+      Summary:  Discards the bind
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    void NullRenderContext::setVertexConstantBufferRanges(_In_ UINT, _In_ UINT, _In_reads_(uNumBuffers) const ConstantBufferRange*)
+    {
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   NullRenderContext::setPixelConstantBufferRanges
+      Summary:  Discards the bind
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    void NullRenderContext::setPixelConstantBufferRanges(_In_ UINT, _In_ UINT, _In_reads_(uNumBuffers) const ConstantBufferRange*)
+    {
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   NullRenderContext::updateConstantBuffer
+      Summary:  Discards the upload
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    void NullRenderContext::updateConstantBuffer(_In_ RenderHandle, _In_reads_bytes_(uDataSize) const void*, _In_ UINT)
+    {
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   NullRenderContext::mapBuffer
+      Summary:  Returns scratch memory the writes land in
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    void* NullRenderContext::mapBuffer(_In_ RenderHandle, _In_ eMapMode, _In_ UINT uByteWidth)
+    {
+        if (m_aMappedData.size() < uByteWidth)
+        {
+            m_aMappedData.resize(uByteWidth);
+        }
+
+        return m_aMappedData.data();
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   NullRenderContext::unmapBuffer
+      Summary:  Discards the writes
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    void NullRenderContext::unmapBuffer(_In_ RenderHandle)
+    {
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   NullRenderContext::copySubresource
+      Summary:  Discards the copy
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    void NullRenderContext::copySubresource(_In_ RenderHandle, _In_ UINT, _In_ RenderHandle, _In_ UINT)
+    {
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   NullRenderContext::drawIndexed
+      Summary:  Discards the draw
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    void NullRenderContext::drawIndexed(_In_ UINT, _In_ UINT, _In_ INT)
+    {
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   NullRenderContext::drawIndexedInstanced
+      Summary:  Discards the draw
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    void NullRenderContext::drawIndexedInstanced(_In_ UINT, _In_ UINT, _In_ UINT, _In_ INT, _In_ UINT)
+    {
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   NullRenderContext::finishCommandList
+      Summary:  Nothing was recorded, there is nothing to close
+      Returns:  HRESULT
+                  Status code
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    HRESULT NullRenderContext::finishCommandList()
+    {
+        return S_OK;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   NullRenderContext::executeCommandList
+      Summary:  Nothing was recorded, there is nothing to play back
+      Returns:  HRESULT
+                  Status code
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    HRESULT NullRenderContext::executeCommandList(_In_ RenderContext&)
+    {
+        return S_OK;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   NullRenderContext::signalFence
+      Summary:  Completes the fence at once, there is no GPU to wait
+                for
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    void NullRenderContext::signalFence(_In_ UINT64 uFenceValue)
+    {
+        m_uCompletedFenceValue = uFenceValue;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   NullRenderContext::getCompletedFenceValue
+      Summary:  Returns the last fence value signaled
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    UINT64 NullRenderContext::getCompletedFenceValue()
+    {
+        return m_uCompletedFenceValue;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   NullRenderContext::createTimestampQueries
+      Summary:  Allocates the timestamps of every set
+      Args:     UINT uNumQuerySets
+                  Number of sets
+                UINT uNumTimestamps
+                  Number of timestamps of every set
+      Modifies: [m_auTimestamps, m_uNumTimestampsPerSet].
+      Returns:  HRESULT
+                  Status code
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    HRESULT NullRenderContext::createTimestampQueries(_In_ UINT uNumQuerySets, _In_ UINT uNumTimestamps)
+    {
+        m_auTimestamps.assign(static_cast<size_t>(uNumQuerySets) * uNumTimestamps, 0u);
+        m_uNumTimestampsPerSet = uNumTimestamps;
+
+        return S_OK;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   NullRenderContext::beginTimestampQueries
+      Summary:  Nothing to begin, the clock never changes frequency
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    void NullRenderContext::beginTimestampQueries(_In_ UINT)
+    {
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   NullRenderContext::writeTimestamp
+      Summary:  Records the CPU time in nanoseconds
+      Args:     UINT uQuerySet
+                  Index of the set being filled
+                UINT uTimestamp
+                  Index of the timestamp in the set
+      Modifies: [m_auTimestamps].
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    void NullRenderContext::writeTimestamp(_In_ UINT uQuerySet, _In_ UINT uTimestamp)
+    {
+        assert(uTimestamp < m_uNumTimestampsPerSet);
+
+        m_auTimestamps[static_cast<size_t>(uQuerySet) * m_uNumTimestampsPerSet + uTimestamp] = static_cast<UINT64>(
+            std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count());
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   NullRenderContext::endTimestampQueries
+      Summary:  Nothing to end, the timestamps are readable at once
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    void NullRenderContext::endTimestampQueries(_In_ UINT)
+    {
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   NullRenderContext::getTimestampQueryData
+      Summary:  Copies the timestamps of a set, always ready
+      Args:     UINT uQuerySet
+                  Index of the set
+                UINT uNumTimestamps
+                  Number of timestamps written into the set
+                UINT64* auTimestamps
+                  Receives the timestamps in nanoseconds
+                UINT64* puFrequency
+                  Receives the nanoseconds per second
+      Returns:  BOOL
+                  TRUE
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    BOOL NullRenderContext::getTimestampQueryData(_In_ UINT uQuerySet, _In_ UINT uNumTimestamps, _Out_writes_(uNumTimestamps) UINT64* auTimestamps, _Out_ UINT64* puFrequency)
+    {
+        assert(uNumTimestamps <= m_uNumTimestampsPerSet);
+
+        std::copy_n(m_auTimestamps.begin() + static_cast<ptrdiff_t>(uQuerySet) * m_uNumTimestampsPerSet, uNumTimestamps, auTimestamps);
+        *puFrequency = 1000000000u;
+
+        return TRUE;
+    }
+}
@@ -0,0 +1,85 @@
+﻿/*+===================================================================
+  File:      NULLRENDERCONTEXT.H
+
+  Summary:   NullRenderContext header file contains declarations of
+             the NullRenderContext class, a render context that records
+             statistics but never touches a GPU.
+
+  Classes: NullRenderContext
+
+  © 2022 Kyung Hee University
+===================================================================+*/
+#pragma once
+
+#include "Common.h"
+
+#include "Renderer/RenderContext.h"
+
+namespace library
+{
+    /*C+C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C
+      Class:    NullRenderContext
+
+      Summary:  Headless back end. Draw calls, uploaded bytes and state
+                changes are counted by RenderContext, every command is
+                then discarded. Used to run and measure the CPU side of
+                the renderer without a device or a window. Mapped
+                buffers are backed by scratch memory, fences complete
+                as soon as they are signaled. Timestamps are the CPU
+                time they are recorded at, readable at once
+
+      Methods:  NullRenderContext
+                  Constructor.
+                ~NullRenderContext
+                  Destructor.
+    C---C---C---C---C---C---C---C---C---C---C---C---C---C---C---C---C-C*/
+    class NullRenderContext final : public RenderContext
+    {
+    public:
+        NullRenderContext();
+        NullRenderContext(const NullRenderContext& other) = delete;
+        NullRenderContext(NullRenderContext&& other) = delete;
+        NullRenderContext& operator=(const NullRenderContext& other) = delete;
+        NullRenderContext& operator=(NullRenderContext&& other) = delete;
+        ~NullRenderContext() override = default;
+
+    protected:
+        void clearRenderTarget(_In_ RenderHandle renderTargetView, _In_ const FLOAT aColor[4]) override;
+        void clearDepthStencil(_In_ RenderHandle depthStencilView, _In_ FLOAT depth) override;
+        void setRenderTargets(_In_ UINT uNumViews, _In_reads_(uNumViews) const RenderHandle* aRenderTargetViews, _In_opt_ RenderHandle depthStencilView) override;
+        void setViewport(_In_ FLOAT width, _In_ FLOAT height) override;
+        void setPrimitiveTopology(_In_ ePrimitiveTopology topology) override;
+        void setVertexBuffers(_In_ UINT uStartSlot, _In_ UINT uNumBuffers, _In_reads_(uNumBuffers) const RenderHandle* aBuffers, _In_reads_(uNumBuffers) const UINT* aStrides, _In_reads_(uNumBuffers) const UINT* aOffsets) override;
+        void setIndexBuffer(_In_ RenderHandle indexBuffer, _In_ eIndexFormat format, _In_ UINT uOffset) override;
+        void setInputLayout(_In_ RenderHandle inputLayout) override;
+        void setVertexShader(_In_ RenderHandle vertexShader) override;
+        void setPixelShader(_In_ RenderHandle pixelShader) override;
+        void setVertexConstantBuffers(_In_ UINT uStartSlot, _In_ UINT uNumBuffers, _In_reads_(uNumBuffers) const RenderHandle* aBuffers) override;
+        void setPixelConstantBuffers(_In_ UINT uStartSlot, _In_ UINT uNumBuffers, _In_reads_(uNumBuffers) const RenderHandle* aBuffers) override;
+        void setVertexConstantBufferRanges(_In_ UINT uStartSlot, _In_ UINT uNumBuffers, _In_reads_(uNumBuffers) const ConstantBufferRange* aRanges) override;
+        void setPixelConstantBufferRanges(_In_ UINT uStartSlot, _In_ UINT uNumBuffers, _In_reads_(uNumBuffers) const ConstantBufferRange* aRanges) override;
+        void setPixelShaderResources(_In_ UINT uStartSlot, _In_ UINT uNumViews, _In_reads_(uNumViews) const RenderHandle* aViews) override;
+        void setPixelSamplers(_In_ UINT uStartSlot, _In_ UINT uNumSamplers, _In_reads_(uNumSamplers) const RenderHandle* aSamplers) override;
+        void updateConstantBuffer(_In_ RenderHandle buffer, _In_reads_bytes_(uDataSize) const void* pData, _In_ UINT uDataSize) override;
+        void* mapBuffer(_In_ RenderHandle buffer, _In_ eMapMode mode, _In_ UINT uByteWidth) override;
+        void unmapBuffer(_In_ RenderHandle buffer) override;
+        void copySubresource(_In_ RenderHandle destination, _In_ UINT uDestinationSubresource, _In_ RenderHandle source, _In_ UINT uSourceSubresource) override;
+        void drawIndexed(_In_ UINT uIndexCount, _In_ UINT uStartIndexLocation, _In_ INT iBaseVertexLocation) override;
+        void drawIndexedInstanced(_In_ UINT uIndexCountPerInstance, _In_ UINT uInstanceCount, _In_ UINT uStartIndexLocation, _In_ INT iBaseVertexLocation, _In_ UINT uStartInstanceLocation) override;
+        HRESULT finishCommandList() override;
+        HRESULT executeCommandList(_In_ RenderContext& deferredContext) override;
+        void signalFence(_In_ UINT64 uFenceValue) override;
+        UINT64 getCompletedFenceValue() override;
+        HRESULT createTimestampQueries(_In_ UINT uNumQuerySets, _In_ UINT uNumTimestamps) override;
+        void beginTimestampQueries(_In_ UINT uQuerySet) override;
+        void writeTimestamp(_In_ UINT uQuerySet, _In_ UINT uTimestamp) override;
+        void endTimestampQueries(_In_ UINT uQuerySet) override;
+        BOOL getTimestampQueryData(_In_ UINT uQuerySet, _In_ UINT uNumTimestamps, _Out_writes_(uNumTimestamps) UINT64* auTimestamps, _Out_ UINT64* puFrequency) override;
+
+    private:
+        std::vector<BYTE> m_aMappedData;
+        UINT64 m_uCompletedFenceValue;
+        std::vector<UINT64> m_auTimestamps;
+        UINT m_uNumTimestampsPerSet;
+    };
+}
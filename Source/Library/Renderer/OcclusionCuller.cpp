@@ -0,0 +1,758 @@
+#include "Renderer/OcclusionCuller.h"
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__SSE__)
+#define OCCLUSIONCULLER_SSE
+#include <xmmintrin.h>
+#endif
+
+namespace library
+{
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   OcclusionCuller::OcclusionCuller
+      Summary:  Constructor. Every box is visible until the culler is
+                initialized and occluders are drawn
+      Modifies: [m_uWidth, m_uHeight, m_aLevels,
+                  m_uNumRasterizedTriangles, m_frameStart,
+                  m_rasterizationTime].
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    OcclusionCuller::OcclusionCuller()
+        : m_uWidth(0u)
+        , m_uHeight(0u)
+        , m_aLevels()
+        , m_uNumRasterizedTriangles(0u)
+        , m_frameStart()
+        , m_rasterizationTime(0.0f)
+    {
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   OcclusionCuller::Initialize
+      Summary:  Allocates the depth buffer and every level of the
+                hierarchy down to a single texel, all cleared to the
+                far plane
+      Args:     UINT uWidth
+                  Width of the depth buffer, a multiple of SIMD_WIDTH
+                UINT uHeight
+                  Height of the depth buffer
+      Modifies: [m_uWidth, m_uHeight, m_aLevels].
+      Returns:  HRESULT
+                  Status code
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    HRESULT OcclusionCuller::Initialize(_In_ UINT uWidth, _In_ UINT uHeight)
+    {
+        if (uWidth == 0u || uHeight == 0u || uWidth % SIMD_WIDTH != 0u)
+        {
+            return E_INVALIDARG;
+        }
+
+        m_uWidth = uWidth;
+        m_uHeight = uHeight;
+
+        m_aLevels.clear();
+        for (;;)
+        {
+            m_aLevels.push_back({ .uWidth = uWidth, .uHeight = uHeight, .aDepth = std::vector<FLOAT>(static_cast<size_t>(uWidth) * uHeight, 1.0f) });
+            if (uWidth == 1u && uHeight == 1u)
+            {
+                break;
+            }
+            uWidth = (uWidth + 1u) / 2u;
+            uHeight = (uHeight + 1u) / 2u;
+        }
+
+        return S_OK;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   OcclusionCuller::BeginFrame
+      Summary:  Clears the depth buffer to the far plane and starts
+                timing the rasterization
+      Modifies: [m_aLevels, m_uNumRasterizedTriangles, m_frameStart].
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    void OcclusionCuller::BeginFrame()
+    {
+        m_frameStart = std::chrono::steady_clock::now();
+        m_uNumRasterizedTriangles = 0u;
+
+        if (!m_aLevels.empty())
+        {
+            std::fill(m_aLevels[0].aDepth.begin(), m_aLevels[0].aDepth.end(), 1.0f);
+        }
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   OcclusionCuller::RasterizeTriangles
+      Summary:  Draws indexed triangles into the depth buffer. Both
+                faces are drawn, triangles crossing the near plane are
+                skipped, which only ever makes the culling less
+                aggressive
+      Args:     const FLOAT* pPositions
+                  x of the first vertex, followed by y and z
+                UINT uStride
+                  Distance in bytes between two vertices
+                const WORD* aIndices
+                  Three indices per triangle
+                UINT uNumIndices
+                  Number of indices
+                const FLOAT* aWorldViewProjection
+                  16 floats of the row major transformation to clip
+                  space
+      Modifies: [m_aLevels, m_uNumRasterizedTriangles].
+      Returns:  UINT
+                  Number of triangles drawn
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    UINT OcclusionCuller::RasterizeTriangles(
+        _In_reads_bytes_(uStride) const FLOAT* pPositions,
+        _In_ UINT uStride,
+        _In_reads_(uNumIndices) const WORD* aIndices,
+        _In_ UINT uNumIndices,
+        _In_reads_(16) const FLOAT* aWorldViewProjection
+    )
+    {
+        if (m_aLevels.empty())
+        {
+            return 0u;
+        }
+
+        const BYTE* pVertices = reinterpret_cast<const BYTE*>(pPositions);
+        UINT uNumTriangles = 0u;
+        for (UINT i = 0u; i + 2u < uNumIndices; i += 3u)
+        {
+            FLOAT aClip[3][4];
+            BOOL bInFront = TRUE;
+            for (UINT j = 0u; j < 3u; ++j)
+            {
+                const FLOAT* aPosition = reinterpret_cast<const FLOAT*>(pVertices + static_cast<size_t>(aIndices[i + j]) * uStride);
+                bInFront = bInFront && transformVertex(aPosition, aWorldViewProjection, aClip[j]);
+            }
+
+            if (bInFront && rasterizeTriangle(aClip[0], aClip[1], aClip[2]))
+            {
+                ++uNumTriangles;
+            }
+        }
+
+        m_uNumRasterizedTriangles += uNumTriangles;
+        return uNumTriangles;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   OcclusionCuller::RasterizeBox
+      Summary:  Draws the twelve triangles of a solid box into the depth
+                buffer, nothing when the box crosses the near plane
+      Args:     const AxisAlignedBox& box
+                  Box to draw
+                const FLOAT* aWorldViewProjection
+                  16 floats of the row major transformation to clip
+                  space
+      Modifies: [m_aLevels, m_uNumRasterizedTriangles].
+      Returns:  UINT
+                  Number of triangles drawn
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    UINT OcclusionCuller::RasterizeBox(_In_ const AxisAlignedBox& box, _In_reads_(16) const FLOAT* aWorldViewProjection)
+    {
+        static constexpr WORD BOX_INDICES[] =
+        {
+            0, 1, 3,  0, 3, 2,  // -z
+            4, 6, 7,  4, 7, 5,  // +z
+            0, 4, 5,  0, 5, 1,  // -y
+            2, 3, 7,  2, 7, 6,  // +y
+            0, 2, 6,  0, 6, 4,  // -x
+            1, 5, 7,  1, 7, 3,  // +x
+        };
+
+        if (m_aLevels.empty())
+        {
+            return 0u;
+        }
+
+        FLOAT aClip[8][4];
+        for (UINT i = 0u; i < 8u; ++i)
+        {
+            const FLOAT aCorner[3] =
+            {
+                box.Center[0] + ((i & 1u) ? box.Extents[0] : -box.Extents[0]),
+                box.Center[1] + ((i & 2u) ? box.Extents[1] : -box.Extents[1]),
+                box.Center[2] + ((i & 4u) ? box.Extents[2] : -box.Extents[2]),
+            };
+            if (!transformVertex(aCorner, aWorldViewProjection, aClip[i]))
+            {
+                return 0u;
+            }
+        }
+
+        UINT uNumTriangles = 0u;
+        for (UINT i = 0u; i < ARRAYSIZE(BOX_INDICES); i += 3u)
+        {
+            if (rasterizeTriangle(aClip[BOX_INDICES[i]], aClip[BOX_INDICES[i + 1u]], aClip[BOX_INDICES[i + 2u]]))
+            {
+                ++uNumTriangles;
+            }
+        }
+
+        m_uNumRasterizedTriangles += uNumTriangles;
+        return uNumTriangles;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   OcclusionCuller::BuildHierarchy
+      Summary:  Builds every level of the hierarchy from the one below,
+                keeping the farthest of each 2x2 texels, and stops
+                timing the rasterization
+      Modifies: [m_aLevels, m_rasterizationTime].
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    void OcclusionCuller::BuildHierarchy()
+    {
+        for (size_t uLevel = 1u; uLevel < m_aLevels.size(); ++uLevel)
+        {
+            const DepthLevel& source = m_aLevels[uLevel - 1u];
+            DepthLevel& destination = m_aLevels[uLevel];
+
+            for (UINT y = 0u; y < destination.uHeight; ++y)
+            {
+                const UINT uRow0 = 2u * y;
+                const UINT uRow1 = std::min(uRow0 + 1u, source.uHeight - 1u);
+                for (UINT x = 0u; x < destination.uWidth; ++x)
+                {
+                    const UINT uColumn0 = 2u * x;
+                    const UINT uColumn1 = std::min(uColumn0 + 1u, source.uWidth - 1u);
+                    destination.aDepth[y * destination.uWidth + x] = std::max(
+                        std::max(source.aDepth[uRow0 * source.uWidth + uColumn0], source.aDepth[uRow0 * source.uWidth + uColumn1]),
+                        std::max(source.aDepth[uRow1 * source.uWidth + uColumn0], source.aDepth[uRow1 * source.uWidth + uColumn1])
+                    );
+                }
+            }
+        }
+
+        m_rasterizationTime = std::chrono::duration<FLOAT, std::milli>(std::chrono::steady_clock::now() - m_frameStart).count();
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   OcclusionCuller::IsVisible
+      Summary:  Tests a single box against the depth hierarchy, built
+                beforehand with BuildHierarchy
+      Args:     const AxisAlignedBox& box
+                  Box to test
+                const FLOAT* aWorldViewProjection
+                  16 floats of the row major transformation to clip
+                  space
+      Returns:  BOOL
+                  FALSE when the box is hidden behind the occluders
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    BOOL OcclusionCuller::IsVisible(_In_ const AxisAlignedBox& box, _In_reads_(16) const FLOAT* aWorldViewProjection) const
+    {
+        FLOAT aRect[4];
+        FLOAT nearestDepth = 0.0f;
+        if (m_aLevels.empty() || !projectBox(box, aWorldViewProjection, aRect, &nearestDepth))
+        {
+            return TRUE;
+        }
+
+        return isRectVisible(aRect, nearestDepth);
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   OcclusionCuller::Cull
+      Summary:  Tests the boxes still flagged visible against the depth
+                hierarchy and clears the flag of the occluded ones
+      Args:     const BoundingBoxArray& boxes
+                  Boxes to test
+                const FLOAT* aWorldViewProjection
+                  16 floats of the row major transformation to clip
+                  space
+                BYTE* aVisible
+                  Visibility flag of each box, typically the result of
+                  the frustum culling
+      Returns:  UINT
+                  Number of boxes that remain visible
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    UINT OcclusionCuller::Cull(_In_ const BoundingBoxArray& boxes, _In_reads_(16) const FLOAT* aWorldViewProjection, _Inout_updates_(boxes.GetNumBoxes()) BYTE* aVisible) const
+    {
+        return Cull(boxes, 0u, boxes.GetNumBoxes(), aWorldViewProjection, aVisible);
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   OcclusionCuller::Cull
+      Summary:  Tests a range of boxes still flagged visible. The depth
+                hierarchy is only read, ranges can be tested from
+                several threads once it is built
+      Args:     const BoundingBoxArray& boxes
+                  Boxes to test
+                UINT uFirstBox
+                  Index of the first box of the range
+                UINT uNumBoxes
+                  Number of boxes of the range
+                const FLOAT* aWorldViewProjection
+                  16 floats of the row major transformation to clip
+                  space
+                BYTE* aVisible
+                  Visibility flag of each box of the range, starting at
+                  the first box of the range
+      Returns:  UINT
+                  Number of boxes of the range that remain visible
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    UINT OcclusionCuller::Cull(
+        _In_ const BoundingBoxArray& boxes,
+        _In_ UINT uFirstBox,
+        _In_ UINT uNumBoxes,
+        _In_reads_(16) const FLOAT* aWorldViewProjection,
+        _Inout_updates_(uNumBoxes) BYTE* aVisible
+    ) const
+    {
+        assert(uFirstBox + uNumBoxes <= boxes.GetNumBoxes());
+
+        const FLOAT* aCenterX = boxes.GetCenters(0u) + uFirstBox;
+        const FLOAT* aCenterY = boxes.GetCenters(1u) + uFirstBox;
+        const FLOAT* aCenterZ = boxes.GetCenters(2u) + uFirstBox;
+        const FLOAT* aExtentX = boxes.GetExtents(0u) + uFirstBox;
+        const FLOAT* aExtentY = boxes.GetExtents(1u) + uFirstBox;
+        const FLOAT* aExtentZ = boxes.GetExtents(2u) + uFirstBox;
+
+        UINT uNumVisible = 0u;
+        for (UINT i = 0u; i < uNumBoxes; ++i)
+        {
+            if (!aVisible[i])
+            {
+                continue;
+            }
+
+            const AxisAlignedBox box =
+            {
+                .Center = { aCenterX[i], aCenterY[i], aCenterZ[i] },
+                .Extents = { aExtentX[i], aExtentY[i], aExtentZ[i] },
+            };
+            aVisible[i] = IsVisible(box, aWorldViewProjection) ? 1u : 0u;
+            uNumVisible += aVisible[i];
+        }
+
+        return uNumVisible;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   OcclusionCuller::GetWidth
+      Summary:  Returns the width of the depth buffer
+      Returns:  UINT
+                  Width in pixels
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    UINT OcclusionCuller::GetWidth() const
+    {
+        return m_uWidth;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   OcclusionCuller::GetHeight
+      Summary:  Returns the height of the depth buffer
+      Returns:  UINT
+                  Height in pixels
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    UINT OcclusionCuller::GetHeight() const
+    {
+        return m_uHeight;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   OcclusionCuller::GetNumLevels
+      Summary:  Returns the number of levels of the hierarchy
+      Returns:  UINT
+                  Number of levels, the depth buffer included
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    UINT OcclusionCuller::GetNumLevels() const
+    {
+        return static_cast<UINT>(m_aLevels.size());
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   OcclusionCuller::GetDepth
+      Summary:  Returns a level of the hierarchy, level 0 being the
+                depth buffer. Level n is (width >> n) x (height >> n)
+                texels, rounded up
+      Args:     UINT uLevel
+                  Level to return
+      Returns:  const FLOAT*
+                  Row major depths of the level
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    const FLOAT* OcclusionCuller::GetDepth(_In_ UINT uLevel) const
+    {
+        return m_aLevels[uLevel].aDepth.data();
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   OcclusionCuller::GetNumRasterizedTriangles
+      Summary:  Returns the number of occluder triangles drawn since
+                the last BeginFrame
+      Returns:  UINT
+                  Number of triangles
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    UINT OcclusionCuller::GetNumRasterizedTriangles() const
+    {
+        return m_uNumRasterizedTriangles;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   OcclusionCuller::GetRasterizationTime
+      Summary:  Returns the CPU time between the last BeginFrame and
+                BuildHierarchy
+      Returns:  FLOAT
+                  Rasterization time in milliseconds
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    FLOAT OcclusionCuller::GetRasterizationTime() const
+    {
+        return m_rasterizationTime;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   OcclusionCuller::transformVertex
+      Summary:  Transforms a position to clip space
+      Args:     const FLOAT* aPosition
+                  x, y and z of the position
+                const FLOAT* aMatrix
+                  16 floats of the row major transformation
+                FLOAT* aClip
+                  Receives x, y, z and w in clip space
+      Returns:  BOOL
+                  FALSE when the position lies in front of the near
+                  plane
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    BOOL OcclusionCuller::transformVertex(_In_reads_(3) const FLOAT* aPosition, _In_reads_(16) const FLOAT* aMatrix, _Out_writes_(4) FLOAT* aClip)
+    {
+        for (UINT i = 0u; i < 4u; ++i)
+        {
+            aClip[i] = aPosition[0] * aMatrix[i] + aPosition[1] * aMatrix[4u + i] + aPosition[2] * aMatrix[8u + i] + aMatrix[12u + i];
+        }
+
+        return aClip[2] >= 0.0f && aClip[3] > FLT_EPSILON;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   OcclusionCuller::toScreen
+      Summary:  Projects a clip space position onto the depth buffer
+      Args:     const FLOAT* aClip
+                  x, y, z and w in clip space, w positive
+                FLOAT* aScreen
+                  Receives x and y in pixels, y pointing down, and the
+                  depth
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    void OcclusionCuller::toScreen(_In_reads_(4) const FLOAT* aClip, _Out_writes_(3) FLOAT* aScreen) const
+    {
+        const FLOAT invW = 1.0f / aClip[3];
+        aScreen[0] = (aClip[0] * invW * 0.5f + 0.5f) * static_cast<FLOAT>(m_uWidth);
+        aScreen[1] = (0.5f - aClip[1] * invW * 0.5f) * static_cast<FLOAT>(m_uHeight);
+        aScreen[2] = aClip[2] * invW;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   OcclusionCuller::rasterizeTriangle
+      Summary:  Draws a triangle into the depth buffer. Pixels whose
+                center lies inside all three edge functions keep the
+                nearest of their depth and the interpolated one
+      Args:     const FLOAT* aClip0
+                  First vertex in clip space
+                const FLOAT* aClip1
+                  Second vertex in clip space
+                const FLOAT* aClip2
+                  Third vertex in clip space
+      Modifies: [m_aLevels].
+      Returns:  BOOL
+                  FALSE when the triangle is degenerate or off screen
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    BOOL OcclusionCuller::rasterizeTriangle(_In_reads_(4) const FLOAT* aClip0, _In_reads_(4) const FLOAT* aClip1, _In_reads_(4) const FLOAT* aClip2)
+    {
+        FLOAT aScreen[3][3];
+        toScreen(aClip0, aScreen[0]);
+        toScreen(aClip1, aScreen[1]);
+        toScreen(aClip2, aScreen[2]);
+
+        const FLOAT* v0 = aScreen[0];
+        const FLOAT* v1 = aScreen[1];
+        const FLOAT* v2 = aScreen[2];
+
+        FLOAT area = (v1[0] - v0[0]) * (v2[1] - v0[1]) - (v1[1] - v0[1]) * (v2[0] - v0[0]);
+        if (std::fabs(area) < FLT_EPSILON)
+        {
+            return FALSE;
+        }
+
+        // Both faces are drawn, wind every triangle the same way
+        if (area < 0.0f)
+        {
+            std::swap(v1, v2);
+            area = -area;
+        }
+
+        // Pixels whose center is covered by the bounds
+        const INT iMinX = std::max(static_cast<INT>(std::ceil(std::min({ v0[0], v1[0], v2[0] }) - 0.5f)), 0);
+        const INT iMaxX = std::min(static_cast<INT>(std::floor(std::max({ v0[0], v1[0], v2[0] }) - 0.5f)), static_cast<INT>(m_uWidth) - 1);
+        const INT iMinY = std::max(static_cast<INT>(std::ceil(std::min({ v0[1], v1[1], v2[1] }) - 0.5f)), 0);
+        const INT iMaxY = std::min(static_cast<INT>(std::floor(std::max({ v0[1], v1[1], v2[1] }) - 0.5f)), static_cast<INT>(m_uHeight) - 1);
+        if (iMinX > iMaxX || iMinY > iMaxY)
+        {
+            return FALSE;
+        }
+
+        // Edge i is opposite to vertex i, E(x, y) = A x + B y + C
+        const FLOAT* aEdgeStart[3] = { v1, v2, v0 };
+        const FLOAT* aEdgeEnd[3] = { v2, v0, v1 };
+        FLOAT aEdgeA[3];
+        FLOAT aEdgeB[3];
+        FLOAT aEdgeC[3];
+        for (UINT i = 0u; i < 3u; ++i)
+        {
+            aEdgeA[i] = aEdgeStart[i][1] - aEdgeEnd[i][1];
+            aEdgeB[i] = aEdgeEnd[i][0] - aEdgeStart[i][0];
+            aEdgeC[i] = -(aEdgeA[i] * aEdgeStart[i][0] + aEdgeB[i] * aEdgeStart[i][1]);
+        }
+
+        // Depth plane, Z(x, y) = dZdX x + dZdY y + Z0
+        const FLOAT dZdX = ((v1[2] - v0[2]) * (v2[1] - v0[1]) - (v2[2] - v0[2]) * (v1[1] - v0[1])) / area;
+        const FLOAT dZdY = ((v2[2] - v0[2]) * (v1[0] - v0[0]) - (v1[2] - v0[2]) * (v2[0] - v0[0])) / area;
+        const FLOAT z0 = v0[2] - dZdX * v0[0] - dZdY * v0[1];
+
+        FLOAT* aDepth = m_aLevels[0].aDepth.data();
+        const INT iStartX = iMinX & ~static_cast<INT>(SIMD_WIDTH - 1u);
+
+#ifdef OCCLUSIONCULLER_SSE
+        const __m128 offsets = _mm_set_ps(3.5f, 2.5f, 1.5f, 0.5f);
+        const __m128 zero = _mm_setzero_ps();
+        __m128 aStepE[3];
+        for (UINT i = 0u; i < 3u; ++i)
+        {
+            aStepE[i] = _mm_set1_ps(aEdgeA[i] * static_cast<FLOAT>(SIMD_WIDTH));
+        }
+        const __m128 stepZ = _mm_set1_ps(dZdX * static_cast<FLOAT>(SIMD_WIDTH));
+
+        for (INT y = iMinY; y <= iMaxY; ++y)
+        {
+            const FLOAT py = static_cast<FLOAT>(y) + 0.5f;
+            const __m128 px = _mm_add_ps(_mm_set1_ps(static_cast<FLOAT>(iStartX)), offsets);
+
+            __m128 aE[3];
+            for (UINT i = 0u; i < 3u; ++i)
+            {
+                aE[i] = _mm_add_ps(_mm_mul_ps(px, _mm_set1_ps(aEdgeA[i])), _mm_set1_ps(aEdgeB[i] * py + aEdgeC[i]));
+            }
+            __m128 z = _mm_add_ps(_mm_mul_ps(px, _mm_set1_ps(dZdX)), _mm_set1_ps(dZdY * py + z0));
+
+            FLOAT* aRow = aDepth + static_cast<size_t>(y) * m_uWidth;
+            for (INT x = iStartX; x <= iMaxX; x += static_cast<INT>(SIMD_WIDTH))
+            {
+                const __m128 inside = _mm_and_ps(_mm_and_ps(_mm_cmpge_ps(aE[0], zero), _mm_cmpge_ps(aE[1], zero)), _mm_cmpge_ps(aE[2], zero));
+                if (_mm_movemask_ps(inside))
+                {
+                    const __m128 depth = _mm_loadu_ps(aRow + x);
+                    const __m128 nearest = _mm_min_ps(depth, z);
+                    _mm_storeu_ps(aRow + x, _mm_or_ps(_mm_and_ps(inside, nearest), _mm_andnot_ps(inside, depth)));
+                }
+
+                for (UINT i = 0u; i < 3u; ++i)
+                {
+                    aE[i] = _mm_add_ps(aE[i], aStepE[i]);
+                }
+                z = _mm_add_ps(z, stepZ);
+            }
+        }
+#else
+        for (INT y = iMinY; y <= iMaxY; ++y)
+        {
+            const FLOAT py = static_cast<FLOAT>(y) + 0.5f;
+            FLOAT* aRow = aDepth + static_cast<size_t>(y) * m_uWidth;
+            for (INT x = iStartX; x <= iMaxX; ++x)
+            {
+                const FLOAT px = static_cast<FLOAT>(x) + 0.5f;
+                const BOOL bInside =
+                    aEdgeA[0] * px + aEdgeB[0] * py + aEdgeC[0] >= 0.0f &&
+                    aEdgeA[1] * px + aEdgeB[1] * py + aEdgeC[1] >= 0.0f &&
+                    aEdgeA[2] * px + aEdgeB[2] * py + aEdgeC[2] >= 0.0f;
+                if (bInside)
+                {
+                    aRow[x] = std::min(aRow[x], dZdX * px + dZdY * py + z0);
+                }
+            }
+        }
+#endif
+
+        return TRUE;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   OcclusionCuller::projectBox
+      Summary:  Projects the eight corners of a box onto the depth
+                buffer. The corners are the center plus or minus each
+                transformed extent, computed four corners at a time
+                with SSE when available
+      Args:     const AxisAlignedBox& box
+                  Box to project
+                const FLOAT* aMatrix
+                  16 floats of the row major transformation to clip
+                  space
+                FLOAT* aRect
+                  Receives the screen rectangle in pixels as min x,
+                  min y, max x and max y
+                FLOAT* pNearestDepth
+                  Receives the depth of the nearest corner
+      Returns:  BOOL
+                  FALSE when the box crosses the near plane
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    BOOL OcclusionCuller::projectBox(_In_ const AxisAlignedBox& box, _In_reads_(16) const FLOAT* aMatrix, _Out_writes_(4) FLOAT* aRect, _Out_ FLOAT* pNearestDepth) const
+    {
+        FLOAT aCenter[4];
+        FLOAT aExtents[3][4];
+        for (UINT i = 0u; i < 4u; ++i)
+        {
+            aCenter[i] = box.Center[0] * aMatrix[i] + box.Center[1] * aMatrix[4u + i] + box.Center[2] * aMatrix[8u + i] + aMatrix[12u + i];
+            for (UINT uAxis = 0u; uAxis < 3u; ++uAxis)
+            {
+                aExtents[uAxis][i] = box.Extents[uAxis] * aMatrix[uAxis * 4u + i];
+            }
+        }
+
+        FLOAT minX = FLT_MAX;
+        FLOAT minY = FLT_MAX;
+        FLOAT maxX = -FLT_MAX;
+        FLOAT maxY = -FLT_MAX;
+        FLOAT nearestDepth = FLT_MAX;
+
+#ifdef OCCLUSIONCULLER_SSE
+        // Lanes are the corners (-x -y), (+x -y), (-x +y) and (+x +y)
+        const __m128 signX = _mm_set_ps(1.0f, -1.0f, 1.0f, -1.0f);
+        const __m128 signY = _mm_set_ps(1.0f, 1.0f, -1.0f, -1.0f);
+
+        __m128 aCorners[2][4];
+        for (UINT i = 0u; i < 4u; ++i)
+        {
+            const __m128 base = _mm_add_ps(_mm_set1_ps(aCenter[i]),
+                _mm_add_ps(_mm_mul_ps(signX, _mm_set1_ps(aExtents[0][i])), _mm_mul_ps(signY, _mm_set1_ps(aExtents[1][i]))));
+            aCorners[0][i] = _mm_sub_ps(base, _mm_set1_ps(aExtents[2][i]));
+            aCorners[1][i] = _mm_add_ps(base, _mm_set1_ps(aExtents[2][i]));
+        }
+
+        const __m128 epsilon = _mm_set1_ps(FLT_EPSILON);
+        const __m128 zero = _mm_setzero_ps();
+        __m128 lowerX = _mm_set1_ps(FLT_MAX);
+        __m128 lowerY = _mm_set1_ps(FLT_MAX);
+        __m128 lowerZ = _mm_set1_ps(FLT_MAX);
+        __m128 upperX = _mm_set1_ps(-FLT_MAX);
+        __m128 upperY = _mm_set1_ps(-FLT_MAX);
+        for (UINT j = 0u; j < 2u; ++j)
+        {
+            const __m128 behind = _mm_or_ps(_mm_cmplt_ps(aCorners[j][2], zero), _mm_cmple_ps(aCorners[j][3], epsilon));
+            if (_mm_movemask_ps(behind))
+            {
+                return FALSE;
+            }
+
+            const __m128 invW = _mm_div_ps(_mm_set1_ps(1.0f), aCorners[j][3]);
+            const __m128 x = _mm_mul_ps(aCorners[j][0], invW);
+            const __m128 y = _mm_mul_ps(aCorners[j][1], invW);
+            const __m128 z = _mm_mul_ps(aCorners[j][2], invW);
+            lowerX = _mm_min_ps(lowerX, x);
+            lowerY = _mm_min_ps(lowerY, y);
+            lowerZ = _mm_min_ps(lowerZ, z);
+            upperX = _mm_max_ps(upperX, x);
+            upperY = _mm_max_ps(upperY, y);
+        }
+
+        FLOAT aLowerX[4];
+        FLOAT aLowerY[4];
+        FLOAT aLowerZ[4];
+        FLOAT aUpperX[4];
+        FLOAT aUpperY[4];
+        _mm_storeu_ps(aLowerX, lowerX);
+        _mm_storeu_ps(aLowerY, lowerY);
+        _mm_storeu_ps(aLowerZ, lowerZ);
+        _mm_storeu_ps(aUpperX, upperX);
+        _mm_storeu_ps(aUpperY, upperY);
+        for (UINT i = 0u; i < 4u; ++i)
+        {
+            minX = std::min(minX, aLowerX[i]);
+            minY = std::min(minY, aLowerY[i]);
+            nearestDepth = std::min(nearestDepth, aLowerZ[i]);
+            maxX = std::max(maxX, aUpperX[i]);
+            maxY = std::max(maxY, aUpperY[i]);
+        }
+#else
+        for (UINT uCorner = 0u; uCorner < 8u; ++uCorner)
+        {
+            FLOAT aClip[4];
+            for (UINT i = 0u; i < 4u; ++i)
+            {
+                aClip[i] = aCenter[i]
+                    + ((uCorner & 1u) ? aExtents[0][i] : -aExtents[0][i])
+                    + ((uCorner & 2u) ? aExtents[1][i] : -aExtents[1][i])
+                    + ((uCorner & 4u) ? aExtents[2][i] : -aExtents[2][i]);
+            }
+            if (aClip[2] < 0.0f || aClip[3] <= FLT_EPSILON)
+            {
+                return FALSE;
+            }
+
+            const FLOAT invW = 1.0f / aClip[3];
+            minX = std::min(minX, aClip[0] * invW);
+            minY = std::min(minY, aClip[1] * invW);
+            maxX = std::max(maxX, aClip[0] * invW);
+            maxY = std::max(maxY, aClip[1] * invW);
+            nearestDepth = std::min(nearestDepth, aClip[2] * invW);
+        }
+#endif
+
+        // Normalized device coordinates to pixels, y pointing down
+        aRect[0] = (minX * 0.5f + 0.5f) * static_cast<FLOAT>(m_uWidth);
+        aRect[1] = (0.5f - maxY * 0.5f) * static_cast<FLOAT>(m_uHeight);
+        aRect[2] = (maxX * 0.5f + 0.5f) * static_cast<FLOAT>(m_uWidth);
+        aRect[3] = (0.5f - minY * 0.5f) * static_cast<FLOAT>(m_uHeight);
+        *pNearestDepth = nearestDepth;
+
+        return TRUE;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   OcclusionCuller::isRectVisible
+      Summary:  Tests a screen rectangle against the coarsest level of
+                the hierarchy it covers with at most 4x4 texels
+      Args:     const FLOAT* aRect
+                  Min x, min y, max x and max y in pixels
+                FLOAT nearestDepth
+                  Depth of the nearest point of the rectangle
+      Returns:  BOOL
+                  TRUE when a texel is farther than the rectangle
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    BOOL OcclusionCuller::isRectVisible(_In_reads_(4) const FLOAT* aRect, _In_ FLOAT nearestDepth) const
+    {
+        const FLOAT width = static_cast<FLOAT>(m_uWidth);
+        const FLOAT height = static_cast<FLOAT>(m_uHeight);
+
+        // Off screen boxes are left to the frustum culling
+        if (aRect[2] < 0.0f || aRect[3] < 0.0f || aRect[0] >= width || aRect[1] >= height)
+        {
+            return TRUE;
+        }
+
+        const UINT uMinX = static_cast<UINT>(std::max(aRect[0], 0.0f));
+        const UINT uMinY = static_cast<UINT>(std::max(aRect[1], 0.0f));
+        const UINT uMaxX = std::min(static_cast<UINT>(aRect[2]), m_uWidth - 1u);
+        const UINT uMaxY = std::min(static_cast<UINT>(aRect[3]), m_uHeight - 1u);
+
+        UINT uLevel = 0u;
+        while (uLevel + 1u < m_aLevels.size() && ((uMaxX >> uLevel) - (uMinX >> uLevel) > 3u || (uMaxY >> uLevel) - (uMinY >> uLevel) > 3u))
+        {
+            ++uLevel;
+        }
+
+        const DepthLevel& level = m_aLevels[uLevel];
+        for (UINT y = uMinY >> uLevel; y <= (uMaxY >> uLevel); ++y)
+        {
+            for (UINT x = uMinX >> uLevel; x <= (uMaxX >> uLevel); ++x)
+            {
+                if (level.aDepth[y * level.uWidth + x] >= nearestDepth)
+                {
+                    return TRUE;
+                }
+            }
+        }
+
+        return FALSE;
+    }
+}
@@ -0,0 +1,135 @@
+﻿/*+===================================================================
+  File:      OCCLUSIONCULLER.H
+
+  Summary:   OcclusionCuller header file contains declarations of the
+             OcclusionCuller class, a low resolution software depth
+             rasterizer that tests bounding boxes against a depth
+             hierarchy of the occluders drawn into it.
+
+  Classes: OcclusionCuller
+
+  © 2022 Kyung Hee University
+===================================================================+*/
+#pragma once
+
+#include "Common.h"
+
+#include <chrono>
+
+#include "Renderer/FrustumCuller.h"
+
+namespace library
+{
+    /*C+C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C
+      Class:    OcclusionCuller
+
+      Summary:  Rasterizes occluder triangles into a CPU depth buffer,
+                four pixels at a time with SSE when available, builds
+                a hierarchy of farthest depths from it and culls boxes
+                whose nearest depth lies behind every texel they cover.
+                Depth follows the Direct3D convention, 0 at the near
+                plane and 1 at the far plane
+
+      Methods:  Initialize
+                  Allocates the depth buffer and its hierarchy
+                BeginFrame
+                  Clears the depth buffer
+                RasterizeTriangles
+                  Draws indexed triangles as occluders
+                RasterizeBox
+                  Draws a solid box as an occluder
+                BuildHierarchy
+                  Builds the depth hierarchy from the depth buffer
+                IsVisible
+                  Tests a single box
+                Cull
+                  Tests a batch or a range of boxes
+                GetWidth
+                  Returns the width of the depth buffer
+                GetHeight
+                  Returns the height of the depth buffer
+                GetNumLevels
+                  Returns the number of levels of the hierarchy
+                GetDepth
+                  Returns a level of the hierarchy
+                GetNumRasterizedTriangles
+                  Returns the number of triangles drawn this frame
+                GetRasterizationTime
+                  Returns the time spent drawing the occluders
+                OcclusionCuller
+                  Constructor.
+                ~OcclusionCuller
+                  Destructor.
+    C---C---C---C---C---C---C---C---C---C---C---C---C---C---C---C---C-C*/
+    class OcclusionCuller final
+    {
+    public:
+        static constexpr UINT SIMD_WIDTH = 4u;
+
+    public:
+        OcclusionCuller();
+        OcclusionCuller(const OcclusionCuller& other) = delete;
+        OcclusionCuller(OcclusionCuller&& other) = delete;
+        OcclusionCuller& operator=(const OcclusionCuller& other) = delete;
+        OcclusionCuller& operator=(OcclusionCuller&& other) = delete;
+        ~OcclusionCuller() = default;
+
+        HRESULT Initialize(_In_ UINT uWidth, _In_ UINT uHeight);
+
+        void BeginFrame();
+        UINT RasterizeTriangles(
+            _In_reads_bytes_(uStride) const FLOAT* pPositions,
+            _In_ UINT uStride,
+            _In_reads_(uNumIndices) const WORD* aIndices,
+            _In_ UINT uNumIndices,
+            _In_reads_(16) const FLOAT* aWorldViewProjection
+        );
+        UINT RasterizeBox(_In_ const AxisAlignedBox& box, _In_reads_(16) const FLOAT* aWorldViewProjection);
+        void BuildHierarchy();
+
+        BOOL IsVisible(_In_ const AxisAlignedBox& box, _In_reads_(16) const FLOAT* aWorldViewProjection) const;
+        UINT Cull(_In_ const BoundingBoxArray& boxes, _In_reads_(16) const FLOAT* aWorldViewProjection, _Inout_updates_(boxes.GetNumBoxes()) BYTE* aVisible) const;
+        UINT Cull(
+            _In_ const BoundingBoxArray& boxes,
+            _In_ UINT uFirstBox,
+            _In_ UINT uNumBoxes,
+            _In_reads_(16) const FLOAT* aWorldViewProjection,
+            _Inout_updates_(uNumBoxes) BYTE* aVisible
+        ) const;
+
+        UINT GetWidth() const;
+        UINT GetHeight() const;
+        UINT GetNumLevels() const;
+        const FLOAT* GetDepth(_In_ UINT uLevel) const;
+        UINT GetNumRasterizedTriangles() const;
+        FLOAT GetRasterizationTime() const;
+
+    private:
+        /*S+S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S
+          Struct:   DepthLevel
+
+          Summary:  Level of the depth hierarchy, each texel holds the
+                    farthest depth of the texels it covers one level
+                    below
+        S---S---S---S---S---S---S---S---S---S---S---S---S---S---S---S---S-S*/
+        struct DepthLevel
+        {
+            UINT uWidth;
+            UINT uHeight;
+            std::vector<FLOAT> aDepth;
+        };
+
+        static BOOL transformVertex(_In_reads_(3) const FLOAT* aPosition, _In_reads_(16) const FLOAT* aMatrix, _Out_writes_(4) FLOAT* aClip);
+        void toScreen(_In_reads_(4) const FLOAT* aClip, _Out_writes_(3) FLOAT* aScreen) const;
+        BOOL rasterizeTriangle(_In_reads_(4) const FLOAT* aClip0, _In_reads_(4) const FLOAT* aClip1, _In_reads_(4) const FLOAT* aClip2);
+        BOOL projectBox(_In_ const AxisAlignedBox& box, _In_reads_(16) const FLOAT* aMatrix, _Out_writes_(4) FLOAT* aRect, _Out_ FLOAT* pNearestDepth) const;
+        BOOL isRectVisible(_In_reads_(4) const FLOAT* aRect, _In_ FLOAT nearestDepth) const;
+
+        UINT m_uWidth;
+        UINT m_uHeight;
+        std::vector<DepthLevel> m_aLevels;
+        UINT m_uNumRasterizedTriangles;
+        std::chrono::steady_clock::time_point m_frameStart;
+        FLOAT m_rasterizationTime;
+    };
+}
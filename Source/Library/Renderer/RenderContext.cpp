@@ -0,0 +1,875 @@
+#include "Renderer/RenderContext.h"
+
+#include <cstdint>
+
+namespace library
+{
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   RenderContext::RenderContext
+      Summary:  Constructor
+      Modifies: [m_statistics, m_aRenderTargetViews, m_depthStencilView,
+                 m_uNumRenderTargetViews, m_aVertexBuffers,
+                 m_auVertexStrides, m_auVertexOffsets, m_viewportWidth,
+                 m_viewportHeight, m_topology, m_indexBuffer,
+                 m_indexFormat, m_uIndexOffset, m_inputLayout,
+                 m_vertexShader, m_pixelShader, m_aVertexConstantBuffers,
+                 m_aPixelConstantBuffers, m_aPixelShaderResources,
+                 m_aPixelSamplers].
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    RenderContext::RenderContext()
+        : m_statistics()
+        , m_aRenderTargetViews()
+        , m_depthStencilView()
+        , m_uNumRenderTargetViews(0u)
+        , m_aVertexBuffers()
+        , m_auVertexStrides()
+        , m_auVertexOffsets()
+        , m_viewportWidth(0.0f)
+        , m_viewportHeight(0.0f)
+        , m_topology(ePrimitiveTopology::COUNT)
+        , m_indexBuffer()
+        , m_indexFormat(eIndexFormat::R16_UINT)
+        , m_uIndexOffset(0u)
+        , m_inputLayout()
+        , m_vertexShader()
+        , m_pixelShader()
+        , m_aVertexConstantBuffers()
+        , m_aPixelConstantBuffers()
+        , m_aPixelShaderResources()
+        , m_aPixelSamplers()
+    {
+        InvalidateState();
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   RenderContext::ClearRenderTarget
+      Summary:  Clears a render target view
+      Args:     RenderHandle renderTargetView
+                  Render target view to clear
+                const FLOAT aColor[4]
+                  Clear color
+      Modifies: [m_statistics].
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    void RenderContext::ClearRenderTarget(_In_ RenderHandle renderTargetView, _In_ const FLOAT aColor[4])
+    {
+        ++m_statistics.uNumClears;
+        clearRenderTarget(renderTargetView, aColor);
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   RenderContext::ClearDepthStencil
+      Summary:  Clears the depth of a depth stencil view
+      Args:     RenderHandle depthStencilView
+                  Depth stencil view to clear
+                FLOAT depth
+                  Depth value to clear to
+      Modifies: [m_statistics].
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    void RenderContext::ClearDepthStencil(_In_ RenderHandle depthStencilView, _In_ FLOAT depth)
+    {
+        ++m_statistics.uNumClears;
+        clearDepthStencil(depthStencilView, depth);
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   RenderContext::SetRenderTargets
+      Summary:  Binds render targets and a depth stencil view. Binding
+                a new target unbinds any aliasing shader resource on
+                the device, so the shadowed shader resources are
+                forgotten as well
+      Args:     UINT uNumViews
+                  Number of render target views
+                const RenderHandle* aRenderTargetViews
+                  Array of render target views
+                RenderHandle depthStencilView
+                  Depth stencil view
+      Modifies: [m_statistics, m_aRenderTargetViews, m_depthStencilView,
+                 m_uNumRenderTargetViews, m_aPixelShaderResources].
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    void RenderContext::SetRenderTargets(_In_ UINT uNumViews, _In_reads_(uNumViews) const RenderHandle* aRenderTargetViews, _In_opt_ RenderHandle depthStencilView)
+    {
+        assert(uNumViews <= MAX_RENDER_TARGETS);
+
+        BOOL bChanged = (uNumViews != m_uNumRenderTargetViews) || (depthStencilView != m_depthStencilView);
+        for (UINT i = 0u; i < uNumViews && !bChanged; ++i)
+        {
+            bChanged = aRenderTargetViews[i] != m_aRenderTargetViews[i];
+        }
+
+        if (!bChanged)
+        {
+            ++m_statistics.uNumRedundantStateChanges;
+            return;
+        }
+
+        for (UINT i = 0u; i < MAX_RENDER_TARGETS; ++i)
+        {
+            m_aRenderTargetViews[i] = i < uNumViews ? aRenderTargetViews[i] : nullptr;
+        }
+        m_depthStencilView = depthStencilView;
+        m_uNumRenderTargetViews = uNumViews;
+
+        for (UINT i = 0u; i < MAX_SHADER_RESOURCES; ++i)
+        {
+            m_aPixelShaderResources[i] = invalidHandle();
+        }
+
+        ++m_statistics.uNumStateChanges;
+        setRenderTargets(uNumViews, aRenderTargetViews, depthStencilView);
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   RenderContext::SetViewport
+      Summary:  Sets a viewport covering the render target from its
+                top left corner, with the full depth range
+      Args:     FLOAT width
+                  Width of the viewport
+                FLOAT height
+                  Height of the viewport
+      Modifies: [m_statistics, m_viewportWidth, m_viewportHeight].
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    void RenderContext::SetViewport(_In_ FLOAT width, _In_ FLOAT height)
+    {
+        if (m_viewportWidth == width && m_viewportHeight == height)
+        {
+            ++m_statistics.uNumRedundantStateChanges;
+            return;
+        }
+
+        m_viewportWidth = width;
+        m_viewportHeight = height;
+
+        ++m_statistics.uNumStateChanges;
+        setViewport(width, height);
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   RenderContext::SetPrimitiveTopology
+      Summary:  Sets the input assembler primitive topology
+      Args:     ePrimitiveTopology topology
+                  Primitive topology
+      Modifies: [m_statistics, m_topology].
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    void RenderContext::SetPrimitiveTopology(_In_ ePrimitiveTopology topology)
+    {
+        if (m_topology == topology)
+        {
+            ++m_statistics.uNumRedundantStateChanges;
+            return;
+        }
+
+        m_topology = topology;
+
+        ++m_statistics.uNumStateChanges;
+        setPrimitiveTopology(topology);
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   RenderContext::SetVertexBuffers
+      Summary:  Binds vertex buffers to the input assembler
+      Args:     UINT uStartSlot
+                  First input slot
+                UINT uNumBuffers
+                  Number of buffers in the arrays
+                const RenderHandle* aBuffers
+                  Array of vertex buffers
+                const UINT* aStrides
+                  Array of strides, one for each buffer
+                const UINT* aOffsets
+                  Array of offsets, one for each buffer
+      Modifies: [m_statistics, m_aVertexBuffers, m_auVertexStrides,
+                 m_auVertexOffsets].
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    void RenderContext::SetVertexBuffers(_In_ UINT uStartSlot, _In_ UINT uNumBuffers, _In_reads_(uNumBuffers) const RenderHandle* aBuffers, _In_reads_(uNumBuffers) const UINT* aStrides, _In_reads_(uNumBuffers) const UINT* aOffsets)
+    {
+        assert(uStartSlot + uNumBuffers <= MAX_VERTEX_BUFFERS);
+
+        BOOL bChanged = FALSE;
+        for (UINT i = 0u; i < uNumBuffers; ++i)
+        {
+            const UINT uSlot = uStartSlot + i;
+            if (m_aVertexBuffers[uSlot] != aBuffers[i] || m_auVertexStrides[uSlot] != aStrides[i] || m_auVertexOffsets[uSlot] != aOffsets[i])
+            {
+                m_aVertexBuffers[uSlot] = aBuffers[i];
+                m_auVertexStrides[uSlot] = aStrides[i];
+                m_auVertexOffsets[uSlot] = aOffsets[i];
+                bChanged = TRUE;
+            }
+        }
+
+        if (!bChanged)
+        {
+            ++m_statistics.uNumRedundantStateChanges;
+            return;
+        }
+
+        ++m_statistics.uNumStateChanges;
+        setVertexBuffers(uStartSlot, uNumBuffers, aBuffers, aStrides, aOffsets);
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   RenderContext::SetIndexBuffer
+      Summary:  Binds an index buffer to the input assembler
+      Args:     RenderHandle indexBuffer
+                  Index buffer
+                eIndexFormat format
+                  Format of the indices
+                UINT uOffset
+                  Offset in bytes to the first index
+      Modifies: [m_statistics, m_indexBuffer, m_indexFormat,
+                 m_uIndexOffset].
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    void RenderContext::SetIndexBuffer(_In_ RenderHandle indexBuffer, _In_ eIndexFormat format, _In_ UINT uOffset)
+    {
+        if (m_indexBuffer == indexBuffer && m_indexFormat == format && m_uIndexOffset == uOffset)
+        {
+            ++m_statistics.uNumRedundantStateChanges;
+            return;
+        }
+
+        m_indexBuffer = indexBuffer;
+        m_indexFormat = format;
+        m_uIndexOffset = uOffset;
+
+        ++m_statistics.uNumStateChanges;
+        setIndexBuffer(indexBuffer, format, uOffset);
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   RenderContext::SetInputLayout
+      Summary:  Binds an input layout to the input assembler
+      Args:     RenderHandle inputLayout
+                  Input layout
+      Modifies: [m_statistics, m_inputLayout].
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    void RenderContext::SetInputLayout(_In_ RenderHandle inputLayout)
+    {
+        if (updateState(m_inputLayout, inputLayout))
+        {
+            setInputLayout(inputLayout);
+        }
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   RenderContext::SetVertexShader
+      Summary:  Binds a vertex shader
+      Args:     RenderHandle vertexShader
+                  Vertex shader
+      Modifies: [m_statistics, m_vertexShader].
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    void RenderContext::SetVertexShader(_In_ RenderHandle vertexShader)
+    {
+        if (updateState(m_vertexShader, vertexShader))
+        {
+            setVertexShader(vertexShader);
+        }
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   RenderContext::SetPixelShader
+      Summary:  Binds a pixel shader
+      Args:     RenderHandle pixelShader
+                  Pixel shader
+      Modifies: [m_statistics, m_pixelShader].
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    void RenderContext::SetPixelShader(_In_ RenderHandle pixelShader)
+    {
+        if (updateState(m_pixelShader, pixelShader))
+        {
+            setPixelShader(pixelShader);
+        }
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   RenderContext::SetVertexConstantBuffers
+      Summary:  Binds constant buffers to the vertex shader stage
+      Args:     UINT uStartSlot
+                  First constant buffer slot
+                UINT uNumBuffers
+                  Number of buffers in the array
+                const RenderHandle* aBuffers
+                  Array of constant buffers
+      Modifies: [m_statistics, m_aVertexConstantBuffers].
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    void RenderContext::SetVertexConstantBuffers(_In_ UINT uStartSlot, _In_ UINT uNumBuffers, _In_reads_(uNumBuffers) const RenderHandle* aBuffers)
+    {
+        assert(uNumBuffers <= MAX_CONSTANT_BUFFERS);
+
+        ConstantBufferRange aRanges[MAX_CONSTANT_BUFFERS];
+        for (UINT i = 0u; i < uNumBuffers; ++i)
+        {
+            aRanges[i] = { .buffer = aBuffers[i], .uFirstConstant = 0u, .uNumConstants = 0u };
+        }
+
+        if (updateConstantBufferSlots(m_aVertexConstantBuffers, uStartSlot, uNumBuffers, aRanges))
+        {
+            setVertexConstantBuffers(uStartSlot, uNumBuffers, aBuffers);
+        }
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   RenderContext::SetVertexConstantBuffers
+      Summary:  Binds ranges of constant buffers to the vertex shader
+                stage. Binding the same buffer at another offset is a
+                state change
+      Args:     UINT uStartSlot
+                  First constant buffer slot
+                UINT uNumBuffers
+                  Number of ranges in the array
+                const ConstantBufferRange* aRanges
+                  Array of constant buffer ranges
+      Modifies: [m_statistics, m_aVertexConstantBuffers].
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    void RenderContext::SetVertexConstantBuffers(_In_ UINT uStartSlot, _In_ UINT uNumBuffers, _In_reads_(uNumBuffers) const ConstantBufferRange* aRanges)
+    {
+        if (updateConstantBufferSlots(m_aVertexConstantBuffers, uStartSlot, uNumBuffers, aRanges))
+        {
+            setVertexConstantBufferRanges(uStartSlot, uNumBuffers, aRanges);
+        }
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   RenderContext::SetPixelConstantBuffers
+      Summary:  Binds constant buffers to the pixel shader stage
+      Args:     UINT uStartSlot
+                  First constant buffer slot
+                UINT uNumBuffers
+                  Number of buffers in the array
+                const RenderHandle* aBuffers
+                  Array of constant buffers
+      Modifies: [m_statistics, m_aPixelConstantBuffers].
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    void RenderContext::SetPixelConstantBuffers(_In_ UINT uStartSlot, _In_ UINT uNumBuffers, _In_reads_(uNumBuffers) const RenderHandle* aBuffers)
+    {
+        assert(uNumBuffers <= MAX_CONSTANT_BUFFERS);
+
+        ConstantBufferRange aRanges[MAX_CONSTANT_BUFFERS];
+        for (UINT i = 0u; i < uNumBuffers; ++i)
+        {
+            aRanges[i] = { .buffer = aBuffers[i], .uFirstConstant = 0u, .uNumConstants = 0u };
+        }
+
+        if (updateConstantBufferSlots(m_aPixelConstantBuffers, uStartSlot, uNumBuffers, aRanges))
+        {
+            setPixelConstantBuffers(uStartSlot, uNumBuffers, aBuffers);
+        }
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   RenderContext::SetPixelConstantBuffers
+      Summary:  Binds ranges of constant buffers to the pixel shader
+                stage. Binding the same buffer at another offset is a
+                state change
+      Args:     UINT uStartSlot
+                  First constant buffer slot
+                UINT uNumBuffers
+                  Number of ranges in the array
+                const ConstantBufferRange* aRanges
+                  Array of constant buffer ranges
+      Modifies: [m_statistics, m_aPixelConstantBuffers].
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    void RenderContext::SetPixelConstantBuffers(_In_ UINT uStartSlot, _In_ UINT uNumBuffers, _In_reads_(uNumBuffers) const ConstantBufferRange* aRanges)
+    {
+        if (updateConstantBufferSlots(m_aPixelConstantBuffers, uStartSlot, uNumBuffers, aRanges))
+        {
+            setPixelConstantBufferRanges(uStartSlot, uNumBuffers, aRanges);
+        }
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   RenderContext::SetPixelShaderResources
+      Summary:  Binds shader resource views to the pixel shader stage
+      Args:     UINT uStartSlot
+                  First shader resource slot
+                UINT uNumViews
+                  Number of views in the array
+                const RenderHandle* aViews
+                  Array of shader resource views
+      Modifies: [m_statistics, m_aPixelShaderResources].
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    void RenderContext::SetPixelShaderResources(_In_ UINT uStartSlot, _In_ UINT uNumViews, _In_reads_(uNumViews) const RenderHandle* aViews)
+    {
+        if (updateSlots(m_aPixelShaderResources, MAX_SHADER_RESOURCES, uStartSlot, uNumViews, aViews))
+        {
+            setPixelShaderResources(uStartSlot, uNumViews, aViews);
+        }
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   RenderContext::SetPixelSamplers
+      Summary:  Binds sampler states to the pixel shader stage
+      Args:     UINT uStartSlot
+                  First sampler slot
+                UINT uNumSamplers
+                  Number of samplers in the array
+                const RenderHandle* aSamplers
+                  Array of sampler states
+      Modifies: [m_statistics, m_aPixelSamplers].
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    void RenderContext::SetPixelSamplers(_In_ UINT uStartSlot, _In_ UINT uNumSamplers, _In_reads_(uNumSamplers) const RenderHandle* aSamplers)
+    {
+        if (updateSlots(m_aPixelSamplers, MAX_SAMPLERS, uStartSlot, uNumSamplers, aSamplers))
+        {
+            setPixelSamplers(uStartSlot, uNumSamplers, aSamplers);
+        }
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   RenderContext::UpdateConstantBuffer
+      Summary:  Uploads the whole contents of a constant buffer
+      Args:     RenderHandle buffer
+                  Constant buffer to update
+                const void* pData
+                  Source data
+                UINT uDataSize
+                  Size of the source data in bytes
+      Modifies: [m_statistics].
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    void RenderContext::UpdateConstantBuffer(_In_ RenderHandle buffer, _In_reads_bytes_(uDataSize) const void* pData, _In_ UINT uDataSize)
+    {
+        ++m_statistics.uNumBufferUpdates;
+        m_statistics.uBytesUploaded += uDataSize;
+        updateConstantBuffer(buffer, pData, uDataSize);
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   RenderContext::MapBuffer
+      Summary:  Maps a dynamic buffer for writing. Only the immediate
+                context may map a buffer
+      Args:     RenderHandle buffer
+                  Dynamic buffer to map
+                eMapMode mode
+                  Whether the previous contents are discarded
+                UINT uByteWidth
+                  Size of the buffer in bytes
+      Returns:  void*
+                  Start of the buffer, nullptr on failure
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    void* RenderContext::MapBuffer(_In_ RenderHandle buffer, _In_ eMapMode mode, _In_ UINT uByteWidth)
+    {
+        return mapBuffer(buffer, mode, uByteWidth);
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   RenderContext::UnmapBuffer
+      Summary:  Unmaps a buffer mapped by MapBuffer
+      Args:     RenderHandle buffer
+                  Mapped buffer
+                UINT uBytesWritten
+                  Number of bytes written while mapped
+      Modifies: [m_statistics].
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    void RenderContext::UnmapBuffer(_In_ RenderHandle buffer, _In_ UINT uBytesWritten)
+    {
+        ++m_statistics.uNumBufferUpdates;
+        m_statistics.uBytesUploaded += uBytesWritten;
+        unmapBuffer(buffer);
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   RenderContext::CopySubresource
+      Summary:  Copies a whole subresource of a texture, e.g. a slice
+                of a texture array, into a subresource of the same size
+                and format
+      Args:     RenderHandle destination
+                  Texture copied into
+                UINT uDestinationSubresource
+                  Subresource copied into
+                RenderHandle source
+                  Texture copied from
+                UINT uSourceSubresource
+                  Subresource copied from
+      Modifies: [m_statistics].
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    void RenderContext::CopySubresource(_In_ RenderHandle destination, _In_ UINT uDestinationSubresource, _In_ RenderHandle source, _In_ UINT uSourceSubresource)
+    {
+        ++m_statistics.uNumCopies;
+        copySubresource(destination, uDestinationSubresource, source, uSourceSubresource);
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   RenderContext::DrawIndexed
+      Summary:  Draws indexed, non-instanced primitives
+      Args:     UINT uIndexCount
+                  Number of indices to draw
+                UINT uStartIndexLocation
+                  Location of the first index
+                INT iBaseVertexLocation
+                  Value added to each index
+      Modifies: [m_statistics].
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    void RenderContext::DrawIndexed(_In_ UINT uIndexCount, _In_ UINT uStartIndexLocation, _In_ INT iBaseVertexLocation)
+    {
+        ++m_statistics.uNumDrawCalls;
+        ++m_statistics.uNumInstances;
+        m_statistics.uNumIndices += uIndexCount;
+        drawIndexed(uIndexCount, uStartIndexLocation, iBaseVertexLocation);
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   RenderContext::DrawIndexedInstanced
+      Summary:  Draws indexed, instanced primitives
+      Args:     UINT uIndexCountPerInstance
+                  Number of indices of each instance
+                UINT uInstanceCount
+                  Number of instances to draw
+                UINT uStartIndexLocation
+                  Location of the first index
+                INT iBaseVertexLocation
+                  Value added to each index
+                UINT uStartInstanceLocation
+                  Value added to each instance index
+      Modifies: [m_statistics].
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    void RenderContext::DrawIndexedInstanced(_In_ UINT uIndexCountPerInstance, _In_ UINT uInstanceCount, _In_ UINT uStartIndexLocation, _In_ INT iBaseVertexLocation, _In_ UINT uStartInstanceLocation)
+    {
+        ++m_statistics.uNumDrawCalls;
+        m_statistics.uNumInstances += uInstanceCount;
+        m_statistics.uNumIndices += static_cast<UINT64>(uIndexCountPerInstance) * uInstanceCount;
+        drawIndexedInstanced(uIndexCountPerInstance, uInstanceCount, uStartIndexLocation, iBaseVertexLocation, uStartInstanceLocation);
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   RenderContext::FinishCommandList
+      Summary:  Closes the commands recorded so far into a command list.
+                The back end starts the next list from the default
+                pipeline state, so the shadowed state is forgotten
+      Returns:  HRESULT
+                  Status code
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    HRESULT RenderContext::FinishCommandList()
+    {
+        HRESULT hr = finishCommandList();
+
+        InvalidateState();
+
+        return hr;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   RenderContext::ExecuteCommandList
+      Summary:  Plays back the command list finished on a deferred
+                context and takes over its statistics. Executing a
+                command list leaves this context in the default
+                pipeline state
+      Args:     RenderContext& deferredContext
+                  Context the command list was recorded on
+      Modifies: [m_statistics].
+      Returns:  HRESULT
+                  Status code
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    HRESULT RenderContext::ExecuteCommandList(_In_ RenderContext& deferredContext)
+    {
+        HRESULT hr = executeCommandList(deferredContext);
+
+        const RenderStatistics& recorded = deferredContext.m_statistics;
+        m_statistics.uNumDrawCalls += recorded.uNumDrawCalls;
+        m_statistics.uNumInstances += recorded.uNumInstances;
+        m_statistics.uNumIndices += recorded.uNumIndices;
+        m_statistics.uNumStateChanges += recorded.uNumStateChanges;
+        m_statistics.uNumRedundantStateChanges += recorded.uNumRedundantStateChanges;
+        m_statistics.uNumBufferUpdates += recorded.uNumBufferUpdates;
+        m_statistics.uBytesUploaded += recorded.uBytesUploaded;
+        m_statistics.uNumClears += recorded.uNumClears;
+        m_statistics.uNumCopies += recorded.uNumCopies;
+        deferredContext.ResetStatistics();
+
+        InvalidateState();
+
+        return hr;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   RenderContext::SignalFence
+      Summary:  Inserts a fence after the commands recorded so far,
+                only on the immediate context
+      Args:     UINT64 uFenceValue
+                  Value reported once the GPU reaches the fence,
+                  increasing from fence to fence
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    void RenderContext::SignalFence(_In_ UINT64 uFenceValue)
+    {
+        signalFence(uFenceValue);
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   RenderContext::GetCompletedFenceValue
+      Summary:  Polls the fences without waiting for the GPU
+      Returns:  UINT64
+                  Value of the last fence the GPU reached, 0 if none
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    UINT64 RenderContext::GetCompletedFenceValue()
+    {
+        return getCompletedFenceValue();
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   RenderContext::CreateTimestampQueries
+      Summary:  Creates the sets of timestamp queries, only on the
+                immediate context. Sets are filled and read back in
+                turns so that a set is read while the next ones fill
+      Args:     UINT uNumQuerySets
+                  Number of sets
+                UINT uNumTimestamps
+                  Number of timestamps of every set
+      Returns:  HRESULT
+                  Status code
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    HRESULT RenderContext::CreateTimestampQueries(_In_ UINT uNumQuerySets, _In_ UINT uNumTimestamps)
+    {
+        return createTimestampQueries(uNumQuerySets, uNumTimestamps);
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   RenderContext::BeginTimestampQueries
+      Summary:  Starts filling a set of timestamp queries. The
+                timestamps written until the set ends share a
+                frequency
+      Args:     UINT uQuerySet
+                  Index of the set
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    void RenderContext::BeginTimestampQueries(_In_ UINT uQuerySet)
+    {
+        beginTimestampQueries(uQuerySet);
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   RenderContext::WriteTimestamp
+      Summary:  Records the GPU time once the commands issued so far
+                are done
+      Args:     UINT uQuerySet
+                  Index of the set being filled
+                UINT uTimestamp
+                  Index of the timestamp in the set
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    void RenderContext::WriteTimestamp(_In_ UINT uQuerySet, _In_ UINT uTimestamp)
+    {
+        writeTimestamp(uQuerySet, uTimestamp);
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   RenderContext::EndTimestampQueries
+      Summary:  Stops filling a set of timestamp queries
+      Args:     UINT uQuerySet
+                  Index of the set
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    void RenderContext::EndTimestampQueries(_In_ UINT uQuerySet)
+    {
+        endTimestampQueries(uQuerySet);
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   RenderContext::GetTimestampQueryData
+      Summary:  Reads the timestamps of a set back without waiting for
+                the GPU
+      Args:     UINT uQuerySet
+                  Index of the set
+                UINT uNumTimestamps
+                  Number of timestamps written into the set
+                UINT64* auTimestamps
+                  Receives the timestamps, in ticks
+                UINT64* puFrequency
+                  Receives the ticks per second, 0 when the timestamps
+                  of the set are unreliable
+      Returns:  BOOL
+                  FALSE if the GPU has not reached the end of the set
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    BOOL RenderContext::GetTimestampQueryData(_In_ UINT uQuerySet, _In_ UINT uNumTimestamps, _Out_writes_(uNumTimestamps) UINT64* auTimestamps, _Out_ UINT64* puFrequency)
+    {
+        return getTimestampQueryData(uQuerySet, uNumTimestamps, auTimestamps, puFrequency);
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   RenderContext::InvalidateState
+      Summary:  Forgets the shadowed pipeline state. Must be called
+                whenever the device context is touched behind the back
+                of this render context
+      Modifies: [m_aRenderTargetViews, m_depthStencilView,
+                 m_uNumRenderTargetViews, m_aVertexBuffers,
+                 m_auVertexStrides, m_auVertexOffsets, m_viewportWidth,
+                 m_viewportHeight, m_topology, m_indexBuffer,
+                 m_uIndexOffset, m_inputLayout, m_vertexShader,
+                 m_pixelShader, m_aVertexConstantBuffers,
+                 m_aPixelConstantBuffers, m_aPixelShaderResources,
+                 m_aPixelSamplers].
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    void RenderContext::InvalidateState()
+    {
+        const RenderHandle invalid = invalidHandle();
+
+        for (UINT i = 0u; i < MAX_RENDER_TARGETS; ++i)
+        {
+            m_aRenderTargetViews[i] = invalid;
+        }
+        m_depthStencilView = invalid;
+        m_uNumRenderTargetViews = MAX_RENDER_TARGETS + 1u;
+
+        for (UINT i = 0u; i < MAX_VERTEX_BUFFERS; ++i)
+        {
+            m_aVertexBuffers[i] = invalid;
+            m_auVertexStrides[i] = 0u;
+            m_auVertexOffsets[i] = 0u;
+        }
+        m_viewportWidth = -1.0f;
+        m_viewportHeight = -1.0f;
+        m_topology = ePrimitiveTopology::COUNT;
+        m_indexBuffer = invalid;
+        m_uIndexOffset = 0u;
+        m_inputLayout = invalid;
+        m_vertexShader = invalid;
+        m_pixelShader = invalid;
+
+        for (UINT i = 0u; i < MAX_CONSTANT_BUFFERS; ++i)
+        {
+            m_aVertexConstantBuffers[i] = { .buffer = invalid, .uFirstConstant = 0u, .uNumConstants = 0u };
+            m_aPixelConstantBuffers[i] = { .buffer = invalid, .uFirstConstant = 0u, .uNumConstants = 0u };
+        }
+        for (UINT i = 0u; i < MAX_SHADER_RESOURCES; ++i)
+        {
+            m_aPixelShaderResources[i] = invalid;
+        }
+        for (UINT i = 0u; i < MAX_SAMPLERS; ++i)
+        {
+            m_aPixelSamplers[i] = invalid;
+        }
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   RenderContext::GetStatistics
+      Summary:  Returns the statistics recorded since the last reset
+      Returns:  const RenderStatistics&
+                  The statistics
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    const RenderStatistics& RenderContext::GetStatistics() const
+    {
+        return m_statistics;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   RenderContext::ResetStatistics
+      Summary:  Zeroes the statistics
+      Modifies: [m_statistics].
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    void RenderContext::ResetStatistics()
+    {
+        m_statistics = RenderStatistics();
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   RenderContext::updateSlots
+      Summary:  Compares a range of bindings against the shadowed
+                slots, stores them and counts the state change
+      Args:     RenderHandle* aShadow
+                  Shadowed slots of the stage
+                UINT uMaxSlots
+                  Number of shadowed slots
+                UINT uStartSlot
+                  First slot to bind
+                UINT uNumSlots
+                  Number of slots to bind
+                const RenderHandle* aHandles
+                  Handles to bind
+      Modifies: [m_statistics].
+      Returns:  BOOL
+                  TRUE if any slot changed and the bind must be
+                  forwarded to the back end
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    BOOL RenderContext::updateSlots(_Inout_ RenderHandle* aShadow, _In_ UINT uMaxSlots, _In_ UINT uStartSlot, _In_ UINT uNumSlots, _In_reads_(uNumSlots) const RenderHandle* aHandles)
+    {
+        assert(uStartSlot + uNumSlots <= uMaxSlots);
+        (void)uMaxSlots;
+
+        BOOL bChanged = FALSE;
+        for (UINT i = 0u; i < uNumSlots; ++i)
+        {
+            if (aShadow[uStartSlot + i] != aHandles[i])
+            {
+                aShadow[uStartSlot + i] = aHandles[i];
+                bChanged = TRUE;
+            }
+        }
+
+        if (bChanged)
+        {
+            ++m_statistics.uNumStateChanges;
+        }
+        else
+        {
+            ++m_statistics.uNumRedundantStateChanges;
+        }
+
+        return bChanged;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   RenderContext::updateConstantBufferSlots
+      Summary:  Compares constant buffer ranges against the shadowed
+                ones, stores them and counts the state change
+      Args:     ConstantBufferRange* aShadow
+                  Shadowed ranges of the stage
+                UINT uStartSlot
+                  First slot
+                UINT uNumSlots
+                  Number of ranges
+                const ConstantBufferRange* aRanges
+                  Ranges to bind
+      Modifies: [m_statistics].
+      Returns:  BOOL
+                  TRUE when at least one slot changed
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    BOOL RenderContext::updateConstantBufferSlots(_Inout_ ConstantBufferRange* aShadow, _In_ UINT uStartSlot, _In_ UINT uNumSlots, _In_reads_(uNumSlots) const ConstantBufferRange* aRanges)
+    {
+        assert(uStartSlot + uNumSlots <= MAX_CONSTANT_BUFFERS);
+
+        BOOL bChanged = FALSE;
+        for (UINT i = 0u; i < uNumSlots; ++i)
+        {
+            ConstantBufferRange& shadow = aShadow[uStartSlot + i];
+            if (shadow.buffer != aRanges[i].buffer || shadow.uFirstConstant != aRanges[i].uFirstConstant || shadow.uNumConstants != aRanges[i].uNumConstants)
+            {
+                shadow = aRanges[i];
+                bChanged = TRUE;
+            }
+        }
+
+        if (bChanged)
+        {
+            ++m_statistics.uNumStateChanges;
+        }
+        else
+        {
+            ++m_statistics.uNumRedundantStateChanges;
+        }
+
+        return bChanged;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   RenderContext::updateState
+      Summary:  Compares a single binding against its shadow, stores it
+                and counts the state change
+      Args:     RenderHandle& shadow
+                  Shadowed binding
+                RenderHandle handle
+                  Handle to bind
+      Modifies: [m_statistics].
+      Returns:  BOOL
+                  TRUE if the binding changed
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    BOOL RenderContext::updateState(_Inout_ RenderHandle& shadow, _In_ RenderHandle handle)
+    {
+        return updateSlots(&shadow, 1u, 0u, 1u, &handle);
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   RenderContext::invalidHandle
+      Summary:  Returns a handle no back-end object can ever have, used
+                to mark shadowed slots as unknown
+      Returns:  RenderHandle
+                  The invalid handle
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    RenderHandle RenderContext::invalidHandle()
+    {
+        return reinterpret_cast<RenderHandle>(~static_cast<uintptr_t>(0u));
+    }
+}
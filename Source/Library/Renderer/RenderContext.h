@@ -0,0 +1,308 @@
+﻿/*+===================================================================
+  File:      RENDERCONTEXT.H
+
+  Summary:   RenderContext header file contains declarations of the
+             RenderContext class, the back-end agnostic interface the
+             renderer records its pipeline state changes, buffer
+             updates and draw calls into.
+
+  Classes: RenderContext
+
+  © 2022 Kyung Hee University
+===================================================================+*/
+#pragma once
+
+#include "Common.h"
+
+namespace library
+{
+    /*T+T+++T+++T+++T+++T+++T+++T+++T+++T+++T+++T+++T+++T+++T+++T+++T+++T
+      Type:     RenderHandle
+
+      Summary:  Opaque handle to a back-end object (buffer, view,
+                shader, sampler, input layout). The Direct3D back end
+                stores the raw interface pointer in it
+    T---T---T---T---T---T---T---T---T---T---T---T---T---T---T---T---T-T*/
+    using RenderHandle = const void*;
+
+    /*E+E+++E+++E+++E+++E+++E+++E+++E+++E+++E+++E+++E+++E+++E+++E+++E+++E
+      Enum:     eIndexFormat
+
+      Summary:  Enumeration of index buffer formats
+    E---E---E---E---E---E---E---E---E---E---E---E---E---E---E---E---E-E*/
+    enum class eIndexFormat : UINT
+    {
+        R16_UINT = 0,
+        R32_UINT,
+        COUNT,
+    };
+
+    /*E+E+++E+++E+++E+++E+++E+++E+++E+++E+++E+++E+++E+++E+++E+++E+++E+++E
+      Enum:     ePrimitiveTopology
+
+      Summary:  Enumeration of primitive topologies
+    E---E---E---E---E---E---E---E---E---E---E---E---E---E---E---E---E-E*/
+    enum class ePrimitiveTopology : UINT
+    {
+        TRIANGLE_LIST = 0,
+        COUNT,
+    };
+
+    /*E+E+++E+++E+++E+++E+++E+++E+++E+++E+++E+++E+++E+++E+++E+++E+++E+++E
+      Enum:     eMapMode
+
+      Summary:  Enumeration of the ways a dynamic buffer is mapped for
+                writing. DISCARD hands out fresh memory, the previous
+                contents are lost; NO_OVERWRITE keeps them and promises
+                not to touch what the GPU may still read
+    E---E---E---E---E---E---E---E---E---E---E---E---E---E---E---E---E-E*/
+    enum class eMapMode : UINT
+    {
+        WRITE_DISCARD = 0,
+        WRITE_NO_OVERWRITE,
+        COUNT,
+    };
+
+    /*S+S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S
+      Struct:   ConstantBufferRange
+
+      Summary:  Part of a constant buffer bound to a slot, in shader
+                constants of 16 bytes. uFirstConstant and uNumConstants
+                are multiples of 16, a uNumConstants of 0 binds the
+                whole buffer
+    S---S---S---S---S---S---S---S---S---S---S---S---S---S---S---S---S-S*/
+    struct ConstantBufferRange
+    {
+        RenderHandle buffer;
+        UINT uFirstConstant;
+        UINT uNumConstants;
+    };
+
+    /*S+S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S
+      Struct:   RenderStatistics
+
+      Summary:  Counters every render context keeps about the commands
+                recorded since the last reset
+    S---S---S---S---S---S---S---S---S---S---S---S---S---S---S---S---S-S*/
+    struct RenderStatistics
+    {
+        UINT uNumDrawCalls;
+        UINT uNumInstances;
+        UINT64 uNumIndices;
+        UINT uNumStateChanges;
+        UINT uNumRedundantStateChanges;
+        UINT uNumBufferUpdates;
+        UINT64 uBytesUploaded;
+        UINT uNumClears;
+        UINT uNumCopies;
+    };
+
+    /*C+C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C
+      Class:    RenderContext
+
+      Summary:  Abstract command recording interface. Public methods
+                shadow the bound pipeline state, drop redundant state
+                changes, update the statistics and forward the rest
+                to the back-end specific virtual functions
+
+      Methods:  ClearRenderTarget
+                  Clears a render target view
+                ClearDepthStencil
+                  Clears the depth of a depth stencil view
+                SetRenderTargets
+                  Binds render targets and a depth stencil view
+                SetViewport
+                  Sets the rasterizer viewport
+                SetPrimitiveTopology
+                  Sets the input assembler primitive topology
+                SetVertexBuffers
+                  Binds vertex buffers to the input assembler
+                SetIndexBuffer
+                  Binds an index buffer to the input assembler
+                SetInputLayout
+                  Binds an input layout to the input assembler
+                SetVertexShader
+                  Binds a vertex shader
+                SetPixelShader
+                  Binds a pixel shader
+                SetVertexConstantBuffers
+                  Binds constant buffers, or ranges of them, to the
+                  vertex shader stage
+                SetPixelConstantBuffers
+                  Binds constant buffers, or ranges of them, to the
+                  pixel shader stage
+                SetPixelShaderResources
+                  Binds shader resource views to the pixel shader
+                SetPixelSamplers
+                  Binds sampler states to the pixel shader
+                UpdateConstantBuffer
+                  Uploads the whole contents of a constant buffer
+                MapBuffer
+                  Maps a dynamic buffer for writing
+                UnmapBuffer
+                  Unmaps a dynamic buffer and counts the bytes written
+                CopySubresource
+                  Copies a subresource of a texture into another
+                DrawIndexed
+                  Draws indexed, non-instanced primitives
+                DrawIndexedInstanced
+                  Draws indexed, instanced primitives
+                FinishCommandList
+                  Closes the commands recorded so far into a command
+                  list that can be executed on another context
+                ExecuteCommandList
+                  Plays back the command list of a deferred context
+                  and merges its statistics
+                SignalFence
+                  Signals a fence value once the GPU reaches it
+                GetCompletedFenceValue
+                  Returns the last fence value the GPU reached
+                CreateTimestampQueries
+                  Creates sets of GPU timestamp queries
+                BeginTimestampQueries
+                  Starts filling a set of timestamp queries
+                WriteTimestamp
+                  Records a GPU timestamp into a set
+                EndTimestampQueries
+                  Stops filling a set of timestamp queries
+                GetTimestampQueryData
+                  Reads a filled set back without waiting
+                InvalidateState
+                  Forgets the shadowed state so that the next binds
+                  are always forwarded
+                GetStatistics
+                  Returns the statistics recorded since the last reset
+                ResetStatistics
+                  Zeroes the statistics
+                RenderContext
+                  Constructor.
+                ~RenderContext
+                  Destructor.
+    C---C---C---C---C---C---C---C---C---C---C---C---C---C---C---C---C-C*/
+    class RenderContext
+    {
+    public:
+        static constexpr UINT MAX_RENDER_TARGETS = 8u;
+        static constexpr UINT MAX_VERTEX_BUFFERS = 16u;
+        static constexpr UINT MAX_CONSTANT_BUFFERS = 14u;
+        static constexpr UINT MAX_SHADER_RESOURCES = 16u;
+        static constexpr UINT MAX_SAMPLERS = 16u;
+        static constexpr UINT CONSTANT_BUFFER_ALIGNMENT = 256u;
+        static constexpr UINT CONSTANT_SIZE = 16u;
+
+    public:
+        RenderContext();
+        RenderContext(const RenderContext& other) = delete;
+        RenderContext(RenderContext&& other) = delete;
+        RenderContext& operator=(const RenderContext& other) = delete;
+        RenderContext& operator=(RenderContext&& other) = delete;
+        virtual ~RenderContext() = default;
+
+        void ClearRenderTarget(_In_ RenderHandle renderTargetView, _In_ const FLOAT aColor[4]);
+        void ClearDepthStencil(_In_ RenderHandle depthStencilView, _In_ FLOAT depth);
+        void SetRenderTargets(_In_ UINT uNumViews, _In_reads_(uNumViews) const RenderHandle* aRenderTargetViews, _In_opt_ RenderHandle depthStencilView);
+        void SetViewport(_In_ FLOAT width, _In_ FLOAT height);
+        void SetPrimitiveTopology(_In_ ePrimitiveTopology topology);
+
+        void SetVertexBuffers(_In_ UINT uStartSlot, _In_ UINT uNumBuffers, _In_reads_(uNumBuffers) const RenderHandle* aBuffers, _In_reads_(uNumBuffers) const UINT* aStrides, _In_reads_(uNumBuffers) const UINT* aOffsets);
+        void SetIndexBuffer(_In_ RenderHandle indexBuffer, _In_ eIndexFormat format, _In_ UINT uOffset);
+        void SetInputLayout(_In_ RenderHandle inputLayout);
+
+        void SetVertexShader(_In_ RenderHandle vertexShader);
+        void SetPixelShader(_In_ RenderHandle pixelShader);
+        void SetVertexConstantBuffers(_In_ UINT uStartSlot, _In_ UINT uNumBuffers, _In_reads_(uNumBuffers) const RenderHandle* aBuffers);
+        void SetPixelConstantBuffers(_In_ UINT uStartSlot, _In_ UINT uNumBuffers, _In_reads_(uNumBuffers) const RenderHandle* aBuffers);
+        void SetVertexConstantBuffers(_In_ UINT uStartSlot, _In_ UINT uNumBuffers, _In_reads_(uNumBuffers) const ConstantBufferRange* aRanges);
+        void SetPixelConstantBuffers(_In_ UINT uStartSlot, _In_ UINT uNumBuffers, _In_reads_(uNumBuffers) const ConstantBufferRange* aRanges);
+        void SetPixelShaderResources(_In_ UINT uStartSlot, _In_ UINT uNumViews, _In_reads_(uNumViews) const RenderHandle* aViews);
+        void SetPixelSamplers(_In_ UINT uStartSlot, _In_ UINT uNumSamplers, _In_reads_(uNumSamplers) const RenderHandle* aSamplers);
+
+        void UpdateConstantBuffer(_In_ RenderHandle buffer, _In_reads_bytes_(uDataSize) const void* pData, _In_ UINT uDataSize);
+        void* MapBuffer(_In_ RenderHandle buffer, _In_ eMapMode mode, _In_ UINT uByteWidth);
+        void UnmapBuffer(_In_ RenderHandle buffer, _In_ UINT uBytesWritten);
+        void CopySubresource(_In_ RenderHandle destination, _In_ UINT uDestinationSubresource, _In_ RenderHandle source, _In_ UINT uSourceSubresource);
+
+        void DrawIndexed(_In_ UINT uIndexCount, _In_ UINT uStartIndexLocation, _In_ INT iBaseVertexLocation);
+        void DrawIndexedInstanced(_In_ UINT uIndexCountPerInstance, _In_ UINT uInstanceCount, _In_ UINT uStartIndexLocation, _In_ INT iBaseVertexLocation, _In_ UINT uStartInstanceLocation);
+
+        HRESULT FinishCommandList();
+        HRESULT ExecuteCommandList(_In_ RenderContext& deferredContext);
+
+        void SignalFence(_In_ UINT64 uFenceValue);
+        UINT64 GetCompletedFenceValue();
+
+        HRESULT CreateTimestampQueries(_In_ UINT uNumQuerySets, _In_ UINT uNumTimestamps);
+        void BeginTimestampQueries(_In_ UINT uQuerySet);
+        void WriteTimestamp(_In_ UINT uQuerySet, _In_ UINT uTimestamp);
+        void EndTimestampQueries(_In_ UINT uQuerySet);
+        BOOL GetTimestampQueryData(_In_ UINT uQuerySet, _In_ UINT uNumTimestamps, _Out_writes_(uNumTimestamps) UINT64* auTimestamps, _Out_ UINT64* puFrequency);
+
+        void InvalidateState();
+
+        const RenderStatistics& GetStatistics() const;
+        void ResetStatistics();
+
+    protected:
+        virtual void clearRenderTarget(_In_ RenderHandle renderTargetView, _In_ const FLOAT aColor[4]) = 0;
+        virtual void clearDepthStencil(_In_ RenderHandle depthStencilView, _In_ FLOAT depth) = 0;
+        virtual void setRenderTargets(_In_ UINT uNumViews, _In_reads_(uNumViews) const RenderHandle* aRenderTargetViews, _In_opt_ RenderHandle depthStencilView) = 0;
+        virtual void setViewport(_In_ FLOAT width, _In_ FLOAT height) = 0;
+        virtual void setPrimitiveTopology(_In_ ePrimitiveTopology topology) = 0;
+        virtual void setVertexBuffers(_In_ UINT uStartSlot, _In_ UINT uNumBuffers, _In_reads_(uNumBuffers) const RenderHandle* aBuffers, _In_reads_(uNumBuffers) const UINT* aStrides, _In_reads_(uNumBuffers) const UINT* aOffsets) = 0;
+        virtual void setIndexBuffer(_In_ RenderHandle indexBuffer, _In_ eIndexFormat format, _In_ UINT uOffset) = 0;
+        virtual void setInputLayout(_In_ RenderHandle inputLayout) = 0;
+        virtual void setVertexShader(_In_ RenderHandle vertexShader) = 0;
+        virtual void setPixelShader(_In_ RenderHandle pixelShader) = 0;
+        virtual void setVertexConstantBuffers(_In_ UINT uStartSlot, _In_ UINT uNumBuffers, _In_reads_(uNumBuffers) const RenderHandle* aBuffers) = 0;
+        virtual void setPixelConstantBuffers(_In_ UINT uStartSlot, _In_ UINT uNumBuffers, _In_reads_(uNumBuffers) const RenderHandle* aBuffers) = 0;
+        virtual void setVertexConstantBufferRanges(_In_ UINT uStartSlot, _In_ UINT uNumBuffers, _In_reads_(uNumBuffers) const ConstantBufferRange* aRanges) = 0;
+        virtual void setPixelConstantBufferRanges(_In_ UINT uStartSlot, _In_ UINT uNumBuffers, _In_reads_(uNumBuffers) const ConstantBufferRange* aRanges) = 0;
+        virtual void setPixelShaderResources(_In_ UINT uStartSlot, _In_ UINT uNumViews, _In_reads_(uNumViews) const RenderHandle* aViews) = 0;
+        virtual void setPixelSamplers(_In_ UINT uStartSlot, _In_ UINT uNumSamplers, _In_reads_(uNumSamplers) const RenderHandle* aSamplers) = 0;
+        virtual void updateConstantBuffer(_In_ RenderHandle buffer, _In_reads_bytes_(uDataSize) const void* pData, _In_ UINT uDataSize) = 0;
+        virtual void* mapBuffer(_In_ RenderHandle buffer, _In_ eMapMode mode, _In_ UINT uByteWidth) = 0;
+        virtual void unmapBuffer(_In_ RenderHandle buffer) = 0;
+        virtual void copySubresource(_In_ RenderHandle destination, _In_ UINT uDestinationSubresource, _In_ RenderHandle source, _In_ UINT uSourceSubresource) = 0;
+        virtual void drawIndexed(_In_ UINT uIndexCount, _In_ UINT uStartIndexLocation, _In_ INT iBaseVertexLocation) = 0;
+        virtual void drawIndexedInstanced(_In_ UINT uIndexCountPerInstance, _In_ UINT uInstanceCount, _In_ UINT uStartIndexLocation, _In_ INT iBaseVertexLocation, _In_ UINT uStartInstanceLocation) = 0;
+        virtual HRESULT finishCommandList() = 0;
+        virtual HRESULT executeCommandList(_In_ RenderContext& deferredContext) = 0;
+        virtual void signalFence(_In_ UINT64 uFenceValue) = 0;
+        virtual UINT64 getCompletedFenceValue() = 0;
+        virtual HRESULT createTimestampQueries(_In_ UINT uNumQuerySets, _In_ UINT uNumTimestamps) = 0;
+        virtual void beginTimestampQueries(_In_ UINT uQuerySet) = 0;
+        virtual void writeTimestamp(_In_ UINT uQuerySet, _In_ UINT uTimestamp) = 0;
+        virtual void endTimestampQueries(_In_ UINT uQuerySet) = 0;
+        virtual BOOL getTimestampQueryData(_In_ UINT uQuerySet, _In_ UINT uNumTimestamps, _Out_writes_(uNumTimestamps) UINT64* auTimestamps, _Out_ UINT64* puFrequency) = 0;
+
+    protected:
+        RenderStatistics m_statistics;
+
+    private:
+        BOOL updateSlots(_Inout_ RenderHandle* aShadow, _In_ UINT uMaxSlots, _In_ UINT uStartSlot, _In_ UINT uNumSlots, _In_reads_(uNumSlots) const RenderHandle* aHandles);
+        BOOL updateState(_Inout_ RenderHandle& shadow, _In_ RenderHandle handle);
+        BOOL updateConstantBufferSlots(_Inout_ ConstantBufferRange* aShadow, _In_ UINT uStartSlot, _In_ UINT uNumSlots, _In_reads_(uNumSlots) const ConstantBufferRange* aRanges);
+
+        static RenderHandle invalidHandle();
+
+        RenderHandle m_aRenderTargetViews[MAX_RENDER_TARGETS];
+        RenderHandle m_depthStencilView;
+        UINT m_uNumRenderTargetViews;
+        RenderHandle m_aVertexBuffers[MAX_VERTEX_BUFFERS];
+        UINT m_auVertexStrides[MAX_VERTEX_BUFFERS];
+        UINT m_auVertexOffsets[MAX_VERTEX_BUFFERS];
+        FLOAT m_viewportWidth;
+        FLOAT m_viewportHeight;
+        ePrimitiveTopology m_topology;
+        RenderHandle m_indexBuffer;
+        eIndexFormat m_indexFormat;
+        UINT m_uIndexOffset;
+        RenderHandle m_inputLayout;
+        RenderHandle m_vertexShader;
+        RenderHandle m_pixelShader;
+        ConstantBufferRange m_aVertexConstantBuffers[MAX_CONSTANT_BUFFERS];
+        ConstantBufferRange m_aPixelConstantBuffers[MAX_CONSTANT_BUFFERS];
+        RenderHandle m_aPixelShaderResources[MAX_SHADER_RESOURCES];
+        RenderHandle m_aPixelSamplers[MAX_SAMPLERS];
+    };
+}
@@ -0,0 +1,191 @@
+#include "Renderer/RenderThreadPool.h"
+
+#include "Profiler/CpuProfiler.h"
+
+namespace library
+{
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   RenderThreadPool::RenderThreadPool
+      Summary:  Constructor
+      Modifies: [m_aWorkers, m_mutex, m_dispatchCondition,
+                  m_completeCondition, m_pTask, m_uNextTask, m_uNumTasks,
+                  m_uNumBusyWorkers, m_uDispatchIndex, m_bShutdown].
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    RenderThreadPool::RenderThreadPool()
+        : m_aWorkers()
+        , m_mutex()
+        , m_dispatchCondition()
+        , m_completeCondition()
+        , m_pTask(nullptr)
+        , m_uNextTask(0u)
+        , m_uNumTasks(0u)
+        , m_uNumBusyWorkers(0u)
+        , m_uDispatchIndex(0u)
+        , m_bShutdown(FALSE)
+    {
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   RenderThreadPool::~RenderThreadPool
+      Summary:  Destructor. Stops and joins the worker threads
+      Modifies: [m_aWorkers, m_bShutdown].
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    RenderThreadPool::~RenderThreadPool()
+    {
+        shutdown();
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   RenderThreadPool::Initialize
+      Summary:  Starts uNumThreads - 1 worker threads, the thread that
+                dispatches is the remaining one. Restarts the pool when
+                it is already running
+      Args:     UINT uNumThreads
+                  Number of threads that execute tasks
+      Modifies: [m_aWorkers, m_uDispatchIndex, m_bShutdown].
+      Returns:  HRESULT
+                  Status code
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    HRESULT RenderThreadPool::Initialize(_In_ UINT uNumThreads)
+    {
+        if (uNumThreads == 0u)
+        {
+            return E_INVALIDARG;
+        }
+
+        shutdown();
+
+        m_bShutdown = FALSE;
+        m_aWorkers.reserve(uNumThreads - 1u);
+        for (UINT i = 1u; i < uNumThreads; ++i)
+        {
+            m_aWorkers.emplace_back(&RenderThreadPool::workerMain, this, m_uDispatchIndex);
+        }
+
+        return S_OK;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   RenderThreadPool::Dispatch
+      Summary:  Executes task(0) .. task(uNumTasks - 1) on the worker
+                threads and the calling thread, and returns when all of
+                them have finished. Must not be called concurrently
+      Args:     UINT uNumTasks
+                  Number of tasks
+                const std::function<void(UINT)>& task
+                  Function called with the index of each task
+      Modifies: [m_pTask, m_uNextTask, m_uNumTasks, m_uNumBusyWorkers,
+                  m_uDispatchIndex].
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    void RenderThreadPool::Dispatch(_In_ UINT uNumTasks, _In_ const std::function<void(UINT)>& task)
+    {
+        if (m_aWorkers.empty() || uNumTasks <= 1u)
+        {
+            for (UINT i = 0u; i < uNumTasks; ++i)
+            {
+                task(i);
+            }
+            return;
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_pTask = &task;
+            m_uNumTasks = uNumTasks;
+            m_uNextTask.store(0u, std::memory_order_relaxed);
+            m_uNumBusyWorkers = static_cast<UINT>(m_aWorkers.size());
+            ++m_uDispatchIndex;
+        }
+        m_dispatchCondition.notify_all();
+
+        runTasks();
+
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_completeCondition.wait(lock, [this] { return m_uNumBusyWorkers == 0u; });
+        m_pTask = nullptr;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   RenderThreadPool::GetNumThreads
+      Summary:  Returns the number of threads that execute tasks
+      Returns:  UINT
+                  Worker threads plus the dispatching thread
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    UINT RenderThreadPool::GetNumThreads() const
+    {
+        return static_cast<UINT>(m_aWorkers.size()) + 1u;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   RenderThreadPool::shutdown
+      Summary:  Wakes the worker threads up to exit and joins them
+      Modifies: [m_aWorkers, m_bShutdown].
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    void RenderThreadPool::shutdown()
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_bShutdown = TRUE;
+        }
+        m_dispatchCondition.notify_all();
+
+        for (std::thread& worker : m_aWorkers)
+        {
+            worker.join();
+        }
+        m_aWorkers.clear();
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   RenderThreadPool::runTasks
+      Summary:  Claims and executes tasks of the current dispatch until
+                none are left
+      Modifies: [m_uNextTask].
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    void RenderThreadPool::runTasks()
+    {
+        for (UINT uTask = m_uNextTask.fetch_add(1u, std::memory_order_relaxed); uTask < m_uNumTasks;
+            uTask = m_uNextTask.fetch_add(1u, std::memory_order_relaxed))
+        {
+            (*m_pTask)(uTask);
+        }
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   RenderThreadPool::workerMain
+      Summary:  Entry point of a worker thread. Waits for a dispatch,
+                helps executing it and reports back
+      Args:     UINT64 uDispatchIndex
+                  Index of the last dispatch the worker has seen
+      Modifies: [m_uNumBusyWorkers].
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    void RenderThreadPool::workerMain(_In_ UINT64 uDispatchIndex)
+    {
+        PROFILE_THREAD_NAME("Render worker");
+
+        for (;;)
+        {
+            {
+                std::unique_lock<std::mutex> lock(m_mutex);
+                m_dispatchCondition.wait(lock, [this, uDispatchIndex] { return m_bShutdown || m_uDispatchIndex != uDispatchIndex; });
+                if (m_bShutdown)
+                {
+                    return;
+                }
+                uDispatchIndex = m_uDispatchIndex;
+            }
+
+            runTasks();
+
+            BOOL bLastWorker = FALSE;
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                bLastWorker = --m_uNumBusyWorkers == 0u;
+            }
+            if (bLastWorker)
+            {
+                m_completeCondition.notify_one();
+            }
+        }
+    }
+}
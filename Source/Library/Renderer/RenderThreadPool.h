@@ -0,0 +1,74 @@
+﻿/*+===================================================================
+  File:      RENDERTHREADPOOL.H
+
+  Summary:   RenderThreadPool header file contains declarations of the
+             RenderThreadPool class, a small pool of persistent worker
+             threads the renderer records command lists with.
+
+  Classes: RenderThreadPool
+
+  © 2022 Kyung Hee University
+===================================================================+*/
+#pragma once
+
+#include "Common.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+namespace library
+{
+    /*C+C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C
+      Class:    RenderThreadPool
+
+      Summary:  Persistent worker threads that execute the tasks of a
+                dispatch together with the calling thread. Tasks are
+                handed out in index order, a dispatch returns once
+                every task has finished
+
+      Methods:  Initialize
+                  Starts the worker threads
+                Dispatch
+                  Runs tasks [0, uNumTasks) and waits for them
+                GetNumThreads
+                  Returns the number of threads that execute tasks,
+                  the calling thread included
+                RenderThreadPool
+                  Constructor.
+                ~RenderThreadPool
+                  Destructor.
+    C---C---C---C---C---C---C---C---C---C---C---C---C---C---C---C---C-C*/
+    class RenderThreadPool final
+    {
+    public:
+        RenderThreadPool();
+        RenderThreadPool(const RenderThreadPool& other) = delete;
+        RenderThreadPool(RenderThreadPool&& other) = delete;
+        RenderThreadPool& operator=(const RenderThreadPool& other) = delete;
+        RenderThreadPool& operator=(RenderThreadPool&& other) = delete;
+        ~RenderThreadPool();
+
+        HRESULT Initialize(_In_ UINT uNumThreads);
+        void Dispatch(_In_ UINT uNumTasks, _In_ const std::function<void(UINT)>& task);
+        UINT GetNumThreads() const;
+
+    private:
+        void shutdown();
+        void runTasks();
+        void workerMain(_In_ UINT64 uDispatchIndex);
+
+        std::vector<std::thread> m_aWorkers;
+        std::mutex m_mutex;
+        std::condition_variable m_dispatchCondition;
+        std::condition_variable m_completeCondition;
+        const std::function<void(UINT)>* m_pTask;
+        std::atomic<UINT> m_uNextTask;
+        UINT m_uNumTasks;
+        UINT m_uNumBusyWorkers;
+        UINT64 m_uDispatchIndex;
+        BOOL m_bShutdown;
+    };
+}
@@ -15,8 +15,8 @@ namespace library
                   Default color to shader the renderable
       Modifies: [m_vertexBuffer, m_indexBuffer, m_constantBuffer,
                  m_normalBuffer, m_aMeshes, m_aMaterials, m_vertexShader,
-                 m_pixelShader, m_outputColor, m_world, m_bHasNormalMap
-                 m_aNormalData].
+                 m_pixelShader, m_outputColor, m_world, m_previousWorld,
+                 m_bHasNormalMap, m_bShadowReceiver, m_aNormalData, m_bounds].
     M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
 
     Renderable::Renderable(_In_ const XMFLOAT4& outputColor)
@@ -29,10 +29,13 @@ namespace library
         m_vertexShader(nullptr),
         m_pixelShader(nullptr),
         m_world(XMMatrixIdentity()),
+        m_previousWorld(XMMatrixIdentity()),
         m_outputColor(outputColor),
         m_bHasNormalMap(FALSE),
+        m_bShadowReceiver(TRUE),
         m_aNormalData(std::vector<NormalData>()),
-        m_padding()
+        m_padding(),
+        m_bounds()
     {
     }
 
@@ -55,6 +58,17 @@ namespace library
     {
         HRESULT hr = S_OK;
 
+        // A headless renderer has no device, only the CPU side data is built
+        if (!pDevice)
+        {
+            if (m_aNormalData.empty())
+            {
+                calculateNormalMapVectors();
+            }
+
+            return S_OK;
+        }
+
         // Create Vertex Buffer
 
         D3D11_BUFFER_DESC vertex_bd =
@@ -346,39 +360,42 @@ namespace library
 
     /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
       Method:   Renderable::GetVertexShader
-      Summary:  Returns the vertex shader
+      Summary:  Returns the permutation of the vertex shader drawing
+                the features of the renderable
       Returns:  ComPtr<ID3D11VertexShader>&
                   Vertex shader. Could be a nullptr
     M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
     
     ComPtr<ID3D11VertexShader>& Renderable::GetVertexShader()
     {
-        return m_vertexShader->GetVertexShader();
+        return m_vertexShader->GetVertexShader(GetShaderFeatures());
     }
 
 
     /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
       Method:   Renderable::GetPixelShader
-      Summary:  Returns the vertex shader
+      Summary:  Returns the permutation of the pixel shader drawing
+                the features of the renderable
       Returns:  ComPtr<ID3D11PixelShader>&
                   Pixel shader. Could be a nullptr
     M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
     
     ComPtr<ID3D11PixelShader>& Renderable::GetPixelShader()
     {
-        return m_pixelShader->GetPixelShader();
+        return m_pixelShader->GetPixelShader(GetShaderFeatures());
     }
 
     /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
       Method:   Renderable::GetVertexLayout
-      Summary:  Returns the vertex input layout
+      Summary:  Returns the vertex input layout of the permutation of
+                the vertex shader drawing the renderable
       Returns:  ComPtr<ID3D11InputLayout>&
                   Vertex input layout
     M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
     
     ComPtr<ID3D11InputLayout>& Renderable::GetVertexLayout()
     {
-        return m_vertexShader->GetVertexLayout();
+        return m_vertexShader->GetVertexLayout(GetShaderFeatures());
     }
 
     /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
@@ -441,6 +458,56 @@ namespace library
         return m_world;
     }
 
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   Renderable::GetInterpolatedWorldMatrix
+      Summary:  Returns the world matrix between the one saved before
+                the last simulation step and the current one. Scale and
+                translation are blended linearly, the rotation along
+                the arc between the two. Renderables that did not move
+                skip the decomposition
+      Args:     FLOAT alpha
+                  Blend factor, 0 for the saved state, 1 for the current
+      Returns:  XMMATRIX
+                  World matrix
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+
+    XMMATRIX Renderable::GetInterpolatedWorldMatrix(_In_ FLOAT alpha) const
+    {
+        if (alpha >= 1.0f
+            || (XMVector4Equal(m_world.r[0], m_previousWorld.r[0]) && XMVector4Equal(m_world.r[1], m_previousWorld.r[1])
+                && XMVector4Equal(m_world.r[2], m_previousWorld.r[2]) && XMVector4Equal(m_world.r[3], m_previousWorld.r[3])))
+        {
+            return m_world;
+        }
+
+        XMVECTOR previousScale, previousRotation, previousTranslation;
+        XMVECTOR scale, rotation, translation;
+        if (!XMMatrixDecompose(&previousScale, &previousRotation, &previousTranslation, m_previousWorld)
+            || !XMMatrixDecompose(&scale, &rotation, &translation, m_world))
+        {
+            return m_world;
+        }
+
+        return XMMatrixAffineTransformation(
+            XMVectorLerp(previousScale, scale, alpha),
+            XMVectorZero(),
+            XMQuaternionSlerp(previousRotation, rotation, alpha),
+            XMVectorLerp(previousTranslation, translation, alpha)
+        );
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   Renderable::SaveState
+      Summary:  Keeps the world matrix before a simulation step, the
+                state rendered frames blend from
+      Modifies: [m_previousWorld].
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+
+    void Renderable::SaveState()
+    {
+        m_previousWorld = m_world;
+    }
+
     /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
      Method:   Renderable::GetOutputColor
      Summary:  Returns the output color
@@ -583,6 +650,45 @@ namespace library
         m_world *= XMMatrixTranslationFromVector(offset);
     }
 
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   Renderable::GetBounds
+      Summary:  Returns the bounding box of the renderable in object
+                space, computed when it is initialized
+      Returns:  const AxisAlignedBox&
+                  Object space bounding box
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+
+    const AxisAlignedBox& Renderable::GetBounds() const
+    {
+        return m_bounds;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   Renderable::GetVertices
+      Summary:  Returns the vertices the vertex buffer was created from,
+                used to draw the renderable on the CPU
+      Returns:  const SimpleVertex*
+                  GetNumVertices vertices
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+
+    const SimpleVertex* Renderable::GetVertices() const
+    {
+        return getVertices();
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   Renderable::GetIndices
+      Summary:  Returns the indices the index buffer was created from,
+                used to draw the renderable on the CPU
+      Returns:  const WORD*
+                  GetNumIndices indices
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+
+    const WORD* Renderable::GetIndices() const
+    {
+        return getIndices();
+    }
+
     /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
       Method:   Renderable::GetNumMeshes
       Summary:  Returns the number of meshes
@@ -617,4 +723,54 @@ namespace library
     {
         return m_bHasNormalMap;
     }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   Renderable::GetShaderFeatures
+      Summary:  Returns the shader features the renderable is drawn
+                with. They follow from its materials once loaded, so
+                the permutations of its shaders never branch on them
+      Returns:  UINT
+                  Mask of eShaderFeature
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+
+    UINT Renderable::GetShaderFeatures() const
+    {
+        UINT uFeatures = 0u;
+        if (m_bHasNormalMap)
+        {
+            uFeatures |= GetShaderFeatureMask(eShaderFeature::NORMAL_MAP);
+        }
+        if (m_bShadowReceiver)
+        {
+            uFeatures |= GetShaderFeatureMask(eShaderFeature::SHADOW_RECEIVER);
+        }
+
+        return uFeatures;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   Renderable::SetShadowReceiver
+      Summary:  Sets whether shadows are cast on the renderable
+      Args:     BOOL bShadowReceiver
+                  TRUE to draw it with the permutations sampling the
+                  shadow maps
+      Modifies: [m_bShadowReceiver].
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+
+    void Renderable::SetShadowReceiver(_In_ BOOL bShadowReceiver)
+    {
+        m_bShadowReceiver = bShadowReceiver;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   Renderable::IsShadowReceiver
+      Summary:  Returns whether shadows are cast on the renderable
+      Returns:  BOOL
+                  TRUE if it is drawn with the shadow maps
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+
+    BOOL Renderable::IsShadowReceiver() const
+    {
+        return m_bShadowReceiver;
+    }
 }
\ No newline at end of file
@@ -14,6 +14,7 @@
 #include "Common.h"
 
 #include "Renderer/DataTypes.h"
+#include "Renderer/FrustumCuller.h"
 #include "Shader/PixelShader.h"
 #include "Shader/VertexShader.h"
 #include "Texture/Material.h"
@@ -39,12 +40,30 @@ namespace library
                   Returns the constant buffer
                 GetWorldMatrix
                   Returns the world matrix
+                GetInterpolatedWorldMatrix
+                  Returns the world matrix between the saved and the
+                  current state
+                SaveState
+                  Keeps the world matrix before a simulation step
+                GetBounds
+                  Returns the object space bounding box
+                GetVertices
+                  Returns the vertices kept on the CPU
+                GetIndices
+                  Returns the indices kept on the CPU
                 GetNumVertices
                   Pure virtual function that returns the number of
                   vertices
                 GetNumIndices
                   Pure virtual function that returns the number of
                   indices
+                GetShaderFeatures
+                  Returns the shader features the renderable is drawn
+                  with, which pick the permutations of its shaders
+                SetShadowReceiver
+                  Sets whether shadows are cast on the renderable
+                IsShadowReceiver
+                  Returns whether shadows are cast on the renderable
                 Renderable
                   Constructor.
                 ~Renderable
@@ -63,6 +82,7 @@ namespace library
                 , uBaseVertex(0u)
                 , uBaseIndex(0u)
                 , uMaterialIndex(INVALID_MATERIAL)
+                , Bounds()
             {
             }
 
@@ -70,6 +90,7 @@ namespace library
             UINT uBaseVertex;
             UINT uBaseIndex;
             UINT uMaterialIndex;
+            AxisAlignedBox Bounds;
         };
 
     public:
@@ -98,6 +119,11 @@ namespace library
         ComPtr<ID3D11Buffer>& GetNormalBuffer();
 
         const XMMATRIX& GetWorldMatrix() const;
+        XMMATRIX GetInterpolatedWorldMatrix(_In_ FLOAT alpha) const;
+        void SaveState();
+        const AxisAlignedBox& GetBounds() const;
+        const SimpleVertex* GetVertices() const;
+        const WORD* GetIndices() const;
         const XMFLOAT4& GetOutputColor() const;
         BOOL HasTexture() const;
         const std::shared_ptr<Material>& GetMaterial(UINT uIndex) const;
@@ -117,6 +143,10 @@ namespace library
         UINT GetNumMaterials() const;
         BOOL HasNormalMap() const;
 
+        virtual UINT GetShaderFeatures() const;
+        void SetShadowReceiver(_In_ BOOL bShadowReceiver);
+        BOOL IsShadowReceiver() const;
+
     protected:
         const virtual SimpleVertex* getVertices() const = 0;
         virtual const WORD* getIndices() const = 0;
@@ -144,6 +174,9 @@ namespace library
         XMFLOAT4 m_outputColor;
         BYTE m_padding[8];
         XMMATRIX m_world;
+        XMMATRIX m_previousWorld;
         BOOL m_bHasNormalMap;
+        BOOL m_bShadowReceiver;
+        AxisAlignedBox m_bounds;
     };
 }
\ No newline at end of file
@@ -1,5 +1,8 @@
 ﻿#include "Renderer/Renderer.h"
 
+#include "Memory/FrameArena.h"
+#include "Profiler/CpuProfiler.h"
+
 namespace library
 {
     /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
@@ -8,10 +11,32 @@ namespace library
       Modifies: [m_driverType, m_featureLevel, m_d3dDevice, m_d3dDevice1,
                   m_immediateContext, m_immediateContext1, m_swapChain,
                   m_swapChain1, m_renderTargetView, m_depthStencil,
-                  m_depthStencilView, m_cbChangeOnResize, m_cbShadowMatrix,
-                  m_pszMainSceneName, m_camera, m_projection, m_scenes
-                  m_invalidTexture, m_shadowMapTexture, m_shadowVertexShader,
-                  m_shadowPixelShader].
+                  m_depthStencilView, m_constantRingBuffer,
+                  m_instanceRingBuffer, m_lightBuffer, m_clusterRangeBuffer,
+                  m_lightIndexBuffer, m_lightView, m_clusterRangeView,
+                  m_lightIndexView, m_staticShadowMaps, m_shadowMaps,
+                  m_aStaticShadowDepthViews, m_aShadowDepthViews,
+                  m_shadowMapView, m_shadowSampler, m_voxelMaterialBuffer,
+                  m_voxelMaterialView, m_renderContext,
+                  m_aSubmissionContexts, m_submissionThreadPool,
+                  m_uNumSubmissionThreads, m_uWidth,
+                  m_uHeight, m_submissionTime, m_pMainScene,
+                  m_camera, m_projection, m_scenes
+                  m_invalidTexture, m_shadowVertexShader,
+                  m_aRenderQueue, m_frustumCuller,
+                  m_objectBounds, m_meshBounds, m_aObjectVisibility,
+                  m_aMeshVisibility, m_aInstanceVisibility,
+                  m_aInstanceBatches, m_instanceRing, m_constantRing,
+                  m_constantBufferCopies, m_bConstantBufferOffsetting,
+                  m_cameraConstants, m_resizeConstants, m_lightsConstants,
+                  m_skyboxConstants, m_shadowsConstants, m_uFrameFenceValue,
+                  m_aCullingStatistics, m_bFrustumCulling,
+                  m_occlusionCuller, m_aOccluders, m_bOcclusionCulling,
+                  m_lightCuller, m_lightCullingTime, m_frameSnapshot,
+                  m_capturedSnapshot, m_snapshotTime, m_interpolationAlpha, m_sceneLoadTime,
+                  m_shadowCascades, m_shadowAtlas,
+                  m_uShadowSlice, m_aShadowCullingStatistics, m_voxelAtlas,
+                  m_aVoxelMaterials, m_bVoxelBatching].
     M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
 
     Renderer::Renderer()
@@ -26,16 +51,74 @@ namespace library
         , m_renderTargetView()
         , m_depthStencil()
         , m_depthStencilView()
-        , m_cbChangeOnResize()
-        , m_pszMainSceneName(nullptr)
+        , m_constantRingBuffer()
+        , m_instanceRingBuffer()
+        , m_lightBuffer()
+        , m_clusterRangeBuffer()
+        , m_lightIndexBuffer()
+        , m_lightView()
+        , m_clusterRangeView()
+        , m_lightIndexView()
+        , m_staticShadowMaps()
+        , m_shadowMaps()
+        , m_aStaticShadowDepthViews()
+        , m_aShadowDepthViews()
+        , m_shadowMapView()
+        , m_shadowSampler()
+        , m_voxelMaterialBuffer()
+        , m_voxelMaterialView()
+        , m_renderContext()
+        , m_aSubmissionContexts()
+        , m_submissionThreadPool()
+        , m_uNumSubmissionThreads(1u)
+        , m_uWidth(0u)
+        , m_uHeight(0u)
+        , m_submissionTime(0.0f)
+        , m_pMainScene(nullptr)
         , m_padding{ '\0' }
         , m_camera(XMVectorSet(0.0f, 3.0f, -6.0f, 0.0f))
         , m_projection()
         , m_scenes()
-        , m_invalidTexture(std::make_shared<Texture>(L"Content/Common/InvalidTexture.png"))
-        , m_shadowMapTexture()
+        , m_invalidTexture(TextureCache::GetGlobal().Acquire(L"Content/Common/InvalidTexture.png"))
         , m_shadowVertexShader()
-        , m_shadowPixelShader()
+        , m_aRenderQueue()
+        , m_frustumCuller()
+        , m_objectBounds()
+        , m_meshBounds()
+        , m_aObjectVisibility()
+        , m_aMeshVisibility()
+        , m_aInstanceVisibility()
+        , m_aInstanceBatches()
+        , m_instanceRing()
+        , m_constantRing()
+        , m_constantBufferCopies()
+        , m_bConstantBufferOffsetting(TRUE)
+        , m_cameraConstants()
+        , m_resizeConstants()
+        , m_lightsConstants()
+        , m_skyboxConstants()
+        , m_shadowsConstants()
+        , m_uFrameFenceValue(0u)
+        , m_aCullingStatistics()
+        , m_bFrustumCulling(TRUE)
+        , m_occlusionCuller()
+        , m_aOccluders()
+        , m_bOcclusionCulling(TRUE)
+        , m_lightCuller()
+        , m_lightCullingTime(0.0f)
+        , m_frameSnapshot()
+        , m_capturedSnapshot()
+        , m_snapshotTime(0.0f)
+        , m_interpolationAlpha(1.0f)
+        , m_sceneLoadTime(0.0f)
+        , m_shadowCascades()
+        , m_shadowAtlas()
+        , m_uShadowSlice(0u)
+        , m_aShadowCullingStatistics()
+        , m_voxelAtlas()
+        , m_aVoxelMaterials()
+        , m_bVoxelBatching(TRUE)
+        , m_gpuProfiler()
     {
     }
 
@@ -48,7 +131,13 @@ namespace library
                  m_d3dDevice1, m_immediateContext1, m_swapChain1,
                  m_swapChain, m_renderTargetView, m_vertexShader,
                  m_vertexLayout, m_pixelShader, m_vertexBuffer
-                 m_cbShadowMatrix].
+                 m_instanceRingBuffer, m_lightBuffer, m_clusterRangeBuffer,
+                 m_lightIndexBuffer, m_lightView, m_clusterRangeView,
+                 m_lightIndexView, m_staticShadowMaps, m_shadowMaps,
+                 m_aStaticShadowDepthViews, m_aShadowDepthViews,
+                 m_shadowMapView, m_shadowSampler, m_renderContext,
+                 m_aSubmissionContexts, m_uWidth, m_uHeight,
+                 m_gpuProfiler, m_bConstantBufferOffsetting].
      Returns:  HRESULT
                  Status code
    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
@@ -226,678 +315,2385 @@ namespace library
             return hr;
         }
 
-        m_immediateContext->OMSetRenderTargets(1, m_renderTargetView.GetAddressOf(), m_depthStencilView.Get());
-
-        // Setup the viewport
-        D3D11_VIEWPORT vp =
+        // The lights are bound with the rest of the frame state
+        hr = createLightBuffers();
+        if (FAILED(hr))
         {
-            .TopLeftX = 0.0f,
-            .TopLeftY = 0.0f,
-            .Width = static_cast<FLOAT>(uWidth),
-            .Height = static_cast<FLOAT>(uHeight),
-            .MinDepth = 0.0f,
-            .MaxDepth = 1.0f,
-        };
-        m_immediateContext->RSSetViewports(1, &vp);
-
-        // Set primitive topology
-        m_immediateContext->IASetPrimitiveTopology(D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
+            return hr;
+        }
 
-        // Create the constant buffers
-        D3D11_BUFFER_DESC bd =
-        {
-            .ByteWidth = sizeof(CBChangeOnResize),
-            .Usage = D3D11_USAGE_DEFAULT,
-            .BindFlags = D3D11_BIND_CONSTANT_BUFFER,
-            .CPUAccessFlags = 0
-        };
-        hr = m_d3dDevice->CreateBuffer(&bd, nullptr, m_cbChangeOnResize.GetAddressOf());
+        // So are the shadow maps
+        hr = createShadowMaps();
         if (FAILED(hr))
         {
             return hr;
         }
 
-        // Initialize the projection matrix
-        m_projection = XMMatrixPerspectiveFovLH(XM_PIDIV4, static_cast<FLOAT>(uWidth) / static_cast<FLOAT>(uHeight), 0.01f, 1000.0f);
-
-        CBChangeOnResize cbChangesOnResize =
+        // Constants are bound as ranges of the constant ring written with no
+        // overwrite maps, which takes the Direct3D 11.1 runtime. The 11.0
+        // runtime does not know the query, both are missing then
+        D3D11_FEATURE_DATA_D3D11_OPTIONS options = {};
+        hr = m_d3dDevice->CheckFeatureSupport(D3D11_FEATURE_D3D11_OPTIONS, &options, sizeof(options));
+        m_bConstantBufferOffsetting = SUCCEEDED(hr) && options.ConstantBufferOffsetting && options.MapNoOverwriteOnDynamicConstantBuffer;
+        if (!m_bConstantBufferOffsetting)
         {
-            .Projection = XMMatrixTranspose(m_projection)
-        };
-        m_immediateContext->UpdateSubresource(m_cbChangeOnResize.Get(), 0, nullptr, &cbChangesOnResize, 0, 0);
-
-        bd.ByteWidth = sizeof(CBLights);
-        bd.Usage = D3D11_USAGE_DEFAULT;
-        bd.BindFlags = D3D11_BIND_CONSTANT_BUFFER;
-        bd.CPUAccessFlags = 0u;
+            OutputDebugString(L"Renderer::Initialize Warning: No constant buffer offsets, constant ranges are copied at every bind\n");
+        }
 
-        hr = m_d3dDevice->CreateBuffer(&bd, nullptr, m_cbLights.GetAddressOf());
-        if (FAILED(hr))
+        std::unique_ptr<D3D11RenderContext> renderContext = std::make_unique<D3D11RenderContext>(m_immediateContext.Get());
+        if (!m_bConstantBufferOffsetting)
         {
-            return hr;
+            renderContext->CopyConstantBufferRanges(&m_constantBufferCopies);
         }
+        m_renderContext = std::move(renderContext);
 
-        // Create m_cbShadowMatrix constant buffer
-        bd.ByteWidth = sizeof(CBShadowMatrix);
-        bd.Usage = D3D11_USAGE_DEFAULT;
-        bd.BindFlags = D3D11_BIND_CONSTANT_BUFFER;
-        bd.CPUAccessFlags = 0u;
-        hr = m_d3dDevice->CreateBuffer(&bd, nullptr, m_cbShadowMatrix.GetAddressOf());
+        // Without timestamp queries the passes are simply not timed
+        m_gpuProfiler.Initialize(m_renderContext.get());
 
+        // Set the render target, the viewport and the primitive topology
+        m_uWidth = uWidth;
+        m_uHeight = uHeight;
+        bindFrameState(*m_renderContext, getMainPassTargets());
 
-        m_camera.Initialize(m_d3dDevice.Get());
-
-        if (!m_scenes.contains(m_pszMainSceneName))
+        // Create the ring the visible voxel instances are written into every pass
+        const D3D11_BUFFER_DESC bd =
         {
-            return E_FAIL;
-        }
-
-        hr = m_scenes[m_pszMainSceneName]->Initialize(m_d3dDevice.Get(), m_immediateContext.Get());
+            .ByteWidth = INSTANCE_RING_CAPACITY * static_cast<UINT>(sizeof(InstanceData)),
+            .Usage = D3D11_USAGE_DYNAMIC,
+            .BindFlags = D3D11_BIND_VERTEX_BUFFER,
+            .CPUAccessFlags = D3D11_CPU_ACCESS_WRITE
+        };
+        hr = m_d3dDevice->CreateBuffer(&bd, nullptr, m_instanceRingBuffer.GetAddressOf());
         if (FAILED(hr))
         {
             return hr;
         }
 
-        hr = m_invalidTexture->Initialize(m_d3dDevice.Get(), m_immediateContext.Get());
+        hr = createSubmissionContexts();
         if (FAILED(hr))
         {
             return hr;
         }
 
-        return S_OK;
+        return initializeScene(uWidth, uHeight);
     }
 
     /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
-      Method:   Renderer::AddScene
-      Summary:  Add scene to renderer
-      Args:     PCWSTR pszSceneName
-                  The name of the scene
-                const std::shared_ptr<Scene>&
-                  The shared pointer to Scene
-      Modifies: [m_scenes].
+      Method:   Renderer::InitializeHeadless
+      Summary:  Initializes the renderer without a device, a window or a
+                swap chain. Commands are recorded into a null render
+                context that only keeps statistics, so the CPU side of
+                updating and rendering the main scene can be run and
+                measured on machines without a GPU
+      Args:     UINT uWidth
+                  Width of the virtual back buffer
+                UINT uHeight
+                  Height of the virtual back buffer
+      Modifies: [m_driverType, m_renderContext, m_aSubmissionContexts,
+                  m_uWidth, m_uHeight, m_projection, m_gpuProfiler].
       Returns:  HRESULT
                   Status code
     M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
-    HRESULT Renderer::AddScene(_In_ PCWSTR pszSceneName, _In_ const std::shared_ptr<Scene>& scene)
+    HRESULT Renderer::InitializeHeadless(_In_ UINT uWidth, _In_ UINT uHeight)
     {
-        if (m_scenes.contains(pszSceneName))
+        HRESULT hr = S_OK;
+
+        if (uWidth == 0u || uHeight == 0u)
         {
-            return E_FAIL;
+            return E_INVALIDARG;
         }
 
-        m_scenes[pszSceneName] = scene;
+        m_driverType = D3D_DRIVER_TYPE_NULL;
+        m_renderContext = std::make_unique<NullRenderContext>();
+        m_gpuProfiler.Initialize(m_renderContext.get());
 
-        return S_OK;
-    }
+        m_uWidth = uWidth;
+        m_uHeight = uHeight;
+        bindFrameState(*m_renderContext, getMainPassTargets());
 
-    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
-      Method:   Renderer::GetSceneOrNull
-      Summary:  Return scene with the given name or null
-      Args:     PCWSTR pszSceneName
-                  The name of the scene
-      Returns:  std::shared_ptr<Scene>
-                  The shared pointer to Scene
-    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
-    std::shared_ptr<Scene> Renderer::GetSceneOrNull(_In_ PCWSTR pszSceneName)
-    {
-        if (m_scenes.contains(pszSceneName))
+        hr = createSubmissionContexts();
+        if (FAILED(hr))
         {
-            return m_scenes[pszSceneName];
+            return hr;
         }
 
-        return nullptr;
+        return initializeScene(uWidth, uHeight);
     }
 
     /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
-      Method:   Renderer::SetMainScene
-      Summary:  Set the main scene
-      Args:     PCWSTR pszSceneName
-                  The name of the scene
-      Modifies: [m_pszMainSceneName].
+      Method:   Renderer::createSubmissionContexts
+      Summary:  Creates one submission context per submission thread
+                and starts the threads. Submission contexts are deferred
+                contexts when there is a device, null render contexts
+                otherwise. A single thread records straight into the
+                render context and needs none
+      Modifies: [m_aSubmissionContexts, m_submissionThreadPool].
       Returns:  HRESULT
                   Status code
     M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
-
-    HRESULT Renderer::SetMainScene(_In_ PCWSTR pszSceneName)
+    HRESULT Renderer::createSubmissionContexts()
     {
-        if (!m_scenes.contains(pszSceneName))
+        HRESULT hr = S_OK;
+
+        m_aSubmissionContexts.clear();
+
+        hr = m_submissionThreadPool.Initialize(m_uNumSubmissionThreads);
+        if (FAILED(hr))
         {
-            return E_FAIL;
+            return hr;
         }
 
-        m_pszMainSceneName = pszSceneName;
+        if (m_uNumSubmissionThreads == 1u)
+        {
+            return S_OK;
+        }
+
+        m_aSubmissionContexts.reserve(m_uNumSubmissionThreads);
+        for (UINT i = 0u; i < m_uNumSubmissionThreads; ++i)
+        {
+            if (!m_d3dDevice)
+            {
+                m_aSubmissionContexts.push_back(std::make_unique<NullRenderContext>());
+                continue;
+            }
+
+            ComPtr<ID3D11DeviceContext> deferredContext;
+            hr = m_d3dDevice->CreateDeferredContext(0u, deferredContext.GetAddressOf());
+            if (FAILED(hr))
+            {
+                m_aSubmissionContexts.clear();
+                return hr;
+            }
+
+            std::unique_ptr<D3D11RenderContext> submissionContext = std::make_unique<D3D11RenderContext>(deferredContext.Get());
+            if (!m_bConstantBufferOffsetting)
+            {
+                submissionContext->CopyConstantBufferRanges(&m_constantBufferCopies);
+            }
+            m_aSubmissionContexts.push_back(std::move(submissionContext));
+        }
 
         return S_OK;
     }
 
     /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
-      Method:   Renderer::HandleInput
-      Summary:  Handle user mouse input
-      Args:     DirectionsInput& directions
-                MouseRelativeMovement& mouseRelativeMovement
-                FLOAT deltaTime
+      Method:   Renderer::createConstantRing
+      Summary:  Creates the dynamic constant buffer the constants of a
+                frame are written into and empties its allocator. There
+                is no buffer without a device, only the bookkeeping.
+                Without constant buffer offsets the ring also gets the
+                CPU copy its ranges are bound from
+      Args:     UINT uSize
+                  Size of the ring in bytes
+      Modifies: [m_constantRingBuffer, m_constantRing,
+                  m_constantBufferCopies].
+      Returns:  HRESULT
+                  Status code
     M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
-    
-    void Renderer::HandleInput(_In_ const DirectionsInput& directions, _In_ const MouseRelativeMovement& mouseRelativeMovement, _In_ FLOAT deltaTime)
+    HRESULT Renderer::createConstantRing(_In_ UINT uSize)
     {
-        m_camera.HandleInput(directions, mouseRelativeMovement, deltaTime);
-    }
+        HRESULT hr = S_OK;
 
+        if (m_d3dDevice)
+        {
+            const D3D11_BUFFER_DESC bd =
+            {
+                .ByteWidth = uSize,
+                .Usage = D3D11_USAGE_DYNAMIC,
+                .BindFlags = D3D11_BIND_CONSTANT_BUFFER,
+                .CPUAccessFlags = D3D11_CPU_ACCESS_WRITE
+            };
 
-    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
-      Method:   Renderer::Update
-      Summary:  Update the renderables each frame
-      Args:     FLOAT deltaTime
-                  Time difference of a frame
-    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
-    void Renderer::Update(_In_ FLOAT deltaTime)
-    {
-        m_scenes[m_pszMainSceneName]->Update(deltaTime);
+            ComPtr<ID3D11Buffer> constantRingBuffer;
+            hr = m_d3dDevice->CreateBuffer(&bd, nullptr, constantRingBuffer.GetAddressOf());
+            if (FAILED(hr))
+            {
+                return hr;
+            }
 
-        m_camera.Update(deltaTime);
+            // Without offsets the ring lives in a CPU copy the ranges are
+            // copied from when bound
+            if (!m_bConstantBufferOffsetting)
+            {
+                m_constantBufferCopies.aCopies.erase(m_constantRingBuffer.Get());
+                m_constantBufferCopies.aCopies[constantRingBuffer.Get()].resize(uSize);
+            }
+
+            // The driver keeps the old buffer alive while the GPU reads it
+            m_constantRingBuffer = constantRingBuffer;
+        }
+
+        m_constantRing.Initialize(uSize);
+
+        return S_OK;
     }
 
     /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
-     Method:   Renderer::Render
-     Summary:  Render the frame
-   M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
-
-    void Renderer::Render()
+      Method:   Renderer::createLightBuffers
+      Summary:  Creates the dynamic buffers the pixel shaders read the
+                clustered lights from, and their views: the lights, the
+                range of the light index list of every cluster, and the
+                light index list
+      Modifies: [m_lightBuffer, m_clusterRangeBuffer, m_lightIndexBuffer,
+                  m_lightView, m_clusterRangeView, m_lightIndexView].
+      Returns:  HRESULT
+                  Status code
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    HRESULT Renderer::createLightBuffers()
     {
+        // Structured when there is no format, typed otherwise
+        auto createBuffer = [this](UINT uNumElements, UINT uStride, DXGI_FORMAT format, ID3D11Buffer** ppBuffer, ID3D11ShaderResourceView** ppView)
+        {
+            const D3D11_BUFFER_DESC bd =
+            {
+                .ByteWidth = uNumElements * uStride,
+                .Usage = D3D11_USAGE_DYNAMIC,
+                .BindFlags = D3D11_BIND_SHADER_RESOURCE,
+                .CPUAccessFlags = D3D11_CPU_ACCESS_WRITE,
+                .MiscFlags = (format == DXGI_FORMAT_UNKNOWN) ? static_cast<UINT>(D3D11_RESOURCE_MISC_BUFFER_STRUCTURED) : 0u,
+                .StructureByteStride = (format == DXGI_FORMAT_UNKNOWN) ? uStride : 0u
+            };
+            HRESULT hr = m_d3dDevice->CreateBuffer(&bd, nullptr, ppBuffer);
+            if (FAILED(hr))
+            {
+                return hr;
+            }
 
-        // Just clear the backbuffer
-        m_immediateContext->ClearRenderTargetView(m_renderTargetView.Get(), Colors::MidnightBlue);
-
-        // Clear depth stencil view
-        // Clear the depth buffer
-        m_immediateContext->ClearDepthStencilView(m_depthStencilView.Get(), D3D11_CLEAR_DEPTH, 1.0f, 0);
+            D3D11_SHADER_RESOURCE_VIEW_DESC srvDesc = {};
+            srvDesc.Format = format;
+            srvDesc.ViewDimension = D3D11_SRV_DIMENSION_BUFFER;
+            srvDesc.Buffer.FirstElement = 0u;
+            srvDesc.Buffer.NumElements = uNumElements;
 
-        // Create camera constant buffer and update
-        CBChangeOnCameraMovement cb_view = {
-               .View = XMMatrixTranspose(m_camera.GetView()),
+            return m_d3dDevice->CreateShaderResourceView(*ppBuffer, &srvDesc, ppView);
         };
 
-        XMStoreFloat4(&cb_view.CameraPosition, m_camera.GetEye());
-        
-        m_immediateContext->UpdateSubresource(m_camera.GetConstantBuffer().Get(), 0, nullptr, &cb_view, 0, 0);
-
-        CBLights cbLight = {};
-
-        for (UINT i = 0; i < NUM_LIGHTS; i++)
+        HRESULT hr = createBuffer(MAX_NUM_LIGHTS, static_cast<UINT>(sizeof(PointLightData)), DXGI_FORMAT_UNKNOWN, m_lightBuffer.ReleaseAndGetAddressOf(), m_lightView.ReleaseAndGetAddressOf());
+        if (FAILED(hr))
         {
-            FLOAT attenuationDistance = m_scenes[m_pszMainSceneName]->GetPointLight(i)->GetAttenuationDistance();
-            FLOAT attenuationDistanceSquared = attenuationDistance * attenuationDistance;
-            PointLightData pointLights = cbLight.PointLights[i];
-
-            pointLights.Position = m_scenes[m_pszMainSceneName]->GetPointLight(i)->GetPosition();
-            pointLights.Color = m_scenes[m_pszMainSceneName]->GetPointLight(i)->GetColor();
-
-            pointLights.AttenuationDistance = XMFLOAT4(attenuationDistance, attenuationDistance, attenuationDistanceSquared, attenuationDistanceSquared);
-
+            return hr;
         }
 
-        m_immediateContext->UpdateSubresource(m_cbLights.Get(), 0, nullptr, &cbLight, 0, 0);
+        hr = createBuffer(ClusteredLightCuller::NUM_CLUSTERS, 2u * static_cast<UINT>(sizeof(UINT)), DXGI_FORMAT_R32G32_UINT, m_clusterRangeBuffer.ReleaseAndGetAddressOf(), m_clusterRangeView.ReleaseAndGetAddressOf());
+        if (FAILED(hr))
+        {
+            return hr;
+        }
 
-        std::unordered_map<std::wstring, std::shared_ptr<Renderable>>::iterator it_renderables;
+        return createBuffer(ClusteredLightCuller::MAX_LIGHT_INDICES, static_cast<UINT>(sizeof(UINT)), DXGI_FORMAT_R32_UINT, m_lightIndexBuffer.ReleaseAndGetAddressOf(), m_lightIndexView.ReleaseAndGetAddressOf());
+    }
 
-        // for each renderables
-        for (it_renderables = m_scenes[m_pszMainSceneName]->GetRenderables().begin(); it_renderables != m_scenes[m_pszMainSceneName]->GetRenderables().end(); it_renderables++)
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   Renderer::createShadowMaps
+      Summary:  Creates the two texture arrays of the shadow slices, the
+                static layers and the shadow maps the dynamic casters
+                are drawn into on top of them, a depth stencil view per
+                slice of each, the view the pixel shaders sample the
+                shadow maps through and the comparison sampler they
+                use. Whatever the static layers held is forgotten
+      Modifies: [m_staticShadowMaps, m_shadowMaps,
+                  m_aStaticShadowDepthViews, m_aShadowDepthViews,
+                  m_shadowMapView, m_shadowSampler, m_shadowAtlas].
+      Returns:  HRESULT
+                  Status code
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    HRESULT Renderer::createShadowMaps()
+    {
+        // Typeless, the slices are drawn as depth and sampled as floats
+        const D3D11_TEXTURE2D_DESC descShadowMaps =
+        {
+            .Width = SHADOW_MAP_SIZE,
+            .Height = SHADOW_MAP_SIZE,
+            .MipLevels = 1u,
+            .ArraySize = FrameSnapshot::NUM_SHADOW_SLICES,
+            .Format = DXGI_FORMAT_R32_TYPELESS,
+            .SampleDesc = {.Count = 1u, .Quality = 0u },
+            .Usage = D3D11_USAGE_DEFAULT,
+            .BindFlags = D3D11_BIND_DEPTH_STENCIL | D3D11_BIND_SHADER_RESOURCE,
+            .CPUAccessFlags = 0u,
+            .MiscFlags = 0u
+        };
+        HRESULT hr = m_d3dDevice->CreateTexture2D(&descShadowMaps, nullptr, m_staticShadowMaps.ReleaseAndGetAddressOf());
+        if (FAILED(hr))
         {
-            
-            // Set the vertex buffer, index buffer, and the input layout
+            return hr;
+        }
 
-            // Set vertex buffer
-            UINT uStrides[2] = { sizeof(SimpleVertex), sizeof(NormalData) };
-            UINT uOffsets[2] = { 0, 0 };
+        hr = m_d3dDevice->CreateTexture2D(&descShadowMaps, nullptr, m_shadowMaps.ReleaseAndGetAddressOf());
+        if (FAILED(hr))
+        {
+            return hr;
+        }
 
-            ComPtr<ID3D11Buffer> vertexNormalBuffers[2] = { it_renderables->second->GetVertexBuffer(), it_renderables->second->GetNormalBuffer() };
+        for (UINT i = 0u; i < FrameSnapshot::NUM_SHADOW_SLICES; ++i)
+        {
+            const D3D11_DEPTH_STENCIL_VIEW_DESC descDSV =
+            {
+                .Format = DXGI_FORMAT_D32_FLOAT,
+                .ViewDimension = D3D11_DSV_DIMENSION_TEXTURE2DARRAY,
+                .Flags = 0u,
+                .Texture2DArray = {.MipSlice = 0u, .FirstArraySlice = i, .ArraySize = 1u }
+            };
+            hr = m_d3dDevice->CreateDepthStencilView(m_staticShadowMaps.Get(), &descDSV, m_aStaticShadowDepthViews[i].ReleaseAndGetAddressOf());
+            if (FAILED(hr))
+            {
+                return hr;
+            }
 
-            m_immediateContext->IASetVertexBuffers(
-                0u,             // the first input slot for binding
-                2u,             // the number of buffers in the array
-                vertexNormalBuffers->GetAddressOf(), // the array of vertex buffers
-                uStrides,       // array of stride values, one for each buffer
-                uOffsets        // array of offset values, one for each buffer
-            );
+            hr = m_d3dDevice->CreateDepthStencilView(m_shadowMaps.Get(), &descDSV, m_aShadowDepthViews[i].ReleaseAndGetAddressOf());
+            if (FAILED(hr))
+            {
+                return hr;
+            }
+        }
 
-            // Set normal buffer
-            //uStride = sizeof(NormalData);
-            //m_immediateContext->IASetVertexBuffers(1u, 1u, it_renderables->second->GetNormalBuffer().GetAddressOf(), &uStride, &uOffset);
+        D3D11_SHADER_RESOURCE_VIEW_DESC srvDesc = {};
+        srvDesc.Format = DXGI_FORMAT_R32_FLOAT;
+        srvDesc.ViewDimension = D3D11_SRV_DIMENSION_TEXTURE2DARRAY;
+        srvDesc.Texture2DArray.MostDetailedMip = 0u;
+        srvDesc.Texture2DArray.MipLevels = 1u;
+        srvDesc.Texture2DArray.FirstArraySlice = 0u;
+        srvDesc.Texture2DArray.ArraySize = FrameSnapshot::NUM_SHADOW_SLICES;
+        hr = m_d3dDevice->CreateShaderResourceView(m_shadowMaps.Get(), &srvDesc, m_shadowMapView.ReleaseAndGetAddressOf());
+        if (FAILED(hr))
+        {
+            return hr;
+        }
 
-            // Set index buffer
-            m_immediateContext->IASetIndexBuffer(
-                it_renderables->second->GetIndexBuffer().Get(),
-                DXGI_FORMAT_R16_UINT,
-                0
-            );
+        // Outside of a slice nothing is in shadow
+        const D3D11_SAMPLER_DESC descSampler =
+        {
+            .Filter = D3D11_FILTER_COMPARISON_MIN_MAG_LINEAR_MIP_POINT,
+            .AddressU = D3D11_TEXTURE_ADDRESS_BORDER,
+            .AddressV = D3D11_TEXTURE_ADDRESS_BORDER,
+            .AddressW = D3D11_TEXTURE_ADDRESS_BORDER,
+            .MipLODBias = 0.0f,
+            .MaxAnisotropy = 1u,
+            .ComparisonFunc = D3D11_COMPARISON_LESS_EQUAL,
+            .BorderColor = { 1.0f, 1.0f, 1.0f, 1.0f },
+            .MinLOD = 0.0f,
+            .MaxLOD = D3D11_FLOAT32_MAX
+        };
+        hr = m_d3dDevice->CreateSamplerState(&descSampler, m_shadowSampler.ReleaseAndGetAddressOf());
+        if (FAILED(hr))
+        {
+            return hr;
+        }
 
-            // Set input layout
-            m_immediateContext->IASetInputLayout(it_renderables->second->GetVertexLayout().Get());
+        m_shadowAtlas.Invalidate();
 
+        return S_OK;
+    }
 
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   Renderer::createVoxelMaterials
+      Summary:  Builds the material of every voxel of the main scene,
+                indexed by the voxel as its instances are. The diffuse
+                textures of the voxels are decoded again and packed into
+                the voxel atlas, so that voxels of different textures
+                are drawn by the same call. A texture that does not
+                decode stays bound to its voxel, which is then drawn on
+                its own. Voxels without a texture keep their color
+      Modifies: [m_voxelAtlas, m_aVoxelMaterials, m_voxelMaterialBuffer,
+                  m_voxelMaterialView].
+      Returns:  HRESULT
+                  Status code
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    HRESULT Renderer::createVoxelMaterials()
+    {
+        const std::vector<std::shared_ptr<Voxel>>& aVoxels = m_pMainScene->GetVoxels();
+        const UINT uNumThreads = std::max(std::thread::hardware_concurrency(), 1u);
 
-            // Update constant buffer
-            //   You must transpose the matrices when passing them to GPU!!
-            //   XMMATRIX is a row - major matrix, however HLSL expects column - major matrix
+        m_aVoxelMaterials.assign(aVoxels.size(), VoxelMaterialData());
+        std::vector<UINT> auRegions(aVoxels.size(), 0u);
+        for (size_t i = 0u; i < aVoxels.size(); ++i)
+        {
+            const Voxel& voxel = *aVoxels[i];
+            VoxelMaterialData& material = m_aVoxelMaterials[i];
+            material.Color = voxel.GetOutputColor();
+            material.ScaleOffset = XMFLOAT4(1.0f, 1.0f, 0.0f, 0.0f);
+            material.Texture = XMUINT4(VOXEL_TEXTURE_NONE, 0u, 0u, 0u);
 
-            // Create renderable constant buffer and update
-            CBChangesEveryFrame cb_world =
+            if (!voxel.HasTexture() || !voxel.GetMaterial(0u)->pDiffuse)
             {
-                .World = XMMatrixTranspose(it_renderables->second->GetWorldMatrix()),
-                .OutputColor = it_renderables->second->GetOutputColor(),
-                .HasNormalMap = it_renderables->second->HasNormalMap()
-            };
-
-            m_immediateContext->UpdateSubresource(it_renderables->second->GetConstantBuffer().Get(), 0, nullptr, &cb_world, 0, 0);
-
-
-            // Set shadersand constant buffers, shader resources, and samplers
-
-            // Set vertex shader
-            m_immediateContext->VSSetShader(
-                it_renderables->second->GetVertexShader().Get(),
-                nullptr,
-                0
-            );
-
-            // VS set
-            m_immediateContext->VSSetConstantBuffers(
-                0, 
-                1,
-                m_camera.GetConstantBuffer().GetAddressOf()
-            );
-            m_immediateContext->VSSetConstantBuffers(
-                1, 
-                1,
-                m_cbChangeOnResize.GetAddressOf()
-            );
-            m_immediateContext->VSSetConstantBuffers(
-                2, 
-                1, 
-                it_renderables->second->GetConstantBuffer().GetAddressOf()
-            );
-            m_immediateContext->VSSetConstantBuffers(
-                3, 
-                1,
-                m_cbLights.GetAddressOf()
-            );
-
-            // Set pixel shader
-            m_immediateContext->PSSetShader(
-                it_renderables->second->GetPixelShader().Get(),
-                nullptr,
-                0u
-            );
-
-            // PS set
-
-            m_immediateContext->PSSetConstantBuffers(
-                0,
-                1,
-                m_camera.GetConstantBuffer().GetAddressOf()
-            );
-
-            m_immediateContext->PSSetConstantBuffers(
-                2,
-                1,
-                it_renderables->second->GetConstantBuffer().GetAddressOf()
-            );
-
-            m_immediateContext->PSSetConstantBuffers(
-                3,
-                1,
-                m_cbLights.GetAddressOf()
-            );
-            
-            std::shared_ptr<Skybox> skybox = m_scenes[m_pszMainSceneName]->GetSkyBox();
-            if (skybox)
-            {
-                eTextureSamplerType textureSamplerType = skybox->GetSkyboxTexture()->GetSamplerType();
-                m_immediateContext->PSSetShaderResources(2, 1, skybox->GetSkyboxTexture()->GetTextureResourceView().GetAddressOf());
-                m_immediateContext->PSSetSamplers(2, 1, Texture::s_samplers[static_cast<size_t>(textureSamplerType)].GetAddressOf());
-            }
-
-            if (it_renderables->second->HasTexture())
-            {
-                for (UINT i = 0u; i < it_renderables->second->GetNumMeshes(); ++i)
-                {
-                    const UINT materialIndex = it_renderables->second->GetMesh(i).uMaterialIndex;
-                    if (it_renderables->second->GetMaterial(materialIndex)->pDiffuse)
-                    {
-                        // Set texture resource view of the renderable into the pixel shader
-                        m_immediateContext->PSSetShaderResources(0u, 1u, it_renderables->second->GetMaterial(materialIndex)->pDiffuse->GetTextureResourceView().GetAddressOf());
-
-                        // Set sampler state of the renderable into the pixel shader
-                        m_immediateContext->PSSetSamplers(0u, 1u, Texture::s_samplers[static_cast<size_t>(it_renderables->second->GetMaterial(materialIndex)->pDiffuse->GetSamplerType())].GetAddressOf());
-                    }
-
-                    if (it_renderables->second->GetMaterial(materialIndex)->pNormal)
-                    {
-                        // Set texture resource view of the renderable into the pixel shader
-                        m_immediateContext->PSSetShaderResources(1u, 1u, it_renderables->second->GetMaterial(materialIndex)->pNormal->GetTextureResourceView().GetAddressOf());
+                continue;
+            }
 
-                        // Set sampler state of the renderable into the pixel shader
-                        m_immediateContext->PSSetSamplers(1u, 1u, Texture::s_samplers[static_cast<size_t>(it_renderables->second->GetMaterial(materialIndex)->pNormal->GetSamplerType())].GetAddressOf());
-                    }
+            // Textured voxels take the color of their texture alone
+            material.Color = XMFLOAT4(1.0f, 1.0f, 1.0f, 1.0f);
+            material.Texture.x = VOXEL_TEXTURE_BOUND;
 
-                    // Render the triangles
-                    m_immediateContext->DrawIndexed(it_renderables->second->GetMesh(i).uNumIndices,
-                        it_renderables->second->GetMesh(i).uBaseIndex,
-                        it_renderables->second->GetMesh(i).uBaseVertex);
-                }
-            }
-            else
+            DecodedImage image;
+            if (SUCCEEDED(TextureStreamer::Decode(voxel.GetMaterial(0u)->pDiffuse->GetFilePath(), uNumThreads, image)))
             {
-                // draw
-                m_immediateContext->DrawIndexed(it_renderables->second->GetNumIndices(), 0, 0);
+                auRegions[i] = m_voxelAtlas.Add(std::move(image));
+                material.Texture.x = VOXEL_TEXTURE_ATLAS;
             }
-            
-            
-
-            
-
         }
 
-        
-
-
-        std::vector<std::shared_ptr<Voxel>>::iterator voxels;
-        for (voxels = m_scenes[m_pszMainSceneName]->GetVoxels().begin(); voxels != m_scenes[m_pszMainSceneName]->GetVoxels().end(); voxels++)
+        HRESULT hr = m_voxelAtlas.Build(uNumThreads);
+        if (FAILED(hr))
         {
-            UINT strides[3] = { sizeof(SimpleVertex), sizeof(NormalData), sizeof(InstanceData) };
-            UINT offsets[3] = { 0, 0, 0 };
+            return hr;
+        }
 
-            ComPtr<ID3D11Buffer> vertexInstanceBuffers[3] = { voxels->get()->GetVertexBuffer(), voxels->get()->GetNormalBuffer(), voxels->get()->GetInstanceBuffer() };
+        for (size_t i = 0u; i < aVoxels.size(); ++i)
+        {
+            VoxelMaterialData& material = m_aVoxelMaterials[i];
+            if (material.Texture.x == VOXEL_TEXTURE_ATLAS)
+            {
+                const AtlasRegion& region = m_voxelAtlas.GetRegion(auRegions[i]);
+                material.ScaleOffset = region.ScaleOffset;
+                material.Texture.y = region.uLayer;
+            }
+        }
 
-            m_immediateContext->IASetVertexBuffers(
-                0,
-                3,
-                vertexInstanceBuffers->GetAddressOf(),
-                strides, 
-                offsets);
+        // A headless renderer keeps the materials on the CPU for batching
+        if (!m_d3dDevice || m_aVoxelMaterials.empty())
+        {
+            return S_OK;
+        }
 
-            m_immediateContext->IASetIndexBuffer(
-                voxels->get()->GetIndexBuffer().Get(),
-                DXGI_FORMAT_R16_UINT,
-                0
-            );
-            m_immediateContext->IASetInputLayout(
-                voxels->get()->GetVertexLayout().Get()
-            );
+        hr = m_voxelAtlas.Initialize(m_d3dDevice.Get());
+        if (FAILED(hr))
+        {
+            return hr;
+        }
 
-            CBChangesEveryFrame cb = {
-                .World = XMMatrixTranspose(voxels->get()->GetWorldMatrix()),
-                .OutputColor = voxels->get()->GetOutputColor(),
-                .HasNormalMap = voxels->get()->HasNormalMap()
-            };
+        const D3D11_BUFFER_DESC bd =
+        {
+            .ByteWidth = static_cast<UINT>(m_aVoxelMaterials.size() * sizeof(VoxelMaterialData)),
+            .Usage = D3D11_USAGE_IMMUTABLE,
+            .BindFlags = D3D11_BIND_SHADER_RESOURCE,
+            .CPUAccessFlags = 0u,
+            .MiscFlags = D3D11_RESOURCE_MISC_BUFFER_STRUCTURED,
+            .StructureByteStride = static_cast<UINT>(sizeof(VoxelMaterialData))
+        };
+        const D3D11_SUBRESOURCE_DATA initData =
+        {
+            .pSysMem = m_aVoxelMaterials.data(),
+            .SysMemPitch = 0u,
+            .SysMemSlicePitch = 0u
+        };
+        hr = m_d3dDevice->CreateBuffer(&bd, &initData, m_voxelMaterialBuffer.ReleaseAndGetAddressOf());
+        if (FAILED(hr))
+        {
+            return hr;
+        }
 
-            m_immediateContext->UpdateSubresource(
-                voxels->get()->GetConstantBuffer().Get(),
-                0,
-                nullptr,
-                &cb,
-                0,
-                0
-            );
-            m_immediateContext->VSSetShader(
-                voxels->get()->GetVertexShader().Get(),
-                nullptr,
-                0
-            );
+        D3D11_SHADER_RESOURCE_VIEW_DESC srvDesc = {};
+        srvDesc.Format = DXGI_FORMAT_UNKNOWN;
+        srvDesc.ViewDimension = D3D11_SRV_DIMENSION_BUFFER;
+        srvDesc.Buffer.FirstElement = 0u;
+        srvDesc.Buffer.NumElements = static_cast<UINT>(m_aVoxelMaterials.size());
 
+        return m_d3dDevice->CreateShaderResourceView(m_voxelMaterialBuffer.Get(), &srvDesc, m_voxelMaterialView.ReleaseAndGetAddressOf());
+    }
 
-            m_immediateContext->VSSetConstantBuffers(0, 1, m_camera.GetConstantBuffer().GetAddressOf());
-            m_immediateContext->VSSetConstantBuffers(1, 1, m_cbChangeOnResize.GetAddressOf());
-            m_immediateContext->VSSetConstantBuffers(2, 1, voxels->get()->GetConstantBuffer().GetAddressOf());
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   Renderer::initializeScene
+      Summary:  Sets up the projection, the camera and the main scene.
+                Shared by the windowed and the headless initialization,
+                the device is null in the latter
+      Args:     UINT uWidth
+                  Width of the back buffer
+                UINT uHeight
+                  Height of the back buffer
+      Modifies: [m_projection, m_camera, m_scenes, m_invalidTexture,
+                  m_occlusionCuller, m_instanceRing, m_constantRingBuffer,
+                  m_constantRing, m_lightCuller, m_shadowCascades,
+                  m_shadowVertexShader, m_shadowAtlas, m_sceneLoadTime,
+                  m_voxelAtlas, m_aVoxelMaterials, m_voxelMaterialBuffer,
+                  m_voxelMaterialView].
+      Returns:  HRESULT
+                  Status code
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    HRESULT Renderer::initializeScene(_In_ UINT uWidth, _In_ UINT uHeight)
+    {
+        PROFILE_SCOPE("Load scene");
 
-            m_immediateContext->PSSetConstantBuffers(0, 1, m_camera.GetConstantBuffer().GetAddressOf());
-            m_immediateContext->PSSetConstantBuffers(2, 1, voxels->get()->GetConstantBuffer().GetAddressOf());
-            m_immediateContext->PSSetConstantBuffers(3, 1, m_cbLights.GetAddressOf());
+        HRESULT hr = S_OK;
 
-            m_immediateContext->PSSetShader(voxels->get()->GetPixelShader().Get(), nullptr, 0);
+        // Initialize the projection matrix, the light clusters split its frustum
+        const FLOAT aspectRatio = static_cast<FLOAT>(uWidth) / static_cast<FLOAT>(uHeight);
+        m_projection = XMMatrixPerspectiveFovLH(XM_PIDIV4, aspectRatio, 0.01f, 1000.0f);
 
+        const FLOAT tanHalfFovY = std::tan(XM_PIDIV4 * 0.5f);
+        hr = m_lightCuller.SetProjection(tanHalfFovY * aspectRatio, tanHalfFovY, 0.01f, 1000.0f);
+        if (FAILED(hr))
+        {
+            return hr;
+        }
 
-            if (voxels->get()->HasTexture())
-            {
-                ComPtr<ID3D11ShaderResourceView> shaderResources[2] = { voxels->get()->GetMaterial(0)->pDiffuse->GetTextureResourceView(),
-                                                voxels->get()->GetMaterial(0)->pNormal->GetTextureResourceView() };
-                ComPtr<ID3D11SamplerState> samplerStates[2] = { Texture::s_samplers[static_cast<size_t>(voxels->get()->GetMaterial(0)->pDiffuse->GetSamplerType())],
-                                                Texture::s_samplers[static_cast<size_t>(voxels->get()->GetMaterial(0)->pNormal->GetSamplerType())] };
-                m_immediateContext->PSSetShaderResources(0, 2, shaderResources->GetAddressOf());
-                m_immediateContext->PSSetSamplers(0, 2, samplerStates->GetAddressOf());
-                m_immediateContext->DrawIndexedInstanced(voxels->get()->GetNumIndices(), voxels->get()->GetNumInstances(), 0, 0, 0);
+        // So do the shadow cascades, up to the shadow distance
+        hr = m_shadowCascades.SetProjection(tanHalfFovY * aspectRatio, tanHalfFovY, 0.01f, SHADOW_DISTANCE, SHADOW_SPLIT_LAMBDA,
+            NUM_SHADOW_CASCADES, SHADOW_MAP_SIZE, SHADOW_CASTER_DISTANCE);
+        if (FAILED(hr))
+        {
+            return hr;
+        }
+        m_shadowAtlas.Initialize(FrameSnapshot::NUM_SHADOW_SLICES, NUM_SHADOW_CASCADES);
 
-            }
-            else
+        if (m_shadowVertexShader)
+        {
+            hr = m_shadowVertexShader->Initialize(m_d3dDevice.Get());
+            if (FAILED(hr))
             {
-                m_immediateContext->DrawIndexedInstanced(voxels->get()->GetNumIndices(), voxels->get()->GetNumInstances(), 0, 0, 0);
+                return hr;
             }
-
         }
-        
-
-
 
+        hr = m_camera.Initialize(m_d3dDevice.Get());
+        if (FAILED(hr))
+        {
+            return hr;
+        }
 
-        std::unordered_map<std::wstring, std::shared_ptr<Model>>::iterator it_models;
-
-        // for models
-        for (it_models = m_scenes[m_pszMainSceneName]->GetModels().begin(); it_models != m_scenes[m_pszMainSceneName]->GetModels().end(); it_models++)
+        if (!m_pMainScene)
         {
-            // Set the vertex buffer, index buffer, and the input layout
+            return E_FAIL;
+        }
 
-            // Set vertex buffer
-            UINT aStrides[2] = {
-                static_cast<UINT>(sizeof(SimpleVertex)),
-                static_cast<UINT>(sizeof(AnimationData)),
-            };
-            UINT aOffsets[2] = { 0u, 0u };
+        // Streamed textures show the invalid texture until they decoded
+        hr = m_invalidTexture->Initialize(m_d3dDevice.Get(), m_immediateContext.Get());
+        if (FAILED(hr))
+        {
+            return hr;
+        }
 
-            ComPtr<ID3D11Buffer> aBuffers[2]
+        if (m_d3dDevice)
+        {
+            hr = TextureStreamer::GetGlobal().Initialize(m_d3dDevice.Get(), NUM_TEXTURE_STREAMING_THREADS, TEXTURE_UPLOAD_BUDGET, m_invalidTexture);
+            if (FAILED(hr))
             {
-                it_models->second->GetVertexBuffer().Get(),
-                it_models->second->GetAnimationBuffer().Get(),
-            };
-
-            m_immediateContext->IASetVertexBuffers(
-                0u,             // the first input slot for binding
-                2u,             // the number of buffers in the array
-                aBuffers->GetAddressOf(), // the array of vertex buffers
-                aStrides,       // array of stride values, one for each buffer
-                aOffsets        // array of offset values, one for each buffer
-            );
+                return hr;
+            }
+        }
+
+        // Textures shared by the models and materials of the scene are loaded once, in the background
+        const std::chrono::steady_clock::time_point loadStart = std::chrono::steady_clock::now();
+        hr = m_pMainScene->Initialize(m_d3dDevice.Get(), m_immediateContext.Get());
+        if (FAILED(hr))
+        {
+            return hr;
+        }
+        m_sceneLoadTime = std::chrono::duration<FLOAT, std::milli>(std::chrono::steady_clock::now() - loadStart).count();
+
+        hr = createVoxelMaterials();
+        if (FAILED(hr))
+        {
+            return hr;
+        }
+
+        hr = m_occlusionCuller.Initialize(OCCLUSION_BUFFER_WIDTH, OCCLUSION_BUFFER_HEIGHT);
+        if (FAILED(hr))
+        {
+            return hr;
+        }
+
+        m_instanceRing.Initialize(INSTANCE_RING_CAPACITY);
+
+        hr = createConstantRing(CONSTANT_RING_SIZE);
+        if (FAILED(hr))
+        {
+            return hr;
+        }
+
+        for (size_t i = 0u; i < m_pMainScene->GetNumPointLights(); ++i)
+        {
+            if (m_pMainScene->GetPointLight(i))
+            {
+                m_pMainScene->GetPointLight(i)->Initialize(uWidth, uHeight);
+            }
+        }
+
+        return S_OK;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   Renderer::AddScene
+      Summary:  Add scene to renderer
+      Args:     PCWSTR pszSceneName
+                  The name of the scene
+                const std::shared_ptr<Scene>&
+                  The shared pointer to Scene
+      Modifies: [m_scenes].
+      Returns:  HRESULT
+                  Status code
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    HRESULT Renderer::AddScene(_In_ PCWSTR pszSceneName, _In_ const std::shared_ptr<Scene>& scene)
+    {
+        if (m_scenes.contains(pszSceneName))
+        {
+            return E_FAIL;
+        }
+
+        m_scenes[pszSceneName] = scene;
+
+        return S_OK;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   Renderer::GetSceneOrNull
+      Summary:  Return scene with the given name or null
+      Args:     PCWSTR pszSceneName
+                  The name of the scene
+      Returns:  std::shared_ptr<Scene>
+                  The shared pointer to Scene
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    std::shared_ptr<Scene> Renderer::GetSceneOrNull(_In_ PCWSTR pszSceneName)
+    {
+        if (m_scenes.contains(pszSceneName))
+        {
+            return m_scenes[pszSceneName];
+        }
+
+        return nullptr;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   Renderer::SetMainScene
+      Summary:  Set the main scene. The scene is resolved here, the
+                frames use it without looking its name up
+      Args:     PCWSTR pszSceneName
+                  The name of the scene
+      Modifies: [m_pMainScene].
+      Returns:  HRESULT
+                  Status code
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+
+    HRESULT Renderer::SetMainScene(_In_ PCWSTR pszSceneName)
+    {
+        auto it = m_scenes.find(pszSceneName);
+        if (it == m_scenes.end())
+        {
+            return E_FAIL;
+        }
+
+        m_pMainScene = it->second.get();
+
+        return S_OK;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   Renderer::HandleInput
+      Summary:  Handle user mouse input
+      Args:     DirectionsInput& directions
+                MouseRelativeMovement& mouseRelativeMovement
+                FLOAT deltaTime
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    
+    void Renderer::HandleInput(_In_ const DirectionsInput& directions, _In_ const MouseRelativeMovement& mouseRelativeMovement, _In_ FLOAT deltaTime)
+    {
+        m_camera.HandleInput(directions, mouseRelativeMovement, deltaTime);
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   Renderer::SetCameraLookAt
+      Summary:  Places the camera at an eye looking at a point, for
+                camera paths that are scripted rather than played
+      Args:     const XMVECTOR& eye
+                  Position of the camera
+                const XMVECTOR& at
+                  Point the camera looks at
+      Modifies: [m_camera].
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    void Renderer::SetCameraLookAt(_In_ const XMVECTOR& eye, _In_ const XMVECTOR& at)
+    {
+        m_camera.LookAt(eye, at);
+    }
+
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   Renderer::Update
+      Summary:  Update the renderables each frame
+      Args:     FLOAT deltaTime
+                  Time difference of a frame
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    void Renderer::Update(_In_ FLOAT deltaTime)
+    {
+        PROFILE_SCOPE("Update");
+
+        m_pMainScene->Update(deltaTime);
+
+        m_camera.Update(deltaTime);
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   Renderer::SaveState
+      Summary:  Keeps the state of the camera and of the main scene
+                before a simulation step, the state the frames rendered
+                until the next step blend from
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    void Renderer::SaveState()
+    {
+        m_pMainScene->SaveState();
+
+        m_camera.SaveState();
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   Renderer::Render
+      Summary:  Captures the frame, makes it current and renders it, the
+                three stages of a frame run one after the other
+      Args:     FLOAT alpha
+                  How far the frame is from the state saved before the
+                  last simulation step to the current one, 1 renders the
+                  current state
+      Modifies: [m_interpolationAlpha, m_capturedSnapshot,
+                  m_frameSnapshot, and what RenderFrame modifies].
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    void Renderer::Render(_In_ FLOAT alpha)
+    {
+        CaptureFrame(alpha);
+        SwapFrames();
+        RenderFrame();
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   Renderer::CaptureFrame
+      Summary:  Gathers the main scene and the camera into the captured
+                snapshot, the back one. Only reads the scene and writes
+                state no pass reads, so it may run on the simulation
+                thread while the current frame renders
+      Args:     FLOAT alpha
+                  How far the frame is from the state saved before the
+                  last simulation step to the current one, 1 renders the
+                  current state
+      Modifies: [m_interpolationAlpha, m_capturedSnapshot,
+                  m_snapshotTime, m_shadowCascades].
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    void Renderer::CaptureFrame(_In_ FLOAT alpha)
+    {
+        m_interpolationAlpha = std::clamp(alpha, 0.0f, 1.0f);
+        takeFrameSnapshot();
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   Renderer::SwapFrames
+      Summary:  Makes the captured snapshot the one the passes read.
+                Called between frames, when neither stage runs. The
+                buffers of the two snapshots are swapped, not copied
+      Modifies: [m_frameSnapshot, m_capturedSnapshot].
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    void Renderer::SwapFrames()
+    {
+        std::swap(m_frameSnapshot, m_capturedSnapshot);
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+     Method:   Renderer::RenderFrame
+     Summary:  Render the current frame snapshot. Streamed texture mips
+               are uploaded first. The
+               lights are assigned to the clusters of the view frustum
+               and the constants of the frame are written into the
+               constant ring, the render queue is recorded in parallel into command lists that
+               are executed in order, the skybox is drawn last on the
+               immediate context. The shadow maps are drawn before the
+               main pass samples them. The frame is fenced so that the
+               rings reuse its ranges once the GPU is done with them.
+               Reads nothing of the scene the snapshot does not hold
+               but its static data, so the next frame can be simulated
+               meanwhile. With GPU profiling the passes are timed with
+               timestamp queries read back a few frames later
+     Modifies: [m_constantRing, m_instanceRing, m_uFrameFenceValue,
+             m_lightCuller, m_lightCullingTime, m_shadowAtlas,
+             m_uShadowSlice, m_aShadowCullingStatistics, m_gpuProfiler].
+   M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+
+    void Renderer::RenderFrame()
+    {
+        PROFILE_SCOPE("Render frame");
+
+        const std::chrono::steady_clock::time_point submissionStart = std::chrono::steady_clock::now();
+
+        m_renderContext->ResetStatistics();
+
+        // Mips that finished streaming are uploaded before anything samples them
+        if (m_d3dDevice)
+        {
+            TextureStreamer::GetGlobal().Update(m_immediateContext.Get());
+        }
+
+        // Ranges the GPU is done with can be written again
+        const UINT64 uCompletedFenceValue = m_renderContext->GetCompletedFenceValue();
+        m_constantRing.RetireFrames(uCompletedFenceValue);
+        m_instanceRing.RetireFrames(uCompletedFenceValue);
+
+        m_gpuProfiler.BeginFrame();
+
+        renderShadowMaps();
+
+        {
+            GpuProfileScope mainPassScope(m_gpuProfiler, "Main pass");
+
+            // Just clear the backbuffer
+            m_renderContext->ClearRenderTarget(m_renderTargetView.Get(), Colors::MidnightBlue);
+
+            // Clear depth stencil view
+            // Clear the depth buffer
+            m_renderContext->ClearDepthStencil(m_depthStencilView.Get(), 1.0f);
+
+            // renderables, voxels and models
+            const PassTargets mainTargets = getMainPassTargets();
+            bindFrameState(*m_renderContext, mainTargets);
+            buildRenderQueue(eRenderPass::MAIN, m_frameSnapshot.ViewProjection, m_frameSnapshot.aItems);
+            batchVoxels();
+            if (SUCCEEDED(cullLights()) && SUCCEEDED(uploadConstants(eRenderPass::MAIN)))
+            {
+                submitMainPass(mainTargets);
+
+                //render sky box
+                if (m_frameSnapshot.pSkybox)
+                {
+                    GpuProfileScope skyboxScope(m_gpuProfiler, "Skybox");
+                    recordSkybox(*m_renderContext, *m_frameSnapshot.pSkybox);
+                }
+            }
+        }
+
+        m_submissionTime = std::chrono::duration<FLOAT, std::milli>(std::chrono::steady_clock::now() - submissionStart).count();
+
+        m_gpuProfiler.EndFrame();
+
+        // A headless renderer has nothing to present
+        if (m_swapChain)
+        {
+            PROFILE_SCOPE("Present");
+            m_swapChain->Present(0, 0);
+        }
+
+        m_renderContext->SignalFence(++m_uFrameFenceValue);
+        m_constantRing.EndFrame(m_uFrameFenceValue);
+        m_instanceRing.EndFrame(m_uFrameFenceValue);
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   Renderer::takeFrameSnapshot
+      Summary:  Gathers what the passes of the frame read from the main
+                scene and from the camera: the
+                matrices, the skybox transform, the first light as the
+                shadow caster, the lights packed without the empty
+                slots, and a render item per renderable, voxel and model.
+                The camera and the world matrices are those between the
+                last two simulation steps, at the interpolation alpha.
+                With a shadow map shader, the first packed light casts
+                the cascades, fit around the camera along the shadow
+                direction of the scene, or along the direction from the
+                light to the origin if the scene sets none, and the next
+                ones cast cube shadows
+      Modifies: [m_capturedSnapshot, m_snapshotTime, m_shadowCascades].
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    void Renderer::takeFrameSnapshot()
+    {
+        PROFILE_SCOPE("Snapshot");
+
+        const std::chrono::steady_clock::time_point snapshotStart = std::chrono::steady_clock::now();
+
+        FrameSnapshot& snapshot = m_capturedSnapshot;
+        Scene& scene = *m_pMainScene;
+
+        snapshot.pScene = &scene;
+        snapshot.View = m_camera.GetInterpolatedView(m_interpolationAlpha);
+        snapshot.Projection = m_projection;
+        snapshot.ViewProjection = snapshot.View * snapshot.Projection;
+        snapshot.CameraPosition = m_camera.GetInterpolatedEye(m_interpolationAlpha);
+
+        // The skybox is centered on the camera
+        snapshot.pSkybox = scene.GetSkyBox().get();
+        snapshot.SkyboxWorld = XMMatrixIdentity();
+        if (snapshot.pSkybox)
+        {
+            XMVECTOR scale;
+            XMVECTOR rotation;
+            XMVECTOR translation;
+            XMMatrixDecompose(&scale, &rotation, &translation, snapshot.pSkybox->GetWorldMatrix());
+
+            snapshot.SkyboxWorld = XMMatrixScalingFromVector(scale) * XMMatrixRotationRollPitchYawFromVector(rotation) * XMMatrixTranslationFromVector(snapshot.CameraPosition);
+        }
+
+        // Shadows are cast from the first light
+        const PointLight* pShadowLight = (scene.GetNumPointLights() != 0u) ? scene.GetPointLight(0).get() : nullptr;
+        snapshot.bHasShadowLight = pShadowLight != nullptr;
+        snapshot.LightView = pShadowLight ? pShadowLight->GetViewMatrix() : XMMatrixIdentity();
+        snapshot.LightProjection = pShadowLight ? pShadowLight->GetProjectionMatrix() : XMMatrixIdentity();
+
+        for (XMMATRIX& shadowViewProjection : snapshot.ShadowViewProjections)
+        {
+            shadowViewProjection = XMMatrixIdentity();
+        }
+        snapshot.CascadeSplits = XMFLOAT4(0.0f, 0.0f, 0.0f, 0.0f);
+        snapshot.ShadowLights = XMUINT4(NO_SHADOW_LIGHT, NO_SHADOW_LIGHT, NO_SHADOW_LIGHT, NO_SHADOW_LIGHT);
+        UINT* auShadowLights = &snapshot.ShadowLights.x;
+
+        // Empty slots are skipped, the light index list refers to the packed lights
+        snapshot.aLights.clear();
+        snapshot.aLightSpheres.clear();
+        for (size_t i = 0u; i < scene.GetNumPointLights(); ++i)
+        {
+            const std::shared_ptr<PointLight>& light = scene.GetPointLight(i);
+            if (!light)
+            {
+                continue;
+            }
+
+            const UINT uLight = static_cast<UINT>(snapshot.aLights.size());
+            if (m_shadowVertexShader && uLight <= MAX_NUM_CUBE_SHADOWS)
+            {
+                auShadowLights[uLight] = uLight;
+                for (UINT uFace = 0u; uLight != 0u && uFace < PointLight::NUM_CUBE_FACES; ++uFace)
+                {
+                    snapshot.ShadowViewProjections[NUM_SHADOW_CASCADES + (uLight - 1u) * PointLight::NUM_CUBE_FACES + uFace] = light->GetCubeFaceViewProjection(uFace);
+                }
+            }
+
+            const FLOAT attenuationDistance = light->GetAttenuationDistance();
+            const FLOAT range = light->GetRange();
+            snapshot.aLights.push_back(
+                {
+                    .Position = light->GetPosition(),
+                    .Color = light->GetColor(),
+                    .AttenuationDistance = XMFLOAT4(attenuationDistance, range, attenuationDistance * attenuationDistance, range * range)
+                });
+
+            XMFLOAT3 center;
+            XMStoreFloat3(&center, XMVector3TransformCoord(XMLoadFloat4(&light->GetPosition()), snapshot.View));
+            snapshot.aLightSpheres.push_back({ .Center = { center.x, center.y, center.z }, .Radius = range });
+        }
+
+        if (snapshot.ShadowLights.x != NO_SHADOW_LIGHT)
+        {
+            XMFLOAT4X4 cameraWorld;
+            XMStoreFloat4x4(&cameraWorld, XMMatrixInverse(nullptr, snapshot.View));
+            snapshot.ShadowDirection = scene.HasShadowDirection() ? scene.GetShadowDirection()
+                : XMFLOAT3(-snapshot.aLights[0].Position.x, -snapshot.aLights[0].Position.y, -snapshot.aLights[0].Position.z);
+            m_shadowCascades.Update(&cameraWorld._11, &snapshot.ShadowDirection.x);
+
+            FLOAT* aCascadeSplits = &snapshot.CascadeSplits.x;
+            for (UINT uCascade = 0u; uCascade < NUM_SHADOW_CASCADES; ++uCascade)
+            {
+                snapshot.ShadowViewProjections[uCascade] = XMLoadFloat4x4(reinterpret_cast<const XMFLOAT4X4*>(m_shadowCascades.GetViewProjection(uCascade)));
+                aCascadeSplits[uCascade] = m_shadowCascades.GetSplit(uCascade);
+            }
+        }
+
+        snapshot.aItems.clear();
+        snapshot.aItems.reserve(scene.GetRenderables().size() + scene.GetVoxels().size() + scene.GetModels().size());
+
+        for (auto it_renderables = scene.GetRenderables().begin(); it_renderables != scene.GetRenderables().end(); it_renderables++)
+        {
+            snapshot.aItems.push_back({ .eType = eRenderItemType::RENDERABLE, .pRenderable = it_renderables->second.get(), .World = {},
+                .uFirstMeshVisibility = RenderItem::NO_VISIBILITY, .uFirstInstanceVisibility = RenderItem::NO_VISIBILITY,
+                .instanceBuffer = nullptr, .uFirstInstance = 0u, .uNumInstances = 0u,
+                .objectConstants = {}, .skinningConstants = {}, .uFirstBone = 0u, .uNumBones = 0u });
+        }
+
+        for (auto voxels = scene.GetVoxels().begin(); voxels != scene.GetVoxels().end(); voxels++)
+        {
+            snapshot.aItems.push_back({ .eType = eRenderItemType::VOXEL, .pRenderable = voxels->get(), .World = {},
+                .uFirstMeshVisibility = RenderItem::NO_VISIBILITY, .uFirstInstanceVisibility = RenderItem::NO_VISIBILITY,
+                .instanceBuffer = (*voxels)->GetInstanceBuffer().Get(), .uFirstInstance = 0u, .uNumInstances = (*voxels)->GetNumInstances(),
+                .objectConstants = {}, .skinningConstants = {}, .uFirstBone = 0u, .uNumBones = 0u });
+        }
+
+        // Animation changes the bones while the snapshot renders, they are copied
+        snapshot.aBoneTransforms.clear();
+        for (auto it_models = scene.GetModels().begin(); it_models != scene.GetModels().end(); it_models++)
+        {
+            const std::vector<XMMATRIX>& aBoneTransforms = it_models->second->GetBoneTransforms();
+            const UINT uFirstBone = static_cast<UINT>(snapshot.aBoneTransforms.size());
+            const UINT uNumBones = static_cast<UINT>(std::min<size_t>(aBoneTransforms.size(), MAX_NUM_BONES));
+            snapshot.aBoneTransforms.insert(snapshot.aBoneTransforms.end(), aBoneTransforms.begin(), aBoneTransforms.begin() + uNumBones);
+
+            snapshot.aItems.push_back({ .eType = eRenderItemType::MODEL, .pRenderable = it_models->second.get(), .World = {},
+                .uFirstMeshVisibility = RenderItem::NO_VISIBILITY, .uFirstInstanceVisibility = RenderItem::NO_VISIBILITY,
+                .instanceBuffer = nullptr, .uFirstInstance = 0u, .uNumInstances = 0u,
+                .objectConstants = {}, .skinningConstants = {}, .uFirstBone = uFirstBone, .uNumBones = uNumBones });
+        }
+
+        // Every pass draws an object where the frame is between the last two steps
+        for (RenderItem& item : snapshot.aItems)
+        {
+            XMStoreFloat4x4(&item.World, item.pRenderable->GetInterpolatedWorldMatrix(m_interpolationAlpha));
+        }
+
+        // The static shadow layers stay valid as long as no voxel is added, moved or given new instances
+        snapshot.aStaticCasters.clear();
+        snapshot.aDynamicCasters.clear();
+        snapshot.uStaticCasterRevision = ShadowAtlas::HASH_OFFSET_BASIS;
+        for (const RenderItem& item : snapshot.aItems)
+        {
+            if (item.eType != eRenderItemType::VOXEL)
+            {
+                snapshot.aDynamicCasters.push_back(item);
+                continue;
+            }
+
+            const Voxel& voxel = static_cast<const Voxel&>(*item.pRenderable);
+            const UINT64 uRevision = voxel.GetRevision();
+            snapshot.uStaticCasterRevision = ShadowAtlas::Hash(&item.pRenderable, sizeof(item.pRenderable), snapshot.uStaticCasterRevision);
+            snapshot.uStaticCasterRevision = ShadowAtlas::Hash(&uRevision, sizeof(uRevision), snapshot.uStaticCasterRevision);
+            snapshot.uStaticCasterRevision = ShadowAtlas::Hash(&item.World, sizeof(item.World), snapshot.uStaticCasterRevision);
+            snapshot.aStaticCasters.push_back(item);
+        }
+
+        m_snapshotTime = std::chrono::duration<FLOAT, std::milli>(std::chrono::steady_clock::now() - snapshotStart).count();
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   Renderer::buildRenderQueue
+      Summary:  Copies render items of the frame snapshot into the
+                render queue and culls it against the frustum of the
+                pass
+      Args:     eRenderPass pass
+                  Pass the queue is built for
+                const XMMATRIX& viewProjection
+                  View projection matrix of the pass
+                const std::vector<RenderItem>& aItems
+                  Items of the frame snapshot the pass draws
+      Modifies: [m_aRenderQueue, m_aCullingStatistics].
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    void Renderer::buildRenderQueue(_In_ eRenderPass pass, _In_ const XMMATRIX& viewProjection, _In_ const std::vector<RenderItem>& aItems)
+    {
+        PROFILE_SCOPE("Build render queue");
+
+        m_aRenderQueue.assign(aItems.begin(), aItems.end());
+
+        m_aCullingStatistics[static_cast<size_t>(pass)] = {};
+        if (m_bFrustumCulling)
+        {
+            cullRenderQueue(pass, viewProjection);
+        }
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   Renderer::cullRenderQueue
+      Summary:  Culls the objects of the render queue against the
+                frustum in one batch, then the instances of the voxels
+                in batches spread over the submission threads. The main
+                pass then draws the occluders and removes what they
+                hide. The visible instances are written into the
+                instance ring, finally the items left are compacted and
+                the meshes of the multi-mesh ones are culled the same
+                way
+      Args:     eRenderPass pass
+                  Pass the queue is culled for
+                const XMMATRIX& viewProjection
+                  View projection matrix of the pass
+      Modifies: [m_aRenderQueue, m_frustumCuller, m_objectBounds,
+                  m_meshBounds, m_aObjectVisibility, m_aMeshVisibility,
+                  m_aInstanceVisibility, m_aInstanceBatches,
+                  m_aCullingStatistics, m_occlusionCuller, m_aOccluders,
+                  m_instanceRing].
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    void Renderer::cullRenderQueue(_In_ eRenderPass pass, _In_ const XMMATRIX& viewProjection)
+    {
+        PROFILE_SCOPE("Frustum culling");
+
+        CullingStatistics& statistics = m_aCullingStatistics[static_cast<size_t>(pass)];
+        const BOOL bOcclusionCulling = m_bOcclusionCulling && pass == eRenderPass::MAIN;
+
+        XMFLOAT4X4 viewProjectionMatrix;
+        XMStoreFloat4x4(&viewProjectionMatrix, viewProjection);
+        m_frustumCuller.SetViewProjection(&viewProjectionMatrix._11);
+
+        // Objects, bounds are transformed to world space
+        const UINT uNumItems = static_cast<UINT>(m_aRenderQueue.size());
+        m_objectBounds.Clear();
+        m_objectBounds.Reserve(uNumItems);
+        for (const RenderItem& item : m_aRenderQueue)
+        {
+            m_objectBounds.Add(FrustumCuller::TransformBox(item.pRenderable->GetBounds(), &item.World._11));
+        }
+
+        m_aObjectVisibility.resize(uNumItems);
+        statistics.uNumVisibleObjects = m_frustumCuller.Cull(m_objectBounds, m_aObjectVisibility.data());
+        statistics.uNumCulledObjects = uNumItems - statistics.uNumVisibleObjects;
+
+        // Instances of the voxels inside the frustum, culled in object space
+        m_aInstanceBatches.clear();
+        UINT uNumTestedInstances = 0u;
+        for (UINT i = 0u; i < uNumItems; ++i)
+        {
+            RenderItem& item = m_aRenderQueue[i];
+            if (!m_aObjectVisibility[i] || item.eType != eRenderItemType::VOXEL)
+            {
+                continue;
+            }
+
+            XMFLOAT4X4 worldViewProjection;
+            XMStoreFloat4x4(&worldViewProjection, XMLoadFloat4x4(&item.World) * viewProjection);
+
+            const UINT uNumInstances = static_cast<const Voxel&>(*item.pRenderable).GetInstanceBounds().GetNumBoxes();
+            item.uFirstInstanceVisibility = uNumTestedInstances;
+            for (UINT uFirst = 0u; uFirst < uNumInstances; uFirst += INSTANCES_PER_CULLING_BATCH)
+            {
+                m_aInstanceBatches.push_back({ .WorldViewProjection = worldViewProjection, .uItem = i, .uFirstInstance = uFirst,
+                    .uNumInstances = std::min(INSTANCES_PER_CULLING_BATCH, uNumInstances - uFirst), .uNumVisible = 0u, .uRingOffset = 0u });
+            }
+            uNumTestedInstances += uNumInstances;
+        }
+        m_aInstanceVisibility.resize(uNumTestedInstances);
+
+        const UINT uNumBatches = static_cast<UINT>(m_aInstanceBatches.size());
+        m_submissionThreadPool.Dispatch(uNumBatches, [this](UINT uBatch)
+            {
+                InstanceBatch& batch = m_aInstanceBatches[uBatch];
+                const RenderItem& item = m_aRenderQueue[batch.uItem];
+
+                FrustumCuller instanceCuller;
+                instanceCuller.SetViewProjection(&batch.WorldViewProjection._11);
+                batch.uNumVisible = instanceCuller.Cull(static_cast<const Voxel&>(*item.pRenderable).GetInstanceBounds(), batch.uFirstInstance, batch.uNumInstances,
+                    m_aInstanceVisibility.data() + item.uFirstInstanceVisibility + batch.uFirstInstance);
+            });
+
+        statistics.uNumTestedInstances = uNumTestedInstances;
+        for (const InstanceBatch& batch : m_aInstanceBatches)
+        {
+            statistics.uNumVisibleInstances += batch.uNumVisible;
+        }
+        statistics.uNumCulledInstances = uNumTestedInstances - statistics.uNumVisibleInstances;
+
+        // Occlusion of the objects and instances that survived the frustum
+        if (bOcclusionCulling)
+        {
+            rasterizeOccluders(viewProjection);
+            statistics.uNumOccluderTriangles = m_occlusionCuller.GetNumRasterizedTriangles();
+
+            const UINT uNumUnoccludedObjects = m_occlusionCuller.Cull(m_objectBounds, &viewProjectionMatrix._11, m_aObjectVisibility.data());
+            statistics.uNumOccludedObjects = statistics.uNumVisibleObjects - uNumUnoccludedObjects;
+            statistics.uNumVisibleObjects = uNumUnoccludedObjects;
+
+            // The depth hierarchy is only read from here on
+            m_submissionThreadPool.Dispatch(uNumBatches, [this](UINT uBatch)
+                {
+                    InstanceBatch& batch = m_aInstanceBatches[uBatch];
+                    const RenderItem& item = m_aRenderQueue[batch.uItem];
+                    if (!m_aObjectVisibility[batch.uItem])
+                    {
+                        batch.uNumVisible = 0u;
+                        return;
+                    }
+
+                    batch.uNumVisible = m_occlusionCuller.Cull(static_cast<const Voxel&>(*item.pRenderable).GetInstanceBounds(), batch.uFirstInstance, batch.uNumInstances,
+                        &batch.WorldViewProjection._11, m_aInstanceVisibility.data() + item.uFirstInstanceVisibility + batch.uFirstInstance);
+                });
+
+            UINT uNumUnoccludedInstances = 0u;
+            for (const InstanceBatch& batch : m_aInstanceBatches)
+            {
+                uNumUnoccludedInstances += batch.uNumVisible;
+            }
+            statistics.uNumOccludedInstances = statistics.uNumVisibleInstances - uNumUnoccludedInstances;
+            statistics.uNumVisibleInstances = uNumUnoccludedInstances;
+        }
+
+        compactInstances(pass);
+
+        UINT uNumVisibleItems = 0u;
+        for (UINT i = 0u; i < uNumItems; ++i)
+        {
+            if (m_aObjectVisibility[i])
+            {
+                m_aRenderQueue[uNumVisibleItems++] = m_aRenderQueue[i];
+            }
+        }
+        m_aRenderQueue.resize(uNumVisibleItems);
+
+        // Meshes of the visible objects made of more than one mesh
+        m_meshBounds.Clear();
+        for (RenderItem& item : m_aRenderQueue)
+        {
+            const Renderable& renderable = *item.pRenderable;
+            if (item.eType == eRenderItemType::VOXEL || renderable.GetNumMeshes() <= 1u)
+            {
+                continue;
+            }
+
+            const XMFLOAT4X4& world = item.World;
+            item.uFirstMeshVisibility = m_meshBounds.GetNumBoxes();
+            for (UINT i = 0u; i < renderable.GetNumMeshes(); ++i)
+            {
+                m_meshBounds.Add(FrustumCuller::TransformBox(renderable.GetMesh(i).Bounds, &world._11));
+            }
+        }
+
+        m_aMeshVisibility.resize(m_meshBounds.GetNumBoxes());
+        statistics.uNumVisibleMeshes = m_frustumCuller.Cull(m_meshBounds, m_aMeshVisibility.data());
+        statistics.uNumCulledMeshes = m_meshBounds.GetNumBoxes() - statistics.uNumVisibleMeshes;
+
+        if (bOcclusionCulling)
+        {
+            const UINT uNumUnoccludedMeshes = m_occlusionCuller.Cull(m_meshBounds, &viewProjectionMatrix._11, m_aMeshVisibility.data());
+            statistics.uNumOccludedMeshes = statistics.uNumVisibleMeshes - uNumUnoccludedMeshes;
+            statistics.uNumVisibleMeshes = uNumUnoccludedMeshes;
+        }
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   Renderer::compactInstances
+      Summary:  Writes the visible instances of the visible voxels
+                back to back into the instance ring and points their
+                render items at it, so that only those are drawn. The
+                ring is mapped once per pass with NO_OVERWRITE, or
+                DISCARD when it has to be renamed, and the batches are
+                copied in parallel. Voxels left without a visible
+                instance are removed from the queue. When the ring
+                cannot hold the pass, the voxels keep drawing their
+                whole buffer
+      Args:     eRenderPass pass
+                  Pass the queue is culled for
+      Modifies: [m_aRenderQueue, m_aObjectVisibility, m_aInstanceBatches,
+                  m_instanceRing, m_aCullingStatistics].
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    void Renderer::compactInstances(_In_ eRenderPass pass)
+    {
+        UINT uNumInstances = 0u;
+        for (InstanceBatch& batch : m_aInstanceBatches)
+        {
+            batch.uRingOffset = uNumInstances;
+            if (m_aObjectVisibility[batch.uItem])
+            {
+                uNumInstances += batch.uNumVisible;
+            }
+        }
+
+        UINT uRingOffset = 0u;
+        BOOL bDiscard = FALSE;
+        InstanceData* aRingInstances = nullptr;
+        if (uNumInstances > 0u && m_instanceRing.Allocate(uNumInstances, 1u, &uRingOffset, &bDiscard))
+        {
+            aRingInstances = static_cast<InstanceData*>(m_renderContext->MapBuffer(m_instanceRingBuffer.Get(),
+                bDiscard ? eMapMode::WRITE_DISCARD : eMapMode::WRITE_NO_OVERWRITE, m_instanceRing.GetCapacity() * sizeof(InstanceData)));
+        }
+
+        if (aRingInstances)
+        {
+            m_submissionThreadPool.Dispatch(static_cast<UINT>(m_aInstanceBatches.size()), [this, aRingInstances, uRingOffset](UINT uBatch)
+                {
+                    const InstanceBatch& batch = m_aInstanceBatches[uBatch];
+                    if (!m_aObjectVisibility[batch.uItem] || batch.uNumVisible == 0u)
+                    {
+                        return;
+                    }
+
+                    const RenderItem& item = m_aRenderQueue[batch.uItem];
+                    const InstanceData* aInstances = static_cast<const Voxel&>(*item.pRenderable).GetInstanceData() + batch.uFirstInstance;
+                    const BYTE* aVisible = m_aInstanceVisibility.data() + item.uFirstInstanceVisibility + batch.uFirstInstance;
+
+                    InstanceData* pDestination = aRingInstances + uRingOffset + batch.uRingOffset;
+                    for (UINT i = 0u; i < batch.uNumInstances; ++i)
+                    {
+                        if (aVisible[i])
+                        {
+                            *pDestination++ = aInstances[i];
+                        }
+                    }
+                });
+
+            m_renderContext->UnmapBuffer(m_instanceRingBuffer.Get(), uNumInstances * static_cast<UINT>(sizeof(InstanceData)));
+            m_aCullingStatistics[static_cast<size_t>(pass)].uNumUploadedInstances = uNumInstances;
+        }
+
+        // Batches of a voxel are contiguous
+        const UINT uNumBatches = static_cast<UINT>(m_aInstanceBatches.size());
+        for (UINT uBatch = 0u; uBatch < uNumBatches;)
+        {
+            const UINT uItem = m_aInstanceBatches[uBatch].uItem;
+            const UINT uFirstRingInstance = uRingOffset + m_aInstanceBatches[uBatch].uRingOffset;
+            UINT uNumVisible = 0u;
+            for (; uBatch < uNumBatches && m_aInstanceBatches[uBatch].uItem == uItem; ++uBatch)
+            {
+                uNumVisible += m_aInstanceBatches[uBatch].uNumVisible;
+            }
+
+            if (!m_aObjectVisibility[uItem])
+            {
+                continue;
+            }
+
+            if (uNumVisible == 0u)
+            {
+                m_aObjectVisibility[uItem] = 0u;
+            }
+            else if (aRingInstances)
+            {
+                RenderItem& item = m_aRenderQueue[uItem];
+                item.instanceBuffer = m_instanceRingBuffer.Get();
+                item.uFirstInstance = uFirstRingInstance;
+                item.uNumInstances = uNumVisible;
+            }
+        }
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   Renderer::batchVoxels
+      Summary:  Merges the voxels of the main queue whose instances
+                follow each other in the instance ring into a single
+                item, drawn by one instanced call. Their instances carry
+                the index of their material, so the voxel types of the
+                batch still look their own. Only the instances culling
+                compacted into the ring are contiguous, so nothing is
+                merged with the frustum culling disabled
+      Modifies: [m_aRenderQueue].
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    void Renderer::batchVoxels()
+    {
+        PROFILE_SCOPE("Batch voxels");
+
+        if (!m_bVoxelBatching || m_aRenderQueue.empty())
+        {
+            return;
+        }
+
+        size_t uNumItems = 1u;
+        for (size_t i = 1u; i < m_aRenderQueue.size(); ++i)
+        {
+            RenderItem& batch = m_aRenderQueue[uNumItems - 1u];
+            if (canBatchVoxels(batch, m_aRenderQueue[i]))
+            {
+                batch.uNumInstances += m_aRenderQueue[i].uNumInstances;
+                continue;
+            }
+
+            m_aRenderQueue[uNumItems++] = m_aRenderQueue[i];
+        }
+        m_aRenderQueue.resize(uNumItems);
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   Renderer::canBatchVoxels
+      Summary:  Tells whether a voxel can be drawn by the call of the
+                batch before it: its instances must follow those of the
+                batch in the instance ring, both must share the shaders,
+                the normal map and the world matrix, and neither may
+                have its texture bound instead of packed in the atlas
+      Args:     const RenderItem& batch
+                  Last item of the compacted queue
+                const RenderItem& item
+                  Next item of the queue
+      Returns:  BOOL
+                  TRUE if the item can join the batch
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    BOOL Renderer::canBatchVoxels(_In_ const RenderItem& batch, _In_ const RenderItem& item) const
+    {
+        if (batch.eType != eRenderItemType::VOXEL || item.eType != eRenderItemType::VOXEL
+            || batch.instanceBuffer != m_instanceRingBuffer.Get() || item.instanceBuffer != m_instanceRingBuffer.Get()
+            || batch.uFirstInstance + batch.uNumInstances != item.uFirstInstance)
+        {
+            return FALSE;
+        }
+
+        Voxel& batchVoxel = static_cast<Voxel&>(*batch.pRenderable);
+        Voxel& voxel = static_cast<Voxel&>(*item.pRenderable);
+        if (m_aVoxelMaterials.size() <= std::max(batchVoxel.GetMaterialIndex(), voxel.GetMaterialIndex())
+            || m_aVoxelMaterials[batchVoxel.GetMaterialIndex()].Texture.x == VOXEL_TEXTURE_BOUND
+            || m_aVoxelMaterials[voxel.GetMaterialIndex()].Texture.x == VOXEL_TEXTURE_BOUND)
+        {
+            return FALSE;
+        }
+
+        if (batchVoxel.GetVertexShader() != voxel.GetVertexShader() || batchVoxel.GetPixelShader() != voxel.GetPixelShader()
+            || batchVoxel.GetVertexLayout() != voxel.GetVertexLayout() || batchVoxel.GetShaderFeatures() != voxel.GetShaderFeatures())
+        {
+            return FALSE;
+        }
+
+        if (voxel.HasNormalMap() && batchVoxel.GetMaterial(0u)->pNormal != voxel.GetMaterial(0u)->pNormal)
+        {
+            return FALSE;
+        }
+
+        return memcmp(&batch.World, &item.World, sizeof(item.World)) == 0;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   Renderer::cullLights
+      Summary:  Uploads the lights of the frame snapshot into the light
+                buffer and assigns their spheres of influence to the
+                clusters of the view frustum, interleaved depth slices
+                per submission thread. The range of every cluster and
+                the light index list are then uploaded for the pixel
+                shaders
+      Modifies: [m_lightCuller, m_lightCullingTime].
+      Returns:  HRESULT
+                  Status code
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    HRESULT Renderer::cullLights()
+    {
+        PROFILE_SCOPE("Light culling");
+
+        const std::chrono::steady_clock::time_point cullingStart = std::chrono::steady_clock::now();
+
+        const UINT uNumLights = static_cast<UINT>(m_frameSnapshot.aLights.size());
+        const UINT uLightsSize = uNumLights * static_cast<UINT>(sizeof(PointLightData));
+        void* pLights = m_renderContext->MapBuffer(m_lightBuffer.Get(), eMapMode::WRITE_DISCARD, MAX_NUM_LIGHTS * static_cast<UINT>(sizeof(PointLightData)));
+        if (!pLights)
+        {
+            return E_FAIL;
+        }
+        memcpy(pLights, m_frameSnapshot.aLights.data(), uLightsSize);
+        m_renderContext->UnmapBuffer(m_lightBuffer.Get(), uLightsSize);
+
+        m_lightCuller.BeginFrame(m_frameSnapshot.aLightSpheres.data(), uNumLights);
+        const UINT uNumTasks = std::max(1u, std::min(m_uNumSubmissionThreads, uNumLights / MIN_LIGHTS_PER_CULLING_TASK));
+        m_submissionThreadPool.Dispatch(uNumTasks, [this, uNumTasks](UINT uTask)
+            {
+                // Near slices hold more lights, interleaving spreads them
+                for (UINT uSlice = uTask; uSlice < ClusteredLightCuller::NUM_CLUSTERS_Z; uSlice += uNumTasks)
+                {
+                    m_lightCuller.AssignSlice(uSlice);
+                }
+            });
+        m_lightCuller.EndFrame();
+
+        const UINT uClusterRangesSize = ClusteredLightCuller::NUM_CLUSTERS * 2u * static_cast<UINT>(sizeof(UINT));
+        void* pClusterRanges = m_renderContext->MapBuffer(m_clusterRangeBuffer.Get(), eMapMode::WRITE_DISCARD, uClusterRangesSize);
+        if (!pClusterRanges)
+        {
+            return E_FAIL;
+        }
+        memcpy(pClusterRanges, m_lightCuller.GetClusterRanges(), uClusterRangesSize);
+        m_renderContext->UnmapBuffer(m_clusterRangeBuffer.Get(), uClusterRangesSize);
+
+        // Every cluster is empty without indices, nothing reads the list
+        const UINT uLightIndicesSize = m_lightCuller.GetNumLightIndices() * static_cast<UINT>(sizeof(UINT));
+        if (uLightIndicesSize != 0u)
+        {
+            void* pLightIndices = m_renderContext->MapBuffer(m_lightIndexBuffer.Get(), eMapMode::WRITE_DISCARD, ClusteredLightCuller::MAX_LIGHT_INDICES * static_cast<UINT>(sizeof(UINT)));
+            if (!pLightIndices)
+            {
+                return E_FAIL;
+            }
+            memcpy(pLightIndices, m_lightCuller.GetLightIndices(), uLightIndicesSize);
+            m_renderContext->UnmapBuffer(m_lightIndexBuffer.Get(), uLightIndicesSize);
+        }
+
+        m_lightCullingTime = std::chrono::duration<FLOAT, std::milli>(std::chrono::steady_clock::now() - cullingStart).count();
+
+        return S_OK;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   Renderer::uploadConstants
+      Summary:  Writes the constants of a pass into one block of the
+                constant ring and points the render queue at them. The
+                main pass block starts with the camera, projection,
+                lights, skybox and shadow constants. Every item then gets its
+                own range, a model of the main pass one more for its
+                bones, so recording only binds ranges. The ring grows
+                when the block does not fit
+      Args:     eRenderPass pass
+                  Pass the render queue was built for
+      Modifies: [m_aRenderQueue, m_constantRingBuffer, m_constantRing,
+                  m_cameraConstants, m_resizeConstants,
+                  m_lightsConstants, m_skyboxConstants,
+                  m_shadowsConstants].
+      Returns:  HRESULT
+                  Status code
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    HRESULT Renderer::uploadConstants(_In_ eRenderPass pass)
+    {
+        PROFILE_SCOPE("Upload constants");
+
+        HRESULT hr = S_OK;
+
+        const FrameSnapshot& snapshot = m_frameSnapshot;
+        const Skybox* pSkybox = snapshot.pSkybox;
+        const UINT uObjectSize = (pass == eRenderPass::SHADOW) ? sizeof(CBShadowMatrix) : sizeof(CBChangesEveryFrame);
+
+        // Lay the block out, ranges are relative to its start for now
+        UINT uBlockSize = 0u;
+        auto reserve = [&uBlockSize](UINT uSize)
+        {
+            const ConstantBufferRange range =
+            {
+                .buffer = nullptr,
+                .uFirstConstant = uBlockSize / RenderContext::CONSTANT_SIZE,
+                .uNumConstants = alignConstantSize(uSize) / RenderContext::CONSTANT_SIZE
+            };
+            uBlockSize += alignConstantSize(uSize);
+            return range;
+        };
+
+        if (pass == eRenderPass::MAIN)
+        {
+            m_cameraConstants = reserve(sizeof(CBChangeOnCameraMovement));
+            m_resizeConstants = reserve(sizeof(CBChangeOnResize));
+            m_lightsConstants = reserve(sizeof(CBLights));
+            m_skyboxConstants = pSkybox ? reserve(sizeof(CBChangesEveryFrame)) : ConstantBufferRange();
+            m_shadowsConstants = reserve(sizeof(CBShadows));
+        }
+
+        for (RenderItem& item : m_aRenderQueue)
+        {
+            item.objectConstants = reserve(uObjectSize);
+            item.skinningConstants = (pass == eRenderPass::MAIN && item.eType == eRenderItemType::MODEL) ? reserve(sizeof(CBSkinning)) : ConstantBufferRange();
+        }
+
+        if (uBlockSize == 0u)
+        {
+            return S_OK;
+        }
+
+        if (uBlockSize > m_constantRing.GetCapacity())
+        {
+            hr = createConstantRing(std::bit_ceil(uBlockSize));
+            if (FAILED(hr))
+            {
+                return hr;
+            }
+        }
+
+        UINT uBlockOffset = 0u;
+        BOOL bDiscard = FALSE;
+        if (!m_constantRing.Allocate(uBlockSize, RenderContext::CONSTANT_BUFFER_ALIGNMENT, &uBlockOffset, &bDiscard))
+        {
+            return E_OUTOFMEMORY;
+        }
+
+        BYTE* pRing = static_cast<BYTE*>(m_renderContext->MapBuffer(m_constantRingBuffer.Get(),
+            bDiscard ? eMapMode::WRITE_DISCARD : eMapMode::WRITE_NO_OVERWRITE, m_constantRing.GetCapacity()));
+        if (!pRing)
+        {
+            return E_FAIL;
+        }
+        BYTE* pBlock = pRing + uBlockOffset;
+
+        if (pass == eRenderPass::MAIN)
+        {
+            CBChangeOnCameraMovement cbView =
+            {
+                .View = XMMatrixTranspose(snapshot.View)
+            };
+            XMStoreFloat4(&cbView.CameraPosition, snapshot.CameraPosition);
+            memcpy(pBlock + m_cameraConstants.uFirstConstant * RenderContext::CONSTANT_SIZE, &cbView, sizeof(cbView));
+
+            const CBChangeOnResize cbChangesOnResize =
+            {
+                .Projection = XMMatrixTranspose(snapshot.Projection)
+            };
+            memcpy(pBlock + m_resizeConstants.uFirstConstant * RenderContext::CONSTANT_SIZE, &cbChangesOnResize, sizeof(cbChangesOnResize));
+
+            // The lights themselves are in the light buffer, filled by cullLights
+            const CBLights cbLights =
+            {
+                .LightView = XMMatrixTranspose(snapshot.LightView),
+                .LightProjection = XMMatrixTranspose(snapshot.LightProjection),
+                .ClusterScale = XMFLOAT4(
+                    static_cast<FLOAT>(ClusteredLightCuller::NUM_CLUSTERS_X) / static_cast<FLOAT>(m_uWidth),
+                    static_cast<FLOAT>(ClusteredLightCuller::NUM_CLUSTERS_Y) / static_cast<FLOAT>(m_uHeight),
+                    m_lightCuller.GetSliceScale(),
+                    m_lightCuller.GetSliceBias()),
+                .ClusterCounts = XMUINT4(ClusteredLightCuller::NUM_CLUSTERS_X, ClusteredLightCuller::NUM_CLUSTERS_Y, ClusteredLightCuller::NUM_CLUSTERS_Z, static_cast<UINT>(snapshot.aLights.size()))
+            };
+            memcpy(pBlock + m_lightsConstants.uFirstConstant * RenderContext::CONSTANT_SIZE, &cbLights, sizeof(cbLights));
+
+            if (pSkybox)
+            {
+                const CBChangesEveryFrame cbChangeEveryFrame =
+                {
+                    .World = XMMatrixTranspose(snapshot.SkyboxWorld),
+                    .OutputColor = pSkybox->GetOutputColor()
+                };
+                memcpy(pBlock + m_skyboxConstants.uFirstConstant * RenderContext::CONSTANT_SIZE, &cbChangeEveryFrame, sizeof(cbChangeEveryFrame));
+            }
+
+            CBShadows cbShadows =
+            {
+                .CascadeSplits = snapshot.CascadeSplits,
+                .ShadowLights = snapshot.ShadowLights,
+                .ShadowParameters = XMFLOAT4(CASCADE_DEPTH_BIAS, CUBE_DEPTH_BIAS, 1.0f / static_cast<FLOAT>(SHADOW_MAP_SIZE), 0.0f)
+            };
+            for (UINT i = 0u; i < NUM_SHADOW_CASCADES; ++i)
+            {
+                cbShadows.CascadeViewProjections[i] = XMMatrixTranspose(snapshot.ShadowViewProjections[i]);
+            }
+            for (UINT i = 0u; i < MAX_NUM_CUBE_SHADOWS * PointLight::NUM_CUBE_FACES; ++i)
+            {
+                cbShadows.CubeViewProjections[i] = XMMatrixTranspose(snapshot.ShadowViewProjections[NUM_SHADOW_CASCADES + i]);
+            }
+            memcpy(pBlock + m_shadowsConstants.uFirstConstant * RenderContext::CONSTANT_SIZE, &cbShadows, sizeof(cbShadows));
+        }
+
+        const UINT uNumItems = static_cast<UINT>(m_aRenderQueue.size());
+        const UINT uNumTasks = std::max(1u, std::min(m_uNumSubmissionThreads, uNumItems / MIN_ITEMS_PER_SUBMISSION_TASK));
+        m_submissionThreadPool.Dispatch(uNumTasks, [this, pass, pBlock, uNumItems, uNumTasks](UINT uTask)
+            {
+                const UINT uBegin = uNumItems * uTask / uNumTasks;
+                const UINT uEnd = uNumItems * (uTask + 1u) / uNumTasks;
+                for (UINT i = uBegin; i < uEnd; ++i)
+                {
+                    writeObjectConstants(pass, m_aRenderQueue[i], pBlock);
+                }
+            });
+
+        m_renderContext->UnmapBuffer(m_constantRingBuffer.Get(), uBlockSize);
+
+        // Rebase the ranges onto the ring
+        const UINT uFirstConstant = uBlockOffset / RenderContext::CONSTANT_SIZE;
+        auto rebase = [this, uFirstConstant](ConstantBufferRange& range)
+        {
+            if (range.uNumConstants != 0u)
+            {
+                range.buffer = m_constantRingBuffer.Get();
+                range.uFirstConstant += uFirstConstant;
+            }
+        };
+
+        if (pass == eRenderPass::MAIN)
+        {
+            rebase(m_cameraConstants);
+            rebase(m_resizeConstants);
+            rebase(m_lightsConstants);
+            rebase(m_skyboxConstants);
+            rebase(m_shadowsConstants);
+        }
+
+        for (RenderItem& item : m_aRenderQueue)
+        {
+            rebase(item.objectConstants);
+            rebase(item.skinningConstants);
+        }
+
+        return S_OK;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   Renderer::writeObjectConstants
+      Summary:  Writes the constants of an item of the render queue at
+                its ranges in the block of the pass. Called from the
+                submission threads, items do not share ranges
+      Args:     eRenderPass pass
+                  Pass the render queue was built for
+                const RenderItem& item
+                  Item of the render queue
+                BYTE* pBlock
+                  Start of the block of the pass in the mapped ring
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    void Renderer::writeObjectConstants(_In_ eRenderPass pass, _In_ const RenderItem& item, _Out_ BYTE* pBlock) const
+    {
+        //   You must transpose the matrices when passing them to GPU!!
+        //   XMMATRIX is a row - major matrix, however HLSL expects column - major matrix
+        const Renderable& renderable = *item.pRenderable;
+        BYTE* pObjectConstants = pBlock + item.objectConstants.uFirstConstant * RenderContext::CONSTANT_SIZE;
+
+        if (pass == eRenderPass::SHADOW)
+        {
+            const CBShadowMatrix cb =
+            {
+                .World = XMMatrixTranspose(XMLoadFloat4x4(&item.World)),
+                .ViewProjection = XMMatrixTranspose(m_frameSnapshot.ShadowViewProjections[m_uShadowSlice])
+            };
+            memcpy(pObjectConstants, &cb, sizeof(cb));
+            return;
+        }
+
+        if (item.eType != eRenderItemType::MODEL)
+        {
+            const CBChangesEveryFrame cb =
+            {
+                .World = XMMatrixTranspose(XMLoadFloat4x4(&item.World)),
+                .OutputColor = renderable.GetOutputColor()
+            };
+            memcpy(pObjectConstants, &cb, sizeof(cb));
+            return;
+        }
+
+        const Model& model = static_cast<const Model&>(renderable);
+        const CBChangesEveryFrame cb =
+        {
+            .World = XMMatrixTranspose(XMLoadFloat4x4(&item.World)),
+            .OutputColor = model.GetOutputColor()
+        };
+        memcpy(pObjectConstants, &cb, sizeof(cb));
+
+        // Bones are written in place, the unused ones are cleared
+        CBSkinning* pSkinning = reinterpret_cast<CBSkinning*>(pBlock + item.skinningConstants.uFirstConstant * RenderContext::CONSTANT_SIZE);
+        const UINT uNumBones = item.uNumBones;
+        for (UINT i = 0u; i < uNumBones; ++i)
+        {
+            pSkinning->BoneTransforms[i] = XMMatrixTranspose(m_frameSnapshot.aBoneTransforms[item.uFirstBone + i]);
+        }
+        memset(&pSkinning->BoneTransforms[uNumBones], 0, (MAX_NUM_BONES - uNumBones) * sizeof(XMMATRIX));
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   Renderer::rasterizeOccluders
+      Summary:  Draws the occluders of the main pass into the occlusion
+                culler. Voxel instances and static renderables inside
+                the frustum that cover enough of the screen are
+                candidates, the largest are drawn first until the
+                triangle budget is spent
+      Args:     const XMMATRIX& viewProjection
+                  View projection matrix of the camera
+      Modifies: [m_occlusionCuller, m_aOccluders].
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    void Renderer::rasterizeOccluders(_In_ const XMMATRIX& viewProjection)
+    {
+        PROFILE_SCOPE("Occlusion culling");
+
+        const XMVECTOR eye = m_frameSnapshot.CameraPosition;
+        auto getScreenSize = [&eye](const AxisAlignedBox& box)
+        {
+            const FLOAT distance = XMVectorGetX(XMVector3Length(XMVectorSubtract(XMVectorSet(box.Center[0], box.Center[1], box.Center[2], 1.0f), eye)));
+            const FLOAT radius = std::sqrt(box.Extents[0] * box.Extents[0] + box.Extents[1] * box.Extents[1] + box.Extents[2] * box.Extents[2]);
+            return distance > radius ? radius / distance : FLT_MAX;
+        };
+
+        m_occlusionCuller.BeginFrame();
+
+        m_aOccluders.clear();
+        for (UINT i = 0u; i < m_aRenderQueue.size(); ++i)
+        {
+            const RenderItem& item = m_aRenderQueue[i];
+            if (!m_aObjectVisibility[i])
+            {
+                continue;
+            }
+
+            if (item.eType == eRenderItemType::VOXEL)
+            {
+                const BoundingBoxArray& instanceBounds = static_cast<const Voxel&>(*item.pRenderable).GetInstanceBounds();
+
+                const XMFLOAT4X4& world = item.World;
+                for (UINT j = 0u; j < instanceBounds.GetNumBoxes(); ++j)
+                {
+                    if (!m_aInstanceVisibility[item.uFirstInstanceVisibility + j])
+                    {
+                        continue;
+                    }
+
+                    const FLOAT screenSize = getScreenSize(FrustumCuller::TransformBox(instanceBounds.GetBox(j), &world._11));
+                    if (screenSize >= MIN_OCCLUDER_SCREEN_SIZE)
+                    {
+                        m_aOccluders.push_back({ .ScreenSize = screenSize, .pRenderable = item.pRenderable, .uItem = i, .uInstance = j });
+                    }
+                }
+            }
+            else
+            {
+                // Skinned models move away from the bind pose they are stored in
+                if (item.eType == eRenderItemType::MODEL && static_cast<const Model&>(*item.pRenderable).HasAnimations())
+                {
+                    continue;
+                }
+                if (!item.pRenderable->GetVertices() || !item.pRenderable->GetIndices())
+                {
+                    continue;
+                }
+
+                const FLOAT screenSize = getScreenSize(m_objectBounds.GetBox(i));
+                if (screenSize >= MIN_OCCLUDER_SCREEN_SIZE)
+                {
+                    m_aOccluders.push_back({ .ScreenSize = screenSize, .pRenderable = item.pRenderable, .uItem = i, .uInstance = Occluder::WHOLE_RENDERABLE });
+                }
+            }
+        }
+
+        std::sort(m_aOccluders.begin(), m_aOccluders.end(), [](const Occluder& a, const Occluder& b)
+            {
+                return a.ScreenSize > b.ScreenSize;
+            });
+
+        UINT uNumTriangles = 0u;
+        for (const Occluder& occluder : m_aOccluders)
+        {
+            const Renderable& renderable = *occluder.pRenderable;
+            const UINT uCost = (occluder.uInstance == Occluder::WHOLE_RENDERABLE) ? renderable.GetNumIndices() / 3u : 12u;
+            if (uNumTriangles + uCost > MAX_OCCLUDER_TRIANGLES)
+            {
+                continue;
+            }
+            uNumTriangles += uCost;
+
+            XMFLOAT4X4 worldViewProjection;
+            XMStoreFloat4x4(&worldViewProjection, XMLoadFloat4x4(&m_aRenderQueue[occluder.uItem].World) * viewProjection);
+
+            if (occluder.uInstance != Occluder::WHOLE_RENDERABLE)
+            {
+                m_occlusionCuller.RasterizeBox(static_cast<const Voxel&>(renderable).GetInstanceBounds().GetBox(occluder.uInstance), &worldViewProjection._11);
+            }
+            else if (renderable.GetNumMeshes() == 0u)
+            {
+                m_occlusionCuller.RasterizeTriangles(&renderable.GetVertices()[0].Position.x, static_cast<UINT>(sizeof(SimpleVertex)),
+                    renderable.GetIndices(), renderable.GetNumIndices(), &worldViewProjection._11);
+            }
+            else
+            {
+                for (UINT i = 0u; i < renderable.GetNumMeshes(); ++i)
+                {
+                    const auto& mesh = renderable.GetMesh(i);
+                    m_occlusionCuller.RasterizeTriangles(&renderable.GetVertices()[mesh.uBaseVertex].Position.x, static_cast<UINT>(sizeof(SimpleVertex)),
+                        renderable.GetIndices() + mesh.uBaseIndex, mesh.uNumIndices, &worldViewProjection._11);
+                }
+            }
+        }
+
+        m_occlusionCuller.BuildHierarchy();
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   Renderer::submitRenderQueue
+      Summary:  Records the render queue. Short queues, or a single
+                submission thread, record straight into the render
+                context. Otherwise the queue is split into contiguous
+                ranges, each recorded by a worker into its own
+                submission context, and the resulting command lists are
+                executed in queue order. The ranges live in the frame
+                arena and the task handed to the pool captures a single
+                reference, small enough for std::function to keep
+                inline, so a submission does not call the heap
+      Args:     RecordFunction pfnRecord
+                  Function that records one item of the queue
+                const PassTargets& targets
+                  Targets the queue is drawn into
+                UINT uBegin
+                  First item of the queue to record
+                UINT uEnd
+                  Item of the queue after the last one to record
+      Modifies: [m_renderContext, m_aSubmissionContexts].
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    void Renderer::submitRenderQueue(_In_ RecordFunction pfnRecord, _In_ const PassTargets& targets, _In_ UINT uBegin, _In_ UINT uEnd)
+    {
+        PROFILE_SCOPE("Submit");
+
+        const UINT uNumItems = uEnd - uBegin;
+        const UINT uNumTasks = std::min(static_cast<UINT>(m_aSubmissionContexts.size()), uNumItems / MIN_ITEMS_PER_SUBMISSION_TASK);
+
+        if (uNumTasks <= 1u)
+        {
+            for (UINT i = uBegin; i < uEnd; ++i)
+            {
+                (this->*pfnRecord)(*m_renderContext, m_aRenderQueue[i]);
+            }
+            return;
+        }
+
+        FrameVector<UINT> auTaskBegins;
+        auTaskBegins.reserve(uNumTasks + 1u);
+        for (UINT uTask = 0u; uTask <= uNumTasks; ++uTask)
+        {
+            auTaskBegins.push_back(uBegin + uNumItems * uTask / uNumTasks);
+        }
+
+        const auto recordTask = [this, pfnRecord, &targets, &auTaskBegins](UINT uTask)
+            {
+                RenderContext& context = *m_aSubmissionContexts[uTask];
+
+                // A command list starts from the default pipeline state
+                bindFrameState(context, targets);
+                for (UINT i = auTaskBegins[uTask]; i < auTaskBegins[uTask + 1u]; ++i)
+                {
+                    (this->*pfnRecord)(context, m_aRenderQueue[i]);
+                }
+                context.FinishCommandList();
+            };
+        m_submissionThreadPool.Dispatch(uNumTasks, [&recordTask](UINT uTask)
+            {
+                recordTask(uTask);
+            });
+
+        for (UINT i = 0u; i < uNumTasks; ++i)
+        {
+            m_renderContext->ExecuteCommandList(*m_aSubmissionContexts[i]);
+        }
+
+        // Executing a command list resets the immediate context state
+        bindFrameState(*m_renderContext, targets);
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   Renderer::submitMainPass
+      Summary:  Records the render queue of the main pass. Timed on the
+                GPU, each run of items of a kind is submitted and timed
+                on its own, the queue keeps the renderables, the voxels
+                and the models apart
+      Args:     const PassTargets& targets
+                  Targets of the main pass
+      Modifies: [m_renderContext, m_aSubmissionContexts].
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    void Renderer::submitMainPass(_In_ const PassTargets& targets)
+    {
+        const UINT uNumItems = static_cast<UINT>(m_aRenderQueue.size());
+        if (!m_gpuProfiler.IsEnabled())
+        {
+            submitRenderQueue(&Renderer::recordItem, targets, 0u, uNumItems);
+            return;
+        }
+
+        UINT uEnd = 0u;
+        for (UINT uBegin = 0u; uBegin < uNumItems; uBegin = uEnd)
+        {
+            const eRenderItemType eType = m_aRenderQueue[uBegin].eType;
+            for (uEnd = uBegin + 1u; uEnd < uNumItems && m_aRenderQueue[uEnd].eType == eType; ++uEnd)
+            {
+            }
+
+            PCSTR pszName = "Renderables";
+            if (eType == eRenderItemType::VOXEL)
+            {
+                pszName = "Voxels";
+            }
+            else if (eType == eRenderItemType::MODEL)
+            {
+                pszName = "Models";
+            }
+
+            GpuProfileScope scope(m_gpuProfiler, pszName);
+            submitRenderQueue(&Renderer::recordItem, targets, uBegin, uEnd);
+        }
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   Renderer::bindFrameState
+      Summary:  Binds the state shared by every draw of a pass, the
+                clustered lights, the shadow maps and the voxel
+                materials and atlas included. The targets are bound
+                first, so that the shadow maps are no longer a depth
+                target when the main pass reads them
+      Args:     RenderContext& context
+                  Context to bind the state on
+                const PassTargets& targets
+                  Targets of the pass
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    void Renderer::bindFrameState(_In_ RenderContext& context, _In_ const PassTargets& targets)
+    {
+        context.SetRenderTargets(targets.renderTargetView ? 1u : 0u, &targets.renderTargetView, targets.depthStencilView);
+        context.SetViewport(static_cast<FLOAT>(targets.uWidth), static_cast<FLOAT>(targets.uHeight));
+        context.SetPrimitiveTopology(ePrimitiveTopology::TRIANGLE_LIST);
+
+        const RenderHandle aFrameViews[6] =
+        {
+            m_lightView.Get(), m_clusterRangeView.Get(), m_lightIndexView.Get(), targets.shadowMapView,
+            m_voxelMaterialView.Get(), m_voxelAtlas.GetTextureResourceView().Get()
+        };
+        context.SetPixelShaderResources(3, 6, aFrameViews);
+
+        const RenderHandle aFrameSamplers[2] = { m_shadowSampler.Get(), Texture::s_samplers[static_cast<size_t>(eTextureSamplerType::TRILINEAR_CLAMP)].Get() };
+        context.SetPixelSamplers(3, 2, aFrameSamplers);
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   Renderer::getMainPassTargets
+      Summary:  Returns the targets of the main pass, the back buffer
+                and its depth buffer, reading the shadow maps
+      Returns:  PassTargets
+                  Targets of the main pass
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    PassTargets Renderer::getMainPassTargets() const
+    {
+        return
+        {
+            .renderTargetView = m_renderTargetView.Get(),
+            .depthStencilView = m_depthStencilView.Get(),
+            .shadowMapView = m_shadowMapView.Get(),
+            .uWidth = m_uWidth,
+            .uHeight = m_uHeight
+        };
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   Renderer::isMeshVisible
+      Summary:  Returns whether a mesh of a queued item survived culling
+      Args:     const RenderItem& item
+                  Item of the render queue
+                UINT uMeshIndex
+                  Index of the mesh
+      Returns:  BOOL
+                  TRUE if the mesh has to be drawn
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    BOOL Renderer::isMeshVisible(_In_ const RenderItem& item, _In_ UINT uMeshIndex) const
+    {
+        return item.uFirstMeshVisibility == RenderItem::NO_VISIBILITY || m_aMeshVisibility[item.uFirstMeshVisibility + uMeshIndex];
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   Renderer::alignConstantSize
+      Summary:  Rounds a constant buffer size up to the granularity of
+                constant buffer ranges
+      Args:     UINT uSize
+                  Size in bytes
+      Returns:  UINT
+                  Size in bytes, a multiple of 256
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    UINT Renderer::alignConstantSize(_In_ UINT uSize)
+    {
+        return (uSize + RenderContext::CONSTANT_BUFFER_ALIGNMENT - 1u) & ~(RenderContext::CONSTANT_BUFFER_ALIGNMENT - 1u);
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   Renderer::addCullingStatistics
+      Summary:  Adds the culling counters of a render queue to a total
+      Args:     CullingStatistics& total
+                  Counters added to
+                const CullingStatistics& statistics
+                  Counters of a render queue
+      Modifies: [total].
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    void Renderer::addCullingStatistics(_Inout_ CullingStatistics& total, _In_ const CullingStatistics& statistics)
+    {
+        total.uNumVisibleObjects += statistics.uNumVisibleObjects;
+        total.uNumCulledObjects += statistics.uNumCulledObjects;
+        total.uNumOccludedObjects += statistics.uNumOccludedObjects;
+        total.uNumVisibleMeshes += statistics.uNumVisibleMeshes;
+        total.uNumCulledMeshes += statistics.uNumCulledMeshes;
+        total.uNumOccludedMeshes += statistics.uNumOccludedMeshes;
+        total.uNumVisibleInstances += statistics.uNumVisibleInstances;
+        total.uNumCulledInstances += statistics.uNumCulledInstances;
+        total.uNumOccludedInstances += statistics.uNumOccludedInstances;
+        total.uNumTestedInstances += statistics.uNumTestedInstances;
+        total.uNumUploadedInstances += statistics.uNumUploadedInstances;
+        total.uNumOccluderTriangles += statistics.uNumOccluderTriangles;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   Renderer::recordItem
+      Summary:  Records an item of the render queue for the main pass
+      Args:     RenderContext& context
+                  Context to record into
+                const RenderItem& item
+                  Item of the render queue
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    void Renderer::recordItem(_In_ RenderContext& context, _In_ const RenderItem& item)
+    {
+        switch (item.eType)
+        {
+        case eRenderItemType::RENDERABLE:
+            recordRenderable(context, item);
+            break;
+        case eRenderItemType::VOXEL:
+            recordVoxel(context, item);
+            break;
+        case eRenderItemType::MODEL:
+            recordModel(context, item);
+            break;
+        default:
+            assert(false);
+            break;
+        }
+    }
 
-            // Set index buffer
-            m_immediateContext->IASetIndexBuffer(
-                it_models->second->GetIndexBuffer().Get(),
-                DXGI_FORMAT_R16_UINT,
-                0
-            );
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   Renderer::recordRenderable
+      Summary:  Records the draw calls of the visible meshes of a
+                renderable
+      Args:     RenderContext& context
+                  Context to record into
+                const RenderItem& item
+                  Item of the render queue holding the renderable
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    void Renderer::recordRenderable(_In_ RenderContext& context, _In_ const RenderItem& item)
+    {
+        Renderable& renderable = *item.pRenderable;
 
-            // Set input layout
-            m_immediateContext->IASetInputLayout(it_models->second->GetVertexLayout().Get());
+        // Set the vertex buffer, index buffer, and the input layout
 
+        // Set vertex buffer
+        UINT uStrides[2] = { sizeof(SimpleVertex), sizeof(NormalData) };
+        UINT uOffsets[2] = { 0, 0 };
 
+        RenderHandle vertexNormalBuffers[2] = { renderable.GetVertexBuffer().Get(), renderable.GetNormalBuffer().Get() };
 
-            // Update constant buffer
-            //   You must transpose the matrices when passing them to GPU!!
-            //   XMMATRIX is a row - major matrix, however HLSL expects column - major matrix
+        context.SetVertexBuffers(
+            0u,             // the first input slot for binding
+            2u,             // the number of buffers in the array
+            vertexNormalBuffers, // the array of vertex buffers
+            uStrides,       // array of stride values, one for each buffer
+            uOffsets        // array of offset values, one for each buffer
+        );
 
-            // Create renderable constant buffer and update
-            CBChangesEveryFrame cb_world =
-            {
-                .World = XMMatrixTranspose(it_models->second->GetWorldMatrix()),
-                .OutputColor = it_models->second->GetOutputColor()
-            };
+        // Set index buffer
+        context.SetIndexBuffer(
+            renderable.GetIndexBuffer().Get(),
+            eIndexFormat::R16_UINT,
+            0
+        );
 
-            m_immediateContext->UpdateSubresource(it_models->second->GetConstantBuffer().Get(), 0, nullptr, &cb_world, 0, 0);
+        // Set input layout
+        context.SetInputLayout(renderable.GetVertexLayout().Get());
+
+        // Set shadersand constant buffers, shader resources, and samplers
+
+        // Set vertex shader
+        context.SetVertexShader(renderable.GetVertexShader().Get());
+
+        // VS set
+        const ConstantBufferRange aVSConstantBuffers[4] = { m_cameraConstants, m_resizeConstants, item.objectConstants, m_lightsConstants };
+        context.SetVertexConstantBuffers(0, 4, aVSConstantBuffers);
+
+        // Set pixel shader
+        context.SetPixelShader(renderable.GetPixelShader().Get());
+
+        // PS set
+        context.SetPixelConstantBuffers(0, 1, &m_cameraConstants);
+        context.SetPixelConstantBuffers(2, 1, &item.objectConstants);
+        context.SetPixelConstantBuffers(3, 1, &m_lightsConstants);
+
+        const Skybox* pSkybox = m_frameSnapshot.pSkybox;
+        if (pSkybox)
+        {
+            eTextureSamplerType textureSamplerType = pSkybox->GetSkyboxTexture()->GetSamplerType();
+            const RenderHandle skyboxView = pSkybox->GetSkyboxTexture()->GetTextureResourceView().Get();
+            const RenderHandle skyboxSampler = Texture::s_samplers[static_cast<size_t>(textureSamplerType)].Get();
+            context.SetPixelShaderResources(2, 1, &skyboxView);
+            context.SetPixelSamplers(2, 1, &skyboxSampler);
+        }
 
-            CBSkinning cb_skinning =
+        if (renderable.HasTexture())
+        {
+            for (UINT i = 0u; i < renderable.GetNumMeshes(); ++i)
             {
-                .BoneTransforms = {}
-            };
+                if (!isMeshVisible(item, i))
+                {
+                    continue;
+                }
 
-            for (UINT i = 0u; i < it_models->second->GetBoneTransforms().size(); i++)
-            {
-                cb_skinning.BoneTransforms[i] = XMMatrixTranspose(it_models->second->GetBoneTransforms()[i]);
-            }
-
-            m_immediateContext->UpdateSubresource(it_models->second->GetSkinningConstantBuffer().Get(), 0, nullptr, &cb_skinning, 0, 0);
-
-            // Set shadersand constant buffers, shader resources, and samplers
-
-            // Set vertex shader
-            m_immediateContext->VSSetShader(
-                it_models->second->GetVertexShader().Get(),
-                nullptr,
-                0
-            );
-
-            // VS set
-            m_immediateContext->VSSetConstantBuffers(
-                0,
-                1,
-                m_camera.GetConstantBuffer().GetAddressOf()
-            );
-            m_immediateContext->VSSetConstantBuffers(
-                1,
-                1,
-                m_cbChangeOnResize.GetAddressOf()
-            );
-            m_immediateContext->VSSetConstantBuffers(
-                2,
-                1,
-                it_models->second->GetConstantBuffer().GetAddressOf()
-            );
-            m_immediateContext->VSSetConstantBuffers(
-                4,
-                1,
-                it_models->second->GetSkinningConstantBuffer().GetAddressOf()
-            );
-
-            // Set pixel shader
-            m_immediateContext->PSSetShader(
-                it_models->second->GetPixelShader().Get(),
-                nullptr,
-                0u
-            );
-
-            // PS set
-
-            m_immediateContext->PSSetConstantBuffers(
-                0,
-                1,
-                m_camera.GetConstantBuffer().GetAddressOf()
-            );
-
-            m_immediateContext->PSSetConstantBuffers(
-                2,
-                1,
-                it_models->second->GetConstantBuffer().GetAddressOf()
-            );
-
-            m_immediateContext->PSSetConstantBuffers(
-                3,
-                1,
-                m_cbLights.GetAddressOf()
-            );
-
-
-            if (it_models->second->HasTexture())
-            {
-                for (UINT i = 0u; i < it_models->second->GetNumMeshes(); ++i)
+                const UINT materialIndex = renderable.GetMesh(i).uMaterialIndex;
+                if (renderable.GetMaterial(materialIndex)->pDiffuse)
                 {
-                    const UINT materialIndex = it_models->second->GetMesh(i).uMaterialIndex;
+                    const RenderHandle diffuseView = renderable.GetMaterial(materialIndex)->pDiffuse->GetTextureResourceView().Get();
+                    const RenderHandle diffuseSampler = Texture::s_samplers[static_cast<size_t>(renderable.GetMaterial(materialIndex)->pDiffuse->GetSamplerType())].Get();
 
                     // Set texture resource view of the renderable into the pixel shader
-                    m_immediateContext->PSSetShaderResources(0u, 1u, it_models->second->GetMaterial(materialIndex)->pDiffuse->GetTextureResourceView().GetAddressOf());
+                    context.SetPixelShaderResources(0u, 1u, &diffuseView);
 
                     // Set sampler state of the renderable into the pixel shader
-                    m_immediateContext->PSSetSamplers(0u, 1u, Texture::s_samplers[static_cast<size_t>(it_models->second->GetMaterial(materialIndex)->pDiffuse->GetSamplerType())].GetAddressOf());
-                    
+                    context.SetPixelSamplers(0u, 1u, &diffuseSampler);
+                }
+
+                if (renderable.GetMaterial(materialIndex)->pNormal)
+                {
+                    const RenderHandle normalView = renderable.GetMaterial(materialIndex)->pNormal->GetTextureResourceView().Get();
+                    const RenderHandle normalSampler = Texture::s_samplers[static_cast<size_t>(renderable.GetMaterial(materialIndex)->pNormal->GetSamplerType())].Get();
+
+                    // Set texture resource view of the renderable into the pixel shader
+                    context.SetPixelShaderResources(1u, 1u, &normalView);
 
-                    // Render the triangles
-                    m_immediateContext->DrawIndexed(it_models->second->GetMesh(i).uNumIndices,
-                        it_models->second->GetMesh(i).uBaseIndex,
-                        it_models->second->GetMesh(i).uBaseVertex);
+                    // Set sampler state of the renderable into the pixel shader
+                    context.SetPixelSamplers(1u, 1u, &normalSampler);
                 }
+
+                // Render the triangles
+                context.DrawIndexed(renderable.GetMesh(i).uNumIndices,
+                    renderable.GetMesh(i).uBaseIndex,
+                    renderable.GetMesh(i).uBaseVertex);
             }
-            else
-            {
-                // draw
-                m_immediateContext->DrawIndexed(it_models->second->GetNumIndices(), 0, 0);
-            }
+        }
+        else
+        {
+            // draw
+            context.DrawIndexed(renderable.GetNumIndices(), 0, 0);
+        }
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   Renderer::recordVoxel
+      Summary:  Records the instanced draw call of a voxel
+      Args:     RenderContext& context
+                  Context to record into
+                const RenderItem& item
+                  Item of the render queue holding the voxel
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    void Renderer::recordVoxel(_In_ RenderContext& context, _In_ const RenderItem& item)
+    {
+        Voxel& voxel = static_cast<Voxel&>(*item.pRenderable);
+
+        UINT strides[3] = { sizeof(SimpleVertex), sizeof(NormalData), sizeof(InstanceData) };
+        UINT offsets[3] = { 0, 0, 0 };
+
+        RenderHandle vertexInstanceBuffers[3] = { voxel.GetVertexBuffer().Get(), voxel.GetNormalBuffer().Get(), item.instanceBuffer };
+
+        context.SetVertexBuffers(
+            0,
+            3,
+            vertexInstanceBuffers,
+            strides, 
+            offsets);
+
+        context.SetIndexBuffer(
+            voxel.GetIndexBuffer().Get(),
+            eIndexFormat::R16_UINT,
+            0
+        );
+        context.SetInputLayout(
+            voxel.GetVertexLayout().Get()
+        );
+
+        context.SetVertexShader(
+            voxel.GetVertexShader().Get()
+        );
 
+        const ConstantBufferRange aVSConstantBuffers[3] = { m_cameraConstants, m_resizeConstants, item.objectConstants };
+        context.SetVertexConstantBuffers(0, 3, aVSConstantBuffers);
 
+        context.SetPixelConstantBuffers(0, 1, &m_cameraConstants);
+        context.SetPixelConstantBuffers(2, 1, &item.objectConstants);
+        context.SetPixelConstantBuffers(3, 1, &m_lightsConstants);
+        context.SetPixelConstantBuffers(5, 1, &m_shadowsConstants);
 
+        context.SetPixelShader(voxel.GetPixelShader().Get());
 
 
+        if (voxel.HasTexture())
+        {
+            RenderHandle shaderResources[2] = { voxel.GetMaterial(0)->pDiffuse->GetTextureResourceView().Get(),
+                                            voxel.GetMaterial(0)->pNormal->GetTextureResourceView().Get() };
+            RenderHandle samplerStates[2] = { Texture::s_samplers[static_cast<size_t>(voxel.GetMaterial(0)->pDiffuse->GetSamplerType())].Get(),
+                                            Texture::s_samplers[static_cast<size_t>(voxel.GetMaterial(0)->pNormal->GetSamplerType())].Get() };
+            context.SetPixelShaderResources(0, 2, shaderResources);
+            context.SetPixelSamplers(0, 2, samplerStates);
+            context.DrawIndexedInstanced(voxel.GetNumIndices(), item.uNumInstances, 0, 0, item.uFirstInstance);
+
+        }
+        else
+        {
+            context.DrawIndexedInstanced(voxel.GetNumIndices(), item.uNumInstances, 0, 0, item.uFirstInstance);
         }
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   Renderer::recordModel
+      Summary:  Records the draw calls of the visible meshes of a model
+      Args:     RenderContext& context
+                  Context to record into
+                const RenderItem& item
+                  Item of the render queue holding the model
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    void Renderer::recordModel(_In_ RenderContext& context, _In_ const RenderItem& item)
+    {
+        Model& model = static_cast<Model&>(*item.pRenderable);
 
+        // Set the vertex buffer, index buffer, and the input layout
+
+        // Set vertex buffer
+        UINT aStrides[2] = {
+            static_cast<UINT>(sizeof(SimpleVertex)),
+            static_cast<UINT>(sizeof(AnimationData)),
+        };
+        UINT aOffsets[2] = { 0u, 0u };
 
-        //render sky box
-        std::shared_ptr<Skybox> skybox = m_scenes[m_pszMainSceneName]->GetSkyBox();
-        if (skybox)
+        RenderHandle aBuffers[2]
         {
-            UINT uStrides = static_cast<UINT>(sizeof(SimpleVertex));
-            UINT uOffsets = 0u;
+            model.GetVertexBuffer().Get(),
+            model.GetAnimationBuffer().Get(),
+        };
 
-            m_immediateContext->IASetVertexBuffers(0u, 1u, skybox->GetVertexBuffer().GetAddressOf(), &uStrides, &uOffsets);
-            m_immediateContext->IASetIndexBuffer(skybox->GetIndexBuffer().Get(), DXGI_FORMAT_R16_UINT, 0);
-            m_immediateContext->IASetInputLayout(skybox->GetVertexLayout().Get());
+        context.SetVertexBuffers(
+            0u,             // the first input slot for binding
+            2u,             // the number of buffers in the array
+            aBuffers,       // the array of vertex buffers
+            aStrides,       // array of stride values, one for each buffer
+            aOffsets        // array of offset values, one for each buffer
+        );
 
-            XMVECTOR scale;
-            XMVECTOR rotation;
-            XMVECTOR translation;
-            XMMatrixDecompose(&scale, &rotation, &translation, skybox->GetWorldMatrix());
+        // Set index buffer
+        context.SetIndexBuffer(
+            model.GetIndexBuffer().Get(),
+            eIndexFormat::R16_UINT,
+            0
+        );
 
-            XMMATRIX skyboxTransform = XMMatrixIdentity();
-            skyboxTransform = XMMatrixScalingFromVector(scale) * XMMatrixRotationRollPitchYawFromVector(rotation) * XMMatrixTranslationFromVector(m_camera.GetEye());
+        // Set input layout
+        context.SetInputLayout(model.GetVertexLayout().Get());
 
-            CBChangesEveryFrame cbChangeEveryFrame = {
-                .World = XMMatrixTranspose(skyboxTransform),
-                .OutputColor = skybox->GetOutputColor(),
-                .HasNormalMap = skybox->HasNormalMap()
-            };
-            m_immediateContext->UpdateSubresource(
-                skybox->GetConstantBuffer().Get(),
-                0,
-                nullptr,
-                &cbChangeEveryFrame,
-                0,
-                0
-            );
-            m_immediateContext->VSSetShader(skybox->GetVertexShader().Get(), nullptr, 0);
-            m_immediateContext->VSSetConstantBuffers(0u, 1u, m_camera.GetConstantBuffer().GetAddressOf());
-            m_immediateContext->VSSetConstantBuffers(1u, 1u, m_cbChangeOnResize.GetAddressOf());
-            m_immediateContext->VSSetConstantBuffers(2u, 1u, skybox->GetConstantBuffer().GetAddressOf());
-
-            m_immediateContext->PSSetShader(skybox->GetPixelShader().Get(), nullptr, 0);
-
-            if (skybox->HasTexture())
-            {
-                for (UINT i = 0; i < skybox->GetNumMeshes(); i++)
+        // Set shadersand constant buffers, shader resources, and samplers
+
+        // Set vertex shader
+        context.SetVertexShader(model.GetVertexShader().Get());
+
+        // VS set
+        const ConstantBufferRange aVSConstantBuffers[3] = { m_cameraConstants, m_resizeConstants, item.objectConstants };
+        context.SetVertexConstantBuffers(0, 3, aVSConstantBuffers);
+        context.SetVertexConstantBuffers(4, 1, &item.skinningConstants);
+
+        // Set pixel shader
+        context.SetPixelShader(model.GetPixelShader().Get());
+
+        // PS set
+        context.SetPixelConstantBuffers(0, 1, &m_cameraConstants);
+        context.SetPixelConstantBuffers(2, 1, &item.objectConstants);
+        context.SetPixelConstantBuffers(3, 1, &m_lightsConstants);
+
+
+        if (model.HasTexture())
+        {
+            for (UINT i = 0u; i < model.GetNumMeshes(); ++i)
+            {
+                if (!isMeshVisible(item, i))
                 {
-                    UINT materialIndex = skybox->GetMesh(i).uMaterialIndex;
-                    ComPtr<ID3D11ShaderResourceView> shaderResources = skybox->GetSkyboxTexture()->GetTextureResourceView();
-                    ComPtr<ID3D11SamplerState> samplerStates = nullptr;
-                    eTextureSamplerType textureSamplerType = skybox->GetMaterial(materialIndex)->pDiffuse->GetSamplerType();
-                    samplerStates = Texture::s_samplers[static_cast<size_t>(textureSamplerType)];
-
-                    m_immediateContext->PSSetShaderResources(0u, 1u, shaderResources.GetAddressOf());
-                    m_immediateContext->PSSetSamplers(0u, 1u, samplerStates.GetAddressOf());
-                    m_immediateContext->DrawIndexed(skybox->GetMesh(i).uNumIndices, skybox->GetMesh(i).uBaseIndex, skybox->GetMesh(i).uBaseVertex);
+                    continue;
                 }
+
+                const UINT materialIndex = model.GetMesh(i).uMaterialIndex;
+                const RenderHandle diffuseView = model.GetMaterial(materialIndex)->pDiffuse->GetTextureResourceView().Get();
+                const RenderHandle diffuseSampler = Texture::s_samplers[static_cast<size_t>(model.GetMaterial(materialIndex)->pDiffuse->GetSamplerType())].Get();
+
+                // Set texture resource view of the renderable into the pixel shader
+                context.SetPixelShaderResources(0u, 1u, &diffuseView);
+
+                // Set sampler state of the renderable into the pixel shader
+                context.SetPixelSamplers(0u, 1u, &diffuseSampler);
+                
+
+                // Render the triangles
+                context.DrawIndexed(model.GetMesh(i).uNumIndices,
+                    model.GetMesh(i).uBaseIndex,
+                    model.GetMesh(i).uBaseVertex);
             }
-            else
-            {
-                m_immediateContext->DrawIndexed(skybox->GetNumIndices(), 0, 0);
-            }
         }
+        else
+        {
+            // draw
+            context.DrawIndexed(model.GetNumIndices(), 0, 0);
+        }
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   Renderer::recordSkybox
+      Summary:  Records the skybox centered on the camera, its
+                constants were written with the main pass
+      Args:     RenderContext& context
+                  Context to record into
+                Skybox& skybox
+                  Skybox to draw
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    void Renderer::recordSkybox(_In_ RenderContext& context, _In_ Skybox& skybox)
+    {
+        PROFILE_SCOPE("Skybox");
+
+        UINT uStrides = static_cast<UINT>(sizeof(SimpleVertex));
+        UINT uOffsets = 0u;
+        const RenderHandle skyboxVertexBuffer = skybox.GetVertexBuffer().Get();
 
-        m_swapChain->Present(0, 0);
+        context.SetVertexBuffers(0u, 1u, &skyboxVertexBuffer, &uStrides, &uOffsets);
+        context.SetIndexBuffer(skybox.GetIndexBuffer().Get(), eIndexFormat::R16_UINT, 0);
+        context.SetInputLayout(skybox.GetVertexLayout().Get());
 
-        
+        const ConstantBufferRange aVSConstantBuffers[3] = { m_cameraConstants, m_resizeConstants, m_skyboxConstants };
+        context.SetVertexShader(skybox.GetVertexShader().Get());
+        context.SetVertexConstantBuffers(0u, 3u, aVSConstantBuffers);
+
+        context.SetPixelShader(skybox.GetPixelShader().Get());
+
+        if (skybox.HasTexture())
+        {
+            for (UINT i = 0; i < skybox.GetNumMeshes(); i++)
+            {
+                UINT materialIndex = skybox.GetMesh(i).uMaterialIndex;
+                const RenderHandle shaderResources = skybox.GetSkyboxTexture()->GetTextureResourceView().Get();
+                eTextureSamplerType textureSamplerType = skybox.GetMaterial(materialIndex)->pDiffuse->GetSamplerType();
+                const RenderHandle samplerStates = Texture::s_samplers[static_cast<size_t>(textureSamplerType)].Get();
+
+                context.SetPixelShaderResources(0u, 1u, &shaderResources);
+                context.SetPixelSamplers(0u, 1u, &samplerStates);
+                context.DrawIndexed(skybox.GetMesh(i).uNumIndices, skybox.GetMesh(i).uBaseIndex, skybox.GetMesh(i).uBaseVertex);
+            }
+        }
+        else
+        {
+            context.DrawIndexed(skybox.GetNumIndices(), 0, 0);
+        }
     }
 
     
@@ -914,151 +2710,445 @@ namespace library
     }
 
     /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
-      Method:   Renderer::SetShadowMapShaders
-      Summary:  Set shaders for the shadow mapping
+      Method:   Renderer::GetRenderStatistics
+      Summary:  Returns the statistics of the last rendered frame
+      Returns:  const RenderStatistics&
+                  Draw calls, uploaded bytes and state changes
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    const RenderStatistics& Renderer::GetRenderStatistics() const
+    {
+        return m_renderContext->GetStatistics();
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   Renderer::SetNumSubmissionThreads
+      Summary:  Sets the number of threads that record the draw calls of
+                a frame. Takes effect immediately when the renderer is
+                initialized, otherwise on initialization
+      Args:     UINT uNumThreads
+                  Number of submission threads, 1 records on the calling
+                  thread only
+      Modifies: [m_uNumSubmissionThreads, m_aSubmissionContexts,
+                  m_submissionThreadPool].
+      Returns:  HRESULT
+                  Status code
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    HRESULT Renderer::SetNumSubmissionThreads(_In_ UINT uNumThreads)
+    {
+        if (uNumThreads == 0u)
+        {
+            return E_INVALIDARG;
+        }
+
+        m_uNumSubmissionThreads = uNumThreads;
+
+        if (!m_renderContext)
+        {
+            return S_OK;
+        }
+
+        return createSubmissionContexts();
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   Renderer::GetNumSubmissionThreads
+      Summary:  Returns the number of threads that record draw calls
+      Returns:  UINT
+                  Number of submission threads
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    UINT Renderer::GetNumSubmissionThreads() const
+    {
+        return m_uNumSubmissionThreads;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   Renderer::GetSubmissionTime
+      Summary:  Returns the CPU time Render spent recording and
+                submitting the last frame, present excluded
+      Returns:  FLOAT
+                  Submission time in milliseconds
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    FLOAT Renderer::GetSubmissionTime() const
+    {
+        return m_submissionTime;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   Renderer::SetFrustumCulling
+      Summary:  Enables or disables the frustum culling of the render
+                queue, everything is drawn when disabled
+      Args:     BOOL bEnable
+                  TRUE to cull
+      Modifies: [m_bFrustumCulling].
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    void Renderer::SetFrustumCulling(_In_ BOOL bEnable)
+    {
+        m_bFrustumCulling = bEnable;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   Renderer::SetVoxelBatching
+      Summary:  Enables or disables merging the voxels of the main pass
+                into one instanced draw call, each voxel is drawn on
+                its own when disabled
+      Args:     BOOL bEnable
+                  TRUE to batch
+      Modifies: [m_bVoxelBatching].
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    void Renderer::SetVoxelBatching(_In_ BOOL bEnable)
+    {
+        m_bVoxelBatching = bEnable;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   Renderer::GetCullingStatistics
+      Summary:  Returns the culling counters of the last frame
+      Args:     eRenderPass pass
+                  Pass to query
+      Returns:  const CullingStatistics&
+                  Visible and culled objects, meshes and instances
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    const CullingStatistics& Renderer::GetCullingStatistics(_In_ eRenderPass pass) const
+    {
+        return m_aCullingStatistics[static_cast<size_t>(pass)];
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   Renderer::SetOcclusionCulling
+      Summary:  Enables or disables the occlusion culling of the main
+                pass. Only applies while the frustum culling is enabled
+      Args:     BOOL bEnable
+                  TRUE to cull
+      Modifies: [m_bOcclusionCulling].
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    void Renderer::SetOcclusionCulling(_In_ BOOL bEnable)
+    {
+        m_bOcclusionCulling = bEnable;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   Renderer::GetOcclusionTime
+      Summary:  Returns the CPU time spent drawing the occluders of the
+                last frame and building their depth hierarchy
+      Returns:  FLOAT
+                  Rasterization time in milliseconds
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    FLOAT Renderer::GetOcclusionTime() const
+    {
+        return m_occlusionCuller.GetRasterizationTime();
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   Renderer::GetLightCullingTime
+      Summary:  Returns the CPU time spent assigning the lights of the
+                last frame to the clusters and uploading the result
+      Returns:  FLOAT
+                  Light culling time in milliseconds
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    FLOAT Renderer::GetLightCullingTime() const
+    {
+        return m_lightCullingTime;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   Renderer::GetNumDroppedLights
+      Summary:  Returns how many times a light of the last frame was
+                left out of a cluster that was already full
+      Returns:  UINT
+                  Number of dropped cluster entries
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    UINT Renderer::GetNumDroppedLights() const
+    {
+        return m_lightCuller.GetNumDroppedLights();
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   Renderer::GetSnapshotTime
+      Summary:  Returns the CPU time spent gathering the snapshot of the
+                last frame
+      Returns:  FLOAT
+                  Snapshot time in milliseconds
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    FLOAT Renderer::GetSnapshotTime() const
+    {
+        return m_snapshotTime;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   Renderer::GetSceneLoadTime
+      Summary:  Returns the time spent initializing the main scene, its
+                meshes, shaders and textures
+      Returns:  FLOAT
+                  Load time in milliseconds
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    FLOAT Renderer::GetSceneLoadTime() const
+    {
+        return m_sceneLoadTime;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   Renderer::GetShadowStatistics
+      Summary:  Returns the shadow map counters of the last frame
+      Returns:  const ShadowStatistics&
+                  Draws, saved draws and copies of the shadow slices
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    const ShadowStatistics& Renderer::GetShadowStatistics() const
+    {
+        return m_shadowAtlas.GetStatistics();
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   Renderer::GetShadowCullingStatistics
+      Summary:  Returns the culling counters of a shadow slice in the
+                last frame, static and dynamic casters together. The
+                shadow pass counters are the sum over the slices
+      Args:     UINT uSlice
+                  Cascade, or cube face after the cascades
+      Returns:  const CullingStatistics&
+                  Culling counters of the slice
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    const CullingStatistics& Renderer::GetShadowCullingStatistics(_In_ UINT uSlice) const
+    {
+        assert(uSlice < FrameSnapshot::NUM_SHADOW_SLICES);
+
+        return m_aShadowCullingStatistics[uSlice];
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   Renderer::SetGpuProfiling
+      Summary:  Enables or disables timing the shadow pass, the main
+                pass, its renderables, voxels and models, and the skybox
+                on the GPU. Timed, the kinds of items of the main pass
+                are submitted apart
+      Args:     BOOL bEnable
+                  TRUE to time the passes
+      Modifies: [m_gpuProfiler].
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    void Renderer::SetGpuProfiling(_In_ BOOL bEnable)
+    {
+        m_gpuProfiler.SetEnabled(bEnable);
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   Renderer::GetGpuStatistics
+      Summary:  Returns the GPU times of the passes of the last frame
+                read back, a few frames behind
+      Returns:  const std::vector<ProfileStatistic>&
+                  One statistic per pass, empty until a frame is read
+                  back
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    const std::vector<ProfileStatistic>& Renderer::GetGpuStatistics() const
+    {
+        return m_gpuProfiler.GetFrameStatistics();
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   Renderer::SetShadowMapShader
+      Summary:  Set the vertex shader of the shadow maps, drawn depth
+                only. There are no shadows without one
       Args:     std::shared_ptr<ShadowVertexShader>
                   vertex shader
-                std::shared_ptr<PixelShader>
-                  pixel shader
-      Modifies: [m_shadowVertexShader, m_shadowPixelShader].
+      Modifies: [m_shadowVertexShader].
     M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
-    void Renderer::SetShadowMapShaders(_In_ std::shared_ptr<ShadowVertexShader> vertexShader, _In_ std::shared_ptr<PixelShader> pixelShader)
+    void Renderer::SetShadowMapShader(_In_ std::shared_ptr<ShadowVertexShader> vertexShader)
     {
         m_shadowVertexShader = move(vertexShader);
-        m_shadowPixelShader = move(pixelShader);
     }
 
     /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
-      Method:   Renderer::RenderSceneToTexture
-      Summary:  Render scene to the texture
+      Method:   Renderer::renderShadowMaps
+      Summary:  Draws the shadow slices of the frame snapshot. The static
+                layer of a slice is only drawn again when its key
+                changes, it is then copied into the shadow map unless
+                the shadow map still holds it alone, and the dynamic
+                casters are drawn on top. Slices of missing lights are
+                skipped
+      Modifies: [m_shadowAtlas, m_uShadowSlice, m_aShadowCullingStatistics,
+                  m_aCullingStatistics, m_aRenderQueue, m_constantRing,
+                  m_instanceRing].
     M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    void Renderer::renderShadowMaps()
+    {
+        PROFILE_SCOPE("Shadow pass");
+        GpuProfileScope shadowPassScope(m_gpuProfiler, "Shadow pass");
 
-    void Renderer::RenderSceneToTexture()
-    {
-        //Unbind current pixel shader resources
-        ID3D11ShaderResourceView* const pSRV[2] = { NULL, NULL };
-        m_immediateContext->PSSetShaderResources(0, 2, pSRV);
-        m_immediateContext->PSSetShaderResources(2, 1, pSRV);
-
-        // Change render target to the shadow map texture
-        m_immediateContext->OMSetRenderTargets(1,
-            m_shadowMapTexture->GetRenderTargetView().GetAddressOf(),
-            m_depthStencilView.Get());
-        // Clear render target view with white color
-        m_immediateContext->ClearRenderTargetView(
-            m_shadowMapTexture->GetRenderTargetView().Get(),
-            Colors::White
-        );
-        // Clear depth stencil view
-        m_immediateContext->ClearDepthStencilView(
-            m_depthStencilView.Get(),
-            D3D11_CLEAR_DEPTH, 1.0f, 0
-        );
+        const FrameSnapshot& snapshot = m_frameSnapshot;
 
-        //std::unordered_map<std::wstring, std::shared_ptr<Renderable>>::iterator it_renderable;
-        for (auto it_renderable = m_scenes[m_pszMainSceneName]->GetRenderables().begin();
-            it_renderable != m_scenes[m_pszMainSceneName]->GetRenderables().end(); it_renderable++)
+        m_shadowAtlas.BeginFrame();
+        std::fill(std::begin(m_aShadowCullingStatistics), std::end(m_aShadowCullingStatistics), CullingStatistics());
+        m_aCullingStatistics[static_cast<size_t>(eRenderPass::SHADOW)] = {};
+        if (!m_shadowVertexShader)
         {
-            UINT strides[1] = { sizeof(SimpleVertex) };
-            UINT offsets[1] = { 0 };
-            m_immediateContext->IASetVertexBuffers(0, 1, it_renderable->second->GetVertexBuffer().GetAddressOf(), strides, offsets);
-            m_immediateContext->IASetIndexBuffer(it_renderable->second->GetIndexBuffer().Get(), DXGI_FORMAT_R16_UINT, 0);
-            m_immediateContext->IASetInputLayout(m_shadowVertexShader->GetVertexLayout().Get());
-            CBShadowMatrix cb =
-            {
-                .World = XMMatrixTranspose(it_renderable->second->GetWorldMatrix()),
+            return;
+        }
 
-                .IsVoxel = false
-            };
-            m_immediateContext->UpdateSubresource(m_cbShadowMatrix.Get(), 0, nullptr, &cb, 0, 0);
+        // The shadow maps are about to be drawn, they cannot be read at the same time
+        const RenderHandle nullView = nullptr;
+        m_renderContext->SetPixelShaderResources(6, 1, &nullView);
 
-            m_immediateContext->VSSetShader(m_shadowVertexShader->GetVertexShader().Get(), nullptr, 0);
-            m_immediateContext->VSSetConstantBuffers(0, 1, m_cbShadowMatrix.GetAddressOf());
-            m_immediateContext->PSSetShader(m_shadowPixelShader->GetPixelShader().Get(), nullptr, 0);
+        const UINT* auShadowLights = &snapshot.ShadowLights.x;
+        CullingStatistics total = {};
+        for (UINT uSlice = 0u; uSlice < FrameSnapshot::NUM_SHADOW_SLICES; ++uSlice)
+        {
+            const UINT uShadowLight = (uSlice < NUM_SHADOW_CASCADES) ? 0u : 1u + (uSlice - NUM_SHADOW_CASCADES) / PointLight::NUM_CUBE_FACES;
+            if (auShadowLights[uShadowLight] == NO_SHADOW_LIGHT)
+            {
+                continue;
+            }
 
+            m_uShadowSlice = uSlice;
+            const XMMATRIX& viewProjection = snapshot.ShadowViewProjections[uSlice];
+            XMFLOAT4X4 viewProjectionFloats;
+            XMStoreFloat4x4(&viewProjectionFloats, viewProjection);
+            const UINT64 uStaticKey = ShadowAtlas::ComputeKey(&viewProjectionFloats._11, snapshot.uStaticCasterRevision);
 
-            for (UINT i = 0; i < it_renderable->second->GetNumMeshes(); i++)
+            CullingStatistics& statistics = m_aShadowCullingStatistics[uSlice];
+            if (m_shadowAtlas.BeginSlice(uSlice, uStaticKey))
             {
-                m_immediateContext->DrawIndexed(
-                    it_renderable->second->GetMesh(i).uNumIndices,
-                    it_renderable->second->GetMesh(i).uBaseIndex,
-                    it_renderable->second->GetMesh(i).uBaseVertex
-                );
+                m_renderContext->ClearDepthStencil(m_aStaticShadowDepthViews[uSlice].Get(), 1.0f);
+                const UINT uNumStaticDraws = drawShadowCasters(snapshot.aStaticCasters, viewProjection, m_aStaticShadowDepthViews[uSlice].Get(), statistics);
+                m_shadowAtlas.SetStatic(uSlice, uStaticKey, uNumStaticDraws);
             }
+
+            const BOOL bCopy = m_shadowAtlas.NeedsCopy(uSlice);
+            if (bCopy)
+            {
+                m_renderContext->CopySubresource(m_shadowMaps.Get(), uSlice, m_staticShadowMaps.Get(), uSlice);
+            }
+
+            const UINT uNumDynamicDraws = drawShadowCasters(snapshot.aDynamicCasters, viewProjection, m_aShadowDepthViews[uSlice].Get(), statistics);
+            m_shadowAtlas.SetDynamic(uSlice, bCopy, uNumDynamicDraws);
+
+            addCullingStatistics(total, statistics);
         }
 
-        //std::vector<std::shared_ptr<Voxel>>::iterator it_voxel;
-        for (auto it_voxel = m_scenes[m_pszMainSceneName]->GetVoxels().begin();
-            it_voxel != m_scenes[m_pszMainSceneName]->GetVoxels().end(); it_voxel++)
+        m_aCullingStatistics[static_cast<size_t>(eRenderPass::SHADOW)] = total;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   Renderer::drawShadowCasters
+      Summary:  Culls shadow casters against the current shadow slice
+                and draws the visible ones, depth only
+      Args:     const std::vector<RenderItem>& aCasters
+                  Static or dynamic casters of the frame snapshot
+                const XMMATRIX& viewProjection
+                  View projection matrix of the slice
+                RenderHandle depthStencilView
+                  Depth stencil view of the slice drawn into
+                CullingStatistics& statistics
+                  Culling counters of the slice, added to
+      Modifies: [m_aRenderQueue, m_aCullingStatistics, m_constantRing,
+                  m_instanceRing].
+      Returns:  UINT
+                  Number of draw calls recorded
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    UINT Renderer::drawShadowCasters(_In_ const std::vector<RenderItem>& aCasters, _In_ const XMMATRIX& viewProjection, _In_ RenderHandle depthStencilView, _Inout_ CullingStatistics& statistics)
+    {
+        buildRenderQueue(eRenderPass::SHADOW, viewProjection, aCasters);
+        addCullingStatistics(statistics, m_aCullingStatistics[static_cast<size_t>(eRenderPass::SHADOW)]);
+        if (m_aRenderQueue.empty() || FAILED(uploadConstants(eRenderPass::SHADOW)))
         {
-            UINT strides[2] = { sizeof(SimpleVertex),sizeof(InstanceData) };
-            UINT offsets[2] = { 0,0 };
+            return 0u;
+        }
 
-            ComPtr<ID3D11Buffer> vertexInstanceBuffers[2] = { it_voxel->get()->GetVertexBuffer() ,it_voxel->get()->GetInstanceBuffer() };
-            m_immediateContext->IASetVertexBuffers(0, 1, vertexInstanceBuffers[0].GetAddressOf(), &strides[0], &offsets[0]);
-            m_immediateContext->IASetVertexBuffers(2, 1, vertexInstanceBuffers[1].GetAddressOf(), &strides[1], &offsets[1]);
-            m_immediateContext->IASetIndexBuffer(it_voxel->get()->GetIndexBuffer().Get(), DXGI_FORMAT_R16_UINT, 0);
-            m_immediateContext->IASetInputLayout(m_shadowVertexShader->GetVertexLayout().Get());
+        const PassTargets targets =
+        {
+            .renderTargetView = nullptr,
+            .depthStencilView = depthStencilView,
+            .shadowMapView = nullptr,
+            .uWidth = SHADOW_MAP_SIZE,
+            .uHeight = SHADOW_MAP_SIZE
+        };
+        const UINT uFirstDrawCall = m_renderContext->GetStatistics().uNumDrawCalls;
+        bindFrameState(*m_renderContext, targets);
+        submitRenderQueue(&Renderer::recordShadowCaster, targets, 0u, static_cast<UINT>(m_aRenderQueue.size()));
 
-            m_immediateContext->VSSetShader(m_shadowVertexShader->GetVertexShader().Get(), nullptr, 0);
-            m_immediateContext->VSSetConstantBuffers(0, 1, m_cbShadowMatrix.GetAddressOf());
-            m_immediateContext->PSSetShader(m_shadowPixelShader->GetPixelShader().Get(), nullptr, 0);
-            CBShadowMatrix cb =
-            {
-                .World = XMMatrixTranspose(it_voxel->get()->GetWorldMatrix()),
+        return m_renderContext->GetStatistics().uNumDrawCalls - uFirstDrawCall;
+    }
 
-                .IsVoxel = false
-            };
-            m_immediateContext->UpdateSubresource(m_cbShadowMatrix.Get(), 0, nullptr, &cb, 0, 0);
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   Renderer::recordShadowCaster
+      Summary:  Records an item of the render queue into the current
+                shadow slice, depth only. Every item binds its own
+                range of shadow matrices, so the command lists do not
+                depend on each other. The instances of a voxel come
+                from the second vertex buffer
+      Args:     RenderContext& context
+                  Context to record into
+                const RenderItem& item
+                  Item of the render queue
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    void Renderer::recordShadowCaster(_In_ RenderContext& context, _In_ const RenderItem& item)
+    {
+        Renderable& renderable = *item.pRenderable;
 
-            for (UINT i = 0u; i < it_voxel->get()->GetNumMeshes(); ++i)
-            {
-                // Render the triangles
-                m_immediateContext->DrawIndexedInstanced(
-                    it_voxel->get()->GetMesh(i).uNumIndices,
-                    it_voxel->get()->GetNumInstances(),
-                    it_voxel->get()->GetMesh(i).uBaseIndex,
-                    it_voxel->get()->GetMesh(i).uBaseVertex,
-                    0u
-                );
-            }
-        }
+        if (item.eType == eRenderItemType::VOXEL)
+        {
+            Voxel& voxel = static_cast<Voxel&>(renderable);
+
+            UINT strides[2] = { sizeof(SimpleVertex),sizeof(InstanceData) };
+            UINT offsets[2] = { 0,0 };
 
-        //std::unordered_map<std::wstring, std::shared_ptr<Model>>::iterator it_model;
-        for (auto it_model = m_scenes[m_pszMainSceneName]->GetModels().begin();
-            it_model != m_scenes[m_pszMainSceneName]->GetModels().end(); it_model++)
+            const RenderHandle vertexInstanceBuffers[2] = { voxel.GetVertexBuffer().Get(), item.instanceBuffer };
+            context.SetVertexBuffers(0, 2, vertexInstanceBuffers, strides, offsets);
+        }
+        else
         {
             UINT strides[1] = { sizeof(SimpleVertex) };
             UINT offsets[1] = { 0 };
+            const RenderHandle vertexBuffers[1] = { renderable.GetVertexBuffer().Get() };
+            context.SetVertexBuffers(0, 1, vertexBuffers, strides, offsets);
+        }
+        context.SetIndexBuffer(renderable.GetIndexBuffer().Get(), eIndexFormat::R16_UINT, 0);
+        // Voxels pick the instanced variant, the others the one without instance data
+        const UINT uShaderFeatures = renderable.GetShaderFeatures();
+        context.SetInputLayout(m_shadowVertexShader->GetVertexLayout(uShaderFeatures).Get());
 
-            ComPtr<ID3D11Buffer> vertexBuffers[1] = { it_model->second->GetVertexBuffer() };
-            m_immediateContext->IASetVertexBuffers(0, 1, vertexBuffers->GetAddressOf(), strides, offsets);
-            m_immediateContext->IASetIndexBuffer(it_model->second->GetIndexBuffer().Get(), DXGI_FORMAT_R16_UINT, 0);
-            m_immediateContext->IASetInputLayout(m_shadowVertexShader->GetVertexLayout().Get());
+        context.SetVertexShader(m_shadowVertexShader->GetVertexShader(uShaderFeatures).Get());
+        context.SetVertexConstantBuffers(0, 1, &item.objectConstants);
+        context.SetPixelShader(nullptr);
 
-            m_immediateContext->VSSetShader(m_shadowVertexShader->GetVertexShader().Get(), nullptr, 0);
-            m_immediateContext->VSSetConstantBuffers(0, 1, m_cbShadowMatrix.GetAddressOf());
-            m_immediateContext->PSSetShader(m_shadowPixelShader->GetPixelShader().Get(), nullptr, 0);
-            CBShadowMatrix cb =
+        // Single mesh renderables are drawn whole
+        if (renderable.GetNumMeshes() == 0u)
+        {
+            if (item.eType == eRenderItemType::VOXEL)
+            {
+                context.DrawIndexedInstanced(renderable.GetNumIndices(), item.uNumInstances, 0, 0, item.uFirstInstance);
+            }
+            else
             {
-                .World = XMMatrixTranspose(it_model->second->GetWorldMatrix()),
+                context.DrawIndexed(renderable.GetNumIndices(), 0, 0);
+            }
+            return;
+        }
 
-                .IsVoxel = false
-            };
-            m_immediateContext->UpdateSubresource(m_cbShadowMatrix.Get(), 0, nullptr, &cb, 0, 0);
+        for (UINT i = 0u; i < renderable.GetNumMeshes(); ++i)
+        {
+            if (!isMeshVisible(item, i))
+            {
+                continue;
+            }
 
-            for (UINT i = 0u; i < it_model->second->GetNumMeshes(); ++i)
+            // Render the triangles
+            if (item.eType == eRenderItemType::VOXEL)
             {
-                m_immediateContext->DrawIndexed(
-                    it_model->second->GetMesh(i).uNumIndices,
-                    it_model->second->GetMesh(i).uBaseIndex,
-                    it_model->second->GetMesh(i).uBaseVertex
+                context.DrawIndexedInstanced(
+                    renderable.GetMesh(i).uNumIndices,
+                    item.uNumInstances,
+                    renderable.GetMesh(i).uBaseIndex,
+                    renderable.GetMesh(i).uBaseVertex,
+                    item.uFirstInstance
+                );
+            }
+            else
+            {
+                context.DrawIndexed(
+                    renderable.GetMesh(i).uNumIndices,
+                    renderable.GetMesh(i).uBaseIndex,
+                    renderable.GetMesh(i).uBaseVertex
                 );
             }
-
         }
-        m_immediateContext->OMSetRenderTargets(1,
-            m_renderTargetView.GetAddressOf(), m_depthStencilView.Get());
     }
 
 
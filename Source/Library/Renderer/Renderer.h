@@ -13,20 +13,190 @@
 
 #include "Common.h"
 
+#include <algorithm>
+#include <bit>
+#include <cfloat>
+#include <chrono>
+#include <cmath>
+#include <thread>
+
 #include "Camera/Camera.h"
 #include "Light/PointLight.h"
 #include "Model/Model.h"
+#include "Profiler/GpuProfiler.h"
+#include "Renderer/ClusteredLightCuller.h"
+#include "Renderer/D3D11RenderContext.h"
 #include "Renderer/DataTypes.h"
+#include "Renderer/FrustumCuller.h"
+#include "Renderer/NullRenderContext.h"
+#include "Renderer/OcclusionCuller.h"
 #include "Renderer/Renderable.h"
+#include "Renderer/RenderThreadPool.h"
+#include "Renderer/RingAllocator.h"
+#include "Renderer/ShadowAtlas.h"
+#include "Renderer/ShadowCascades.h"
 #include "Scene/Scene.h"
 #include "Shader/PixelShader.h"
 #include "Shader/VertexShader.h"
+#include "Texture/TextureAtlas.h"
+#include "Texture/TextureCache.h"
+#include "Texture/TextureStreamer.h"
 #include "Window/MainWindow.h"
-#include "Texture/RenderTexture.h"
 #include "Shader/ShadowVertexShader.h"
 
 namespace library
 {
+    /*E+E+++E+++E+++E+++E+++E+++E+++E+++E+++E+++E+++E+++E+++E+++E+++E+++E
+      Enum:     eRenderItemType
+
+      Summary:  Enumeration of the kinds of objects in the render queue
+    E---E---E---E---E---E---E---E---E---E---E---E---E---E---E---E---E-E*/
+    enum class eRenderItemType : UINT
+    {
+        RENDERABLE = 0,
+        VOXEL,
+        MODEL,
+        COUNT,
+    };
+
+    /*E+E+++E+++E+++E+++E+++E+++E+++E+++E+++E+++E+++E+++E+++E+++E+++E+++E
+      Enum:     eRenderPass
+
+      Summary:  Enumeration of the passes that build a render queue
+    E---E---E---E---E---E---E---E---E---E---E---E---E---E---E---E---E-E*/
+    enum class eRenderPass : UINT
+    {
+        MAIN = 0,
+        SHADOW,
+        COUNT,
+    };
+
+    /*S+S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S
+      Struct:   RenderItem
+
+      Summary:  Entry of the render queue, a visible object of the main
+                scene, how to record it and where the visibility of its
+                meshes and instances starts, NO_VISIBILITY when all of
+                them are visible. The world matrix is the one blended
+                between the last two simulation steps. Voxels also carry the instances to
+                draw, all of their own buffer or the visible ones
+                written into the instance ring. The constants of the
+                object, and the bones of a model, live in the constant
+                ring. The bones are copied from the bone transforms of
+                the snapshot
+    S---S---S---S---S---S---S---S---S---S---S---S---S---S---S---S---S-S*/
+    struct RenderItem
+    {
+        static constexpr UINT NO_VISIBILITY = 0xFFFFFFFFu;
+
+        eRenderItemType eType;
+        Renderable* pRenderable;
+        XMFLOAT4X4 World;
+        UINT uFirstMeshVisibility;
+        UINT uFirstInstanceVisibility;
+        RenderHandle instanceBuffer;
+        UINT uFirstInstance;
+        UINT uNumInstances;
+        ConstantBufferRange objectConstants;
+        ConstantBufferRange skinningConstants;
+        UINT uFirstBone;
+        UINT uNumBones;
+    };
+
+    /*S+S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S
+      Struct:   InstanceBatch
+
+      Summary:  Contiguous range of the instances of a voxel, the unit
+                the instance culling and compaction are split into
+                across the threads
+    S---S---S---S---S---S---S---S---S---S---S---S---S---S---S---S---S-S*/
+    struct InstanceBatch
+    {
+        XMFLOAT4X4 WorldViewProjection;
+        UINT uItem;
+        UINT uFirstInstance;
+        UINT uNumInstances;
+        UINT uNumVisible;
+        UINT uRingOffset;
+    };
+
+    /*S+S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S
+      Struct:   Occluder
+
+      Summary:  Candidate occluder of the main pass, a whole renderable
+                or a single voxel instance, ranked by the size it
+                covers on screen, with the render item it comes from
+    S---S---S---S---S---S---S---S---S---S---S---S---S---S---S---S---S-S*/
+    struct Occluder
+    {
+        static constexpr UINT WHOLE_RENDERABLE = 0xFFFFFFFFu;
+
+        FLOAT ScreenSize;
+        Renderable* pRenderable;
+        UINT uItem;
+        UINT uInstance;
+    };
+
+    /*S+S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S
+      Struct:   PassTargets
+
+      Summary:  Views a pass draws into and reads the shadow maps from,
+                and the size of its viewport. The shadow passes draw
+                depth only and read no shadow map
+    S---S---S---S---S---S---S---S---S---S---S---S---S---S---S---S---S-S*/
+    struct PassTargets
+    {
+        RenderHandle renderTargetView;
+        RenderHandle depthStencilView;
+        RenderHandle shadowMapView;
+        UINT uWidth;
+        UINT uHeight;
+    };
+
+    /*S+S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S
+      Struct:   FrameSnapshot
+
+      Summary:  Everything the passes of a frame read from the main
+                scene and the camera, gathered once when the frame
+                starts and left untouched until the next one: the
+                camera and shadow light matrices, the packed lights
+                and their view space spheres, and one unculled render
+                item per object the render queues are copied from.
+                The shadow slices are the cascades of the first light,
+                cast along the shadow direction of the scene, followed
+                by the cube faces of the next ones, the voxels are
+                their static casters and everything else their dynamic
+                ones. The bone transforms of the animated
+                models are copied too, so the scene can be simulated
+                while the passes read the snapshot
+    S---S---S---S---S---S---S---S---S---S---S---S---S---S---S---S---S-S*/
+    struct FrameSnapshot
+    {
+        static constexpr UINT NUM_SHADOW_SLICES = NUM_SHADOW_CASCADES + MAX_NUM_CUBE_SHADOWS * PointLight::NUM_CUBE_FACES;
+
+        XMMATRIX View;
+        XMMATRIX Projection;
+        XMMATRIX ViewProjection;
+        XMMATRIX SkyboxWorld;
+        XMMATRIX LightView;
+        XMMATRIX LightProjection;
+        XMMATRIX ShadowViewProjections[NUM_SHADOW_SLICES];
+        XMVECTOR CameraPosition;
+        XMFLOAT3 ShadowDirection;
+        XMFLOAT4 CascadeSplits;
+        XMUINT4 ShadowLights;
+        Scene* pScene;
+        Skybox* pSkybox;
+        BOOL bHasShadowLight;
+        UINT64 uStaticCasterRevision;
+        std::vector<PointLightData> aLights;
+        std::vector<LightSphere> aLightSpheres;
+        std::vector<RenderItem> aItems;
+        std::vector<RenderItem> aStaticCasters;
+        std::vector<RenderItem> aDynamicCasters;
+        std::vector<XMMATRIX> aBoneTransforms;
+    };
+
     /*C+C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C
       Class:    Renderer
 
@@ -35,14 +205,68 @@ namespace library
 
       Methods:  Initialize
                   Creates Direct3D device and swap chain
+                InitializeHeadless
+                  Initializes the scene without any device, recording
+                  into a null render context
                 AddRenderable
                   Add a renderable object and initialize the object
+                SetCameraLookAt
+                  Places the camera at an eye looking at a point
                 Update
                   Update the renderables each frame
+                SaveState
+                  Keeps the state of the camera and the main scene
+                  before a simulation step
                 Render
-                  Renders the frame
+                  Renders the frame between the last two simulation
+                  steps
+                CaptureFrame
+                  Takes the snapshot of the next frame
+                SwapFrames
+                  Makes the captured snapshot the one rendered
+                RenderFrame
+                  Renders the snapshot of the current frame
                 GetDriverType
                   Returns the Direct3D driver type
+                GetRenderStatistics
+                  Returns the statistics of the last rendered frame
+                SetNumSubmissionThreads
+                  Sets the number of threads that record draw calls
+                GetNumSubmissionThreads
+                  Returns the number of threads that record draw calls
+                GetSubmissionTime
+                  Returns the CPU time spent recording the last frame
+                SetFrustumCulling
+                  Enables or disables the frustum culling
+                SetVoxelBatching
+                  Enables or disables drawing the voxels in one call
+                GetCullingStatistics
+                  Returns the culling counters of a pass
+                SetOcclusionCulling
+                  Enables or disables the occlusion culling
+                GetOcclusionTime
+                  Returns the CPU time spent drawing the occluders
+                GetLightCullingTime
+                  Returns the CPU time spent assigning the lights to
+                  the clusters
+                GetNumDroppedLights
+                  Returns the lights left out of full clusters
+                GetSnapshotTime
+                  Returns the CPU time spent gathering the frame
+                  snapshot
+                GetSceneLoadTime
+                  Returns the time spent loading the main scene
+                SetShadowMapShader
+                  Sets the vertex shader of the shadow maps
+                GetShadowStatistics
+                  Returns the shadow map counters of the last frame
+                GetShadowCullingStatistics
+                  Returns the culling counters of a shadow slice
+                SetGpuProfiling
+                  Enables or disables timing the passes on the GPU
+                GetGpuStatistics
+                  Returns the GPU times of the passes of the last
+                  frame read back
                 Renderer
                   Constructor.
                 ~Renderer
@@ -59,20 +283,98 @@ namespace library
         ~Renderer() = default;
 
         HRESULT Initialize(_In_ HWND hWnd);
+        HRESULT InitializeHeadless(_In_ UINT uWidth, _In_ UINT uHeight);
 
         HRESULT AddScene(_In_ PCWSTR pszSceneName, _In_ const std::shared_ptr<Scene>& scene);
         std::shared_ptr<Scene> GetSceneOrNull(_In_ PCWSTR pszSceneName);
         HRESULT SetMainScene(_In_ PCWSTR pszSceneName);
-        void SetShadowMapShaders(_In_ std::shared_ptr<ShadowVertexShader> vertexShader, _In_ std::shared_ptr<PixelShader> pixelShader);
+        void SetShadowMapShader(_In_ std::shared_ptr<ShadowVertexShader> vertexShader);
 
         void HandleInput(_In_ const DirectionsInput& directions, _In_ const MouseRelativeMovement& mouseRelativeMovement, _In_ FLOAT deltaTime);
+        void SetCameraLookAt(_In_ const XMVECTOR& eye, _In_ const XMVECTOR& at);
         void Update(_In_ FLOAT deltaTime);
-        void Render();
-        void RenderSceneToTexture();
+        void SaveState();
+        void Render(_In_ FLOAT alpha = 1.0f);
+        void CaptureFrame(_In_ FLOAT alpha);
+        void SwapFrames();
+        void RenderFrame();
 
         D3D_DRIVER_TYPE GetDriverType() const;
+        const RenderStatistics& GetRenderStatistics() const;
+
+        HRESULT SetNumSubmissionThreads(_In_ UINT uNumThreads);
+        UINT GetNumSubmissionThreads() const;
+        FLOAT GetSubmissionTime() const;
+
+        void SetFrustumCulling(_In_ BOOL bEnable);
+        void SetVoxelBatching(_In_ BOOL bEnable);
+        const CullingStatistics& GetCullingStatistics(_In_ eRenderPass pass) const;
+        void SetOcclusionCulling(_In_ BOOL bEnable);
+        FLOAT GetOcclusionTime() const;
+        FLOAT GetLightCullingTime() const;
+        UINT GetNumDroppedLights() const;
+        FLOAT GetSnapshotTime() const;
+        FLOAT GetSceneLoadTime() const;
+        const ShadowStatistics& GetShadowStatistics() const;
+        const CullingStatistics& GetShadowCullingStatistics(_In_ UINT uSlice) const;
+        void SetGpuProfiling(_In_ BOOL bEnable);
+        const std::vector<ProfileStatistic>& GetGpuStatistics() const;
 
     private:
+        static constexpr UINT MIN_ITEMS_PER_SUBMISSION_TASK = 16u;
+        static constexpr UINT OCCLUSION_BUFFER_WIDTH = 256u;
+        static constexpr UINT OCCLUSION_BUFFER_HEIGHT = 128u;
+        static constexpr UINT MAX_OCCLUDER_TRIANGLES = 16384u;
+        static constexpr FLOAT MIN_OCCLUDER_SCREEN_SIZE = 0.05f;
+        static constexpr UINT INSTANCES_PER_CULLING_BATCH = 4096u;
+        static constexpr UINT INSTANCE_RING_CAPACITY = 1u << 19u;
+        static constexpr UINT CONSTANT_RING_SIZE = 1u << 22u;
+        static constexpr UINT MIN_LIGHTS_PER_CULLING_TASK = 64u;
+        static constexpr UINT SHADOW_MAP_SIZE = 1024u;
+        static constexpr FLOAT SHADOW_DISTANCE = 200.0f;
+        static constexpr FLOAT SHADOW_SPLIT_LAMBDA = 0.75f;
+        static constexpr FLOAT SHADOW_CASTER_DISTANCE = 500.0f;
+        static constexpr FLOAT CASCADE_DEPTH_BIAS = 0.0015f;
+        static constexpr FLOAT CUBE_DEPTH_BIAS = 0.0002f;
+        static constexpr UINT NUM_TEXTURE_STREAMING_THREADS = 2u;
+        static constexpr UINT64 TEXTURE_UPLOAD_BUDGET = 4ull << 20ull;
+
+        using RecordFunction = void (Renderer::*)(RenderContext&, const RenderItem&);
+
+        HRESULT initializeScene(_In_ UINT uWidth, _In_ UINT uHeight);
+        HRESULT createSubmissionContexts();
+        HRESULT createConstantRing(_In_ UINT uSize);
+        HRESULT createLightBuffers();
+        HRESULT createShadowMaps();
+        HRESULT createVoxelMaterials();
+
+        void takeFrameSnapshot();
+        void renderShadowMaps();
+        UINT drawShadowCasters(_In_ const std::vector<RenderItem>& aCasters, _In_ const XMMATRIX& viewProjection, _In_ RenderHandle depthStencilView, _Inout_ CullingStatistics& statistics);
+        void buildRenderQueue(_In_ eRenderPass pass, _In_ const XMMATRIX& viewProjection, _In_ const std::vector<RenderItem>& aItems);
+        void cullRenderQueue(_In_ eRenderPass pass, _In_ const XMMATRIX& viewProjection);
+        void rasterizeOccluders(_In_ const XMMATRIX& viewProjection);
+        void compactInstances(_In_ eRenderPass pass);
+        void batchVoxels();
+        BOOL canBatchVoxels(_In_ const RenderItem& batch, _In_ const RenderItem& item) const;
+        HRESULT cullLights();
+        HRESULT uploadConstants(_In_ eRenderPass pass);
+        void writeObjectConstants(_In_ eRenderPass pass, _In_ const RenderItem& item, _Out_ BYTE* pBlock) const;
+        void submitRenderQueue(_In_ RecordFunction pfnRecord, _In_ const PassTargets& targets, _In_ UINT uBegin, _In_ UINT uEnd);
+        void submitMainPass(_In_ const PassTargets& targets);
+        void bindFrameState(_In_ RenderContext& context, _In_ const PassTargets& targets);
+        PassTargets getMainPassTargets() const;
+        BOOL isMeshVisible(_In_ const RenderItem& item, _In_ UINT uMeshIndex) const;
+        static UINT alignConstantSize(_In_ UINT uSize);
+        static void addCullingStatistics(_Inout_ CullingStatistics& total, _In_ const CullingStatistics& statistics);
+
+        void recordItem(_In_ RenderContext& context, _In_ const RenderItem& item);
+        void recordRenderable(_In_ RenderContext& context, _In_ const RenderItem& item);
+        void recordVoxel(_In_ RenderContext& context, _In_ const RenderItem& item);
+        void recordModel(_In_ RenderContext& context, _In_ const RenderItem& item);
+        void recordSkybox(_In_ RenderContext& context, _In_ Skybox& skybox);
+        void recordShadowCaster(_In_ RenderContext& context, _In_ const RenderItem& item);
+
         D3D_DRIVER_TYPE m_driverType;
         D3D_FEATURE_LEVEL m_featureLevel;
         ComPtr<ID3D11Device> m_d3dDevice;
@@ -84,18 +386,74 @@ namespace library
         ComPtr<ID3D11RenderTargetView> m_renderTargetView;
         ComPtr<ID3D11Texture2D> m_depthStencil;
         ComPtr<ID3D11DepthStencilView> m_depthStencilView;
-        ComPtr<ID3D11Buffer> m_cbChangeOnResize;
-        ComPtr<ID3D11Buffer> m_cbLights;
-        ComPtr<ID3D11Buffer> m_cbShadowMatrix;
-        PCWSTR m_pszMainSceneName;
+        ComPtr<ID3D11Buffer> m_constantRingBuffer;
+        ComPtr<ID3D11Buffer> m_instanceRingBuffer;
+        ComPtr<ID3D11Buffer> m_lightBuffer;
+        ComPtr<ID3D11Buffer> m_clusterRangeBuffer;
+        ComPtr<ID3D11Buffer> m_lightIndexBuffer;
+        ComPtr<ID3D11ShaderResourceView> m_lightView;
+        ComPtr<ID3D11ShaderResourceView> m_clusterRangeView;
+        ComPtr<ID3D11ShaderResourceView> m_lightIndexView;
+        ComPtr<ID3D11Texture2D> m_staticShadowMaps;
+        ComPtr<ID3D11Texture2D> m_shadowMaps;
+        ComPtr<ID3D11DepthStencilView> m_aStaticShadowDepthViews[FrameSnapshot::NUM_SHADOW_SLICES];
+        ComPtr<ID3D11DepthStencilView> m_aShadowDepthViews[FrameSnapshot::NUM_SHADOW_SLICES];
+        ComPtr<ID3D11ShaderResourceView> m_shadowMapView;
+        ComPtr<ID3D11SamplerState> m_shadowSampler;
+        ComPtr<ID3D11Buffer> m_voxelMaterialBuffer;
+        ComPtr<ID3D11ShaderResourceView> m_voxelMaterialView;
+        std::unique_ptr<RenderContext> m_renderContext;
+        std::vector<std::unique_ptr<RenderContext>> m_aSubmissionContexts;
+        RenderThreadPool m_submissionThreadPool;
+        UINT m_uNumSubmissionThreads;
+        UINT m_uWidth;
+        UINT m_uHeight;
+        FLOAT m_submissionTime;
+        Scene* m_pMainScene;
         BYTE m_padding[8];
         Camera m_camera;
         XMMATRIX m_projection;
 
         std::unordered_map<std::wstring, std::shared_ptr<Scene>> m_scenes;
         std::shared_ptr<Texture> m_invalidTexture;
-        std::shared_ptr<RenderTexture> m_shadowMapTexture;
         std::shared_ptr<ShadowVertexShader> m_shadowVertexShader;
-        std::shared_ptr<PixelShader> m_shadowPixelShader;
+        std::vector<RenderItem> m_aRenderQueue;
+        FrustumCuller m_frustumCuller;
+        BoundingBoxArray m_objectBounds;
+        BoundingBoxArray m_meshBounds;
+        std::vector<BYTE> m_aObjectVisibility;
+        std::vector<BYTE> m_aMeshVisibility;
+        std::vector<BYTE> m_aInstanceVisibility;
+        std::vector<InstanceBatch> m_aInstanceBatches;
+        RingAllocator m_instanceRing;
+        RingAllocator m_constantRing;
+        ConstantBufferCopies m_constantBufferCopies;
+        BOOL m_bConstantBufferOffsetting;
+        ConstantBufferRange m_cameraConstants;
+        ConstantBufferRange m_resizeConstants;
+        ConstantBufferRange m_lightsConstants;
+        ConstantBufferRange m_skyboxConstants;
+        ConstantBufferRange m_shadowsConstants;
+        UINT64 m_uFrameFenceValue;
+        CullingStatistics m_aCullingStatistics[static_cast<size_t>(eRenderPass::COUNT)];
+        BOOL m_bFrustumCulling;
+        OcclusionCuller m_occlusionCuller;
+        std::vector<Occluder> m_aOccluders;
+        BOOL m_bOcclusionCulling;
+        ClusteredLightCuller m_lightCuller;
+        FLOAT m_lightCullingTime;
+        FrameSnapshot m_frameSnapshot;
+        FrameSnapshot m_capturedSnapshot;
+        FLOAT m_snapshotTime;
+        FLOAT m_interpolationAlpha;
+        FLOAT m_sceneLoadTime;
+        ShadowCascades m_shadowCascades;
+        ShadowAtlas m_shadowAtlas;
+        UINT m_uShadowSlice;
+        CullingStatistics m_aShadowCullingStatistics[FrameSnapshot::NUM_SHADOW_SLICES];
+        TextureAtlas m_voxelAtlas;
+        std::vector<VoxelMaterialData> m_aVoxelMaterials;
+        BOOL m_bVoxelBatching;
+        GpuProfiler m_gpuProfiler;
     };
 }
\ No newline at end of file
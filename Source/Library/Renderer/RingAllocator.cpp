@@ -0,0 +1,227 @@
+#include "Renderer/RingAllocator.h"
+
+namespace library
+{
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   RingAllocator::RingAllocator
+      Summary:  Constructor. Nothing can be allocated until the ring is
+                initialized
+      Modifies: [m_uCapacity, m_uHead, m_uTail, m_uAllocated,
+                  m_uRetired, m_aFrameFences, m_bDiscardPending].
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    RingAllocator::RingAllocator()
+        : m_uCapacity(0u)
+        , m_uHead(0u)
+        , m_uTail(0u)
+        , m_uAllocated(0u)
+        , m_uRetired(0u)
+        , m_aFrameFences()
+        , m_bDiscardPending(TRUE)
+    {
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   RingAllocator::Initialize
+      Summary:  Sets the capacity and empties the ring
+      Args:     UINT uCapacity
+                  Size of the buffer, in the unit of the allocations
+      Modifies: [m_uCapacity, m_uHead, m_uTail, m_uAllocated,
+                  m_uRetired, m_aFrameFences, m_bDiscardPending].
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    void RingAllocator::Initialize(_In_ UINT uCapacity)
+    {
+        m_uCapacity = uCapacity;
+        Reset();
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   RingAllocator::Allocate
+      Summary:  Reserves a range after the previous allocation, aligned
+                up, or at the front when the end of the ring is too
+                short and the front has been released. Otherwise every
+                range in flight is dropped, the buffer must be
+                discarded and the range starts at the front
+      Args:     UINT uSize
+                  Size of the range
+                UINT uAlignment
+                  Alignment of the offset, a power of two
+                UINT* puOffset
+                  Receives the offset of the range
+                BOOL* pbDiscard
+                  Receives TRUE when the buffer has to be discarded
+                  before the range is written
+      Modifies: [m_uHead, m_uTail, m_uAllocated, m_uRetired,
+                  m_aFrameFences, m_bDiscardPending].
+      Returns:  BOOL
+                  FALSE when the range is larger than the ring
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    BOOL RingAllocator::Allocate(_In_ UINT uSize, _In_ UINT uAlignment, _Out_ UINT* puOffset, _Out_ BOOL* pbDiscard)
+    {
+        assert(uAlignment != 0u && (uAlignment & (uAlignment - 1u)) == 0u);
+
+        *puOffset = 0u;
+        *pbDiscard = FALSE;
+
+        if (uSize > m_uCapacity)
+        {
+            return FALSE;
+        }
+
+        // Everything was released, start over from the front. Frames
+        // still fenced allocated nothing, they end at the front too
+        if (GetNumUsed() == 0u)
+        {
+            m_uHead = 0u;
+            m_uTail = 0u;
+            for (FrameFence& frameFence : m_aFrameFences)
+            {
+                frameFence.uHead = 0u;
+            }
+        }
+
+        const UINT64 uAligned = (static_cast<UINT64>(m_uHead) + uAlignment - 1u) & ~static_cast<UINT64>(uAlignment - 1u);
+        UINT64 uOffset = 0u;
+        BOOL bFits = FALSE;
+        if (m_bDiscardPending)
+        {
+            bFits = FALSE;
+        }
+        else if (m_uHead > m_uTail || GetNumUsed() == 0u)
+        {
+            // Free space is [head, capacity) then [0, tail)
+            if (uAligned + uSize <= m_uCapacity)
+            {
+                uOffset = uAligned;
+                bFits = TRUE;
+            }
+            else if (uSize <= m_uTail)
+            {
+                m_uAllocated += m_uCapacity - m_uHead;
+                m_uHead = 0u;
+                uOffset = 0u;
+                bFits = TRUE;
+            }
+        }
+        else if (uAligned + uSize <= m_uTail)
+        {
+            // Free space is [head, tail)
+            uOffset = uAligned;
+            bFits = TRUE;
+        }
+
+        if (!bFits)
+        {
+            // The renamed buffer holds nothing the GPU reads
+            m_uRetired = m_uAllocated;
+            m_aFrameFences.clear();
+            m_uHead = 0u;
+            m_uTail = 0u;
+            m_bDiscardPending = FALSE;
+            *pbDiscard = TRUE;
+            uOffset = 0u;
+        }
+
+        m_uAllocated += uOffset - m_uHead + uSize;
+        m_uHead = static_cast<UINT>(uOffset) + uSize;
+        *puOffset = static_cast<UINT>(uOffset);
+
+        return TRUE;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   RingAllocator::EndFrame
+      Summary:  Fences the ranges allocated since the previous frame
+      Args:     UINT64 uFenceValue
+                  Value the GPU signals once it is done with the frame,
+                  increasing from frame to frame
+      Modifies: [m_aFrameFences].
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    void RingAllocator::EndFrame(_In_ UINT64 uFenceValue)
+    {
+        assert(m_aFrameFences.empty() || m_aFrameFences.back().uFenceValue < uFenceValue);
+
+        m_aFrameFences.push_back({ .uFenceValue = uFenceValue, .uAllocated = m_uAllocated, .uHead = m_uHead });
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   RingAllocator::RetireFrames
+      Summary:  Releases the ranges of the frames whose fence has
+                completed
+      Args:     UINT64 uCompletedFenceValue
+                  Last fence value the GPU signaled
+      Modifies: [m_uTail, m_uRetired, m_aFrameFences].
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    void RingAllocator::RetireFrames(_In_ UINT64 uCompletedFenceValue)
+    {
+        while (!m_aFrameFences.empty() && m_aFrameFences.front().uFenceValue <= uCompletedFenceValue)
+        {
+            m_uTail = m_aFrameFences.front().uHead;
+            m_uRetired = m_aFrameFences.front().uAllocated;
+            m_aFrameFences.pop_front();
+        }
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   RingAllocator::Reset
+      Summary:  Empties the ring. The GPU may still read the buffer, so
+                the next allocation asks for a discard
+      Modifies: [m_uHead, m_uTail, m_uAllocated, m_uRetired,
+                  m_aFrameFences, m_bDiscardPending].
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    void RingAllocator::Reset()
+    {
+        m_uHead = 0u;
+        m_uTail = 0u;
+        m_uAllocated = 0u;
+        m_uRetired = 0u;
+        m_aFrameFences.clear();
+        m_bDiscardPending = TRUE;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   RingAllocator::GetCapacity
+      Summary:  Returns the capacity of the ring
+      Returns:  UINT
+                  Capacity
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    UINT RingAllocator::GetCapacity() const
+    {
+        return m_uCapacity;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   RingAllocator::GetHead
+      Summary:  Returns the end of the last allocation
+      Returns:  UINT
+                  Offset the next allocation starts from, before
+                  alignment
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    UINT RingAllocator::GetHead() const
+    {
+        return m_uHead;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   RingAllocator::GetNumUsed
+      Summary:  Returns the space allocated and not yet released,
+                alignment padding and the end skipped by a wrap
+                included
+      Returns:  UINT64
+                  Space in use
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    UINT64 RingAllocator::GetNumUsed() const
+    {
+        return m_uAllocated - m_uRetired;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   RingAllocator::GetNumFramesInFlight
+      Summary:  Returns the number of fenced frames not yet retired
+      Returns:  UINT
+                  Number of frames
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    UINT RingAllocator::GetNumFramesInFlight() const
+    {
+        return static_cast<UINT>(m_aFrameFences.size());
+    }
+}
@@ -0,0 +1,101 @@
+﻿/*+===================================================================
+  File:      RINGALLOCATOR.H
+
+  Summary:   RingAllocator header file contains declarations of the
+             RingAllocator class that hands out ranges of a dynamic
+             buffer written with no-overwrite maps, and keeps track of
+             the frames the GPU may still be reading.
+
+  Classes: RingAllocator
+
+  © 2022 Kyung Hee University
+===================================================================+*/
+#pragma once
+
+#include "Common.h"
+
+#include <deque>
+
+namespace library
+{
+    /*C+C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C
+      Class:    RingAllocator
+
+      Summary:  Bookkeeping of a buffer filled front to back and reused
+                from the front once the GPU is done with it. Ranges are
+                appended after the previous ones, so they can be
+                written without overwriting anything the GPU may still
+                read. The ranges of a frame are fenced when the frame
+                ends and released when the fence completes. When a
+                range does not fit in the released space, the buffer
+                has to be discarded, i.e. renamed by the driver, and
+                the allocator starts over from the front. Holds no
+                memory, sizes are in whatever unit the caller uses
+
+      Methods:  Initialize
+                  Sets the capacity and empties the ring
+                Allocate
+                  Reserves a range
+                EndFrame
+                  Fences the ranges allocated since the last frame
+                RetireFrames
+                  Releases the ranges of the completed frames
+                Reset
+                  Empties the ring
+                GetCapacity
+                  Returns the capacity
+                GetHead
+                  Returns the offset of the next allocation
+                GetNumUsed
+                  Returns the space the GPU may still be reading
+                GetNumFramesInFlight
+                  Returns the number of fenced frames not yet retired
+                RingAllocator
+                  Constructor.
+                ~RingAllocator
+                  Destructor.
+    C---C---C---C---C---C---C---C---C---C---C---C---C---C---C---C---C-C*/
+    class RingAllocator final
+    {
+    public:
+        RingAllocator();
+        RingAllocator(const RingAllocator& other) = default;
+        RingAllocator(RingAllocator&& other) = default;
+        RingAllocator& operator=(const RingAllocator& other) = default;
+        RingAllocator& operator=(RingAllocator&& other) = default;
+        ~RingAllocator() = default;
+
+        void Initialize(_In_ UINT uCapacity);
+        BOOL Allocate(_In_ UINT uSize, _In_ UINT uAlignment, _Out_ UINT* puOffset, _Out_ BOOL* pbDiscard);
+        void EndFrame(_In_ UINT64 uFenceValue);
+        void RetireFrames(_In_ UINT64 uCompletedFenceValue);
+        void Reset();
+
+        UINT GetCapacity() const;
+        UINT GetHead() const;
+        UINT64 GetNumUsed() const;
+        UINT GetNumFramesInFlight() const;
+
+    private:
+        /*S+S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S
+          Struct:   FrameFence
+
+          Summary:  End of the ranges of a frame and the fence value
+                    that tells when the GPU is done with them
+        S---S---S---S---S---S---S---S---S---S---S---S---S---S---S---S---S-S*/
+        struct FrameFence
+        {
+            UINT64 uFenceValue;
+            UINT64 uAllocated;
+            UINT uHead;
+        };
+
+        UINT m_uCapacity;
+        UINT m_uHead;
+        UINT m_uTail;
+        UINT64 m_uAllocated;
+        UINT64 m_uRetired;
+        std::deque<FrameFence> m_aFrameFences;
+        BOOL m_bDiscardPending;
+    };
+}
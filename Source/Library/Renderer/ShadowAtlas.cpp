@@ -0,0 +1,216 @@
+#include "Renderer/ShadowAtlas.h"
+
+namespace library
+{
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   ShadowAtlas::ShadowAtlas
+      Summary:  Constructor. There is no slice until initialized
+      Modifies: [m_aSlices, m_uNumCascades, m_statistics].
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    ShadowAtlas::ShadowAtlas()
+        : m_aSlices()
+        , m_uNumCascades(0u)
+        , m_statistics()
+    {
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   ShadowAtlas::Initialize
+      Summary:  Sets the number of slices, none of them holds a static
+                layer yet
+      Args:     UINT uNumSlices
+                  Number of slices of the shadow maps
+                UINT uNumCascades
+                  Number of those slices that are cascades, the first
+                  ones
+      Modifies: [m_aSlices, m_uNumCascades, m_statistics].
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    void ShadowAtlas::Initialize(_In_ UINT uNumSlices, _In_ UINT uNumCascades)
+    {
+        assert(uNumCascades <= uNumSlices);
+
+        m_aSlices.resize(uNumSlices);
+        m_uNumCascades = uNumCascades;
+        Invalidate();
+        BeginFrame();
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   ShadowAtlas::BeginFrame
+      Summary:  Zeroes the statistics before the slices of a frame
+      Modifies: [m_statistics].
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    void ShadowAtlas::BeginFrame()
+    {
+        m_statistics = {};
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   ShadowAtlas::BeginSlice
+      Summary:  Starts a slice of the frame and tells whether its static
+                layer has to be drawn again. When it does not, the draws
+                it took are counted as saved
+      Args:     UINT uSlice
+                  Index of the slice
+                UINT64 uStaticKey
+                  Key of the static layer the slice needs this frame
+      Modifies: [m_statistics].
+      Returns:  BOOL
+                  TRUE if the static layer is stale
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    BOOL ShadowAtlas::BeginSlice(_In_ UINT uSlice, _In_ UINT64 uStaticKey)
+    {
+        assert(uSlice < m_aSlices.size());
+
+        const Slice& slice = m_aSlices[uSlice];
+        ++m_statistics.uNumSlices;
+        if (slice.bStaticValid && slice.uStaticKey == uStaticKey)
+        {
+            UINT& uNumDrawsSaved = (uSlice < m_uNumCascades) ? m_statistics.uNumCascadeDrawsSaved : m_statistics.uNumCubeDrawsSaved;
+            uNumDrawsSaved += slice.uNumStaticDraws;
+            return FALSE;
+        }
+
+        return TRUE;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   ShadowAtlas::SetStatic
+      Summary:  Records that the static layer of a slice was drawn
+                again. The shadow map no longer matches it
+      Args:     UINT uSlice
+                  Index of the slice
+                UINT64 uStaticKey
+                  Key the static layer was drawn for
+                UINT uNumDraws
+                  Draw calls the static layer took
+      Modifies: [m_aSlices, m_statistics].
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    void ShadowAtlas::SetStatic(_In_ UINT uSlice, _In_ UINT64 uStaticKey, _In_ UINT uNumDraws)
+    {
+        assert(uSlice < m_aSlices.size());
+
+        m_aSlices[uSlice] = { .uStaticKey = uStaticKey, .uNumStaticDraws = uNumDraws, .bStaticValid = TRUE, .bMatchesStatic = FALSE };
+
+        ++m_statistics.uNumStaticRedraws;
+        m_statistics.uNumStaticDraws += uNumDraws;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   ShadowAtlas::NeedsCopy
+      Summary:  Tells whether the shadow map of a slice has to be
+                restored from its static layer before the dynamic
+                casters are drawn
+      Args:     UINT uSlice
+                  Index of the slice
+      Returns:  BOOL
+                  TRUE if the shadow map differs from the static layer
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    BOOL ShadowAtlas::NeedsCopy(_In_ UINT uSlice) const
+    {
+        assert(uSlice < m_aSlices.size());
+
+        return !m_aSlices[uSlice].bMatchesStatic;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   ShadowAtlas::SetDynamic
+      Summary:  Records the end of a slice: whether its static layer was
+                copied into the shadow map and how many draws the
+                dynamic casters took on top of it
+      Args:     UINT uSlice
+                  Index of the slice
+                BOOL bCopied
+                  TRUE if the static layer was copied
+                UINT uNumDraws
+                  Draw calls of the dynamic casters
+      Modifies: [m_aSlices, m_statistics].
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    void ShadowAtlas::SetDynamic(_In_ UINT uSlice, _In_ BOOL bCopied, _In_ UINT uNumDraws)
+    {
+        assert(uSlice < m_aSlices.size());
+
+        m_aSlices[uSlice].bMatchesStatic = (bCopied || m_aSlices[uSlice].bMatchesStatic) && uNumDraws == 0u;
+
+        m_statistics.uNumCopies += bCopied ? 1u : 0u;
+        m_statistics.uNumDynamicDraws += uNumDraws;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   ShadowAtlas::Invalidate
+      Summary:  Forgets every static layer, e.g. when the textures are
+                created again
+      Modifies: [m_aSlices].
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    void ShadowAtlas::Invalidate()
+    {
+        for (Slice& slice : m_aSlices)
+        {
+            slice = { .uStaticKey = 0u, .uNumStaticDraws = 0u, .bStaticValid = FALSE, .bMatchesStatic = FALSE };
+        }
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   ShadowAtlas::GetNumSlices
+      Summary:  Returns the number of slices
+      Returns:  UINT
+                  Number of slices
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    UINT ShadowAtlas::GetNumSlices() const
+    {
+        return static_cast<UINT>(m_aSlices.size());
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   ShadowAtlas::GetStatistics
+      Summary:  Returns the counters of the slices since BeginFrame
+      Returns:  const ShadowStatistics&
+                  Draws, saved draws and copies
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    const ShadowStatistics& ShadowAtlas::GetStatistics() const
+    {
+        return m_statistics;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   ShadowAtlas::ComputeKey
+      Summary:  Computes the key of the static layer of a slice from
+                its view projection and the revision of the static
+                casters. The matrix is hashed bit for bit, the cascades
+                are snapped to texels and the cube faces follow their
+                light, so it only changes when the layer does
+      Args:     const FLOAT* aViewProjection
+                  View projection matrix of the slice, 16 floats
+                UINT64 uStaticRevision
+                  Hash of the static casters
+      Returns:  UINT64
+                  Key of the static layer
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    UINT64 ShadowAtlas::ComputeKey(_In_reads_(16) const FLOAT* aViewProjection, _In_ UINT64 uStaticRevision)
+    {
+        return Hash(aViewProjection, 16u * sizeof(FLOAT), Hash(&uStaticRevision, sizeof(uStaticRevision), HASH_OFFSET_BASIS));
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   ShadowAtlas::Hash
+      Summary:  Folds bytes into a 64-bit FNV-1a hash
+      Args:     const void* pData
+                  Bytes to hash
+                size_t uSize
+                  Number of bytes
+                UINT64 uHash
+                  Hash so far, HASH_OFFSET_BASIS to start one
+      Returns:  UINT64
+                  Hash including the bytes
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    UINT64 ShadowAtlas::Hash(_In_reads_bytes_(uSize) const void* pData, _In_ size_t uSize, _In_ UINT64 uHash)
+    {
+        const BYTE* aBytes = static_cast<const BYTE*>(pData);
+        for (size_t i = 0u; i < uSize; ++i)
+        {
+            uHash = (uHash ^ aBytes[i]) * 1099511628211ull;
+        }
+
+        return uHash;
+    }
+}
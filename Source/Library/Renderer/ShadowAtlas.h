@@ -0,0 +1,134 @@
+﻿/*+===================================================================
+  File:      SHADOWATLAS.H
+
+  Summary:   ShadowAtlas header file contains declarations of the
+             ShadowStatistics type and the ShadowAtlas class that
+             keeps track of the cached static caster layer of the
+             shadow maps.
+
+  Classes: ShadowAtlas
+
+  © 2022 Kyung Hee University
+===================================================================+*/
+#pragma once
+
+#include "Common.h"
+
+namespace library
+{
+    /*S+S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S
+      Struct:   ShadowStatistics
+
+      Summary:  Counters of the shadow maps of a frame. Static draws
+                are those that refreshed the cached static casters,
+                saved ones those a slice would have drawn again without
+                the cache, counted apart for the cascades and the cube
+                faces. Copies bring the static casters of a slice
+                into its shadow map before the dynamic casters are
+                drawn on top
+    S---S---S---S---S---S---S---S---S---S---S---S---S---S---S---S---S-S*/
+    struct ShadowStatistics
+    {
+        UINT uNumSlices;
+        UINT uNumStaticRedraws;
+        UINT uNumStaticDraws;
+        UINT uNumDynamicDraws;
+        UINT uNumCascadeDrawsSaved;
+        UINT uNumCubeDrawsSaved;
+        UINT uNumCopies;
+    };
+
+    /*C+C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C
+      Class:    ShadowAtlas
+
+      Summary:  Bookkeeping of the slices of the shadow maps, cascades
+                and cube faces alike. Every slice has a static layer,
+                the casters that do not move drawn on their own, and the
+                shadow map itself, the static layer with the dynamic
+                casters on top. The static layer is only drawn again
+                when its key changes, i.e. when the view projection of
+                the slice or one of the static casters did. The shadow
+                map only needs the static layer copied back when the
+                layer was redrawn or dynamic casters were drawn over it.
+                The cascades come first. Their view projections follow
+                the camera, so their static layers are only reused while
+                the camera keeps within a texel, the cube faces whenever
+                their light stands still. Holds no texture, the renderer
+                owns them
+
+      Methods:  Initialize
+                  Sets the number of slices and invalidates them
+                BeginFrame
+                  Zeroes the statistics
+                BeginSlice
+                  Tells whether the static layer of a slice is stale
+                SetStatic
+                  Records a redrawn static layer
+                NeedsCopy
+                  Tells whether the shadow map differs from its static
+                  layer
+                SetDynamic
+                  Records what was drawn over the static layer
+                Invalidate
+                  Forgets every static layer
+                GetNumSlices
+                  Returns the number of slices
+                GetStatistics
+                  Returns the counters of the frame
+                ComputeKey
+                  Computes the key of a static layer
+                Hash
+                  Hashes bytes with FNV-1a
+                ShadowAtlas
+                  Constructor.
+                ~ShadowAtlas
+                  Destructor.
+    C---C---C---C---C---C---C---C---C---C---C---C---C---C---C---C---C-C*/
+    class ShadowAtlas final
+    {
+    public:
+        static constexpr UINT64 HASH_OFFSET_BASIS = 14695981039346656037ull;
+
+    public:
+        ShadowAtlas();
+        ShadowAtlas(const ShadowAtlas& other) = default;
+        ShadowAtlas(ShadowAtlas&& other) = default;
+        ShadowAtlas& operator=(const ShadowAtlas& other) = default;
+        ShadowAtlas& operator=(ShadowAtlas&& other) = default;
+        ~ShadowAtlas() = default;
+
+        void Initialize(_In_ UINT uNumSlices, _In_ UINT uNumCascades);
+        void BeginFrame();
+        BOOL BeginSlice(_In_ UINT uSlice, _In_ UINT64 uStaticKey);
+        void SetStatic(_In_ UINT uSlice, _In_ UINT64 uStaticKey, _In_ UINT uNumDraws);
+        BOOL NeedsCopy(_In_ UINT uSlice) const;
+        void SetDynamic(_In_ UINT uSlice, _In_ BOOL bCopied, _In_ UINT uNumDraws);
+        void Invalidate();
+
+        UINT GetNumSlices() const;
+        const ShadowStatistics& GetStatistics() const;
+
+        static UINT64 ComputeKey(_In_reads_(16) const FLOAT* aViewProjection, _In_ UINT64 uStaticRevision);
+        static UINT64 Hash(_In_reads_bytes_(uSize) const void* pData, _In_ size_t uSize, _In_ UINT64 uHash);
+
+    private:
+        /*S+S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S
+          Struct:   Slice
+
+          Summary:  Key and draw count of the static layer of a slice,
+                    and whether the shadow map still holds nothing but
+                    that layer
+        S---S---S---S---S---S---S---S---S---S---S---S---S---S---S---S---S-S*/
+        struct Slice
+        {
+            UINT64 uStaticKey;
+            UINT uNumStaticDraws;
+            BOOL bStaticValid;
+            BOOL bMatchesStatic;
+        };
+
+        std::vector<Slice> m_aSlices;
+        UINT m_uNumCascades;
+        ShadowStatistics m_statistics;
+    };
+}
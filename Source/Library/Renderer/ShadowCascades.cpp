@@ -0,0 +1,330 @@
+#include "Renderer/ShadowCascades.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace library
+{
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   ShadowCascades::ShadowCascades
+      Summary:  Constructor. There is no cascade until the projection
+                is set
+      Modifies: [m_uNumCascades, m_uResolution, m_casterDistance,
+                  m_aSplits, m_aCenterDepths, m_aRadii, m_aView,
+                  m_aProjections, m_aViewProjections].
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    ShadowCascades::ShadowCascades()
+        : m_uNumCascades(0u)
+        , m_uResolution(1u)
+        , m_casterDistance(0.0f)
+        , m_aSplits()
+        , m_aCenterDepths()
+        , m_aRadii()
+        , m_aView()
+        , m_aProjections()
+        , m_aViewProjections()
+    {
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   ShadowCascades::SetProjection
+      Summary:  Splits the view frustum of a perspective projection
+                looking down +z into cascades and finds the bounding
+                sphere of every slice. The center of a sphere lies on
+                the view axis where it is as far from the near corners
+                of the slice as from the far ones, or on the far plane
+                when the slice is wider than it is deep
+      Args:     FLOAT tanHalfFovX
+                  Tangent of half the horizontal field of view
+                FLOAT tanHalfFovY
+                  Tangent of half the vertical field of view
+                FLOAT nearZ
+                  Distance to the near plane
+                FLOAT shadowDistance
+                  View depth where the last cascade ends
+                FLOAT splitLambda
+                  Weight of the logarithmic split, 0 splits uniformly
+                UINT uNumCascades
+                  Number of cascades, at most MAX_CASCADES
+                UINT uResolution
+                  Width and height of a cascade in texels
+                FLOAT casterDistance
+                  Distance in front of a cascade towards the light that
+                  still casts shadows into it
+      Modifies: [m_uNumCascades, m_uResolution, m_casterDistance,
+                  m_aSplits, m_aCenterDepths, m_aRadii].
+      Returns:  HRESULT
+                  Status code
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    HRESULT ShadowCascades::SetProjection(_In_ FLOAT tanHalfFovX, _In_ FLOAT tanHalfFovY, _In_ FLOAT nearZ, _In_ FLOAT shadowDistance, _In_ FLOAT splitLambda,
+        _In_ UINT uNumCascades, _In_ UINT uResolution, _In_ FLOAT casterDistance)
+    {
+        if (!(tanHalfFovX > 0.0f) || !(tanHalfFovY > 0.0f) || !(nearZ > 0.0f) || !(shadowDistance > nearZ) || !(splitLambda >= 0.0f) || !(splitLambda <= 1.0f)
+            || uNumCascades == 0u || uNumCascades > MAX_CASCADES || uResolution == 0u || !(casterDistance >= 0.0f))
+        {
+            return E_INVALIDARG;
+        }
+
+        m_uNumCascades = uNumCascades;
+        m_uResolution = uResolution;
+        m_casterDistance = casterDistance;
+
+        ComputeSplits(nearZ, shadowDistance, splitLambda, uNumCascades, m_aSplits);
+
+        const FLOAT sqrTanHalfFov = tanHalfFovX * tanHalfFovX + tanHalfFovY * tanHalfFovY;
+        for (UINT i = 0u; i < uNumCascades; ++i)
+        {
+            const FLOAT sliceNear = (i == 0u) ? nearZ : m_aSplits[i - 1u];
+            const FLOAT sliceFar = m_aSplits[i];
+
+            const FLOAT centerDepth = std::min(0.5f * (sliceNear + sliceFar) * (1.0f + sqrTanHalfFov), sliceFar);
+            m_aCenterDepths[i] = centerDepth;
+            m_aRadii[i] = std::sqrt(sliceFar * sliceFar * sqrTanHalfFov + (sliceFar - centerDepth) * (sliceFar - centerDepth));
+        }
+
+        return S_OK;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   ShadowCascades::ComputeSplits
+      Summary:  Computes where the splits of a view depth range end,
+                blending the logarithmic split, that keeps the texel
+                density even, with the uniform one, that keeps the near
+                cascades from becoming tiny
+      Args:     FLOAT nearZ
+                  View depth where the first split starts
+                FLOAT farZ
+                  View depth where the last split ends
+                FLOAT splitLambda
+                  Weight of the logarithmic split, 0 splits uniformly
+                UINT uNumSplits
+                  Number of splits
+                FLOAT* aSplits
+                  Receives the far view depth of every split, the last
+                  one is farZ
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    void ShadowCascades::ComputeSplits(_In_ FLOAT nearZ, _In_ FLOAT farZ, _In_ FLOAT splitLambda, _In_ UINT uNumSplits, _Out_writes_(uNumSplits) FLOAT* aSplits)
+    {
+        for (UINT i = 1u; i <= uNumSplits; ++i)
+        {
+            const FLOAT fraction = static_cast<FLOAT>(i) / static_cast<FLOAT>(uNumSplits);
+            const FLOAT logSplit = nearZ * std::pow(farZ / nearZ, fraction);
+            const FLOAT uniformSplit = nearZ + (farZ - nearZ) * fraction;
+            aSplits[i - 1u] = splitLambda * logSplit + (1.0f - splitLambda) * uniformSplit;
+        }
+
+        // Exact at the end, the last cascade has to reach the shadow distance
+        aSplits[uNumSplits - 1u] = farZ;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   ShadowCascades::Update
+      Summary:  Fits the cascades around the camera. The light view
+                only rotates, so a translation of the camera moves the
+                centers in light space by exactly what it moves them in
+                the world, and the centers are snapped to whole texels
+                before the projections are built
+      Args:     const FLOAT* aCameraWorld
+                  World matrix of the camera, the inverse of its view
+                  matrix
+                const FLOAT* aLightDirection
+                  Direction the light shines towards
+      Modifies: [m_aView, m_aProjections, m_aViewProjections].
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    void ShadowCascades::Update(_In_reads_(16) const FLOAT* aCameraWorld, _In_reads_(3) const FLOAT* aLightDirection)
+    {
+        FLOAT aZAxis[3] = { aLightDirection[0], aLightDirection[1], aLightDirection[2] };
+        const FLOAT directionLength = std::sqrt(aZAxis[0] * aZAxis[0] + aZAxis[1] * aZAxis[1] + aZAxis[2] * aZAxis[2]);
+        if (!(directionLength > 1e-6f))
+        {
+            aZAxis[0] = 0.0f;
+            aZAxis[1] = -1.0f;
+            aZAxis[2] = 0.0f;
+        }
+        else
+        {
+            aZAxis[0] /= directionLength;
+            aZAxis[1] /= directionLength;
+            aZAxis[2] /= directionLength;
+        }
+
+        // The up vector falls back to +z when the light shines straight up or down
+        const FLOAT aUp[3] = { 0.0f, (std::fabs(aZAxis[1]) > 0.99f) ? 0.0f : 1.0f, (std::fabs(aZAxis[1]) > 0.99f) ? 1.0f : 0.0f };
+        FLOAT aXAxis[3] =
+        {
+            aUp[1] * aZAxis[2] - aUp[2] * aZAxis[1],
+            aUp[2] * aZAxis[0] - aUp[0] * aZAxis[2],
+            aUp[0] * aZAxis[1] - aUp[1] * aZAxis[0],
+        };
+        const FLOAT xLength = std::sqrt(aXAxis[0] * aXAxis[0] + aXAxis[1] * aXAxis[1] + aXAxis[2] * aXAxis[2]);
+        aXAxis[0] /= xLength;
+        aXAxis[1] /= xLength;
+        aXAxis[2] /= xLength;
+        const FLOAT aYAxis[3] =
+        {
+            aZAxis[1] * aXAxis[2] - aZAxis[2] * aXAxis[1],
+            aZAxis[2] * aXAxis[0] - aZAxis[0] * aXAxis[2],
+            aZAxis[0] * aXAxis[1] - aZAxis[1] * aXAxis[0],
+        };
+
+        // Looks along the light from the origin
+        std::fill(m_aView, m_aView + 16, 0.0f);
+        for (UINT uRow = 0u; uRow < 3u; ++uRow)
+        {
+            m_aView[uRow * 4u + 0u] = aXAxis[uRow];
+            m_aView[uRow * 4u + 1u] = aYAxis[uRow];
+            m_aView[uRow * 4u + 2u] = aZAxis[uRow];
+        }
+        m_aView[15] = 1.0f;
+
+        const FLOAT* aForward = aCameraWorld + 8;
+        const FLOAT* aPosition = aCameraWorld + 12;
+        for (UINT i = 0u; i < m_uNumCascades; ++i)
+        {
+            const FLOAT radius = m_aRadii[i];
+            const FLOAT aCenter[3] =
+            {
+                aPosition[0] + aForward[0] * m_aCenterDepths[i],
+                aPosition[1] + aForward[1] * m_aCenterDepths[i],
+                aPosition[2] + aForward[2] * m_aCenterDepths[i],
+            };
+
+            const FLOAT texelSize = 2.0f * radius / static_cast<FLOAT>(m_uResolution);
+            FLOAT aLightCenter[3];
+            for (UINT uAxis = 0u; uAxis < 3u; ++uAxis)
+            {
+                const FLOAT lightCoordinate = aCenter[0] * m_aView[uAxis] + aCenter[1] * m_aView[4u + uAxis] + aCenter[2] * m_aView[8u + uAxis];
+                aLightCenter[uAxis] = std::floor(lightCoordinate / texelSize) * texelSize;
+            }
+
+            const FLOAT left = aLightCenter[0] - radius;
+            const FLOAT right = aLightCenter[0] + radius;
+            const FLOAT bottom = aLightCenter[1] - radius;
+            const FLOAT top = aLightCenter[1] + radius;
+            const FLOAT nearZ = aLightCenter[2] - radius - m_casterDistance;
+            const FLOAT farZ = aLightCenter[2] + radius;
+
+            // Off center orthographic projection, depth from 0 at the near plane to 1 at the far plane
+            FLOAT* aProjection = m_aProjections[i];
+            std::fill(aProjection, aProjection + 16, 0.0f);
+            aProjection[0] = 2.0f / (right - left);
+            aProjection[5] = 2.0f / (top - bottom);
+            aProjection[10] = 1.0f / (farZ - nearZ);
+            aProjection[12] = (left + right) / (left - right);
+            aProjection[13] = (top + bottom) / (bottom - top);
+            aProjection[14] = nearZ / (nearZ - farZ);
+            aProjection[15] = 1.0f;
+
+            multiply(m_aView, aProjection, m_aViewProjections[i]);
+        }
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   ShadowCascades::GetNumCascades
+      Summary:  Returns the number of cascades
+      Returns:  UINT
+                  Number of cascades
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    UINT ShadowCascades::GetNumCascades() const
+    {
+        return m_uNumCascades;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   ShadowCascades::GetSplit
+      Summary:  Returns the view depth where a cascade ends
+      Args:     UINT uCascade
+                  Index of the cascade
+      Returns:  FLOAT
+                  Far view depth of the cascade
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    FLOAT ShadowCascades::GetSplit(_In_ UINT uCascade) const
+    {
+        assert(uCascade < m_uNumCascades);
+
+        return m_aSplits[uCascade];
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   ShadowCascades::GetRadius
+      Summary:  Returns the radius of the bounding sphere of a cascade,
+                half the width it covers
+      Args:     UINT uCascade
+                  Index of the cascade
+      Returns:  FLOAT
+                  Radius of the cascade
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    FLOAT ShadowCascades::GetRadius(_In_ UINT uCascade) const
+    {
+        assert(uCascade < m_uNumCascades);
+
+        return m_aRadii[uCascade];
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   ShadowCascades::GetView
+      Summary:  Returns the view matrix of the light, shared by every
+                cascade
+      Returns:  const FLOAT*
+                  16 floats, row major
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    const FLOAT* ShadowCascades::GetView() const
+    {
+        return m_aView;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   ShadowCascades::GetProjection
+      Summary:  Returns the orthographic projection of a cascade
+      Args:     UINT uCascade
+                  Index of the cascade
+      Returns:  const FLOAT*
+                  16 floats, row major
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    const FLOAT* ShadowCascades::GetProjection(_In_ UINT uCascade) const
+    {
+        assert(uCascade < m_uNumCascades);
+
+        return m_aProjections[uCascade];
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   ShadowCascades::GetViewProjection
+      Summary:  Returns the view projection matrix of a cascade
+      Args:     UINT uCascade
+                  Index of the cascade
+      Returns:  const FLOAT*
+                  16 floats, row major
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    const FLOAT* ShadowCascades::GetViewProjection(_In_ UINT uCascade) const
+    {
+        assert(uCascade < m_uNumCascades);
+
+        return m_aViewProjections[uCascade];
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   ShadowCascades::multiply
+      Summary:  Multiplies two row major matrices
+      Args:     const FLOAT* aLeft
+                  Matrix applied first
+                const FLOAT* aRight
+                  Matrix applied second
+                FLOAT* aResult
+                  Receives aLeft * aRight
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    void ShadowCascades::multiply(_In_reads_(16) const FLOAT* aLeft, _In_reads_(16) const FLOAT* aRight, _Out_writes_(16) FLOAT* aResult)
+    {
+        for (UINT uRow = 0u; uRow < 4u; ++uRow)
+        {
+            for (UINT uColumn = 0u; uColumn < 4u; ++uColumn)
+            {
+                aResult[uRow * 4u + uColumn] =
+                    aLeft[uRow * 4u + 0u] * aRight[0u * 4u + uColumn] +
+                    aLeft[uRow * 4u + 1u] * aRight[1u * 4u + uColumn] +
+                    aLeft[uRow * 4u + 2u] * aRight[2u * 4u + uColumn] +
+                    aLeft[uRow * 4u + 3u] * aRight[3u * 4u + uColumn];
+            }
+        }
+    }
+}
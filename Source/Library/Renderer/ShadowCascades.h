@@ -0,0 +1,97 @@
+﻿/*+===================================================================
+  File:      SHADOWCASCADES.H
+
+  Summary:   ShadowCascades header file contains declarations of the
+             ShadowCascades class that splits the view frustum into
+             cascades and fits a stable orthographic shadow projection
+             around each of them.
+
+  Classes: ShadowCascades
+
+  © 2022 Kyung Hee University
+===================================================================+*/
+#pragma once
+
+#include "Common.h"
+
+namespace library
+{
+    /*C+C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C
+      Class:    ShadowCascades
+
+      Summary:  Cascaded shadow map layout of a perspective camera lit
+                by a directional light. The view depth up to the shadow
+                distance is split between a logarithmic and a uniform
+                distribution, each slice of the frustum is enclosed in
+                a bounding sphere and the cascade is the light space
+                square around that sphere. The size of a sphere only
+                depends on the projection and its center is snapped to
+                the texels of the cascade, so the shadows neither
+                shimmer when the camera turns or moves, nor change at
+                all while it stays within a texel. Matrices are row
+                major and transform row vectors, the layout of
+                XMFLOAT4X4
+
+      Methods:  SetProjection
+                  Sets the camera projection and the cascade layout
+                ComputeSplits
+                  Computes the far distance of every split
+                Update
+                  Fits the cascades around the camera
+                GetNumCascades
+                  Returns the number of cascades
+                GetSplit
+                  Returns the far view depth of a cascade
+                GetRadius
+                  Returns the radius of the sphere of a cascade
+                GetView
+                  Returns the view matrix of the light
+                GetProjection
+                  Returns the projection matrix of a cascade
+                GetViewProjection
+                  Returns the view projection matrix of a cascade
+                ShadowCascades
+                  Constructor.
+                ~ShadowCascades
+                  Destructor.
+    C---C---C---C---C---C---C---C---C---C---C---C---C---C---C---C---C-C*/
+    class ShadowCascades final
+    {
+    public:
+        static constexpr UINT MAX_CASCADES = 4u;
+
+    public:
+        ShadowCascades();
+        ShadowCascades(const ShadowCascades& other) = default;
+        ShadowCascades(ShadowCascades&& other) = default;
+        ShadowCascades& operator=(const ShadowCascades& other) = default;
+        ShadowCascades& operator=(ShadowCascades&& other) = default;
+        ~ShadowCascades() = default;
+
+        HRESULT SetProjection(_In_ FLOAT tanHalfFovX, _In_ FLOAT tanHalfFovY, _In_ FLOAT nearZ, _In_ FLOAT shadowDistance, _In_ FLOAT splitLambda,
+            _In_ UINT uNumCascades, _In_ UINT uResolution, _In_ FLOAT casterDistance);
+        static void ComputeSplits(_In_ FLOAT nearZ, _In_ FLOAT farZ, _In_ FLOAT splitLambda, _In_ UINT uNumSplits, _Out_writes_(uNumSplits) FLOAT* aSplits);
+
+        void Update(_In_reads_(16) const FLOAT* aCameraWorld, _In_reads_(3) const FLOAT* aLightDirection);
+
+        UINT GetNumCascades() const;
+        FLOAT GetSplit(_In_ UINT uCascade) const;
+        FLOAT GetRadius(_In_ UINT uCascade) const;
+        const FLOAT* GetView() const;
+        const FLOAT* GetProjection(_In_ UINT uCascade) const;
+        const FLOAT* GetViewProjection(_In_ UINT uCascade) const;
+
+    private:
+        static void multiply(_In_reads_(16) const FLOAT* aLeft, _In_reads_(16) const FLOAT* aRight, _Out_writes_(16) FLOAT* aResult);
+
+        UINT m_uNumCascades;
+        UINT m_uResolution;
+        FLOAT m_casterDistance;
+        FLOAT m_aSplits[MAX_CASCADES];
+        FLOAT m_aCenterDepths[MAX_CASCADES];
+        FLOAT m_aRadii[MAX_CASCADES];
+        FLOAT m_aView[16];
+        FLOAT m_aProjections[MAX_CASCADES][16];
+        FLOAT m_aViewProjections[MAX_CASCADES][16];
+    };
+}
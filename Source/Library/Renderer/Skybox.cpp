@@ -1,5 +1,7 @@
 #include "Renderer/Skybox.h"
 
+#include "Texture/TextureCache.h"
+
 #include "assimp/Importer.hpp"	// C++ importer interface
 #include "assimp/scene.h"		// output data structure
 #include "assimp/postprocess.h"	// post processing flags
@@ -53,7 +55,7 @@ namespace library
         m_aMeshes[0].uMaterialIndex = 0;
 
         // Set and initialize the first (0th) materials diffuse texture by the m_cubeMapFileName
-        m_aMaterials[0]->pDiffuse = std::make_shared<Texture>(m_cubeMapFileName);
+        m_aMaterials[0]->pDiffuse = TextureCache::GetGlobal().Acquire(m_cubeMapFileName);
 
         hr = m_aMaterials[0]->Initialize(pDevice, pImmediateContext);
         if (FAILED(hr)) 
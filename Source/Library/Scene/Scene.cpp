@@ -1,5 +1,9 @@
 #include "Scene/Scene.h"
 
+#include <algorithm>
+
+#include "Job/JobSystem.h"
+#include "Profiler/CpuProfiler.h"
 #include "Shader/SkyMapVertexShader.h"
 
 namespace library
@@ -28,11 +32,15 @@ namespace library
         : m_filePath(filePath)
         , m_voxels()
         , m_renderables()
-        , m_aPointLights{ nullptr }
+        , m_aPointLights()
         , m_vertexShaders()
         , m_pixelShaders()
         , m_skyBox()
+        , m_shadowDirection()
+        , m_bHasShadowDirection(FALSE)
     {
+        PROFILE_SCOPE("Build voxels");
+
         std::ifstream inputFile;
         inputFile.open(m_filePath.string());
 
@@ -81,15 +89,10 @@ namespace library
             }
         }
 
-        std::vector<std::vector<InstanceData>> aInstanceData;
-        aInstanceData.reserve(m_voxels.size());
-        for (UINT renderableIdx = 0u; renderableIdx < m_voxels.size(); ++renderableIdx)
-        {
-            aInstanceData.push_back(std::vector<InstanceData>());
-            aInstanceData.back().reserve(
-                static_cast<size_t>(aDimension[0]) * static_cast<size_t>(aDimension[1]) * static_cast<size_t>(aDimension[2])
-            );
-        }
+        // The file is read in order, the voxels of its columns are then
+        // built on the job system
+        std::vector<VoxelColumn> aColumns;
+        aColumns.reserve(static_cast<size_t>(aDimension[0]) * static_cast<size_t>(aDimension[2]));
 
         UINT uDepthIdx = 0u;
         UINT uWidthIdx = 0u;
@@ -110,16 +113,16 @@ namespace library
             }
             else if (static_cast<CHAR>(eBlockType::GRASSLAND) <= voxelType && voxelType < static_cast<CHAR>(eBlockType::COUNT))
             {
-                for (UINT heightIdx = 0; heightIdx < static_cast<UINT>(static_cast<float>(aDimension[1]) * height); ++heightIdx)
+                const UINT uType = static_cast<UINT>(voxelType) - static_cast<UINT>(eBlockType::GRASSLAND);
+                if (uType < m_voxels.size())
                 {
-                    aInstanceData[static_cast<size_t>(voxelType) - static_cast<size_t>(eBlockType::GRASSLAND)].push_back(
-                        InstanceData
+                    aColumns.push_back(
+                        VoxelColumn
                         {
-                            .Transformation = XMMatrixTranslation(
-                                2.0f * (static_cast<FLOAT>(uWidthIdx) - static_cast<FLOAT>(aDimension[0]) / 2.0f),
-                                2.0f * (static_cast<FLOAT>(heightIdx) - static_cast<FLOAT>(aDimension[1])) + (static_cast<FLOAT>(aDimension[1]) * 0.75f),
-                                2.0f * (static_cast<FLOAT>(uDepthIdx) - static_cast<FLOAT>(aDimension[2]) / 2.0f)
-                                )
+                            .uType = uType,
+                            .uWidthIdx = uWidthIdx,
+                            .uDepthIdx = uDepthIdx,
+                            .uHeight = static_cast<UINT>(static_cast<float>(aDimension[1]) * height),
                         }
                     );
                 }
@@ -139,6 +142,58 @@ namespace library
 
         inputFile.close();
 
+        // Each job fills its own lists, one per voxel, appended in the
+        // order of the jobs so the instances keep the order of the file
+        JobSystem& jobSystem = JobSystem::GetGlobal();
+        const size_t uNumVoxels = m_voxels.size();
+        const UINT uNumJobs = (static_cast<UINT>(aColumns.size()) + NUM_COLUMNS_PER_JOB - 1u) / NUM_COLUMNS_PER_JOB;
+        std::vector<std::vector<InstanceData>> aJobInstanceData(static_cast<size_t>(uNumJobs) * uNumVoxels);
+        jobSystem.ParallelFor(uNumJobs, 1u, [&aColumns, &aJobInstanceData, &aDimension, uNumVoxels](UINT uFirstJob, UINT uLastJob)
+            {
+                for (UINT uJob = uFirstJob; uJob < uLastJob; ++uJob)
+                {
+                    std::vector<InstanceData>* aJobData = &aJobInstanceData[static_cast<size_t>(uJob) * uNumVoxels];
+                    const size_t uLastColumn = std::min(static_cast<size_t>(uJob + 1u) * NUM_COLUMNS_PER_JOB, aColumns.size());
+                    for (size_t i = static_cast<size_t>(uJob) * NUM_COLUMNS_PER_JOB; i < uLastColumn; ++i)
+                    {
+                        const VoxelColumn& column = aColumns[i];
+                        for (UINT heightIdx = 0; heightIdx < column.uHeight; ++heightIdx)
+                        {
+                            aJobData[column.uType].push_back(
+                                InstanceData
+                                {
+                                    .Transformation = XMMatrixTranslation(
+                                        2.0f * (static_cast<FLOAT>(column.uWidthIdx) - static_cast<FLOAT>(aDimension[0]) / 2.0f),
+                                        2.0f * (static_cast<FLOAT>(heightIdx) - static_cast<FLOAT>(aDimension[1])) + (static_cast<FLOAT>(aDimension[1]) * 0.75f),
+                                        2.0f * (static_cast<FLOAT>(column.uDepthIdx) - static_cast<FLOAT>(aDimension[2]) / 2.0f)
+                                        )
+                                }
+                            );
+                        }
+                    }
+                }
+            });
+
+        std::vector<std::vector<InstanceData>> aInstanceData(uNumVoxels);
+        jobSystem.ParallelFor(static_cast<UINT>(uNumVoxels), 1u, [&aInstanceData, &aJobInstanceData, uNumVoxels, uNumJobs](UINT uFirstVoxel, UINT uLastVoxel)
+            {
+                for (UINT uVoxel = uFirstVoxel; uVoxel < uLastVoxel; ++uVoxel)
+                {
+                    size_t uNumInstances = 0u;
+                    for (UINT uJob = 0u; uJob < uNumJobs; ++uJob)
+                    {
+                        uNumInstances += aJobInstanceData[uJob * uNumVoxels + uVoxel].size();
+                    }
+
+                    aInstanceData[uVoxel].reserve(uNumInstances);
+                    for (UINT uJob = 0u; uJob < uNumJobs; ++uJob)
+                    {
+                        const std::vector<InstanceData>& aJobData = aJobInstanceData[uJob * uNumVoxels + uVoxel];
+                        aInstanceData[uVoxel].insert(aInstanceData[uVoxel].end(), aJobData.begin(), aJobData.end());
+                    }
+                }
+            });
+
         UINT uVoxelIdx = 0u;
         auto it = m_voxels.begin();
         while (it != m_voxels.end())
@@ -160,7 +215,12 @@ namespace library
       Method:   Scene::Initialize
 
       Summary:  Initializes the voxels, shaders, renderables, models,
-                and skybox
+                and skybox. The instances of a voxel are drawn with the
+                material of its index among the voxels. The voxels and
+                shaders only use the device, which is free threaded, and
+                initialize on the job system while this thread
+                initializes the rest, which uses the immediate context
+                and the importer the models share
 
       Args:     ID3D11Device* pDevice
                   The Direct3D device to create the buffers
@@ -170,36 +230,82 @@ namespace library
 
     HRESULT Scene::Initialize(_In_ ID3D11Device* pDevice, _In_ ID3D11DeviceContext* pImmediateContext)
     {
-        for (auto voxel : m_voxels)
+        PROFILE_SCOPE("Initialize scene");
+
+        JobSystem& jobSystem = JobSystem::GetGlobal();
+        JobCounter counter;
+
+        std::vector<HRESULT> aVoxelResults(m_voxels.size(), S_OK);
+        for (UINT i = 0u; i < m_voxels.size(); ++i)
         {
-            HRESULT hr = voxel->Initialize(pDevice, pImmediateContext);
-            if (FAILED(hr))
-            {
-                return hr;
-            }
+            m_voxels[i]->SetMaterialIndex(i);
+            jobSystem.Run([this, pDevice, pImmediateContext, &aVoxelResults, i]()
+                {
+                    aVoxelResults[i] = m_voxels[i]->Initialize(pDevice, pImmediateContext);
+                }, &counter);
         }
 
+        // Shaders compile or load from the shader cache in parallel
+        std::vector<Shader*> apShaders;
+        apShaders.reserve(m_vertexShaders.size() + m_pixelShaders.size());
         for (auto it = m_vertexShaders.begin(); it != m_vertexShaders.end(); ++it)
         {
-            HRESULT hr = it->second->Initialize(pDevice);
-            if (FAILED(hr))
+            apShaders.push_back(it->second.get());
+        }
+        for (auto it = m_pixelShaders.begin(); it != m_pixelShaders.end(); ++it)
+        {
+            apShaders.push_back(it->second.get());
+        }
+
+        HRESULT shaderResult = S_OK;
+        jobSystem.Run([pDevice, &apShaders, &shaderResult]()
             {
-                return hr;
-            }
+                shaderResult = Shader::InitializeShaders(pDevice, apShaders);
+            }, &counter);
+
+        // The jobs write to the locals above, they must finish before
+        // any return
+        HRESULT hr = initializeOnThisThread(pDevice, pImmediateContext);
+        jobSystem.Wait(counter);
+        if (FAILED(hr))
+        {
+            return hr;
         }
 
-        for (auto it = m_pixelShaders.begin(); it != m_pixelShaders.end(); ++it)
+        for (HRESULT voxelResult : aVoxelResults)
         {
-            HRESULT hr = it->second->Initialize(pDevice);
-            if (FAILED(hr))
+            if (FAILED(voxelResult))
             {
-                return hr;
+                return voxelResult;
             }
         }
 
+        return shaderResult;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   Scene::initializeOnThisThread
+
+      Summary:  Initializes the renderables, models, their materials
+                and the skybox on the calling thread
+
+      Args:     ID3D11Device* pDevice
+                  The Direct3D device to create the buffers
+                ID3D11DeviceContext* pImmediateContext
+                  The Direct3D context to set buffers
+
+      Modifies: [m_renderables, m_models, m_materials, m_skyBox].
+
+      Returns:  HRESULT
+                  Status code
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    HRESULT Scene::initializeOnThisThread(_In_ ID3D11Device* pDevice, _In_ ID3D11DeviceContext* pImmediateContext)
+    {
+        HRESULT hr = S_OK;
+
         for (auto it = m_renderables.begin(); it != m_renderables.end(); ++it)
         {
-            HRESULT hr = it->second->Initialize(pDevice, pImmediateContext);
+            hr = it->second->Initialize(pDevice, pImmediateContext);
             if (FAILED(hr))
             {
                 return hr;
@@ -208,7 +314,7 @@ namespace library
 
         for (auto it = m_models.begin(); it != m_models.end(); ++it)
         {
-            HRESULT hr = it->second->Initialize(pDevice, pImmediateContext);
+            hr = it->second->Initialize(pDevice, pImmediateContext);
             if (FAILED(hr))
             {
                 return hr;
@@ -222,7 +328,7 @@ namespace library
 
         for (auto it = m_materials.begin(); it != m_materials.end(); ++it)
         {
-            HRESULT hr = it->second->Initialize(pDevice, pImmediateContext);
+            hr = it->second->Initialize(pDevice, pImmediateContext);
             if (FAILED(hr))
             {
                 return hr;
@@ -231,7 +337,7 @@ namespace library
 
         if (m_skyBox)
         {
-            HRESULT hr = m_skyBox->Initialize(pDevice, pImmediateContext);
+            hr = m_skyBox->Initialize(pDevice, pImmediateContext);
             if (FAILED(hr))
             {
                 return hr;
@@ -317,7 +423,8 @@ namespace library
     /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
       Method:   Scene::AddPointLight
 
-      Summary:  Add a point light object
+      Summary:  Add a point light object. Slots below the index that
+                were never filled stay empty
 
       Args:     size_t index
                   Index of the point light
@@ -333,11 +440,15 @@ namespace library
     {
         HRESULT hr = S_OK;
 
-        if (index >= NUM_LIGHTS)
+        if (index >= MAX_NUM_LIGHTS)
         {
             return E_FAIL;
         }
 
+        if (index >= m_aPointLights.size())
+        {
+            m_aPointLights.resize(index + 1u);
+        }
         m_aPointLights[index] = pPointLight;
 
         return hr;
@@ -441,7 +552,10 @@ namespace library
       Method:   Scene::Update
 
       Summary:  Update the renderables, models, point lights, skybox
-                each frame
+                each frame. The models and the point lights update on
+                the job system, each on its own. The renderables update
+                on the calling thread meanwhile, their Update belongs
+                to the game and may share state between instances
 
       Args:     FLOAT deltaTime
                   Time difference of a frame
@@ -449,23 +563,69 @@ namespace library
 
     void Scene::Update(_In_ FLOAT deltaTime)
     {
+        PROFILE_SCOPE("Update scene");
+
+        JobSystem& jobSystem = JobSystem::GetGlobal();
+        JobCounter counter;
+
+        for (auto it = m_models.begin(); it != m_models.end(); ++it)
+        {
+            Model* pModel = it->second.get();
+            jobSystem.Run([pModel, deltaTime]()
+                {
+                    pModel->Update(deltaTime);
+                }, &counter);
+        }
+
+        jobSystem.Run([this, deltaTime]()
+            {
+                for (const std::shared_ptr<PointLight>& pointLight : m_aPointLights)
+                {
+                    if (pointLight)
+                    {
+                        pointLight->Update(deltaTime);
+                    }
+                }
+            }, &counter);
+
         for (auto it = m_renderables.begin(); it != m_renderables.end(); ++it)
         {
             it->second->Update(deltaTime);
         }
 
-        for (auto it = m_models.begin(); it != m_models.end(); ++it)
+        if (m_skyBox)
+            m_skyBox->Update(deltaTime);
+
+        jobSystem.Wait(counter);
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   Scene::SaveState
+
+      Summary:  Keeps the world matrices of the renderables, voxels,
+                models and skybox before a simulation step, for the
+                rendered frames to blend from
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+
+    void Scene::SaveState()
+    {
+        for (auto it = m_renderables.begin(); it != m_renderables.end(); ++it)
         {
-            it->second->Update(deltaTime);
+            it->second->SaveState();
+        }
+
+        for (const std::shared_ptr<Voxel>& voxel : m_voxels)
+        {
+            voxel->SaveState();
         }
 
-        for (UINT lightIdx = 0; lightIdx < NUM_LIGHTS; ++lightIdx)
+        for (auto it = m_models.begin(); it != m_models.end(); ++it)
         {
-            m_aPointLights[lightIdx]->Update(deltaTime);
+            it->second->SaveState();
         }
 
         if (m_skyBox)
-            m_skyBox->Update(deltaTime);
+            m_skyBox->SaveState();
     }
 
     /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
@@ -521,11 +681,25 @@ namespace library
     M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
     std::shared_ptr<PointLight>& Scene::GetPointLight(_In_ size_t index)
     {
-        assert(index < NUM_LIGHTS);
+        assert(index < m_aPointLights.size());
 
         return m_aPointLights[index];
     }
 
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   Scene::GetNumPointLights
+
+      Summary:  Returns the number of point light slots, empty ones
+                included
+
+      Returns:  size_t
+                  Number of point lights
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    size_t Scene::GetNumPointLights() const
+    {
+        return m_aPointLights.size();
+    }
+
     /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
       Method:   Scene::GetVertexShaders
 
@@ -571,6 +745,63 @@ namespace library
         return m_skyBox;
     }
 
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   Scene::SetShadowDirection
+
+      Summary:  Sets the direction the light casting the shadow
+                cascades shines along, as a sun would
+
+      Args:     const XMFLOAT3& direction
+                  Direction of the light, not necessarily normalized
+
+      Modifies: [m_shadowDirection, m_bHasShadowDirection].
+
+      Returns:  HRESULT
+                  Status code, E_INVALIDARG if the direction is zero
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+
+    HRESULT Scene::SetShadowDirection(_In_ const XMFLOAT3& direction)
+    {
+        const XMVECTOR lengthSquared = XMVector3LengthSq(XMLoadFloat3(&direction));
+        if (XMVectorGetX(lengthSquared) < 1.0e-12f)
+        {
+            return E_INVALIDARG;
+        }
+
+        XMStoreFloat3(&m_shadowDirection, XMVector3Normalize(XMLoadFloat3(&direction)));
+        m_bHasShadowDirection = TRUE;
+
+        return S_OK;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   Scene::HasShadowDirection
+
+      Summary:  Returns whether the shadow direction was set
+
+      Returns:  BOOL
+                  TRUE if SetShadowDirection succeeded once
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+
+    BOOL Scene::HasShadowDirection() const
+    {
+        return m_bHasShadowDirection;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   Scene::GetShadowDirection
+
+      Summary:  Returns the direction the cascade light shines along
+
+      Returns:  const XMFLOAT3&
+                  Normalized direction, zero until set
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+
+    const XMFLOAT3& Scene::GetShadowDirection() const
+    {
+        return m_shadowDirection;
+    }
+
     /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
       Method:   Scene::GetFilePath
 
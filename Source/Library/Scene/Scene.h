@@ -45,17 +45,22 @@ namespace library
         HRESULT AddPixelShader(_In_ PCWSTR pszPixelShaderName, _In_ const std::shared_ptr<PixelShader>& pixelShader);
         HRESULT AddSkyBox(_In_ const std::shared_ptr<Skybox>& skybox);
         HRESULT AddMaterial(_In_ const std::shared_ptr<Material>& material);
+        HRESULT SetShadowDirection(_In_ const XMFLOAT3& direction);
 
         void Update(_In_ FLOAT deltaTime);
+        void SaveState();
 
         std::vector<std::shared_ptr<Voxel>>& GetVoxels();
         std::unordered_map<std::wstring, std::shared_ptr<Renderable>>& GetRenderables();
         std::unordered_map<std::wstring, std::shared_ptr<Model>>& GetModels();
         std::shared_ptr<PointLight>& GetPointLight(_In_ size_t index);
+        size_t GetNumPointLights() const;
         std::unordered_map<std::wstring, std::shared_ptr<VertexShader>>& GetVertexShaders();
         std::unordered_map<std::wstring, std::shared_ptr<PixelShader>>& GetPixelShaders();
         std::unordered_map<std::wstring, std::shared_ptr<Material>>& GetMaterials();
         std::shared_ptr<Skybox>& GetSkyBox();
+        BOOL HasShadowDirection() const;
+        const XMFLOAT3& GetShadowDirection() const;
 
         const std::filesystem::path& GetFilePath() const;
         PCWSTR GetFileName() const;
@@ -67,6 +72,21 @@ namespace library
         HRESULT SetVertexShaderOfVoxel(_In_ PCWSTR pszVertexShaderName);
         HRESULT SetPixelShaderOfVoxel(_In_ PCWSTR pszPixelShaderName);
 
+    private:
+        // Stack of voxels of the height map, its type, where it stands
+        // and how many voxels high it is
+        struct VoxelColumn
+        {
+            UINT uType;
+            UINT uWidthIdx;
+            UINT uDepthIdx;
+            UINT uHeight;
+        };
+
+        static constexpr UINT NUM_COLUMNS_PER_JOB = 256u;
+
+        HRESULT initializeOnThisThread(_In_ ID3D11Device* pDevice, _In_ ID3D11DeviceContext* pImmediateContext);
+
     private:
         static FLOAT getNoise2(UINT x, UINT y);
         static FLOAT getNoise2d(FLOAT x, FLOAT y);
@@ -95,10 +115,12 @@ namespace library
         std::vector<std::shared_ptr<Voxel>> m_voxels;
         std::unordered_map<std::wstring, std::shared_ptr<Renderable>> m_renderables;
         std::unordered_map<std::wstring, std::shared_ptr<Model>> m_models;
-        std::shared_ptr<PointLight> m_aPointLights[NUM_LIGHTS];
+        std::vector<std::shared_ptr<PointLight>> m_aPointLights;
         std::unordered_map<std::wstring, std::shared_ptr<VertexShader>> m_vertexShaders;
         std::unordered_map<std::wstring, std::shared_ptr<PixelShader>> m_pixelShaders;
         std::unordered_map<std::wstring, std::shared_ptr<Material>> m_materials;
         std::shared_ptr<Skybox> m_skyBox;
+        XMFLOAT3 m_shadowDirection;
+        BOOL m_bHasShadowDirection;
     };
 }
\ No newline at end of file
@@ -9,9 +9,11 @@ namespace library
      Summary:  Constructor
      Args:     const XMFLOAT4& outputColor
                  Color of the voxel
+     Modifies: [m_instanceBounds].
    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
     Voxel::Voxel(_In_ const XMFLOAT4& outputColor) :
-        InstancedRenderable(outputColor)
+        InstancedRenderable(outputColor),
+        m_instanceBounds()
     {
     }
 
@@ -22,19 +24,24 @@ namespace library
                   Instance data
                 const XMFLOAT4& outputColor
                   Color of the voxel
+      Modifies: [m_instanceBounds].
     M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
     Voxel::Voxel(_In_ std::vector<InstanceData>&& aInstanceData, _In_ const XMFLOAT4& outputColor) :
-        InstancedRenderable(std::move(aInstanceData), outputColor)
+        InstancedRenderable(std::move(aInstanceData), outputColor),
+        m_instanceBounds()
     {
     }
 
     /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
      Method:   Voxel::Initialize
-     Summary:  Initializes a voxel
+     Summary:  Initializes a voxel and computes the bounding box of
+               each instance, the bounding box of the voxel is the
+               union of them
      Args:     ID3D11Device* pDevice
                  The Direct3D device to create the buffers
                ID3D11DeviceContext* pImmediateContext
                  The Direct3D context to set buffers
+     Modifies: [m_aMeshes, m_instanceBounds, m_bounds].
      Returns:  HRESULT
                  Status code
    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
@@ -42,9 +49,22 @@ namespace library
     {
         BasicMeshEntry basicMeshEntry;
         basicMeshEntry.uNumIndices = NUM_INDICES;
+        basicMeshEntry.Bounds = FrustumCuller::ComputeBox(&VERTICES[0].Position.x, NUM_VERTICES, static_cast<UINT>(sizeof(SimpleVertex)));
 
         m_aMeshes.push_back(basicMeshEntry);
 
+        m_instanceBounds.Clear();
+        m_instanceBounds.Reserve(static_cast<UINT>(m_aInstanceData.size()));
+        for (const InstanceData& instanceData : m_aInstanceData)
+        {
+            XMFLOAT4X4 transformation;
+            XMStoreFloat4x4(&transformation, instanceData.Transformation);
+
+            const AxisAlignedBox instanceBox = FrustumCuller::TransformBox(basicMeshEntry.Bounds, &transformation._11);
+            m_bounds = (m_instanceBounds.GetNumBoxes() == 0u) ? instanceBox : FrustumCuller::MergeBoxes(m_bounds, instanceBox);
+            m_instanceBounds.Add(instanceBox);
+        }
+
 
         HRESULT hr = initialize(pDevice, pImmediateContext);
         if (FAILED(hr))
@@ -102,6 +122,18 @@ namespace library
         return NUM_INDICES;
     }
 
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   Voxel::GetInstanceBounds
+      Summary:  Returns the bounding boxes of the instances in the
+                object space of the voxel, in instance order
+      Returns:  const BoundingBoxArray&
+                  Bounding boxes of the instances
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    const BoundingBoxArray& Voxel::GetInstanceBounds() const
+    {
+        return m_instanceBounds;
+    }
+
     /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
       Method:   Voxel::getVertices
       Summary:  Returns the pointer to the vertices data
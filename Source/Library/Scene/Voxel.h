@@ -18,7 +18,9 @@ namespace library
     /*C+C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C
       Class:    Voxel
       Summary:  Base class for renderable 3d cube object
-      Methods:  Voxel
+      Methods:  GetInstanceBounds
+                  Returns the bounding boxes of the instances
+                Voxel
                   Constructor.
                 ~Voxel
                   Destructor.
@@ -40,6 +42,8 @@ namespace library
         UINT GetNumVertices() const override;
         UINT GetNumIndices() const override;
 
+        const BoundingBoxArray& GetInstanceBounds() const;
+
     protected:
         const SimpleVertex* getVertices() const override;
         const WORD* getIndices() const override;
@@ -98,5 +102,7 @@ namespace library
             23,20,22
         };
         static constexpr const UINT NUM_INDICES = 36u;
+
+        BoundingBoxArray m_instanceBounds;
     };
 }
\ No newline at end of file
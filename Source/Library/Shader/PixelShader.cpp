@@ -13,20 +13,24 @@ namespace library
                 PCSTR pszShaderModel
                   Specifies the shader target or set of shader features
                   to compile against
-      Modifies: [m_pixelShader].
+                UINT uFeatures
+                  Mask of the eShaderFeature the source compiles in or
+                  out
+      Modifies: [m_aPixelShaders].
     M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
 
-    PixelShader::PixelShader(_In_ PCWSTR pszFileName, _In_ PCSTR pszEntryPoint, _In_ PCSTR pszShaderModel)
-        : Shader(pszFileName, pszEntryPoint, pszShaderModel),
-        m_pixelShader(nullptr)
+    PixelShader::PixelShader(_In_ PCWSTR pszFileName, _In_ PCSTR pszEntryPoint, _In_ PCSTR pszShaderModel, _In_ UINT uFeatures)
+        : Shader(pszFileName, pszEntryPoint, pszShaderModel, uFeatures),
+        m_aPixelShaders()
     {
     }
 
     /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
       Method:   PixelShader::Initialize
-      Summary:  Initializes the pixel shader
+      Summary:  Initializes every permutation of the pixel shader
       Args:     ID3D11Device* pDevice
                   The Direct3D device to create the pixel shader
+      Modifies: [m_aPixelShaders].
       Returns:  HRESULT
                   Status code
     M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
@@ -35,19 +39,32 @@ namespace library
     {
         HRESULT hr = S_OK;
 
-        // Compile the pixel shader
-        ComPtr<ID3DBlob> pPSBlob;
-        hr = compile(pPSBlob.GetAddressOf());
-        if (FAILED(hr))
+        if (!pDevice)
         {
-            return hr;
+            return S_OK;
         }
 
-        // Create the pixel shader
-        hr = pDevice->CreatePixelShader(pPSBlob->GetBufferPointer(), pPSBlob->GetBufferSize(), nullptr, m_pixelShader.GetAddressOf());
-        if (FAILED(hr))
+        for (UINT uPermutation = 0u; uPermutation < MAX_NUM_PERMUTATIONS; ++uPermutation)
         {
-            return hr;
+            if (!hasPermutation(uPermutation))
+            {
+                continue;
+            }
+
+            // Compile the pixel shader
+            ComPtr<ID3DBlob> pPSBlob;
+            hr = compile(pPSBlob.GetAddressOf(), uPermutation);
+            if (FAILED(hr))
+            {
+                return hr;
+            }
+
+            // Create the pixel shader
+            hr = pDevice->CreatePixelShader(pPSBlob->GetBufferPointer(), pPSBlob->GetBufferSize(), nullptr, m_aPixelShaders[uPermutation].ReleaseAndGetAddressOf());
+            if (FAILED(hr))
+            {
+                return hr;
+            }
         }
 
         return S_OK;
@@ -55,13 +72,16 @@ namespace library
 
     /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
       Method:   PixelShader::GetPixelShader
-      Summary:  Returns the pixel shader
+      Summary:  Returns the permutation of the pixel shader drawing a
+                set of features
+      Args:     UINT uFeatures
+                  Mask of eShaderFeature of the object drawn
       Returns:  ComPtr<ID3D11PixelShader>&
                   Pixel shader. Could be a nullptr
     M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
 
-    ComPtr<ID3D11PixelShader>& PixelShader::GetPixelShader()
+    ComPtr<ID3D11PixelShader>& PixelShader::GetPixelShader(_In_ UINT uFeatures)
     {
-        return m_pixelShader;
+        return m_aPixelShaders[GetPermutation(uFeatures)];
     }
 }
\ No newline at end of file
@@ -18,9 +18,11 @@ namespace library
       Class:    PixelShader
       Summary:  Pixel shader
       Methods:  Initialize
-                  Initializes and compiles the pixel shader
+                  Initializes and compiles the permutations of the
+                  pixel shader
                 GetPixelShader
-                  Returns the reference to the D3D11 pixel shader
+                  Returns the reference to the D3D11 pixel shader of
+                  the permutation drawing a set of features
                 Game
                   Constructor.
                 ~Game
@@ -30,7 +32,7 @@ namespace library
     {
     public:
         PixelShader() = delete;
-        PixelShader(_In_ PCWSTR pszFileName, _In_ PCSTR pszEntryPoint, _In_ PCSTR pszShaderModel);
+        PixelShader(_In_ PCWSTR pszFileName, _In_ PCSTR pszEntryPoint, _In_ PCSTR pszShaderModel, _In_ UINT uFeatures = 0u);
         PixelShader(const PixelShader& other) = delete;
         PixelShader(PixelShader&& other) = delete;
         PixelShader& operator=(const PixelShader& other) = delete;
@@ -39,9 +41,9 @@ namespace library
 
         virtual HRESULT Initialize(_In_ ID3D11Device* pDevice) override;
 
-        ComPtr<ID3D11PixelShader>& GetPixelShader();
+        ComPtr<ID3D11PixelShader>& GetPixelShader(_In_ UINT uFeatures = 0u);
 
     protected:
-        ComPtr<ID3D11PixelShader> m_pixelShader;
+        ComPtr<ID3D11PixelShader> m_aPixelShaders[MAX_NUM_PERMUTATIONS];
     };
 }
\ No newline at end of file
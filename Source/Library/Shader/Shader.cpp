@@ -1,5 +1,9 @@
 #include "Shader.h"
 
+#include "Job/JobSystem.h"
+#include "Shader/ShaderCache.h"
+#include "Shader/ShaderConstants.h"
+
 namespace library
 {
     /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
@@ -13,13 +17,18 @@ namespace library
               PCSTR pszShaderModel
                   Specifies the shader target or set of shader features
                   to compile against
-      Modifies: [m_pszFileName, m_pszEntryPoint, m_pszShaderModel].
+              UINT uFeatures
+                  Mask of the eShaderFeature the source compiles in or
+                  out, one permutation is compiled per subset
+      Modifies: [m_pszFileName, m_pszEntryPoint, m_pszShaderModel,
+                 m_uFeatures].
     M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
 
-    Shader::Shader(_In_ PCWSTR pszFileName, _In_ PCSTR pszEntryPoint, _In_ PCSTR pszShaderModel)
+    Shader::Shader(_In_ PCWSTR pszFileName, _In_ PCSTR pszEntryPoint, _In_ PCSTR pszShaderModel, _In_ UINT uFeatures)
         : m_pszFileName(pszFileName),
         m_pszEntryPoint(pszEntryPoint),
-        m_pszShaderModel(pszShaderModel)
+        m_pszShaderModel(pszShaderModel),
+        m_uFeatures(uFeatures & (MAX_NUM_PERMUTATIONS - 1u))
     {
     }
 
@@ -35,18 +44,113 @@ namespace library
         return m_pszFileName;
     }
 
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   Shader::GetFeatures
+      Summary:  Returns the features the shader compiles permutations of
+      Returns:  UINT
+                  Mask of eShaderFeature
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+
+    UINT Shader::GetFeatures() const
+    {
+        return m_uFeatures;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   Shader::GetPermutation
+      Summary:  Returns the permutation that draws an object with a set
+                of features. Features the shader does not have are
+                left out
+      Args:     UINT uFeatures
+                  Mask of eShaderFeature of the object
+      Returns:  UINT
+                  Index of the permutation
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+
+    UINT Shader::GetPermutation(_In_ UINT uFeatures) const
+    {
+        return GetShaderPermutation(m_uFeatures, uFeatures);
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   Shader::GetNumPermutations
+      Summary:  Returns the number of permutations compiled, one per
+                subset of the features
+      Returns:  UINT
+                  Number of permutations
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+
+    UINT Shader::GetNumPermutations() const
+    {
+        UINT uNumPermutations = 0u;
+        for (UINT uPermutation = 0u; uPermutation < MAX_NUM_PERMUTATIONS; ++uPermutation)
+        {
+            if (hasPermutation(uPermutation))
+            {
+                ++uNumPermutations;
+            }
+        }
+
+        return uNumPermutations;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   Shader::InitializeShaders
+      Summary:  Initializes shaders on the job system, one job per
+                shader. Shaders compile independently and the device
+                creates objects from any thread
+      Args:     ID3D11Device* pDevice
+                  The Direct3D device to create the shaders
+                const std::vector<Shader*>& apShaders
+                  Shaders to initialize
+      Returns:  HRESULT
+                  Status code of the first shader that failed
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+
+    HRESULT Shader::InitializeShaders(_In_ ID3D11Device* pDevice, _In_ const std::vector<Shader*>& apShaders)
+    {
+        std::vector<HRESULT> aResults(apShaders.size(), S_OK);
+        JobSystem::GetGlobal().ParallelFor(static_cast<UINT>(apShaders.size()), 1u, [pDevice, &apShaders, &aResults](UINT uBegin, UINT uEnd)
+            {
+                for (UINT i = uBegin; i < uEnd; ++i)
+                {
+                    aResults[i] = apShaders[i]->Initialize(pDevice);
+                }
+            });
+
+        for (HRESULT hr : aResults)
+        {
+            if (FAILED(hr))
+            {
+                return hr;
+            }
+        }
+
+        return S_OK;
+    }
+
     /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
       Method:   Shader::compile
-      Summary:  Compiles the given shader file
+      Summary:  Compiles a permutation of the given shader file, with
+                the shader constants and every feature defined. The
+                bytecode is read from the shader cache when the file,
+                its includes and the options did not change since it
+                was compiled
       Args:     ID3DBlob** ppOutBlob
                   Receives a pointer to the ID3DBlob interface that you
                   can use to access the compiled code
+                UINT uPermutation
+                  Mask of eShaderFeature compiled in
       Returns:  HRESULT
                   Status code
     M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
 
-    HRESULT Shader::compile(_Outptr_ ID3DBlob** ppOutBlob)
+    HRESULT Shader::compile(_Outptr_ ID3DBlob** ppOutBlob, _In_ UINT uPermutation)
     {
+        static constexpr PCSTR FEATURE_NAMES[] = { "NORMAL_MAP", "INSTANCING", "SKINNING", "SHADOW_RECEIVER" };
+        static_assert(ARRAYSIZE(FEATURE_NAMES) == static_cast<size_t>(eShaderFeature::COUNT), "Every shader feature needs a define");
+
+
         HRESULT hr = S_OK;
 
         DWORD dwShaderFlags = D3DCOMPILE_ENABLE_STRICTNESS;
@@ -60,26 +164,38 @@ namespace library
         // Disable optimizations to further improve shader debugging
         dwShaderFlags |= D3DCOMPILE_SKIP_OPTIMIZATION;
 #endif
-        ComPtr<ID3DBlob> pErrorBlob;
-        hr = D3DCompileFromFile(m_pszFileName,
-            nullptr,
-            nullptr,
-            m_pszEntryPoint,
-            m_pszShaderModel,
-            dwShaderFlags,
-            0,
-            ppOutBlob,
-            pErrorBlob.GetAddressOf()
-        );
+        D3D_SHADER_MACRO aDefines[ARRAYSIZE(SHADER_CONSTANT_DEFINES) + ARRAYSIZE(FEATURE_NAMES) + 1u] = {};
+        size_t uNumDefines = 0u;
+        for (const D3D_SHADER_MACRO& define : SHADER_CONSTANT_DEFINES)
+        {
+            aDefines[uNumDefines++] = define;
+        }
+        for (UINT i = 0u; i < ARRAYSIZE(FEATURE_NAMES); ++i)
+        {
+            aDefines[uNumDefines++] = { FEATURE_NAMES[i], (uPermutation & (1u << i)) ? "1" : "0" };
+        }
+
+        hr = ShaderCache::GetGlobal().Load(m_pszFileName, aDefines, m_pszEntryPoint, m_pszShaderModel, dwShaderFlags, ppOutBlob);
         if (FAILED(hr))
         {
-            if (pErrorBlob)
-            {
-                OutputDebugStringA(reinterpret_cast<const char*>(pErrorBlob->GetBufferPointer()));
-            }
             return hr;
         }
 
         return S_OK;
     }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   Shader::hasPermutation
+      Summary:  Tells whether a permutation is compiled, whether its
+                features are all features of the shader
+      Args:     UINT uPermutation
+                  Mask of eShaderFeature
+      Returns:  BOOL
+                  TRUE if the permutation is compiled
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+
+    BOOL Shader::hasPermutation(_In_ UINT uPermutation) const
+    {
+        return IsShaderPermutation(m_uFeatures, uPermutation);
+    }
 }
\ No newline at end of file
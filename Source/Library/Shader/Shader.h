@@ -10,6 +10,8 @@
 
 #include "Common.h"
 
+#include "Shader/ShaderPermutation.h"
+
 namespace library
 {
     /*C+C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C
@@ -19,8 +21,18 @@ namespace library
                   Pure virtual function that initializes the shader
                 GetFileName
                   Returns the name of the shader file to be compiled
+                GetFeatures
+                  Returns the features the shader compiles permutations
+                  of
+                GetPermutation
+                  Returns the permutation compiled for a set of features
+                GetNumPermutations
+                  Returns the number of permutations compiled
+                InitializeShaders
+                  Initializes shaders in parallel
                 compile
-                  Compiles the given shader file
+                  Compiles a permutation of the given shader file, or
+                  reads it from the shader cache
                 Game
                   Constructor.
                 ~Game
@@ -28,9 +40,12 @@ namespace library
     C---C---C---C---C---C---C---C---C---C---C---C---C---C---C---C---C-C*/
     class Shader
     {
+    public:
+        static constexpr UINT MAX_NUM_PERMUTATIONS = MAX_NUM_SHADER_PERMUTATIONS;
+
     public:
         Shader() = delete;
-        Shader(_In_ PCWSTR pszFileName, _In_ PCSTR pszEntryPoint, _In_ PCSTR pszShaderModel);
+        Shader(_In_ PCWSTR pszFileName, _In_ PCSTR pszEntryPoint, _In_ PCSTR pszShaderModel, _In_ UINT uFeatures = 0u);
         Shader(const Shader& other) = delete;
         Shader(Shader&& other) = delete;
         Shader& operator=(const Shader& other) = delete;
@@ -39,12 +54,19 @@ namespace library
 
         virtual HRESULT Initialize(_In_ ID3D11Device* pDevice) = 0;
         PCWSTR GetFileName() const;
+        UINT GetFeatures() const;
+        UINT GetPermutation(_In_ UINT uFeatures) const;
+        UINT GetNumPermutations() const;
+
+        static HRESULT InitializeShaders(_In_ ID3D11Device* pDevice, _In_ const std::vector<Shader*>& apShaders);
 
     protected:
-        HRESULT compile(_Outptr_ ID3DBlob** ppOutBlob);
+        HRESULT compile(_Outptr_ ID3DBlob** ppOutBlob, _In_ UINT uPermutation = 0u);
+        BOOL hasPermutation(_In_ UINT uPermutation) const;
 
         PCWSTR m_pszFileName;
         PCSTR m_pszEntryPoint;
         PCSTR m_pszShaderModel;
+        UINT m_uFeatures;
     };
 }
\ No newline at end of file
@@ -0,0 +1,455 @@
+#include "Shader/ShaderCache.h"
+
+#include <chrono>
+#include <cstring>
+#include <fstream>
+#include <thread>
+
+namespace library
+{
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   ShaderCache::GetGlobal
+      Summary:  Returns the cache shared by the whole library, created
+                on first use
+      Returns:  ShaderCache&
+                  Global shader cache
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    ShaderCache& ShaderCache::GetGlobal()
+    {
+        static ShaderCache s_cache;
+
+        return s_cache;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   ShaderCache::ShaderCache
+      Summary:  Constructor. The cached files go to the ShaderCache
+                directory of the working directory, next to the
+                shaders
+      Modifies: [m_mutex, m_directory, m_uNumHits, m_uNumMisses,
+                  m_uNumFailures, m_readTime, m_compileTime].
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    ShaderCache::ShaderCache()
+        : m_mutex()
+        , m_directory(L"ShaderCache")
+        , m_uNumHits(0u)
+        , m_uNumMisses(0u)
+        , m_uNumFailures(0u)
+        , m_readTime(0.0f)
+        , m_compileTime(0.0f)
+    {
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   ShaderCache::Load
+      Summary:  Returns the bytecode of a shader. The cached file of its
+                key is read if there is a valid one, otherwise the
+                shader is compiled and the bytecode written to the
+                cache. A cache that cannot be written is not an error,
+                the shader just compiles again on the next run
+      Args:     const std::filesystem::path& filePath
+                  Path to the source of the shader
+                const D3D_SHADER_MACRO* pDefines
+                  Defines, terminated by a null name, or nullptr
+                PCSTR pszEntryPoint
+                  Name of the entry point
+                PCSTR pszShaderModel
+                  Profile to compile against
+                UINT uFlags
+                  D3DCOMPILE flags
+                ID3DBlob** ppBlob
+                  Receives the bytecode
+      Modifies: [m_uNumHits, m_uNumMisses, m_uNumFailures, m_readTime,
+                  m_compileTime].
+      Returns:  HRESULT
+                  Status code of the compilation on a miss
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    HRESULT ShaderCache::Load(_In_ const std::filesystem::path& filePath, _In_opt_ const D3D_SHADER_MACRO* pDefines, _In_ PCSTR pszEntryPoint,
+        _In_ PCSTR pszShaderModel, _In_ UINT uFlags, _Outptr_ ID3DBlob** ppBlob)
+    {
+        *ppBlob = nullptr;
+
+        // A source that cannot be read has no key, the compiler reports why
+        const std::chrono::steady_clock::time_point readStart = std::chrono::steady_clock::now();
+        const UINT64 uKey = ComputeKey(filePath, pDefines, pszEntryPoint, pszShaderModel, uFlags);
+        const std::filesystem::path cachePath = getCachePath(uKey);
+        if (uKey != INVALID_KEY && SUCCEEDED(readBytecode(cachePath, uKey, ppBlob)))
+        {
+            const FLOAT readTime = std::chrono::duration<FLOAT, std::milli>(std::chrono::steady_clock::now() - readStart).count();
+
+            std::lock_guard<std::mutex> lock(m_mutex);
+            ++m_uNumHits;
+            m_readTime += readTime;
+
+            return S_OK;
+        }
+
+        const std::chrono::steady_clock::time_point compileStart = std::chrono::steady_clock::now();
+        ComPtr<ID3DBlob> errorBlob;
+        HRESULT hr = D3DCompileFromFile(filePath.c_str(), pDefines, D3D_COMPILE_STANDARD_FILE_INCLUDE, pszEntryPoint, pszShaderModel, uFlags, 0u,
+            ppBlob, errorBlob.GetAddressOf());
+        if (errorBlob)
+        {
+            OutputDebugStringA(static_cast<const char*>(errorBlob->GetBufferPointer()));
+        }
+        if (SUCCEEDED(hr) && uKey != INVALID_KEY)
+        {
+            writeBytecode(cachePath, uKey, *ppBlob);
+        }
+        const FLOAT compileTime = std::chrono::duration<FLOAT, std::milli>(std::chrono::steady_clock::now() - compileStart).count();
+
+        std::lock_guard<std::mutex> lock(m_mutex);
+        ++m_uNumMisses;
+        m_compileTime += compileTime;
+        if (FAILED(hr))
+        {
+            ++m_uNumFailures;
+        }
+
+        return hr;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   ShaderCache::ComputeKey
+      Summary:  Hashes everything the bytecode of a shader depends on:
+                the source and the files it includes, the defines, the
+                entry point, the profile, the flags, the version of the
+                compiler and the version of the cached files
+      Args:     const std::filesystem::path& filePath
+                  Path to the source of the shader
+                const D3D_SHADER_MACRO* pDefines
+                  Defines, terminated by a null name, or nullptr
+                PCSTR pszEntryPoint
+                  Name of the entry point
+                PCSTR pszShaderModel
+                  Profile to compile against
+                UINT uFlags
+                  D3DCOMPILE flags
+      Returns:  UINT64
+                  Key of the shader, INVALID_KEY if its source cannot be
+                  read
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    UINT64 ShaderCache::ComputeKey(_In_ const std::filesystem::path& filePath, _In_opt_ const D3D_SHADER_MACRO* pDefines, _In_ PCSTR pszEntryPoint,
+        _In_ PCSTR pszShaderModel, _In_ UINT uFlags)
+    {
+        UINT64 uHash = FNV_OFFSET_BASIS;
+
+        std::unordered_set<std::wstring> visited;
+        if (!hashSource(filePath, visited, uHash))
+        {
+            return INVALID_KEY;
+        }
+
+        // Names and values are hashed with their terminators, so "AB" "C" differs from "A" "BC"
+        for (const D3D_SHADER_MACRO* pDefine = pDefines; pDefine && pDefine->Name; ++pDefine)
+        {
+            uHash = hashBytes(pDefine->Name, strlen(pDefine->Name) + 1u, uHash);
+            uHash = pDefine->Definition ? hashBytes(pDefine->Definition, strlen(pDefine->Definition) + 1u, uHash) : hashBytes("", 1u, uHash);
+        }
+        uHash = hashBytes(pszEntryPoint, strlen(pszEntryPoint) + 1u, uHash);
+        uHash = hashBytes(pszShaderModel, strlen(pszShaderModel) + 1u, uHash);
+
+        const UINT auVersions[3] = { uFlags, static_cast<UINT>(D3D_COMPILER_VERSION), FILE_VERSION };
+        uHash = hashBytes(auVersions, sizeof(auVersions), uHash);
+
+        return (uHash == INVALID_KEY) ? 1ull : uHash;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   ShaderCache::SetDirectory
+      Summary:  Sets the directory the cached files are read from and
+                written to, created when the first one is written
+      Args:     const std::filesystem::path& directory
+                  Directory of the cached files
+      Modifies: [m_directory].
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    void ShaderCache::SetDirectory(_In_ const std::filesystem::path& directory)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+
+        m_directory = directory;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   ShaderCache::GetDirectory
+      Summary:  Returns the directory of the cached files
+      Returns:  std::filesystem::path
+                  Directory of the cached files
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    std::filesystem::path ShaderCache::GetDirectory() const
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+
+        return m_directory;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   ShaderCache::ResetStatistics
+      Summary:  Zeroes the hit, miss and failure counters and the times
+      Modifies: [m_uNumHits, m_uNumMisses, m_uNumFailures, m_readTime,
+                  m_compileTime].
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    void ShaderCache::ResetStatistics()
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+
+        m_uNumHits = 0u;
+        m_uNumMisses = 0u;
+        m_uNumFailures = 0u;
+        m_readTime = 0.0f;
+        m_compileTime = 0.0f;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   ShaderCache::GetStatistics
+      Summary:  Returns the counters and the times of the cache
+      Returns:  ShaderCacheStatistics
+                  Counters and times
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    ShaderCacheStatistics ShaderCache::GetStatistics() const
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+
+        return
+        {
+            .uNumHits = m_uNumHits,
+            .uNumMisses = m_uNumMisses,
+            .uNumFailures = m_uNumFailures,
+            .readTime = m_readTime,
+            .compileTime = m_compileTime
+        };
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   ShaderCache::hashBytes
+      Summary:  Folds bytes into a 64-bit FNV-1a hash
+      Args:     const void* pData
+                  Bytes to hash
+                size_t uSize
+                  Number of bytes
+                UINT64 uHash
+                  Hash so far
+      Returns:  UINT64
+                  Hash with the bytes folded in
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    UINT64 ShaderCache::hashBytes(_In_reads_bytes_(uSize) const void* pData, _In_ size_t uSize, _In_ UINT64 uHash)
+    {
+        const BYTE* pBytes = static_cast<const BYTE*>(pData);
+        for (size_t i = 0u; i < uSize; ++i)
+        {
+            uHash = (uHash ^ pBytes[i]) * FNV_PRIME;
+        }
+
+        return uHash;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   ShaderCache::hashSource
+      Summary:  Hashes the contents of a source file, then those of the
+                files it includes, resolved against its directory as
+                the standard include handler does. A file included
+                twice is hashed once. The #include lines are found
+                without preprocessing, so an include disabled by the
+                preprocessor still counts, which only costs a
+                needless compilation. An include that cannot be read
+                is hashed by name, the compiler reports it
+      Args:     const std::filesystem::path& filePath
+                  Path to the source file
+                std::unordered_set<std::wstring>& visited
+                  Files already hashed
+                UINT64& uHash
+                  Hash so far
+      Modifies: [visited, uHash].
+      Returns:  BOOL
+                  TRUE if the file could be read
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    BOOL ShaderCache::hashSource(_In_ const std::filesystem::path& filePath, _Inout_ std::unordered_set<std::wstring>& visited, _Inout_ UINT64& uHash)
+    {
+        std::error_code error;
+        const std::filesystem::path canonicalPath = std::filesystem::weakly_canonical(filePath, error);
+        if (!visited.insert(error ? filePath.wstring() : canonicalPath.wstring()).second)
+        {
+            return TRUE;
+        }
+
+        std::vector<BYTE> aSource;
+        if (!readFile(filePath, aSource))
+        {
+            return FALSE;
+        }
+        uHash = hashBytes(aSource.data(), aSource.size(), uHash);
+
+        const std::string szSource(aSource.begin(), aSource.end());
+        for (size_t uLine = 0u; uLine < szSource.size();)
+        {
+            size_t uEnd = szSource.find('\n', uLine);
+            if (uEnd == std::string::npos)
+            {
+                uEnd = szSource.size();
+            }
+
+            size_t uDirective = szSource.find_first_not_of(" \t", uLine);
+            if (uDirective < uEnd && szSource[uDirective] == '#')
+            {
+                uDirective = szSource.find_first_not_of(" \t", uDirective + 1u);
+                if (uDirective < uEnd && szSource.compare(uDirective, 7u, "include") == 0)
+                {
+                    const size_t uOpen = szSource.find_first_of("\"<", uDirective + 7u);
+                    const size_t uClose = (uOpen < uEnd) ? szSource.find_first_of("\">", uOpen + 1u) : std::string::npos;
+                    if (uClose < uEnd)
+                    {
+                        const std::string szInclude = szSource.substr(uOpen + 1u, uClose - uOpen - 1u);
+                        if (!hashSource(filePath.parent_path() / std::filesystem::path(szInclude), visited, uHash))
+                        {
+                            uHash = hashBytes(szInclude.data(), szInclude.size(), uHash);
+                        }
+                    }
+                }
+            }
+
+            uLine = uEnd + 1u;
+        }
+
+        return TRUE;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   ShaderCache::readFile
+      Summary:  Reads a whole file with a single read
+      Args:     const std::filesystem::path& filePath
+                  Path to the file
+                std::vector<BYTE>& aData
+                  Receives the contents of the file
+      Modifies: [aData].
+      Returns:  BOOL
+                  TRUE if the file could be read
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    BOOL ShaderCache::readFile(_In_ const std::filesystem::path& filePath, _Out_ std::vector<BYTE>& aData)
+    {
+        aData.clear();
+
+        std::ifstream file(filePath, std::ios::binary | std::ios::ate);
+        if (!file)
+        {
+            return FALSE;
+        }
+
+        const std::streamoff size = file.tellg();
+        if (size < 0)
+        {
+            return FALSE;
+        }
+        aData.resize(static_cast<size_t>(size));
+        file.seekg(0);
+
+        return file.read(reinterpret_cast<char*>(aData.data()), static_cast<std::streamsize>(aData.size())) ? TRUE : FALSE;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   ShaderCache::readBytecode
+      Summary:  Reads the cached bytecode of a key
+      Args:     const std::filesystem::path& cachePath
+                  Path to the cached file
+                UINT64 uKey
+                  Key the file must hold
+                ID3DBlob** ppBlob
+                  Receives the bytecode
+      Returns:  HRESULT
+                  Status code, failed if the file is missing or does not
+                  hold the key
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    HRESULT ShaderCache::readBytecode(_In_ const std::filesystem::path& cachePath, _In_ UINT64 uKey, _Outptr_ ID3DBlob** ppBlob)
+    {
+        std::vector<BYTE> aFile;
+        if (!readFile(cachePath, aFile) || aFile.size() < sizeof(FileHeader))
+        {
+            return E_FAIL;
+        }
+
+        FileHeader header;
+        memcpy(&header, aFile.data(), sizeof(header));
+        if (header.uMagic != FILE_MAGIC || header.uVersion != FILE_VERSION || header.uKey != uKey
+            || header.uSize == 0u || header.uSize != aFile.size() - sizeof(header))
+        {
+            return E_FAIL;
+        }
+
+        HRESULT hr = D3DCreateBlob(static_cast<SIZE_T>(header.uSize), ppBlob);
+        if (FAILED(hr))
+        {
+            return hr;
+        }
+        memcpy((*ppBlob)->GetBufferPointer(), aFile.data() + sizeof(header), static_cast<size_t>(header.uSize));
+
+        return S_OK;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   ShaderCache::writeBytecode
+      Summary:  Writes the bytecode of a key to the cache. The file is
+                written under a name of the thread, then renamed, so
+                that a run stopped halfway or two threads compiling the
+                same shader never leave a partial file
+      Args:     const std::filesystem::path& cachePath
+                  Path to the cached file
+                UINT64 uKey
+                  Key of the bytecode
+                ID3DBlob* pBlob
+                  Bytecode
+      Returns:  HRESULT
+                  Status code
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    HRESULT ShaderCache::writeBytecode(_In_ const std::filesystem::path& cachePath, _In_ UINT64 uKey, _In_ ID3DBlob* pBlob)
+    {
+        std::error_code error;
+        std::filesystem::create_directories(cachePath.parent_path(), error);
+
+        std::filesystem::path tempPath = cachePath;
+        tempPath += L"." + std::to_wstring(std::hash<std::thread::id>()(std::this_thread::get_id())) + L".tmp";
+
+        const FileHeader header =
+        {
+            .uMagic = FILE_MAGIC,
+            .uVersion = FILE_VERSION,
+            .uKey = uKey,
+            .uSize = static_cast<UINT64>(pBlob->GetBufferSize())
+        };
+        {
+            std::ofstream file(tempPath, std::ios::binary | std::ios::trunc);
+            file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+            file.write(static_cast<const char*>(pBlob->GetBufferPointer()), static_cast<std::streamsize>(pBlob->GetBufferSize()));
+            if (!file)
+            {
+                file.close();
+                std::filesystem::remove(tempPath, error);
+                return E_FAIL;
+            }
+        }
+
+        std::filesystem::rename(tempPath, cachePath, error);
+        if (error)
+        {
+            std::filesystem::remove(tempPath, error);
+            return E_FAIL;
+        }
+
+        return S_OK;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   ShaderCache::getCachePath
+      Summary:  Returns the path of the cached file of a key, the key in
+                hexadecimal
+      Args:     UINT64 uKey
+                  Key of the shader
+      Returns:  std::filesystem::path
+                  Path of the cached file
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    std::filesystem::path ShaderCache::getCachePath(_In_ UINT64 uKey) const
+    {
+        WCHAR szName[24];
+        swprintf_s(szName, L"%016llX.cso", static_cast<unsigned long long>(uKey));
+
+        return GetDirectory() / szName;
+    }
+}
@@ -0,0 +1,129 @@
+﻿/*+===================================================================
+  File:      SHADERCACHE.H
+
+  Summary:   ShaderCache header file contains declarations of the
+             ShaderCacheStatistics type and the ShaderCache class that
+             keeps compiled shader bytecode on disk between runs.
+
+  Classes: ShaderCache
+
+  © 2022 Kyung Hee University
+===================================================================+*/
+#pragma once
+
+#include "Common.h"
+
+#include <mutex>
+
+namespace library
+{
+    /*S+S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S
+      Struct:   ShaderCacheStatistics
+
+      Summary:  Counters of the shader cache. Hits are shaders read
+                from the cache, misses the ones compiled, failures the
+                compilations that did not succeed. The times are summed
+                over the threads that loaded shaders, in milliseconds
+    S---S---S---S---S---S---S---S---S---S---S---S---S---S---S---S---S-S*/
+    struct ShaderCacheStatistics
+    {
+        UINT uNumHits;
+        UINT uNumMisses;
+        UINT uNumFailures;
+        FLOAT readTime;
+        FLOAT compileTime;
+    };
+
+    /*C+C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C
+      Class:    ShaderCache
+
+      Summary:  Bytecode of compiled shaders, one file per shader in the
+                cache directory. A shader is keyed by a hash of the
+                contents of its source and of every file it includes,
+                its defines, entry point, profile and compile flags, and
+                the version of the compiler, so any edit compiles it
+                again and nothing has to be cleaned by hand. A cached
+                file is loaded with a single read. Thread safe
+
+      Methods:  GetGlobal
+                  Returns the cache shared by the whole library
+                Load
+                  Returns the bytecode of a shader, compiled on a miss
+                ComputeKey
+                  Hashes the inputs of a compilation
+                SetDirectory
+                  Sets the directory of the cached files
+                GetDirectory
+                  Returns the directory of the cached files
+                ResetStatistics
+                  Zeroes the counters and the times
+                GetStatistics
+                  Returns the counters and the times
+                ShaderCache
+                  Constructor.
+                ~ShaderCache
+                  Destructor.
+    C---C---C---C---C---C---C---C---C---C---C---C---C---C---C---C---C-C*/
+    class ShaderCache final
+    {
+    public:
+        static constexpr UINT FILE_VERSION = 1u;
+        static constexpr UINT64 INVALID_KEY = 0ull;
+
+        static ShaderCache& GetGlobal();
+
+    public:
+        ShaderCache();
+        ShaderCache(const ShaderCache& other) = delete;
+        ShaderCache(ShaderCache&& other) = delete;
+        ShaderCache& operator=(const ShaderCache& other) = delete;
+        ShaderCache& operator=(ShaderCache&& other) = delete;
+        ~ShaderCache() = default;
+
+        HRESULT Load(_In_ const std::filesystem::path& filePath, _In_opt_ const D3D_SHADER_MACRO* pDefines, _In_ PCSTR pszEntryPoint,
+            _In_ PCSTR pszShaderModel, _In_ UINT uFlags, _Outptr_ ID3DBlob** ppBlob);
+        static UINT64 ComputeKey(_In_ const std::filesystem::path& filePath, _In_opt_ const D3D_SHADER_MACRO* pDefines, _In_ PCSTR pszEntryPoint,
+            _In_ PCSTR pszShaderModel, _In_ UINT uFlags);
+
+        void SetDirectory(_In_ const std::filesystem::path& directory);
+        std::filesystem::path GetDirectory() const;
+
+        void ResetStatistics();
+        ShaderCacheStatistics GetStatistics() const;
+
+    private:
+        static constexpr UINT FILE_MAGIC = 0x43444853u;
+        static constexpr UINT64 FNV_OFFSET_BASIS = 0xCBF29CE484222325ull;
+        static constexpr UINT64 FNV_PRIME = 0x100000001B3ull;
+
+        /*S+S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S
+          Struct:   FileHeader
+
+          Summary:  Start of a cached file, followed by the bytecode. A
+                    file whose header does not match its key or its size
+                    is compiled again
+        S---S---S---S---S---S---S---S---S---S---S---S---S---S---S---S---S-S*/
+        struct FileHeader
+        {
+            UINT uMagic;
+            UINT uVersion;
+            UINT64 uKey;
+            UINT64 uSize;
+        };
+
+        static UINT64 hashBytes(_In_reads_bytes_(uSize) const void* pData, _In_ size_t uSize, _In_ UINT64 uHash);
+        static BOOL hashSource(_In_ const std::filesystem::path& filePath, _Inout_ std::unordered_set<std::wstring>& visited, _Inout_ UINT64& uHash);
+        static BOOL readFile(_In_ const std::filesystem::path& filePath, _Out_ std::vector<BYTE>& aData);
+        static HRESULT readBytecode(_In_ const std::filesystem::path& cachePath, _In_ UINT64 uKey, _Outptr_ ID3DBlob** ppBlob);
+        static HRESULT writeBytecode(_In_ const std::filesystem::path& cachePath, _In_ UINT64 uKey, _In_ ID3DBlob* pBlob);
+        std::filesystem::path getCachePath(_In_ UINT64 uKey) const;
+
+        mutable std::mutex m_mutex;
+        std::filesystem::path m_directory;
+        UINT m_uNumHits;
+        UINT m_uNumMisses;
+        UINT m_uNumFailures;
+        FLOAT m_readTime;
+        FLOAT m_compileTime;
+    };
+}
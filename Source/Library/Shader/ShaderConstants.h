@@ -0,0 +1,39 @@
+﻿/*+===================================================================
+  File:      SHADERCONSTANTS.H
+
+  Summary:   ShaderConstants header file contains the constants shared
+             by the library and the shaders, declared once for both.
+
+  © 2022 Kyung Hee University
+===================================================================+*/
+#pragma once
+
+#include "Common.h"
+
+// Every constant the shaders size their arrays and loops with. The list
+// expands to a constant of the library and to a define passed to every
+// shader compilation, so the two can not disagree. Values are written
+// as literals both languages read
+#define SHADER_CONSTANTS(CONSTANT) \
+    CONSTANT(MAX_NUM_LIGHTS, 1024u) \
+    CONSTANT(MAX_NUM_BONES, 256u) \
+    CONSTANT(NUM_SHADOW_CASCADES, 4u) \
+    CONSTANT(MAX_NUM_CUBE_SHADOWS, 2u) \
+    CONSTANT(NO_SHADOW_LIGHT, 0xFFFFFFFFu) \
+    CONSTANT(VOXEL_TEXTURE_NONE, 0u) \
+    CONSTANT(VOXEL_TEXTURE_ATLAS, 1u) \
+    CONSTANT(VOXEL_TEXTURE_BOUND, 2u)
+
+namespace library
+{
+#define SHADER_CONSTANT_DECLARATION(name, value) inline constexpr UINT name = value;
+    SHADER_CONSTANTS(SHADER_CONSTANT_DECLARATION)
+#undef SHADER_CONSTANT_DECLARATION
+
+#define SHADER_CONSTANT_DEFINE(name, value) { #name, #value },
+    inline constexpr D3D_SHADER_MACRO SHADER_CONSTANT_DEFINES[] =
+    {
+        SHADER_CONSTANTS(SHADER_CONSTANT_DEFINE)
+    };
+#undef SHADER_CONSTANT_DEFINE
+}
@@ -0,0 +1,51 @@
+﻿/*+===================================================================
+  File:      SHADERPERMUTATION.H
+
+  Summary:   ShaderPermutation header file contains the features a
+             shader compiles permutations of, and the mapping from the
+             features of an object to the permutation that draws it.
+
+  © 2022 Kyung Hee University
+===================================================================+*/
+#pragma once
+
+#include "Common.h"
+
+namespace library
+{
+    /*E+E+++E+++E+++E+++E+++E+++E+++E+++E+++E+++E+++E+++E+++E+++E+++E+++E
+      Enum:     eShaderFeature
+
+      Summary:  Features a shader source compiles in or out. Each one is
+                defined to 1 or 0 in the compilation of a permutation,
+                under the name of its value
+    E---E---E---E---E---E---E---E---E---E---E---E---E---E---E---E---E-E*/
+    enum class eShaderFeature : UINT
+    {
+        NORMAL_MAP = 0,
+        INSTANCING,
+        SKINNING,
+        SHADOW_RECEIVER,
+        COUNT,
+    };
+
+    inline constexpr UINT MAX_NUM_SHADER_PERMUTATIONS = 1u << static_cast<UINT>(eShaderFeature::COUNT);
+
+    constexpr UINT GetShaderFeatureMask(_In_ eShaderFeature feature)
+    {
+        return 1u << static_cast<UINT>(feature);
+    }
+
+    // A shader compiles one permutation per subset of its features, and
+    // indexes them by their mask. An object is drawn with the features
+    // it shares with the shader, the others are left out
+    constexpr UINT GetShaderPermutation(_In_ UINT uShaderFeatures, _In_ UINT uFeatures)
+    {
+        return uFeatures & uShaderFeatures;
+    }
+
+    constexpr BOOL IsShaderPermutation(_In_ UINT uShaderFeatures, _In_ UINT uPermutation)
+    {
+        return uPermutation < MAX_NUM_SHADER_PERMUTATIONS && (uPermutation & ~uShaderFeatures) == 0u;
+    }
+}
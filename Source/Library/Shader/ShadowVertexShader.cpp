@@ -2,15 +2,14 @@
 
 namespace library
 {
-    ShadowVertexShader::ShadowVertexShader(_In_ PCWSTR pszFileName, _In_ PCSTR pszEntryPoint, _In_ PCSTR pszShaderModel)
-        : VertexShader(pszFileName, pszEntryPoint, pszShaderModel)
+    ShadowVertexShader::ShadowVertexShader(_In_ PCWSTR pszFileName, _In_ PCSTR pszEntryPoint, _In_ PCSTR pszShaderModel, _In_ UINT uFeatures)
+        : VertexShader(pszFileName, pszEntryPoint, pszShaderModel, uFeatures)
     {
     }
 
     HRESULT ShadowVertexShader::Initialize(_In_ ID3D11Device* pDevice)
     {
-        ComPtr<ID3DBlob> vsBlob;
-        HRESULT hr = compile(vsBlob.GetAddressOf());
+        HRESULT hr = VertexShader::Initialize(pDevice);
         if (FAILED(hr))
         {
             WCHAR szMessage[256];
@@ -28,12 +27,11 @@ namespace library
             return hr;
         }
 
-        hr = pDevice->CreateVertexShader(vsBlob->GetBufferPointer(), vsBlob->GetBufferSize(), nullptr, m_vertexShader.GetAddressOf());
-        if (FAILED(hr))
-        {
-            return hr;
-        }
+        return S_OK;
+    }
 
+    HRESULT ShadowVertexShader::createInputLayout(_In_ ID3D11Device* pDevice, _In_ ID3DBlob* pBlob, _Outptr_ ID3D11InputLayout** ppInputLayout)
+    {
         // Define the input layout
         D3D11_INPUT_ELEMENT_DESC aLayouts[] =
         {
@@ -46,12 +44,6 @@ namespace library
         UINT uNumElements = ARRAYSIZE(aLayouts);
 
         // Create the input layout
-        hr = pDevice->CreateInputLayout(aLayouts, uNumElements, vsBlob->GetBufferPointer(), vsBlob->GetBufferSize(), m_vertexLayout.GetAddressOf());
-        if (FAILED(hr))
-        {
-            return hr;
-        }
-
-        return hr;
+        return pDevice->CreateInputLayout(aLayouts, uNumElements, pBlob->GetBufferPointer(), pBlob->GetBufferSize(), ppInputLayout);
     }
 }
\ No newline at end of file
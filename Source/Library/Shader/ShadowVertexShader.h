@@ -21,7 +21,7 @@ namespace library
     {
     public:
         ShadowVertexShader() = delete;
-        ShadowVertexShader(_In_ PCWSTR pszFileName, _In_ PCSTR pszEntryPoint, _In_ PCSTR pszShaderModel);
+        ShadowVertexShader(_In_ PCWSTR pszFileName, _In_ PCSTR pszEntryPoint, _In_ PCSTR pszShaderModel, _In_ UINT uFeatures = 0u);
         ShadowVertexShader(const ShadowVertexShader& other) = delete;
         ShadowVertexShader(ShadowVertexShader&& other) = delete;
         ShadowVertexShader& operator=(const ShadowVertexShader& other) = delete;
@@ -29,5 +29,8 @@ namespace library
         virtual ~ShadowVertexShader() = default;
 
         virtual HRESULT Initialize(_In_ ID3D11Device* pDevice) override;
+
+    protected:
+        virtual HRESULT createInputLayout(_In_ ID3D11Device* pDevice, _In_ ID3DBlob* pBlob, _Outptr_ ID3D11InputLayout** ppInputLayout) override;
     };
 }
\ No newline at end of file
@@ -21,7 +21,7 @@ namespace library
     {
     public:
         SkinningVertexShader() = delete;
-        SkinningVertexShader(_In_ PCWSTR pszFileName, _In_ PCSTR pszEntryPoint, _In_ PCSTR pszShaderModel);
+        SkinningVertexShader(_In_ PCWSTR pszFileName, _In_ PCSTR pszEntryPoint, _In_ PCSTR pszShaderModel, _In_ UINT uFeatures = 0u);
         SkinningVertexShader(const SkinningVertexShader& other) = delete;
         SkinningVertexShader(SkinningVertexShader&& other) = delete;
         SkinningVertexShader& operator=(const SkinningVertexShader& other) = delete;
@@ -29,5 +29,8 @@ namespace library
         virtual ~SkinningVertexShader() = default;
 
         virtual HRESULT Initialize(_In_ ID3D11Device* pDevice) override;
+
+    protected:
+        virtual HRESULT createInputLayout(_In_ ID3D11Device* pDevice, _In_ ID3DBlob* pBlob, _Outptr_ ID3D11InputLayout** ppInputLayout) override;
     };
 }
\ No newline at end of file
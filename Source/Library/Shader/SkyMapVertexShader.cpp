@@ -15,47 +15,36 @@ namespace library
                 PCSTR pszShaderModel
                   Specifies the shader target or set of shader features
                   to compile against
+                UINT uFeatures
+                  Mask of the eShaderFeature the source compiles in or
+                  out
     M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
 
-    SkyMapVertexShader::SkyMapVertexShader(_In_ PCWSTR pszFileName, _In_ PCSTR pszEntryPoint, _In_ PCSTR pszShaderModel)
-        :VertexShader(pszFileName, pszEntryPoint, pszShaderModel)
+    SkyMapVertexShader::SkyMapVertexShader(_In_ PCWSTR pszFileName, _In_ PCSTR pszEntryPoint, _In_ PCSTR pszShaderModel, _In_ UINT uFeatures)
+        :VertexShader(pszFileName, pszEntryPoint, pszShaderModel, uFeatures)
     {
 
     }
 
     /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
-      Method:   SkyMapVertexShader::Initialize
+      Method:   SkyMapVertexShader::createInputLayout
 
-      Summary:  Initializes the vertex shader and the input layout
+      Summary:  Creates the input layout of a compiled permutation, the
+                position only
 
       Args:     ID3D11Device* pDevice
-                  The Direct3D device to create the vertex shader
+                  The Direct3D device to create the input layout
+                ID3DBlob* pBlob
+                  Bytecode of the permutation
+                ID3D11InputLayout** ppInputLayout
+                  Receives the input layout
 
       Returns:  HRESULT
                   Status code
     M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
 
-    HRESULT SkyMapVertexShader::Initialize(_In_ ID3D11Device* pDevice)
+    HRESULT SkyMapVertexShader::createInputLayout(_In_ ID3D11Device* pDevice, _In_ ID3DBlob* pBlob, _Outptr_ ID3D11InputLayout** ppInputLayout)
     {
-        HRESULT hr = S_OK;
-
-        ComPtr<ID3DBlob> VSBlob;
-        hr = compile(VSBlob.GetAddressOf());
-        if (FAILED(hr))
-        {
-            return hr;
-        }
-
-        hr = pDevice->CreateVertexShader(VSBlob->GetBufferPointer(),
-            VSBlob->GetBufferSize(),
-            nullptr,
-            m_vertexShader.GetAddressOf()
-        );
-        if (FAILED(hr))
-        {
-            return hr;
-        }
-
         // Define and Create Input Layout
         D3D11_INPUT_ELEMENT_DESC layout[] =
         {
@@ -71,17 +60,11 @@ namespace library
         };
         const UINT numElements = ARRAYSIZE(layout);
 
-        hr = pDevice->CreateInputLayout(layout,
+        return pDevice->CreateInputLayout(layout,
             numElements,
-            VSBlob->GetBufferPointer(),
-            VSBlob->GetBufferSize(),
-            &m_vertexLayout
+            pBlob->GetBufferPointer(),
+            pBlob->GetBufferSize(),
+            ppInputLayout
         );
-        if (FAILED(hr))
-        {
-            return hr;
-        }
-
-        return hr;
     }
 }
\ No newline at end of file
@@ -22,8 +22,8 @@ namespace library
 
       Summary:  Sky map vertex shader
 
-      Methods:  Initialize
-                  Initializes the vertex shader and the input layout
+      Methods:  createInputLayout
+                  Creates the input layout of a compiled permutation
                 SkyMapVertexShader
                   Constructor.
                 ~SkyMapVertexShader
@@ -33,13 +33,14 @@ namespace library
     {
     public:
         SkyMapVertexShader() = delete;
-        SkyMapVertexShader(_In_ PCWSTR pszFileName, _In_ PCSTR pszEntryPoint, _In_ PCSTR pszShaderModel);
+        SkyMapVertexShader(_In_ PCWSTR pszFileName, _In_ PCSTR pszEntryPoint, _In_ PCSTR pszShaderModel, _In_ UINT uFeatures = 0u);
         SkyMapVertexShader(const SkyMapVertexShader& other) = delete;
         SkyMapVertexShader(SkyMapVertexShader&& other) = delete;
         SkyMapVertexShader& operator=(const SkyMapVertexShader& other) = delete;
         SkyMapVertexShader& operator=(SkyMapVertexShader&& other) = delete;
         virtual ~SkyMapVertexShader() = default;
 
-        virtual HRESULT Initialize(_In_ ID3D11Device* pDevice) override;
+    protected:
+        virtual HRESULT createInputLayout(_In_ ID3D11Device* pDevice, _In_ ID3DBlob* pBlob, _Outptr_ ID3D11InputLayout** ppInputLayout) override;
     };
 }
\ No newline at end of file
@@ -13,21 +13,26 @@ namespace library
                 PCSTR pszShaderModel
                   Specifies the shader target or set of shader features
                   to compile against
-      Modifies: [m_vertexShader].
+                UINT uFeatures
+                  Mask of the eShaderFeature the source compiles in or
+                  out
+      Modifies: [m_aVertexShaders, m_aVertexLayouts].
     M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
 
-    VertexShader::VertexShader(_In_ PCWSTR pszFileName, _In_ PCSTR pszEntryPoint, _In_ PCSTR pszShaderModel)
-        :Shader(pszFileName, pszEntryPoint, pszShaderModel),
-        m_vertexLayout(nullptr),
-        m_vertexShader(nullptr)
+    VertexShader::VertexShader(_In_ PCWSTR pszFileName, _In_ PCSTR pszEntryPoint, _In_ PCSTR pszShaderModel, _In_ UINT uFeatures)
+        :Shader(pszFileName, pszEntryPoint, pszShaderModel, uFeatures),
+        m_aVertexShaders(),
+        m_aVertexLayouts()
     {
     }
 
     /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
       Method:   VertexShader::Initialize
-      Summary:  Initializes the vertex shader and the input layout
+      Summary:  Initializes every permutation of the vertex shader and
+                its input layout
       Args:     ID3D11Device* pDevice
                   The Direct3D device to create the vertex shader
+      Modifies: [m_aVertexShaders, m_aVertexLayouts].
       Returns:  HRESULT
                   Status code
     M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
@@ -35,26 +40,65 @@ namespace library
     HRESULT VertexShader::Initialize(_In_ ID3D11Device* pDevice)
     {
         HRESULT hr = S_OK;
-        ComPtr<ID3DBlob> VSBlob;
 
-        // Compile a vertex shader
-        hr = compile(VSBlob.GetAddressOf());
-        if (FAILED(hr))
+        if (!pDevice)
         {
-            return hr;
+            return S_OK;
         }
 
-        // Create the Direct3D Vertex Shader object
-        hr = pDevice->CreateVertexShader(VSBlob->GetBufferPointer(),
-            VSBlob->GetBufferSize(),
-            nullptr,
-            m_vertexShader.GetAddressOf()
-        );
-        if (FAILED(hr))
+        for (UINT uPermutation = 0u; uPermutation < MAX_NUM_PERMUTATIONS; ++uPermutation)
         {
-            return hr;
+            if (!hasPermutation(uPermutation))
+            {
+                continue;
+            }
+
+            // Compile a vertex shader
+            ComPtr<ID3DBlob> VSBlob;
+            hr = compile(VSBlob.GetAddressOf(), uPermutation);
+            if (FAILED(hr))
+            {
+                return hr;
+            }
+
+            // Create the Direct3D Vertex Shader object
+            hr = pDevice->CreateVertexShader(VSBlob->GetBufferPointer(),
+                VSBlob->GetBufferSize(),
+                nullptr,
+                m_aVertexShaders[uPermutation].ReleaseAndGetAddressOf()
+            );
+            if (FAILED(hr))
+            {
+                return hr;
+            }
+
+            hr = createInputLayout(pDevice, VSBlob.Get(), m_aVertexLayouts[uPermutation].ReleaseAndGetAddressOf());
+            if (FAILED(hr))
+            {
+                return hr;
+            }
         }
 
+        return S_OK;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   VertexShader::createInputLayout
+      Summary:  Creates the input layout of a compiled permutation. The
+                layout holds the elements of every permutation, those a
+                permutation does not read are ignored
+      Args:     ID3D11Device* pDevice
+                  The Direct3D device to create the input layout
+                ID3DBlob* pBlob
+                  Bytecode of the permutation
+                ID3D11InputLayout** ppInputLayout
+                  Receives the input layout
+      Returns:  HRESULT
+                  Status code
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+
+    HRESULT VertexShader::createInputLayout(_In_ ID3D11Device* pDevice, _In_ ID3DBlob* pBlob, _Outptr_ ID3D11InputLayout** ppInputLayout)
+    {
         // Define the input layout
         D3D11_INPUT_ELEMENT_DESC layout[] =
         {
@@ -66,46 +110,48 @@ namespace library
             { "INSTANCE_TRANSFORM", 0, DXGI_FORMAT_R32G32B32A32_FLOAT, 2, 0, D3D11_INPUT_PER_INSTANCE_DATA, 1 },
             { "INSTANCE_TRANSFORM", 1, DXGI_FORMAT_R32G32B32A32_FLOAT, 2, 16, D3D11_INPUT_PER_INSTANCE_DATA, 1 },
             { "INSTANCE_TRANSFORM", 2, DXGI_FORMAT_R32G32B32A32_FLOAT, 2, 32, D3D11_INPUT_PER_INSTANCE_DATA, 1 },
-            { "INSTANCE_TRANSFORM", 3, DXGI_FORMAT_R32G32B32A32_FLOAT, 2, 48, D3D11_INPUT_PER_INSTANCE_DATA, 1 }
+            { "INSTANCE_TRANSFORM", 3, DXGI_FORMAT_R32G32B32A32_FLOAT, 2, 48, D3D11_INPUT_PER_INSTANCE_DATA, 1 },
+            { "INSTANCE_MATERIAL", 0, DXGI_FORMAT_R32_UINT, 2, 64, D3D11_INPUT_PER_INSTANCE_DATA, 1 }
 
         };
         UINT numElements = ARRAYSIZE(layout);
 
         // Create the input layout
-        hr = pDevice->CreateInputLayout(layout,
+        return pDevice->CreateInputLayout(layout,
             numElements,
-            VSBlob->GetBufferPointer(),
-            VSBlob->GetBufferSize(),
-            &m_vertexLayout
+            pBlob->GetBufferPointer(),
+            pBlob->GetBufferSize(),
+            ppInputLayout
         );
-        if (FAILED(hr))
-            return hr;
-
-
-        return hr;
     }
 
     /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
       Method:   VertexShader::GetVertexShader
-      Summary:  Returns the vertex shader
+      Summary:  Returns the permutation of the vertex shader drawing a
+                set of features
+      Args:     UINT uFeatures
+                  Mask of eShaderFeature of the object drawn
       Returns:  ComPtr<ID3D11VertexShader>&
                   Vertex shader. Could be a nullptr
     M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
 
-    ComPtr<ID3D11VertexShader>& VertexShader::GetVertexShader()
+    ComPtr<ID3D11VertexShader>& VertexShader::GetVertexShader(_In_ UINT uFeatures)
     {
-        return m_vertexShader;
+        return m_aVertexShaders[GetPermutation(uFeatures)];
     }
 
     /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
       Method:   VertexShader::GetVertexLayout
-      Summary:  Returns the vertex input layout
+      Summary:  Returns the vertex input layout of the permutation
+                drawing a set of features
+      Args:     UINT uFeatures
+                  Mask of eShaderFeature of the object drawn
       Returns:  ComPtr<ID3D11InputLayout>&
                   Vertex input layout
     M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
 
-    ComPtr<ID3D11InputLayout>& VertexShader::GetVertexLayout()
+    ComPtr<ID3D11InputLayout>& VertexShader::GetVertexLayout(_In_ UINT uFeatures)
     {
-        return m_vertexLayout;
+        return m_aVertexLayouts[GetPermutation(uFeatures)];
     }
 }
\ No newline at end of file
@@ -18,11 +18,15 @@ namespace library
       Class:    VertexShader
       Summary:  Vertex shader
       Methods:  Initialize
-                  Initializes the vertex shader and the input layout
+                  Initializes the permutations of the vertex shader and
+                  their input layouts
                 GetVertexShader
-                  Returns the vertex shader
+                  Returns the permutation of the vertex shader drawing
+                  a set of features
                 GetVertexLayout
-                  Returns the vertex input layout
+                  Returns the vertex input layout of a permutation
+                createInputLayout
+                  Creates the input layout of a compiled permutation
                 Game
                   Constructor.
                 ~Game
@@ -32,7 +36,7 @@ namespace library
     {
     public:
         VertexShader() = delete;
-        VertexShader(_In_ PCWSTR pszFileName, _In_ PCSTR pszEntryPoint, _In_ PCSTR pszShaderModel);
+        VertexShader(_In_ PCWSTR pszFileName, _In_ PCSTR pszEntryPoint, _In_ PCSTR pszShaderModel, _In_ UINT uFeatures = 0u);
         VertexShader(const VertexShader& other) = delete;
         VertexShader(VertexShader&& other) = delete;
         VertexShader& operator=(const VertexShader& other) = delete;
@@ -41,11 +45,13 @@ namespace library
 
         virtual HRESULT Initialize(_In_ ID3D11Device* pDevice) override;
 
-        ComPtr<ID3D11VertexShader>& GetVertexShader();
-        ComPtr<ID3D11InputLayout>& GetVertexLayout();
+        ComPtr<ID3D11VertexShader>& GetVertexShader(_In_ UINT uFeatures = 0u);
+        ComPtr<ID3D11InputLayout>& GetVertexLayout(_In_ UINT uFeatures = 0u);
 
     protected:
-        ComPtr<ID3D11VertexShader> m_vertexShader;
-        ComPtr<ID3D11InputLayout> m_vertexLayout;
+        virtual HRESULT createInputLayout(_In_ ID3D11Device* pDevice, _In_ ID3DBlob* pBlob, _Outptr_ ID3D11InputLayout** ppInputLayout);
+
+        ComPtr<ID3D11VertexShader> m_aVertexShaders[MAX_NUM_PERMUTATIONS];
+        ComPtr<ID3D11InputLayout> m_aVertexLayouts[MAX_NUM_PERMUTATIONS];
     };
 }
\ No newline at end of file
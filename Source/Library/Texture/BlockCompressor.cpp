@@ -0,0 +1,629 @@
+#include "Texture/BlockCompressor.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace library
+{
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   BlockCompressor::CompressBC1
+      Summary:  Encodes the colors of a block in the four color mode,
+                alpha is ignored
+      Args:     const BYTE* pTexels
+                  16 RGBA8 texels
+                BYTE* pBlock
+                  8 bytes of the encoded block
+      Modifies: [pBlock].
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    void BlockCompressor::CompressBC1(_In_reads_(64) const BYTE* pTexels, _Out_writes_bytes_(8) BYTE* pBlock)
+    {
+        FLOAT aTexels[NUM_BLOCK_TEXELS * 4u];
+        for (UINT i = 0u; i < NUM_BLOCK_TEXELS * 4u; ++i)
+        {
+            aTexels[i] = static_cast<FLOAT>(pTexels[i]);
+        }
+
+        FLOAT aMean[4];
+        FLOAT aAxis[4];
+        findPrincipalAxis(aTexels, 3u, aMean, aAxis);
+
+        FLOAT fMin = 0.0f;
+        FLOAT fMax = 0.0f;
+        for (UINT i = 0u; i < NUM_BLOCK_TEXELS; ++i)
+        {
+            FLOAT fProjection = 0.0f;
+            for (UINT c = 0u; c < 3u; ++c)
+            {
+                fProjection += (aTexels[i * 4u + c] - aMean[c]) * aAxis[c];
+            }
+            fMin = std::min(fMin, fProjection);
+            fMax = std::max(fMax, fProjection);
+        }
+
+        FLOAT aColor0[3];
+        FLOAT aColor1[3];
+        for (UINT c = 0u; c < 3u; ++c)
+        {
+            aColor0[c] = aMean[c] + aAxis[c] * fMax;
+            aColor1[c] = aMean[c] + aAxis[c] * fMin;
+        }
+
+        UINT16 uColor0 = packRGB565(aColor0);
+        UINT16 uColor1 = packRGB565(aColor1);
+        UINT auIndices[NUM_BLOCK_TEXELS];
+        FLOAT fError = fitBC1(aTexels, uColor0, uColor1, auIndices);
+
+        // Least squares fit of the endpoints to the texels, given the palette entries they picked
+        static constexpr const FLOAT WEIGHTS[] = { 1.0f, 0.0f, 2.0f / 3.0f, 1.0f / 3.0f };
+        for (UINT uIteration = 0u; uIteration < 2u; ++uIteration)
+        {
+            FLOAT fAlpha2 = 0.0f;
+            FLOAT fBeta2 = 0.0f;
+            FLOAT fAlphaBeta = 0.0f;
+            FLOAT aAlphaX[3] = {};
+            FLOAT aBetaX[3] = {};
+            for (UINT i = 0u; i < NUM_BLOCK_TEXELS; ++i)
+            {
+                const FLOAT fAlpha = WEIGHTS[auIndices[i]];
+                const FLOAT fBeta = 1.0f - fAlpha;
+                fAlpha2 += fAlpha * fAlpha;
+                fBeta2 += fBeta * fBeta;
+                fAlphaBeta += fAlpha * fBeta;
+                for (UINT c = 0u; c < 3u; ++c)
+                {
+                    aAlphaX[c] += fAlpha * aTexels[i * 4u + c];
+                    aBetaX[c] += fBeta * aTexels[i * 4u + c];
+                }
+            }
+
+            const FLOAT fDeterminant = fAlpha2 * fBeta2 - fAlphaBeta * fAlphaBeta;
+            if (std::fabs(fDeterminant) < 1e-6f)
+            {
+                break;
+            }
+
+            for (UINT c = 0u; c < 3u; ++c)
+            {
+                aColor0[c] = (aAlphaX[c] * fBeta2 - aBetaX[c] * fAlphaBeta) / fDeterminant;
+                aColor1[c] = (aBetaX[c] * fAlpha2 - aAlphaX[c] * fAlphaBeta) / fDeterminant;
+            }
+
+            const UINT16 uRefinedColor0 = packRGB565(aColor0);
+            const UINT16 uRefinedColor1 = packRGB565(aColor1);
+            if (uRefinedColor0 == uColor0 && uRefinedColor1 == uColor1)
+            {
+                break;
+            }
+
+            UINT auRefinedIndices[NUM_BLOCK_TEXELS];
+            const FLOAT fRefinedError = fitBC1(aTexels, uRefinedColor0, uRefinedColor1, auRefinedIndices);
+            if (fRefinedError >= fError)
+            {
+                break;
+            }
+
+            uColor0 = uRefinedColor0;
+            uColor1 = uRefinedColor1;
+            std::copy(auRefinedIndices, auRefinedIndices + NUM_BLOCK_TEXELS, auIndices);
+            fError = fRefinedError;
+        }
+
+        // The first endpoint must be the greater one for the four color mode, swapping them swaps the thirds
+        if (uColor0 < uColor1)
+        {
+            std::swap(uColor0, uColor1);
+            for (UINT i = 0u; i < NUM_BLOCK_TEXELS; ++i)
+            {
+                auIndices[i] ^= 1u;
+            }
+        }
+        else if (uColor0 == uColor1)
+        {
+            std::fill(auIndices, auIndices + NUM_BLOCK_TEXELS, 0u);
+        }
+
+        UINT uIndexBits = 0u;
+        for (UINT i = 0u; i < NUM_BLOCK_TEXELS; ++i)
+        {
+            uIndexBits |= auIndices[i] << (i * 2u);
+        }
+
+        pBlock[0] = static_cast<BYTE>(uColor0 & 0xFFu);
+        pBlock[1] = static_cast<BYTE>(uColor0 >> 8u);
+        pBlock[2] = static_cast<BYTE>(uColor1 & 0xFFu);
+        pBlock[3] = static_cast<BYTE>(uColor1 >> 8u);
+        for (UINT i = 0u; i < 4u; ++i)
+        {
+            pBlock[4u + i] = static_cast<BYTE>((uIndexBits >> (i * 8u)) & 0xFFu);
+        }
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   BlockCompressor::CompressBC3
+      Summary:  Encodes the alphas of a block as BC4 followed by its
+                colors as BC1
+      Args:     const BYTE* pTexels
+                  16 RGBA8 texels
+                BYTE* pBlock
+                  16 bytes of the encoded block
+      Modifies: [pBlock].
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    void BlockCompressor::CompressBC3(_In_reads_(64) const BYTE* pTexels, _Out_writes_bytes_(16) BYTE* pBlock)
+    {
+        CompressBC4(pTexels, 3u, pBlock);
+        CompressBC1(pTexels, pBlock + 8u);
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   BlockCompressor::CompressBC4
+      Summary:  Encodes one channel of a block between its minimum and
+                maximum, in the eight value mode
+      Args:     const BYTE* pTexels
+                  16 RGBA8 texels
+                UINT uChannel
+                  Channel to encode, 0 to 3
+                BYTE* pBlock
+                  8 bytes of the encoded block
+      Modifies: [pBlock].
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    void BlockCompressor::CompressBC4(_In_reads_(64) const BYTE* pTexels, _In_ UINT uChannel, _Out_writes_bytes_(8) BYTE* pBlock)
+    {
+        UINT uMin = 255u;
+        UINT uMax = 0u;
+        for (UINT i = 0u; i < NUM_BLOCK_TEXELS; ++i)
+        {
+            uMin = std::min(uMin, static_cast<UINT>(pTexels[i * 4u + uChannel]));
+            uMax = std::max(uMax, static_cast<UINT>(pTexels[i * 4u + uChannel]));
+        }
+
+        pBlock[0] = static_cast<BYTE>(uMax);
+        pBlock[1] = static_cast<BYTE>(uMin);
+
+        UINT64 uIndexBits = 0u;
+        if (uMax > uMin)
+        {
+            FLOAT aPalette[8];
+            aPalette[0] = static_cast<FLOAT>(uMax);
+            aPalette[1] = static_cast<FLOAT>(uMin);
+            for (UINT i = 2u; i < 8u; ++i)
+            {
+                aPalette[i] = (static_cast<FLOAT>(8u - i) * static_cast<FLOAT>(uMax) + static_cast<FLOAT>(i - 1u) * static_cast<FLOAT>(uMin)) / 7.0f;
+            }
+
+            for (UINT i = 0u; i < NUM_BLOCK_TEXELS; ++i)
+            {
+                const FLOAT fValue = static_cast<FLOAT>(pTexels[i * 4u + uChannel]);
+                UINT uIndex = 0u;
+                FLOAT fBestError = std::fabs(fValue - aPalette[0]);
+                for (UINT j = 1u; j < 8u; ++j)
+                {
+                    const FLOAT fError = std::fabs(fValue - aPalette[j]);
+                    if (fError < fBestError)
+                    {
+                        fBestError = fError;
+                        uIndex = j;
+                    }
+                }
+                uIndexBits |= static_cast<UINT64>(uIndex) << (i * 3u);
+            }
+        }
+
+        for (UINT i = 0u; i < 6u; ++i)
+        {
+            pBlock[2u + i] = static_cast<BYTE>((uIndexBits >> (i * 8u)) & 0xFFu);
+        }
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   BlockCompressor::CompressBC5
+      Summary:  Encodes the red and green channels of a block as two
+                BC4 blocks, the X and Y of a normal map
+      Args:     const BYTE* pTexels
+                  16 RGBA8 texels
+                BYTE* pBlock
+                  16 bytes of the encoded block
+      Modifies: [pBlock].
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    void BlockCompressor::CompressBC5(_In_reads_(64) const BYTE* pTexels, _Out_writes_bytes_(16) BYTE* pBlock)
+    {
+        CompressBC4(pTexels, 0u, pBlock);
+        CompressBC4(pTexels, 1u, pBlock + 8u);
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   BlockCompressor::CompressBC7
+      Summary:  Encodes the colors and alphas of a block in mode 6,
+                7-bit RGBA endpoints with a shared bit each and 4-bit
+                indices
+      Args:     const BYTE* pTexels
+                  16 RGBA8 texels
+                BYTE* pBlock
+                  16 bytes of the encoded block
+      Modifies: [pBlock].
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    void BlockCompressor::CompressBC7(_In_reads_(64) const BYTE* pTexels, _Out_writes_bytes_(16) BYTE* pBlock)
+    {
+        FLOAT aTexels[NUM_BLOCK_TEXELS * 4u];
+        for (UINT i = 0u; i < NUM_BLOCK_TEXELS * 4u; ++i)
+        {
+            aTexels[i] = static_cast<FLOAT>(pTexels[i]);
+        }
+
+        FLOAT aMean[4];
+        FLOAT aAxis[4];
+        findPrincipalAxis(aTexels, 4u, aMean, aAxis);
+
+        FLOAT fMin = 0.0f;
+        FLOAT fMax = 0.0f;
+        for (UINT i = 0u; i < NUM_BLOCK_TEXELS; ++i)
+        {
+            FLOAT fProjection = 0.0f;
+            for (UINT c = 0u; c < 4u; ++c)
+            {
+                fProjection += (aTexels[i * 4u + c] - aMean[c]) * aAxis[c];
+            }
+            fMin = std::min(fMin, fProjection);
+            fMax = std::max(fMax, fProjection);
+        }
+
+        FLOAT aEndpoints[8];
+        for (UINT c = 0u; c < 4u; ++c)
+        {
+            aEndpoints[c] = aMean[c] + aAxis[c] * fMin;
+            aEndpoints[4u + c] = aMean[c] + aAxis[c] * fMax;
+        }
+
+        UINT auEndpoints[8];
+        quantizeBC7(aEndpoints, auEndpoints);
+        quantizeBC7(aEndpoints + 4u, auEndpoints + 4u);
+        UINT auIndices[NUM_BLOCK_TEXELS];
+        FLOAT fError = fitBC7(aTexels, auEndpoints, auIndices);
+
+        // Least squares fit of the endpoints to the texels, given the palette entries they picked
+        for (UINT uIteration = 0u; uIteration < 2u; ++uIteration)
+        {
+            FLOAT fAlpha2 = 0.0f;
+            FLOAT fBeta2 = 0.0f;
+            FLOAT fAlphaBeta = 0.0f;
+            FLOAT aAlphaX[4] = {};
+            FLOAT aBetaX[4] = {};
+            for (UINT i = 0u; i < NUM_BLOCK_TEXELS; ++i)
+            {
+                const FLOAT fBeta = static_cast<FLOAT>(BC7_WEIGHTS[auIndices[i]]) / 64.0f;
+                const FLOAT fAlpha = 1.0f - fBeta;
+                fAlpha2 += fAlpha * fAlpha;
+                fBeta2 += fBeta * fBeta;
+                fAlphaBeta += fAlpha * fBeta;
+                for (UINT c = 0u; c < 4u; ++c)
+                {
+                    aAlphaX[c] += fAlpha * aTexels[i * 4u + c];
+                    aBetaX[c] += fBeta * aTexels[i * 4u + c];
+                }
+            }
+
+            const FLOAT fDeterminant = fAlpha2 * fBeta2 - fAlphaBeta * fAlphaBeta;
+            if (std::fabs(fDeterminant) < 1e-6f)
+            {
+                break;
+            }
+
+            for (UINT c = 0u; c < 4u; ++c)
+            {
+                aEndpoints[c] = (aAlphaX[c] * fBeta2 - aBetaX[c] * fAlphaBeta) / fDeterminant;
+                aEndpoints[4u + c] = (aBetaX[c] * fAlpha2 - aAlphaX[c] * fAlphaBeta) / fDeterminant;
+            }
+
+            UINT auRefinedEndpoints[8];
+            quantizeBC7(aEndpoints, auRefinedEndpoints);
+            quantizeBC7(aEndpoints + 4u, auRefinedEndpoints + 4u);
+            UINT auRefinedIndices[NUM_BLOCK_TEXELS];
+            const FLOAT fRefinedError = fitBC7(aTexels, auRefinedEndpoints, auRefinedIndices);
+            if (fRefinedError >= fError)
+            {
+                break;
+            }
+
+            std::copy(auRefinedEndpoints, auRefinedEndpoints + 8u, auEndpoints);
+            std::copy(auRefinedIndices, auRefinedIndices + NUM_BLOCK_TEXELS, auIndices);
+            fError = fRefinedError;
+        }
+
+        // The index of the first texel is stored without its high bit, swapping the endpoints mirrors the indices
+        if (auIndices[0] >= 8u)
+        {
+            for (UINT c = 0u; c < 4u; ++c)
+            {
+                std::swap(auEndpoints[c], auEndpoints[4u + c]);
+            }
+            for (UINT i = 0u; i < NUM_BLOCK_TEXELS; ++i)
+            {
+                auIndices[i] = 15u - auIndices[i];
+            }
+        }
+
+        std::fill(pBlock, pBlock + 16u, static_cast<BYTE>(0u));
+        UINT uOffset = 0u;
+        writeBits(pBlock, uOffset, 1u << 6u, 7u);
+        for (UINT c = 0u; c < 4u; ++c)
+        {
+            writeBits(pBlock, uOffset, auEndpoints[c] >> 1u, 7u);
+            writeBits(pBlock, uOffset, auEndpoints[4u + c] >> 1u, 7u);
+        }
+        writeBits(pBlock, uOffset, auEndpoints[0] & 1u, 1u);
+        writeBits(pBlock, uOffset, auEndpoints[4] & 1u, 1u);
+        for (UINT i = 0u; i < NUM_BLOCK_TEXELS; ++i)
+        {
+            writeBits(pBlock, uOffset, auIndices[i], i == 0u ? 3u : 4u);
+        }
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   BlockCompressor::findPrincipalAxis
+      Summary:  Computes the mean of the texels and the direction they
+                vary the most along, by power iteration on their
+                covariance
+      Args:     const FLOAT* pTexels
+                  16 RGBA texels
+                UINT uNumChannels
+                  Channels taken into account, 3 or 4
+                FLOAT* pMean
+                  Mean of the texels
+                FLOAT* pAxis
+                  Unit axis, zero for a block of a single color
+      Modifies: [pMean, pAxis].
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    void BlockCompressor::findPrincipalAxis(_In_reads_(64) const FLOAT* pTexels, _In_ UINT uNumChannels, _Out_writes_(4) FLOAT* pMean, _Out_writes_(4) FLOAT* pAxis)
+    {
+        FLOAT aMin[4] = { 255.0f, 255.0f, 255.0f, 255.0f };
+        FLOAT aMax[4] = {};
+        for (UINT c = 0u; c < 4u; ++c)
+        {
+            pMean[c] = 0.0f;
+            pAxis[c] = 0.0f;
+        }
+        for (UINT i = 0u; i < NUM_BLOCK_TEXELS; ++i)
+        {
+            for (UINT c = 0u; c < uNumChannels; ++c)
+            {
+                pMean[c] += pTexels[i * 4u + c] / static_cast<FLOAT>(NUM_BLOCK_TEXELS);
+                aMin[c] = std::min(aMin[c], pTexels[i * 4u + c]);
+                aMax[c] = std::max(aMax[c], pTexels[i * 4u + c]);
+            }
+        }
+
+        FLOAT aCovariance[4][4] = {};
+        for (UINT i = 0u; i < NUM_BLOCK_TEXELS; ++i)
+        {
+            for (UINT r = 0u; r < uNumChannels; ++r)
+            {
+                for (UINT c = 0u; c < uNumChannels; ++c)
+                {
+                    aCovariance[r][c] += (pTexels[i * 4u + r] - pMean[r]) * (pTexels[i * 4u + c] - pMean[c]);
+                }
+            }
+        }
+
+        // Starting from the diagonal of the bounding box converges in a few steps for most blocks
+        FLOAT aVector[4] = {};
+        for (UINT c = 0u; c < uNumChannels; ++c)
+        {
+            aVector[c] = aMax[c] - aMin[c];
+        }
+        for (UINT uIteration = 0u; uIteration < 8u; ++uIteration)
+        {
+            FLOAT aProduct[4] = {};
+            FLOAT fLengthSquared = 0.0f;
+            for (UINT r = 0u; r < uNumChannels; ++r)
+            {
+                for (UINT c = 0u; c < uNumChannels; ++c)
+                {
+                    aProduct[r] += aCovariance[r][c] * aVector[c];
+                }
+                fLengthSquared += aProduct[r] * aProduct[r];
+            }
+            if (fLengthSquared < 1e-12f)
+            {
+                break;
+            }
+
+            const FLOAT fInverseLength = 1.0f / std::sqrt(fLengthSquared);
+            for (UINT c = 0u; c < uNumChannels; ++c)
+            {
+                aVector[c] = aProduct[c] * fInverseLength;
+                pAxis[c] = aVector[c];
+            }
+        }
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   BlockCompressor::fitBC1
+      Summary:  Picks the nearest entry of the four color palette of two
+                endpoints for every texel
+      Args:     const FLOAT* pTexels
+                  16 RGBA texels
+                UINT16 uColor0, uColor1
+                  RGB565 endpoints
+                UINT* puIndices
+                  Palette entry of every texel
+      Modifies: [puIndices].
+      Returns:  FLOAT
+                  Sum of the squared errors of the block
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    FLOAT BlockCompressor::fitBC1(_In_reads_(64) const FLOAT* pTexels, _In_ UINT16 uColor0, _In_ UINT16 uColor1, _Out_writes_(16) UINT* puIndices)
+    {
+        FLOAT aPalette[4][3];
+        unpackRGB565(uColor0, aPalette[0]);
+        unpackRGB565(uColor1, aPalette[1]);
+        for (UINT c = 0u; c < 3u; ++c)
+        {
+            aPalette[2][c] = (2.0f * aPalette[0][c] + aPalette[1][c]) / 3.0f;
+            aPalette[3][c] = (aPalette[0][c] + 2.0f * aPalette[1][c]) / 3.0f;
+        }
+
+        FLOAT fTotalError = 0.0f;
+        for (UINT i = 0u; i < NUM_BLOCK_TEXELS; ++i)
+        {
+            FLOAT fBestError = 0.0f;
+            for (UINT j = 0u; j < 4u; ++j)
+            {
+                FLOAT fError = 0.0f;
+                for (UINT c = 0u; c < 3u; ++c)
+                {
+                    const FLOAT fDifference = pTexels[i * 4u + c] - aPalette[j][c];
+                    fError += fDifference * fDifference;
+                }
+                if (j == 0u || fError < fBestError)
+                {
+                    fBestError = fError;
+                    puIndices[i] = j;
+                }
+            }
+            fTotalError += fBestError;
+        }
+
+        return fTotalError;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   BlockCompressor::fitBC7
+      Summary:  Picks the nearest entry of the 16 entry palette of two
+                mode 6 endpoints for every texel
+      Args:     const FLOAT* pTexels
+                  16 RGBA texels
+                const UINT* puEndpoints
+                  RGBA8 values of both endpoints
+                UINT* puIndices
+                  Palette entry of every texel
+      Modifies: [puIndices].
+      Returns:  FLOAT
+                  Sum of the squared errors of the block
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    FLOAT BlockCompressor::fitBC7(_In_reads_(64) const FLOAT* pTexels, _In_reads_(8) const UINT* puEndpoints, _Out_writes_(16) UINT* puIndices)
+    {
+        FLOAT aPalette[16][4];
+        for (UINT j = 0u; j < 16u; ++j)
+        {
+            for (UINT c = 0u; c < 4u; ++c)
+            {
+                aPalette[j][c] = static_cast<FLOAT>(((64u - BC7_WEIGHTS[j]) * puEndpoints[c] + BC7_WEIGHTS[j] * puEndpoints[4u + c] + 32u) >> 6u);
+            }
+        }
+
+        FLOAT fTotalError = 0.0f;
+        for (UINT i = 0u; i < NUM_BLOCK_TEXELS; ++i)
+        {
+            FLOAT fBestError = 0.0f;
+            for (UINT j = 0u; j < 16u; ++j)
+            {
+                FLOAT fError = 0.0f;
+                for (UINT c = 0u; c < 4u; ++c)
+                {
+                    const FLOAT fDifference = pTexels[i * 4u + c] - aPalette[j][c];
+                    fError += fDifference * fDifference;
+                }
+                if (j == 0u || fError < fBestError)
+                {
+                    fBestError = fError;
+                    puIndices[i] = j;
+                }
+            }
+            fTotalError += fBestError;
+        }
+
+        return fTotalError;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   BlockCompressor::quantizeBC7
+      Summary:  Rounds an endpoint to 7 bits per channel and the shared
+                low bit that brings it the closest
+      Args:     const FLOAT* pEndpoint
+                  RGBA endpoint, 0 to 255
+                UINT* puEndpoint
+                  RGBA8 value of the endpoint, the low bit shared
+      Modifies: [puEndpoint].
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    void BlockCompressor::quantizeBC7(_In_reads_(4) const FLOAT* pEndpoint, _Out_writes_(4) UINT* puEndpoint)
+    {
+        FLOAT fBestError = 0.0f;
+        for (UINT uBit = 0u; uBit < 2u; ++uBit)
+        {
+            UINT auCandidate[4];
+            FLOAT fError = 0.0f;
+            for (UINT c = 0u; c < 4u; ++c)
+            {
+                const FLOAT fHigh = std::clamp(std::round((pEndpoint[c] - static_cast<FLOAT>(uBit)) / 2.0f), 0.0f, 127.0f);
+                auCandidate[c] = (static_cast<UINT>(fHigh) << 1u) | uBit;
+                const FLOAT fDifference = pEndpoint[c] - static_cast<FLOAT>(auCandidate[c]);
+                fError += fDifference * fDifference;
+            }
+            if (uBit == 0u || fError < fBestError)
+            {
+                fBestError = fError;
+                std::copy(auCandidate, auCandidate + 4u, puEndpoint);
+            }
+        }
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   BlockCompressor::packRGB565
+      Summary:  Rounds a color to 5, 6 and 5 bits
+      Args:     const FLOAT* pColor
+                  RGB color, 0 to 255
+      Returns:  UINT16
+                  RGB565 color, red in the high bits
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    UINT16 BlockCompressor::packRGB565(_In_reads_(3) const FLOAT* pColor)
+    {
+        const UINT uRed = static_cast<UINT>(std::clamp(std::round(pColor[0] * 31.0f / 255.0f), 0.0f, 31.0f));
+        const UINT uGreen = static_cast<UINT>(std::clamp(std::round(pColor[1] * 63.0f / 255.0f), 0.0f, 63.0f));
+        const UINT uBlue = static_cast<UINT>(std::clamp(std::round(pColor[2] * 31.0f / 255.0f), 0.0f, 31.0f));
+
+        return static_cast<UINT16>((uRed << 11u) | (uGreen << 5u) | uBlue);
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   BlockCompressor::unpackRGB565
+      Summary:  Expands a RGB565 color to 8 bits per channel by
+                replicating its high bits, as the hardware does
+      Args:     UINT16 uColor
+                  RGB565 color
+                FLOAT* pColor
+                  RGB color, 0 to 255
+      Modifies: [pColor].
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    void BlockCompressor::unpackRGB565(_In_ UINT16 uColor, _Out_writes_(3) FLOAT* pColor)
+    {
+        const UINT uRed = (uColor >> 11u) & 0x1Fu;
+        const UINT uGreen = (uColor >> 5u) & 0x3Fu;
+        const UINT uBlue = uColor & 0x1Fu;
+
+        pColor[0] = static_cast<FLOAT>((uRed << 3u) | (uRed >> 2u));
+        pColor[1] = static_cast<FLOAT>((uGreen << 2u) | (uGreen >> 4u));
+        pColor[2] = static_cast<FLOAT>((uBlue << 3u) | (uBlue >> 2u));
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   BlockCompressor::writeBits
+      Summary:  Appends a field to a block, lowest bit first
+      Args:     BYTE* pBlock
+                  16 bytes of the block, zeroed beforehand
+                UINT& uOffset
+                  Bit the field starts at, advanced past it
+                UINT uValue
+                  Value of the field
+                UINT uNumBits
+                  Width of the field
+      Modifies: [pBlock, uOffset].
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    void BlockCompressor::writeBits(_Inout_updates_(16) BYTE* pBlock, _Inout_ UINT& uOffset, _In_ UINT uValue, _In_ UINT uNumBits)
+    {
+        for (UINT i = 0u; i < uNumBits; ++i, ++uOffset)
+        {
+            if ((uValue >> i) & 1u)
+            {
+                pBlock[uOffset / 8u] |= static_cast<BYTE>(1u << (uOffset % 8u));
+            }
+        }
+    }
+}
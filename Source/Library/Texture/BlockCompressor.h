@@ -0,0 +1,68 @@
+﻿/*+===================================================================
+  File:      BLOCKCOMPRESSOR.H
+
+  Summary:   BlockCompressor header file contains declarations of the
+             BlockCompressor class that encodes 4x4 texel blocks into
+             the BC1, BC3, BC4, BC5 and BC7 formats.
+
+  Classes: BlockCompressor
+
+  © 2022 Kyung Hee University
+===================================================================+*/
+#pragma once
+
+#include "Common.h"
+
+namespace library
+{
+    /*C+C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C
+      Class:    BlockCompressor
+
+      Summary:  CPU encoder of the block compressed formats. A block is
+                16 RGBA8 texels in rows of four. Endpoints are fitted
+                along the principal axis of the texels, then refined by
+                least squares over the chosen indices. BC7 blocks are
+                encoded in mode 6, one RGBA subset with 16 indices
+
+      Methods:  CompressBC1
+                  Encodes the colors of a block
+                CompressBC3
+                  Encodes the colors and alphas of a block
+                CompressBC4
+                  Encodes one channel of a block
+                CompressBC5
+                  Encodes the red and green channels of a block
+                CompressBC7
+                  Encodes the colors and alphas of a block in mode 6
+    C---C---C---C---C---C---C---C---C---C---C---C---C---C---C---C---C-C*/
+    class BlockCompressor final
+    {
+    public:
+        static constexpr UINT NUM_BLOCK_TEXELS = 16u;
+
+    public:
+        BlockCompressor() = delete;
+        BlockCompressor(const BlockCompressor& other) = delete;
+        BlockCompressor(BlockCompressor&& other) = delete;
+        BlockCompressor& operator=(const BlockCompressor& other) = delete;
+        BlockCompressor& operator=(BlockCompressor&& other) = delete;
+        ~BlockCompressor() = delete;
+
+        static void CompressBC1(_In_reads_(64) const BYTE* pTexels, _Out_writes_bytes_(8) BYTE* pBlock);
+        static void CompressBC3(_In_reads_(64) const BYTE* pTexels, _Out_writes_bytes_(16) BYTE* pBlock);
+        static void CompressBC4(_In_reads_(64) const BYTE* pTexels, _In_ UINT uChannel, _Out_writes_bytes_(8) BYTE* pBlock);
+        static void CompressBC5(_In_reads_(64) const BYTE* pTexels, _Out_writes_bytes_(16) BYTE* pBlock);
+        static void CompressBC7(_In_reads_(64) const BYTE* pTexels, _Out_writes_bytes_(16) BYTE* pBlock);
+
+    private:
+        static constexpr UINT BC7_WEIGHTS[16] = { 0u, 4u, 9u, 13u, 17u, 21u, 26u, 30u, 34u, 38u, 43u, 47u, 51u, 55u, 60u, 64u };
+
+        static void findPrincipalAxis(_In_reads_(64) const FLOAT* pTexels, _In_ UINT uNumChannels, _Out_writes_(4) FLOAT* pMean, _Out_writes_(4) FLOAT* pAxis);
+        static FLOAT fitBC1(_In_reads_(64) const FLOAT* pTexels, _In_ UINT16 uColor0, _In_ UINT16 uColor1, _Out_writes_(16) UINT* puIndices);
+        static FLOAT fitBC7(_In_reads_(64) const FLOAT* pTexels, _In_reads_(8) const UINT* puEndpoints, _Out_writes_(16) UINT* puIndices);
+        static void quantizeBC7(_In_reads_(4) const FLOAT* pEndpoint, _Out_writes_(4) UINT* puEndpoint);
+        static UINT16 packRGB565(_In_reads_(3) const FLOAT* pColor);
+        static void unpackRGB565(_In_ UINT16 uColor, _Out_writes_(3) FLOAT* pColor);
+        static void writeBits(_Inout_updates_(16) BYTE* pBlock, _Inout_ UINT& uOffset, _In_ UINT uValue, _In_ UINT uNumBits);
+    };
+}
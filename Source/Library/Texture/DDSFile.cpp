@@ -0,0 +1,596 @@
+#include "Texture/DDSFile.h"
+
+#include <algorithm>
+#include <cwctype>
+
+namespace library
+{
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   DDSFile::DDSFile
+      Summary:  Constructor. Holds no file until parsed
+      Modifies: [m_description, m_aSubresources, m_uDataSize].
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    DDSFile::DDSFile()
+        : m_description()
+        , m_aSubresources()
+        , m_uDataSize(0u)
+    {
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   DDSFile::Parse
+      Summary:  Validates the headers of a DDS file and lays its
+                subresources out behind them. Bytes past the last
+                subresource are ignored, a file that ends before it is
+                rejected before anything is allocated for it. Arrays
+                are limited to what Direct3D 11 accepts, 2048 elements
+                or 341 cubes
+      Args:     const BYTE* pData
+                  First byte of the file, the magic number
+                UINT64 uSize
+                  Size of the file
+      Modifies: [m_description, m_aSubresources, m_uDataSize].
+      Returns:  HRESULT
+                  E_NOTIMPL for valid files with a format or layout
+                  not handled, E_FAIL for invalid ones
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    HRESULT DDSFile::Parse(_In_reads_bytes_(uSize) const BYTE* pData, _In_ UINT64 uSize)
+    {
+        m_description = DDSDescription();
+        m_aSubresources.clear();
+        m_uDataSize = 0u;
+
+        if (!pData || uSize < sizeof(UINT) + HEADER_SIZE || readUint(pData) != MAGIC)
+        {
+            return E_FAIL;
+        }
+
+        const BYTE* pHeader = pData + sizeof(UINT);
+        const BYTE* pPixelFormat = pHeader + 72u;
+        if (readUint(pHeader) != HEADER_SIZE || readUint(pPixelFormat) != PIXEL_FORMAT_SIZE)
+        {
+            return E_FAIL;
+        }
+
+        const UINT uFlags = readUint(pHeader + 4u);
+        DDSDescription description =
+        {
+            .uFormat = 0u,
+            .uDimension = 2u,
+            .uWidth = readUint(pHeader + 12u),
+            .uHeight = readUint(pHeader + 8u),
+            .uDepth = 1u,
+            .uMipLevels = std::max(readUint(pHeader + 24u), 1u),
+            .uArraySize = 1u,
+            .bCubeMap = FALSE
+        };
+
+        UINT64 uOffset = sizeof(UINT) + HEADER_SIZE;
+        if ((readUint(pPixelFormat + 4u) & DDS_FOURCC) && readUint(pPixelFormat + 8u) == makeFourCC('D', 'X', '1', '0'))
+        {
+            if (uSize < uOffset + DX10_HEADER_SIZE)
+            {
+                return E_FAIL;
+            }
+
+            const BYTE* pDX10Header = pData + uOffset;
+            uOffset += DX10_HEADER_SIZE;
+            description.uFormat = readUint(pDX10Header);
+            description.uArraySize = readUint(pDX10Header + 12u);
+            switch (readUint(pDX10Header + 4u))
+            {
+            case 2u:
+                description.uDimension = 1u;
+                description.uHeight = 1u;
+                break;
+            case 3u:
+                description.bCubeMap = (readUint(pDX10Header + 8u) & RESOURCE_MISC_TEXTURECUBE) != 0u;
+                break;
+            case 4u:
+                if (description.uArraySize != 1u)
+                {
+                    return E_FAIL;
+                }
+                description.uDimension = 3u;
+                description.uDepth = readUint(pHeader + 20u);
+                break;
+            default:
+                return E_FAIL;
+            }
+        }
+        else
+        {
+            HRESULT hr = getLegacyFormat(pPixelFormat, &description.uFormat);
+            if (FAILED(hr))
+            {
+                return hr;
+            }
+
+            const UINT uCaps2 = readUint(pHeader + 108u);
+            if (uFlags & DDS_HEADER_FLAGS_VOLUME)
+            {
+                description.uDimension = 3u;
+                description.uDepth = readUint(pHeader + 20u);
+            }
+            else if (uCaps2 & DDS_CUBEMAP)
+            {
+                // Cube maps with missing faces are not valid textures
+                if ((uCaps2 & DDS_CUBEMAP_ALLFACES) != DDS_CUBEMAP_ALLFACES)
+                {
+                    return E_NOTIMPL;
+                }
+                description.bCubeMap = TRUE;
+            }
+        }
+
+        if (description.uWidth == 0u || description.uHeight == 0u || description.uDepth == 0u || description.uArraySize == 0u
+            || description.uMipLevels > MAX_MIP_LEVELS)
+        {
+            return E_FAIL;
+        }
+        if (getBlockSize(description.uFormat) == 0u && getBitsPerPixel(description.uFormat) == 0u)
+        {
+            return E_NOTIMPL;
+        }
+
+        if (description.uArraySize > (description.bCubeMap ? MAX_CUBE_ARRAY_SIZE : MAX_ARRAY_SIZE))
+        {
+            return E_FAIL;
+        }
+
+        // Mips of an array element, offsets relative to the element
+        DDSSubresource aMips[MAX_MIP_LEVELS] = {};
+        UINT64 uElementSize = 0u;
+        UINT uWidth = description.uWidth;
+        UINT uHeight = description.uHeight;
+        UINT uDepth = description.uDepth;
+        for (UINT uMip = 0u; uMip < description.uMipLevels; ++uMip)
+        {
+            UINT uRowPitch = 0u;
+            UINT uNumRows = 0u;
+            HRESULT hr = GetSurfaceInfo(uWidth, uHeight, description.uFormat, &uRowPitch, &uNumRows);
+            if (FAILED(hr))
+            {
+                return hr;
+            }
+
+            const UINT64 uSlicePitch = static_cast<UINT64>(uRowPitch) * uNumRows;
+            const UINT64 uSubresourceSize = uSlicePitch * uDepth;
+            if (uSlicePitch > 0xFFFFFFFFull || uSubresourceSize > uSize - uOffset - uElementSize)
+            {
+                return E_FAIL;
+            }
+
+            aMips[uMip] = DDSSubresource
+            {
+                .pData = nullptr,
+                .uRowPitch = uRowPitch,
+                .uSlicePitch = static_cast<UINT>(uSlicePitch),
+                .uWidth = uWidth,
+                .uHeight = uHeight,
+                .uDepth = uDepth
+            };
+            uElementSize += uSubresourceSize;
+
+            uWidth = std::max(uWidth / 2u, 1u);
+            uHeight = std::max(uHeight / 2u, 1u);
+            uDepth = std::max(uDepth / 2u, 1u);
+        }
+
+        // Every element must fit in the file before the layout is reserved
+        const UINT64 uNumElements = static_cast<UINT64>(description.uArraySize) * (description.bCubeMap ? 6u : 1u);
+        if (uElementSize == 0u || uNumElements > (uSize - uOffset) / uElementSize)
+        {
+            return E_FAIL;
+        }
+
+        std::vector<DDSSubresource> aSubresources;
+        aSubresources.reserve(static_cast<size_t>(uNumElements * description.uMipLevels));
+        for (UINT64 uElement = 0u; uElement < uNumElements; ++uElement)
+        {
+            for (UINT uMip = 0u; uMip < description.uMipLevels; ++uMip)
+            {
+                DDSSubresource subresource = aMips[uMip];
+                subresource.pData = pData + uOffset;
+                aSubresources.push_back(subresource);
+                uOffset += static_cast<UINT64>(subresource.uSlicePitch) * subresource.uDepth;
+            }
+        }
+
+        m_description = description;
+        m_aSubresources = std::move(aSubresources);
+        m_uDataSize = uOffset - (sizeof(UINT) + HEADER_SIZE);
+
+        return S_OK;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   DDSFile::GetDescription
+      Summary:  Returns the texture of the parsed file
+      Returns:  const DDSDescription&
+                  Description of the texture
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    const DDSDescription& DDSFile::GetDescription() const
+    {
+        return m_description;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   DDSFile::GetNumSubresources
+      Summary:  Returns the number of subresources, mips times array
+                elements times faces
+      Returns:  UINT
+                  Number of subresources
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    UINT DDSFile::GetNumSubresources() const
+    {
+        return static_cast<UINT>(m_aSubresources.size());
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   DDSFile::GetSubresource
+      Summary:  Returns a subresource, numbered as D3D11CalcSubresource
+                does
+      Args:     UINT uSubresource
+                  Index of the subresource
+      Returns:  const DDSSubresource&
+                  Subresource pointing into the file
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    const DDSSubresource& DDSFile::GetSubresource(_In_ UINT uSubresource) const
+    {
+        return m_aSubresources[uSubresource];
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   DDSFile::GetDataSize
+      Summary:  Returns the bytes of the subresources and of the DX10
+                header, the file past the legacy header
+      Returns:  UINT64
+                  Size in bytes
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    UINT64 DDSFile::GetDataSize() const
+    {
+        return m_uDataSize;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   DDSFile::GetSurfaceInfo
+      Summary:  Computes the row pitch and the number of rows of a mip.
+                Rows of block compressed formats are rows of blocks
+      Args:     UINT uWidth
+                  Width of the mip
+                UINT uHeight
+                  Height of the mip
+                UINT uFormat
+                  DXGI_FORMAT value
+                UINT* puRowPitch
+                  Bytes of a row
+                UINT* puNumRows
+                  Number of rows
+      Modifies: [puRowPitch, puNumRows].
+      Returns:  HRESULT
+                  E_NOTIMPL for the formats not handled
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    HRESULT DDSFile::GetSurfaceInfo(_In_ UINT uWidth, _In_ UINT uHeight, _In_ UINT uFormat, _Out_ UINT* puRowPitch, _Out_ UINT* puNumRows)
+    {
+        *puRowPitch = 0u;
+        *puNumRows = 0u;
+
+        const UINT uBlockSize = getBlockSize(uFormat);
+        if (uBlockSize != 0u)
+        {
+            *puRowPitch = std::max((uWidth + 3u) / 4u, 1u) * uBlockSize;
+            *puNumRows = std::max((uHeight + 3u) / 4u, 1u);
+            return S_OK;
+        }
+
+        const UINT uBitsPerPixel = getBitsPerPixel(uFormat);
+        if (uBitsPerPixel == 0u)
+        {
+            return E_NOTIMPL;
+        }
+
+        *puRowPitch = static_cast<UINT>((static_cast<UINT64>(uWidth) * uBitsPerPixel + 7u) / 8u);
+        *puNumRows = uHeight;
+
+        return S_OK;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   DDSFile::HasExtension
+      Summary:  Tells whether a path names a DDS file, whatever the case
+                of its extension
+      Args:     const std::filesystem::path& filePath
+                  Path to the file
+      Returns:  BOOL
+                  TRUE for .dds files
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    BOOL DDSFile::HasExtension(_In_ const std::filesystem::path& filePath)
+    {
+        std::wstring szExtension = filePath.extension().wstring();
+        std::transform(szExtension.begin(), szExtension.end(), szExtension.begin(), [](WCHAR c)
+            {
+                return static_cast<WCHAR>(std::towlower(c));
+            });
+
+        return szExtension == L".dds";
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   DDSFile::WriteHeader
+      Summary:  Appends the magic number, the header and the DX10
+                header of a texture to a file. The subresources follow
+                in the order Parse lays them out, tightly packed
+      Args:     const DDSDescription& description
+                  Texture the file holds
+                std::vector<BYTE>& aFile
+                  Bytes of the file
+      Modifies: [aFile].
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    void DDSFile::WriteHeader(_In_ const DDSDescription& description, _Inout_ std::vector<BYTE>& aFile)
+    {
+        UINT uRowPitch = 0u;
+        UINT uNumRows = 0u;
+        const BOOL bBlockCompressed = getBlockSize(description.uFormat) != 0u;
+        GetSurfaceInfo(description.uWidth, description.uHeight, description.uFormat, &uRowPitch, &uNumRows);
+
+        UINT uFlags = DDS_HEADER_FLAGS_TEXTURE | (description.uMipLevels > 1u ? DDS_HEADER_FLAGS_MIPMAP : 0u);
+        UINT uPitchOrLinearSize = uRowPitch;
+        if (bBlockCompressed)
+        {
+            uFlags |= DDS_HEADER_FLAGS_LINEARSIZE;
+            uPitchOrLinearSize = uRowPitch * uNumRows;
+        }
+        if (description.uDimension == 3u)
+        {
+            uFlags |= DDS_HEADER_FLAGS_VOLUME;
+        }
+
+        writeUint(MAGIC, aFile);
+        writeUint(HEADER_SIZE, aFile);
+        writeUint(uFlags, aFile);
+        writeUint(description.uHeight, aFile);
+        writeUint(description.uWidth, aFile);
+        writeUint(uPitchOrLinearSize, aFile);
+        writeUint(description.uDimension == 3u ? description.uDepth : 0u, aFile);
+        writeUint(description.uMipLevels, aFile);
+        for (UINT i = 0u; i < 11u; ++i)
+        {
+            writeUint(0u, aFile);
+        }
+
+        writeUint(PIXEL_FORMAT_SIZE, aFile);
+        writeUint(DDS_FOURCC, aFile);
+        writeUint(makeFourCC('D', 'X', '1', '0'), aFile);
+        for (UINT i = 0u; i < 5u; ++i)
+        {
+            writeUint(0u, aFile);
+        }
+
+        writeUint(DDS_SURFACE_FLAGS_TEXTURE | (description.uMipLevels > 1u ? DDS_SURFACE_FLAGS_MIPMAP : 0u), aFile);
+        writeUint(description.bCubeMap ? DDS_CUBEMAP | DDS_CUBEMAP_ALLFACES : 0u, aFile);
+        for (UINT i = 0u; i < 3u; ++i)
+        {
+            writeUint(0u, aFile);
+        }
+
+        writeUint(description.uFormat, aFile);
+        writeUint(description.uDimension + 1u, aFile);
+        writeUint(description.bCubeMap ? RESOURCE_MISC_TEXTURECUBE : 0u, aFile);
+        writeUint(description.uArraySize, aFile);
+        writeUint(0u, aFile);
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   DDSFile::getLegacyFormat
+      Summary:  Maps the pixel format of a file without DX10 header to
+                a DXGI format, the FourCC codes of the block compressed
+                and float formats and the 32-bit channel masks
+      Args:     const BYTE* pPixelFormat
+                  DDS_PIXELFORMAT of the header
+                UINT* puFormat
+                  DXGI_FORMAT value
+      Modifies: [puFormat].
+      Returns:  HRESULT
+                  E_NOTIMPL for the pixel formats not handled
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    HRESULT DDSFile::getLegacyFormat(_In_reads_bytes_(PIXEL_FORMAT_SIZE) const BYTE* pPixelFormat, _Out_ UINT* puFormat)
+    {
+        *puFormat = 0u;
+
+        const UINT uFlags = readUint(pPixelFormat + 4u);
+        if (uFlags & DDS_FOURCC)
+        {
+            const UINT uFourCC = readUint(pPixelFormat + 8u);
+            if (uFourCC == makeFourCC('D', 'X', 'T', '1'))
+            {
+                *puFormat = 71u;
+            }
+            else if (uFourCC == makeFourCC('D', 'X', 'T', '2') || uFourCC == makeFourCC('D', 'X', 'T', '3'))
+            {
+                *puFormat = 74u;
+            }
+            else if (uFourCC == makeFourCC('D', 'X', 'T', '4') || uFourCC == makeFourCC('D', 'X', 'T', '5'))
+            {
+                *puFormat = 77u;
+            }
+            else if (uFourCC == makeFourCC('A', 'T', 'I', '1') || uFourCC == makeFourCC('B', 'C', '4', 'U'))
+            {
+                *puFormat = 80u;
+            }
+            else if (uFourCC == makeFourCC('B', 'C', '4', 'S'))
+            {
+                *puFormat = 81u;
+            }
+            else if (uFourCC == makeFourCC('A', 'T', 'I', '2') || uFourCC == makeFourCC('B', 'C', '5', 'U'))
+            {
+                *puFormat = 83u;
+            }
+            else if (uFourCC == makeFourCC('B', 'C', '5', 'S'))
+            {
+                *puFormat = 84u;
+            }
+            else
+            {
+                // D3DFORMAT codes of the float and 16-bit formats
+                switch (uFourCC)
+                {
+                case 36u:
+                    *puFormat = 11u;
+                    break;
+                case 110u:
+                    *puFormat = 13u;
+                    break;
+                case 111u:
+                    *puFormat = 54u;
+                    break;
+                case 112u:
+                    *puFormat = 34u;
+                    break;
+                case 113u:
+                    *puFormat = 10u;
+                    break;
+                case 114u:
+                    *puFormat = 41u;
+                    break;
+                case 115u:
+                    *puFormat = 16u;
+                    break;
+                case 116u:
+                    *puFormat = 2u;
+                    break;
+                default:
+                    return E_NOTIMPL;
+                }
+            }
+            return S_OK;
+        }
+
+        if ((uFlags & DDS_RGB) && readUint(pPixelFormat + 12u) == 32u)
+        {
+            const UINT uRMask = readUint(pPixelFormat + 16u);
+            const UINT uGMask = readUint(pPixelFormat + 20u);
+            const UINT uBMask = readUint(pPixelFormat + 24u);
+            const UINT uAMask = readUint(pPixelFormat + 28u);
+            if (uRMask == 0x000000FFu && uGMask == 0x0000FF00u && uBMask == 0x00FF0000u && uAMask == 0xFF000000u)
+            {
+                *puFormat = 28u;
+                return S_OK;
+            }
+            if (uRMask == 0x00FF0000u && uGMask == 0x0000FF00u && uBMask == 0x000000FFu)
+            {
+                *puFormat = uAMask == 0xFF000000u ? 87u : 88u;
+                return S_OK;
+            }
+        }
+
+        return E_NOTIMPL;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   DDSFile::getBlockSize
+      Summary:  Returns the bytes of a 4x4 block of a block compressed
+                format
+      Args:     UINT uFormat
+                  DXGI_FORMAT value
+      Returns:  UINT
+                  8 or 16, 0 if the format is not block compressed
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    UINT DDSFile::getBlockSize(_In_ UINT uFormat)
+    {
+        if ((uFormat >= 70u && uFormat <= 72u) || (uFormat >= 79u && uFormat <= 81u))
+        {
+            return 8u;
+        }
+        if ((uFormat >= 73u && uFormat <= 78u) || (uFormat >= 82u && uFormat <= 84u) || (uFormat >= 94u && uFormat <= 99u))
+        {
+            return 16u;
+        }
+        return 0u;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   DDSFile::getBitsPerPixel
+      Summary:  Returns the bits of a texel of an uncompressed format
+                laid out in plain rows
+      Args:     UINT uFormat
+                  DXGI_FORMAT value
+      Returns:  UINT
+                  Bits per texel, 0 for the formats not handled
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    UINT DDSFile::getBitsPerPixel(_In_ UINT uFormat)
+    {
+        if (uFormat >= 1u && uFormat <= 4u)
+        {
+            return 128u;
+        }
+        if (uFormat >= 5u && uFormat <= 8u)
+        {
+            return 96u;
+        }
+        if (uFormat >= 9u && uFormat <= 22u)
+        {
+            return 64u;
+        }
+        if ((uFormat >= 23u && uFormat <= 47u) || uFormat == 67u || (uFormat >= 87u && uFormat <= 93u))
+        {
+            return 32u;
+        }
+        if ((uFormat >= 48u && uFormat <= 59u) || uFormat == 85u || uFormat == 86u || uFormat == 115u)
+        {
+            return 16u;
+        }
+        if (uFormat >= 60u && uFormat <= 65u)
+        {
+            return 8u;
+        }
+        return 0u;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   DDSFile::makeFourCC
+      Summary:  Packs four characters into a FourCC code
+      Args:     CHAR c0, c1, c2, c3
+                  Characters, first one in the lowest byte
+      Returns:  UINT
+                  FourCC code
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    UINT DDSFile::makeFourCC(_In_ CHAR c0, _In_ CHAR c1, _In_ CHAR c2, _In_ CHAR c3)
+    {
+        return static_cast<UINT>(static_cast<BYTE>(c0)) | (static_cast<UINT>(static_cast<BYTE>(c1)) << 8u)
+            | (static_cast<UINT>(static_cast<BYTE>(c2)) << 16u) | (static_cast<UINT>(static_cast<BYTE>(c3)) << 24u);
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   DDSFile::readUint
+      Summary:  Reads a little-endian 32-bit field, aligned or not
+      Args:     const BYTE* pData
+                  First byte of the field
+      Returns:  UINT
+                  Value of the field
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    UINT DDSFile::readUint(_In_reads_bytes_(4) const BYTE* pData)
+    {
+        UINT uValue = 0u;
+        std::memcpy(&uValue, pData, sizeof(uValue));
+
+        return uValue;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   DDSFile::writeUint
+      Summary:  Appends a little-endian 32-bit field to a file
+      Args:     UINT uValue
+                  Value of the field
+                std::vector<BYTE>& aFile
+                  Bytes of the file
+      Modifies: [aFile].
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    void DDSFile::writeUint(_In_ UINT uValue, _Inout_ std::vector<BYTE>& aFile)
+    {
+        for (UINT i = 0u; i < sizeof(uValue); ++i)
+        {
+            aFile.push_back(static_cast<BYTE>((uValue >> (i * 8u)) & 0xFFu));
+        }
+    }
+}
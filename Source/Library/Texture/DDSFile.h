@@ -0,0 +1,141 @@
+﻿/*+===================================================================
+  File:      DDSFILE.H
+
+  Summary:   DDSFile header file contains declarations of the types of
+             a DDS description and its subresources, and the DDSFile
+             class that lays a DDS file out in place.
+
+  Classes: DDSFile
+
+  © 2022 Kyung Hee University
+===================================================================+*/
+#pragma once
+
+#include "Common.h"
+
+namespace library
+{
+    /*S+S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S
+      Struct:   DDSDescription
+
+      Summary:  Texture a DDS file holds. The format is a DXGI_FORMAT
+                value, the dimension 1, 2 or 3. A cube map is a 2D
+                texture with six faces per array element
+    S---S---S---S---S---S---S---S---S---S---S---S---S---S---S---S---S-S*/
+    struct DDSDescription
+    {
+        UINT uFormat;
+        UINT uDimension;
+        UINT uWidth;
+        UINT uHeight;
+        UINT uDepth;
+        UINT uMipLevels;
+        UINT uArraySize;
+        BOOL bCubeMap;
+    };
+
+    /*S+S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S
+      Struct:   DDSSubresource
+
+      Summary:  Texels of a mip of an array element, pointing into the
+                file. Block compressed rows are rows of 4x4 blocks
+    S---S---S---S---S---S---S---S---S---S---S---S---S---S---S---S---S-S*/
+    struct DDSSubresource
+    {
+        const BYTE* pData;
+        UINT uRowPitch;
+        UINT uSlicePitch;
+        UINT uWidth;
+        UINT uHeight;
+        UINT uDepth;
+    };
+
+    /*C+C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C
+      Class:    DDSFile
+
+      Summary:  Parses the header of a DDS file in memory and lays its
+                subresources out in the order Direct3D numbers them,
+                every mip of the first array element first. Nothing is
+                copied, the subresources point into the bytes parsed,
+                which must outlive them, e.g. a file mapping. Formats
+                come from the DX10 header or the common legacy pixel
+                formats, the block compressed FourCCs and 32-bit RGBA,
+                BGRA and BGRX. Other files, packed and planar formats
+                are left to DDSTextureLoader
+
+      Methods:  Parse
+                  Validates a file and lays it out
+                GetDescription
+                  Returns the texture of the file
+                GetNumSubresources
+                  Returns the number of subresources
+                GetSubresource
+                  Returns a subresource
+                GetDataSize
+                  Returns the bytes of the subresources
+                GetSurfaceInfo
+                  Computes the pitches of a mip
+                HasExtension
+                  Tells whether a path names a DDS file
+                WriteHeader
+                  Appends the headers of a texture to a file
+                DDSFile
+                  Constructor.
+                ~DDSFile
+                  Destructor.
+    C---C---C---C---C---C---C---C---C---C---C---C---C---C---C---C---C-C*/
+    class DDSFile final
+    {
+    public:
+        static constexpr UINT MAGIC = 0x20534444u;
+        static constexpr UINT HEADER_SIZE = 124u;
+        static constexpr UINT PIXEL_FORMAT_SIZE = 32u;
+        static constexpr UINT DX10_HEADER_SIZE = 20u;
+        static constexpr UINT MAX_MIP_LEVELS = 16u;
+        static constexpr UINT MAX_ARRAY_SIZE = 2048u;
+        static constexpr UINT MAX_CUBE_ARRAY_SIZE = MAX_ARRAY_SIZE / 6u;
+
+    public:
+        DDSFile();
+        DDSFile(const DDSFile& other) = default;
+        DDSFile(DDSFile&& other) = default;
+        DDSFile& operator=(const DDSFile& other) = default;
+        DDSFile& operator=(DDSFile&& other) = default;
+        ~DDSFile() = default;
+
+        HRESULT Parse(_In_reads_bytes_(uSize) const BYTE* pData, _In_ UINT64 uSize);
+
+        const DDSDescription& GetDescription() const;
+        UINT GetNumSubresources() const;
+        const DDSSubresource& GetSubresource(_In_ UINT uSubresource) const;
+        UINT64 GetDataSize() const;
+
+        static HRESULT GetSurfaceInfo(_In_ UINT uWidth, _In_ UINT uHeight, _In_ UINT uFormat, _Out_ UINT* puRowPitch, _Out_ UINT* puNumRows);
+        static BOOL HasExtension(_In_ const std::filesystem::path& filePath);
+        static void WriteHeader(_In_ const DDSDescription& description, _Inout_ std::vector<BYTE>& aFile);
+
+    private:
+        static constexpr UINT DDS_HEADER_FLAGS_TEXTURE = 0x00001007u;
+        static constexpr UINT DDS_HEADER_FLAGS_MIPMAP = 0x00020000u;
+        static constexpr UINT DDS_HEADER_FLAGS_LINEARSIZE = 0x00080000u;
+        static constexpr UINT DDS_SURFACE_FLAGS_TEXTURE = 0x00001000u;
+        static constexpr UINT DDS_SURFACE_FLAGS_MIPMAP = 0x00400008u;
+        static constexpr UINT DDS_FOURCC = 0x00000004u;
+        static constexpr UINT DDS_RGB = 0x00000040u;
+        static constexpr UINT DDS_HEADER_FLAGS_VOLUME = 0x00800000u;
+        static constexpr UINT DDS_CUBEMAP = 0x00000200u;
+        static constexpr UINT DDS_CUBEMAP_ALLFACES = 0x0000FE00u;
+        static constexpr UINT RESOURCE_MISC_TEXTURECUBE = 0x4u;
+
+        static HRESULT getLegacyFormat(_In_reads_bytes_(PIXEL_FORMAT_SIZE) const BYTE* pPixelFormat, _Out_ UINT* puFormat);
+        static UINT getBlockSize(_In_ UINT uFormat);
+        static UINT getBitsPerPixel(_In_ UINT uFormat);
+        static UINT makeFourCC(_In_ CHAR c0, _In_ CHAR c1, _In_ CHAR c2, _In_ CHAR c3);
+        static UINT readUint(_In_reads_bytes_(4) const BYTE* pData);
+        static void writeUint(_In_ UINT uValue, _Inout_ std::vector<BYTE>& aFile);
+
+        DDSDescription m_description;
+        std::vector<DDSSubresource> m_aSubresources;
+        UINT64 m_uDataSize;
+    };
+}
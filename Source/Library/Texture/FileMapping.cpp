@@ -0,0 +1,83 @@
+#include "Texture/FileMapping.h"
+
+#ifdef _WIN32
+#include "Texture/Win32FileMapping.h"
+#else
+#include "Texture/PosixFileMapping.h"
+#endif // _WIN32
+
+namespace library
+{
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   FileMapping::Create
+      Summary:  Creates the file mapping of the platform, no file is
+                mapped yet
+      Returns:  std::unique_ptr<FileMapping>
+                  Win32FileMapping on Windows, PosixFileMapping elsewhere
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    std::unique_ptr<FileMapping> FileMapping::Create()
+    {
+#ifdef _WIN32
+        return std::make_unique<Win32FileMapping>();
+#else
+        return std::make_unique<PosixFileMapping>();
+#endif // _WIN32
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   FileMapping::FileMapping
+      Summary:  Constructor
+      Modifies: [m_pData, m_uSize, m_bOpen].
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    FileMapping::FileMapping()
+        : m_pData(nullptr)
+        , m_uSize(0u)
+        , m_bOpen(FALSE)
+    {
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   FileMapping::IsOpen
+      Summary:  Tells whether a file is mapped
+      Returns:  BOOL
+                  TRUE between a successful Open and Close
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    BOOL FileMapping::IsOpen() const
+    {
+        return m_bOpen;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   FileMapping::GetData
+      Summary:  Returns the first byte of the view
+      Returns:  const BYTE*
+                  Mapped bytes, null when no file or an empty one is
+                  mapped
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    const BYTE* FileMapping::GetData() const
+    {
+        return m_pData;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   FileMapping::GetSize
+      Summary:  Returns the size of the mapped file
+      Returns:  UINT64
+                  Size in bytes
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    UINT64 FileMapping::GetSize() const
+    {
+        return m_uSize;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   FileMapping::GetRange
+      Summary:  Returns the whole view
+      Returns:  FileRange
+                  Mapped bytes and their size
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    FileRange FileMapping::GetRange() const
+    {
+        return FileRange{ .pData = m_pData, .uSize = m_uSize };
+    }
+}
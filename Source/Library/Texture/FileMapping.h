@@ -0,0 +1,84 @@
+﻿/*+===================================================================
+  File:      FILEMAPPING.H
+
+  Summary:   FileMapping header file contains declarations of the
+             FileRange type and the FileMapping class, the platform
+             agnostic interface of read-only memory-mapped files.
+
+  Classes: FileMapping
+
+  © 2022 Kyung Hee University
+===================================================================+*/
+#pragma once
+
+#include "Common.h"
+
+namespace library
+{
+    /*S+S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S
+      Struct:   FileRange
+
+      Summary:  Bytes of a mapped file, or of a part of it
+    S---S---S---S---S---S---S---S---S---S---S---S---S---S---S---S---S-S*/
+    struct FileRange
+    {
+        const BYTE* pData;
+        UINT64 uSize;
+    };
+
+    /*C+C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C
+      Class:    FileMapping
+
+      Summary:  Read-only view of a whole file in the address space.
+                Pages are read from the file as they are touched, so
+                data handed on from the view is never copied by the
+                reader. The view lives until the mapping is closed or
+                destroyed. Win32FileMapping implements it on Windows,
+                PosixFileMapping elsewhere
+
+      Methods:  Create
+                  Creates the mapping of the platform
+                Open
+                  Maps a file
+                Close
+                  Unmaps the file
+                IsOpen
+                  Tells whether a file is mapped
+                GetData
+                  Returns the first byte of the view
+                GetSize
+                  Returns the size of the file
+                GetRange
+                  Returns the whole view
+                FileMapping
+                  Constructor.
+                ~FileMapping
+                  Destructor.
+    C---C---C---C---C---C---C---C---C---C---C---C---C---C---C---C---C-C*/
+    class FileMapping
+    {
+    public:
+        static std::unique_ptr<FileMapping> Create();
+
+    public:
+        FileMapping();
+        FileMapping(const FileMapping& other) = delete;
+        FileMapping(FileMapping&& other) = delete;
+        FileMapping& operator=(const FileMapping& other) = delete;
+        FileMapping& operator=(FileMapping&& other) = delete;
+        virtual ~FileMapping() = default;
+
+        virtual HRESULT Open(_In_ const std::filesystem::path& filePath) = 0;
+        virtual void Close() = 0;
+
+        BOOL IsOpen() const;
+        const BYTE* GetData() const;
+        UINT64 GetSize() const;
+        FileRange GetRange() const;
+
+    protected:
+        const BYTE* m_pData;
+        UINT64 m_uSize;
+        BOOL m_bOpen;
+    };
+}
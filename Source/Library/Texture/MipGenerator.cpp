@@ -0,0 +1,1081 @@
+#include "Texture/MipGenerator.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <thread>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+#include <immintrin.h>
+
+namespace library
+{
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   MipGenerator::MipGenerator
+      Summary:  Constructor
+      Args:     UINT uNumThreads
+                  Threads the rows of a mip are split across, the
+                  calling one included
+      Modifies: [m_uNumThreads, m_kernel].
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    MipGenerator::MipGenerator(_In_ UINT uNumThreads)
+        : m_uNumThreads(std::max(uNumThreads, 1u))
+        , m_kernel(GetBestKernel())
+    {
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   MipGenerator::Generate
+      Summary:  Replaces the coarser mips of an image with the chain
+                down to 1x1, each mip filtered from the previous one.
+                The full resolution mip of a normal map is renormalized
+                first, sources are not always made of unit normals
+      Args:     DecodedImage& image
+                  Image whose full resolution mip is decoded
+                eMipFormat format
+                  Format of the texels
+                BOOL bNormalMap
+                  Whether the texels are normals, an RGBA8 one mapped
+                  from 0..1 to -1..1
+      Modifies: [image].
+      Returns:  HRESULT
+                  Status code
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    HRESULT MipGenerator::Generate(_Inout_ DecodedImage& image, _In_ eMipFormat format, _In_ BOOL bNormalMap) const
+    {
+        if (image.aMips.empty() || format >= eMipFormat::COUNT || (bNormalMap && getNumChannels(format) != 4u))
+        {
+            return E_INVALIDARG;
+        }
+
+        const UINT uBytesPerTexel = GetBytesPerTexel(format);
+        DecodedMip& base = image.aMips[0];
+        if (base.uWidth == 0u || base.uHeight == 0u || base.uRowPitch < base.uWidth * uBytesPerTexel
+            || base.aData.size() < static_cast<size_t>(base.uRowPitch) * base.uHeight)
+        {
+            return E_INVALIDARG;
+        }
+
+        image.aMips.resize(1u);
+        if (bNormalMap)
+        {
+            runBands(base.uHeight, base.uWidth, [&](UINT uFirstRow, UINT uLastRow)
+                {
+                    normalizeRows(base, format, uFirstRow, uLastRow);
+                });
+        }
+
+        while (image.aMips.back().uWidth > 1u || image.aMips.back().uHeight > 1u)
+        {
+            const DecodedMip& source = image.aMips.back();
+            DecodedMip mip =
+            {
+                .uWidth = std::max(source.uWidth / 2u, 1u),
+                .uHeight = std::max(source.uHeight / 2u, 1u),
+                .uRowPitch = std::max(source.uWidth / 2u, 1u) * uBytesPerTexel,
+                .aData = std::vector<BYTE>()
+            };
+            mip.aData.resize(static_cast<size_t>(mip.uRowPitch) * mip.uHeight);
+
+            AxisWeights columns;
+            AxisWeights rows;
+            computeWeights(source.uWidth, mip.uWidth, columns);
+            computeWeights(source.uHeight, mip.uHeight, rows);
+
+            runBands(mip.uHeight, mip.uWidth, [&](UINT uFirstRow, UINT uLastRow)
+                {
+                    generateRows(source, mip, format, bNormalMap, columns, rows, uFirstRow, uLastRow);
+                });
+
+            image.aMips.push_back(std::move(mip));
+        }
+
+        return S_OK;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   MipGenerator::SetKernel
+      Summary:  Picks the kernels the mips are filtered with
+      Args:     eMipKernel kernel
+                  Scalar or AVX2 kernels
+      Modifies: [m_kernel].
+      Returns:  HRESULT
+                  E_NOTIMPL if the CPU does not run the kernels
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    HRESULT MipGenerator::SetKernel(_In_ eMipKernel kernel)
+    {
+        if (kernel >= eMipKernel::COUNT)
+        {
+            return E_INVALIDARG;
+        }
+        if (kernel == eMipKernel::AVX2 && !isAVX2Supported())
+        {
+            return E_NOTIMPL;
+        }
+
+        m_kernel = kernel;
+
+        return S_OK;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   MipGenerator::GetKernel
+      Summary:  Returns the kernels the mips are filtered with
+      Returns:  eMipKernel
+                  Scalar or AVX2 kernels
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    eMipKernel MipGenerator::GetKernel() const
+    {
+        return m_kernel;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   MipGenerator::GetBestKernel
+      Summary:  Returns the AVX2 kernels on CPUs with AVX2 and F16C, the
+                scalar ones elsewhere
+      Returns:  eMipKernel
+                  Fastest kernels of the CPU
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    eMipKernel MipGenerator::GetBestKernel()
+    {
+        static const eMipKernel s_kernel = isAVX2Supported() ? eMipKernel::AVX2 : eMipKernel::SCALAR;
+
+        return s_kernel;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   MipGenerator::GetBytesPerTexel
+      Summary:  Returns the size of a texel of a format
+      Args:     eMipFormat format
+                  Format of the texels
+      Returns:  UINT
+                  Bytes per texel, 0 for an unknown format
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    UINT MipGenerator::GetBytesPerTexel(_In_ eMipFormat format)
+    {
+        switch (format)
+        {
+        case eMipFormat::RGBA8_UNORM:
+        case eMipFormat::RGBA8_UNORM_SRGB:
+        case eMipFormat::R32_FLOAT:
+            return 4u;
+        case eMipFormat::RGBA16_FLOAT:
+            return 8u;
+        default:
+            return 0u;
+        }
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   MipGenerator::runBands
+      Summary:  Splits the rows of a mip in bands, one per thread, and
+                runs them on the calling thread and new ones. Small mips
+                get fewer threads than they cost to start
+      Args:     UINT uNumRows
+                  Rows of the mip
+                UINT uRowSize
+                  Texels of a row
+                const std::function<void(UINT, UINT)>& work
+                  Called with the first row of a band and the row past
+                  its last
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    void MipGenerator::runBands(_In_ UINT uNumRows, _In_ UINT uRowSize, _In_ const std::function<void(UINT, UINT)>& work) const
+    {
+        const UINT64 uNumTexels = static_cast<UINT64>(uNumRows) * uRowSize;
+        const UINT uNumBands = static_cast<UINT>(std::clamp<UINT64>(uNumTexels / MIN_TEXELS_PER_THREAD, 1u, std::min(m_uNumThreads, uNumRows)));
+
+        std::vector<std::thread> aThreads;
+        aThreads.reserve(uNumBands - 1u);
+        for (UINT uBand = 1u; uBand < uNumBands; ++uBand)
+        {
+            aThreads.emplace_back(work, static_cast<UINT>(static_cast<UINT64>(uNumRows) * uBand / uNumBands),
+                static_cast<UINT>(static_cast<UINT64>(uNumRows) * (uBand + 1u) / uNumBands));
+        }
+        work(0u, uNumRows / uNumBands);
+
+        for (std::thread& thread : aThreads)
+        {
+            thread.join();
+        }
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   MipGenerator::generateRows
+      Summary:  Filters a band of rows of a mip. The three source rows
+                of a row are decoded and filtered horizontally, then
+                blended, renormalized and encoded. A third row of zero
+                weight is not read
+      Args:     const DecodedMip& source
+                  Previous mip
+                DecodedMip& mip
+                  Mip filtered
+                eMipFormat format
+                  Format of the texels
+                BOOL bNormalMap
+                  Whether the texels are normals
+                const AxisWeights& columns
+                  Taps of the columns of the mip
+                const AxisWeights& rows
+                  Taps of the rows of the mip
+                UINT uFirstRow
+                  First row of the band
+                UINT uLastRow
+                  Row past the last of the band
+      Modifies: [mip].
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    void MipGenerator::generateRows(_In_ const DecodedMip& source, _Inout_ DecodedMip& mip, _In_ eMipFormat format, _In_ BOOL bNormalMap,
+        _In_ const AxisWeights& columns, _In_ const AxisWeights& rows, _In_ UINT uFirstRow, _In_ UINT uLastRow) const
+    {
+        const UINT uNumChannels = getNumChannels(format);
+        const BOOL bAVX2 = m_kernel == eMipKernel::AVX2;
+
+        RowBuffers buffers;
+        for (UINT k = 0u; k < 3u; ++k)
+        {
+            buffers.aSource[k].resize(static_cast<size_t>(source.uWidth) * uNumChannels);
+            buffers.aFiltered[k].resize(static_cast<size_t>(mip.uWidth) * uNumChannels);
+            if (bAVX2)
+            {
+                buffers.aChannelWeights[k].resize(static_cast<size_t>(mip.uWidth) * uNumChannels);
+                for (UINT x = 0u; x < mip.uWidth; ++x)
+                {
+                    std::fill_n(buffers.aChannelWeights[k].data() + static_cast<size_t>(x) * uNumChannels, uNumChannels, columns.aWeights[x * 3u + k]);
+                }
+            }
+        }
+        buffers.aBlended.resize(static_cast<size_t>(mip.uWidth) * uNumChannels);
+
+        for (UINT y = uFirstRow; y < uLastRow; ++y)
+        {
+            const FLOAT* apRows[3] = {};
+            for (UINT k = 0u; k < 3u; ++k)
+            {
+                if (k == 2u && rows.aWeights[y * 3u + 2u] == 0.0f)
+                {
+                    apRows[2] = apRows[1];
+                    break;
+                }
+
+                const UINT uSourceRow = std::min(rows.auFirst[y] + k, source.uHeight - 1u);
+                const BYTE* pSource = source.aData.data() + static_cast<size_t>(source.uRowPitch) * uSourceRow;
+                if (bAVX2)
+                {
+                    decodeRowAVX2(pSource, source.uWidth, format, buffers.aSource[k].data());
+                    filterRowAVX2(buffers.aSource[k].data(), source.uWidth, uNumChannels, columns, buffers.aChannelWeights, buffers.aFiltered[k].data());
+                }
+                else
+                {
+                    decodeRowScalar(pSource, source.uWidth, format, buffers.aSource[k].data());
+                    filterRowScalar(buffers.aSource[k].data(), source.uWidth, uNumChannels, columns, 0u, buffers.aFiltered[k].data());
+                }
+                apRows[k] = buffers.aFiltered[k].data();
+            }
+
+            BYTE* pDestination = mip.aData.data() + static_cast<size_t>(mip.uRowPitch) * y;
+            const BOOL bUnsigned = format != eMipFormat::RGBA16_FLOAT;
+            if (bAVX2)
+            {
+                blendRowsAVX2(apRows, &rows.aWeights[y * 3u], mip.uWidth * uNumChannels, buffers.aBlended.data());
+                if (bNormalMap)
+                {
+                    normalizeRowAVX2(buffers.aBlended.data(), mip.uWidth, bUnsigned);
+                }
+                encodeRowAVX2(buffers.aBlended.data(), mip.uWidth, format, pDestination);
+            }
+            else
+            {
+                blendRowsScalar(apRows, &rows.aWeights[y * 3u], mip.uWidth * uNumChannels, buffers.aBlended.data());
+                if (bNormalMap)
+                {
+                    normalizeRowScalar(buffers.aBlended.data(), mip.uWidth, bUnsigned);
+                }
+                encodeRowScalar(buffers.aBlended.data(), mip.uWidth, format, pDestination);
+            }
+        }
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   MipGenerator::normalizeRows
+      Summary:  Renormalizes the normals of a band of rows in place
+      Args:     DecodedMip& mip
+                  Mip of normals
+                eMipFormat format
+                  Format of the texels
+                UINT uFirstRow
+                  First row of the band
+                UINT uLastRow
+                  Row past the last of the band
+      Modifies: [mip].
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    void MipGenerator::normalizeRows(_Inout_ DecodedMip& mip, _In_ eMipFormat format, _In_ UINT uFirstRow, _In_ UINT uLastRow) const
+    {
+        const BOOL bUnsigned = format != eMipFormat::RGBA16_FLOAT;
+        std::vector<FLOAT> aRow(static_cast<size_t>(mip.uWidth) * 4u);
+        for (UINT y = uFirstRow; y < uLastRow; ++y)
+        {
+            BYTE* pRow = mip.aData.data() + static_cast<size_t>(mip.uRowPitch) * y;
+            if (m_kernel == eMipKernel::AVX2)
+            {
+                decodeRowAVX2(pRow, mip.uWidth, format, aRow.data());
+                normalizeRowAVX2(aRow.data(), mip.uWidth, bUnsigned);
+                encodeRowAVX2(aRow.data(), mip.uWidth, format, pRow);
+            }
+            else
+            {
+                decodeRowScalar(pRow, mip.uWidth, format, aRow.data());
+                normalizeRowScalar(aRow.data(), mip.uWidth, bUnsigned);
+                encodeRowScalar(aRow.data(), mip.uWidth, format, pRow);
+            }
+        }
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   MipGenerator::computeWeights
+      Summary:  Computes the taps of a mip along one axis. An even size
+                averages texel pairs. An odd size 2n+1 covers each of
+                the n texels with 2+1/n source texels, the three taps
+                weighted (n-i, n, i+1) / (2n+1)
+      Args:     UINT uSourceSize
+                  Size of the previous mip
+                UINT uSize
+                  Size of the mip
+                AxisWeights& weights
+                  Taps of every texel of the mip
+      Modifies: [weights].
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    void MipGenerator::computeWeights(_In_ UINT uSourceSize, _In_ UINT uSize, _Out_ AxisWeights& weights)
+    {
+        weights.auFirst.resize(uSize);
+        weights.aWeights.resize(static_cast<size_t>(uSize) * 3u);
+
+        const FLOAT fDenominator = static_cast<FLOAT>(uSize * 2u + 1u);
+        for (UINT i = 0u; i < uSize; ++i)
+        {
+            FLOAT* pWeights = weights.aWeights.data() + static_cast<size_t>(i) * 3u;
+            weights.auFirst[i] = std::min(i * 2u, uSourceSize - 1u);
+            if (uSourceSize == 1u)
+            {
+                pWeights[0] = 1.0f;
+                pWeights[1] = 0.0f;
+                pWeights[2] = 0.0f;
+            }
+            else if (uSourceSize % 2u == 0u)
+            {
+                pWeights[0] = 0.5f;
+                pWeights[1] = 0.5f;
+                pWeights[2] = 0.0f;
+            }
+            else
+            {
+                pWeights[0] = static_cast<FLOAT>(uSize - i) / fDenominator;
+                pWeights[1] = static_cast<FLOAT>(uSize) / fDenominator;
+                pWeights[2] = static_cast<FLOAT>(i + 1u) / fDenominator;
+            }
+        }
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   MipGenerator::getNumChannels
+      Summary:  Returns the channels of a format
+      Args:     eMipFormat format
+                  Format of the texels
+      Returns:  UINT
+                  1 for R32_FLOAT, 4 for the others
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    UINT MipGenerator::getNumChannels(_In_ eMipFormat format)
+    {
+        return format == eMipFormat::R32_FLOAT ? 1u : 4u;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   MipGenerator::isAVX2Supported
+      Summary:  Tells whether the CPU and the OS run AVX2 and F16C
+      Returns:  BOOL
+                  TRUE if the AVX2 kernels can run
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    BOOL MipGenerator::isAVX2Supported()
+    {
+#if defined(_MSC_VER)
+        INT aInfo[4] = {};
+        __cpuid(aInfo, 0);
+        if (aInfo[0] < 7)
+        {
+            return FALSE;
+        }
+
+        // AVX, F16C and the OS saving the YMM registers
+        __cpuid(aInfo, 1);
+        const INT iFeatures = (1 << 27) | (1 << 28) | (1 << 29);
+        if ((aInfo[2] & iFeatures) != iFeatures || (_xgetbv(0) & 0x6u) != 0x6u)
+        {
+            return FALSE;
+        }
+
+        __cpuidex(aInfo, 7, 0);
+        return (aInfo[1] & (1 << 5)) != 0;
+#else
+        return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("f16c");
+#endif
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   MipGenerator::getSRGBToLinearTable
+      Summary:  Returns the linear value of every 8-bit sRGB value,
+                computed on first use
+      Returns:  const FLOAT*
+                  256 linear values
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    const FLOAT* MipGenerator::getSRGBToLinearTable()
+    {
+        static const std::vector<FLOAT> s_aTable = []()
+            {
+                std::vector<FLOAT> aTable(256u);
+                for (UINT i = 0u; i < 256u; ++i)
+                {
+                    const double fValue = static_cast<double>(i) / 255.0;
+                    aTable[i] = static_cast<FLOAT>(fValue <= 0.04045 ? fValue / 12.92 : std::pow((fValue + 0.055) / 1.055, 2.4));
+                }
+                return aTable;
+            }();
+
+        return s_aTable.data();
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   MipGenerator::getLinearToSRGBTable
+      Summary:  Returns the linear values halfway between consecutive
+                8-bit sRGB values, computed on first use. Counting the
+                thresholds below a linear value encodes it
+      Returns:  const FLOAT*
+                  255 thresholds, then a padding one
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    const FLOAT* MipGenerator::getLinearToSRGBTable()
+    {
+        static const std::vector<FLOAT> s_aTable = []()
+            {
+                std::vector<FLOAT> aTable(256u, 2.0f);
+                for (UINT i = 0u; i < 255u; ++i)
+                {
+                    const double fValue = (static_cast<double>(i) + 0.5) / 255.0;
+                    aTable[i] = static_cast<FLOAT>(fValue <= 0.04045 ? fValue / 12.92 : std::pow((fValue + 0.055) / 1.055, 2.4));
+                }
+                return aTable;
+            }();
+
+        return s_aTable.data();
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   MipGenerator::getSRGBBucketTable
+      Summary:  Returns the thresholds below the start of every bucket
+                of linear values, computed on first use
+      Returns:  const INT*
+                  NUM_SRGB_BUCKETS counts of thresholds
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    const INT* MipGenerator::getSRGBBucketTable()
+    {
+        static const std::vector<INT> s_aTable = []()
+            {
+                const FLOAT* pThresholds = getLinearToSRGBTable();
+                std::vector<INT> aTable(NUM_SRGB_BUCKETS);
+                for (UINT i = 1u; i < NUM_SRGB_BUCKETS; ++i)
+                {
+                    const UINT uBits = SRGB_BUCKET_BASE + (i << SRGB_BUCKET_SHIFT);
+                    FLOAT fStart = 0.0f;
+                    memcpy(&fStart, &uBits, sizeof(fStart));
+                    aTable[i] = static_cast<INT>(std::upper_bound(pThresholds, pThresholds + 255, fStart) - pThresholds);
+                }
+                return aTable;
+            }();
+
+        return s_aTable.data();
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   MipGenerator::decodeRowScalar
+      Summary:  Converts a row of texels to floats, sRGB colors to
+                linear ones
+      Args:     const BYTE* pSource
+                  Texels of the row
+                UINT uNumTexels
+                  Texels of the row
+                eMipFormat format
+                  Format of the texels
+                FLOAT* pRow
+                  Channels of the texels
+      Modifies: [pRow].
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    void MipGenerator::decodeRowScalar(_In_ const BYTE* pSource, _In_ UINT uNumTexels, _In_ eMipFormat format, _Out_ FLOAT* pRow)
+    {
+        switch (format)
+        {
+        case eMipFormat::RGBA8_UNORM:
+            for (UINT i = 0u; i < uNumTexels * 4u; ++i)
+            {
+                pRow[i] = static_cast<FLOAT>(pSource[i]) / 255.0f;
+            }
+            break;
+        case eMipFormat::RGBA8_UNORM_SRGB:
+        {
+            const FLOAT* pTable = getSRGBToLinearTable();
+            for (UINT i = 0u; i < uNumTexels * 4u; ++i)
+            {
+                pRow[i] = i % 4u == 3u ? static_cast<FLOAT>(pSource[i]) / 255.0f : pTable[pSource[i]];
+            }
+            break;
+        }
+        case eMipFormat::RGBA16_FLOAT:
+            for (UINT i = 0u; i < uNumTexels * 4u; ++i)
+            {
+                UINT16 uHalf = 0u;
+                memcpy(&uHalf, pSource + i * 2u, sizeof(uHalf));
+                pRow[i] = halfToFloat(uHalf);
+            }
+            break;
+        default:
+            memcpy(pRow, pSource, static_cast<size_t>(uNumTexels) * sizeof(FLOAT));
+            break;
+        }
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   MipGenerator::filterRowScalar
+      Summary:  Filters a decoded source row to the width of the mip
+      Args:     const FLOAT* pRow
+                  Decoded source row
+                UINT uSourceWidth
+                  Texels of the source row
+                UINT uNumChannels
+                  Channels of a texel
+                const AxisWeights& columns
+                  Taps of the columns of the mip
+                UINT uFirstTexel
+                  First texel of the mip to filter, the ones before are
+                  left as they are
+                FLOAT* pFiltered
+                  Filtered row
+      Modifies: [pFiltered].
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    void MipGenerator::filterRowScalar(_In_ const FLOAT* pRow, _In_ UINT uSourceWidth, _In_ UINT uNumChannels, _In_ const AxisWeights& columns, _In_ UINT uFirstTexel,
+        _Out_ FLOAT* pFiltered)
+    {
+        const UINT uWidth = static_cast<UINT>(columns.auFirst.size());
+        for (UINT x = uFirstTexel; x < uWidth; ++x)
+        {
+            const FLOAT* pWeights = columns.aWeights.data() + static_cast<size_t>(x) * 3u;
+            const FLOAT* pTap0 = pRow + static_cast<size_t>(columns.auFirst[x]) * uNumChannels;
+            const FLOAT* pTap1 = pRow + static_cast<size_t>(std::min(columns.auFirst[x] + 1u, uSourceWidth - 1u)) * uNumChannels;
+            const FLOAT* pTap2 = pRow + static_cast<size_t>(std::min(columns.auFirst[x] + 2u, uSourceWidth - 1u)) * uNumChannels;
+            for (UINT c = 0u; c < uNumChannels; ++c)
+            {
+                pFiltered[x * uNumChannels + c] = (pWeights[0] * pTap0[c] + pWeights[1] * pTap1[c]) + pWeights[2] * pTap2[c];
+            }
+        }
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   MipGenerator::blendRowsScalar
+      Summary:  Blends the three filtered rows of a row of the mip
+      Args:     const FLOAT* const* ppRows
+                  Filtered rows
+                const FLOAT* pWeights
+                  Weights of the rows
+                UINT uNumValues
+                  Channels of a row
+                FLOAT* pRow
+                  Blended row
+      Modifies: [pRow].
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    void MipGenerator::blendRowsScalar(_In_ const FLOAT* const* ppRows, _In_reads_(3) const FLOAT* pWeights, _In_ UINT uNumValues, _Out_ FLOAT* pRow)
+    {
+        for (UINT i = 0u; i < uNumValues; ++i)
+        {
+            pRow[i] = (pWeights[0] * ppRows[0][i] + pWeights[1] * ppRows[1][i]) + pWeights[2] * ppRows[2][i];
+        }
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   MipGenerator::normalizeRowScalar
+      Summary:  Normalizes the XYZ of a row of RGBA normals, alpha is
+                kept. Zero normals are left as they are
+      Args:     FLOAT* pRow
+                  Row of normals
+                UINT uNumTexels
+                  Texels of the row
+                BOOL bUnsigned
+                  Whether the normals are mapped to 0..1
+      Modifies: [pRow].
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    void MipGenerator::normalizeRowScalar(_Inout_ FLOAT* pRow, _In_ UINT uNumTexels, _In_ BOOL bUnsigned)
+    {
+        const FLOAT fScale = bUnsigned ? 2.0f : 1.0f;
+        const FLOAT fBias = bUnsigned ? -1.0f : 0.0f;
+        const FLOAT fInverseScale = bUnsigned ? 0.5f : 1.0f;
+        const FLOAT fInverseBias = bUnsigned ? 0.5f : 0.0f;
+        for (UINT x = 0u; x < uNumTexels; ++x)
+        {
+            FLOAT* pTexel = pRow + static_cast<size_t>(x) * 4u;
+            FLOAT afNormal[3] = {};
+            for (UINT c = 0u; c < 3u; ++c)
+            {
+                afNormal[c] = pTexel[c] * fScale + fBias;
+            }
+
+            const FLOAT fLength = std::sqrt((afNormal[0] * afNormal[0] + afNormal[1] * afNormal[1]) + afNormal[2] * afNormal[2]);
+            for (UINT c = 0u; c < 3u; ++c)
+            {
+                if (fLength > 0.0f)
+                {
+                    afNormal[c] = afNormal[c] / fLength;
+                }
+                pTexel[c] = afNormal[c] * fInverseScale + fInverseBias;
+            }
+        }
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   MipGenerator::encodeRowScalar
+      Summary:  Converts a row of floats to texels, linear colors to
+                sRGB ones
+      Args:     const FLOAT* pRow
+                  Channels of the texels
+                UINT uNumTexels
+                  Texels of the row
+                eMipFormat format
+                  Format of the texels
+                BYTE* pDestination
+                  Texels of the row
+      Modifies: [pDestination].
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    void MipGenerator::encodeRowScalar(_In_ const FLOAT* pRow, _In_ UINT uNumTexels, _In_ eMipFormat format, _Out_ BYTE* pDestination)
+    {
+        switch (format)
+        {
+        case eMipFormat::RGBA8_UNORM:
+            for (UINT i = 0u; i < uNumTexels * 4u; ++i)
+            {
+                pDestination[i] = encodeUnorm(pRow[i]);
+            }
+            break;
+        case eMipFormat::RGBA8_UNORM_SRGB:
+            for (UINT i = 0u; i < uNumTexels * 4u; ++i)
+            {
+                pDestination[i] = i % 4u == 3u ? encodeUnorm(pRow[i]) : encodeSRGB(pRow[i]);
+            }
+            break;
+        case eMipFormat::RGBA16_FLOAT:
+            for (UINT i = 0u; i < uNumTexels * 4u; ++i)
+            {
+                const UINT16 uHalf = floatToHalf(pRow[i]);
+                memcpy(pDestination + i * 2u, &uHalf, sizeof(uHalf));
+            }
+            break;
+        default:
+            memcpy(pDestination, pRow, static_cast<size_t>(uNumTexels) * sizeof(FLOAT));
+            break;
+        }
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   MipGenerator::halfToFloat
+      Summary:  Converts a half to a float, as F16C does
+      Args:     UINT16 uHalf
+                  Half float
+      Returns:  FLOAT
+                  Same value, NaNs made quiet
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    FLOAT MipGenerator::halfToFloat(_In_ UINT16 uHalf)
+    {
+        const UINT uSign = static_cast<UINT>(uHalf & 0x8000u) << 16u;
+        UINT uExponent = (uHalf >> 10u) & 0x1Fu;
+        UINT uMantissa = uHalf & 0x3FFu;
+
+        UINT uBits = uSign;
+        if (uExponent == 0x1Fu)
+        {
+            uBits |= 0x7F800000u | (uMantissa << 13u) | (uMantissa != 0u ? 0x400000u : 0u);
+        }
+        else if (uExponent != 0u)
+        {
+            uBits |= ((uExponent + 112u) << 23u) | (uMantissa << 13u);
+        }
+        else if (uMantissa != 0u)
+        {
+            // Denormal halves are normal floats
+            uExponent = 113u;
+            while ((uMantissa & 0x400u) == 0u)
+            {
+                uMantissa <<= 1u;
+                --uExponent;
+            }
+            uBits |= (uExponent << 23u) | ((uMantissa & 0x3FFu) << 13u);
+        }
+
+        FLOAT fValue = 0.0f;
+        memcpy(&fValue, &uBits, sizeof(fValue));
+        return fValue;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   MipGenerator::floatToHalf
+      Summary:  Converts a float to a half, rounding to nearest even as
+                F16C does
+      Args:     FLOAT fValue
+                  Float
+      Returns:  UINT16
+                  Half float, infinite past the range of halves
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    UINT16 MipGenerator::floatToHalf(_In_ FLOAT fValue)
+    {
+        UINT uBits = 0u;
+        memcpy(&uBits, &fValue, sizeof(uBits));
+        const UINT uSign = (uBits >> 16u) & 0x8000u;
+        const UINT uAbsolute = uBits & 0x7FFFFFFFu;
+
+        if (uAbsolute > 0x7F800000u)
+        {
+            return static_cast<UINT16>(uSign | 0x7E00u | ((uAbsolute >> 13u) & 0x3FFu));
+        }
+        // 65520 and up round past the largest half, 65504
+        if (uAbsolute >= 0x477FF000u)
+        {
+            return static_cast<UINT16>(uSign | 0x7C00u);
+        }
+        // 2^-25 and below round to zero
+        if (uAbsolute <= 0x33000000u)
+        {
+            return static_cast<UINT16>(uSign);
+        }
+
+        UINT uHalf = 0u;
+        UINT uRemainder = 0u;
+        UINT uHalfway = 0u;
+        if (uAbsolute < 0x38800000u)
+        {
+            // Denormal halves count units of 2^-24
+            const UINT uMantissa = (uAbsolute & 0x7FFFFFu) | 0x800000u;
+            const UINT uShift = 126u - (uAbsolute >> 23u);
+            uHalf = uMantissa >> uShift;
+            uRemainder = uMantissa & ((1u << uShift) - 1u);
+            uHalfway = 1u << (uShift - 1u);
+        }
+        else
+        {
+            uHalf = (uAbsolute - 0x38000000u) >> 13u;
+            uRemainder = uAbsolute & 0x1FFFu;
+            uHalfway = 0x1000u;
+        }
+
+        if (uRemainder > uHalfway || (uRemainder == uHalfway && (uHalf & 1u) != 0u))
+        {
+            ++uHalf;
+        }
+
+        return static_cast<UINT16>(uSign | uHalf);
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   MipGenerator::encodeUnorm
+      Summary:  Rounds a value to 8 bits. The clamps are written as the
+                SSE minimum and maximum, NaNs encode to 0
+      Args:     FLOAT fValue
+                  Value, 0 to 1
+      Returns:  BYTE
+                  Encoded value
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    BYTE MipGenerator::encodeUnorm(_In_ FLOAT fValue)
+    {
+        fValue = fValue > 0.0f ? fValue : 0.0f;
+        fValue = fValue < 1.0f ? fValue : 1.0f;
+
+        return static_cast<BYTE>(static_cast<INT>(fValue * 255.0f + 0.5f));
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   MipGenerator::encodeSRGB
+      Summary:  Encodes a linear value to the nearest 8-bit sRGB value.
+                The bucket of the value counts the thresholds below it
+                but the one it may hold. The clamps are those of
+                encodeUnorm
+      Args:     FLOAT fValue
+                  Linear value, 0 to 1
+      Returns:  BYTE
+                  Encoded value
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    BYTE MipGenerator::encodeSRGB(_In_ FLOAT fValue)
+    {
+        fValue = fValue > 0.0f ? fValue : 0.0f;
+        fValue = fValue < 1.0f ? fValue : 1.0f;
+
+        UINT uBits = 0u;
+        memcpy(&uBits, &fValue, sizeof(uBits));
+        const UINT uBucket = (std::max(uBits, SRGB_BUCKET_BASE) - SRGB_BUCKET_BASE) >> SRGB_BUCKET_SHIFT;
+
+        INT iValue = getSRGBBucketTable()[uBucket];
+        if (fValue >= getLinearToSRGBTable()[iValue])
+        {
+            ++iValue;
+        }
+
+        return static_cast<BYTE>(iValue);
+    }
+
+    // The AVX2 kernels are compiled for AVX2 whatever the target of the
+    // library, they only run on CPUs that support it
+#if defined(__GNUC__)
+#pragma GCC push_options
+#pragma GCC target("avx2,f16c")
+#endif
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   MipGenerator::decodeRowAVX2
+      Summary:  decodeRowScalar on eight channels at a time, the sRGB
+                table gathered
+      Args:     const BYTE* pSource
+                  Texels of the row
+                UINT uNumTexels
+                  Texels of the row
+                eMipFormat format
+                  Format of the texels
+                FLOAT* pRow
+                  Channels of the texels
+      Modifies: [pRow].
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    void MipGenerator::decodeRowAVX2(_In_ const BYTE* pSource, _In_ UINT uNumTexels, _In_ eMipFormat format, _Out_ FLOAT* pRow)
+    {
+        if (format == eMipFormat::R32_FLOAT)
+        {
+            decodeRowScalar(pSource, uNumTexels, format, pRow);
+            return;
+        }
+
+        // Two RGBA texels per register
+        const __m256 unormMax = _mm256_set1_ps(255.0f);
+        const FLOAT* pTable = getSRGBToLinearTable();
+        UINT x = 0u;
+        for (; x + 2u <= uNumTexels; x += 2u)
+        {
+            __m256 values;
+            if (format == eMipFormat::RGBA16_FLOAT)
+            {
+                values = _mm256_cvtph_ps(_mm_loadu_si128(reinterpret_cast<const __m128i*>(pSource + x * 8u)));
+            }
+            else
+            {
+                const __m256i bytes = _mm256_cvtepu8_epi32(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(pSource + x * 4u)));
+                values = _mm256_div_ps(_mm256_cvtepi32_ps(bytes), unormMax);
+                if (format == eMipFormat::RGBA8_UNORM_SRGB)
+                {
+                    values = _mm256_blend_ps(_mm256_i32gather_ps(pTable, bytes, 4), values, 0x88);
+                }
+            }
+            _mm256_storeu_ps(pRow + x * 4u, values);
+        }
+
+        if (x < uNumTexels)
+        {
+            decodeRowScalar(pSource + x * GetBytesPerTexel(format), uNumTexels - x, format, pRow + x * 4u);
+        }
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   MipGenerator::filterRowAVX2
+      Summary:  filterRowScalar on eight channels at a time, two RGBA
+                texels or eight R texels. The texels whose taps would be
+                clamped are filtered by filterRowScalar
+      Args:     const FLOAT* pRow
+                  Decoded source row
+                UINT uSourceWidth
+                  Texels of the source row
+                UINT uNumChannels
+                  Channels of a texel
+                const AxisWeights& columns
+                  Taps of the columns of the mip
+                const std::vector<FLOAT>* pChannelWeights
+                  Weights of the three taps per channel
+                FLOAT* pFiltered
+                  Filtered row
+      Modifies: [pFiltered].
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    void MipGenerator::filterRowAVX2(_In_ const FLOAT* pRow, _In_ UINT uSourceWidth, _In_ UINT uNumChannels, _In_ const AxisWeights& columns,
+        _In_ const std::vector<FLOAT>* pChannelWeights, _Out_ FLOAT* pFiltered)
+    {
+        const UINT uWidth = static_cast<UINT>(columns.auFirst.size());
+        UINT x = 0u;
+        if (uNumChannels == 4u)
+        {
+            // Texels x and x+1 read source texels 2x to 2x+4
+            for (; x + 2u <= uWidth && x * 2u + 5u <= uSourceWidth; x += 2u)
+            {
+                __m256 taps[3];
+                for (UINT k = 0u; k < 3u; ++k)
+                {
+                    taps[k] = _mm256_set_m128(_mm_loadu_ps(pRow + (x * 2u + k + 2u) * 4u), _mm_loadu_ps(pRow + (x * 2u + k) * 4u));
+                    taps[k] = _mm256_mul_ps(_mm256_loadu_ps(pChannelWeights[k].data() + x * 4u), taps[k]);
+                }
+                _mm256_storeu_ps(pFiltered + x * 4u, _mm256_add_ps(_mm256_add_ps(taps[0], taps[1]), taps[2]));
+            }
+        }
+        else
+        {
+            // Texels x to x+7 read source texels 2x to 2x+16, the even ones of two registers per tap
+            for (; x + 8u <= uWidth && x * 2u + 18u <= uSourceWidth; x += 8u)
+            {
+                __m256 taps[3];
+                for (UINT k = 0u; k < 3u; ++k)
+                {
+                    const __m256 low = _mm256_loadu_ps(pRow + x * 2u + k);
+                    const __m256 high = _mm256_loadu_ps(pRow + x * 2u + k + 8u);
+                    const __m256 evens = _mm256_shuffle_ps(low, high, _MM_SHUFFLE(2, 0, 2, 0));
+                    taps[k] = _mm256_castpd_ps(_mm256_permute4x64_pd(_mm256_castps_pd(evens), _MM_SHUFFLE(3, 1, 2, 0)));
+                    taps[k] = _mm256_mul_ps(_mm256_loadu_ps(pChannelWeights[k].data() + x), taps[k]);
+                }
+                _mm256_storeu_ps(pFiltered + x, _mm256_add_ps(_mm256_add_ps(taps[0], taps[1]), taps[2]));
+            }
+        }
+
+        filterRowScalar(pRow, uSourceWidth, uNumChannels, columns, x, pFiltered);
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   MipGenerator::blendRowsAVX2
+      Summary:  blendRowsScalar on eight channels at a time
+      Args:     const FLOAT* const* ppRows
+                  Filtered rows
+                const FLOAT* pWeights
+                  Weights of the rows
+                UINT uNumValues
+                  Channels of a row
+                FLOAT* pRow
+                  Blended row
+      Modifies: [pRow].
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    void MipGenerator::blendRowsAVX2(_In_ const FLOAT* const* ppRows, _In_reads_(3) const FLOAT* pWeights, _In_ UINT uNumValues, _Out_ FLOAT* pRow)
+    {
+        const __m256 weight0 = _mm256_set1_ps(pWeights[0]);
+        const __m256 weight1 = _mm256_set1_ps(pWeights[1]);
+        const __m256 weight2 = _mm256_set1_ps(pWeights[2]);
+        UINT i = 0u;
+        for (; i + 8u <= uNumValues; i += 8u)
+        {
+            const __m256 row0 = _mm256_mul_ps(weight0, _mm256_loadu_ps(ppRows[0] + i));
+            const __m256 row1 = _mm256_mul_ps(weight1, _mm256_loadu_ps(ppRows[1] + i));
+            const __m256 row2 = _mm256_mul_ps(weight2, _mm256_loadu_ps(ppRows[2] + i));
+            _mm256_storeu_ps(pRow + i, _mm256_add_ps(_mm256_add_ps(row0, row1), row2));
+        }
+
+        const FLOAT* apRows[3] = { ppRows[0] + i, ppRows[1] + i, ppRows[2] + i };
+        blendRowsScalar(apRows, pWeights, uNumValues - i, pRow + i);
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   MipGenerator::normalizeRowAVX2
+      Summary:  normalizeRowScalar on two texels at a time
+      Args:     FLOAT* pRow
+                  Row of normals
+                UINT uNumTexels
+                  Texels of the row
+                BOOL bUnsigned
+                  Whether the normals are mapped to 0..1
+      Modifies: [pRow].
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    void MipGenerator::normalizeRowAVX2(_Inout_ FLOAT* pRow, _In_ UINT uNumTexels, _In_ BOOL bUnsigned)
+    {
+        const __m256 scale = _mm256_set1_ps(bUnsigned ? 2.0f : 1.0f);
+        const __m256 bias = _mm256_set1_ps(bUnsigned ? -1.0f : 0.0f);
+        const __m256 inverseScale = _mm256_set1_ps(bUnsigned ? 0.5f : 1.0f);
+        const __m256 inverseBias = _mm256_set1_ps(bUnsigned ? 0.5f : 0.0f);
+        const __m256 zero = _mm256_setzero_ps();
+        UINT x = 0u;
+        for (; x + 2u <= uNumTexels; x += 2u)
+        {
+            const __m256 texels = _mm256_loadu_ps(pRow + x * 4u);
+            __m256 normals = _mm256_add_ps(_mm256_mul_ps(texels, scale), bias);
+
+            const __m256 squares = _mm256_mul_ps(normals, normals);
+            const __m256 lengths = _mm256_sqrt_ps(_mm256_add_ps(
+                _mm256_add_ps(_mm256_permute_ps(squares, _MM_SHUFFLE(0, 0, 0, 0)), _mm256_permute_ps(squares, _MM_SHUFFLE(1, 1, 1, 1))),
+                _mm256_permute_ps(squares, _MM_SHUFFLE(2, 2, 2, 2))));
+            normals = _mm256_blendv_ps(normals, _mm256_div_ps(normals, lengths), _mm256_cmp_ps(lengths, zero, _CMP_GT_OQ));
+
+            const __m256 encoded = _mm256_add_ps(_mm256_mul_ps(normals, inverseScale), inverseBias);
+            _mm256_storeu_ps(pRow + x * 4u, _mm256_blend_ps(encoded, texels, 0x88));
+        }
+
+        if (x < uNumTexels)
+        {
+            normalizeRowScalar(pRow + x * 4u, uNumTexels - x, bUnsigned);
+        }
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   MipGenerator::encodeRowAVX2
+      Summary:  encodeRowScalar on eight channels at a time, the sRGB
+                buckets and thresholds gathered
+      Args:     const FLOAT* pRow
+                  Channels of the texels
+                UINT uNumTexels
+                  Texels of the row
+                eMipFormat format
+                  Format of the texels
+                BYTE* pDestination
+                  Texels of the row
+      Modifies: [pDestination].
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    void MipGenerator::encodeRowAVX2(_In_ const FLOAT* pRow, _In_ UINT uNumTexels, _In_ eMipFormat format, _Out_ BYTE* pDestination)
+    {
+        if (format == eMipFormat::R32_FLOAT)
+        {
+            encodeRowScalar(pRow, uNumTexels, format, pDestination);
+            return;
+        }
+
+        const __m256 zero = _mm256_setzero_ps();
+        const __m256 one = _mm256_set1_ps(1.0f);
+        const __m256 unormMax = _mm256_set1_ps(255.0f);
+        const __m256 half = _mm256_set1_ps(0.5f);
+        const __m256i packOrder = _mm256_setr_epi32(0, 4, 0, 0, 0, 0, 0, 0);
+        const __m256i bucketBase = _mm256_set1_epi32(static_cast<INT>(SRGB_BUCKET_BASE));
+        const FLOAT* pThresholds = getLinearToSRGBTable();
+        const INT* pBuckets = getSRGBBucketTable();
+        UINT x = 0u;
+        for (; x + 2u <= uNumTexels; x += 2u)
+        {
+            const __m256 values = _mm256_loadu_ps(pRow + x * 4u);
+            if (format == eMipFormat::RGBA16_FLOAT)
+            {
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(pDestination + x * 8u), _mm256_cvtps_ph(values, _MM_FROUND_TO_NEAREST_INT));
+                continue;
+            }
+
+            const __m256 clamped = _mm256_min_ps(_mm256_max_ps(values, zero), one);
+            __m256i bytes = _mm256_cvttps_epi32(_mm256_add_ps(_mm256_mul_ps(clamped, unormMax), half));
+            if (format == eMipFormat::RGBA8_UNORM_SRGB)
+            {
+                // Clamped values are positive floats, their bits order as integers
+                const __m256i buckets = _mm256_srli_epi32(_mm256_sub_epi32(_mm256_max_epi32(_mm256_castps_si256(clamped), bucketBase), bucketBase),
+                    SRGB_BUCKET_SHIFT);
+                __m256i colors = _mm256_i32gather_epi32(pBuckets, buckets, 4);
+                const __m256 thresholds = _mm256_i32gather_ps(pThresholds, colors, 4);
+                colors = _mm256_sub_epi32(colors, _mm256_castps_si256(_mm256_cmp_ps(clamped, thresholds, _CMP_GE_OQ)));
+                bytes = _mm256_blend_epi32(colors, bytes, 0x88);
+            }
+
+            // 32 to 8 bits within each lane, then the two lanes side by side
+            bytes = _mm256_packus_epi16(_mm256_packus_epi32(bytes, bytes), _mm256_setzero_si256());
+            bytes = _mm256_permutevar8x32_epi32(bytes, packOrder);
+            _mm_storel_epi64(reinterpret_cast<__m128i*>(pDestination + x * 4u), _mm256_castsi256_si128(bytes));
+        }
+
+        if (x < uNumTexels)
+        {
+            encodeRowScalar(pRow + x * 4u, uNumTexels - x, format, pDestination + x * GetBytesPerTexel(format));
+        }
+    }
+
+#if defined(__GNUC__)
+#pragma GCC pop_options
+#endif
+}
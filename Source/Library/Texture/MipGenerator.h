@@ -0,0 +1,158 @@
+﻿/*+===================================================================
+  File:      MIPGENERATOR.H
+
+  Summary:   MipGenerator header file contains declarations of the
+             MipGenerator class that builds mip chains on the CPU with
+             scalar or AVX2 kernels, split across threads.
+
+  Classes: MipGenerator
+
+  © 2022 Kyung Hee University
+===================================================================+*/
+#pragma once
+
+#include "Common.h"
+
+#include <functional>
+
+#include "Texture/TextureStreamingQueue.h"
+
+namespace library
+{
+    enum class eMipFormat : UINT
+    {
+        RGBA8_UNORM = 0,
+        RGBA8_UNORM_SRGB,
+        RGBA16_FLOAT,
+        R32_FLOAT,
+        COUNT,
+    };
+
+    enum class eMipKernel : UINT
+    {
+        SCALAR = 0,
+        AVX2,
+        COUNT,
+    };
+
+    /*C+C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C
+      Class:    MipGenerator
+
+      Summary:  Builds the mip chain of an image down to 1x1, each mip
+                filtered from the previous one. Even sizes are halved
+                with a 2x2 box, odd sizes with the 3-tap polyphase box
+                of the non-power-of-two mip chains, so every source
+                texel weighs the same and the edges do not shift. Texels
+                are filtered as floats, sRGB colors in linear space,
+                and normals are renormalized after filtering. The rows
+                of a mip are split across threads. The AVX2 kernels
+                perform the same operations in the same order as the
+                scalar ones, without fused multiply-adds, so both give
+                the same bits
+
+      Methods:  Generate
+                  Builds the mip chain of an image
+                SetKernel
+                  Picks the scalar or AVX2 kernels
+                GetKernel
+                  Returns the kernels in use
+                GetBestKernel
+                  Returns the fastest kernels the CPU runs
+                GetBytesPerTexel
+                  Returns the size of a texel of a format
+                MipGenerator
+                  Constructor.
+                ~MipGenerator
+                  Destructor.
+    C---C---C---C---C---C---C---C---C---C---C---C---C---C---C---C---C-C*/
+    class MipGenerator final
+    {
+    public:
+        static constexpr UINT MIN_TEXELS_PER_THREAD = 16384u;
+
+    public:
+        explicit MipGenerator(_In_ UINT uNumThreads);
+        MipGenerator(const MipGenerator& other) = default;
+        MipGenerator(MipGenerator&& other) = default;
+        MipGenerator& operator=(const MipGenerator& other) = default;
+        MipGenerator& operator=(MipGenerator&& other) = default;
+        ~MipGenerator() = default;
+
+        HRESULT Generate(_Inout_ DecodedImage& image, _In_ eMipFormat format, _In_ BOOL bNormalMap) const;
+
+        HRESULT SetKernel(_In_ eMipKernel kernel);
+        eMipKernel GetKernel() const;
+
+        static eMipKernel GetBestKernel();
+        static UINT GetBytesPerTexel(_In_ eMipFormat format);
+
+    private:
+        // Linear values are bucketed by their top bits from 2^-13, under
+        // the first sRGB threshold, to 1. No bucket holds two thresholds
+        static constexpr UINT SRGB_BUCKET_BASE = 0x39000000u;
+        static constexpr UINT SRGB_BUCKET_SHIFT = 16u;
+        static constexpr UINT NUM_SRGB_BUCKETS = ((0x3F800000u - SRGB_BUCKET_BASE) >> SRGB_BUCKET_SHIFT) + 1u;
+
+        /*S+S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S
+          Struct:   AxisWeights
+
+          Summary:  Taps of every texel of a mip along one axis, the
+                    first source texel and the weights of the three
+                    texels from it. Indices past the source are clamped
+        S---S---S---S---S---S---S---S---S---S---S---S---S---S---S---S---S-S*/
+        struct AxisWeights
+        {
+            std::vector<UINT> auFirst;
+            std::vector<FLOAT> aWeights;
+        };
+
+        /*S+S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S
+          Struct:   RowBuffers
+
+          Summary:  Scratch rows of a thread, the three source rows
+                    decoded and filtered, the row they blend to, and the
+                    column weights repeated for every channel
+        S---S---S---S---S---S---S---S---S---S---S---S---S---S---S---S---S-S*/
+        struct RowBuffers
+        {
+            std::vector<FLOAT> aSource[3];
+            std::vector<FLOAT> aFiltered[3];
+            std::vector<FLOAT> aBlended;
+            std::vector<FLOAT> aChannelWeights[3];
+        };
+
+        void runBands(_In_ UINT uNumRows, _In_ UINT uRowSize, _In_ const std::function<void(UINT, UINT)>& work) const;
+        void generateRows(_In_ const DecodedMip& source, _Inout_ DecodedMip& mip, _In_ eMipFormat format, _In_ BOOL bNormalMap,
+            _In_ const AxisWeights& columns, _In_ const AxisWeights& rows, _In_ UINT uFirstRow, _In_ UINT uLastRow) const;
+        void normalizeRows(_Inout_ DecodedMip& mip, _In_ eMipFormat format, _In_ UINT uFirstRow, _In_ UINT uLastRow) const;
+
+        static void computeWeights(_In_ UINT uSourceSize, _In_ UINT uSize, _Out_ AxisWeights& weights);
+        static UINT getNumChannels(_In_ eMipFormat format);
+        static BOOL isAVX2Supported();
+        static const FLOAT* getSRGBToLinearTable();
+        static const FLOAT* getLinearToSRGBTable();
+        static const INT* getSRGBBucketTable();
+
+        static void decodeRowScalar(_In_ const BYTE* pSource, _In_ UINT uNumTexels, _In_ eMipFormat format, _Out_ FLOAT* pRow);
+        static void filterRowScalar(_In_ const FLOAT* pRow, _In_ UINT uSourceWidth, _In_ UINT uNumChannels, _In_ const AxisWeights& columns, _In_ UINT uFirstTexel,
+            _Out_ FLOAT* pFiltered);
+        static void blendRowsScalar(_In_ const FLOAT* const* ppRows, _In_reads_(3) const FLOAT* pWeights, _In_ UINT uNumValues, _Out_ FLOAT* pRow);
+        static void normalizeRowScalar(_Inout_ FLOAT* pRow, _In_ UINT uNumTexels, _In_ BOOL bUnsigned);
+        static void encodeRowScalar(_In_ const FLOAT* pRow, _In_ UINT uNumTexels, _In_ eMipFormat format, _Out_ BYTE* pDestination);
+
+        static void decodeRowAVX2(_In_ const BYTE* pSource, _In_ UINT uNumTexels, _In_ eMipFormat format, _Out_ FLOAT* pRow);
+        static void filterRowAVX2(_In_ const FLOAT* pRow, _In_ UINT uSourceWidth, _In_ UINT uNumChannels, _In_ const AxisWeights& columns,
+            _In_ const std::vector<FLOAT>* pChannelWeights, _Out_ FLOAT* pFiltered);
+        static void blendRowsAVX2(_In_ const FLOAT* const* ppRows, _In_reads_(3) const FLOAT* pWeights, _In_ UINT uNumValues, _Out_ FLOAT* pRow);
+        static void normalizeRowAVX2(_Inout_ FLOAT* pRow, _In_ UINT uNumTexels, _In_ BOOL bUnsigned);
+        static void encodeRowAVX2(_In_ const FLOAT* pRow, _In_ UINT uNumTexels, _In_ eMipFormat format, _Out_ BYTE* pDestination);
+
+        static FLOAT halfToFloat(_In_ UINT16 uHalf);
+        static UINT16 floatToHalf(_In_ FLOAT fValue);
+        static BYTE encodeUnorm(_In_ FLOAT fValue);
+        static BYTE encodeSRGB(_In_ FLOAT fValue);
+
+        UINT m_uNumThreads;
+        eMipKernel m_kernel;
+    };
+}
@@ -0,0 +1,87 @@
+#include "Texture/PosixFileMapping.h"
+
+#ifndef _WIN32
+
+#include <cerrno>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace library
+{
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   PosixFileMapping::~PosixFileMapping
+      Summary:  Destructor. Unmaps the file
+      Modifies: [m_pData, m_uSize, m_bOpen].
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    PosixFileMapping::~PosixFileMapping()
+    {
+        Close();
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   PosixFileMapping::Open
+      Summary:  Maps a whole file read-only, unmapping the previous one.
+                An empty file opens with no data
+      Args:     const std::filesystem::path& filePath
+                  Path to the file
+      Modifies: [m_pData, m_uSize, m_bOpen].
+      Returns:  HRESULT
+                  Status code
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    HRESULT PosixFileMapping::Open(_In_ const std::filesystem::path& filePath)
+    {
+        Close();
+
+        const int iFile = open(filePath.c_str(), O_RDONLY | O_CLOEXEC);
+        if (iFile < 0)
+        {
+            return errno == ENOENT ? E_INVALIDARG : E_FAIL;
+        }
+
+        struct stat fileStatus = {};
+        if (fstat(iFile, &fileStatus) != 0 || !S_ISREG(fileStatus.st_mode))
+        {
+            close(iFile);
+            return E_FAIL;
+        }
+
+        const UINT64 uSize = static_cast<UINT64>(fileStatus.st_size);
+        void* pView = nullptr;
+        if (uSize > 0u)
+        {
+            pView = mmap(nullptr, static_cast<size_t>(uSize), PROT_READ, MAP_PRIVATE, iFile, 0);
+        }
+        close(iFile);
+        if (pView == MAP_FAILED)
+        {
+            return errno == ENOMEM ? E_OUTOFMEMORY : E_FAIL;
+        }
+
+        m_pData = static_cast<const BYTE*>(pView);
+        m_uSize = uSize;
+        m_bOpen = TRUE;
+
+        return S_OK;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   PosixFileMapping::Close
+      Summary:  Unmaps the file, pointers into the view dangle
+      Modifies: [m_pData, m_uSize, m_bOpen].
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    void PosixFileMapping::Close()
+    {
+        if (m_pData)
+        {
+            munmap(const_cast<BYTE*>(m_pData), static_cast<size_t>(m_uSize));
+        }
+        m_pData = nullptr;
+        m_uSize = 0u;
+        m_bOpen = FALSE;
+    }
+}
+
+#endif // ! _WIN32
@@ -0,0 +1,53 @@
+﻿/*+===================================================================
+  File:      POSIXFILEMAPPING.H
+
+  Summary:   PosixFileMapping header file contains declarations of the
+             PosixFileMapping class, the file mapping of non-Windows
+             hosts.
+
+  Classes: PosixFileMapping
+
+  © 2022 Kyung Hee University
+===================================================================+*/
+#pragma once
+
+#ifndef _WIN32
+
+#include "Common.h"
+
+#include "Texture/FileMapping.h"
+
+namespace library
+{
+    /*C+C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C
+      Class:    PosixFileMapping
+
+      Summary:  File mapping built on mmap. The file descriptor is
+                closed as soon as the file is mapped, the mapping keeps
+                the file alive
+
+      Methods:  Open
+                  Maps a file
+                Close
+                  Unmaps the file
+                PosixFileMapping
+                  Constructor.
+                ~PosixFileMapping
+                  Destructor.
+    C---C---C---C---C---C---C---C---C---C---C---C---C---C---C---C---C-C*/
+    class PosixFileMapping final : public FileMapping
+    {
+    public:
+        PosixFileMapping() = default;
+        PosixFileMapping(const PosixFileMapping& other) = delete;
+        PosixFileMapping(PosixFileMapping&& other) = delete;
+        PosixFileMapping& operator=(const PosixFileMapping& other) = delete;
+        PosixFileMapping& operator=(PosixFileMapping&& other) = delete;
+        ~PosixFileMapping() override;
+
+        HRESULT Open(_In_ const std::filesystem::path& filePath) override;
+        void Close() override;
+    };
+}
+
+#endif // ! _WIN32
@@ -0,0 +1,229 @@
+#include "Texture/RectanglePacker.h"
+
+#include <algorithm>
+#include <numeric>
+
+namespace library
+{
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   RectanglePacker::RectanglePacker
+      Summary:  Constructor
+      Args:     UINT uLayerWidth
+                  Width of a layer
+                UINT uLayerHeight
+                  Height of a layer
+      Modifies: [m_uLayerWidth, m_uLayerHeight, m_uPackedArea,
+                  m_aSkylines].
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    RectanglePacker::RectanglePacker(_In_ UINT uLayerWidth, _In_ UINT uLayerHeight)
+        : m_uLayerWidth(uLayerWidth)
+        , m_uLayerHeight(uLayerHeight)
+        , m_uPackedArea(0u)
+        , m_aSkylines()
+    {
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   RectanglePacker::Pack
+      Summary:  Places rectangles into layers, forgetting what the
+                previous call placed. Rectangles are visited tallest
+                first, then widest, and keep their order in the array
+      Args:     std::vector<PackedRectangle>& aRectangles
+                  Rectangles whose size is set
+      Modifies: [aRectangles, m_uPackedArea, m_aSkylines].
+      Returns:  HRESULT
+                  E_INVALIDARG if a rectangle is empty or larger than
+                  a layer
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    HRESULT RectanglePacker::Pack(_Inout_ std::vector<PackedRectangle>& aRectangles)
+    {
+        m_uPackedArea = 0u;
+        m_aSkylines.clear();
+
+        for (const PackedRectangle& rectangle : aRectangles)
+        {
+            if (rectangle.uWidth == 0u || rectangle.uHeight == 0u || rectangle.uWidth > m_uLayerWidth || rectangle.uHeight > m_uLayerHeight)
+            {
+                return E_INVALIDARG;
+            }
+        }
+
+        std::vector<UINT> aOrder(aRectangles.size());
+        std::iota(aOrder.begin(), aOrder.end(), 0u);
+        std::stable_sort(aOrder.begin(), aOrder.end(), [&aRectangles](UINT uA, UINT uB)
+            {
+                const PackedRectangle& a = aRectangles[uA];
+                const PackedRectangle& b = aRectangles[uB];
+                return a.uHeight != b.uHeight ? a.uHeight > b.uHeight : a.uWidth > b.uWidth;
+            });
+
+        for (UINT uRectangle : aOrder)
+        {
+            PackedRectangle& rectangle = aRectangles[uRectangle];
+
+            size_t uSegment = 0u;
+            UINT uLayer = 0u;
+            for (; uLayer < m_aSkylines.size(); ++uLayer)
+            {
+                if (findPosition(m_aSkylines[uLayer], rectangle.uWidth, rectangle.uHeight, &uSegment, &rectangle.uX, &rectangle.uY))
+                {
+                    break;
+                }
+            }
+
+            // An empty layer holds any rectangle that passed the size check
+            if (uLayer == m_aSkylines.size())
+            {
+                m_aSkylines.push_back({ { .uX = 0u, .uY = 0u, .uWidth = m_uLayerWidth } });
+                findPosition(m_aSkylines.back(), rectangle.uWidth, rectangle.uHeight, &uSegment, &rectangle.uX, &rectangle.uY);
+            }
+
+            rectangle.uLayer = uLayer;
+            addRectangle(m_aSkylines[uLayer], uSegment, rectangle.uX, rectangle.uY, rectangle.uWidth, rectangle.uHeight);
+            m_uPackedArea += static_cast<UINT64>(rectangle.uWidth) * rectangle.uHeight;
+        }
+
+        return S_OK;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   RectanglePacker::GetNumLayers
+      Summary:  Returns the layers the last packed rectangles took
+      Returns:  UINT
+                  Number of layers
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    UINT RectanglePacker::GetNumLayers() const
+    {
+        return static_cast<UINT>(m_aSkylines.size());
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   RectanglePacker::GetOccupancy
+      Summary:  Returns the area of the last packed rectangles over the
+                area of the layers they took
+      Returns:  FLOAT
+                  Ratio from 0 to 1, 0 without any layer
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    FLOAT RectanglePacker::GetOccupancy() const
+    {
+        const UINT64 uLayersArea = static_cast<UINT64>(m_uLayerWidth) * m_uLayerHeight * m_aSkylines.size();
+
+        return uLayersArea != 0u ? static_cast<FLOAT>(static_cast<double>(m_uPackedArea) / static_cast<double>(uLayersArea)) : 0.0f;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   RectanglePacker::findPosition
+      Summary:  Finds where a rectangle goes on a skyline, its left edge
+                on the left of a segment and its bottom edge on the
+                highest segment under it. The position whose top ends
+                the lowest wins, the leftmost on a tie
+      Args:     const std::vector<SkylineSegment>& aSkyline
+                  Top edge of a layer
+                UINT uWidth
+                  Width of the rectangle
+                UINT uHeight
+                  Height of the rectangle
+                size_t* puSegment
+                  Segment the left edge of the rectangle is on
+                UINT* puX
+                  Left of the rectangle
+                UINT* puY
+                  Top of the rectangle
+      Modifies: [puSegment, puX, puY].
+      Returns:  BOOL
+                  TRUE if the rectangle fits in the layer
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    BOOL RectanglePacker::findPosition(_In_ const std::vector<SkylineSegment>& aSkyline, _In_ UINT uWidth, _In_ UINT uHeight, _Out_ size_t* puSegment, _Out_ UINT* puX, _Out_ UINT* puY) const
+    {
+        BOOL bFound = FALSE;
+        UINT uBestBottom = 0u;
+        *puSegment = 0u;
+        *puX = 0u;
+        *puY = 0u;
+
+        for (size_t i = 0u; i < aSkyline.size(); ++i)
+        {
+            const UINT uX = aSkyline[i].uX;
+            if (uX + uWidth > m_uLayerWidth)
+            {
+                break;
+            }
+
+            UINT uY = 0u;
+            for (size_t j = i; j < aSkyline.size() && aSkyline[j].uX < uX + uWidth; ++j)
+            {
+                uY = std::max(uY, aSkyline[j].uY);
+            }
+
+            if (uY + uHeight > m_uLayerHeight)
+            {
+                continue;
+            }
+
+            // Segments go left to right, a tie keeps the leftmost
+            if (!bFound || uY + uHeight < uBestBottom)
+            {
+                bFound = TRUE;
+                uBestBottom = uY + uHeight;
+                *puSegment = i;
+                *puX = uX;
+                *puY = uY;
+            }
+        }
+
+        return bFound;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   RectanglePacker::addRectangle
+      Summary:  Raises a skyline over a placed rectangle. The segments
+                under it are cut or removed, then neighbors at the same
+                height are merged
+      Args:     std::vector<SkylineSegment>& aSkyline
+                  Top edge of a layer
+                size_t uSegment
+                  Segment the left edge of the rectangle is on
+                UINT uX
+                  Left of the rectangle
+                UINT uY
+                  Top of the rectangle
+                UINT uWidth
+                  Width of the rectangle
+                UINT uHeight
+                  Height of the rectangle
+      Modifies: [aSkyline].
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    void RectanglePacker::addRectangle(_Inout_ std::vector<SkylineSegment>& aSkyline, _In_ size_t uSegment, _In_ UINT uX, _In_ UINT uY, _In_ UINT uWidth, _In_ UINT uHeight)
+    {
+        aSkyline.insert(aSkyline.begin() + static_cast<std::ptrdiff_t>(uSegment), { .uX = uX, .uY = uY + uHeight, .uWidth = uWidth });
+
+        const UINT uRight = uX + uWidth;
+        size_t i = uSegment + 1u;
+        while (i < aSkyline.size() && aSkyline[i].uX < uRight)
+        {
+            const UINT uSegmentRight = aSkyline[i].uX + aSkyline[i].uWidth;
+            if (uSegmentRight <= uRight)
+            {
+                aSkyline.erase(aSkyline.begin() + static_cast<std::ptrdiff_t>(i));
+                continue;
+            }
+
+            aSkyline[i].uWidth = uSegmentRight - uRight;
+            aSkyline[i].uX = uRight;
+            break;
+        }
+
+        for (i = 1u; i < aSkyline.size();)
+        {
+            if (aSkyline[i - 1u].uY == aSkyline[i].uY)
+            {
+                aSkyline[i - 1u].uWidth += aSkyline[i].uWidth;
+                aSkyline.erase(aSkyline.begin() + static_cast<std::ptrdiff_t>(i));
+            }
+            else
+            {
+                ++i;
+            }
+        }
+    }
+}
@@ -0,0 +1,90 @@
+﻿/*+===================================================================
+  File:      RECTANGLEPACKER.H
+
+  Summary:   RectanglePacker header file contains declarations of the
+             RectanglePacker class that places rectangles into the
+             layers of a texture array.
+
+  Classes: RectanglePacker
+
+  © 2022 Kyung Hee University
+===================================================================+*/
+#pragma once
+
+#include "Common.h"
+
+namespace library
+{
+    /*S+S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S
+      Struct:   PackedRectangle
+
+      Summary:  Rectangle to pack, its size, then the layer and the top
+                left corner it was placed at
+    S---S---S---S---S---S---S---S---S---S---S---S---S---S---S---S---S-S*/
+    struct PackedRectangle
+    {
+        UINT uWidth;
+        UINT uHeight;
+        UINT uX;
+        UINT uY;
+        UINT uLayer;
+    };
+
+    /*C+C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C
+      Class:    RectanglePacker
+
+      Summary:  Skyline packer of rectangles into layers of the same
+                size. Every layer keeps the top edge of what it holds
+                as a list of segments, a rectangle goes where its bottom
+                edge ends the lowest, leftmost first, in the first layer
+                it fits. Rectangles are placed tallest first, a layer is
+                opened when none of the open ones has room
+
+      Methods:  Pack
+                  Places rectangles into as few layers as it can
+                GetNumLayers
+                  Returns the layers the rectangles took
+                GetOccupancy
+                  Returns the ratio of the layers covered
+                RectanglePacker
+                  Constructor.
+                ~RectanglePacker
+                  Destructor.
+    C---C---C---C---C---C---C---C---C---C---C---C---C---C---C---C---C-C*/
+    class RectanglePacker final
+    {
+    public:
+        RectanglePacker(_In_ UINT uLayerWidth, _In_ UINT uLayerHeight);
+        RectanglePacker(const RectanglePacker& other) = default;
+        RectanglePacker(RectanglePacker&& other) = default;
+        RectanglePacker& operator=(const RectanglePacker& other) = default;
+        RectanglePacker& operator=(RectanglePacker&& other) = default;
+        ~RectanglePacker() = default;
+
+        HRESULT Pack(_Inout_ std::vector<PackedRectangle>& aRectangles);
+        UINT GetNumLayers() const;
+        FLOAT GetOccupancy() const;
+
+    private:
+        /*S+S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S
+          Struct:   SkylineSegment
+
+          Summary:  Span of the top edge of a layer, from uX and
+                    uWidth texels wide, at height uY
+        S---S---S---S---S---S---S---S---S---S---S---S---S---S---S---S---S-S*/
+        struct SkylineSegment
+        {
+            UINT uX;
+            UINT uY;
+            UINT uWidth;
+        };
+
+        BOOL findPosition(_In_ const std::vector<SkylineSegment>& aSkyline, _In_ UINT uWidth, _In_ UINT uHeight, _Out_ size_t* puSegment, _Out_ UINT* puX, _Out_ UINT* puY) const;
+        static void addRectangle(_Inout_ std::vector<SkylineSegment>& aSkyline, _In_ size_t uSegment, _In_ UINT uX, _In_ UINT uY, _In_ UINT uWidth, _In_ UINT uHeight);
+
+        UINT m_uLayerWidth;
+        UINT m_uLayerHeight;
+        UINT64 m_uPackedArea;
+        std::vector<std::vector<SkylineSegment>> m_aSkylines;
+    };
+}
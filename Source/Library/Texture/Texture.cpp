@@ -1,6 +1,14 @@
 #include "Texture.h"
 
+#include <algorithm>
+#include <thread>
+
+#include "Texture/DDSFile.h"
 #include "Texture/DDSTextureLoader.h"
+#include "Texture/FileMapping.h"
+#include "Texture/TextureArchive.h"
+#include "Texture/TextureCooker.h"
+#include "Texture/TextureStreamer.h"
 #include "Texture/WICTextureLoader.h"
 
 namespace library
@@ -17,11 +25,12 @@ namespace library
                 eTextureSamplerType textureSamplerType
                   Texture sampler type of this texture
 
-      Modifies: [m_filePath, m_textureRV, m_textureSamplerType].
+      Modifies: [m_filePath, m_textureRV, m_textureSamplerType,
+                 m_uMemorySize].
     M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
 
     Texture::Texture(_In_ const std::filesystem::path& filePath, _In_opt_ eTextureSamplerType textureSamplerType)
-        :m_filePath(filePath), m_textureRV(nullptr), m_textureSamplerType(textureSamplerType)
+        :m_filePath(filePath), m_textureRV(nullptr), m_textureSamplerType(textureSamplerType), m_uMemorySize(0u)
     {
 
     }
@@ -29,34 +38,65 @@ namespace library
     /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
       Method:   Texture::Initialize
 
-      Summary:  Initializes the texture and samplers if not initialized
+      Summary:  Initializes the texture and samplers if not initialized.
+                Textures are shared between materials, so a texture
+                already loaded is left as is. A texture owned by a
+                shared pointer is streamed when the global streamer is
+                enabled, it shows the placeholder until then. DDS files
+                and images cooked to DDS are mapped and created in place
 
       Args:     ID3D11Device* pDevice
                   The Direct3D device to create the buffers
                 ID3D11DeviceContext* pImmediateContext
                   The Direct3D context to set buffers
 
-      Modifies: [m_textureRV].
+      Modifies: [m_textureRV, m_uMemorySize].
     M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
     HRESULT Texture::Initialize(_In_ ID3D11Device* pDevice, _In_ ID3D11DeviceContext* pImmediateContext)
     {
-        HRESULT hr = CreateWICTextureFromFile(
-            pDevice,
-            pImmediateContext,
-            m_filePath.c_str(),
-            nullptr,
-            m_textureRV.GetAddressOf()
-        );
+        if (!pDevice || m_textureRV)
+        {
+            return S_OK;
+        }
+
+        HRESULT hr = E_NOTIMPL;
+        const std::shared_ptr<Texture> texture = weak_from_this().lock();
+        if (texture && TextureStreamer::GetGlobal().IsEnabled())
+        {
+            hr = TextureStreamer::GetGlobal().Stream(texture);
+        }
+
+        if (FAILED(hr))
+        {
+            hr = loadMappedDDS(pDevice);
+        }
+
         if (FAILED(hr))
         {
-            hr = CreateDDSTextureFromFile(pDevice, m_filePath.c_str(), nullptr, m_textureRV.GetAddressOf());
+            hr = loadDecodedImage(pDevice);
+        }
+
+        if (FAILED(hr))
+        {
+            hr = CreateWICTextureFromFile(
+                pDevice,
+                pImmediateContext,
+                m_filePath.c_str(),
+                nullptr,
+                m_textureRV.GetAddressOf()
+            );
             if (FAILED(hr))
             {
-                OutputDebugString(L"Can't load texture from \"");
-                OutputDebugString(m_filePath.c_str());
-                OutputDebugString(L"\n");
-                return hr;
+                hr = CreateDDSTextureFromFile(pDevice, m_filePath.c_str(), nullptr, m_textureRV.GetAddressOf());
+                if (FAILED(hr))
+                {
+                    OutputDebugString(L"Can't load texture from \"");
+                    OutputDebugString(m_filePath.c_str());
+                    OutputDebugString(L"\n");
+                    return hr;
+                }
             }
+            m_uMemorySize = computeMemorySize(m_textureRV.Get());
         }
 
         // Create the sample state
@@ -129,4 +169,414 @@ namespace library
     {
         return m_textureSamplerType;
     }
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   Texture::GetFilePath
+
+      Summary:  Returns the path the texture is loaded from
+
+      Returns:  const std::filesystem::path&
+                  Path to the texture file
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    const std::filesystem::path& Texture::GetFilePath() const
+    {
+        return m_filePath;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   Texture::GetMemorySize
+
+      Summary:  Returns the estimated GPU memory of the texture, zero
+                until it is loaded
+
+      Returns:  UINT64
+                  Memory in bytes
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    UINT64 Texture::GetMemorySize() const
+    {
+        return m_uMemorySize;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   Texture::CreateFromImage
+
+      Summary:  Creates an immutable 2D texture and its view from a
+                decoded image, every mip of its chain a subresource
+
+      Args:     ID3D11Device* pDevice
+                  The Direct3D device to create the texture
+                const DecodedImage& image
+                  Image and its mip chain
+                DXGI_FORMAT format
+                  Format of the texels of the image
+                ComPtr<ID3D11ShaderResourceView>& textureRV
+                  View of the texture
+
+      Modifies: [textureRV].
+
+      Returns:  HRESULT
+                  Status code
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    HRESULT Texture::CreateFromImage(_In_ ID3D11Device* pDevice, _In_ const DecodedImage& image, _In_ DXGI_FORMAT format, _Out_ ComPtr<ID3D11ShaderResourceView>& textureRV)
+    {
+        if (image.aMips.empty())
+        {
+            return E_INVALIDARG;
+        }
+
+        const D3D11_TEXTURE2D_DESC desc =
+        {
+            .Width = image.aMips[0].uWidth,
+            .Height = image.aMips[0].uHeight,
+            .MipLevels = static_cast<UINT>(image.aMips.size()),
+            .ArraySize = 1u,
+            .Format = format,
+            .SampleDesc = {.Count = 1u, .Quality = 0u },
+            .Usage = D3D11_USAGE_IMMUTABLE,
+            .BindFlags = D3D11_BIND_SHADER_RESOURCE,
+            .CPUAccessFlags = 0u,
+            .MiscFlags = 0u
+        };
+
+        std::vector<D3D11_SUBRESOURCE_DATA> aInitData(image.aMips.size());
+        for (size_t i = 0u; i < image.aMips.size(); ++i)
+        {
+            const DecodedMip& mip = image.aMips[i];
+            aInitData[i] =
+            {
+                .pSysMem = mip.aData.data(),
+                .SysMemPitch = mip.uRowPitch,
+                .SysMemSlicePitch = mip.uRowPitch * mip.uHeight
+            };
+        }
+
+        ComPtr<ID3D11Texture2D> texture2D;
+        HRESULT hr = pDevice->CreateTexture2D(&desc, aInitData.data(), texture2D.GetAddressOf());
+        if (FAILED(hr))
+        {
+            return hr;
+        }
+
+        return pDevice->CreateShaderResourceView(texture2D.Get(), nullptr, textureRV.ReleaseAndGetAddressOf());
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   Texture::getDDSFilePath
+
+      Summary:  Returns the path of the DDS file of the texture, the
+                file itself or the file its image was cooked to
+
+      Returns:  std::filesystem::path
+                  Path to the DDS file
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    std::filesystem::path Texture::getDDSFilePath() const
+    {
+        return DDSFile::HasExtension(m_filePath) ? m_filePath : TextureCooker::GetCookedPath(m_filePath);
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   Texture::hasDDSFile
+
+      Summary:  Tells whether the DDS file of the texture is in a
+                mounted archive or on the file system
+
+      Returns:  BOOL
+                  TRUE if the texture can be mapped
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    BOOL Texture::hasDDSFile() const
+    {
+        const std::filesystem::path ddsFilePath = getDDSFilePath();
+        FileRange range = {};
+        std::error_code error;
+
+        return TextureArchive::FindMounted(ddsFilePath, &range) || std::filesystem::is_regular_file(ddsFilePath, error);
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   Texture::loadMappedDDS
+
+      Summary:  Creates the texture from its DDS file, in a mounted
+                archive or mapped from the file system. The subresources
+                handed to Direct3D point into the mapping, the file is
+                never read into a buffer of its own
+
+      Args:     ID3D11Device* pDevice
+                  The Direct3D device to create the texture
+
+      Modifies: [m_textureRV, m_uMemorySize].
+
+      Returns:  HRESULT
+                  E_NOTIMPL for textures without DDS file, or whose
+                  layout DDSFile does not handle, for the loaders
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    HRESULT Texture::loadMappedDDS(_In_ ID3D11Device* pDevice)
+    {
+        HRESULT hr = S_OK;
+
+        const std::filesystem::path ddsFilePath = getDDSFilePath();
+        std::unique_ptr<FileMapping> mapping;
+        FileRange range = {};
+        if (!TextureArchive::FindMounted(ddsFilePath, &range))
+        {
+            std::error_code error;
+            if (!std::filesystem::is_regular_file(ddsFilePath, error))
+            {
+                return E_NOTIMPL;
+            }
+
+            mapping = FileMapping::Create();
+            hr = mapping->Open(ddsFilePath);
+            if (FAILED(hr))
+            {
+                return hr;
+            }
+            range = mapping->GetRange();
+        }
+
+        DDSFile dds;
+        hr = dds.Parse(range.pData, range.uSize);
+        if (FAILED(hr))
+        {
+            return hr;
+        }
+
+        hr = createFromDDS(pDevice, dds, m_textureRV);
+        if (FAILED(hr))
+        {
+            return hr;
+        }
+        m_uMemorySize = computeMemorySize(m_textureRV.Get());
+
+        return S_OK;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   Texture::loadDecodedImage
+
+      Summary:  Creates the texture from its image file decoded on the
+                CPU, its mips generated by MipGenerator on every core
+                instead of by the immediate context
+
+      Args:     ID3D11Device* pDevice
+                  The Direct3D device to create the texture
+
+      Modifies: [m_textureRV, m_uMemorySize].
+
+      Returns:  HRESULT
+                  E_NOTIMPL for DDS files, left to the DDS loader
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    HRESULT Texture::loadDecodedImage(_In_ ID3D11Device* pDevice)
+    {
+        if (DDSFile::HasExtension(m_filePath))
+        {
+            return E_NOTIMPL;
+        }
+
+        DecodedImage image;
+        HRESULT hr = TextureStreamer::Decode(m_filePath, std::max(std::thread::hardware_concurrency(), 1u), image);
+        if (FAILED(hr))
+        {
+            return hr;
+        }
+
+        hr = CreateFromImage(pDevice, image, DXGI_FORMAT_R8G8B8A8_UNORM, m_textureRV);
+        if (FAILED(hr))
+        {
+            return hr;
+        }
+        m_uMemorySize = computeMemorySize(m_textureRV.Get());
+
+        return S_OK;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   Texture::createFromDDS
+
+      Summary:  Creates a 2D texture, texture array or cube map and its
+                view from the subresources of a parsed DDS file
+
+      Args:     ID3D11Device* pDevice
+                  The Direct3D device to create the texture
+                const DDSFile& dds
+                  Parsed DDS file
+                ComPtr<ID3D11ShaderResourceView>& textureRV
+                  View of the texture
+
+      Modifies: [textureRV].
+
+      Returns:  HRESULT
+                  E_NOTIMPL for 1D and volume textures
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    HRESULT Texture::createFromDDS(_In_ ID3D11Device* pDevice, _In_ const DDSFile& dds, _Out_ ComPtr<ID3D11ShaderResourceView>& textureRV)
+    {
+        const DDSDescription& description = dds.GetDescription();
+        if (description.uDimension != 2u)
+        {
+            return E_NOTIMPL;
+        }
+
+        const UINT uArraySize = description.uArraySize * (description.bCubeMap ? 6u : 1u);
+        D3D11_TEXTURE2D_DESC desc =
+        {
+            .Width = description.uWidth,
+            .Height = description.uHeight,
+            .MipLevels = description.uMipLevels,
+            .ArraySize = uArraySize,
+            .Format = static_cast<DXGI_FORMAT>(description.uFormat),
+            .SampleDesc = {.Count = 1u, .Quality = 0u },
+            .Usage = D3D11_USAGE_IMMUTABLE,
+            .BindFlags = D3D11_BIND_SHADER_RESOURCE,
+            .CPUAccessFlags = 0u,
+            .MiscFlags = description.bCubeMap ? static_cast<UINT>(D3D11_RESOURCE_MISC_TEXTURECUBE) : 0u
+        };
+
+        std::vector<D3D11_SUBRESOURCE_DATA> aInitData(dds.GetNumSubresources());
+        for (UINT i = 0u; i < dds.GetNumSubresources(); ++i)
+        {
+            const DDSSubresource& subresource = dds.GetSubresource(i);
+            aInitData[i] =
+            {
+                .pSysMem = subresource.pData,
+                .SysMemPitch = subresource.uRowPitch,
+                .SysMemSlicePitch = subresource.uSlicePitch
+            };
+        }
+
+        ComPtr<ID3D11Texture2D> texture2D;
+        HRESULT hr = pDevice->CreateTexture2D(&desc, aInitData.data(), texture2D.GetAddressOf());
+        if (FAILED(hr))
+        {
+            return hr;
+        }
+
+        D3D11_SHADER_RESOURCE_VIEW_DESC srvDesc = {};
+        srvDesc.Format = desc.Format;
+        if (description.bCubeMap && description.uArraySize > 1u)
+        {
+            srvDesc.ViewDimension = D3D11_SRV_DIMENSION_TEXTURECUBEARRAY;
+            srvDesc.TextureCubeArray.MipLevels = desc.MipLevels;
+            srvDesc.TextureCubeArray.NumCubes = description.uArraySize;
+        }
+        else if (description.bCubeMap)
+        {
+            srvDesc.ViewDimension = D3D11_SRV_DIMENSION_TEXTURECUBE;
+            srvDesc.TextureCube.MipLevels = desc.MipLevels;
+        }
+        else if (uArraySize > 1u)
+        {
+            srvDesc.ViewDimension = D3D11_SRV_DIMENSION_TEXTURE2DARRAY;
+            srvDesc.Texture2DArray.MipLevels = desc.MipLevels;
+            srvDesc.Texture2DArray.ArraySize = uArraySize;
+        }
+        else
+        {
+            srvDesc.ViewDimension = D3D11_SRV_DIMENSION_TEXTURE2D;
+            srvDesc.Texture2D.MipLevels = desc.MipLevels;
+        }
+
+        return pDevice->CreateShaderResourceView(texture2D.Get(), &srvDesc, textureRV.ReleaseAndGetAddressOf());
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   Texture::computeMemorySize
+
+      Summary:  Estimates the memory of the 2D texture behind a view,
+                every mip of every slice. Block compressed mips are
+                rounded up to whole 4x4 blocks
+
+      Args:     ID3D11ShaderResourceView* pTextureView
+                  View of the texture
+
+      Returns:  UINT64
+                  Memory in bytes, zero if the view is not of a 2D
+                  texture
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    UINT64 Texture::computeMemorySize(_In_ ID3D11ShaderResourceView* pTextureView)
+    {
+        ComPtr<ID3D11Resource> resource;
+        pTextureView->GetResource(resource.GetAddressOf());
+
+        ComPtr<ID3D11Texture2D> texture2D;
+        if (FAILED(resource.As(&texture2D)))
+        {
+            return 0u;
+        }
+
+        D3D11_TEXTURE2D_DESC desc = {};
+        texture2D->GetDesc(&desc);
+
+        UINT64 uBitsPerPixel = 32u;
+        BOOL bBlockCompressed = FALSE;
+        switch (desc.Format)
+        {
+        case DXGI_FORMAT_BC1_TYPELESS:
+        case DXGI_FORMAT_BC1_UNORM:
+        case DXGI_FORMAT_BC1_UNORM_SRGB:
+        case DXGI_FORMAT_BC4_TYPELESS:
+        case DXGI_FORMAT_BC4_UNORM:
+        case DXGI_FORMAT_BC4_SNORM:
+            uBitsPerPixel = 4u;
+            bBlockCompressed = TRUE;
+            break;
+        case DXGI_FORMAT_BC2_TYPELESS:
+        case DXGI_FORMAT_BC2_UNORM:
+        case DXGI_FORMAT_BC2_UNORM_SRGB:
+        case DXGI_FORMAT_BC3_TYPELESS:
+        case DXGI_FORMAT_BC3_UNORM:
+        case DXGI_FORMAT_BC3_UNORM_SRGB:
+        case DXGI_FORMAT_BC5_TYPELESS:
+        case DXGI_FORMAT_BC5_UNORM:
+        case DXGI_FORMAT_BC5_SNORM:
+        case DXGI_FORMAT_BC6H_TYPELESS:
+        case DXGI_FORMAT_BC6H_UF16:
+        case DXGI_FORMAT_BC6H_SF16:
+        case DXGI_FORMAT_BC7_TYPELESS:
+        case DXGI_FORMAT_BC7_UNORM:
+        case DXGI_FORMAT_BC7_UNORM_SRGB:
+            uBitsPerPixel = 8u;
+            bBlockCompressed = TRUE;
+            break;
+        case DXGI_FORMAT_R32G32B32A32_TYPELESS:
+        case DXGI_FORMAT_R32G32B32A32_FLOAT:
+        case DXGI_FORMAT_R32G32B32A32_UINT:
+        case DXGI_FORMAT_R32G32B32A32_SINT:
+            uBitsPerPixel = 128u;
+            break;
+        case DXGI_FORMAT_R16G16B16A16_TYPELESS:
+        case DXGI_FORMAT_R16G16B16A16_FLOAT:
+        case DXGI_FORMAT_R16G16B16A16_UNORM:
+        case DXGI_FORMAT_R16G16B16A16_UINT:
+        case DXGI_FORMAT_R16G16B16A16_SNORM:
+        case DXGI_FORMAT_R16G16B16A16_SINT:
+            uBitsPerPixel = 64u;
+            break;
+        case DXGI_FORMAT_R8G8_TYPELESS:
+        case DXGI_FORMAT_R8G8_UNORM:
+        case DXGI_FORMAT_R16_FLOAT:
+        case DXGI_FORMAT_R16_UNORM:
+            uBitsPerPixel = 16u;
+            break;
+        case DXGI_FORMAT_R8_TYPELESS:
+        case DXGI_FORMAT_R8_UNORM:
+        case DXGI_FORMAT_A8_UNORM:
+            uBitsPerPixel = 8u;
+            break;
+        default:
+            break;
+        }
+
+        UINT64 uMemorySize = 0u;
+        for (UINT uMip = 0u; uMip < desc.MipLevels; ++uMip)
+        {
+            UINT64 uWidth = std::max(desc.Width >> uMip, 1u);
+            UINT64 uHeight = std::max(desc.Height >> uMip, 1u);
+            if (bBlockCompressed)
+            {
+                uWidth = (uWidth + 3u) & ~3ull;
+                uHeight = (uHeight + 3u) & ~3ull;
+            }
+            uMemorySize += uWidth * uHeight * uBitsPerPixel / 8u;
+        }
+
+        return uMemorySize * desc.ArraySize;
+    }
 }
\ No newline at end of file
@@ -21,8 +21,15 @@ namespace library
         COUNT,
     };
 
-    class Texture
+    class DDSFile;
+    class TextureStreamer;
+    struct DecodedImage;
+
+    class Texture : public std::enable_shared_from_this<Texture>
     {
+        friend class TextureStreamer;
+
+
     public:
         Texture() = delete;
         Texture(_In_ const std::filesystem::path& filePath, _In_opt_ eTextureSamplerType textureSamplerType = eTextureSamplerType::TRILINEAR_WRAP);
@@ -32,18 +39,34 @@ namespace library
         Texture& operator=(Texture&& other) = delete;
         virtual ~Texture() = default;
 
-        // Should be called once to load the texture
+        // Loads the texture, a texture already loaded returns at once.
+        // Image files of a shared texture are streamed while the global
+        // texture streamer is enabled
         virtual HRESULT Initialize(_In_ ID3D11Device* pDevice, _In_ ID3D11DeviceContext* pImmediateContext);
 
         ComPtr<ID3D11ShaderResourceView>& GetTextureResourceView();
         eTextureSamplerType GetSamplerType() const;
+        const std::filesystem::path& GetFilePath() const;
+        UINT64 GetMemorySize() const;
+
+        // Creates an immutable texture from an image and its mip chain,
+        // one generated by MipGenerator for images made in memory
+        static HRESULT CreateFromImage(_In_ ID3D11Device* pDevice, _In_ const DecodedImage& image, _In_ DXGI_FORMAT format, _Out_ ComPtr<ID3D11ShaderResourceView>& textureRV);
 
     public:
         static ComPtr<ID3D11SamplerState> s_samplers[static_cast<size_t>(eTextureSamplerType::COUNT)];
 
     protected:
+        std::filesystem::path getDDSFilePath() const;
+        BOOL hasDDSFile() const;
+        HRESULT loadMappedDDS(_In_ ID3D11Device* pDevice);
+        HRESULT loadDecodedImage(_In_ ID3D11Device* pDevice);
+        static HRESULT createFromDDS(_In_ ID3D11Device* pDevice, _In_ const DDSFile& dds, _Out_ ComPtr<ID3D11ShaderResourceView>& textureRV);
+        static UINT64 computeMemorySize(_In_ ID3D11ShaderResourceView* pTextureView);
+
         std::filesystem::path m_filePath;
         ComPtr<ID3D11ShaderResourceView> m_textureRV;
         eTextureSamplerType m_textureSamplerType;
+        UINT64 m_uMemorySize;
     };
 }
\ No newline at end of file
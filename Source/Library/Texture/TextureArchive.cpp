@@ -0,0 +1,304 @@
+#include "Texture/TextureArchive.h"
+
+#include <fstream>
+
+namespace library
+{
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   TextureArchive::TextureArchive
+      Summary:  Constructor. Holds no archive until opened
+      Modifies: [m_mapping, m_entries].
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    TextureArchive::TextureArchive()
+        : m_mapping(FileMapping::Create())
+        , m_entries()
+    {
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   TextureArchive::Open
+      Summary:  Maps an archive and validates its entries, closing the
+                previous one
+      Args:     const std::filesystem::path& archivePath
+                  Path to the archive
+      Modifies: [m_mapping, m_entries].
+      Returns:  HRESULT
+                  Status code
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    HRESULT TextureArchive::Open(_In_ const std::filesystem::path& archivePath)
+    {
+        Close();
+
+        HRESULT hr = m_mapping->Open(archivePath);
+        if (FAILED(hr))
+        {
+            return hr;
+        }
+
+        const BYTE* pData = m_mapping->GetData();
+        const UINT64 uSize = m_mapping->GetSize();
+        UINT aHeader[HEADER_SIZE / sizeof(UINT)] = {};
+        if (uSize < HEADER_SIZE)
+        {
+            Close();
+            return E_FAIL;
+        }
+        std::memcpy(aHeader, pData, HEADER_SIZE);
+
+        const UINT uNumEntries = aHeader[2];
+        if (aHeader[0] != MAGIC || aHeader[1] != VERSION || uNumEntries > (uSize - HEADER_SIZE) / ENTRY_SIZE)
+        {
+            Close();
+            return E_FAIL;
+        }
+
+        m_entries.reserve(uNumEntries);
+        for (UINT i = 0u; i < uNumEntries; ++i)
+        {
+            UINT64 uOffset = 0u;
+            UINT64 uFileSize = 0u;
+            UINT uNameOffset = 0u;
+            UINT uNameLength = 0u;
+            const BYTE* pEntry = pData + HEADER_SIZE + static_cast<UINT64>(i) * ENTRY_SIZE;
+            std::memcpy(&uOffset, pEntry, sizeof(uOffset));
+            std::memcpy(&uFileSize, pEntry + 8u, sizeof(uFileSize));
+            std::memcpy(&uNameOffset, pEntry + 16u, sizeof(uNameOffset));
+            std::memcpy(&uNameLength, pEntry + 20u, sizeof(uNameLength));
+
+            if (uOffset > uSize || uFileSize > uSize - uOffset || uNameOffset > uSize || uNameLength > uSize - uNameOffset)
+            {
+                Close();
+                return E_FAIL;
+            }
+
+            m_entries.emplace(std::string(reinterpret_cast<const CHAR*>(pData + uNameOffset), uNameLength),
+                FileRange{ .pData = pData + uOffset, .uSize = uFileSize });
+        }
+
+        return S_OK;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   TextureArchive::Close
+      Summary:  Unmaps the archive, ranges found in it dangle
+      Modifies: [m_mapping, m_entries].
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    void TextureArchive::Close()
+    {
+        m_entries.clear();
+        m_mapping->Close();
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   TextureArchive::Find
+      Summary:  Returns the bytes of a file of the archive, valid until
+                the archive is closed
+      Args:     const std::filesystem::path& filePath
+                  Path the file was packed from
+                FileRange* pRange
+                  Bytes of the file
+      Modifies: [pRange].
+      Returns:  BOOL
+                  TRUE if the archive holds the file
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    BOOL TextureArchive::Find(_In_ const std::filesystem::path& filePath, _Out_ FileRange* pRange) const
+    {
+        *pRange = FileRange{ .pData = nullptr, .uSize = 0u };
+
+        const auto it = m_entries.find(makeName(filePath));
+        if (it == m_entries.end())
+        {
+            return FALSE;
+        }
+
+        *pRange = it->second;
+
+        return TRUE;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   TextureArchive::GetNumEntries
+      Summary:  Returns the number of files of the archive
+      Returns:  UINT
+                  Number of files
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    UINT TextureArchive::GetNumEntries() const
+    {
+        return static_cast<UINT>(m_entries.size());
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   TextureArchive::Write
+      Summary:  Packs files into an archive, named by the paths given
+      Args:     const std::filesystem::path& archivePath
+                  Path to the archive to write
+                const std::vector<std::filesystem::path>& aFilePaths
+                  Files to pack
+      Returns:  HRESULT
+                  Status code
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    HRESULT TextureArchive::Write(_In_ const std::filesystem::path& archivePath, _In_ const std::vector<std::filesystem::path>& aFilePaths)
+    {
+        std::vector<std::string> aszNames;
+        std::vector<UINT64> auFileSizes;
+        aszNames.reserve(aFilePaths.size());
+        auFileSizes.reserve(aFilePaths.size());
+
+        UINT64 uOffset = HEADER_SIZE + static_cast<UINT64>(aFilePaths.size()) * ENTRY_SIZE;
+        for (const std::filesystem::path& filePath : aFilePaths)
+        {
+            std::error_code error;
+            const UINT64 uFileSize = std::filesystem::file_size(filePath, error);
+            if (error)
+            {
+                return E_INVALIDARG;
+            }
+
+            aszNames.push_back(makeName(filePath));
+            auFileSizes.push_back(uFileSize);
+            uOffset += aszNames.back().size();
+        }
+
+        std::vector<BYTE> aHeaders(static_cast<size_t>(HEADER_SIZE + aFilePaths.size() * ENTRY_SIZE));
+        const UINT aHeader[HEADER_SIZE / sizeof(UINT)] = { MAGIC, VERSION, static_cast<UINT>(aFilePaths.size()), 0u };
+        std::memcpy(aHeaders.data(), aHeader, HEADER_SIZE);
+
+        UINT uNameOffset = static_cast<UINT>(aHeaders.size());
+        for (size_t i = 0u; i < aFilePaths.size(); ++i)
+        {
+            uOffset = (uOffset + FILE_ALIGNMENT - 1u) & ~static_cast<UINT64>(FILE_ALIGNMENT - 1u);
+            const UINT uNameLength = static_cast<UINT>(aszNames[i].size());
+
+            BYTE* pEntry = aHeaders.data() + HEADER_SIZE + i * ENTRY_SIZE;
+            std::memcpy(pEntry, &uOffset, sizeof(uOffset));
+            std::memcpy(pEntry + 8u, &auFileSizes[i], sizeof(UINT64));
+            std::memcpy(pEntry + 16u, &uNameOffset, sizeof(uNameOffset));
+            std::memcpy(pEntry + 20u, &uNameLength, sizeof(uNameLength));
+
+            uOffset += auFileSizes[i];
+            uNameOffset += uNameLength;
+        }
+
+        std::ofstream archive(archivePath, std::ios::binary | std::ios::trunc);
+        if (!archive)
+        {
+            return E_FAIL;
+        }
+
+        archive.write(reinterpret_cast<const CHAR*>(aHeaders.data()), static_cast<std::streamsize>(aHeaders.size()));
+        for (const std::string& szName : aszNames)
+        {
+            archive.write(szName.data(), static_cast<std::streamsize>(szName.size()));
+        }
+
+        std::vector<CHAR> aFileData;
+        for (size_t i = 0u; i < aFilePaths.size(); ++i)
+        {
+            const std::streamoff uPosition = archive.tellp();
+            const std::streamoff uPadding = (FILE_ALIGNMENT - uPosition % FILE_ALIGNMENT) % FILE_ALIGNMENT;
+            const CHAR aZeros[FILE_ALIGNMENT] = {};
+            archive.write(aZeros, uPadding);
+
+            std::ifstream file(aFilePaths[i], std::ios::binary);
+            aFileData.resize(static_cast<size_t>(auFileSizes[i]));
+            if (!file.read(aFileData.data(), static_cast<std::streamsize>(aFileData.size())))
+            {
+                return E_FAIL;
+            }
+            archive.write(aFileData.data(), static_cast<std::streamsize>(aFileData.size()));
+        }
+
+        return archive ? S_OK : E_FAIL;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   TextureArchive::Mount
+      Summary:  Opens an archive whose files the texture loader finds
+                before the file system. Archives mounted later are
+                searched first. Not thread safe, mount before loading
+      Args:     const std::filesystem::path& archivePath
+                  Path to the archive
+      Returns:  HRESULT
+                  Status code
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    HRESULT TextureArchive::Mount(_In_ const std::filesystem::path& archivePath)
+    {
+        std::unique_ptr<TextureArchive> archive = std::make_unique<TextureArchive>();
+        HRESULT hr = archive->Open(archivePath);
+        if (FAILED(hr))
+        {
+            return hr;
+        }
+
+        getMounted().push_back(std::move(archive));
+
+        return S_OK;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   TextureArchive::UnmountAll
+      Summary:  Closes every mounted archive. Textures already created
+                from them keep their copy on the GPU
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    void TextureArchive::UnmountAll()
+    {
+        getMounted().clear();
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   TextureArchive::FindMounted
+      Summary:  Looks a file up in the mounted archives, the last
+                mounted first
+      Args:     const std::filesystem::path& filePath
+                  Path the file was packed from
+                FileRange* pRange
+                  Bytes of the file
+      Modifies: [pRange].
+      Returns:  BOOL
+                  TRUE if a mounted archive holds the file
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    BOOL TextureArchive::FindMounted(_In_ const std::filesystem::path& filePath, _Out_ FileRange* pRange)
+    {
+        *pRange = FileRange{ .pData = nullptr, .uSize = 0u };
+
+        const std::vector<std::unique_ptr<TextureArchive>>& aMounted = getMounted();
+        for (auto it = aMounted.rbegin(); it != aMounted.rend(); ++it)
+        {
+            if ((*it)->Find(filePath, pRange))
+            {
+                return TRUE;
+            }
+        }
+
+        return FALSE;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   TextureArchive::makeName
+      Summary:  Returns the name a file is packed and looked up by, its
+                normalized path in generic form
+      Args:     const std::filesystem::path& filePath
+                  Path to the file
+      Returns:  std::string
+                  UTF-8 name
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    std::string TextureArchive::makeName(_In_ const std::filesystem::path& filePath)
+    {
+        const std::u8string szName = filePath.lexically_normal().generic_u8string();
+
+        return std::string(szName.begin(), szName.end());
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   TextureArchive::getMounted
+      Summary:  Returns the mounted archives, created on first use
+      Returns:  std::vector<std::unique_ptr<TextureArchive>>&
+                  Mounted archives, in mount order
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    std::vector<std::unique_ptr<TextureArchive>>& TextureArchive::getMounted()
+    {
+        static std::vector<std::unique_ptr<TextureArchive>> s_aMounted;
+
+        return s_aMounted;
+    }
+}
@@ -0,0 +1,91 @@
+﻿/*+===================================================================
+  File:      TEXTUREARCHIVE.H
+
+  Summary:   TextureArchive header file contains declarations of the
+             TextureArchive class, a memory-mapped pack of texture
+             files.
+
+  Classes: TextureArchive
+
+  © 2022 Kyung Hee University
+===================================================================+*/
+#pragma once
+
+#include "Common.h"
+
+#include "Texture/FileMapping.h"
+
+namespace library
+{
+    /*C+C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C
+      Class:    TextureArchive
+
+      Summary:  Pack of files mapped as a whole, whose entries point
+                into the mapping. The archive starts with a header, the
+                magic "TPAK", the version and the number of entries,
+                followed by the entries, each the offset, size, name
+                offset and name length of a file, then the UTF-8 names
+                and the files, each aligned to 16 bytes. Little-endian.
+                Names are the paths the files were packed from, in
+                generic form, and are looked up the same way. Mounted
+                archives are searched by the texture loader before the
+                file system
+
+      Methods:  Open
+                  Maps an archive
+                Close
+                  Unmaps the archive
+                Find
+                  Returns the bytes of a file of the archive
+                GetNumEntries
+                  Returns the number of files
+                Write
+                  Packs files into an archive
+                Mount
+                  Opens an archive for the whole library
+                UnmountAll
+                  Closes every mounted archive
+                FindMounted
+                  Looks a file up in the mounted archives
+                TextureArchive
+                  Constructor.
+                ~TextureArchive
+                  Destructor.
+    C---C---C---C---C---C---C---C---C---C---C---C---C---C---C---C---C-C*/
+    class TextureArchive final
+    {
+    public:
+        static constexpr UINT MAGIC = 0x4B415054u;
+        static constexpr UINT VERSION = 1u;
+        static constexpr UINT HEADER_SIZE = 16u;
+        static constexpr UINT ENTRY_SIZE = 24u;
+        static constexpr UINT FILE_ALIGNMENT = 16u;
+
+    public:
+        TextureArchive();
+        TextureArchive(const TextureArchive& other) = delete;
+        TextureArchive(TextureArchive&& other) = delete;
+        TextureArchive& operator=(const TextureArchive& other) = delete;
+        TextureArchive& operator=(TextureArchive&& other) = delete;
+        ~TextureArchive() = default;
+
+        HRESULT Open(_In_ const std::filesystem::path& archivePath);
+        void Close();
+
+        BOOL Find(_In_ const std::filesystem::path& filePath, _Out_ FileRange* pRange) const;
+        UINT GetNumEntries() const;
+
+        static HRESULT Write(_In_ const std::filesystem::path& archivePath, _In_ const std::vector<std::filesystem::path>& aFilePaths);
+
+        static HRESULT Mount(_In_ const std::filesystem::path& archivePath);
+        static void UnmountAll();
+        static BOOL FindMounted(_In_ const std::filesystem::path& filePath, _Out_ FileRange* pRange);
+
+    private:
+        static std::string makeName(_In_ const std::filesystem::path& filePath);
+        static std::vector<std::unique_ptr<TextureArchive>>& getMounted();
+
+        std::unique_ptr<FileMapping> m_mapping;
+        std::unordered_map<std::string, FileRange> m_entries;
+    };
+}
@@ -0,0 +1,352 @@
+#include "Texture/TextureAtlas.h"
+
+#include <algorithm>
+#include <bit>
+#include <cstring>
+
+#include "Texture/MipGenerator.h"
+
+namespace library
+{
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   TextureAtlas::TextureAtlas
+      Summary:  Constructor
+      Modifies: [m_aImages, m_aRegions, m_aLayers, m_uLayerSize,
+                  m_occupancy, m_textureRV].
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    TextureAtlas::TextureAtlas()
+        : m_aImages()
+        , m_aRegions()
+        , m_aLayers()
+        , m_uLayerSize(0u)
+        , m_occupancy(0.0f)
+        , m_textureRV()
+    {
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   TextureAtlas::Add
+      Summary:  Adds an image to pack, only its full resolution mip is
+                read
+      Args:     DecodedImage&& image
+                  RGBA8 image, its colors in sRGB
+      Modifies: [m_aImages].
+      Returns:  UINT
+                  Index of the region of the image once built
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    UINT TextureAtlas::Add(_In_ DecodedImage&& image)
+    {
+        m_aImages.push_back(std::move(image));
+
+        return static_cast<UINT>(m_aImages.size() - 1u);
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   TextureAtlas::Build
+      Summary:  Packs the images added into layers and filters the mips
+                of every layer. Footprints of the shared images are
+                aligned so that a texel of the kept mips never covers
+                two of them
+      Args:     UINT uNumMipThreads
+                  Threads filtering the mips of a layer
+      Modifies: [m_aRegions, m_aLayers, m_uLayerSize, m_occupancy].
+      Returns:  HRESULT
+                  E_INVALIDARG if an image is empty or does not fit the
+                  largest layer
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    HRESULT TextureAtlas::Build(_In_ UINT uNumMipThreads)
+    {
+        m_aRegions.clear();
+        m_aLayers.clear();
+        m_uLayerSize = 0u;
+        m_occupancy = 0.0f;
+
+        UINT uMaxSize = 0u;
+        for (const DecodedImage& image : m_aImages)
+        {
+            if (image.aMips.empty())
+            {
+                return E_INVALIDARG;
+            }
+
+            const DecodedMip& base = image.aMips[0];
+            if (base.uWidth == 0u || base.uHeight == 0u || base.uRowPitch < base.uWidth * 4u
+                || base.aData.size() < static_cast<size_t>(base.uRowPitch) * base.uHeight)
+            {
+                return E_INVALIDARG;
+            }
+            uMaxSize = std::max({ uMaxSize, base.uWidth, base.uHeight });
+        }
+
+        if (m_aImages.empty())
+        {
+            return S_OK;
+        }
+
+        auto getFootprint = [](UINT uSize)
+        {
+            return (uSize + 2u * BORDER + ALIGNMENT - 1u) & ~(ALIGNMENT - 1u);
+        };
+
+        // Layers grow when a bordered image does not fit, no image takes a whole one then
+        UINT uLayerSize = std::bit_ceil(std::min(uMaxSize, MAX_LAYER_SIZE + 1u));
+        UINT uMaxFootprint = 0u;
+        for (const DecodedImage& image : m_aImages)
+        {
+            const DecodedMip& base = image.aMips[0];
+            if (base.uWidth != uLayerSize || base.uHeight != uLayerSize)
+            {
+                uMaxFootprint = std::max({ uMaxFootprint, getFootprint(base.uWidth), getFootprint(base.uHeight) });
+            }
+        }
+        uLayerSize = std::max(uLayerSize, std::bit_ceil(std::min(uMaxFootprint, MAX_LAYER_SIZE + 1u)));
+        if (uLayerSize > MAX_LAYER_SIZE)
+        {
+            return E_INVALIDARG;
+        }
+
+        BOOL bShared = FALSE;
+        std::vector<PackedRectangle> aFootprints;
+        aFootprints.reserve(m_aImages.size());
+        for (const DecodedImage& image : m_aImages)
+        {
+            const DecodedMip& base = image.aMips[0];
+            const BOOL bWhole = base.uWidth == uLayerSize && base.uHeight == uLayerSize;
+            bShared = bShared || !bWhole;
+            aFootprints.push_back({ .uWidth = bWhole ? uLayerSize : getFootprint(base.uWidth), .uHeight = bWhole ? uLayerSize : getFootprint(base.uHeight),
+                .uX = 0u, .uY = 0u, .uLayer = 0u });
+        }
+
+        RectanglePacker packer(uLayerSize, uLayerSize);
+        HRESULT hr = packer.Pack(aFootprints);
+        if (FAILED(hr))
+        {
+            return hr;
+        }
+
+        m_aLayers.resize(packer.GetNumLayers());
+        for (DecodedImage& layer : m_aLayers)
+        {
+            layer.aMips.push_back({ .uWidth = uLayerSize, .uHeight = uLayerSize, .uRowPitch = uLayerSize * 4u, .aData = std::vector<BYTE>() });
+            layer.aMips[0].aData.resize(static_cast<size_t>(uLayerSize) * uLayerSize * 4u, 0u);
+        }
+
+        const FLOAT layerSize = static_cast<FLOAT>(uLayerSize);
+        UINT64 uImagesArea = 0u;
+        for (size_t i = 0u; i < m_aImages.size(); ++i)
+        {
+            const DecodedMip& base = m_aImages[i].aMips[0];
+            const PackedRectangle& footprint = aFootprints[i];
+            const UINT uBorder = (footprint.uWidth == uLayerSize && footprint.uHeight == uLayerSize && base.uWidth == uLayerSize) ? 0u : BORDER;
+
+            copyImage(base, footprint, uBorder, m_aLayers[footprint.uLayer].aMips[0]);
+            m_aRegions.push_back(
+                {
+                    .ScaleOffset = XMFLOAT4(static_cast<FLOAT>(base.uWidth) / layerSize, static_cast<FLOAT>(base.uHeight) / layerSize,
+                        static_cast<FLOAT>(footprint.uX + uBorder) / layerSize, static_cast<FLOAT>(footprint.uY + uBorder) / layerSize),
+                    .uLayer = footprint.uLayer
+                });
+            uImagesArea += static_cast<UINT64>(base.uWidth) * base.uHeight;
+        }
+
+        // Every layer of an array has as many mips
+        const MipGenerator mipGenerator(uNumMipThreads);
+        for (DecodedImage& layer : m_aLayers)
+        {
+            hr = mipGenerator.Generate(layer, eMipFormat::RGBA8_UNORM_SRGB, FALSE);
+            if (FAILED(hr))
+            {
+                return hr;
+            }
+
+            if (bShared && layer.aMips.size() > NUM_SHARED_MIPS)
+            {
+                layer.aMips.resize(NUM_SHARED_MIPS);
+            }
+        }
+
+        m_uLayerSize = uLayerSize;
+        m_occupancy = static_cast<FLOAT>(static_cast<double>(uImagesArea) / (static_cast<double>(uLayerSize) * uLayerSize * m_aLayers.size()));
+
+        return S_OK;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   TextureAtlas::Initialize
+      Summary:  Creates the immutable texture array of the built layers
+                and its view. An atlas without any layer has no view
+      Args:     ID3D11Device* pDevice
+                  The Direct3D device to create the texture
+      Modifies: [m_textureRV].
+      Returns:  HRESULT
+                  Status code
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    HRESULT TextureAtlas::Initialize(_In_ ID3D11Device* pDevice)
+    {
+        if (m_aLayers.empty())
+        {
+            return S_OK;
+        }
+
+        const UINT uNumMips = static_cast<UINT>(m_aLayers[0].aMips.size());
+        const UINT uNumLayers = static_cast<UINT>(m_aLayers.size());
+        const D3D11_TEXTURE2D_DESC desc =
+        {
+            .Width = m_uLayerSize,
+            .Height = m_uLayerSize,
+            .MipLevels = uNumMips,
+            .ArraySize = uNumLayers,
+            .Format = DXGI_FORMAT_R8G8B8A8_UNORM,
+            .SampleDesc = {.Count = 1u, .Quality = 0u },
+            .Usage = D3D11_USAGE_IMMUTABLE,
+            .BindFlags = D3D11_BIND_SHADER_RESOURCE,
+            .CPUAccessFlags = 0u,
+            .MiscFlags = 0u
+        };
+
+        // Subresources go mip by mip within a layer
+        std::vector<D3D11_SUBRESOURCE_DATA> aInitData;
+        aInitData.reserve(static_cast<size_t>(uNumLayers) * uNumMips);
+        for (const DecodedImage& layer : m_aLayers)
+        {
+            for (const DecodedMip& mip : layer.aMips)
+            {
+                aInitData.push_back({ .pSysMem = mip.aData.data(), .SysMemPitch = mip.uRowPitch, .SysMemSlicePitch = mip.uRowPitch * mip.uHeight });
+            }
+        }
+
+        ComPtr<ID3D11Texture2D> texture2D;
+        HRESULT hr = pDevice->CreateTexture2D(&desc, aInitData.data(), texture2D.GetAddressOf());
+        if (FAILED(hr))
+        {
+            return hr;
+        }
+
+        // An array of one layer is still viewed as an array
+        D3D11_SHADER_RESOURCE_VIEW_DESC srvDesc = {};
+        srvDesc.Format = desc.Format;
+        srvDesc.ViewDimension = D3D11_SRV_DIMENSION_TEXTURE2DARRAY;
+        srvDesc.Texture2DArray.MostDetailedMip = 0u;
+        srvDesc.Texture2DArray.MipLevels = uNumMips;
+        srvDesc.Texture2DArray.FirstArraySlice = 0u;
+        srvDesc.Texture2DArray.ArraySize = uNumLayers;
+
+        return pDevice->CreateShaderResourceView(texture2D.Get(), &srvDesc, m_textureRV.ReleaseAndGetAddressOf());
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   TextureAtlas::GetNumRegions
+      Summary:  Returns the number of images added
+      Returns:  UINT
+                  Number of regions
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    UINT TextureAtlas::GetNumRegions() const
+    {
+        return static_cast<UINT>(m_aRegions.size());
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   TextureAtlas::GetRegion
+      Summary:  Returns where an image was packed by the last build
+      Args:     UINT uRegion
+                  Index Add returned for the image
+      Returns:  const AtlasRegion&
+                  Layer and texture coordinate mapping of the image
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    const AtlasRegion& TextureAtlas::GetRegion(_In_ UINT uRegion) const
+    {
+        return m_aRegions[uRegion];
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   TextureAtlas::GetNumLayers
+      Summary:  Returns the number of layers of the last build
+      Returns:  UINT
+                  Number of layers
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    UINT TextureAtlas::GetNumLayers() const
+    {
+        return static_cast<UINT>(m_aLayers.size());
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   TextureAtlas::GetLayerSize
+      Summary:  Returns the width and height of the layers
+      Returns:  UINT
+                  Size of a layer in texels, 0 before a build
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    UINT TextureAtlas::GetLayerSize() const
+    {
+        return m_uLayerSize;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   TextureAtlas::GetLayers
+      Summary:  Returns the layers of the last build
+      Returns:  const std::vector<DecodedImage>&
+                  Layers and their mips
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    const std::vector<DecodedImage>& TextureAtlas::GetLayers() const
+    {
+        return m_aLayers;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   TextureAtlas::GetOccupancy
+      Summary:  Returns the area of the images over the area of the
+                layers, borders and gaps are the rest
+      Returns:  FLOAT
+                  Ratio from 0 to 1
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    FLOAT TextureAtlas::GetOccupancy() const
+    {
+        return m_occupancy;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   TextureAtlas::GetTextureResourceView
+      Summary:  Returns the view of the texture array
+      Returns:  ComPtr<ID3D11ShaderResourceView>&
+                  View of every layer, null before Initialize
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    ComPtr<ID3D11ShaderResourceView>& TextureAtlas::GetTextureResourceView()
+    {
+        return m_textureRV;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   TextureAtlas::copyImage
+      Summary:  Copies an image into its footprint on a layer, inset by
+                the border. The border and the alignment padding past it
+                repeat the nearest edge texel
+      Args:     const DecodedMip& image
+                  Full resolution mip of the image
+                const PackedRectangle& footprint
+                  Rectangle the image was packed into
+                UINT uBorder
+                  Texels between the footprint and the image
+                DecodedMip& layer
+                  Full resolution mip of the layer
+      Modifies: [layer].
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    void TextureAtlas::copyImage(_In_ const DecodedMip& image, _In_ const PackedRectangle& footprint, _In_ UINT uBorder, _Inout_ DecodedMip& layer)
+    {
+        for (UINT y = 0u; y < footprint.uHeight; ++y)
+        {
+            const UINT uSourceY = std::min(y - std::min(y, uBorder), image.uHeight - 1u);
+            const BYTE* pSource = image.aData.data() + static_cast<size_t>(uSourceY) * image.uRowPitch;
+            BYTE* pDestination = layer.aData.data() + static_cast<size_t>(footprint.uY + y) * layer.uRowPitch + static_cast<size_t>(footprint.uX) * 4u;
+
+            const UINT uRight = std::min(uBorder + image.uWidth, footprint.uWidth);
+            for (UINT x = 0u; x < uBorder; ++x)
+            {
+                memcpy(pDestination + static_cast<size_t>(x) * 4u, pSource, 4u);
+            }
+            memcpy(pDestination + static_cast<size_t>(uBorder) * 4u, pSource, static_cast<size_t>(uRight - uBorder) * 4u);
+            for (UINT x = uRight; x < footprint.uWidth; ++x)
+            {
+                memcpy(pDestination + static_cast<size_t>(x) * 4u, pSource + static_cast<size_t>(image.uWidth - 1u) * 4u, 4u);
+            }
+        }
+    }
+}
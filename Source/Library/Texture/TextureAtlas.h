@@ -0,0 +1,109 @@
+﻿/*+===================================================================
+  File:      TEXTUREATLAS.H
+
+  Summary:   TextureAtlas header file contains declarations of the
+             TextureAtlas class that packs small textures into the
+             layers of one texture array.
+
+  Classes: TextureAtlas
+
+  © 2022 Kyung Hee University
+===================================================================+*/
+#pragma once
+
+#include "Common.h"
+
+#include "Texture/RectanglePacker.h"
+#include "Texture/TextureStreamingQueue.h"
+
+namespace library
+{
+    /*S+S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S
+      Struct:   AtlasRegion
+
+      Summary:  Where an image of the atlas was packed, the layer and
+                the scale and offset mapping its texture coordinates to
+                the ones of the layer, in xy and zw
+    S---S---S---S---S---S---S---S---S---S---S---S---S---S---S---S---S-S*/
+    struct AtlasRegion
+    {
+        XMFLOAT4 ScaleOffset;
+        UINT uLayer;
+    };
+
+    /*C+C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C
+      Class:    TextureAtlas
+
+      Summary:  Texture array holding decoded RGBA8 images, so that
+                objects sampling different ones are drawn together.
+                Layers are square, the smallest power of two the images
+                fit in. A square image of that size takes a whole layer,
+                the smaller ones share layers, packed by RectanglePacker
+                with their edge texels repeated in a border around them.
+                Shared layers keep the first mips only, those in which
+                the border still holds the bilinear taps of a region
+
+      Methods:  Add
+                  Adds an image and returns its region
+                Build
+                  Packs the images into layers and filters their mips
+                Initialize
+                  Creates the texture array
+                GetNumRegions
+                  Returns the number of images added
+                GetRegion
+                  Returns where an image was packed
+                GetNumLayers
+                  Returns the number of layers
+                GetLayerSize
+                  Returns the width and height of a layer
+                GetLayers
+                  Returns the layers and their mips
+                GetOccupancy
+                  Returns the ratio of the layers covered by images
+                GetTextureResourceView
+                  Returns the view of the texture array
+                TextureAtlas
+                  Constructor.
+                ~TextureAtlas
+                  Destructor.
+    C---C---C---C---C---C---C---C---C---C---C---C---C---C---C---C---C-C*/
+    class TextureAtlas final
+    {
+    public:
+        static constexpr UINT BORDER = 8u;
+        static constexpr UINT ALIGNMENT = 16u;
+        static constexpr UINT NUM_SHARED_MIPS = 5u;
+        static constexpr UINT MAX_LAYER_SIZE = 16384u;
+
+    public:
+        TextureAtlas();
+        TextureAtlas(const TextureAtlas& other) = delete;
+        TextureAtlas(TextureAtlas&& other) = delete;
+        TextureAtlas& operator=(const TextureAtlas& other) = delete;
+        TextureAtlas& operator=(TextureAtlas&& other) = delete;
+        ~TextureAtlas() = default;
+
+        UINT Add(_In_ DecodedImage&& image);
+        HRESULT Build(_In_ UINT uNumMipThreads);
+        HRESULT Initialize(_In_ ID3D11Device* pDevice);
+
+        UINT GetNumRegions() const;
+        const AtlasRegion& GetRegion(_In_ UINT uRegion) const;
+        UINT GetNumLayers() const;
+        UINT GetLayerSize() const;
+        const std::vector<DecodedImage>& GetLayers() const;
+        FLOAT GetOccupancy() const;
+        ComPtr<ID3D11ShaderResourceView>& GetTextureResourceView();
+
+    private:
+        static void copyImage(_In_ const DecodedMip& image, _In_ const PackedRectangle& footprint, _In_ UINT uBorder, _Inout_ DecodedMip& layer);
+
+        std::vector<DecodedImage> m_aImages;
+        std::vector<AtlasRegion> m_aRegions;
+        std::vector<DecodedImage> m_aLayers;
+        UINT m_uLayerSize;
+        FLOAT m_occupancy;
+        ComPtr<ID3D11ShaderResourceView> m_textureRV;
+    };
+}
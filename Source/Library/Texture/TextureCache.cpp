@@ -0,0 +1,300 @@
+#include "Texture/TextureCache.h"
+
+#include <algorithm>
+#include <cwctype>
+
+namespace library
+{
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   TextureCache::GetGlobal
+      Summary:  Returns the cache shared by the whole library, created
+                on first use
+      Returns:  TextureCache&
+                  Global texture cache
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    TextureCache& TextureCache::GetGlobal()
+    {
+        static TextureCache s_cache;
+
+        return s_cache;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   TextureCache::TextureCache
+      Summary:  Constructor. The cache starts empty and enabled, with no
+                budget
+      Modifies: [m_mutex, m_entries, m_uMemoryBudget, m_bEnabled,
+                  m_uNumAcquisitions, m_uNumHits, m_uNumMisses,
+                  m_uNumEvictions].
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    TextureCache::TextureCache()
+        : m_mutex()
+        , m_entries()
+        , m_uMemoryBudget(UNLIMITED_MEMORY_BUDGET)
+        , m_bEnabled(TRUE)
+        , m_uNumAcquisitions(0u)
+        , m_uNumHits(0u)
+        , m_uNumMisses(0u)
+        , m_uNumEvictions(0u)
+    {
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   TextureCache::Acquire
+      Summary:  Returns the texture of a file with the given sampler
+                type. On a miss the texture is created, left for the
+                caller to initialize, and unused textures are evicted
+                if the budget is exceeded. A disabled cache returns a
+                new texture, neither cached nor counted
+      Args:     const std::filesystem::path& filePath
+                  Path to the texture file
+                eTextureSamplerType textureSamplerType
+                  Texture sampler type of the texture
+      Modifies: [m_entries, m_uNumAcquisitions, m_uNumHits, m_uNumMisses,
+                  m_uNumEvictions].
+      Returns:  std::shared_ptr<Texture>
+                  Texture shared with every other acquirer of the file
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    std::shared_ptr<Texture> TextureCache::Acquire(_In_ const std::filesystem::path& filePath, _In_opt_ eTextureSamplerType textureSamplerType)
+    {
+        const std::wstring szKey = makeKey(filePath, textureSamplerType);
+
+        std::lock_guard<std::mutex> lock(m_mutex);
+
+        if (!m_bEnabled)
+        {
+            return std::make_shared<Texture>(filePath, textureSamplerType);
+        }
+
+        ++m_uNumAcquisitions;
+        const auto it = m_entries.find(szKey);
+        if (it != m_entries.end())
+        {
+            ++m_uNumHits;
+            it->second.uLastAcquisition = m_uNumAcquisitions;
+            return it->second.texture;
+        }
+
+        ++m_uNumMisses;
+        std::shared_ptr<Texture> texture = std::make_shared<Texture>(filePath, textureSamplerType);
+        m_entries.emplace(szKey, Entry{ .texture = texture, .uLastAcquisition = m_uNumAcquisitions });
+
+        evict(m_uMemoryBudget);
+
+        return texture;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   TextureCache::SetEnabled
+      Summary:  Enables or disables sharing the textures. The textures
+                already cached stay, for when it is enabled again
+      Args:     BOOL bEnabled
+                  TRUE to share the textures, FALSE to load every
+                  acquisition anew
+      Modifies: [m_bEnabled].
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    void TextureCache::SetEnabled(_In_ BOOL bEnabled)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+
+        m_bEnabled = bEnabled;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   TextureCache::SetMemoryBudget
+      Summary:  Sets the memory the loaded textures may take before the
+                unused ones are evicted. Textures in use are never
+                evicted, so the budget can be exceeded
+      Args:     UINT64 uMemoryBudget
+                  Budget in bytes, UNLIMITED_MEMORY_BUDGET for none
+      Modifies: [m_uMemoryBudget, m_entries, m_uNumEvictions].
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    void TextureCache::SetMemoryBudget(_In_ UINT64 uMemoryBudget)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+
+        m_uMemoryBudget = uMemoryBudget;
+        evict(m_uMemoryBudget);
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   TextureCache::Trim
+      Summary:  Evicts unused textures, least recently acquired first,
+                until the loaded ones fit in the budget
+      Modifies: [m_entries, m_uNumEvictions].
+      Returns:  UINT
+                  Number of textures evicted
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    UINT TextureCache::Trim()
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+
+        return evict(m_uMemoryBudget);
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   TextureCache::Clear
+      Summary:  Evicts every unused texture, loaded or not
+      Modifies: [m_entries, m_uNumEvictions].
+      Returns:  UINT
+                  Number of textures evicted
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    UINT TextureCache::Clear()
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+
+        const UINT uNumEvicted = static_cast<UINT>(std::erase_if(m_entries, [](const auto& entry)
+            {
+                return entry.second.texture.use_count() == 1;
+            }));
+        m_uNumEvictions += uNumEvicted;
+
+        return uNumEvicted;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   TextureCache::ResetStatistics
+      Summary:  Zeroes the hit, miss and eviction counters
+      Modifies: [m_uNumHits, m_uNumMisses, m_uNumEvictions].
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    void TextureCache::ResetStatistics()
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+
+        m_uNumHits = 0u;
+        m_uNumMisses = 0u;
+        m_uNumEvictions = 0u;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   TextureCache::GetStatistics
+      Summary:  Returns the counters since the last reset, and the
+                textures and memory the cache holds now
+      Returns:  TextureCacheStatistics
+                  Statistics of the cache
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    TextureCacheStatistics TextureCache::GetStatistics() const
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+
+        TextureCacheStatistics statistics =
+        {
+            .uNumHits = m_uNumHits,
+            .uNumMisses = m_uNumMisses,
+            .uNumEvictions = m_uNumEvictions,
+            .uNumTextures = static_cast<UINT>(m_entries.size()),
+            .uNumLoadedTextures = 0u,
+            .uNumUnusedTextures = 0u,
+            .uMemorySize = 0u,
+            .uMemoryBudget = m_uMemoryBudget
+        };
+        for (const auto& [szKey, entry] : m_entries)
+        {
+            statistics.uNumLoadedTextures += entry.texture->GetMemorySize() != 0u ? 1u : 0u;
+            statistics.uNumUnusedTextures += entry.texture.use_count() == 1 ? 1u : 0u;
+            statistics.uMemorySize += entry.texture->GetMemorySize();
+        }
+
+        return statistics;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   TextureCache::makeKey
+      Summary:  Returns the key of a file and sampler type. Different
+                spellings of the same path share the key, without case
+                on Windows where file names ignore it
+      Args:     const std::filesystem::path& filePath
+                  Path to the texture file
+                eTextureSamplerType textureSamplerType
+                  Texture sampler type of the texture
+      Returns:  std::wstring
+                  Canonical path followed by the sampler type
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    std::wstring TextureCache::makeKey(_In_ const std::filesystem::path& filePath, _In_ eTextureSamplerType textureSamplerType)
+    {
+        std::error_code error;
+        std::filesystem::path canonicalPath = std::filesystem::weakly_canonical(filePath, error);
+        if (error)
+        {
+            canonicalPath = filePath.lexically_normal();
+        }
+
+        std::wstring szKey = canonicalPath.generic_wstring();
+#ifdef _WIN32
+        std::transform(szKey.begin(), szKey.end(), szKey.begin(), [](WCHAR c)
+            {
+                return static_cast<WCHAR>(std::towlower(c));
+            });
+#endif // _WIN32
+        szKey += L'|';
+        szKey += std::to_wstring(static_cast<size_t>(textureSamplerType));
+
+        return szKey;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   TextureCache::evict
+      Summary:  Evicts unused textures, least recently acquired first,
+                until the loaded ones fit in a budget. The mutex is held
+      Args:     UINT64 uMemoryBudget
+                  Budget in bytes
+      Modifies: [m_entries, m_uNumEvictions].
+      Returns:  UINT
+                  Number of textures evicted
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    UINT TextureCache::evict(_In_ UINT64 uMemoryBudget)
+    {
+        UINT64 uMemorySize = getMemorySize();
+        if (uMemorySize <= uMemoryBudget)
+        {
+            return 0u;
+        }
+
+        std::vector<std::unordered_map<std::wstring, Entry>::iterator> aUnused;
+        for (auto it = m_entries.begin(); it != m_entries.end(); ++it)
+        {
+            if (it->second.texture.use_count() == 1)
+            {
+                aUnused.push_back(it);
+            }
+        }
+        std::sort(aUnused.begin(), aUnused.end(), [](const auto& left, const auto& right)
+            {
+                return left->second.uLastAcquisition < right->second.uLastAcquisition;
+            });
+
+        UINT uNumEvicted = 0u;
+        for (const auto& it : aUnused)
+        {
+            if (uMemorySize <= uMemoryBudget)
+            {
+                break;
+            }
+
+            uMemorySize -= it->second.texture->GetMemorySize();
+            m_entries.erase(it);
+            ++uNumEvicted;
+        }
+        m_uNumEvictions += uNumEvicted;
+
+        return uNumEvicted;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   TextureCache::getMemorySize
+      Summary:  Sums the memory of the loaded textures. The mutex is
+                held
+      Returns:  UINT64
+                  Memory in bytes
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    UINT64 TextureCache::getMemorySize() const
+    {
+        UINT64 uMemorySize = 0u;
+        for (const auto& [szKey, entry] : m_entries)
+        {
+            uMemorySize += entry.texture->GetMemorySize();
+        }
+
+        return uMemorySize;
+    }
+}
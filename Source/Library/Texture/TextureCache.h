@@ -0,0 +1,127 @@
+﻿/*+===================================================================
+  File:      TEXTURECACHE.H
+
+  Summary:   TextureCache header file contains declarations of the
+             TextureCacheStatistics type and the TextureCache class
+             that shares textures loaded from the same file.
+
+  Classes: TextureCache
+
+  © 2022 Kyung Hee University
+===================================================================+*/
+#pragma once
+
+#include "Common.h"
+
+#include <mutex>
+
+#include "Texture/Texture.h"
+
+namespace library
+{
+    /*S+S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S
+      Struct:   TextureCacheStatistics
+
+      Summary:  Counters of the texture cache. Hits are acquisitions
+                of a texture already in the cache, misses the ones that
+                created it. The memory is the estimated GPU size of the
+                loaded textures
+    S---S---S---S---S---S---S---S---S---S---S---S---S---S---S---S---S-S*/
+    struct TextureCacheStatistics
+    {
+        UINT uNumHits;
+        UINT uNumMisses;
+        UINT uNumEvictions;
+        UINT uNumTextures;
+        UINT uNumLoadedTextures;
+        UINT uNumUnusedTextures;
+        UINT64 uMemorySize;
+        UINT64 uMemoryBudget;
+    };
+
+    /*C+C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C
+      Class:    TextureCache
+
+      Summary:  Hands out shared textures keyed by the canonical path of
+                their file and their sampler type, so materials and
+                models that refer to the same file load it once. The
+                shared pointers count the references, a texture only
+                the cache holds is unused. When the loaded textures
+                exceed the memory budget, the unused ones are evicted,
+                least recently acquired first. A texture is loaded by
+                its first Initialize, later ones return at once. A
+                disabled cache hands out a new texture every time, to
+                measure what it saves. Thread safe
+
+      Methods:  GetGlobal
+                  Returns the cache shared by the whole library
+                Acquire
+                  Returns the texture of a file, created on a miss
+                SetEnabled
+                  Enables or disables sharing the textures
+                SetMemoryBudget
+                  Sets the memory the loaded textures may take
+                Trim
+                  Evicts unused textures until within the budget
+                Clear
+                  Evicts every unused texture
+                ResetStatistics
+                  Zeroes the hit, miss and eviction counters
+                GetStatistics
+                  Returns the counters and the memory of the textures
+                TextureCache
+                  Constructor.
+                ~TextureCache
+                  Destructor.
+    C---C---C---C---C---C---C---C---C---C---C---C---C---C---C---C---C-C*/
+    class TextureCache final
+    {
+    public:
+        static constexpr UINT64 UNLIMITED_MEMORY_BUDGET = ~0ull;
+
+        static TextureCache& GetGlobal();
+
+    public:
+        TextureCache();
+        TextureCache(const TextureCache& other) = delete;
+        TextureCache(TextureCache&& other) = delete;
+        TextureCache& operator=(const TextureCache& other) = delete;
+        TextureCache& operator=(TextureCache&& other) = delete;
+        ~TextureCache() = default;
+
+        std::shared_ptr<Texture> Acquire(_In_ const std::filesystem::path& filePath, _In_opt_ eTextureSamplerType textureSamplerType = eTextureSamplerType::TRILINEAR_WRAP);
+
+        void SetEnabled(_In_ BOOL bEnabled);
+        void SetMemoryBudget(_In_ UINT64 uMemoryBudget);
+        UINT Trim();
+        UINT Clear();
+
+        void ResetStatistics();
+        TextureCacheStatistics GetStatistics() const;
+
+    private:
+        /*S+S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S
+          Struct:   Entry
+
+          Summary:  Cached texture and when it was last acquired
+        S---S---S---S---S---S---S---S---S---S---S---S---S---S---S---S---S-S*/
+        struct Entry
+        {
+            std::shared_ptr<Texture> texture;
+            UINT64 uLastAcquisition;
+        };
+
+        static std::wstring makeKey(_In_ const std::filesystem::path& filePath, _In_ eTextureSamplerType textureSamplerType);
+        UINT evict(_In_ UINT64 uMemoryBudget);
+        UINT64 getMemorySize() const;
+
+        mutable std::mutex m_mutex;
+        std::unordered_map<std::wstring, Entry> m_entries;
+        UINT64 m_uMemoryBudget;
+        BOOL m_bEnabled;
+        UINT64 m_uNumAcquisitions;
+        UINT m_uNumHits;
+        UINT m_uNumMisses;
+        UINT m_uNumEvictions;
+    };
+}
@@ -0,0 +1,231 @@
+#include "Texture/TextureCooker.h"
+
+#include <algorithm>
+#include <cstring>
+#include <cwctype>
+
+#include "Texture/BlockCompressor.h"
+#include "Texture/DDSFile.h"
+
+namespace library
+{
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   TextureCooker::Cook
+      Summary:  Builds the DDS file of an RGBA8 image, every mip down
+                to 1x1 compressed. The mips of BC5 images are those of
+                normal maps, renormalized, the others are filtered as
+                sRGB colors with linear alpha
+      Args:     const DecodedImage& image
+                  Decoded source image and its mip chain
+                eCookedFormat format
+                  Format of the cooked texture
+                std::vector<BYTE>& aFile
+                  Bytes of the DDS file
+      Modifies: [aFile].
+      Returns:  HRESULT
+                  Status code
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    HRESULT TextureCooker::Cook(_In_ const DecodedImage& image, _In_ eCookedFormat format, _Out_ std::vector<BYTE>& aFile)
+    {
+        aFile.clear();
+        if (image.aMips.empty() || format >= eCookedFormat::COUNT)
+        {
+            return E_INVALIDARG;
+        }
+
+        // Every mip down to 1x1, each half the size of the previous one
+        UINT uWidth = image.aMips[0].uWidth;
+        UINT uHeight = image.aMips[0].uHeight;
+        for (const DecodedMip& mip : image.aMips)
+        {
+            if (mip.uWidth != uWidth || mip.uHeight != uHeight || mip.uWidth == 0u || mip.uHeight == 0u || mip.uRowPitch < mip.uWidth * 4u
+                || mip.aData.size() < static_cast<size_t>(mip.uRowPitch) * mip.uHeight)
+            {
+                return E_INVALIDARG;
+            }
+            uWidth = std::max(uWidth / 2u, 1u);
+            uHeight = std::max(uHeight / 2u, 1u);
+        }
+        if (image.aMips.back().uWidth != 1u || image.aMips.back().uHeight != 1u)
+        {
+            return E_INVALIDARG;
+        }
+
+        const DDSDescription description =
+        {
+            .uFormat = GetFormat(format),
+            .uDimension = 2u,
+            .uWidth = image.aMips[0].uWidth,
+            .uHeight = image.aMips[0].uHeight,
+            .uDepth = 1u,
+            .uMipLevels = static_cast<UINT>(image.aMips.size()),
+            .uArraySize = 1u,
+            .bCubeMap = FALSE
+        };
+        DDSFile::WriteHeader(description, aFile);
+
+        for (const DecodedMip& mip : image.aMips)
+        {
+            compressMip(mip, format, aFile);
+        }
+
+        return S_OK;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   TextureCooker::ChooseFormat
+      Summary:  Picks BC5 for normal maps, BC3 for images with alpha
+                and BC1 for the others. BC7 replaces BC1 and BC3 at
+                high quality
+      Args:     const std::filesystem::path& sourcePath
+                  Path to the source image
+                const DecodedMip& image
+                  Decoded source image
+                BOOL bHighQuality
+                  Whether to spend 8 bits per texel on every color
+      Returns:  eCookedFormat
+                  Format of the cooked texture
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    eCookedFormat TextureCooker::ChooseFormat(_In_ const std::filesystem::path& sourcePath, _In_ const DecodedMip& image, _In_ BOOL bHighQuality)
+    {
+        if (IsNormalMap(sourcePath))
+        {
+            return eCookedFormat::BC5;
+        }
+
+        BOOL bHasAlpha = FALSE;
+        for (UINT y = 0u; y < image.uHeight && !bHasAlpha; ++y)
+        {
+            const BYTE* pRow = image.aData.data() + static_cast<size_t>(image.uRowPitch) * y;
+            for (UINT x = 0u; x < image.uWidth; ++x)
+            {
+                if (pRow[x * 4u + 3u] != 0xFFu)
+                {
+                    bHasAlpha = TRUE;
+                    break;
+                }
+            }
+        }
+
+        if (bHighQuality)
+        {
+            return eCookedFormat::BC7;
+        }
+
+        return bHasAlpha ? eCookedFormat::BC3 : eCookedFormat::BC1;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   TextureCooker::IsNormalMap
+      Summary:  Tells normal maps apart by the name of their file, the
+                "_ddn" suffix of the nanosuit or "normal"
+      Args:     const std::filesystem::path& sourcePath
+                  Path to the source image
+      Returns:  BOOL
+                  TRUE for normal maps
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    BOOL TextureCooker::IsNormalMap(_In_ const std::filesystem::path& sourcePath)
+    {
+        std::wstring szStem = sourcePath.stem().wstring();
+        std::transform(szStem.begin(), szStem.end(), szStem.begin(), [](WCHAR c)
+            {
+                return static_cast<WCHAR>(std::towlower(c));
+            });
+
+        return szStem.find(L"_ddn") != std::wstring::npos || szStem.find(L"normal") != std::wstring::npos;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   TextureCooker::GetCookedPath
+      Summary:  Returns the path the cooked file of a source is written
+                to, next to it with the .dds extension
+      Args:     const std::filesystem::path& sourcePath
+                  Path to the source image
+      Returns:  std::filesystem::path
+                  Path to the cooked file
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    std::filesystem::path TextureCooker::GetCookedPath(_In_ const std::filesystem::path& sourcePath)
+    {
+        return std::filesystem::path(sourcePath).replace_extension(L".dds");
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   TextureCooker::GetFormat
+      Summary:  Returns the DXGI format a cooked format is written as
+      Args:     eCookedFormat format
+                  Format of the cooked texture
+      Returns:  UINT
+                  DXGI_FORMAT value, a UNORM one
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    UINT TextureCooker::GetFormat(_In_ eCookedFormat format)
+    {
+        switch (format)
+        {
+        case eCookedFormat::BC1:
+            return 71u;
+        case eCookedFormat::BC3:
+            return 77u;
+        case eCookedFormat::BC5:
+            return 83u;
+        case eCookedFormat::BC7:
+            return 98u;
+        default:
+            return 0u;
+        }
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   TextureCooker::compressMip
+      Summary:  Appends the compressed blocks of a mip to a file.
+                Blocks over the edge of the mip repeat its last texels
+      Args:     const DecodedMip& mip
+                  RGBA8 texels of the mip
+                eCookedFormat format
+                  Format of the cooked texture
+                std::vector<BYTE>& aFile
+                  Bytes of the DDS file
+      Modifies: [aFile].
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    void TextureCooker::compressMip(_In_ const DecodedMip& mip, _In_ eCookedFormat format, _Inout_ std::vector<BYTE>& aFile)
+    {
+        const UINT uWidth = mip.uWidth;
+        const UINT uHeight = mip.uHeight;
+        const UINT uBlockSize = format == eCookedFormat::BC1 ? 8u : 16u;
+        const UINT uNumBlocksX = (uWidth + 3u) / 4u;
+        const UINT uNumBlocksY = (uHeight + 3u) / 4u;
+
+        size_t uOffset = aFile.size();
+        aFile.resize(uOffset + static_cast<size_t>(uNumBlocksX) * uNumBlocksY * uBlockSize);
+
+        BYTE aBlock[BlockCompressor::NUM_BLOCK_TEXELS * 4u];
+        for (UINT uBlockY = 0u; uBlockY < uNumBlocksY; ++uBlockY)
+        {
+            for (UINT uBlockX = 0u; uBlockX < uNumBlocksX; ++uBlockX)
+            {
+                for (UINT i = 0u; i < BlockCompressor::NUM_BLOCK_TEXELS; ++i)
+                {
+                    const UINT x = std::min(uBlockX * 4u + i % 4u, uWidth - 1u);
+                    const UINT y = std::min(uBlockY * 4u + i / 4u, uHeight - 1u);
+                    memcpy(aBlock + i * 4u, mip.aData.data() + static_cast<size_t>(mip.uRowPitch) * y + x * 4u, 4u);
+                }
+
+                switch (format)
+                {
+                case eCookedFormat::BC1:
+                    BlockCompressor::CompressBC1(aBlock, aFile.data() + uOffset);
+                    break;
+                case eCookedFormat::BC3:
+                    BlockCompressor::CompressBC3(aBlock, aFile.data() + uOffset);
+                    break;
+                case eCookedFormat::BC5:
+                    BlockCompressor::CompressBC5(aBlock, aFile.data() + uOffset);
+                    break;
+                default:
+                    BlockCompressor::CompressBC7(aBlock, aFile.data() + uOffset);
+                    break;
+                }
+                uOffset += uBlockSize;
+            }
+        }
+    }
+}
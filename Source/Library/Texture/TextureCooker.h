@@ -0,0 +1,69 @@
+﻿/*+===================================================================
+  File:      TEXTURECOOKER.H
+
+  Summary:   TextureCooker header file contains declarations of the
+             TextureCooker class that turns decoded images into block
+             compressed DDS files with their full mip chain.
+
+  Classes: TextureCooker
+
+  © 2022 Kyung Hee University
+===================================================================+*/
+#pragma once
+
+#include "Common.h"
+
+#include "Texture/TextureStreamingQueue.h"
+
+namespace library
+{
+    enum class eCookedFormat
+    {
+        BC1 = 0,
+        BC3,
+        BC5,
+        BC7,
+        COUNT,
+    };
+
+    /*C+C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C
+      Class:    TextureCooker
+
+      Summary:  Offline conversion of source images to DDS files the
+                texture loaders map in place. The mips are those the
+                streamer decodes, filtered by MipGenerator. The formats
+                are the UNORM ones, so a cooked texture samples the same
+                values as its source loaded through WIC. Normal maps
+                keep X and Y in BC5, shaders rebuild Z
+
+      Methods:  Cook
+                  Builds the DDS file of an image
+                ChooseFormat
+                  Picks the format of an image
+                IsNormalMap
+                  Tells whether a source file is a normal map
+                GetCookedPath
+                  Returns the path of the cooked file of a source
+                GetFormat
+                  Returns the DXGI format of a cooked format
+    C---C---C---C---C---C---C---C---C---C---C---C---C---C---C---C---C-C*/
+    class TextureCooker final
+    {
+    public:
+        TextureCooker() = delete;
+        TextureCooker(const TextureCooker& other) = delete;
+        TextureCooker(TextureCooker&& other) = delete;
+        TextureCooker& operator=(const TextureCooker& other) = delete;
+        TextureCooker& operator=(TextureCooker&& other) = delete;
+        ~TextureCooker() = delete;
+
+        static HRESULT Cook(_In_ const DecodedImage& image, _In_ eCookedFormat format, _Out_ std::vector<BYTE>& aFile);
+        static eCookedFormat ChooseFormat(_In_ const std::filesystem::path& sourcePath, _In_ const DecodedMip& image, _In_ BOOL bHighQuality);
+        static BOOL IsNormalMap(_In_ const std::filesystem::path& sourcePath);
+        static std::filesystem::path GetCookedPath(_In_ const std::filesystem::path& sourcePath);
+        static UINT GetFormat(_In_ eCookedFormat format);
+
+    private:
+        static void compressMip(_In_ const DecodedMip& mip, _In_ eCookedFormat format, _Inout_ std::vector<BYTE>& aFile);
+    };
+}
@@ -0,0 +1,391 @@
+#include "Texture/TextureStreamer.h"
+
+#include "Texture/DDSFile.h"
+#include "Texture/MipGenerator.h"
+#include "Texture/TextureCooker.h"
+
+namespace library
+{
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   TextureStreamer::GetGlobal
+      Summary:  Returns the streamer shared by the whole library,
+                created on first use and disabled until initialized
+      Returns:  TextureStreamer&
+                  Global texture streamer
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    TextureStreamer& TextureStreamer::GetGlobal()
+    {
+        static TextureStreamer s_streamer;
+
+        return s_streamer;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   TextureStreamer::TextureStreamer
+      Summary:  Constructor
+      Modifies: [m_d3dDevice, m_placeholder, m_queue, m_streamedTextures,
+                  m_aDecoded, m_aUploads].
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    TextureStreamer::TextureStreamer()
+        : m_d3dDevice(nullptr)
+        , m_placeholder(nullptr)
+        , m_queue()
+        , m_streamedTextures()
+        , m_aDecoded()
+        , m_aUploads()
+    {
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   TextureStreamer::Initialize
+      Summary:  Starts the streaming threads. Textures initialized from
+                now on are streamed, showing the placeholder until their
+                mip tail arrives
+      Args:     ID3D11Device* pDevice
+                  The Direct3D device to create the textures
+                UINT uNumThreads
+                  Number of threads that read and decode files
+                UINT64 uUploadBudget
+                  Bytes of mips uploaded per frame, the tails aside
+                const std::shared_ptr<Texture>& placeholder
+                  Loaded texture shown until a texture is decoded
+      Modifies: [m_d3dDevice, m_placeholder, m_queue].
+      Returns:  HRESULT
+                  Status code
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    HRESULT TextureStreamer::Initialize(_In_ ID3D11Device* pDevice, _In_ UINT uNumThreads, _In_ UINT64 uUploadBudget, _In_ const std::shared_ptr<Texture>& placeholder)
+    {
+        if (!pDevice || !placeholder || !placeholder->GetTextureResourceView())
+        {
+            return E_INVALIDARG;
+        }
+
+        HRESULT hr = m_queue.Initialize(uNumThreads, uUploadBudget, MIP_TAIL_SIZE);
+        if (FAILED(hr))
+        {
+            return hr;
+        }
+
+        m_d3dDevice = pDevice;
+        m_placeholder = placeholder;
+
+        return S_OK;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   TextureStreamer::Shutdown
+      Summary:  Stops the streaming threads. Textures that have not
+                decoded keep the placeholder
+      Modifies: [m_d3dDevice, m_placeholder, m_queue, m_streamedTextures].
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    void TextureStreamer::Shutdown()
+    {
+        m_queue.Shutdown();
+        m_streamedTextures.clear();
+        m_placeholder.reset();
+        m_d3dDevice.Reset();
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   TextureStreamer::IsEnabled
+      Summary:  Tells whether textures are streamed
+      Returns:  BOOL
+                  TRUE between Initialize and Shutdown
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    BOOL TextureStreamer::IsEnabled() const
+    {
+        return m_d3dDevice != nullptr;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   TextureStreamer::Stream
+      Summary:  Queues the decode of a texture and gives it the view of
+                the placeholder meanwhile. Only a weak reference is
+                kept, a texture released before it decoded is dropped
+      Args:     const std::shared_ptr<Texture>& texture
+                  Texture to stream
+      Modifies: [m_queue, m_streamedTextures, texture].
+      Returns:  HRESULT
+                  E_NOTIMPL for DDS files, cooked images and the files
+                  of mounted archives, which are mapped instead
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    HRESULT TextureStreamer::Stream(_In_ const std::shared_ptr<Texture>& texture)
+    {
+        if (!IsEnabled())
+        {
+            return E_UNEXPECTED;
+        }
+
+        if (DDSFile::HasExtension(texture->GetFilePath()) || texture->hasDDSFile())
+        {
+            return E_NOTIMPL;
+        }
+
+        const UINT uStream = m_queue.Enqueue([filePath = texture->GetFilePath()](DecodedImage& image)
+            {
+                return Decode(filePath, 1u, image);
+            });
+        m_streamedTextures.emplace(uStream, StreamedTexture{ .texture = texture, .texture2D = nullptr });
+
+        texture->m_textureRV = m_placeholder->GetTextureResourceView();
+
+        return S_OK;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   TextureStreamer::Update
+      Summary:  Creates the textures decoded since the last frame with
+                their mip tail, then uploads the mips the queue
+                schedules and lowers the minimum LOD of their textures.
+                Called once per frame before anything is drawn
+      Args:     ID3D11DeviceContext* pImmediateContext
+                  The Direct3D context to upload the mips with
+      Modifies: [m_queue, m_streamedTextures, m_aDecoded, m_aUploads].
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    void TextureStreamer::Update(_In_ ID3D11DeviceContext* pImmediateContext)
+    {
+        if (!IsEnabled())
+        {
+            return;
+        }
+
+        m_queue.BeginFrame(m_aDecoded);
+        for (UINT uStream : m_aDecoded)
+        {
+            const auto it = m_streamedTextures.find(uStream);
+            if (it == m_streamedTextures.end())
+            {
+                continue;
+            }
+
+            if (FAILED(createTexture(pImmediateContext, uStream, it->second)))
+            {
+                m_queue.Cancel(uStream);
+                m_streamedTextures.erase(it);
+            }
+        }
+
+        m_queue.Schedule(m_aUploads);
+        for (const MipUpload& upload : m_aUploads)
+        {
+            const auto it = m_streamedTextures.find(upload.uStream);
+            if (it == m_streamedTextures.end())
+            {
+                continue;
+            }
+
+            uploadMip(pImmediateContext, it->second.texture2D.Get(), m_queue.GetImage(upload.uStream), upload.uMip);
+            pImmediateContext->SetResourceMinLOD(it->second.texture2D.Get(), static_cast<FLOAT>(upload.uMip));
+        }
+        m_queue.EndFrame();
+
+        std::erase_if(m_streamedTextures, [this](const auto& streamedTexture)
+            {
+                return m_queue.IsResident(streamedTexture.first);
+            });
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   TextureStreamer::GetStatistics
+      Summary:  Returns the streams in every state and the uploads of
+                the last frame
+      Returns:  StreamingStatistics
+                  Statistics of the streaming queue
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    StreamingStatistics TextureStreamer::GetStatistics() const
+    {
+        return m_queue.GetStatistics();
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   TextureStreamer::Decode
+      Summary:  Reads an image file with WIC, converts it to RGBA8 and
+                generates its mip chain, colors filtered as sRGB and
+                normal maps renormalized. Runs on a streaming thread, or
+                any other, which joins the multithreaded apartment for
+                the call
+      Args:     const std::filesystem::path& filePath
+                  Path to the image file
+                UINT uNumMipThreads
+                  Threads the mips are generated with, the calling one
+                  included
+                DecodedImage& image
+                  Decoded image
+      Modifies: [image].
+      Returns:  HRESULT
+                  Status code
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    HRESULT TextureStreamer::Decode(_In_ const std::filesystem::path& filePath, _In_ UINT uNumMipThreads, _Inout_ DecodedImage& image)
+    {
+        const HRESULT hrCom = CoInitializeEx(nullptr, COINIT_MULTITHREADED);
+
+        HRESULT hr = [&filePath, uNumMipThreads, &image]()
+            {
+                ComPtr<IWICImagingFactory> factory;
+                HRESULT hr = CoCreateInstance(CLSID_WICImagingFactory, nullptr, CLSCTX_INPROC_SERVER, IID_PPV_ARGS(factory.GetAddressOf()));
+                if (FAILED(hr))
+                {
+                    return hr;
+                }
+
+                ComPtr<IWICBitmapDecoder> decoder;
+                hr = factory->CreateDecoderFromFilename(filePath.c_str(), nullptr, GENERIC_READ, WICDecodeMetadataCacheOnDemand, decoder.GetAddressOf());
+                if (FAILED(hr))
+                {
+                    return hr;
+                }
+
+                ComPtr<IWICBitmapFrameDecode> frame;
+                hr = decoder->GetFrame(0u, frame.GetAddressOf());
+                if (FAILED(hr))
+                {
+                    return hr;
+                }
+
+                ComPtr<IWICFormatConverter> converter;
+                hr = factory->CreateFormatConverter(converter.GetAddressOf());
+                if (FAILED(hr))
+                {
+                    return hr;
+                }
+
+                hr = converter->Initialize(frame.Get(), GUID_WICPixelFormat32bppRGBA, WICBitmapDitherTypeNone, nullptr, 0.0, WICBitmapPaletteTypeCustom);
+                if (FAILED(hr))
+                {
+                    return hr;
+                }
+
+                UINT uWidth = 0u;
+                UINT uHeight = 0u;
+                hr = converter->GetSize(&uWidth, &uHeight);
+                if (FAILED(hr))
+                {
+                    return hr;
+                }
+                if (uWidth == 0u || uHeight == 0u
+                    || uWidth > D3D11_REQ_TEXTURE2D_U_OR_V_DIMENSION || uHeight > D3D11_REQ_TEXTURE2D_U_OR_V_DIMENSION)
+                {
+                    return E_INVALIDARG;
+                }
+
+                DecodedMip mip =
+                {
+                    .uWidth = uWidth,
+                    .uHeight = uHeight,
+                    .uRowPitch = uWidth * 4u,
+                    .aData = std::vector<BYTE>(static_cast<size_t>(uWidth) * uHeight * 4u)
+                };
+                hr = converter->CopyPixels(nullptr, mip.uRowPitch, static_cast<UINT>(mip.aData.size()), mip.aData.data());
+                if (FAILED(hr))
+                {
+                    return hr;
+                }
+
+                image.aMips.clear();
+                image.aMips.push_back(std::move(mip));
+
+                const BOOL bNormalMap = TextureCooker::IsNormalMap(filePath);
+                return MipGenerator(uNumMipThreads).Generate(image, bNormalMap ? eMipFormat::RGBA8_UNORM : eMipFormat::RGBA8_UNORM_SRGB, bNormalMap);
+            }();
+
+        if (SUCCEEDED(hrCom))
+        {
+            CoUninitialize();
+        }
+
+        return hr;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   TextureStreamer::createTexture
+      Summary:  Creates the texture of a decoded stream with its full
+                mip chain, uploads the mip tail, clamps sampling to it
+                and replaces the placeholder of the texture. A failed
+                decode leaves the placeholder
+      Args:     ID3D11DeviceContext* pImmediateContext
+                  The Direct3D context to upload the mip tail with
+                UINT uStream
+                  Decoded stream
+                StreamedTexture& streamedTexture
+                  Texture of the stream
+      Modifies: [streamedTexture].
+      Returns:  HRESULT
+                  Status code
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    HRESULT TextureStreamer::createTexture(_In_ ID3D11DeviceContext* pImmediateContext, _In_ UINT uStream, _Inout_ StreamedTexture& streamedTexture)
+    {
+        const std::shared_ptr<Texture> texture = streamedTexture.texture.lock();
+        if (!texture)
+        {
+            return E_ABORT;
+        }
+
+        HRESULT hr = m_queue.GetStatus(uStream);
+        if (FAILED(hr))
+        {
+            OutputDebugString(L"Can't stream texture from \"");
+            OutputDebugString(texture->GetFilePath().c_str());
+            OutputDebugString(L"\n");
+            return hr;
+        }
+
+        const DecodedImage& image = m_queue.GetImage(uStream);
+        const UINT uNumMips = static_cast<UINT>(image.aMips.size());
+        D3D11_TEXTURE2D_DESC desc =
+        {
+            .Width = image.aMips[0].uWidth,
+            .Height = image.aMips[0].uHeight,
+            .MipLevels = uNumMips,
+            .ArraySize = 1u,
+            .Format = DXGI_FORMAT_R8G8B8A8_UNORM,
+            .SampleDesc = {.Count = 1u, .Quality = 0u },
+            .Usage = D3D11_USAGE_DEFAULT,
+            .BindFlags = D3D11_BIND_SHADER_RESOURCE,
+            .CPUAccessFlags = 0u,
+            .MiscFlags = 0u
+        };
+        hr = m_d3dDevice->CreateTexture2D(&desc, nullptr, streamedTexture.texture2D.GetAddressOf());
+        if (FAILED(hr))
+        {
+            return hr;
+        }
+
+        const UINT uResidentMip = m_queue.GetResidentMip(uStream);
+        for (UINT uMip = uResidentMip; uMip < uNumMips; ++uMip)
+        {
+            uploadMip(pImmediateContext, streamedTexture.texture2D.Get(), image, uMip);
+        }
+        pImmediateContext->SetResourceMinLOD(streamedTexture.texture2D.Get(), static_cast<FLOAT>(uResidentMip));
+
+        ComPtr<ID3D11ShaderResourceView> textureRV;
+        hr = m_d3dDevice->CreateShaderResourceView(streamedTexture.texture2D.Get(), nullptr, textureRV.GetAddressOf());
+        if (FAILED(hr))
+        {
+            return hr;
+        }
+
+        texture->m_textureRV = textureRV;
+        texture->m_uMemorySize = Texture::computeMemorySize(textureRV.Get());
+
+        return S_OK;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   TextureStreamer::uploadMip
+      Summary:  Copies a decoded mip into its subresource
+      Args:     ID3D11DeviceContext* pImmediateContext
+                  The Direct3D context to upload with
+                ID3D11Texture2D* pTexture2D
+                  Texture of the image
+                const DecodedImage& image
+                  Decoded image
+                UINT uMip
+                  Mip to upload
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    void TextureStreamer::uploadMip(_In_ ID3D11DeviceContext* pImmediateContext, _In_ ID3D11Texture2D* pTexture2D, _In_ const DecodedImage& image, _In_ UINT uMip)
+    {
+        const DecodedMip& mip = image.aMips[uMip];
+        pImmediateContext->UpdateSubresource(pTexture2D, D3D11CalcSubresource(uMip, 0u, static_cast<UINT>(image.aMips.size())), nullptr,
+            mip.aData.data(), mip.uRowPitch, 0u);
+    }
+}
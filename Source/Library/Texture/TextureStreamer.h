@@ -0,0 +1,107 @@
+﻿/*+===================================================================
+  File:      TEXTURESTREAMER.H
+
+  Summary:   TextureStreamer header file contains declarations of the
+             TextureStreamer class that loads textures in the
+             background and uploads their mips over several frames.
+
+  Classes: TextureStreamer
+
+  © 2022 Kyung Hee University
+===================================================================+*/
+#pragma once
+
+#include "Common.h"
+
+#include "Texture/Texture.h"
+#include "Texture/TextureStreamingQueue.h"
+
+namespace library
+{
+    /*C+C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C
+      Class:    TextureStreamer
+
+      Summary:  Streams the image textures of the library. A streamed
+                texture shows the placeholder texture as soon as it is
+                initialized, while its file is read and decoded to RGBA8
+                with its mip chain on the streaming threads. Once
+                decoded it is created with every mip, the mip tail is
+                uploaded at once and the minimum LOD of the texture
+                keeps sampling away from the finer mips until the
+                queue schedules them under the upload budget. DDS files
+                hold their own mips and formats, they are mapped and
+                created in place instead, and so are the images cooked
+                to DDS. Driven from the render thread
+
+      Methods:  GetGlobal
+                  Returns the streamer shared by the whole library
+                Initialize
+                  Starts streaming with a placeholder texture
+                Shutdown
+                  Stops streaming
+                IsEnabled
+                  Tells whether textures are streamed
+                Stream
+                  Starts streaming a texture
+                Update
+                  Creates the decoded textures and uploads the mips of
+                  the frame
+                GetStatistics
+                  Returns the streams and uploads of the last frame
+                Decode
+                  Reads an image file and generates its mips
+                TextureStreamer
+                  Constructor.
+                ~TextureStreamer
+                  Destructor.
+    C---C---C---C---C---C---C---C---C---C---C---C---C---C---C---C---C-C*/
+    class TextureStreamer final
+    {
+    public:
+        static constexpr UINT64 MIP_TAIL_SIZE = 64u * 64u * 4u;
+
+        static TextureStreamer& GetGlobal();
+
+    public:
+        TextureStreamer();
+        TextureStreamer(const TextureStreamer& other) = delete;
+        TextureStreamer(TextureStreamer&& other) = delete;
+        TextureStreamer& operator=(const TextureStreamer& other) = delete;
+        TextureStreamer& operator=(TextureStreamer&& other) = delete;
+        ~TextureStreamer() = default;
+
+        HRESULT Initialize(_In_ ID3D11Device* pDevice, _In_ UINT uNumThreads, _In_ UINT64 uUploadBudget, _In_ const std::shared_ptr<Texture>& placeholder);
+        void Shutdown();
+        BOOL IsEnabled() const;
+
+        HRESULT Stream(_In_ const std::shared_ptr<Texture>& texture);
+        void Update(_In_ ID3D11DeviceContext* pImmediateContext);
+
+        StreamingStatistics GetStatistics() const;
+
+        static HRESULT Decode(_In_ const std::filesystem::path& filePath, _In_ UINT uNumMipThreads, _Inout_ DecodedImage& image);
+
+    private:
+        /*S+S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S
+          Struct:   StreamedTexture
+
+          Summary:  Texture being streamed and the resource its mips are
+                    uploaded to once decoded
+        S---S---S---S---S---S---S---S---S---S---S---S---S---S---S---S---S-S*/
+        struct StreamedTexture
+        {
+            std::weak_ptr<Texture> texture;
+            ComPtr<ID3D11Texture2D> texture2D;
+        };
+
+        HRESULT createTexture(_In_ ID3D11DeviceContext* pImmediateContext, _In_ UINT uStream, _Inout_ StreamedTexture& streamedTexture);
+        static void uploadMip(_In_ ID3D11DeviceContext* pImmediateContext, _In_ ID3D11Texture2D* pTexture2D, _In_ const DecodedImage& image, _In_ UINT uMip);
+
+        ComPtr<ID3D11Device> m_d3dDevice;
+        std::shared_ptr<Texture> m_placeholder;
+        TextureStreamingQueue m_queue;
+        std::unordered_map<UINT, StreamedTexture> m_streamedTextures;
+        std::vector<UINT> m_aDecoded;
+        std::vector<MipUpload> m_aUploads;
+    };
+}
@@ -0,0 +1,448 @@
+#include "Texture/TextureStreamingQueue.h"
+
+#include <algorithm>
+
+namespace library
+{
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   TextureStreamingQueue::TextureStreamingQueue
+      Summary:  Constructor. The queue decodes on the calling thread and
+                uploads without budget until initialized
+      Modifies: [m_aWorkers, m_mutex, m_jobCondition, m_aJobs,
+                  m_aDecodedJobs, m_bShutdown, m_aStreams, m_uUploadBudget,
+                  m_uMipTailSize, m_statistics].
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    TextureStreamingQueue::TextureStreamingQueue()
+        : m_aWorkers()
+        , m_mutex()
+        , m_jobCondition()
+        , m_aJobs()
+        , m_aDecodedJobs()
+        , m_bShutdown(FALSE)
+        , m_aStreams()
+        , m_uUploadBudget(~0ull)
+        , m_uMipTailSize(0u)
+        , m_statistics()
+    {
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   TextureStreamingQueue::~TextureStreamingQueue
+      Summary:  Destructor. Stops and joins the worker threads
+      Modifies: [m_aWorkers, m_aJobs, m_bShutdown].
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    TextureStreamingQueue::~TextureStreamingQueue()
+    {
+        Shutdown();
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   TextureStreamingQueue::Initialize
+      Summary:  Starts the worker threads that decode, none decodes in
+                BeginFrame instead. Restarts the queue when it is
+                already running
+      Args:     UINT uNumThreads
+                  Number of worker threads
+                UINT64 uUploadBudget
+                  Bytes of mips uploaded per frame, the tails aside
+                UINT64 uMipTailSize
+                  Largest mip a texture is created with
+      Modifies: [m_aWorkers, m_bShutdown, m_uUploadBudget,
+                  m_uMipTailSize].
+      Returns:  HRESULT
+                  Status code
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    HRESULT TextureStreamingQueue::Initialize(_In_ UINT uNumThreads, _In_ UINT64 uUploadBudget, _In_ UINT64 uMipTailSize)
+    {
+        Shutdown();
+
+        m_bShutdown = FALSE;
+        m_uUploadBudget = uUploadBudget;
+        m_uMipTailSize = uMipTailSize;
+        m_aWorkers.reserve(uNumThreads);
+        for (UINT i = 0u; i < uNumThreads; ++i)
+        {
+            m_aWorkers.emplace_back(&TextureStreamingQueue::workerMain, this);
+        }
+
+        return S_OK;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   TextureStreamingQueue::Shutdown
+      Summary:  Wakes the worker threads up to exit and joins them. The
+                decodes no thread has started are canceled, the ones
+                that finished are still collected by BeginFrame
+      Modifies: [m_aWorkers, m_aJobs, m_bShutdown, m_aStreams].
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    void TextureStreamingQueue::Shutdown()
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_bShutdown = TRUE;
+        }
+        m_jobCondition.notify_all();
+
+        for (std::thread& worker : m_aWorkers)
+        {
+            worker.join();
+        }
+        m_aWorkers.clear();
+
+        for (const Job& job : m_aJobs)
+        {
+            m_aStreams[job.uStream].eState = eStreamState::CANCELED;
+        }
+        m_aJobs.clear();
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   TextureStreamingQueue::Enqueue
+      Summary:  Queues the decode of a texture. The decode function
+                fills the image, the full resolution mip first, and
+                runs on a worker thread
+      Args:     DecodeFunction&& decode
+                  Function that decodes the texture
+      Modifies: [m_aJobs, m_aStreams].
+      Returns:  UINT
+                  Stream of the texture
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    UINT TextureStreamingQueue::Enqueue(_In_ DecodeFunction&& decode)
+    {
+        const UINT uStream = static_cast<UINT>(m_aStreams.size());
+        m_aStreams.push_back(Stream{ .eState = eStreamState::DECODING, .hr = E_PENDING, .uResidentMip = 0u, .image = DecodedImage() });
+
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_aJobs.push_back(Job{ .uStream = uStream, .decode = std::move(decode), .hr = E_PENDING, .image = DecodedImage() });
+        }
+        m_jobCondition.notify_one();
+
+        return uStream;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   TextureStreamingQueue::Cancel
+      Summary:  Forgets a stream that is still decoding or streaming,
+                e.g. because its texture was released. Its image is
+                dropped once decoded
+      Args:     UINT uStream
+                  Stream to cancel
+      Modifies: [m_aStreams].
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    void TextureStreamingQueue::Cancel(_In_ UINT uStream)
+    {
+        Stream& stream = m_aStreams[uStream];
+        if (stream.eState == eStreamState::DECODING || stream.eState == eStreamState::STREAMING)
+        {
+            stream.eState = eStreamState::CANCELED;
+        }
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   TextureStreamingQueue::BeginFrame
+      Summary:  Zeroes the uploads of the frame and collects the streams
+                decoded since the last frame. A decoded stream is
+                resident down from the start of its mip tail, which the
+                caller uploads now, a failed one only has its status
+      Args:     std::vector<UINT>& aDecoded
+                  Streams decoded or failed since the last frame
+      Modifies: [m_aJobs, m_aDecodedJobs, m_aStreams, m_statistics].
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    void TextureStreamingQueue::BeginFrame(_Out_ std::vector<UINT>& aDecoded)
+    {
+        aDecoded.clear();
+        m_statistics.uNumTailUploads = 0u;
+        m_statistics.uNumUploads = 0u;
+        m_statistics.uTailBytesUploaded = 0u;
+        m_statistics.uBytesUploaded = 0u;
+
+        if (m_aWorkers.empty())
+        {
+            while (!m_aJobs.empty())
+            {
+                Job job = std::move(m_aJobs.front());
+                m_aJobs.pop_front();
+                finishDecode(job);
+            }
+        }
+
+        std::vector<Job> aDecodedJobs;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            aDecodedJobs.swap(m_aDecodedJobs);
+        }
+
+        for (Job& job : aDecodedJobs)
+        {
+            Stream& stream = m_aStreams[job.uStream];
+            if (stream.eState == eStreamState::CANCELED)
+            {
+                continue;
+            }
+
+            aDecoded.push_back(job.uStream);
+            if (FAILED(job.hr) || job.image.aMips.empty())
+            {
+                stream.eState = eStreamState::FAILED;
+                stream.hr = FAILED(job.hr) ? job.hr : E_FAIL;
+                continue;
+            }
+
+            stream.eState = eStreamState::STREAMING;
+            stream.hr = S_OK;
+            stream.image = std::move(job.image);
+
+            const std::vector<DecodedMip>& aMips = stream.image.aMips;
+            stream.uResidentMip = static_cast<UINT>(aMips.size()) - 1u;
+            while (stream.uResidentMip > 0u && aMips[stream.uResidentMip - 1u].aData.size() <= m_uMipTailSize)
+            {
+                --stream.uResidentMip;
+            }
+            for (UINT uMip = stream.uResidentMip; uMip < aMips.size(); ++uMip)
+            {
+                ++m_statistics.uNumTailUploads;
+                m_statistics.uTailBytesUploaded += aMips[uMip].aData.size();
+            }
+
+            if (stream.uResidentMip == 0u)
+            {
+                stream.eState = eStreamState::RESIDENT;
+            }
+        }
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   TextureStreamingQueue::Schedule
+      Summary:  Picks the mips to upload this frame. The stream whose
+                finest resident mip is the coarsest gains the next finer
+                mip, ties going to the oldest stream, until the next mip
+                would exceed the budget. Streams are resident down to
+                the scheduled mips when this returns
+      Args:     std::vector<MipUpload>& aUploads
+                  Mips to upload, in order
+      Modifies: [m_aStreams, m_statistics].
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    void TextureStreamingQueue::Schedule(_Out_ std::vector<MipUpload>& aUploads)
+    {
+        aUploads.clear();
+
+        UINT64 uRemainingBudget = m_uUploadBudget;
+        for (;;)
+        {
+            Stream* pCoarsest = nullptr;
+            UINT uCoarsest = INVALID_STREAM;
+            for (UINT i = 0u; i < m_aStreams.size(); ++i)
+            {
+                Stream& stream = m_aStreams[i];
+                if (stream.eState == eStreamState::STREAMING && (!pCoarsest || stream.uResidentMip > pCoarsest->uResidentMip))
+                {
+                    pCoarsest = &stream;
+                    uCoarsest = i;
+                }
+            }
+            if (!pCoarsest)
+            {
+                break;
+            }
+
+            const UINT uMip = pCoarsest->uResidentMip - 1u;
+            const UINT64 uSize = pCoarsest->image.aMips[uMip].aData.size();
+            if (uSize > uRemainingBudget && !aUploads.empty())
+            {
+                break;
+            }
+
+            uRemainingBudget -= std::min(uSize, uRemainingBudget);
+            aUploads.push_back(MipUpload{ .uStream = uCoarsest, .uMip = uMip });
+            ++m_statistics.uNumUploads;
+            m_statistics.uBytesUploaded += uSize;
+
+            pCoarsest->uResidentMip = uMip;
+            if (uMip == 0u)
+            {
+                pCoarsest->eState = eStreamState::RESIDENT;
+            }
+        }
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   TextureStreamingQueue::EndFrame
+      Summary:  Frees the images of the streams that are resident,
+                failed or canceled, once their uploads are made
+      Modifies: [m_aStreams].
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    void TextureStreamingQueue::EndFrame()
+    {
+        for (Stream& stream : m_aStreams)
+        {
+            if (stream.eState != eStreamState::STREAMING && !stream.image.aMips.empty())
+            {
+                stream.image = DecodedImage();
+            }
+        }
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   TextureStreamingQueue::SetUploadBudget
+      Summary:  Sets the bytes of mips uploaded per frame
+      Args:     UINT64 uUploadBudget
+                  Budget in bytes
+      Modifies: [m_uUploadBudget].
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    void TextureStreamingQueue::SetUploadBudget(_In_ UINT64 uUploadBudget)
+    {
+        m_uUploadBudget = uUploadBudget;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   TextureStreamingQueue::GetStatus
+      Summary:  Returns whether a stream decoded
+      Args:     UINT uStream
+                  Stream
+      Returns:  HRESULT
+                  E_PENDING while decoding, E_ABORT once canceled, the
+                  error of a failed decode, S_OK otherwise
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    HRESULT TextureStreamingQueue::GetStatus(_In_ UINT uStream) const
+    {
+        if (uStream >= m_aStreams.size())
+        {
+            return E_INVALIDARG;
+        }
+
+        switch (m_aStreams[uStream].eState)
+        {
+        case eStreamState::DECODING:
+            return E_PENDING;
+        case eStreamState::CANCELED:
+            return E_ABORT;
+        default:
+            return m_aStreams[uStream].hr;
+        }
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   TextureStreamingQueue::GetResidentMip
+      Summary:  Returns the finest resident mip of a decoded stream,
+                the coarser ones are resident too
+      Args:     UINT uStream
+                  Stream
+      Returns:  UINT
+                  Finest resident mip
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    UINT TextureStreamingQueue::GetResidentMip(_In_ UINT uStream) const
+    {
+        return m_aStreams[uStream].uResidentMip;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   TextureStreamingQueue::IsResident
+      Summary:  Tells whether every mip of a stream is resident
+      Args:     UINT uStream
+                  Stream
+      Returns:  BOOL
+                  TRUE once the full resolution mip is scheduled
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    BOOL TextureStreamingQueue::IsResident(_In_ UINT uStream) const
+    {
+        return m_aStreams[uStream].eState == eStreamState::RESIDENT;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   TextureStreamingQueue::GetImage
+      Summary:  Returns the decoded image of a stream, empty before it
+                decoded and after EndFrame of the frame it became
+                resident
+      Args:     UINT uStream
+                  Stream
+      Returns:  const DecodedImage&
+                  Decoded image
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    const DecodedImage& TextureStreamingQueue::GetImage(_In_ UINT uStream) const
+    {
+        return m_aStreams[uStream].image;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   TextureStreamingQueue::GetStatistics
+      Summary:  Returns the number of streams in every state and the
+                uploads of the frame
+      Returns:  StreamingStatistics
+                  Statistics of the queue
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    StreamingStatistics TextureStreamingQueue::GetStatistics() const
+    {
+        StreamingStatistics statistics = m_statistics;
+        statistics.uNumDecoding = 0u;
+        statistics.uNumStreaming = 0u;
+        statistics.uNumResident = 0u;
+        statistics.uNumFailed = 0u;
+        statistics.uUploadBudget = m_uUploadBudget;
+        for (const Stream& stream : m_aStreams)
+        {
+            switch (stream.eState)
+            {
+            case eStreamState::DECODING:
+                ++statistics.uNumDecoding;
+                break;
+            case eStreamState::STREAMING:
+                ++statistics.uNumStreaming;
+                break;
+            case eStreamState::RESIDENT:
+                ++statistics.uNumResident;
+                break;
+            case eStreamState::FAILED:
+                ++statistics.uNumFailed;
+                break;
+            default:
+                break;
+            }
+        }
+
+        return statistics;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   TextureStreamingQueue::workerMain
+      Summary:  Entry point of a worker thread. Decodes queued textures
+                until shut down
+      Modifies: [m_aJobs].
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    void TextureStreamingQueue::workerMain()
+    {
+        for (;;)
+        {
+            Job job;
+            {
+                std::unique_lock<std::mutex> lock(m_mutex);
+                m_jobCondition.wait(lock, [this] { return m_bShutdown || !m_aJobs.empty(); });
+                if (m_bShutdown)
+                {
+                    return;
+                }
+                job = std::move(m_aJobs.front());
+                m_aJobs.pop_front();
+            }
+
+            finishDecode(job);
+        }
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   TextureStreamingQueue::finishDecode
+      Summary:  Runs the decode function of a job and hands the result
+                to the next BeginFrame
+      Args:     Job& job
+                  Job to decode
+      Modifies: [m_aDecodedJobs].
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    void TextureStreamingQueue::finishDecode(_Inout_ Job& job)
+    {
+        job.hr = job.decode(job.image);
+        job.decode = nullptr;
+
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_aDecodedJobs.push_back(std::move(job));
+    }
+}
@@ -0,0 +1,212 @@
+﻿/*+===================================================================
+  File:      TEXTURESTREAMINGQUEUE.H
+
+  Summary:   TextureStreamingQueue header file contains declarations of
+             the types of decoded images and the TextureStreamingQueue
+             class that decodes textures on worker threads and hands
+             their mips out to upload under a per-frame budget.
+
+  Classes: TextureStreamingQueue
+
+  © 2022 Kyung Hee University
+===================================================================+*/
+#pragma once
+
+#include "Common.h"
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+namespace library
+{
+    /*S+S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S
+      Struct:   DecodedMip
+
+      Summary:  Texels of a decoded mip, rows uRowPitch bytes apart
+    S---S---S---S---S---S---S---S---S---S---S---S---S---S---S---S---S-S*/
+    struct DecodedMip
+    {
+        UINT uWidth;
+        UINT uHeight;
+        UINT uRowPitch;
+        std::vector<BYTE> aData;
+    };
+
+    /*S+S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S
+      Struct:   DecodedImage
+
+      Summary:  Mip chain of a decoded texture, the full resolution mip
+                first
+    S---S---S---S---S---S---S---S---S---S---S---S---S---S---S---S---S-S*/
+    struct DecodedImage
+    {
+        std::vector<DecodedMip> aMips;
+    };
+
+    /*S+S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S
+      Struct:   MipUpload
+
+      Summary:  Mip of a stream to upload this frame
+    S---S---S---S---S---S---S---S---S---S---S---S---S---S---S---S---S-S*/
+    struct MipUpload
+    {
+        UINT uStream;
+        UINT uMip;
+    };
+
+    /*S+S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S
+      Struct:   StreamingStatistics
+
+      Summary:  Streams in every state and the uploads of the last
+                frame. Tail uploads are the smallest mips a texture is
+                created with, the other uploads share the budget
+    S---S---S---S---S---S---S---S---S---S---S---S---S---S---S---S---S-S*/
+    struct StreamingStatistics
+    {
+        UINT uNumDecoding;
+        UINT uNumStreaming;
+        UINT uNumResident;
+        UINT uNumFailed;
+        UINT uNumTailUploads;
+        UINT uNumUploads;
+        UINT64 uTailBytesUploaded;
+        UINT64 uBytesUploaded;
+        UINT64 uUploadBudget;
+    };
+
+    using DecodeFunction = std::function<HRESULT(DecodedImage& image)>;
+
+    /*C+C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C
+      Class:    TextureStreamingQueue
+
+      Summary:  Queue of textures streamed in the background. Enqueued
+                decode functions run on the worker threads, or on the
+                calling thread of BeginFrame when there are none, and
+                know nothing of the GPU. Once decoded, a stream starts
+                with the tail of its mip chain, every mip up to the
+                tail size, and then gains one finer mip at a time, the
+                coarsest streams first, as long as the uploads of the
+                frame fit in the budget. The first upload of a frame is
+                always made so that a mip larger than the budget still
+                arrives. Apart from the decode functions everything
+                runs on the thread that enqueues and begins frames
+
+      Methods:  Initialize
+                  Starts the worker threads and sets the budget
+                Shutdown
+                  Stops the worker threads, dropping pending decodes
+                Enqueue
+                  Queues the decode of a texture
+                Cancel
+                  Forgets a stream
+                BeginFrame
+                  Collects the decoded streams
+                Schedule
+                  Picks the mips to upload this frame
+                EndFrame
+                  Frees the images of finished streams
+                SetUploadBudget
+                  Sets the bytes uploaded per frame
+                GetStatus
+                  Returns whether a stream decoded
+                GetResidentMip
+                  Returns the finest resident mip of a stream
+                IsResident
+                  Tells whether every mip of a stream is resident
+                GetImage
+                  Returns the decoded image of a stream
+                GetStatistics
+                  Returns the streams and uploads of the frame
+                TextureStreamingQueue
+                  Constructor.
+                ~TextureStreamingQueue
+                  Destructor.
+    C---C---C---C---C---C---C---C---C---C---C---C---C---C---C---C---C-C*/
+    class TextureStreamingQueue final
+    {
+    public:
+        static constexpr UINT INVALID_STREAM = 0xFFFFFFFFu;
+
+    public:
+        TextureStreamingQueue();
+        TextureStreamingQueue(const TextureStreamingQueue& other) = delete;
+        TextureStreamingQueue(TextureStreamingQueue&& other) = delete;
+        TextureStreamingQueue& operator=(const TextureStreamingQueue& other) = delete;
+        TextureStreamingQueue& operator=(TextureStreamingQueue&& other) = delete;
+        ~TextureStreamingQueue();
+
+        HRESULT Initialize(_In_ UINT uNumThreads, _In_ UINT64 uUploadBudget, _In_ UINT64 uMipTailSize);
+        void Shutdown();
+
+        UINT Enqueue(_In_ DecodeFunction&& decode);
+        void Cancel(_In_ UINT uStream);
+
+        void BeginFrame(_Out_ std::vector<UINT>& aDecoded);
+        void Schedule(_Out_ std::vector<MipUpload>& aUploads);
+        void EndFrame();
+
+        void SetUploadBudget(_In_ UINT64 uUploadBudget);
+
+        HRESULT GetStatus(_In_ UINT uStream) const;
+        UINT GetResidentMip(_In_ UINT uStream) const;
+        BOOL IsResident(_In_ UINT uStream) const;
+        const DecodedImage& GetImage(_In_ UINT uStream) const;
+        StreamingStatistics GetStatistics() const;
+
+    private:
+        enum class eStreamState : UINT
+        {
+            DECODING = 0,
+            STREAMING,
+            RESIDENT,
+            FAILED,
+            CANCELED,
+        };
+
+        /*S+S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S
+          Struct:   Stream
+
+          Summary:  State of a stream, its finest resident mip and its
+                    image until every mip is uploaded
+        S---S---S---S---S---S---S---S---S---S---S---S---S---S---S---S---S-S*/
+        struct Stream
+        {
+            eStreamState eState;
+            HRESULT hr;
+            UINT uResidentMip;
+            DecodedImage image;
+        };
+
+        /*S+S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S+++S
+          Struct:   Job
+
+          Summary:  Decode waiting for a thread, or its result waiting for
+                    BeginFrame
+        S---S---S---S---S---S---S---S---S---S---S---S---S---S---S---S---S-S*/
+        struct Job
+        {
+            UINT uStream;
+            DecodeFunction decode;
+            HRESULT hr;
+            DecodedImage image;
+        };
+
+        void workerMain();
+        void finishDecode(_Inout_ Job& job);
+
+        std::vector<std::thread> m_aWorkers;
+        std::mutex m_mutex;
+        std::condition_variable m_jobCondition;
+        std::deque<Job> m_aJobs;
+        std::vector<Job> m_aDecodedJobs;
+        BOOL m_bShutdown;
+
+        std::vector<Stream> m_aStreams;
+        UINT64 m_uUploadBudget;
+        UINT64 m_uMipTailSize;
+        StreamingStatistics m_statistics;
+    };
+}
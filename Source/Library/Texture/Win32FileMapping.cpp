@@ -0,0 +1,92 @@
+#include "Texture/Win32FileMapping.h"
+
+#ifdef _WIN32
+
+namespace library
+{
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   Win32FileMapping::~Win32FileMapping
+      Summary:  Destructor. Unmaps the file
+      Modifies: [m_pData, m_uSize, m_bOpen].
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    Win32FileMapping::~Win32FileMapping()
+    {
+        Close();
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   Win32FileMapping::Open
+      Summary:  Maps a whole file read-only, unmapping the previous one.
+                An empty file opens with no data, Windows refuses to
+                map it
+      Args:     const std::filesystem::path& filePath
+                  Path to the file
+      Modifies: [m_pData, m_uSize, m_bOpen].
+      Returns:  HRESULT
+                  Status code
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    HRESULT Win32FileMapping::Open(_In_ const std::filesystem::path& filePath)
+    {
+        Close();
+
+        HANDLE hFile = CreateFileW(filePath.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+        if (hFile == INVALID_HANDLE_VALUE)
+        {
+            return HRESULT_FROM_WIN32(GetLastError());
+        }
+
+        LARGE_INTEGER fileSize = {};
+        if (!GetFileSizeEx(hFile, &fileSize))
+        {
+            const HRESULT hr = HRESULT_FROM_WIN32(GetLastError());
+            CloseHandle(hFile);
+            return hr;
+        }
+
+        const void* pView = nullptr;
+        if (fileSize.QuadPart > 0)
+        {
+            HANDLE hMapping = CreateFileMappingW(hFile, nullptr, PAGE_READONLY, 0u, 0u, nullptr);
+            if (!hMapping)
+            {
+                const HRESULT hr = HRESULT_FROM_WIN32(GetLastError());
+                CloseHandle(hFile);
+                return hr;
+            }
+
+            pView = MapViewOfFile(hMapping, FILE_MAP_READ, 0u, 0u, 0u);
+            const HRESULT hr = pView ? S_OK : HRESULT_FROM_WIN32(GetLastError());
+            CloseHandle(hMapping);
+            if (FAILED(hr))
+            {
+                CloseHandle(hFile);
+                return hr;
+            }
+        }
+        CloseHandle(hFile);
+
+        m_pData = static_cast<const BYTE*>(pView);
+        m_uSize = static_cast<UINT64>(fileSize.QuadPart);
+        m_bOpen = TRUE;
+
+        return S_OK;
+    }
+
+    /*M+M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M+++M
+      Method:   Win32FileMapping::Close
+      Summary:  Unmaps the file, pointers into the view dangle
+      Modifies: [m_pData, m_uSize, m_bOpen].
+    M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M---M-M*/
+    void Win32FileMapping::Close()
+    {
+        if (m_pData)
+        {
+            UnmapViewOfFile(m_pData);
+        }
+        m_pData = nullptr;
+        m_uSize = 0u;
+        m_bOpen = FALSE;
+    }
+}
+
+#endif // _WIN32
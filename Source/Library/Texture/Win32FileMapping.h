@@ -0,0 +1,52 @@
+﻿/*+===================================================================
+  File:      WIN32FILEMAPPING.H
+
+  Summary:   Win32FileMapping header file contains declarations of the
+             Win32FileMapping class, the file mapping of Windows.
+
+  Classes: Win32FileMapping
+
+  © 2022 Kyung Hee University
+===================================================================+*/
+#pragma once
+
+#ifdef _WIN32
+
+#include "Common.h"
+
+#include "Texture/FileMapping.h"
+
+namespace library
+{
+    /*C+C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C+++C
+      Class:    Win32FileMapping
+
+      Summary:  File mapping built on a file mapping object and a view
+                of it. The file and mapping handles are closed as soon
+                as the view is mapped, the view keeps both alive
+
+      Methods:  Open
+                  Maps a file
+                Close
+                  Unmaps the file
+                Win32FileMapping
+                  Constructor.
+                ~Win32FileMapping
+                  Destructor.
+    C---C---C---C---C---C---C---C---C---C---C---C---C---C---C---C---C-C*/
+    class Win32FileMapping final : public FileMapping
+    {
+    public:
+        Win32FileMapping() = default;
+        Win32FileMapping(const Win32FileMapping& other) = delete;
+        Win32FileMapping(Win32FileMapping&& other) = delete;
+        Win32FileMapping& operator=(const Win32FileMapping& other) = delete;
+        Win32FileMapping& operator=(Win32FileMapping&& other) = delete;
+        ~Win32FileMapping() override;
+
+        HRESULT Open(_In_ const std::filesystem::path& filePath) override;
+        void Close() override;
+    };
+}
+
+#endif // _WIN32